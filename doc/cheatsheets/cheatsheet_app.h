@@ -10,6 +10,7 @@
 // Handlers (can be defined by your app to respond to events)
 //----------------------------------------------------------------
 void oc_on_init(void);
+void oc_on_restore(void);
 void oc_on_mouse_down(oc_mouse_button button);
 void oc_on_mouse_up(oc_mouse_button button);
 void oc_on_mouse_enter(void);
@@ -21,6 +22,7 @@ void oc_on_key_up(oc_scan_code scan, oc_key_code key);
 void oc_on_frame_refresh(void);
 void oc_on_resize(f32 width, f32 height);
 void oc_on_raw_event(oc_event* event);
+void oc_on_events(oc_event* events, u32 count);
 void oc_on_terminate(void);
 
 //----------------------------------------------------------------
@@ -29,6 +31,11 @@ void oc_on_terminate(void);
 void oc_window_set_title(oc_str8 title);
 void oc_window_set_size(oc_vec2 size);
 
+//----------------------------------------------------------------
+// Frame scheduling
+//----------------------------------------------------------------
+void oc_request_frame(void);
+
 //----------------------------------------------------------------
 // Quitting
 //----------------------------------------------------------------
@@ -60,6 +60,7 @@ void oc_set_cap(oc_cap_type cap);
 void oc_set_font(oc_font font);
 void oc_set_font_size(f32 size);
 void oc_set_text_flip(bool flip);
+void oc_set_glyph_raster_cache(bool enable);
 void oc_set_image(oc_image image);
 void oc_set_image_source_region(oc_rect region);
 
@@ -72,6 +73,7 @@ oc_cap_type oc_get_cap(void);
 oc_font oc_get_font(void);
 f32 oc_get_font_size(void);
 bool oc_get_text_flip(void);
+bool oc_get_glyph_raster_cache(void);
 oc_image oc_get_image();
 
 //------------------------------------------------------------------------------------------
@@ -98,8 +100,10 @@ void oc_stroke(void);
 //------------------------------------------------------------------------------------------
 // shapes helpers
 //------------------------------------------------------------------------------------------
+void oc_rectangle_path(f32 x, f32 y, f32 w, f32 h);
 void oc_rectangle_fill(f32 x, f32 y, f32 w, f32 h);
 void oc_rectangle_stroke(f32 x, f32 y, f32 w, f32 h);
+void oc_rounded_rectangle_path(f32 x, f32 y, f32 w, f32 h, f32 r);
 void oc_rounded_rectangle_fill(f32 x, f32 y, f32 w, f32 h, f32 r);
 void oc_rounded_rectangle_stroke(f32 x, f32 y, f32 w, f32 h, f32 r);
 void oc_ellipse_fill(f32 x, f32 y, f32 rx, f32 ry);
@@ -119,6 +123,10 @@ bool oc_font_is_nil(oc_font font);
 oc_font oc_font_create_from_memory(oc_str8 mem, u32 rangeCount, oc_unicode_range* ranges);
 oc_font oc_font_create_from_file(oc_file file, u32 rangeCount, oc_unicode_range* ranges);
 oc_font oc_font_create_from_path(oc_str8 path, u32 rangeCount, oc_unicode_range* ranges);
+oc_str8 oc_font_push_cache(oc_arena* arena, oc_font font);
+oc_font oc_font_create_from_cache_memory(oc_str8 mem);
+oc_font oc_font_create_from_cache_file(oc_file file);
+oc_font oc_font_create_from_cache_path(oc_str8 path);
 
 void oc_font_destroy(oc_font font);
 
@@ -133,6 +141,9 @@ f32 oc_font_get_scale_for_em_pixels(oc_font font, f32 emSize);
 oc_text_metrics oc_font_text_metrics_utf32(oc_font font, f32 fontSize, oc_str32 codepoints);
 oc_text_metrics oc_font_text_metrics(oc_font font, f32 fontSize, oc_str8 text);
 
+oc_text_run_cache_stats oc_text_run_cache_get_stats(void);
+void oc_text_run_cache_reset_stats(void);
+
 //------------------------------------------------------------------------------------------
 // images
 //------------------------------------------------------------------------------------------
@@ -150,6 +161,11 @@ void oc_image_destroy(oc_image image);
 void oc_image_upload_region_rgba8(oc_image image, oc_rect region, u8* pixels);
 oc_vec2 oc_image_size(oc_image image);
 
+oc_image oc_image_create_async_from_memory(oc_surface surface, oc_str8 mem, bool flip, u32 maxSize);
+oc_image oc_image_create_async_from_file(oc_surface surface, oc_file file, bool flip, u32 maxSize);
+oc_image oc_image_create_async_from_path(oc_surface surface, oc_str8 path, bool flip, u32 maxSize);
+oc_image_status oc_image_get_status(oc_image image);
+
 //------------------------------------------------------------------------------------------
 // image atlas
 //------------------------------------------------------------------------------------------
@@ -157,6 +173,8 @@ oc_vec2 oc_image_size(oc_image image);
 oc_rect_atlas* oc_rect_atlas_create(oc_arena* arena, i32 width, i32 height);
 oc_rect oc_rect_atlas_alloc(oc_rect_atlas* atlas, i32 width, i32 height);
 void oc_rect_atlas_recycle(oc_rect_atlas* atlas, oc_rect rect);
+oc_rect_atlas_stats oc_rect_atlas_get_stats(oc_rect_atlas* atlas);
+bool oc_rect_atlas_defragment(oc_rect_atlas* atlas, oc_rect_atlas_move_proc moveProc, void* user);
 
 oc_image_region oc_image_atlas_alloc_from_rgba8(oc_rect_atlas* atlas, oc_image backingImage, u32 width, u32 height, u8* pixels);
 oc_image_region oc_image_atlas_alloc_from_memory(oc_rect_atlas* atlas, oc_image backingImage, oc_str8 mem, bool flip);
@@ -39,6 +39,10 @@ void oc_ui_panel_begin(const char* name, oc_ui_flags flags);
 void oc_ui_panel_end(void);
 #define oc_ui_panel(s, f)
 
+void oc_ui_list_begin(const char* name, oc_ui_flags flags, oc_ui_list_info* info);
+void oc_ui_list_end(oc_ui_list_info* info);
+#define oc_ui_list(s, f, info)
+
 void oc_ui_menu_bar_begin(const char* name);
 void oc_ui_menu_bar_end(void);
 #define oc_ui_menu_bar(name)
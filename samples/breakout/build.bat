@@ -27,6 +27,10 @@ set wasmFlags=--target=wasm32^
        -I%ORCA_DIR%\src ^
        -I%ORCA_DIR%\src\ext
 
+:: let clang vectorize with WebAssembly SIMD, if it supports it
+echo.| clang --target=wasm32 -msimd128 -x c -c -o NUL - >NUL 2>&1
+if !ERRORLEVEL! equ 0 set wasmFlags=%wasmFlags% -msimd128
+
 :: build orca core as wasm module
 clang %wasmFlags% -Wl,--relocatable -o .\liborca.a %ORCA_DIR%\src\orca.c %ORCA_DIR%\src\libc-shim\src\*.c
 IF %ERRORLEVEL% NEQ 0 EXIT /B %ERRORLEVEL%
@@ -27,6 +27,11 @@ wasmFlags="--target=wasm32 \
   -I $ORCA_DIR/src \
   -I $ORCA_DIR/src/ext"
 
+# let clang vectorize with WebAssembly SIMD, if it supports it
+if echo "" | clang --target=wasm32 -msimd128 -x c -c -o /dev/null - 2>/dev/null; then
+  wasmFlags="$wasmFlags -msimd128"
+fi
+
 # build orca core as wasm module
 clang $wasmFlags -Wl,--relocatable -o ./liborca.a $ORCA_DIR/src/orca.c $STDLIB_DIR/src/*.c
 
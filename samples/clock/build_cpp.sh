@@ -46,6 +46,12 @@ wasmFlags="--target=wasm32 \
   -I $ORCA_DIR/ext \
   -I $ORCA_DIR/src"
 
+# let clang vectorize with WebAssembly SIMD, if it supports it
+if echo "" | $CLANG --target=wasm32 -msimd128 -x c -c -o /dev/null - 2>/dev/null; then
+  wasmObjFlags="$wasmObjFlags -msimd128"
+  wasmFlags="$wasmFlags -msimd128"
+fi
+
 if [ ! -e build ] ; then
     mkdir build
 fi
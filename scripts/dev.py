@@ -27,6 +27,7 @@ def attach_dev_commands(subparsers):
 
     build_cmd = dev_sub.add_parser("build-runtime", help="Build the Orca runtime from source.")
     build_cmd.add_argument("--release", action="store_true", help="compile Orca in release mode (default is debug)")
+    build_cmd.add_argument("--guard-pages", action="store_true", help="catch out of bounds wasm memory accesses with guard pages instead of explicit bounds checks (64-bit only)")
     build_cmd.set_defaults(func=dev_shellish(build_runtime))
 
     clean_cmd = dev_sub.add_parser("clean", help="Delete all build artifacts and start fresh.")
@@ -61,11 +62,13 @@ def dev_shellish(func):
 
 def build_runtime(args):
     ensure_programs()
-    ensure_angle()
+    if platform.system() != "Linux":
+        # the Linux platform layer is headless and doesn't use ANGLE
+        ensure_angle()
 
     build_platform_layer("lib", args.release)
-    build_wasm3(args.release)
-    build_orca(args.release)
+    build_wasm3(args.release, args.guard_pages)
+    build_orca(args.release, args.guard_pages)
 
     with open("build/orcaruntime.sum", "w") as f:
         f.write(runtime_checksum())
@@ -101,6 +104,8 @@ def build_platform_layer(target, release):
             build_platform_layer_lib_win(release)
         elif platform.system() == "Darwin":
             build_platform_layer_lib_mac(release)
+        elif platform.system() == "Linux":
+            build_platform_layer_lib_linux(release)
         else:
             log_error(f"can't build platform layer for unknown platform '{platform.system()}'")
             exit(1)
@@ -237,7 +242,24 @@ def build_platform_layer_lib_mac(release):
     ], check=True)
 
 
-def build_wasm3(release):
+def build_platform_layer_lib_linux(release):
+    cflags = ["-std=c11", "-fPIC", "-D_GNU_SOURCE"]
+    debug_flags = ["-O3"] if release else ["-g", "-DOC_DEBUG", "-DOC_LOG_COMPILE_DEBUG"]
+    includes = ["-Isrc", "-Isrc/ext"]
+
+    # the Linux platform layer is headless: it has no display connection, and its surfaces
+    # don't draw anything. It is used to run and benchmark apps on CI machines.
+    subprocess.run([
+        "gcc",
+        *debug_flags, *cflags, *includes,
+        "-shared",
+        "-o", "build/bin/liborca.so",
+        "src/orca.c",
+        "-lm", "-lpthread",
+    ], check=True)
+
+
+def build_wasm3(release, guard_pages):
     print("Building wasm3...")
 
     os.makedirs("build/bin", exist_ok=True)
@@ -245,21 +267,26 @@ def build_wasm3(release):
     os.makedirs("build/obj", exist_ok=True)
 
     if platform.system() == "Windows":
-        build_wasm3_lib_win(release)
+        build_wasm3_lib_win(release, guard_pages)
     elif platform.system() == "Darwin":
-        build_wasm3_lib_mac(release)
+        build_wasm3_lib_mac(release, guard_pages)
+    elif platform.system() == "Linux":
+        build_wasm3_lib_linux(release, guard_pages)
     else:
         log_error(f"can't build wasm3 for unknown platform '{platform.system()}'")
         exit(1)
 
 
-def build_wasm3_lib_win(release):
+def build_wasm3_lib_win(release, guard_pages):
     for f in glob.iglob("./src/ext/wasm3/source/*.c"):
         name = os.path.splitext(os.path.basename(f))[0]
         subprocess.run([
             "cl", "/nologo",
             "/Zi", "/Zc:preprocessor", "/c",
             "/O2",
+            "/Dd_m3EnableCodeCache=1",
+            "/Dd_m3EnableJit=1",
+            *guard_pages_flags(guard_pages, "/D"),
             f"/Fo:build/obj/{name}.obj",
             "/I", "./src/ext/wasm3/source",
             f,
@@ -270,7 +297,7 @@ def build_wasm3_lib_win(release):
     ], check=True)
 
 
-def build_wasm3_lib_mac(release):
+def build_wasm3_lib_mac(release, guard_pages):
     includes = ["-Isrc/ext/wasm3/source"]
     debug_flags = ["-g", "-O2"]
     flags = [
@@ -278,6 +305,9 @@ def build_wasm3_lib_mac(release):
         "-foptimize-sibling-calls",
         "-Wno-extern-initializer",
         "-Dd_m3VerboseErrorMessages",
+        "-Dd_m3EnableCodeCache=1",
+        "-Dd_m3EnableJit=1",
+        *guard_pages_flags(guard_pages, "-D"),
         "-mmacos-version-min=10.15.4"
     ]
 
@@ -292,22 +322,54 @@ def build_wasm3_lib_mac(release):
     subprocess.run(["rm", "-rf", "build/obj"], check=True)
 
 
-def build_orca(release):
+def build_wasm3_lib_linux(release, guard_pages):
+    includes = ["-Isrc/ext/wasm3/source"]
+    debug_flags = ["-g", "-O2"]
+    flags = [
+        *debug_flags,
+        "-fPIC",
+        "-foptimize-sibling-calls",
+        "-Dd_m3VerboseErrorMessages",
+        "-Dd_m3EnableCodeCache=1",
+        "-Dd_m3EnableJit=1",
+        *guard_pages_flags(guard_pages, "-D"),
+    ]
+
+    for f in glob.iglob("src/ext/wasm3/source/*.c"):
+        name = os.path.splitext(os.path.basename(f))[0] + ".o"
+        subprocess.run([
+            "gcc", "-c", *flags, *includes,
+            "-o", f"build/obj/{name}",
+            f,
+        ], check=True)
+    subprocess.run(["ar", "rcs", "build/lib/libwasm3.a", *glob.glob("build/obj/*.o")], check=True)
+    subprocess.run(["rm", "-rf", "build/obj"], check=True)
+
+
+def guard_pages_flags(guard_pages, define):
+    # wasm3 and the runtime must agree on this: the runtime reserves the guard region and
+    # turns faults into traps only when wasm3 is built without bounds checks.
+    return [f"{define}d_m3SkipMemoryBoundsCheck=1"] if guard_pages else []
+
+
+def build_orca(release, guard_pages):
     print("Building Orca runtime...")
 
     os.makedirs("build/bin", exist_ok=True)
     os.makedirs("build/lib", exist_ok=True)
 
     if platform.system() == "Windows":
-        build_orca_win(release)
+        build_orca_win(release, guard_pages)
     elif platform.system() == "Darwin":
-        build_orca_mac(release)
+        build_orca_mac(release, guard_pages)
+    elif platform.system() == "Linux":
+        build_orca_linux(release, guard_pages)
     else:
         log_error(f"can't build Orca for unknown platform '{platform.system()}'")
         exit(1)
 
 
-def build_orca_win(release):
+def build_orca_win(release, guard_pages):
 
     gen_all_bindings()
 
@@ -328,6 +390,7 @@ def build_orca_win(release):
         "cl",
         "/Zi", "/Zc:preprocessor",
         "/std:c11", "/experimental:c11atomics",
+        *guard_pages_flags(guard_pages, "/D"),
         *includes,
         "src/runtime.c",
         "/link", *libs,
@@ -335,7 +398,7 @@ def build_orca_win(release):
     ], check=True)
 
 
-def build_orca_mac(release):
+def build_orca_mac(release, guard_pages):
 
     includes = [
         "-Isrc",
@@ -347,6 +410,7 @@ def build_orca_mac(release):
     debug_flags = ["-O2"] if release else ["-g", "-DOC_DEBUG -DOC_LOG_COMPILE_DEBUG"]
     flags = [
         *debug_flags,
+        *guard_pages_flags(guard_pages, "-D"),
         "-mmacos-version-min=10.15.4"]
 
     gen_all_bindings()
@@ -371,16 +435,43 @@ def build_orca_mac(release):
     ], check=True)
 
 
-def gen_all_bindings():
-    gles_gen("src/ext/gl.xml",
-        "src/wasmbind/gles_api.json",
-        "src/graphics/orca_gl31.h",
-        log_file='./build/gles_gen.log'
-    )
+def build_orca_linux(release, guard_pages):
+    includes = [
+        "-Isrc",
+        "-Isrc/ext",
+        "-Isrc/ext/wasm3/source"
+    ]
+    libs = ["-Lbuild/bin", "-Lbuild/lib", "-lorca", "-lwasm3", "-lm", "-lpthread"]
+    debug_flags = ["-O2"] if release else ["-g", "-DOC_DEBUG", "-DOC_LOG_COMPILE_DEBUG"]
+    flags = [
+        *debug_flags,
+        "-std=c11", "-D_GNU_SOURCE",
+        *guard_pages_flags(guard_pages, "-D"),
+    ]
 
-    bindgen("gles", "src/wasmbind/gles_api.json",
-        wasm3_bindings="src/wasmbind/gles_api_bind_gen.c",
-    )
+    gen_all_bindings(gles=False)
+
+    # compile orca
+    subprocess.run([
+        "gcc", *flags, *includes,
+        "-o", "build/bin/orca_runtime",
+        "src/runtime.c",
+        *libs,
+        "-Wl,-rpath,$ORIGIN",
+    ], check=True)
+
+
+def gen_all_bindings(gles=True):
+    if gles:
+        gles_gen("src/ext/gl.xml",
+            "src/wasmbind/gles_api.json",
+            "src/graphics/orca_gl31.h",
+            log_file='./build/gles_gen.log'
+        )
+
+        bindgen("gles", "src/wasmbind/gles_api.json",
+            wasm3_bindings="src/wasmbind/gles_api_bind_gen.c",
+        )
 
     bindgen("core", "src/wasmbind/core_api.json",
         guest_stubs="src/wasmbind/core_api_stubs.c",
@@ -393,6 +484,12 @@ def gen_all_bindings():
         wasm3_bindings="src/wasmbind/surface_api_bind_gen.c",
     )
 
+    bindgen("font", "src/wasmbind/font_api.json",
+        guest_stubs="src/graphics/orca_font_stubs.c",
+        guest_include="graphics/graphics_common.h",
+        wasm3_bindings="src/wasmbind/font_api_bind_gen.c",
+    )
+
     bindgen("clock", "src/wasmbind/clock_api.json",
         guest_include="platform/platform_clock.h",
         wasm3_bindings="src/wasmbind/clock_api_bind_gen.c",
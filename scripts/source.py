@@ -102,10 +102,11 @@ def cflags(args):
     print()
     print("And the following clang flags are recommended:")
     print("> -g -O2                  (to compile with optimizations and debug info)")
+    print("> -msimd128               (to let clang vectorize your code with WebAssembly SIMD, if your clang supports it)")
     print()
     print("Complete clang example:")
     print()
-    print(f"clang --target=wasm32 --no-standard-libraries -mbulk-memory -g -O2 -D__ORCA__ -Wl,--no-entry -Wl,--export-dynamic -isystem \"{sysinclude}\" -I \"{include}\" -I \"{extinclude}\" \"{orcac}\" \"{libcsource}\" your-main.c")
+    print(f"clang --target=wasm32 --no-standard-libraries -mbulk-memory -msimd128 -g -O2 -D__ORCA__ -Wl,--no-entry -Wl,--export-dynamic -isystem \"{sysinclude}\" -I \"{include}\" -I \"{extinclude}\" \"{orcac}\" \"{libcsource}\" your-main.c")
     print()
     if not path_contains(os.getcwd(), args.srcdir):
         print("If these paths look crazy to you, consider vendoring the source code into your")
@@ -0,0 +1,264 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "orca.h"
+
+//NOTE: measures the packing efficiency of oc_rect_atlas over a few image size distributions, and compares it to a
+//      simple shelf packer. Each distribution is run in three phases:
+//        - fill: allocate until the first failure, and report the occupancy at that point.
+//        - churn: repeatedly recycle a random live rectangle and allocate new ones until the atlas is full again, as
+//          an app loading and unloading images would, and report the steady state occupancy and fragmentation.
+//        - defragment: repack the live rectangles, then allocate until the first failure again.
+//      Usage: example_atlas_bench [atlasSize] [churnIterations]
+
+typedef enum
+{
+    DIST_ICONS,
+    DIST_SPRITES,
+    DIST_THUMBNAILS,
+    DIST_MIXED,
+    DIST_COUNT
+} size_distribution;
+
+const char* distributionNames[DIST_COUNT] = {
+    "icons",
+    "sprites",
+    "thumbnails",
+    "mixed",
+};
+
+typedef struct bench_rng
+{
+    u64 state;
+} bench_rng;
+
+u32 bench_rng_next(bench_rng* rng)
+{
+    rng->state ^= rng->state << 13;
+    rng->state ^= rng->state >> 7;
+    rng->state ^= rng->state << 17;
+    return ((u32)(rng->state >> 32));
+}
+
+i32 bench_rng_range(bench_rng* rng, i32 min, i32 max)
+{
+    return (min + bench_rng_next(rng) % (max - min + 1));
+}
+
+oc_vec2i bench_random_size(bench_rng* rng, size_distribution dist)
+{
+    oc_vec2i size = { 0 };
+    switch(dist)
+    {
+        case DIST_ICONS:
+        {
+            //NOTE: mostly square icons, in power of two sizes or close to them
+            i32 sizes[] = { 16, 24, 32, 48, 64 };
+            i32 s = sizes[bench_rng_next(rng) % oc_array_size(sizes)];
+            size = (oc_vec2i){ s, s - bench_rng_range(rng, 0, 2) };
+        }
+        break;
+
+        case DIST_SPRITES:
+            size = (oc_vec2i){ bench_rng_range(rng, 8, 128), bench_rng_range(rng, 8, 128) };
+            break;
+
+        case DIST_THUMBNAILS:
+        {
+            //NOTE: photos with 4:3 or 16:9 aspect ratios, in portrait or landscape
+            i32 w = bench_rng_range(rng, 64, 256);
+            i32 h = (bench_rng_next(rng) & 1) ? w * 3 / 4 : w * 9 / 16;
+            size = (bench_rng_next(rng) & 1) ? (oc_vec2i){ w, h } : (oc_vec2i){ h, w };
+        }
+        break;
+
+        case DIST_MIXED:
+        {
+            u32 r = bench_rng_next(rng) % 100;
+            if(r < 70)
+            {
+                size = bench_random_size(rng, DIST_ICONS);
+            }
+            else if(r < 95)
+            {
+                size = bench_random_size(rng, DIST_SPRITES);
+            }
+            else
+            {
+                size = (oc_vec2i){ bench_rng_range(rng, 256, 512), bench_rng_range(rng, 256, 512) };
+            }
+        }
+        break;
+
+        default:
+            break;
+    }
+    return (size);
+}
+
+//NOTE: the previous shelf packer, for reference. It can't recycle space.
+typedef struct shelf_atlas
+{
+    oc_vec2i size;
+    oc_vec2i pos;
+    i32 lineHeight;
+    u64 usedArea;
+} shelf_atlas;
+
+bool shelf_atlas_alloc(shelf_atlas* atlas, i32 width, i32 height)
+{
+    if(atlas->pos.x + width >= atlas->size.x)
+    {
+        atlas->pos.x = 0;
+        atlas->pos.y += (atlas->lineHeight + 1);
+        atlas->lineHeight = 0;
+    }
+    if(atlas->pos.x + width < atlas->size.x
+       && atlas->pos.y + height < atlas->size.y)
+    {
+        atlas->pos.x += (width + 1);
+        atlas->lineHeight = oc_max(atlas->lineHeight, height);
+        atlas->usedArea += (u64)width * height;
+        return (true);
+    }
+    return (false);
+}
+
+typedef struct bench_result
+{
+    f32 shelfFill;
+    f32 fill;
+    f64 allocTime;
+    f32 churn;
+    u32 freeRects;
+    f32 defragFill;
+} bench_result;
+
+bench_result bench_distribution(i32 atlasSize, u32 churnIterations, size_distribution dist)
+{
+    bench_result result = { 0 };
+    u64 totalArea = (u64)atlasSize * atlasSize;
+
+    //NOTE: shelf packer fill
+    {
+        bench_rng rng = { 0x9e3779b97f4a7c15ULL + dist };
+        shelf_atlas shelf = { .size = { atlasSize, atlasSize } };
+        while(true)
+        {
+            oc_vec2i size = bench_random_size(&rng, dist);
+            if(!shelf_atlas_alloc(&shelf, size.x, size.y))
+            {
+                break;
+            }
+        }
+        result.shelfFill = (f32)shelf.usedArea / totalArea;
+    }
+
+    oc_arena arena;
+    oc_arena_init(&arena);
+
+    bench_rng rng = { 0x9e3779b97f4a7c15ULL + dist };
+    oc_rect_atlas* atlas = oc_rect_atlas_create(&arena, atlasSize, atlasSize);
+
+    u32 liveCapacity = 1 << 16;
+    oc_rect* live = oc_arena_push_array(&arena, oc_rect, liveCapacity);
+    u32 liveCount = 0;
+
+    //NOTE: fill
+    f64 start = oc_clock_time(OC_CLOCK_MONOTONIC);
+    while(liveCount < liveCapacity)
+    {
+        oc_vec2i size = bench_random_size(&rng, dist);
+        oc_rect rect = oc_rect_atlas_alloc(atlas, size.x, size.y);
+        if(rect.w == 0)
+        {
+            break;
+        }
+        live[liveCount++] = rect;
+    }
+    result.allocTime = liveCount ? (oc_clock_time(OC_CLOCK_MONOTONIC) - start) / liveCount : 0;
+    result.fill = oc_rect_atlas_get_stats(atlas).occupancy;
+
+    //NOTE: churn
+    for(u32 i = 0; i < churnIterations && liveCount; i++)
+    {
+        u32 index = bench_rng_next(&rng) % liveCount;
+        oc_rect_atlas_recycle(atlas, live[index]);
+        live[index] = live[--liveCount];
+
+        //NOTE: keep allocating until we fail, so that the atlas stays full
+        while(liveCount < liveCapacity)
+        {
+            oc_vec2i size = bench_random_size(&rng, dist);
+            oc_rect rect = oc_rect_atlas_alloc(atlas, size.x, size.y);
+            if(rect.w == 0)
+            {
+                break;
+            }
+            live[liveCount++] = rect;
+        }
+    }
+    oc_rect_atlas_stats stats = oc_rect_atlas_get_stats(atlas);
+    result.churn = stats.occupancy;
+    result.freeRects = stats.freeRectCount;
+
+    //NOTE: defragment. The rectangles are only tracked by their position here, so we don't need to update them
+    if(oc_rect_atlas_defragment(atlas, 0, 0))
+    {
+        while(true)
+        {
+            oc_vec2i size = bench_random_size(&rng, dist);
+            oc_rect rect = oc_rect_atlas_alloc(atlas, size.x, size.y);
+            if(rect.w == 0)
+            {
+                break;
+            }
+        }
+    }
+    result.defragFill = oc_rect_atlas_get_stats(atlas).occupancy;
+
+    oc_arena_cleanup(&arena);
+    return (result);
+}
+
+int main(int argc, char** argv)
+{
+    i32 atlasSize = 2048;
+    u32 churnIterations = 20000;
+    if(argc > 1)
+    {
+        atlasSize = oc_max(64, atoi(argv[1]));
+    }
+    if(argc > 2)
+    {
+        churnIterations = atoi(argv[2]);
+    }
+
+    oc_init();
+
+    printf("atlas bench: %ix%i atlas, %u churn iterations\n", atlasSize, atlasSize, churnIterations);
+    printf("%-12s %8s %8s %10s %8s %10s %8s\n", "", "shelf", "fill", "alloc", "churn", "free rects", "defrag");
+
+    for(int dist = 0; dist < DIST_COUNT; dist++)
+    {
+        bench_result result = bench_distribution(atlasSize, churnIterations, dist);
+        printf("%-12s %7.1f%% %7.1f%% %8.2fus %7.1f%% %10u %7.1f%%\n",
+               distributionNames[dist],
+               result.shelfFill * 100,
+               result.fill * 100,
+               result.allocTime * 1e6,
+               result.churn * 100,
+               result.freeRects,
+               result.defragFill * 100);
+    }
+
+    oc_terminate();
+    return (0);
+}
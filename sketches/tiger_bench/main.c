@@ -0,0 +1,167 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#define _USE_MATH_DEFINES //NOTE: necessary for MSVC
+#include <math.h>
+
+#include "orca.h"
+
+#include "../tiger/tiger.c"
+
+//NOTE: draws a grid of tigers for a fixed number of frames and reports the time spent in oc_render(), which covers
+//      the CPU side of the canvas backend (path encoding and command submission), as well as the total frame time.
+//      Usage: example_tiger_bench [frameCount] [gridSize]
+
+enum
+{
+    BENCH_WARMUP_FRAMES = 10,
+};
+
+typedef struct bench_stats
+{
+    f64 min;
+    f64 max;
+    f64 sum;
+    u32 count;
+} bench_stats;
+
+void bench_stats_push(bench_stats* stats, f64 value)
+{
+    if(stats->count == 0)
+    {
+        stats->min = value;
+        stats->max = value;
+    }
+    else
+    {
+        stats->min = oc_min(stats->min, value);
+        stats->max = oc_max(stats->max, value);
+    }
+    stats->sum += value;
+    stats->count++;
+}
+
+void bench_stats_print(const char* name, bench_stats* stats)
+{
+    printf("%-12s avg %8.3f ms, min %8.3f ms, max %8.3f ms\n",
+           name,
+           stats->count ? stats->sum / stats->count * 1000 : 0,
+           stats->min * 1000,
+           stats->max * 1000);
+}
+
+int main(int argc, char** argv)
+{
+    u32 frameCount = 300;
+    u32 gridSize = 4;
+    if(argc > 1)
+    {
+        frameCount = oc_max(1, atoi(argv[1]));
+    }
+    if(argc > 2)
+    {
+        gridSize = oc_max(1, atoi(argv[2]));
+    }
+
+    oc_init();
+
+    oc_rect windowRect = { .x = 100, .y = 100, .w = 810, .h = 610 };
+    oc_window window = oc_window_create(windowRect, OC_STR8("tiger bench"), 0);
+
+    //NOTE: create surface
+    oc_surface surface = oc_surface_create_for_window(window, OC_CANVAS);
+    if(oc_surface_is_nil(surface))
+    {
+        oc_log_error("Couldn't create surface\n");
+        return (-1);
+    }
+    oc_surface_swap_interval(surface, 0);
+
+    oc_canvas canvas = oc_canvas_create();
+    if(oc_canvas_is_nil(canvas))
+    {
+        oc_log_error("Error: couldn't create canvas\n");
+        return (-1);
+    }
+
+    oc_window_bring_to_front(window);
+    oc_window_focus(window);
+
+    bench_stats renderStats = { 0 };
+    bench_stats frameStats = { 0 };
+
+    for(u32 frame = 0; frame < frameCount + BENCH_WARMUP_FRAMES && !oc_should_quit(); frame++)
+    {
+        oc_arena_scope scratch = oc_scratch_begin();
+        f64 startTime = oc_clock_time(OC_CLOCK_MONOTONIC);
+
+        oc_pump_events(0);
+        oc_event* event = 0;
+        while((event = oc_next_event(scratch.arena)) != 0)
+        {
+            if(event->type == OC_EVENT_WINDOW_CLOSE)
+            {
+                oc_request_quit();
+            }
+        }
+
+        oc_surface_select(surface);
+
+        oc_set_color_rgba(1, 0, 1, 1);
+        oc_clear();
+
+        //NOTE: the tiger spans roughly [-130, 130]x[-100, 160] in user space. Lay out a grid of tigers that covers
+        //      the window, and rotate them slightly each frame so that nothing can be reused from one frame to the next
+        oc_vec2 cellSize = { windowRect.w / gridSize, windowRect.h / gridSize };
+        f32 zoom = oc_min(cellSize.x / 260., cellSize.y / 260.);
+
+        for(u32 row = 0; row < gridSize; row++)
+        {
+            for(u32 col = 0; col < gridSize; col++)
+            {
+                f32 angle = 0.01 * (frame + row * gridSize + col);
+                f32 c = cosf(angle) * zoom;
+                f32 s = sinf(angle) * zoom;
+
+                oc_matrix_multiply_push((oc_mat2x3){ c, -s, (col + 0.5) * cellSize.x,
+                                                     s, c, (row + 0.5) * cellSize.y - 30 * zoom });
+                draw_tiger(false, 0);
+                oc_matrix_pop();
+            }
+        }
+
+        f64 renderStart = oc_clock_time(OC_CLOCK_MONOTONIC);
+        oc_render(canvas);
+        f64 renderTime = oc_clock_time(OC_CLOCK_MONOTONIC) - renderStart;
+
+        oc_surface_present(surface);
+
+        oc_scratch_end(scratch);
+
+        f64 frameTime = oc_clock_time(OC_CLOCK_MONOTONIC) - startTime;
+
+        if(frame >= BENCH_WARMUP_FRAMES)
+        {
+            bench_stats_push(&renderStats, renderTime);
+            bench_stats_push(&frameStats, frameTime);
+        }
+    }
+
+    printf("tiger bench: %u frames, %ux%u tigers\n", frameStats.count, gridSize, gridSize);
+    bench_stats_print("oc_render", &renderStats);
+    bench_stats_print("frame", &frameStats);
+
+    oc_canvas_destroy(canvas);
+    oc_surface_destroy(surface);
+    oc_window_destroy(window);
+
+    oc_terminate();
+
+    return (0);
+}
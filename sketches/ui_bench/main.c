@@ -0,0 +1,368 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "orca.h"
+
+//NOTE: ui stress tests, run with no window.
+//        - churn: stresses the lifetime of ui boxes with churning keys, as a list whose item IDs keep changing would.
+//          Each frame builds a window of live rows, then slides it so that some rows disappear and new ones appear.
+//          Pruned boxes should be recycled, so the memory used by the box pool and the box map should level off
+//          instead of growing with the total number of boxes ever created.
+//        - layout: builds a large settings screen and changes a single row per frame, timing the end of the frame
+//          (layout and pruning) separately. Layout cost should follow what changed rather than the size of the tree.
+//        - styling: styles a large tree with a big theme made of tag, text, status and descendant rules. Styling cost
+//          should follow the number of rules that can match each box rather than the total number of rules.
+//        - list: scrolls through a virtualized list. Only visible rows get boxes, so the cost of a frame shouldn't
+//          depend on the number of rows.
+//      Usage: example_ui_bench churn [totalBoxes] [liveBoxes] [churnPerFrame]
+//             example_ui_bench layout [rowCount] [frameCount]
+//             example_ui_bench styling [ruleCount] [rowCount] [frameCount]
+//             example_ui_bench list [rowCount] [frameCount]
+
+u64 bench_arena_used(oc_arena* arena)
+{
+    u64 used = 0;
+    oc_list_for(arena->chunks, chunk, oc_arena_chunk, listElt)
+    {
+        used += chunk->offset;
+    }
+    return (used);
+}
+
+void bench_churn(u32 totalBoxes, u32 liveBoxes, u32 churnPerFrame)
+{
+    oc_ui_context ui;
+    oc_ui_init(&ui);
+
+    u32 frameCount = totalBoxes / churnPerFrame;
+    u32 reportInterval = oc_max(1, frameCount / 10);
+
+    printf("churn: %u boxes created over %u frames, %u live boxes\n", totalBoxes, frameCount, liveBoxes);
+    printf("%8s %10s %10s %12s %12s %10s\n", "frame", "created", "live", "map slots", "pool bytes", "frame");
+
+    oc_vec2 frameSize = { 800, 600 };
+    oc_ui_style defaultStyle = { 0 };
+
+    f64 frameTime = 0;
+    for(u32 frame = 0; frame < frameCount; frame++)
+    {
+        f64 start = oc_clock_time(OC_CLOCK_MONOTONIC);
+
+        oc_ui_frame(frameSize, &defaultStyle, 0)
+        {
+            oc_ui_container("list", 0)
+            {
+                u32 first = frame * churnPerFrame;
+                for(u32 i = 0; i < liveBoxes; i++)
+                {
+                    oc_arena_scope scratch = oc_scratch_begin();
+                    oc_str8 name = oc_str8_pushf(scratch.arena, "item %u", first + i);
+                    oc_ui_box_make_str8(name, 0);
+                    oc_scratch_end(scratch);
+                }
+            }
+        }
+
+        frameTime += oc_clock_time(OC_CLOCK_MONOTONIC) - start;
+
+        if((frame + 1) % reportInterval == 0)
+        {
+            printf("%8u %10u %10llu %12llu %12llu %8.3fms\n",
+                   frame + 1,
+                   frame * churnPerFrame + liveBoxes,
+                   (unsigned long long)ui.boxMap.count,
+                   (unsigned long long)ui.boxMap.capacity,
+                   (unsigned long long)bench_arena_used(&ui.boxPool.arena),
+                   frameTime / reportInterval * 1000);
+            frameTime = 0;
+        }
+    }
+
+    oc_ui_cleanup();
+}
+
+void bench_settings_row(u32 index, f32 valueWidth)
+{
+    oc_arena_scope scratch = oc_scratch_begin();
+
+    oc_ui_style_next(&(oc_ui_style){ .size.width = { OC_UI_SIZE_PARENT, 1 },
+                                     .size.height = { OC_UI_SIZE_CHILDREN },
+                                     .layout.axis = OC_UI_AXIS_X,
+                                     .layout.spacing = 10,
+                                     .layout.margin.x = 8,
+                                     .layout.margin.y = 4,
+                                     .layout.align.y = OC_UI_ALIGN_CENTER },
+                     OC_UI_STYLE_SIZE | OC_UI_STYLE_LAYOUT);
+
+    oc_ui_container_str8(oc_str8_pushf(scratch.arena, "row %u", index), 0)
+    {
+        oc_ui_style_next(&(oc_ui_style){ .size.width = { OC_UI_SIZE_PIXELS, 200 },
+                                         .size.height = { OC_UI_SIZE_PIXELS, 20 } },
+                         OC_UI_STYLE_SIZE);
+        oc_ui_box_make("label", 0);
+
+        oc_ui_style_next(&(oc_ui_style){ .size.width = { OC_UI_SIZE_PARENT, 1, 1 },
+                                         .size.height = { OC_UI_SIZE_PIXELS, 10 } },
+                         OC_UI_STYLE_SIZE);
+        oc_ui_box_make("spacer", 0);
+
+        oc_ui_style_next(&(oc_ui_style){ .size.width = { OC_UI_SIZE_PIXELS, valueWidth },
+                                         .size.height = { OC_UI_SIZE_PIXELS, 24 } },
+                         OC_UI_STYLE_SIZE);
+        oc_ui_box_make("value", 0);
+    }
+
+    oc_scratch_end(scratch);
+}
+
+void bench_layout(u32 rowCount, u32 frameCount)
+{
+    oc_ui_context ui;
+    oc_ui_init(&ui);
+
+    printf("layout: %u rows (%u boxes), %u frames, one row changed per frame\n", rowCount, rowCount * 4, frameCount);
+
+    oc_vec2 frameSize = { 800, 600 };
+    oc_ui_style defaultStyle = { 0 };
+
+    f64 buildTime = 0;
+    f64 endTime = 0;
+    for(u32 frame = 0; frame < frameCount; frame++)
+    {
+        u32 changedRow = (frame * 7919) % rowCount;
+
+        f64 start = oc_clock_time(OC_CLOCK_MONOTONIC);
+
+        oc_ui_begin_frame(frameSize, &defaultStyle, 0);
+        oc_ui_style_next(&(oc_ui_style){ .size.width = { OC_UI_SIZE_PARENT, 1 },
+                                         .size.height = { OC_UI_SIZE_CHILDREN } },
+                         OC_UI_STYLE_SIZE);
+        oc_ui_container("settings", 0)
+        {
+            for(u32 i = 0; i < rowCount; i++)
+            {
+                bench_settings_row(i, (i == changedRow) ? 120 + frame % 40 : 120);
+            }
+        }
+        f64 built = oc_clock_time(OC_CLOCK_MONOTONIC);
+        oc_ui_end_frame();
+        f64 end = oc_clock_time(OC_CLOCK_MONOTONIC);
+
+        //NOTE: the first frame lays out everything
+        if(frame)
+        {
+            buildTime += built - start;
+            endTime += end - built;
+        }
+    }
+
+    u32 timedFrames = oc_max(1, frameCount - 1);
+    printf("build: %.3fms, end frame (layout + pruning): %.3fms\n",
+           buildTime / timedFrames * 1000,
+           endTime / timedFrames * 1000);
+
+    oc_ui_cleanup();
+}
+
+void bench_theme(u32 ruleCount)
+{
+    oc_ui_context* ui = oc_ui_get_context();
+    oc_arena_scope scratch = oc_scratch_begin();
+
+    for(u32 i = 0; i < ruleCount; i++)
+    {
+        oc_ui_pattern pattern = { 0 };
+        oc_ui_style style = { .bgColor = { i / 1000., 0.5, 0.5, 1 },
+                              .borderSize = i % 4 };
+
+        switch(i % 4)
+        {
+            case 0:
+                oc_ui_pattern_push(&ui->frameArena,
+                                   &pattern,
+                                   (oc_ui_selector){ .kind = OC_UI_SEL_TAG,
+                                                     .tag = oc_ui_tag_make_str8(oc_str8_pushf(scratch.arena, "kind %u", i / 4)) });
+                break;
+
+            case 1:
+                oc_ui_pattern_push(&ui->frameArena,
+                                   &pattern,
+                                   (oc_ui_selector){ .kind = OC_UI_SEL_TAG,
+                                                     .tag = oc_ui_tag_make_str8(oc_str8_pushf(scratch.arena, "section %u", i / 4)) });
+                oc_ui_pattern_push(&ui->frameArena,
+                                   &pattern,
+                                   (oc_ui_selector){ .op = OC_UI_SEL_DESCENDANT,
+                                                     .kind = OC_UI_SEL_TAG,
+                                                     .tag = oc_ui_tag_make_str8(oc_str8_pushf(scratch.arena, "kind %u", i / 4)) });
+                break;
+
+            case 2:
+                oc_ui_pattern_push(&ui->frameArena,
+                                   &pattern,
+                                   (oc_ui_selector){ .kind = OC_UI_SEL_TEXT,
+                                                     .text = oc_str8_pushf(&ui->frameArena, "label %u", i / 4) });
+                break;
+
+            case 3:
+                oc_ui_pattern_push(&ui->frameArena,
+                                   &pattern,
+                                   (oc_ui_selector){ .kind = OC_UI_SEL_STATUS, .status = OC_UI_HOVER });
+                oc_ui_pattern_push(&ui->frameArena,
+                                   &pattern,
+                                   (oc_ui_selector){ .op = OC_UI_SEL_AND,
+                                                     .kind = OC_UI_SEL_TAG,
+                                                     .tag = oc_ui_tag_make_str8(oc_str8_pushf(scratch.arena, "kind %u", i / 4)) });
+                break;
+        }
+        oc_ui_style_match_before(pattern, &style, OC_UI_STYLE_BG_COLOR | OC_UI_STYLE_BORDER_SIZE);
+    }
+
+    oc_scratch_end(scratch);
+}
+
+void bench_styling(u32 ruleCount, u32 rowCount, u32 frameCount)
+{
+    oc_ui_context ui;
+    oc_ui_init(&ui);
+
+    u32 sectionSize = 50;
+    u32 kindCount = oc_max(1, ruleCount / 4);
+
+    printf("styling: %u rules, %u rows (%u boxes), %u frames\n", ruleCount, rowCount, rowCount * 3, frameCount);
+
+    oc_vec2 frameSize = { 800, 600 };
+    oc_ui_style defaultStyle = { 0 };
+
+    f64 endTime = 0;
+    for(u32 frame = 0; frame < frameCount; frame++)
+    {
+        oc_ui_begin_frame(frameSize, &defaultStyle, 0);
+
+        bench_theme(ruleCount);
+        oc_ui_container("theme", 0)
+        {
+            for(u32 section = 0; section * sectionSize < rowCount; section++)
+            {
+                oc_arena_scope scratch = oc_scratch_begin();
+
+                oc_ui_tag_next_str8(oc_str8_pushf(scratch.arena, "section %u", section % kindCount));
+                oc_ui_container_str8(oc_str8_pushf(scratch.arena, "section %u", section), 0)
+                {
+                    for(u32 i = section * sectionSize; i < oc_min(rowCount, (section + 1) * sectionSize); i++)
+                    {
+                        oc_ui_tag_next_str8(oc_str8_pushf(scratch.arena, "kind %u", i % kindCount));
+                        oc_ui_container_str8(oc_str8_pushf(scratch.arena, "row %u", i), 0)
+                        {
+                            oc_ui_box_make_str8(oc_str8_pushf(scratch.arena, "label %u", i % (2 * kindCount)), 0);
+                            oc_ui_box_make("value", 0);
+                        }
+                    }
+                }
+
+                oc_scratch_end(scratch);
+            }
+        }
+
+        f64 start = oc_clock_time(OC_CLOCK_MONOTONIC);
+        oc_ui_end_frame();
+        endTime += oc_clock_time(OC_CLOCK_MONOTONIC) - start;
+    }
+
+    printf("end frame (styling + layout): %.3fms\n", endTime / frameCount * 1000);
+
+    oc_ui_cleanup();
+}
+
+void bench_list(u64 rowCount, u32 frameCount)
+{
+    oc_ui_context ui;
+    oc_ui_init(&ui);
+
+    printf("list: %llu rows, %u frames\n", (unsigned long long)rowCount, frameCount);
+
+    oc_vec2 frameSize = { 800, 600 };
+    oc_ui_style defaultStyle = { 0 };
+
+    f64 frameTime = 0;
+    u64 builtRows = 0;
+    for(u32 frame = 0; frame < frameCount; frame++)
+    {
+        f64 start = oc_clock_time(OC_CLOCK_MONOTONIC);
+
+        oc_ui_list_info info = { .rowCount = rowCount, .rowHeight = 20 };
+        oc_ui_frame(frameSize, &defaultStyle, 0)
+        {
+            //NOTE: jump through the list, as dragging the scrollbar would
+            oc_ui_box* panel = oc_ui_box_lookup("list");
+            if(panel)
+            {
+                panel->scroll.y = (f64)frame / frameCount * rowCount * 20;
+            }
+
+            oc_ui_list("list", 0, &info)
+            {
+                for(u64 i = info.firstRow; i < info.endRow; i++)
+                {
+                    oc_arena_scope scratch = oc_scratch_begin();
+
+                    oc_ui_style_next(&(oc_ui_style){ .size.width = { OC_UI_SIZE_PARENT, 1 },
+                                                     .size.height = { OC_UI_SIZE_PIXELS, 20 } },
+                                     OC_UI_STYLE_SIZE);
+                    oc_ui_box_make_str8(oc_str8_pushf(scratch.arena, "row %llu", (unsigned long long)i), 0);
+
+                    oc_scratch_end(scratch);
+                }
+            }
+        }
+        frameTime += oc_clock_time(OC_CLOCK_MONOTONIC) - start;
+        builtRows += info.endRow - info.firstRow;
+    }
+
+    printf("rows built per frame: %.1f, frame: %.3fms\n",
+           (f64)builtRows / frameCount,
+           frameTime / frameCount * 1000);
+
+    oc_ui_cleanup();
+}
+
+int main(int argc, char** argv)
+{
+    oc_init();
+
+    if(argc > 1 && !strcmp(argv[1], "layout"))
+    {
+        u32 rowCount = (argc > 2) ? oc_max(1, atoi(argv[2])) : 2500;
+        u32 frameCount = (argc > 3) ? oc_max(2, atoi(argv[3])) : 200;
+        bench_layout(rowCount, frameCount);
+    }
+    else if(argc > 1 && !strcmp(argv[1], "styling"))
+    {
+        u32 ruleCount = (argc > 2) ? atoi(argv[2]) : 400;
+        u32 rowCount = (argc > 3) ? oc_max(1, atoi(argv[3])) : 2000;
+        u32 frameCount = (argc > 4) ? oc_max(1, atoi(argv[4])) : 50;
+        bench_styling(ruleCount, rowCount, frameCount);
+    }
+    else if(argc > 1 && !strcmp(argv[1], "list"))
+    {
+        u64 rowCount = (argc > 2) ? strtoull(argv[2], 0, 10) : 500000;
+        u32 frameCount = (argc > 3) ? oc_max(1, atoi(argv[3])) : 200;
+        bench_list(rowCount, frameCount);
+    }
+    else
+    {
+        u32 totalBoxes = (argc > 2) ? atoi(argv[2]) : 100000;
+        u32 liveBoxes = (argc > 3) ? oc_max(1, atoi(argv[3])) : 1000;
+        u32 churnPerFrame = (argc > 4) ? oc_max(1, atoi(argv[4])) : 100;
+        bench_churn(totalBoxes, liveBoxes, churnPerFrame);
+    }
+
+    oc_terminate();
+    return (0);
+}
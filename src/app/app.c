@@ -83,10 +83,14 @@ static void oc_init_common()
 {
     oc_init_window_handles();
     oc_ringbuffer_init(&oc_appData.eventQueue, 16);
+    oc_appData.eventMutex = oc_mutex_create();
+    oc_appData.eventAvailable = oc_condition_create();
 }
 
 static void oc_terminate_common()
 {
+    oc_condition_destroy(oc_appData.eventAvailable);
+    oc_mutex_destroy(oc_appData.eventMutex);
     oc_ringbuffer_cleanup(&oc_appData.eventQueue);
 }
 
@@ -132,10 +136,36 @@ void oc_queue_event(oc_event* event)
         else
         {
             oc_ringbuffer_commit(queue);
+
+            oc_mutex_lock(oc_appData.eventMutex);
+            oc_condition_broadcast(oc_appData.eventAvailable);
+            oc_mutex_unlock(oc_appData.eventMutex);
         }
     }
 }
 
+bool oc_wait_event(f64 timeout)
+{
+    oc_ringbuffer* queue = &oc_appData.eventQueue;
+
+    oc_mutex_lock(oc_appData.eventMutex);
+    if(timeout < 0)
+    {
+        while(oc_ringbuffer_read_available(queue) < sizeof(oc_event))
+        {
+            oc_condition_wait(oc_appData.eventAvailable, oc_appData.eventMutex);
+        }
+    }
+    else if(timeout > 0 && oc_ringbuffer_read_available(queue) < sizeof(oc_event))
+    {
+        oc_condition_timedwait(oc_appData.eventAvailable, oc_appData.eventMutex, timeout);
+    }
+    bool available = (oc_ringbuffer_read_available(queue) >= sizeof(oc_event));
+    oc_mutex_unlock(oc_appData.eventMutex);
+
+    return (available);
+}
+
 oc_event* oc_next_event(oc_arena* arena)
 {
     //NOTE: pop and return event from queue
@@ -293,6 +293,10 @@ typedef struct oc_event
 
 } oc_event;
 
+//NOTE: maximum number of events passed to a single oc_on_events() call. The runtime
+//      splits a frame's events across several calls if there are more than that.
+#define OC_EVENT_BATCH_CAPACITY 64
+
 //NOTE: these APIs are not directly available to Orca apps
 #if !defined(OC_PLATFORM_ORCA) || !(OC_PLATFORM_ORCA)
 //--------------------------------------------------------------------
@@ -316,9 +320,14 @@ ORCA_API void oc_set_cursor(oc_mouse_cursor cursor);
 	or the timeout elapses.
 
 	oc_next_event() get the next event from the event queue, allocating from the passed arena
+
+	oc_wait_event() blocks the calling thread until the event queue is not empty, using the same timeout
+	convention as oc_pump_events(), and returns whether an event is available. It's meant for a thread that
+	consumes events while another one pumps them.
 */
 ORCA_API void oc_pump_events(f64 timeout);
 ORCA_API oc_event* oc_next_event(oc_arena* arena);
+ORCA_API bool oc_wait_event(f64 timeout);
 
 ORCA_API oc_key_code oc_scancode_to_keycode(oc_scan_code scanCode);
 
@@ -468,6 +477,11 @@ void oc_window_set_title(oc_str8 title);
 void oc_window_set_size(oc_vec2 size);
 
 void ORCA_IMPORT(oc_request_quit)(void);
+
+//NOTE: apps start out rendering continuously. Once an app calls oc_request_frame(), the runtime switches to on-demand
+//      frames and only calls oc_on_frame_refresh() after input events, or when a frame was requested since the last
+//      refresh. Animations request their next frame from oc_on_frame_refresh().
+void ORCA_IMPORT(oc_request_frame)(void);
 oc_key_code ORCA_IMPORT(oc_scancode_to_keycode)(oc_scan_code scanCode);
 
 void oc_clipboard_set_string(oc_str8 string);
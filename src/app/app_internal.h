@@ -18,6 +18,8 @@
     #include "win32_app.h"
 #elif OC_PLATFORM_MACOS
     #include "osx_app.h"
+#elif OC_PLATFORM_LINUX
+    #include "headless_app.h"
 #else
     #error "platform not supported yet"
 #endif
@@ -67,6 +69,8 @@ typedef struct oc_app
     oc_arena eventArena;
 
     oc_ringbuffer eventQueue;
+    oc_mutex* eventMutex;
+    oc_condition* eventAvailable; // signaled by oc_queue_event(), for consumers blocked in oc_wait_event()
 
     oc_frame_stats frameStats;
 
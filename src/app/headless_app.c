@@ -0,0 +1,533 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "app.c"
+#include "graphics/graphics.h"
+#include "platform/platform_thread.h"
+
+//--------------------------------------------------------------------
+// app management
+//--------------------------------------------------------------------
+
+void oc_init()
+{
+    if(!oc_appData.init)
+    {
+        memset(&oc_appData, 0, sizeof(oc_appData));
+
+        oc_clock_init();
+
+        oc_init_common();
+        memcpy(oc_appData.keyMap, oc_defaultKeyMap, sizeof(oc_key_code) * OC_SCANCODE_COUNT);
+
+        oc_appData.headless.mutex = oc_mutex_create();
+        oc_appData.headless.wakeup = oc_condition_create();
+        oc_arena_init(&oc_appData.headless.clipboardArena);
+
+        oc_vsync_init();
+
+        oc_appData.init = true;
+    }
+}
+
+void oc_terminate()
+{
+    if(oc_appData.init)
+    {
+        oc_arena_cleanup(&oc_appData.headless.clipboardArena);
+        oc_condition_destroy(oc_appData.headless.wakeup);
+        oc_mutex_destroy(oc_appData.headless.mutex);
+
+        oc_terminate_common();
+        oc_appData = (oc_app){ 0 };
+    }
+}
+
+static void oc_headless_wakeup()
+{
+    oc_mutex_lock(oc_appData.headless.mutex);
+    oc_appData.headless.wakeupPending = true;
+    oc_condition_signal(oc_appData.headless.wakeup);
+    oc_mutex_unlock(oc_appData.headless.mutex);
+}
+
+bool oc_should_quit()
+{
+    return (oc_appData.shouldQuit);
+}
+
+void oc_cancel_quit()
+{
+    oc_appData.shouldQuit = false;
+}
+
+void oc_request_quit()
+{
+    oc_appData.shouldQuit = true;
+    oc_headless_wakeup();
+}
+
+void oc_set_cursor(oc_mouse_cursor cursor)
+{
+}
+
+void oc_pump_events(f64 timeout)
+{
+    //NOTE: there are no system events to pump, so this only waits until the timeout elapses or another
+    //      thread wakes us up, e.g. by requesting to quit.
+    oc_mutex_lock(oc_appData.headless.mutex);
+    if(timeout < 0)
+    {
+        while(!oc_appData.headless.wakeupPending)
+        {
+            oc_condition_wait(oc_appData.headless.wakeup, oc_appData.headless.mutex);
+        }
+    }
+    else if(timeout > 0 && !oc_appData.headless.wakeupPending)
+    {
+        oc_condition_timedwait(oc_appData.headless.wakeup, oc_appData.headless.mutex, timeout);
+    }
+    oc_appData.headless.wakeupPending = false;
+    oc_mutex_unlock(oc_appData.headless.mutex);
+}
+
+i32 oc_dispatch_on_main_thread_sync(oc_window main_window, oc_dispatch_proc proc, void* user)
+{
+    //NOTE: headless windows and surfaces aren't tied to the main thread, so we can call proc directly
+    return (proc(user));
+}
+
+//--------------------------------------------------------------------
+// window management
+//--------------------------------------------------------------------
+
+oc_window oc_window_create(oc_rect rect, oc_str8 title, oc_window_style style)
+{
+    oc_window_data* window = oc_window_alloc();
+    if(!window)
+    {
+        return (oc_window_null_handle());
+    }
+    window->style = style;
+    window->shouldClose = false;
+    window->hidden = false;
+    window->minimized = false;
+    window->headless.contentRect = rect;
+    window->headless.focused = false;
+    window->headless.layers = (oc_list){ 0 };
+
+    return (oc_window_handle_from_ptr(window));
+}
+
+void oc_window_destroy(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        oc_window_recycle_ptr(windowData);
+    }
+}
+
+void* oc_window_native_pointer(oc_window window)
+{
+    return (0);
+}
+
+bool oc_window_should_close(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        return (windowData->shouldClose);
+    }
+    else
+    {
+        return (false);
+    }
+}
+
+void oc_window_request_close(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        windowData->shouldClose = true;
+
+        oc_event event = { 0 };
+        event.window = window;
+        event.type = OC_EVENT_WINDOW_CLOSE;
+        oc_queue_event(&event);
+    }
+}
+
+void oc_window_cancel_close(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        windowData->shouldClose = false;
+    }
+}
+
+bool oc_window_is_hidden(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        return (windowData->hidden);
+    }
+    else
+    {
+        return (false);
+    }
+}
+
+void oc_window_hide(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        windowData->hidden = true;
+    }
+}
+
+void oc_window_show(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        windowData->hidden = false;
+    }
+}
+
+void oc_window_set_title(oc_window window, oc_str8 title)
+{
+}
+
+bool oc_window_is_minimized(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        return (windowData->minimized);
+    }
+    else
+    {
+        return (false);
+    }
+}
+
+void oc_window_minimize(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        windowData->minimized = true;
+    }
+}
+
+void oc_window_maximize(oc_window window)
+{
+}
+
+void oc_window_restore(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        windowData->minimized = false;
+    }
+}
+
+bool oc_window_has_focus(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        return (windowData->headless.focused);
+    }
+    else
+    {
+        return (false);
+    }
+}
+
+void oc_window_focus(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        windowData->headless.focused = true;
+    }
+}
+
+void oc_window_unfocus(oc_window window)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        windowData->headless.focused = false;
+    }
+}
+
+void oc_window_send_to_back(oc_window window)
+{
+}
+
+void oc_window_bring_to_front(oc_window window)
+{
+}
+
+//NOTE: headless windows have no decorations, so their frame and content rects are the same
+oc_rect oc_window_get_frame_rect(oc_window window)
+{
+    return (oc_window_get_content_rect(window));
+}
+
+void oc_window_set_frame_rect(oc_window window, oc_rect rect)
+{
+    oc_window_set_content_rect(window, rect);
+}
+
+oc_rect oc_window_get_content_rect(oc_window window)
+{
+    oc_rect rect = { 0 };
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        rect = windowData->headless.contentRect;
+    }
+    return (rect);
+}
+
+void oc_window_set_content_rect(oc_window window, oc_rect rect)
+{
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        oc_rect oldRect = windowData->headless.contentRect;
+        windowData->headless.contentRect = rect;
+
+        if(oldRect.x != rect.x || oldRect.y != rect.y || oldRect.w != rect.w || oldRect.h != rect.h)
+        {
+            oc_event event = { 0 };
+            event.window = window;
+            event.type = (oldRect.w != rect.w || oldRect.h != rect.h) ? OC_EVENT_WINDOW_RESIZE : OC_EVENT_WINDOW_MOVE;
+            event.move.frame = rect;
+            event.move.content = rect;
+            oc_queue_event(&event);
+        }
+    }
+}
+
+void oc_window_center(oc_window window)
+{
+}
+
+oc_rect oc_window_content_rect_for_frame_rect(oc_rect frameRect, oc_window_style style)
+{
+    return (frameRect);
+}
+
+oc_rect oc_window_frame_rect_for_content_rect(oc_rect contentRect, oc_window_style style)
+{
+    return (contentRect);
+}
+
+//--------------------------------------------------------------------------------
+// clipboard functions
+//--------------------------------------------------------------------------------
+
+//NOTE: the headless clipboard is local to the process
+
+void oc_clipboard_clear(void)
+{
+    oc_arena_clear(&oc_appData.headless.clipboardArena);
+    oc_appData.headless.clipboardString = (oc_str8){ 0 };
+}
+
+void oc_clipboard_set_string(oc_str8 string)
+{
+    oc_arena_clear(&oc_appData.headless.clipboardArena);
+    oc_appData.headless.clipboardString = oc_str8_push_copy(&oc_appData.headless.clipboardArena, string);
+}
+
+oc_str8 oc_clipboard_get_string(oc_arena* arena)
+{
+    return (oc_str8_push_copy(arena, oc_appData.headless.clipboardString));
+}
+
+oc_str8 oc_clipboard_copy_string(oc_str8 backing)
+{
+    oc_str8 string = oc_appData.headless.clipboardString;
+    u64 len = backing.len ? oc_min(backing.len - 1, string.len) : 0; //NOTE: leave space for a null terminator
+    if(backing.len)
+    {
+        memcpy(backing.ptr, string.ptr, len);
+        backing.ptr[len] = '\0';
+    }
+    return (oc_str8_slice(backing, 0, len));
+}
+
+//--------------------------------------------------------------------------------
+// headless surfaces
+//--------------------------------------------------------------------------------
+
+#include "graphics/graphics_surface.h"
+
+oc_vec2 oc_headless_surface_contents_scaling(oc_surface_data* surface)
+{
+    return ((oc_vec2){ 1, 1 });
+}
+
+oc_vec2 oc_headless_surface_get_size(oc_surface_data* surface)
+{
+    oc_rect rect = surface->layer.parent->headless.contentRect;
+    return ((oc_vec2){ rect.w, rect.h });
+}
+
+bool oc_headless_surface_get_hidden(oc_surface_data* surface)
+{
+    return (surface->layer.hidden);
+}
+
+void oc_headless_surface_set_hidden(oc_surface_data* surface, bool hidden)
+{
+    surface->layer.hidden = hidden;
+}
+
+void oc_headless_surface_bring_to_front(oc_surface_data* surface)
+{
+    oc_list_remove(&surface->layer.parent->headless.layers, &surface->layer.listElt);
+    oc_list_push(&surface->layer.parent->headless.layers, &surface->layer.listElt);
+}
+
+void oc_headless_surface_send_to_back(oc_surface_data* surface)
+{
+    oc_list_remove(&surface->layer.parent->headless.layers, &surface->layer.listElt);
+    oc_list_push_back(&surface->layer.parent->headless.layers, &surface->layer.listElt);
+}
+
+void* oc_headless_surface_native_layer(oc_surface_data* surface)
+{
+    return (0);
+}
+
+void oc_surface_cleanup(oc_surface_data* surface)
+{
+    oc_list_remove(&surface->layer.parent->headless.layers, &surface->layer.listElt);
+}
+
+void oc_surface_init_for_window(oc_surface_data* surface, oc_window_data* window)
+{
+    surface->contentsScaling = oc_headless_surface_contents_scaling;
+    surface->getSize = oc_headless_surface_get_size;
+    surface->getHidden = oc_headless_surface_get_hidden;
+    surface->setHidden = oc_headless_surface_set_hidden;
+    surface->nativeLayer = oc_headless_surface_native_layer;
+    surface->bringToFront = oc_headless_surface_bring_to_front;
+    surface->sendToBack = oc_headless_surface_send_to_back;
+
+    surface->layer.parent = window;
+    surface->layer.hidden = false;
+    oc_list_append(&window->headless.layers, &surface->layer.listElt);
+}
+
+//--------------------------------------------------------------------
+// vsync
+//--------------------------------------------------------------------
+
+//NOTE: there is no display to sync to, so we simply pace frames at 60Hz
+static const f64 OC_HEADLESS_FRAME_PERIOD = 1. / 60;
+static f64 oc_headlessNextFrameTime = 0;
+
+void oc_vsync_init(void)
+{
+    oc_headlessNextFrameTime = 0;
+}
+
+void oc_vsync_wait(oc_window window)
+{
+    f64 now = oc_clock_time(OC_CLOCK_MONOTONIC);
+    if(oc_headlessNextFrameTime > now)
+    {
+        oc_sleep_nano((u64)((oc_headlessNextFrameTime - now) * 1e9));
+        oc_headlessNextFrameTime += OC_HEADLESS_FRAME_PERIOD;
+    }
+    else
+    {
+        //NOTE: we're late (or it's the first frame), so restart the schedule from now rather than trying to catch up
+        oc_headlessNextFrameTime = now + OC_HEADLESS_FRAME_PERIOD;
+    }
+}
+
+//--------------------------------------------------------------------
+// native open/save/alert windows
+//--------------------------------------------------------------------
+
+oc_file_dialog_result oc_file_dialog_for_table(oc_arena* arena, oc_file_dialog_desc* desc, oc_file_table* table)
+{
+    oc_log_warning("file dialogs are not available in headless mode\n");
+    return ((oc_file_dialog_result){ .button = OC_FILE_DIALOG_CANCEL });
+}
+
+int oc_alert_popup(oc_str8 title,
+                   oc_str8 message,
+                   oc_str8_list options)
+{
+    //NOTE: there is nobody to answer, so just log the alert and pick the first option
+    oc_log_error("%.*s: %.*s\n", oc_str8_ip(title), oc_str8_ip(message));
+    return (0);
+}
+
+//--------------------------------------------------------------------
+// file system stuff... //TODO: move elsewhere
+//--------------------------------------------------------------------
+
+int oc_file_move(oc_str8 from, oc_str8 to)
+{
+    oc_arena_scope scratch = oc_scratch_begin();
+    int result = rename(oc_str8_to_cstring(scratch.arena, from), oc_str8_to_cstring(scratch.arena, to));
+    oc_scratch_end(scratch);
+    return (result ? -1 : 0);
+}
+
+int oc_file_remove(oc_str8 path)
+{
+    oc_arena_scope scratch = oc_scratch_begin();
+    int result = remove(oc_str8_to_cstring(scratch.arena, path));
+    oc_scratch_end(scratch);
+    return (result ? -1 : 0);
+}
+
+int oc_directory_create(oc_str8 path)
+{
+    //NOTE: create intermediate directories too, like the macOS implementation
+    oc_arena_scope scratch = oc_scratch_begin();
+    char* cpath = oc_str8_to_cstring(scratch.arena, path);
+    int result = 0;
+
+    for(char* c = cpath + 1; *c; c++)
+    {
+        if(*c == '/')
+        {
+            *c = '\0';
+            mkdir(cpath, 0755);
+            *c = '/';
+        }
+    }
+    if(mkdir(cpath, 0755) && errno != EEXIST)
+    {
+        result = -1;
+    }
+    oc_scratch_end(scratch);
+    return (result);
+}
@@ -0,0 +1,49 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+#ifndef __HEADLESS_APP_H_
+#define __HEADLESS_APP_H_
+
+#include "app.h"
+#include "platform/platform_thread.h"
+
+//NOTE: the headless app layer has no display connection. Windows are just rectangles, surfaces accept
+//      render commands without drawing them, and the only events are the ones queued by the app layer
+//      itself (e.g. when a window is resized), so that apps can be run and benchmarked without a GPU.
+
+typedef struct oc_headless_window_data
+{
+    oc_rect contentRect;
+    bool focused;
+    oc_list layers;
+} oc_headless_window_data;
+
+typedef struct oc_window_data oc_window_data;
+
+typedef struct oc_layer
+{
+    oc_window_data* parent;
+    oc_list_elt listElt;
+    bool hidden;
+} oc_layer;
+
+#define OC_PLATFORM_WINDOW_DATA oc_headless_window_data headless;
+
+typedef struct oc_headless_app_data
+{
+    oc_mutex* mutex;
+    oc_condition* wakeup;
+    bool wakeupPending;
+
+    oc_arena clipboardArena;
+    oc_str8 clipboardString;
+
+} oc_headless_app_data;
+
+#define OC_PLATFORM_APP_DATA oc_headless_app_data headless;
+
+#endif // __HEADLESS_APP_H_
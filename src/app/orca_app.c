@@ -10,6 +10,9 @@
 //This is used to pass raw events from the runtime
 ORCA_EXPORT oc_event oc_rawEvent;
 
+//This is used to pass a frame's worth of events to oc_on_events()
+ORCA_EXPORT oc_event oc_rawEventBatch[OC_EVENT_BATCH_CAPACITY];
+
 ORCA_EXPORT void* oc_arena_push_stub(oc_arena* arena, u64 size)
 {
     return (oc_arena_push(arena, size));
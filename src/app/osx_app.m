@@ -1123,9 +1123,7 @@ void oc_init()
             oc_update_keyboard_layout();
             oc_install_keyboard_layout_listener();
 
-            oc_init_window_handles();
-
-            oc_ringbuffer_init(&oc_appData.eventQueue, 16);
+            oc_init_common();
 
             [OCApplication sharedApplication];
             OCAppDelegate* delegate = [[OCAppDelegate alloc] init];
@@ -0,0 +1,1080 @@
+//
+//  m3_cache.c
+//
+//  Serialization of compiled code pages.
+//
+//  Code pages are sequences of operation pointers and immediates. Most immediates are
+//  plain numbers (slot offsets, constants) that can be copied verbatim, but some are
+//  pointers into the runtime: operations, other code pages, functions, globals... The
+//  compiler records the location and kind of each of these pointers (see EmitPointer
+//  in m3_compile.c). The serializer uses that log to replace them with indices, and
+//  marks them in a per page bitmap. The loader restores a page in a single pass over
+//  its cached code: words are copied straight from the buffer (typically a mapped
+//  file), and the marked ones are decoded on the way.
+//
+//  Operations are stored as indices into the list of operations the compiler can emit
+//  (GetCompilerOperations), so a cache can't point execution at anything but a known
+//  operation. The list depends on the build, so a cache is only valid for the exact
+//  wasm3 binary that produced it. The cache header records a build id and a hash of
+//  the module bytes, and m3_LoadCompiledModule rejects any mismatch.
+//
+
+#include <stddef.h>
+
+#include "m3_cache.h"
+#include "m3_exception.h"
+#include "m3_math_utils.h"
+
+# if d_m3EnableCodeCache
+
+//---------------------------------------------------------------------------------------------------------------------------------
+
+#define d_m3CodeCacheMagic                  0x4343334d      // 'M3CC'
+#define d_m3CodeCacheVersion                4
+#define d_m3CodeCacheNone                   0xffffffff
+#define d_m3CodeCacheMaxPageLines           (1 << 24)
+
+// a relocated word is stored as its kind in the top bits, and an index below it. c_m3Reloc_pc
+// words hold a page index and a line instead (the page is d_m3CodeCacheNoPage for a null pc).
+#define d_m3CodeCacheKindShift              60
+#define d_m3CodeCachePageShift              32
+#define d_m3CodeCacheNoPage                 0x0fffffff
+#define d_m3CodeCacheIndexMask              0xffffffffULL
+
+enum
+{
+    c_m3CodeCacheComplete               = 1 << 0,   // every function with a body has compiled code in the cache
+};
+
+typedef struct M3CodeCacheHeader
+{
+    u32                     magic;
+    u32                     version;
+    u64                     buildId;
+    u64                     wasmHash;
+
+    u32                     flags;
+    u32                     reserved;
+
+    u32                     numPages;
+    u32                     numFunctions;
+    u32                     numRelocations;         // number of bits set in the relocation bitmap
+    u32                     numConstantBytes;
+}
+M3CodeCacheHeader;
+
+typedef struct M3CodeCachePage
+{
+    u32                     numLines;
+    u32                     lineIndex;
+}
+M3CodeCachePage;
+
+typedef struct M3CodeCacheFunction
+{
+    u32                     page;                   // d_m3CodeCacheNone if the function wasn't compiled
+    u32                     line;
+    u32                     constantsOffset;
+
+    u16                     maxStackSlots;
+    u16                     numRetSlots;
+    u16                     numRetAndArgSlots;
+    u16                     numLocals;
+    u16                     numLocalBytes;
+    u16                     numConstantBytes;
+}
+M3CodeCacheFunction;
+
+// the layout is: header, pages, functions, relocation bitmap, code lines, constants. every section
+// is a multiple of 8 bytes so that a buffer aligned on 8 bytes has all its records aligned. the
+// bitmap has one bit per code line, and each page starts on a new bitmap word.
+typedef struct M3CodeCacheLayout
+{
+    const M3CodeCacheHeader *       header;
+    const M3CodeCachePage *         pages;
+    const M3CodeCacheFunction *     functions;
+    const u64 *                     bitmap;
+    const u8 *                      code;
+    const u8 *                      constants;
+    u64                             size;
+}
+M3CodeCacheLayout;
+
+static inline
+u32  GetPageBitmapWords  (u32 i_numLines)
+{
+    return (i_numLines + 63) / 64;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------
+
+static const u64 c_m3FnvOffsetBasis = 0xcbf29ce484222325ULL;
+static const u64 c_m3FnvPrime = 0x100000001b3ULL;
+
+static inline
+u64  MixWord  (u64 i_hash, u64 i_word)
+{
+    i_hash = (i_hash ^ i_word) * c_m3FnvPrime;
+    return (i_hash << 31) | (i_hash >> 33);
+}
+
+// FNV-style hash over 8 byte words, with four independent lanes so that the multiplications
+// overlap. The whole module is hashed on every load, so hashing it byte by byte would cost more
+// than restoring the code of a large module.
+static
+u64  HashBytes  (u64 i_hash, const void * i_bytes, size_t i_size)
+{
+    const u8 * bytes = (const u8 *) i_bytes;
+    u64 lanes [4] = { i_hash, i_hash + 1, i_hash + 2, i_hash + 3 };
+
+    size_t i = 0;
+    for (; i + 32 <= i_size; i += 32)
+    {
+        for (u32 lane = 0; lane < 4; ++lane)
+        {
+            u64 word;
+            memcpy (& word, bytes + i + lane * 8, sizeof (word));
+            lanes [lane] = MixWord (lanes [lane], word);
+        }
+    }
+
+    u64 hash = MixWord (MixWord (MixWord (lanes [0], lanes [1]), lanes [2]), lanes [3]);
+
+    for (; i < i_size; ++i)
+    {
+        hash ^= bytes [i];
+        hash *= c_m3FnvPrime;
+    }
+
+    return MixWord (hash, i_size);
+}
+
+static
+u64  GetCodeCacheBuildId  (void)
+{
+    static const char c_buildStamp [] = "wasm3 " __DATE__ " " __TIME__;
+
+    u64 hash = HashBytes (c_m3FnvOffsetBasis, c_buildStamp, sizeof (c_buildStamp));
+
+    u32 config [] = { M3_VERSION_MAJOR, M3_VERSION_MINOR, M3_VERSION_REV, sizeof (code_t), sizeof (m3slot_t),
+                      d_m3MaxFunctionSlots, d_m3CodePageAlignSize, d_m3HasFloat, d_m3EnableOpTracing, d_m3EnableStrace,
+                      d_m3EnableSimd, d_m3SkipMemoryBoundsCheck, d_m3EnableJit };
+    hash = HashBytes (hash, config, sizeof (config));
+
+    // the distance between functions of different units changes whenever the binary is relinked
+    i64 layout [] = { (u8 *) GetCodeCacheOperationBase () - (u8 *) CompileFunction,
+                      (u8 *) m3_LoadCompiledModule - (u8 *) CompileFunction };
+    hash = HashBytes (hash, layout, sizeof (layout));
+
+    return hash;
+}
+
+static
+u64  GetModuleHash  (IM3Module i_module)
+{
+    return HashBytes (c_m3FnvOffsetBasis, i_module->wasmStart, i_module->wasmEnd - i_module->wasmStart);
+}
+
+static
+bool  IsImportedFunction  (IM3Function i_function)
+{
+    return (i_function->import.moduleUtf8 or i_function->import.fieldUtf8);
+}
+
+static
+bool  IsModuleFullyCompiled  (IM3Module i_module)
+{
+    for (u32 i = 0; i < i_module->numFunctions; ++i)
+    {
+        IM3Function function = & i_module->functions [i];
+
+        if (function->wasm and not function->compiled)
+            return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------
+
+void  RecordCodeRelocation  (IM3Runtime io_runtime, pc_t i_location, u8 i_kind)
+{
+    if (io_runtime->numCodeRelocations == io_runtime->codeRelocationsCapacity)
+    {
+        if (io_runtime->codeRelocationsOverflow)
+            return;
+
+        u32 capacity = io_runtime->codeRelocationsCapacity ? io_runtime->codeRelocationsCapacity * 2 : 1024;
+        M3CodeRelocation * relocations = m3_ReallocArray (M3CodeRelocation, io_runtime->codeRelocations, capacity, io_runtime->codeRelocationsCapacity);
+
+        if (not relocations)
+        {
+            io_runtime->codeRelocationsOverflow = true;
+            return;
+        }
+
+        io_runtime->codeRelocations = relocations;
+        io_runtime->codeRelocationsCapacity = capacity;
+    }
+
+    M3CodeRelocation * relocation = & io_runtime->codeRelocations [io_runtime->numCodeRelocations++];
+    relocation->location = i_location;
+    relocation->kind = i_kind;
+}
+
+
+void  FreeCodeRelocations  (IM3Runtime io_runtime)
+{
+    m3_Free (io_runtime->codeRelocations);
+    io_runtime->numCodeRelocations = 0;
+    io_runtime->codeRelocationsCapacity = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------
+// serialization
+//---------------------------------------------------------------------------------------------------------------------------------
+
+typedef struct M3PcEntry
+{
+    pc_t                    pc;
+    u32                     index;
+}
+M3PcEntry;
+
+static
+int  ComparePages  (const void * i_a, const void * i_b)
+{
+    uintptr_t a = (uintptr_t) * (IM3CodePage *) i_a;
+    uintptr_t b = (uintptr_t) * (IM3CodePage *) i_b;
+    return (a > b) - (a < b);
+}
+
+static
+int  ComparePcEntries  (const void * i_a, const void * i_b)
+{
+    uintptr_t a = (uintptr_t) ((M3PcEntry *) i_a)->pc;
+    uintptr_t b = (uintptr_t) ((M3PcEntry *) i_b)->pc;
+    return (a > b) - (a < b);
+}
+
+typedef struct M3OperationEntry
+{
+    IM3Operation            operation;
+    u32                     index;
+}
+M3OperationEntry;
+
+static
+int  CompareOperationEntries  (const void * i_a, const void * i_b)
+{
+    uintptr_t a = (uintptr_t) ((M3OperationEntry *) i_a)->operation;
+    uintptr_t b = (uintptr_t) ((M3OperationEntry *) i_b)->operation;
+    return (a > b) - (a < b);
+}
+
+static
+M3Result  AllocCompilerOperations  (IM3Operation ** o_operations, u32 * o_numOperations)
+{
+    M3Result result = m3Err_none;
+
+    u32 numOperations = GetCompilerOperations (NULL, 0);
+
+    * o_operations = m3_AllocArray (IM3Operation, numOperations + 1);
+    _throwifnull (* o_operations);
+
+    * o_numOperations = GetCompilerOperations (* o_operations, numOperations);
+
+    _catch: return result;
+}
+
+static
+bool  FindOperation  (M3OperationEntry * i_entries, u32 i_numEntries, IM3Operation i_operation, u32 * o_index)
+{
+    u32 left = 0;
+    u32 right = i_numEntries;
+
+    while (left < right)
+    {
+        u32 mid = left + (right - left) / 2;
+
+        if ((uintptr_t) i_entries [mid].operation < (uintptr_t) i_operation)
+            left = mid + 1;
+        else
+            right = mid;
+    }
+
+    if (left < i_numEntries and i_entries [left].operation == i_operation)
+    {
+        * o_index = i_entries [left].index;
+        return true;
+    }
+
+    return false;
+}
+
+// finds the page containing i_pc. o_line can be equal to the page line count for a pc that
+// points right past the last emitted word of a page.
+static
+bool  FindPageOfPC  (IM3CodePage * i_pages, u32 i_numPages, const void * i_pc, u32 * o_page, u32 * o_line)
+{
+    u32 left = 0;
+    u32 right = i_numPages;
+
+    while (left < right)
+    {
+        u32 mid = left + (right - left) / 2;
+
+        if ((uintptr_t) GetPageStartPC (i_pages [mid]) <= (uintptr_t) i_pc)
+            left = mid + 1;
+        else
+            right = mid;
+    }
+
+    if (left == 0)
+        return false;
+
+    IM3CodePage page = i_pages [left - 1];
+    uintptr_t offset = (uintptr_t) i_pc - (uintptr_t) GetPageStartPC (page);
+
+    if (offset % sizeof (code_t) or offset / sizeof (code_t) > page->info.numLines)
+        return false;
+
+    * o_page = left - 1;
+    * o_line = (u32) (offset / sizeof (code_t));
+
+    return true;
+}
+
+static
+bool  FindFunctionOfPC  (M3PcEntry * i_entries, u32 i_numEntries, const void * i_pc, u32 * o_index)
+{
+    u32 left = 0;
+    u32 right = i_numEntries;
+
+    while (left < right)
+    {
+        u32 mid = left + (right - left) / 2;
+
+        if ((uintptr_t) i_entries [mid].pc < (uintptr_t) i_pc)
+            left = mid + 1;
+        else
+            right = mid;
+    }
+
+    if (left < i_numEntries and i_entries [left].pc == i_pc)
+    {
+        * o_index = i_entries [left].index;
+        return true;
+    }
+
+    return false;
+}
+
+typedef struct M3CodeCacheWriter
+{
+    IM3CodePage *           pages;                  // runtime pages sorted by address
+    u64 *                   pageCodeOffsets;        // offset of each page in the code section
+    u32                     numPages;
+
+    M3PcEntry *             functionPCs;            // compiled functions sorted by entry pc
+    u32                     numFunctionPCs;
+
+    M3OperationEntry *      operations;             // compiler operations sorted by address
+    u32                     numOperations;
+
+    u32 *                   relocationPages;        // page of each recorded relocation, or d_m3CodeCacheNone
+    u64 *                   pageBitmapOffsets;      // index of the first bitmap word of each page
+
+    u64                     numBitmapWords;
+    u64                     numCodeBytes;
+    u64                     numConstantBytes;
+}
+M3CodeCacheWriter;
+
+static
+M3Result  EncodeRelocation  (const M3CodeCacheWriter * i_writer, IM3Module i_module, const M3CodeRelocation * i_relocation, u64 * o_word)
+{
+    M3Result result = m3Err_none;
+
+    const void * value = * (void **) i_relocation->location;
+
+    u64 kind = i_relocation->kind;
+    u64 index = d_m3CodeCacheNone;
+
+    switch (kind)
+    {
+        case c_m3Reloc_opaque:
+            break;
+
+        case c_m3Reloc_operation:
+        {
+            u32 operation;
+            _throwif ("code cache: unknown operation", not FindOperation (i_writer->operations, i_writer->numOperations, (IM3Operation) value, & operation));
+            index = operation;
+            break;
+        }
+
+        case c_m3Reloc_pc:
+        {
+            u32 page = d_m3CodeCacheNoPage, line = 0;
+            if (value and not FindPageOfPC (i_writer->pages, i_writer->numPages, value, & page, & line))
+                _throw ("code cache: branch target outside of the runtime code pages");
+
+            index = ((u64) page << d_m3CodeCachePageShift) | line;
+            break;
+        }
+
+        case c_m3Reloc_callTarget:
+        case c_m3Reloc_function:
+        {
+            IM3Function function = (IM3Function) value;
+
+            u32 functionIndex;
+
+            if (function >= i_module->functions and function < i_module->functions + i_module->numFunctions)
+            {
+                kind = c_m3Reloc_function;
+                index = (u32) (function - i_module->functions);
+            }
+            else if (kind == c_m3Reloc_callTarget and FindFunctionOfPC (i_writer->functionPCs, i_writer->numFunctionPCs, value, & functionIndex))
+            {
+                // op_Compile was already rewritten to op_Call
+                kind = c_m3Reloc_functionCode;
+                index = functionIndex;
+            }
+            else _throw ("code cache: call to a function outside of the module");
+            break;
+        }
+
+        case c_m3Reloc_module:
+            _throwif ("code cache: reference to another module", value != i_module);
+            break;
+
+        case c_m3Reloc_funcType:
+        {
+            for (u32 i = 0; i < i_module->numFuncTypes; ++i)
+            {
+                if (i_module->funcTypes [i] == value)
+                {
+                    index = i;
+                    break;
+                }
+            }
+            _throwif ("code cache: function type outside of the module", index == d_m3CodeCacheNone);
+            break;
+        }
+
+        case c_m3Reloc_global:
+        {
+            M3Global * global = (M3Global *) ((u8 *) value - offsetof (M3Global, intValue));
+
+            _throwif ("code cache: global outside of the module", global < i_module->globals or global >= i_module->globals + i_module->numGlobals);
+            index = (u32) (global - i_module->globals);
+            break;
+        }
+
+        default:
+            _throw (m3Err_codeCacheMalformed);
+    }
+
+    * o_word = (kind << d_m3CodeCacheKindShift) | index;
+
+    _catch: return result;
+}
+
+
+
+static
+void  FreeCodeCacheWriter  (M3CodeCacheWriter * io_writer)
+{
+    m3_Free (io_writer->relocationPages);
+    m3_Free (io_writer->pageBitmapOffsets);
+    m3_Free (io_writer->operations);
+    m3_Free (io_writer->functionPCs);
+    m3_Free (io_writer->pageCodeOffsets);
+    m3_Free (io_writer->pages);
+}
+
+static
+M3Result  PrepareCodeCacheWriter  (M3CodeCacheWriter * o_writer, IM3Module i_module)
+{
+    M3Result result = m3Err_none;
+
+    IM3Runtime runtime = i_module->runtime;
+    u32 pageIndex = 0;
+
+    // collect and sort the runtime pages so that pointers can be mapped to (page, line) pairs
+    o_writer->numPages = CountCodePages (runtime->pagesOpen) + CountCodePages (runtime->pagesFull);
+
+    o_writer->pages = m3_AllocArray (IM3CodePage, o_writer->numPages + 1);
+    _throwifnull (o_writer->pages);
+
+    o_writer->pageCodeOffsets = m3_AllocArray (u64, o_writer->numPages + 1);
+    _throwifnull (o_writer->pageCodeOffsets);
+
+    o_writer->pageBitmapOffsets = m3_AllocArray (u64, o_writer->numPages + 1);
+    _throwifnull (o_writer->pageBitmapOffsets);
+
+    for (IM3CodePage page = runtime->pagesOpen; page; page = page->info.next)
+        o_writer->pages [pageIndex++] = page;
+    for (IM3CodePage page = runtime->pagesFull; page; page = page->info.next)
+        o_writer->pages [pageIndex++] = page;
+
+    qsort (o_writer->pages, o_writer->numPages, sizeof (IM3CodePage), ComparePages);
+
+    for (u32 i = 0; i < o_writer->numPages; ++i)
+    {
+        o_writer->pageCodeOffsets [i] = o_writer->numCodeBytes;
+        o_writer->numCodeBytes += o_writer->pages [i]->info.lineIndex * sizeof (code_t);
+
+        o_writer->pageBitmapOffsets [i] = o_writer->numBitmapWords;
+        o_writer->numBitmapWords += GetPageBitmapWords (o_writer->pages [i]->info.lineIndex);
+    }
+
+    // compiled functions, including raw function stubs
+    o_writer->functionPCs = m3_AllocArray (M3PcEntry, i_module->numFunctions + 1);
+    _throwifnull (o_writer->functionPCs);
+
+    for (u32 i = 0; i < i_module->numFunctions; ++i)
+    {
+        IM3Function function = & i_module->functions [i];
+
+        if (function->compiled)
+        {
+            o_writer->functionPCs [o_writer->numFunctionPCs].pc = function->compiled;
+            o_writer->functionPCs [o_writer->numFunctionPCs].index = i;
+            ++o_writer->numFunctionPCs;
+        }
+
+        o_writer->numConstantBytes += function->numConstantBytes;
+    }
+
+    qsort (o_writer->functionPCs, o_writer->numFunctionPCs, sizeof (M3PcEntry), ComparePcEntries);
+
+    o_writer->numConstantBytes = (o_writer->numConstantBytes + 7) & ~7ULL;
+
+    // operations are encoded as their index in the compiler's list
+    IM3Operation * operations = NULL;
+_   (AllocCompilerOperations (& operations, & o_writer->numOperations));
+
+    o_writer->operations = m3_AllocArray (M3OperationEntry, o_writer->numOperations + 1);
+    if (o_writer->operations)
+    {
+        for (u32 i = 0; i < o_writer->numOperations; ++i)
+        {
+            o_writer->operations [i].operation = operations [i];
+            o_writer->operations [i].index = i;
+        }
+
+        qsort (o_writer->operations, o_writer->numOperations, sizeof (M3OperationEntry), CompareOperationEntries);
+    }
+
+    m3_Free (operations);
+    _throwifnull (o_writer->operations);
+
+    // relocations recorded in pages that were handed back to the environment are dropped
+    o_writer->relocationPages = m3_AllocArray (u32, runtime->numCodeRelocations + 1);
+    _throwifnull (o_writer->relocationPages);
+
+    for (u32 i = 0; i < runtime->numCodeRelocations; ++i)
+    {
+        u32 page, line;
+        o_writer->relocationPages [i] = d_m3CodeCacheNone;
+
+        if (FindPageOfPC (o_writer->pages, o_writer->numPages, runtime->codeRelocations [i].location, & page, & line)
+            and line < o_writer->pages [page]->info.lineIndex)
+        {
+            o_writer->relocationPages [i] = page;
+        }
+    }
+
+    _catch: return result;
+}
+
+static
+M3Result  WriteCodeCache  (M3CodeCacheWriter * i_writer, IM3Module i_module, u8 * o_buffer, u64 i_size)
+{
+    M3Result result = m3Err_none;
+
+    IM3Runtime runtime = i_module->runtime;
+    u32 constantsOffset = 0;
+
+    memset (o_buffer, 0, i_size);
+
+    M3CodeCacheHeader * header = (M3CodeCacheHeader *) o_buffer;
+    M3CodeCachePage * pageRecords = (M3CodeCachePage *) (header + 1);
+    M3CodeCacheFunction * functions = (M3CodeCacheFunction *) (pageRecords + i_writer->numPages);
+    u64 * bitmap = (u64 *) (functions + i_module->numFunctions);
+    u8 * code = (u8 *) (bitmap + i_writer->numBitmapWords);
+    u8 * constants = code + i_writer->numCodeBytes;
+
+    header->magic = d_m3CodeCacheMagic;
+    header->version = d_m3CodeCacheVersion;
+    header->buildId = GetCodeCacheBuildId ();
+    header->wasmHash = GetModuleHash (i_module);
+    header->flags = IsModuleFullyCompiled (i_module) ? c_m3CodeCacheComplete : 0;
+    header->numPages = i_writer->numPages;
+    header->numFunctions = i_module->numFunctions;
+    header->numConstantBytes = (u32) i_writer->numConstantBytes;
+
+    for (u32 i = 0; i < i_writer->numPages; ++i)
+    {
+        IM3CodePage page = i_writer->pages [i];
+
+        pageRecords [i].numLines = page->info.numLines;
+        pageRecords [i].lineIndex = page->info.lineIndex;
+
+        memcpy (code + i_writer->pageCodeOffsets [i], GetPageStartPC (page), page->info.lineIndex * sizeof (code_t));
+    }
+
+    // the relocated words are replaced by their encoding, so that no host pointer ends up in the cache
+    for (u32 i = 0; i < runtime->numCodeRelocations; ++i)
+    {
+        u32 page = i_writer->relocationPages [i];
+        if (page == d_m3CodeCacheNone)
+            continue;
+
+        const M3CodeRelocation * relocation = & runtime->codeRelocations [i];
+        u32 line = (u32) (relocation->location - GetPageStartPC (i_writer->pages [page]));
+
+        u64 word;
+_       (EncodeRelocation (i_writer, i_module, relocation, & word));
+
+        memcpy (code + i_writer->pageCodeOffsets [page] + line * sizeof (code_t), & word, sizeof (word));
+        bitmap [i_writer->pageBitmapOffsets [page] + line / 64] |= 1ULL << (line % 64);
+    }
+
+    for (u64 i = 0; i < i_writer->numBitmapWords; ++i)
+        header->numRelocations += __builtin_popcountll (bitmap [i]);
+
+    for (u32 i = 0; i < i_module->numFunctions; ++i)
+    {
+        IM3Function function = & i_module->functions [i];
+        M3CodeCacheFunction * record = & functions [i];
+
+        record->page = d_m3CodeCacheNone;
+
+        if (function->compiled and not IsImportedFunction (function))
+        {
+            _throwif ("code cache: function code outside of the runtime code pages",
+                      not FindPageOfPC (i_writer->pages, i_writer->numPages, function->compiled, & record->page, & record->line));
+
+            record->maxStackSlots = function->maxStackSlots;
+            record->numRetSlots = function->numRetSlots;
+            record->numRetAndArgSlots = function->numRetAndArgSlots;
+            record->numLocals = function->numLocals;
+            record->numLocalBytes = function->numLocalBytes;
+            record->numConstantBytes = function->numConstantBytes;
+            record->constantsOffset = constantsOffset;
+
+            if (function->numConstantBytes)
+                memcpy (constants + constantsOffset, function->constants, function->numConstantBytes);
+
+            constantsOffset += function->numConstantBytes;
+        }
+    }
+
+    _catch: return result;
+}
+
+
+M3Result  m3_SerializeCompiledModule  (IM3Module i_module, uint8_t * o_buffer, uint32_t i_bufferSize, uint32_t * o_size)
+{
+    M3Result result = m3Err_none;
+
+    M3CodeCacheWriter writer = { 0 };
+    u64 size = 0;
+
+    IM3Runtime runtime = i_module->runtime;
+
+    _throwif ("code cache: module isn't loaded", not runtime);
+    _throwif ("code cache: relocations need 64-bit code words", sizeof (code_t) != sizeof (u64));
+    _throwif ("code cache: module is being compiled", runtime->numActiveCodePages);
+    _throwif (m3Err_mallocFailed, runtime->codeRelocationsOverflow);
+#   if d_m3RecordBacktraces
+    _throw ("code cache: backtrace mappings can't be serialized");
+#   endif
+
+_   (PrepareCodeCacheWriter (& writer, i_module));
+
+    size = sizeof (M3CodeCacheHeader)
+         + writer.numPages * sizeof (M3CodeCachePage)
+         + i_module->numFunctions * sizeof (M3CodeCacheFunction)
+         + writer.numBitmapWords * sizeof (u64)
+         + writer.numCodeBytes
+         + writer.numConstantBytes;
+
+    _throwif (m3Err_mallocFailed, size > UINT32_MAX);
+
+    * o_size = (u32) size;
+
+    if (o_buffer)
+    {
+        _throwif (m3Err_codeCacheBufferTooSmall, i_bufferSize < size);
+_       (WriteCodeCache (& writer, i_module, o_buffer, size));
+    }
+
+    _catch:
+
+    FreeCodeCacheWriter (& writer);
+
+    return result;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------
+// loading
+//---------------------------------------------------------------------------------------------------------------------------------
+
+static
+M3Result  ParseCodeCacheLayout  (M3CodeCacheLayout * o_layout, IM3Module i_module, const u8 * i_buffer, u32 i_bufferSize)
+{
+    M3Result result = m3Err_none;
+
+    const M3CodeCacheHeader * header = (const M3CodeCacheHeader *) i_buffer;
+    u64 offset = sizeof (M3CodeCacheHeader);
+    u64 numBitmapWords = 0;
+    u64 numCodeBytes = 0;
+
+    _throwif (m3Err_codeCacheMalformed, ((uintptr_t) i_buffer & 7) or i_bufferSize < sizeof (M3CodeCacheHeader));
+
+    _throwif (m3Err_codeCacheMalformed, header->magic != d_m3CodeCacheMagic);
+    _throwif (m3Err_codeCacheStale, header->version != d_m3CodeCacheVersion);
+    _throwif (m3Err_codeCacheStale, header->buildId != GetCodeCacheBuildId ());
+    _throwif (m3Err_codeCacheStale, header->wasmHash != GetModuleHash (i_module));
+    _throwif (m3Err_codeCacheStale, header->numFunctions != i_module->numFunctions);
+    _throwif (m3Err_codeCacheMalformed, header->flags & ~c_m3CodeCacheComplete);
+
+    o_layout->header = header;
+
+    o_layout->pages = (const M3CodeCachePage *) (i_buffer + offset);
+    offset += (u64) header->numPages * sizeof (M3CodeCachePage);
+
+    o_layout->functions = (const M3CodeCacheFunction *) (i_buffer + offset);
+    offset += (u64) header->numFunctions * sizeof (M3CodeCacheFunction);
+
+    _throwif (m3Err_codeCacheMalformed, offset > i_bufferSize);
+
+    for (u32 i = 0; i < header->numPages; ++i)
+    {
+        const M3CodeCachePage * page = & o_layout->pages [i];
+        _throwif (m3Err_codeCacheMalformed, page->lineIndex > page->numLines or page->numLines > d_m3CodeCacheMaxPageLines);
+
+        numBitmapWords += GetPageBitmapWords (page->lineIndex);
+        numCodeBytes += (u64) page->lineIndex * sizeof (code_t);
+    }
+
+    o_layout->bitmap = (const u64 *) (i_buffer + offset);
+    offset += numBitmapWords * sizeof (u64);
+
+    o_layout->code = i_buffer + offset;
+    offset += numCodeBytes;
+
+    o_layout->constants = i_buffer + offset;
+    offset += header->numConstantBytes;
+
+    _throwif (m3Err_codeCacheMalformed, offset != i_bufferSize);
+    o_layout->size = offset;
+
+    // functions
+    for (u32 i = 0; i < header->numFunctions; ++i)
+    {
+        const M3CodeCacheFunction * record = & o_layout->functions [i];
+
+        if (record->page != d_m3CodeCacheNone)
+        {
+            _throwif (m3Err_codeCacheMalformed, record->page >= header->numPages);
+            _throwif (m3Err_codeCacheMalformed, record->line >= o_layout->pages [record->page].lineIndex);
+            _throwif (m3Err_codeCacheMalformed, (u64) record->constantsOffset + record->numConstantBytes > header->numConstantBytes);
+            _throwif (m3Err_codeCacheMalformed, IsImportedFunction (& i_module->functions [i]));
+        }
+        else if (header->flags & c_m3CodeCacheComplete)
+        {
+            _throwif (m3Err_codeCacheMalformed, i_module->functions [i].wasm);
+        }
+    }
+
+    _catch: return result;
+}
+
+
+// the function entry points have to be restored first, since functionCode relocations resolve to them
+static
+M3Result  DecodeRelocation  (u64 i_word, IM3Module i_module, const M3CodeCacheLayout * i_layout, IM3CodePage * i_pages,
+                             IM3Operation * i_operations, u32 i_numOperations, const void ** o_value, u8 * o_kind)
+{
+    M3Result result = m3Err_none;
+
+    u32 kind = (u32) (i_word >> d_m3CodeCacheKindShift);
+    u64 index = i_word & ~(0xfULL << d_m3CodeCacheKindShift);
+
+    const void * value = NULL;
+
+    switch (kind)
+    {
+        case c_m3Reloc_opaque:
+            _throwif (m3Err_codeCacheMalformed, index != d_m3CodeCacheNone);
+            break;
+
+        case c_m3Reloc_module:
+            _throwif (m3Err_codeCacheMalformed, index != d_m3CodeCacheNone);
+            value = i_module;
+            break;
+
+        case c_m3Reloc_operation:
+            _throwif (m3Err_codeCacheMalformed, index >= i_numOperations);
+            value = i_operations [index];
+            break;
+
+        case c_m3Reloc_pc:
+        {
+            u32 page = (u32) (index >> d_m3CodeCachePageShift);
+            u32 line = (u32) (index & d_m3CodeCacheIndexMask);
+
+            if (page != d_m3CodeCacheNoPage)
+            {
+                _throwif (m3Err_codeCacheMalformed, page >= i_layout->header->numPages);
+                _throwif (m3Err_codeCacheMalformed, line > i_layout->pages [page].numLines);
+                value = GetPageStartPC (i_pages [page]) + line;
+            }
+            else _throwif (m3Err_codeCacheMalformed, line);
+            break;
+        }
+
+        case c_m3Reloc_function:
+            _throwif (m3Err_codeCacheMalformed, index >= i_module->numFunctions);
+            value = & i_module->functions [index];
+            break;
+
+        case c_m3Reloc_functionCode:
+        {
+            _throwif (m3Err_codeCacheMalformed, index >= i_module->numFunctions);
+
+            IM3Function function = & i_module->functions [index];
+            if (not function->compiled)
+            {
+                if (IsImportedFunction (function))
+                    _throw (ErrorModule (m3Err_functionImportMissing, i_module, "'%s.%s'",
+                                         GetFunctionImportModuleName (function), m3_GetFunctionName (function)));
+
+                _throw (m3Err_codeCacheMalformed);
+            }
+
+            value = function->compiled;
+            kind = c_m3Reloc_callTarget;
+            break;
+        }
+
+        case c_m3Reloc_funcType:
+            _throwif (m3Err_codeCacheMalformed, index >= i_module->numFuncTypes);
+            value = i_module->funcTypes [index];
+            break;
+
+        case c_m3Reloc_global:
+            _throwif (m3Err_codeCacheMalformed, index >= i_module->numGlobals);
+            value = & i_module->globals [index].intValue;
+            break;
+
+        default:
+            _throw (m3Err_codeCacheMalformed);
+    }
+
+    * o_value = value;
+    * o_kind = (u8) kind;
+
+    _catch: return result;
+}
+
+
+M3Result  m3_LoadCompiledModule  (IM3Module io_module, const uint8_t * i_buffer, uint32_t i_bufferSize)
+{
+    M3Result result = m3Err_none;
+
+    IM3CodePage * pages = NULL;
+    u32 numAllocatedPages = 0;
+    u32 numRestoredFunctions = 0;
+
+    M3CodeCacheLayout layout = { 0 };
+    const M3CodeCacheHeader * header = NULL;
+    IM3Operation * operations = NULL;
+    u32 numOperations = 0;
+    u32 numRecordedRelocations = 0;
+
+    IM3Runtime runtime = io_module->runtime;
+    _throwif ("code cache: module isn't loaded", not runtime);
+    _throwif ("code cache: relocations need 64-bit code words", sizeof (code_t) != sizeof (u64));
+#   if d_m3RecordBacktraces
+    _throw ("code cache: backtrace mappings can't be restored");
+#   endif
+
+    numRecordedRelocations = runtime->numCodeRelocations;
+
+_   (ParseCodeCacheLayout (& layout, io_module, i_buffer, i_bufferSize));
+_   (AllocCompilerOperations (& operations, & numOperations));
+
+    header = layout.header;
+
+    pages = m3_AllocArray (IM3CodePage, header->numPages ? header->numPages : 1);
+    _throwifnull (pages);
+
+    for (u32 i = 0; i < header->numPages; ++i)
+    {
+        IM3CodePage page = NewCodePage (runtime, layout.pages [i].numLines);
+        _throwifnull (page);
+
+        pages [numAllocatedPages++] = page;
+    }
+
+    // restore the functions. this comes before the code, whose relocations can reference their entry points
+    for (u32 i = 0; i < header->numFunctions; ++i)
+    {
+        const M3CodeCacheFunction * record = & layout.functions [i];
+        IM3Function function = & io_module->functions [i];
+
+        if (record->page == d_m3CodeCacheNone or function->compiled)
+            continue;
+
+        if (record->numConstantBytes)
+        {
+            function->constants = m3_CopyMem (layout.constants + record->constantsOffset, record->numConstantBytes);
+            _throwifnull (function->constants);
+        }
+
+        function->compiled = GetPageStartPC (pages [record->page]) + record->line;
+        function->maxStackSlots = record->maxStackSlots;
+        function->numRetSlots = record->numRetSlots;
+        function->numRetAndArgSlots = record->numRetAndArgSlots;
+        function->numLocals = record->numLocals;
+        function->numLocalBytes = record->numLocalBytes;
+        function->numConstantBytes = record->numConstantBytes;
+
+        numRestoredFunctions = i + 1;
+    }
+
+    // grow the relocation log once, instead of doubling it while restoring
+    if (runtime->codeRelocationsCapacity - runtime->numCodeRelocations < header->numRelocations and not runtime->codeRelocationsOverflow)
+    {
+        u32 capacity = runtime->numCodeRelocations + header->numRelocations;
+        M3CodeRelocation * relocations = m3_ReallocArray (M3CodeRelocation, runtime->codeRelocations, capacity, runtime->codeRelocationsCapacity);
+
+        if (relocations)
+        {
+            runtime->codeRelocations = relocations;
+            runtime->codeRelocationsCapacity = capacity;
+        }
+    }
+
+    // copy the code in one pass, 64 lines at a time, and patch the lines flagged in the relocation bitmap
+    const u64 * bitmap = layout.bitmap;
+    const u8 * code = layout.code;
+    u32 numRelocations = 0;
+
+    for (u32 i = 0; i < header->numPages; ++i)
+    {
+        u32 numLines = layout.pages [i].lineIndex;
+        code_t * lines = (code_t *) GetPageStartPC (pages [i]);
+
+        memcpy (lines, code, numLines * sizeof (code_t));
+        pages [i]->info.lineIndex = numLines;
+
+        for (u32 block = 0; block < numLines; block += 64)
+        {
+            u64 bits = * bitmap++;
+
+            while (bits)
+            {
+                u32 line = block + __builtin_ctzll (bits);
+                bits &= bits - 1;
+
+                _throwif (m3Err_codeCacheMalformed, line >= numLines);
+
+                const void * value;
+                u8 kind;
+_               (DecodeRelocation ((u64) lines [line], io_module, & layout, pages, operations, numOperations, & value, & kind));
+
+                * (const void **) (lines + line) = value;
+
+                // keep the log up to date so that the restored module can be serialized again
+                RecordCodeRelocation (runtime, lines + line, kind);
+                ++numRelocations;
+            }
+        }
+
+        code += numLines * sizeof (code_t);
+    }
+
+    _throwif (m3Err_codeCacheMalformed, numRelocations != header->numRelocations);
+
+    // hand the pages over to the runtime
+    for (u32 i = 0; i < numAllocatedPages; ++i)
+    {
+        runtime->numCodePages++;
+        runtime->numActiveCodePages++;
+        ReleaseCodePage (runtime, pages [i]);
+    }
+    numAllocatedPages = 0;
+
+    _catch:
+
+    if (result)
+    {
+        if (runtime and runtime->numCodeRelocations > numRecordedRelocations)
+            runtime->numCodeRelocations = numRecordedRelocations;
+
+        for (u32 i = 0; i < numRestoredFunctions; ++i)
+        {
+            const M3CodeCacheFunction * record = & layout.functions [i];
+            IM3Function function = & io_module->functions [i];
+
+            if (record->page != d_m3CodeCacheNone and function->compiled >= GetPageStartPC (pages [record->page])
+                and function->compiled < GetPageStartPC (pages [record->page]) + pages [record->page]->info.numLines)
+            {
+                function->compiled = NULL;
+                m3_Free (function->constants);
+                function->numConstantBytes = 0;
+            }
+        }
+
+        for (u32 i = 0; i < numAllocatedPages; ++i)
+            m3_Free (pages [i]);
+    }
+
+    m3_Free (pages);
+    m3_Free (operations);
+
+    return result;
+}
+
+
+M3Result  m3_GetCompiledModuleInfo  (const uint8_t * i_buffer, uint32_t i_bufferSize, int * o_isComplete)
+{
+    M3Result result = m3Err_none;
+
+    const M3CodeCacheHeader * header = (const M3CodeCacheHeader *) i_buffer;
+
+    _throwif (m3Err_codeCacheMalformed, ((uintptr_t) i_buffer & 7) or i_bufferSize < sizeof (M3CodeCacheHeader));
+    _throwif (m3Err_codeCacheMalformed, header->magic != d_m3CodeCacheMagic);
+    _throwif (m3Err_codeCacheStale, header->version != d_m3CodeCacheVersion);
+
+    * o_isComplete = (header->flags & c_m3CodeCacheComplete) != 0;
+
+    _catch: return result;
+}
+
+# else // d_m3EnableCodeCache
+
+M3Result  m3_SerializeCompiledModule  (IM3Module i_module, uint8_t * o_buffer, uint32_t i_bufferSize, uint32_t * o_size)
+{
+    return m3Err_codeCacheDisabled;
+}
+
+M3Result  m3_LoadCompiledModule  (IM3Module io_module, const uint8_t * i_buffer, uint32_t i_bufferSize)
+{
+    return m3Err_codeCacheDisabled;
+}
+
+M3Result  m3_GetCompiledModuleInfo  (const uint8_t * i_buffer, uint32_t i_bufferSize, int * o_isComplete)
+{
+    return m3Err_codeCacheDisabled;
+}
+
+# endif // d_m3EnableCodeCache
@@ -0,0 +1,51 @@
+//
+//  m3_cache.h
+//
+//  Serialization of compiled code pages, so that a module can skip compilation
+//  when it is loaded again by the same wasm3 build.
+//
+
+#ifndef m3_cache_h
+#define m3_cache_h
+
+#include "m3_env.h"
+#include "m3_exec_defs.h"
+
+d_m3BeginExternC
+
+// Every pointer-sized word emitted in a code page that can't be copied verbatim
+// is tagged with one of these kinds. The tag tells the serializer how to turn the
+// current value of the word into something position independent.
+enum
+{
+    c_m3Reloc_opaque            = 0,    // host specific (raw function stubs); written out as zero
+    c_m3Reloc_operation,                // IM3Operation, stored as an index into GetCompilerOperations
+    c_m3Reloc_pc,                       // pc_t inside one of the runtime's code pages
+    c_m3Reloc_function,                 // IM3Function
+    c_m3Reloc_callTarget,               // op_Compile/op_Call operand: IM3Function, or function->compiled once rewritten
+    c_m3Reloc_functionCode,             // serialized form of a compiled call target: index of the function
+    c_m3Reloc_module,                   // IM3Module
+    c_m3Reloc_funcType,                 // IM3FuncType, stored as a module type index
+    c_m3Reloc_global,                   // & M3Global.intValue
+
+    c_m3Reloc_count
+};
+
+# if d_m3EnableCodeCache
+
+void            RecordCodeRelocation        (IM3Runtime io_runtime, pc_t i_location, u8 i_kind);
+void            FreeCodeRelocations         (IM3Runtime io_runtime);
+
+IM3Operation    GetCodeCacheOperationBase   (void);
+u32             GetCompilerOperations       (IM3Operation * o_operations, u32 i_capacity);
+
+# else
+
+static inline void RecordCodeRelocation     (IM3Runtime io_runtime, pc_t i_location, u8 i_kind) {}
+static inline void FreeCodeRelocations      (IM3Runtime io_runtime) {}
+
+# endif // d_m3EnableCodeCache
+
+d_m3EndExternC
+
+#endif // m3_cache_h
@@ -53,6 +53,14 @@ void                    dump_code_page            (IM3CodePage i_codePage, pc_t
 
 #define EmitWord(page, val) EmitWord_impl(page, (void*)(val))
 
+// location of a code word that needs patching when the page is restored from a code cache (see m3_cache.h)
+typedef struct M3CodeRelocation
+{
+    pc_t                    location;
+    u8                      kind;
+}
+M3CodeRelocation;
+
 //---------------------------------------------------------------------------------------------------------------------------------
 
 # if d_m3RecordBacktraces
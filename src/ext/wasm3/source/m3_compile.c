@@ -13,6 +13,7 @@
 #include "m3_exec.h"
 #include "m3_exception.h"
 #include "m3_info.h"
+#include "m3_cache.h"
 
 //----- EMIT --------------------------------------------------------------------------------------------------------------
 
@@ -38,7 +39,9 @@ M3Result  EnsureCodePageNumLines  (IM3Compilation o, u32 i_numLines)
             m3log (emit, "bridging new code page from: %d %p (free slots: %d) to: %d", o->page->info.sequence, GetPC (o), NumFreeLines (o->page), page->info.sequence);
             d_m3Assert (NumFreeLines (o->page) >= 2);
 
+            RecordCodeRelocation (o->runtime, GetPC (o), c_m3Reloc_operation);
             EmitWord (o->page, op_Branch);
+            RecordCodeRelocation (o->runtime, GetPC (o), c_m3Reloc_pc);
             EmitWord (o->page, GetPagePC (page));
 
             ReleaseCodePage (o->runtime, o->page);
@@ -72,6 +75,7 @@ M3Result  EmitOp  (IM3Compilation o, IM3Operation i_operation)
 # if d_m3RecordBacktraces
             EmitMappingEntry (o->page, o->lastOpcodeStart - o->module->wasmStart);
 # endif // d_m3RecordBacktraces
+            RecordCodeRelocation (o->runtime, GetPC (o), c_m3Reloc_operation);
             EmitWord (o->page, i_operation);
         }
     }
@@ -94,22 +98,27 @@ void  EmitSlotOffset  (IM3Compilation o, const i32 i_offset)
         EmitWord32 (o->page, i_offset);
 }
 
+// i_relocationKind tells the code cache how to rebuild the pointer when the page is reloaded (see m3_cache.h)
 static M3_NOINLINE
-pc_t  EmitPointer  (IM3Compilation o, const void * const i_pointer)
+pc_t  EmitPointer  (IM3Compilation o, const void * const i_pointer, u8 i_relocationKind)
 {
     pc_t ptr = GetPagePC (o->page);
 
     if (o->page)
+    {
+        RecordCodeRelocation (o->runtime, ptr, i_relocationKind);
         EmitWord (o->page, i_pointer);
+    }
 
     return ptr;
 }
 
+// reserved pointers are always patched with a pc
 static M3_NOINLINE
 void * ReservePointer (IM3Compilation o)
 {
     pc_t ptr = GetPagePC (o->page);
-    EmitPointer (o, NULL);
+    EmitPointer (o, NULL, c_m3Reloc_pc);
     return (void *) ptr;
 }
 
@@ -123,6 +132,7 @@ void * ReservePointer (IM3Compilation o)
 #define i_64    c_m3Type_i64
 #define f_32    c_m3Type_f32
 #define f_64    c_m3Type_f64
+#define v_128   c_m3Type_v128
 #define none    c_m3Type_none
 #define any     (u8)-1
 
@@ -194,6 +204,11 @@ void  ReleaseCompilationCodePage  (IM3Compilation o)
 static inline
 u16 GetTypeNumSlots (u8 i_type)
 {
+#   if d_m3EnableSimd
+    if (i_type == c_m3Type_v128)
+        return sizeof (m3v128_t) / sizeof (m3slot_t);
+#   endif
+
 #   if d_m3Use32BitSlots
         return Is64BitType (i_type) ? 2 : 1;
 #   else
@@ -201,6 +216,35 @@ u16 GetTypeNumSlots (u8 i_type)
 #   endif
 }
 
+// the number of slots an arg or return value of this type occupies in a call frame
+static inline
+u16 GetTypeNumIoSlots (u8 i_type)
+{
+    return M3_MAX (c_ioSlotCount, GetTypeNumSlots (i_type));
+}
+
+static
+u16  GetFuncTypeNumParamSlots  (IM3FuncType i_type)
+{
+    u16 numSlots = 0;
+
+    for (u16 i = 0; i < GetFuncTypeNumParams (i_type); ++i)
+        numSlots += GetTypeNumIoSlots (GetFuncTypeParamType (i_type, i));
+
+    return numSlots;
+}
+
+static
+u16  GetFuncTypeNumResultSlots  (IM3FuncType i_type)
+{
+    u16 numSlots = 0;
+
+    for (u16 i = 0; i < GetFuncTypeNumResults (i_type); ++i)
+        numSlots += GetTypeNumIoSlots (GetFuncTypeResultType (i_type, i));
+
+    return numSlots;
+}
+
 static inline
 void  AlignSlotToType  (u16 * io_slot, u8 i_type)
 {
@@ -364,11 +408,15 @@ M3Result  AllocateSlotsWithinRange  (IM3Compilation o, u16 * o_slot, u8 i_type,
 
     AlignSlotToType (& i_startSlot, i_type);
 
-    // search for 1 or 2 consecutive slots in the execution stack
+    // search for 1, 2 (or 4, for a v128) consecutive slots in the execution stack
     u16 i = i_startSlot;
     while (i + searchOffset < i_endSlot)
     {
-        if (o->m3Slots [i] == 0 and o->m3Slots [i + searchOffset] == 0)
+        bool isFree = true;
+        for (u16 j = 0; j < numSlots; ++j)
+            isFree = isFree and (o->m3Slots [i + j] == 0);
+
+        if (isFree)
         {
             MarkSlotsAllocated (o, i, numSlots);
 
@@ -830,6 +878,28 @@ void  PatchBranches  (IM3Compilation o)
 
 //-------------------------------------------------------------------------------------------------------------------------
 
+static inline
+IM3Operation  GetCopySlotOp  (u8 i_type)
+{
+#   if d_m3EnableSimd
+    if (i_type == c_m3Type_v128)
+        return op_CopySlot_128;
+#   endif
+
+    return Is64BitType (i_type) ? op_CopySlot_64 : op_CopySlot_32;
+}
+
+static inline
+IM3Operation  GetPreserveCopySlotOp  (u8 i_type)
+{
+#   if d_m3EnableSimd
+    if (i_type == c_m3Type_v128)
+        return op_PreserveCopySlot_128;
+#   endif
+
+    return Is64BitType (i_type) ? op_PreserveCopySlot_64 : op_PreserveCopySlot_32;
+}
+
 static
 M3Result  CopyStackIndexToSlot  (IM3Compilation o, u16 i_destSlot, u16 i_stackIndex)  // NoPushPop
 {
@@ -844,7 +914,7 @@ M3Result  CopyStackIndexToSlot  (IM3Compilation o, u16 i_destSlot, u16 i_stackIn
     {
         op = c_setSetOps [type];
     }
-    else op = Is64BitType (type) ? op_CopySlot_64 : op_CopySlot_32;
+    else op = GetCopySlotOp (type);
 
 _   (EmitOp (o, op));
     EmitSlotOffset (o, i_destSlot);
@@ -889,7 +959,7 @@ M3Result  PreservedCopyTopSlot  (IM3Compilation o, u16 i_destSlot, u16 i_preserv
     {
         op = c_preserveSetSlot [type];
     }
-    else op = Is64BitType (type) ? op_PreserveCopySlot_64 : op_PreserveCopySlot_32;
+    else op = GetPreserveCopySlotOp (type);
 
 _   (EmitOp (o, op));
     EmitSlotOffset (o, i_destSlot);
@@ -1015,15 +1085,17 @@ M3Result  CopyStackSlotsR  (IM3Compilation o, u16 i_targetSlotStackIndex, u16 i_
                 u16 otherSlot1 = GetSlotForStackIndex (o, checkIndex);
                 u16 otherSlot2 = GetExtraSlotForStackIndex (o, checkIndex);
 
-                if (targetSlot == otherSlot1 or
-                    targetSlot == otherSlot2 or
-                    targetSlot + extraSlot == otherSlot1)
+                // do the target slot range and the other item's slot range overlap?
+                if (targetSlot <= otherSlot2 and otherSlot1 <= targetSlot + extraSlot)
                 {
-                    _throwif (m3Err_functionStackOverflow, i_tempSlot >= d_m3MaxFunctionSlots);
+                    u8 otherType = GetStackTypeFromBottom (o, checkIndex);
+                    AlignSlotToType (& i_tempSlot, otherType);
+
+                    _throwif (m3Err_functionStackOverflow, i_tempSlot + GetTypeNumSlots (otherType) > d_m3MaxFunctionSlots);
 
 _                   (CopyStackIndexToSlot (o, i_tempSlot, checkIndex));
                     o->wasmStack [checkIndex] = i_tempSlot;
-                    i_tempSlot += GetTypeNumSlots (c_m3Type_i64);
+                    i_tempSlot += M3_MAX (GetTypeNumSlots (otherType), GetTypeNumSlots (c_m3Type_i64));
                     TouchSlot (o, i_tempSlot - 1);
 
                     // restore this on the way back down
@@ -1114,7 +1186,7 @@ M3Result  ReturnValues  (IM3Compilation o, IM3CompilationScope i_functionBlock,
     if (numReturns)
     {
         // return slots like args are 64-bit aligned
-        u16 returnSlot = numReturns * c_ioSlotCount;
+        u16 returnSlot = GetFuncTypeNumResultSlots (i_functionBlock->type);
         u16 stackTop = GetStackTopIndex (o);
 
         for (u16 i = 0; i < numReturns; ++i)
@@ -1130,7 +1202,7 @@ M3Result  ReturnValues  (IM3Compilation o, IM3CompilationScope i_functionBlock,
 
             if (not IsStackPolymorphic (o))
             {
-                returnSlot -= c_ioSlotCount;
+                returnSlot -= GetTypeNumIoSlots (returnType);
 _               (CopyStackIndexToSlot (o, returnSlot, stackTop--));
             }
         }
@@ -1342,8 +1414,12 @@ M3Result  Compile_GetGlobal  (IM3Compilation o, M3Global * i_global)
     M3Result result;
 
     IM3Operation op = Is64BitType (i_global->type) ? op_GetGlobal_s64 : op_GetGlobal_s32;
+#   if d_m3EnableSimd
+    if (i_global->type == c_m3Type_v128)
+        op = op_GetGlobal_s128;
+#   endif
 _   (EmitOp (o, op));
-    EmitPointer (o, & i_global->intValue);
+    EmitPointer (o, & i_global->intValue, c_m3Reloc_global);
 _   (PushAllocatedSlotAndEmit (o, i_global->type));
 
     _catch: return result;
@@ -1365,8 +1441,13 @@ M3Result  Compile_SetGlobal  (IM3Compilation o, M3Global * i_global)
         }
         else op = Is64BitType (type) ? op_SetGlobal_s64 : op_SetGlobal_s32;
 
+#       if d_m3EnableSimd
+        if (type == c_m3Type_v128)
+            op = op_SetGlobal_s128;
+#       endif
+
 _      (EmitOp (o, op));
-        EmitPointer (o, & i_global->intValue);
+        EmitPointer (o, & i_global->intValue, c_m3Reloc_global);
 
         if (IsStackTopInSlot (o))
             EmitSlotOffset (o, GetStackTopSlotNumber (o));
@@ -1404,7 +1485,7 @@ _           ((i_opcode == c_waOp_getGlobal) ? Compile_GetGlobal (o, global) : Co
 static
 void  EmitPatchingBranchPointer  (IM3Compilation o, IM3CompilationScope i_scope)
 {
-    pc_t patch = EmitPointer (o, i_scope->patches);                     m3log (compile, "branch patch required at: %p", patch);
+    pc_t patch = EmitPointer (o, i_scope->patches, c_m3Reloc_pc);                     m3log (compile, "branch patch required at: %p", patch);
     i_scope->patches = patch;
 }
 
@@ -1447,7 +1528,7 @@ _               (EmitSlotNumOfStackTopAndPop (o));
 _               (ResolveBlockResults (o, scope, /* isBranch: */ true));
 
 _               (EmitOp (o, op_ContinueLoop));
-                EmitPointer (o, scope->pc);
+                EmitPointer (o, scope->pc, c_m3Reloc_pc);
 
                 * jumpTo = GetPC (o);
             }
@@ -1458,7 +1539,7 @@ _               (CopyStackTopToRegister (o, false));
 _               (PopType (o, c_m3Type_i32));
 
 _               (EmitOp (o, op_ContinueLoopIf));
-                EmitPointer (o, scope->pc);
+                EmitPointer (o, scope->pc, c_m3Reloc_pc);
             }
 
 //          dump_type_stack(o);
@@ -1466,7 +1547,7 @@ _               (EmitOp (o, op_ContinueLoopIf));
         else // is c_waOp_branch
         {
     _       (EmitOp (o, op_ContinueLoop));
-            EmitPointer (o, scope->pc);
+            EmitPointer (o, scope->pc, c_m3Reloc_pc);
             o->block.isPolymorphic = true;
         }
     }
@@ -1574,7 +1655,7 @@ _       (AcquireCompilationCodePage (o, & continueOpPage));
 _           (ResolveBlockResults (o, scope, true));
 
 _           (EmitOp (o, op_ContinueLoop));
-            EmitPointer (o, scope->pc);
+            EmitPointer (o, scope->pc, c_m3Reloc_pc);
         }
         else
         {
@@ -1598,7 +1679,7 @@ _                   (EmitPatchingBranch (o, scope));
         ReleaseCompilationCodePage (o);     // FIX: continueOpPage can get lost if thrown
         o->page = savedPage;
 
-        EmitPointer (o, startPC);
+        EmitPointer (o, startPC, c_m3Reloc_pc);
     }
 
 _   (SetStackPolymorphic (o));
@@ -1632,11 +1713,12 @@ _       (Pop (o));
     u16 numArgs = GetFuncTypeNumParams (i_type);
     u16 numRets = GetFuncTypeNumResults (i_type);
 
-    u16 argTop = topSlot + (numArgs + numRets) * c_ioSlotCount;
+    u16 argTop = topSlot + GetFuncTypeNumParamSlots (i_type) + GetFuncTypeNumResultSlots (i_type);
 
     while (numArgs--)
     {
-_       (CopyStackTopToSlot (o, argTop -= c_ioSlotCount));
+        argTop -= GetTypeNumIoSlots (GetFuncTypeParamType (i_type, numArgs));
+_       (CopyStackTopToSlot (o, argTop));
 _       (Pop (o));
     }
 
@@ -1648,7 +1730,7 @@ _       (Pop (o));
 _       (Push (o, type, topSlot));
         MarkSlotsAllocatedByType (o, topSlot, type);
 
-        topSlot += c_ioSlotCount;
+        topSlot += GetTypeNumIoSlots (type);
     }
 
     } _catch: return result;
@@ -1686,7 +1768,7 @@ _           (CompileCallArgsAndReturn (o, & slotTop, function->funcType, false))
             }
 
 _           (EmitOp     (o, op));
-            EmitPointer (o, operand);
+            EmitPointer (o, operand, c_m3Reloc_callTarget);
             EmitSlotOffset  (o, slotTop);
         }
         else
@@ -1722,8 +1804,8 @@ _   (CompileCallArgsAndReturn (o, & execTop, type, true));
 
 _   (EmitOp         (o, op_CallIndirect));
     EmitSlotOffset  (o, tableIndexSlot);
-    EmitPointer     (o, o->module);
-    EmitPointer     (o, type);              // TODO: unify all types in M3Environment
+    EmitPointer     (o, o->module, c_m3Reloc_module);
+    EmitPointer     (o, type, c_m3Reloc_funcType);      // TODO: unify all types in M3Environment
     EmitSlotOffset  (o, execTop);
 
 } _catch:
@@ -1833,7 +1915,7 @@ _           (FindReferencedLocalWithinCurrentBlock (o, & preservedSlotNumber, sl
             if (preservedSlotNumber != slot)
             {
                 u8 type = GetStackTypeFromBottom (o, i);                    d_m3Assert (type != c_m3Type_none)
-                IM3Operation op = Is64BitType (type) ? op_CopySlot_64 : op_CopySlot_32;
+                IM3Operation op = GetCopySlotOp (type);
 
                 EmitOp          (o, op);
                 EmitSlotOffset  (o, preservedSlotNumber);
@@ -1887,6 +1969,9 @@ _                       (CopyStackIndexToSlot (o, newSlot, i));
         }
 
 _       (EmitOp (o, op_Loop));
+# if d_m3EnableJit
+        EmitPointer (o, o->function, c_m3Reloc_function);
+# endif
     }
     else
     {
@@ -1913,7 +1998,7 @@ _   (AcquireCompilationCodePage (o, & elsePage));
 _   (CompileBlock (o, i_blockType, c_waOp_else));
 
 _   (EmitOp (o, op_Branch));
-    EmitPointer (o, GetPagePC (savedPage));
+    EmitPointer (o, GetPagePC (savedPage), c_m3Reloc_pc);
 
     ReleaseCompilationCodePage (o);
 
@@ -2045,6 +2130,22 @@ _          (Pop (o));
 
         op = c_intSelectOps [type - c_m3Type_i32] [opIndex];
     }
+#   if d_m3EnableSimd
+    else if (type == c_m3Type_v128)
+    {
+        // v128 values only live in slots; move the selector out of _r0, if it's there
+        if (IsStackTopInRegister (o))
+_           (PreserveRegisterIfOccupied (o, c_m3Type_i32));
+
+        for (u32 i = 0; i < 3; ++i)
+        {
+            slots [i] = GetStackTopSlotNumber (o);
+_          (Pop (o));
+        }
+
+        op = op_v128_Select;
+    }
+#   endif
     else if (not IsStackPolymorphic (o))
         _throw (m3Err_functionStackUnderrun);
 
@@ -2054,7 +2155,17 @@ _          (Pop (o));
         if (IsValidSlot (slots [i]))
             EmitSlotOffset (o, slots [i]);
     }
-_   (PushRegister (o, type));
+
+#   if d_m3EnableSimd
+    if (type == c_m3Type_v128)
+    {
+_       (PushAllocatedSlotAndEmit (o, type));
+    }
+    else
+#   endif
+    {
+_       (PushRegister (o, type));
+    }
 
     _catch: return result;
 }
@@ -2218,6 +2329,226 @@ _   (Compile_Operator (o, i_opcode));
     _catch: return result;
 }
 
+#if d_m3EnableSimd
+
+// the number of lanes addressed by the lane index immediate of a lane opcode
+static
+u32  GetSimdLaneCount  (m3opcode_t i_opcode)
+{
+    switch (i_opcode & 0xff)
+    {
+        case 0x15: case 0x16: case 0x17: case 0x54: case 0x58:                  return 16;
+        case 0x18: case 0x19: case 0x1a: case 0x55: case 0x59:                  return 8;
+        case 0x1b: case 0x1c: case 0x1f: case 0x20: case 0x56: case 0x5a:       return 4;
+        default:                                                                return 2;
+    }
+}
+
+// v128 values only live in slots. scalar operands are moved out of the registers first, so that every operand can
+// be emitted as a slot, deepest stack item first. the result is always written to a slot.
+static
+M3Result  EmitSimdOperation  (IM3Compilation o, IM3OpInfo i_opInfo)
+{
+_try {
+    u16 numOperands = (i_opInfo->type != c_m3Type_none) - i_opInfo->stackOffset;
+
+    _throwif (m3Err_functionStackUnderrun, GetNumBlockValuesOnStack (o) < numOperands and not IsStackPolymorphic (o));
+
+    for (u16 i = 0; i < numOperands; ++i)
+    {
+        i32 stackIndex = (i32) GetStackTopIndex (o) - i;
+
+        if (IsStackIndexInRegister (o, stackIndex))
+_           (PreserveRegisterIfOccupied (o, GetStackTypeFromBottom (o, stackIndex)));
+    }
+
+_   (EmitOp (o, i_opInfo->operations [0]));
+
+    for (u16 i = numOperands; i > 0; --i)
+        EmitSlotOffset (o, GetSlotForStackIndex (o, GetStackTopIndex (o) - (i - 1)));
+
+    for (u16 i = 0; i < numOperands; ++i)
+_       (Pop (o));
+
+    if (i_opInfo->type != c_m3Type_none)
+_       (PushAllocatedSlotAndEmit (o, i_opInfo->type));
+
+} _catch: return result;
+}
+
+static
+M3Result  Compile_SimdOperator  (IM3Compilation o, m3opcode_t i_opcode)
+{
+_try {
+    IM3OpInfo opInfo = GetOpInfo (i_opcode);
+    _throwif (m3Err_unknownOpcode, not opInfo);
+
+_   (EmitSimdOperation (o, opInfo));
+
+} _catch: return result;
+}
+
+static
+M3Result  Compile_SimdLane  (IM3Compilation o, m3opcode_t i_opcode)
+{
+_try {
+    u8 lane;
+    IM3OpInfo opInfo = GetOpInfo (i_opcode);
+    _throwif (m3Err_unknownOpcode, not opInfo);
+
+_   (Read_u8 (& lane, & o->wasm, o->wasmEnd));                      m3log (compile, d_indent " (lane = %d)", get_indention_string (o), (u32) lane);
+    _throwif ("invalid lane index", lane >= GetSimdLaneCount (i_opcode));
+
+_   (EmitSimdOperation (o, opInfo));
+
+    EmitConstant32 (o, lane);
+
+} _catch: return result;
+}
+
+static
+M3Result  Compile_SimdLoadStore  (IM3Compilation o, m3opcode_t i_opcode)
+{
+_try {
+    u32 alignHint, memoryOffset;
+    u8 lane = 0;
+    bool isLaneOp = ((i_opcode & 0xff) >= 0x54 and (i_opcode & 0xff) <= 0x5b);
+
+    u16 numOperands;
+    i32 addressIndex;
+    bool addressInRegister;
+
+    IM3OpInfo opInfo = GetOpInfo (i_opcode);
+    _throwif (m3Err_unknownOpcode, not opInfo);
+
+    numOperands = (opInfo->type != c_m3Type_none) - opInfo->stackOffset;
+
+_   (ReadLEB_u32 (& alignHint, & o->wasm, o->wasmEnd));
+_   (ReadLEB_u32 (& memoryOffset, & o->wasm, o->wasmEnd));
+                                                                        m3log (compile, d_indent " (offset = %d)", get_indention_string (o), memoryOffset);
+    if (isLaneOp)
+    {
+_       (Read_u8 (& lane, & o->wasm, o->wasmEnd));
+        _throwif ("invalid lane index", lane >= GetSimdLaneCount (i_opcode));
+    }
+
+    _throwif (m3Err_functionStackUnderrun, GetNumBlockValuesOnStack (o) < numOperands and not IsStackPolymorphic (o));
+
+    // the address is the deepest operand and can be used directly from _r0. a v128 operand is always in a slot
+    addressIndex = (i32) GetStackTopIndex (o) - (numOperands - 1);
+    addressInRegister = IsStackIndexInRegister (o, addressIndex);
+
+_   (EmitOp (o, opInfo->operations [addressInRegister ? 0 : 1]));
+
+    for (u16 i = numOperands; i > 0; --i)
+    {
+        i32 stackIndex = (i32) GetStackTopIndex (o) - (i - 1);
+
+        if (not IsStackIndexInRegister (o, stackIndex))
+            EmitSlotOffset (o, GetSlotForStackIndex (o, stackIndex));
+    }
+
+    for (u16 i = 0; i < numOperands; ++i)
+_       (Pop (o));
+
+    if (opInfo->type != c_m3Type_none)
+_       (PushAllocatedSlotAndEmit (o, opInfo->type));
+
+    EmitConstant32 (o, memoryOffset);
+
+    if (isLaneOp)
+        EmitConstant32 (o, lane);
+
+} _catch: return result;
+}
+
+static
+M3Result  Compile_SimdConst  (IM3Compilation o, m3opcode_t i_opcode)
+{
+_try {
+    u64 value [2];
+
+_   (Read_u64 (& value [0], & o->wasm, o->wasmEnd));
+_   (Read_u64 (& value [1], & o->wasm, o->wasmEnd));              m3log (compile, d_indent " (const v128 = 0x%016" PRIx64 "%016" PRIx64 ")", get_indention_string (o), value [1], value [0]);
+
+_   (EmitOp (o, op_v128_Const));
+_   (PushAllocatedSlotAndEmit (o, c_m3Type_v128));
+
+    if (o->page)
+    {
+        EmitWord64 (o->page, value [0]);
+        EmitWord64 (o->page, value [1]);
+    }
+
+} _catch: return result;
+}
+
+static
+M3Result  Compile_SimdShuffle  (IM3Compilation o, m3opcode_t i_opcode)
+{
+_try {
+    u64 lanes [2];
+    IM3OpInfo opInfo = GetOpInfo (i_opcode);
+    _throwif (m3Err_unknownOpcode, not opInfo);
+
+_   (Read_u64 (& lanes [0], & o->wasm, o->wasmEnd));
+_   (Read_u64 (& lanes [1], & o->wasm, o->wasmEnd));
+
+    // each byte selects one of the 32 lanes of the two operands
+    _throwif ("invalid lane index", ((lanes [0] | lanes [1]) & 0xe0e0e0e0e0e0e0e0ull) != 0);
+
+_   (EmitSimdOperation (o, opInfo));
+
+    if (o->page)
+    {
+        EmitWord64 (o->page, lanes [0]);
+        EmitWord64 (o->page, lanes [1]);
+    }
+
+} _catch: return result;
+}
+
+static
+M3Result  Compile_SimdOpcode  (IM3Compilation o, m3opcode_t i_opcode)
+{
+_try {
+    u32 opcode;
+    IM3OpInfo opInfo;
+    M3Compiler compiler;
+
+_   (ReadLEB_u32 (& opcode, & o->wasm, o->wasmEnd));              m3log (compile, d_indent " (FD: %" PRIi32 ")", get_indention_string (o), opcode);
+    _throwif (m3Err_unknownOpcode, opcode > 0xff);
+
+    i_opcode = (i_opcode << 8) | opcode;
+
+    // v128.const is the only SIMD instruction allowed in a constant expression
+    if (not o->function and i_opcode != c_waOp_v128_const)
+        _throw (m3Err_restrictedOpcode);
+
+    opInfo = GetOpInfo (i_opcode);
+    _throwif (m3Err_unknownOpcode, not opInfo);
+
+    compiler = opInfo->compiler;
+    _throwif (m3Err_noCompiler, not compiler);
+
+_   ((* compiler) (o, i_opcode));
+
+    o->previousOpcode = i_opcode;
+
+} _catch: return result;
+}
+
+#endif // d_m3EnableSimd
+
+
+# if d_m3EnableCodeCache
+// operations are static to this compilation unit. the code cache hashes the address of op_Entry into its build id
+IM3Operation  GetCodeCacheOperationBase  (void)
+{
+    return op_Entry;
+}
+# endif
+
 
 M3Result  CompileRawFunction  (IM3Module io_module,  IM3Function io_function, const void * i_function, const void * i_userdata)
 {
@@ -2230,9 +2561,14 @@ M3Result  CompileRawFunction  (IM3Module io_module,  IM3Function io_function, co
         io_function->compiled = GetPagePC (page);
         io_function->module = io_module;
 
+        // host pointers can't be cached; raw function stubs are rebuilt by linking imports before loading a cache
+        RecordCodeRelocation (io_module->runtime, GetPagePC (page), c_m3Reloc_operation);
         EmitWord (page, op_CallRawFunction);
+        RecordCodeRelocation (io_module->runtime, GetPagePC (page), c_m3Reloc_opaque);
         EmitWord (page, i_function);
+        RecordCodeRelocation (io_module->runtime, GetPagePC (page), c_m3Reloc_opaque);
         EmitWord (page, io_function);
+        RecordCodeRelocation (io_module->runtime, GetPagePC (page), c_m3Reloc_opaque);
         EmitWord (page, i_userdata);
 
         ReleaseCodePage (io_module->runtime, page);
@@ -2255,6 +2591,8 @@ M3Result  CompileRawFunction  (IM3Module io_module,  IM3Function io_function, co
 #define d_storeFpOpList(TYPE, NAME)         { op_##TYPE##_##NAME##_rs,  op_##TYPE##_##NAME##_sr,    op_##TYPE##_##NAME##_ss,    op_##TYPE##_##NAME##_rr }
 #define d_commutativeBinOpList(TYPE, NAME)  { op_##TYPE##_##NAME##_rs,  NULL,                       op_##TYPE##_##NAME##_ss,    NULL }
 #define d_convertOpList(OP)                 { op_##OP##_r_r,            op_##OP##_r_s,              op_##OP##_s_r,              op_##OP##_s_s }
+#define d_simdOpList(OP)                    { op_##OP,                  NULL,                       NULL,                       NULL }
+#define d_simdMemOpList(OP)                 { op_##OP##_r,              op_##OP##_s,                NULL,                       NULL }
 
 
 const M3OpInfo c_operations [] =
@@ -2513,12 +2851,21 @@ const M3OpInfo c_operations [] =
     d_m3DebugTypedOp (SetGlobal),   d_m3DebugOp (SetGlobal_s32),    d_m3DebugOp (SetGlobal_s64),
 
     d_m3DebugTypedOp (SetRegister), d_m3DebugTypedOp (SetSlot),     d_m3DebugTypedOp (PreserveSetSlot),
+
+# if d_m3EnableSimd
+    d_m3DebugOp (CopySlot_128),     d_m3DebugOp (PreserveCopySlot_128), d_m3DebugOp (GetGlobal_s128), d_m3DebugOp (SetGlobal_s128),
+    d_m3DebugOp (v128_Select),      d_m3DebugOp (v128_Const),
+# endif
 # endif
 
 # if d_m3CascadedOpcodes
     [c_waOp_extended] = M3OP( "0xFC", 0, c_m3Type_unknown,   d_emptyOpList,  Compile_ExtendedOpcode ),
 # endif
 
+# if d_m3EnableSimd
+    [c_waOp_simd]     = M3OP( "0xFD", 0, c_m3Type_unknown,   d_emptyOpList,  Compile_SimdOpcode ),
+# endif
+
 # ifdef DEBUG
     M3OP( "termination", 0, c_m3Type_unknown ) // for find_operation_info
 # endif
@@ -2546,6 +2893,260 @@ const M3OpInfo c_operationsFC [] =
 # endif
 };
 
+# if d_m3EnableSimd
+const M3OpInfo c_operationsFD [] =
+{
+    M3OP( "v128.load",                        0,  v_128, d_simdMemOpList (v128_Load),                 Compile_SimdLoadStore ), // 0x00
+    M3OP( "v128.load8x8_s",                   0,  v_128, d_simdMemOpList (i16x8_Load_i8x8),           Compile_SimdLoadStore ), // 0x01
+    M3OP( "v128.load8x8_u",                   0,  v_128, d_simdMemOpList (i16x8_Load_u8x8),           Compile_SimdLoadStore ), // 0x02
+    M3OP( "v128.load16x4_s",                  0,  v_128, d_simdMemOpList (i32x4_Load_i16x4),          Compile_SimdLoadStore ), // 0x03
+    M3OP( "v128.load16x4_u",                  0,  v_128, d_simdMemOpList (i32x4_Load_u16x4),          Compile_SimdLoadStore ), // 0x04
+    M3OP( "v128.load32x2_s",                  0,  v_128, d_simdMemOpList (i64x2_Load_i32x2),          Compile_SimdLoadStore ), // 0x05
+    M3OP( "v128.load32x2_u",                  0,  v_128, d_simdMemOpList (i64x2_Load_u32x2),          Compile_SimdLoadStore ), // 0x06
+    M3OP( "v128.load8_splat",                 0,  v_128, d_simdMemOpList (i8x16_LoadSplat),           Compile_SimdLoadStore ), // 0x07
+    M3OP( "v128.load16_splat",                0,  v_128, d_simdMemOpList (i16x8_LoadSplat),           Compile_SimdLoadStore ), // 0x08
+    M3OP( "v128.load32_splat",                0,  v_128, d_simdMemOpList (i32x4_LoadSplat),           Compile_SimdLoadStore ), // 0x09
+    M3OP( "v128.load64_splat",                0,  v_128, d_simdMemOpList (i64x2_LoadSplat),           Compile_SimdLoadStore ), // 0x0a
+    M3OP( "v128.store",                      -2,  none,  d_simdMemOpList (v128_Store),                Compile_SimdLoadStore ), // 0x0b
+    M3OP( "v128.const",                       1,  v_128, d_emptyOpList,                               Compile_SimdConst ),     // 0x0c
+    M3OP( "i8x16.shuffle",                   -1,  v_128, d_simdOpList (i8x16_Shuffle),                Compile_SimdShuffle ),   // 0x0d
+    M3OP( "i8x16.swizzle",                   -1,  v_128, d_simdOpList (i8x16_Swizzle),                Compile_SimdOperator ),  // 0x0e
+    M3OP( "i8x16.splat",                      0,  v_128, d_simdOpList (i8x16_Splat),                  Compile_SimdOperator ),  // 0x0f
+    M3OP( "i16x8.splat",                      0,  v_128, d_simdOpList (i16x8_Splat),                  Compile_SimdOperator ),  // 0x10
+    M3OP( "i32x4.splat",                      0,  v_128, d_simdOpList (i32x4_Splat),                  Compile_SimdOperator ),  // 0x11
+    M3OP( "i64x2.splat",                      0,  v_128, d_simdOpList (i64x2_Splat),                  Compile_SimdOperator ),  // 0x12
+    M3OP( "f32x4.splat",                      0,  v_128, d_simdOpList (f32x4_Splat),                  Compile_SimdOperator ),  // 0x13
+    M3OP( "f64x2.splat",                      0,  v_128, d_simdOpList (f64x2_Splat),                  Compile_SimdOperator ),  // 0x14
+    M3OP( "i8x16.extract_lane_s",             0,  i_32,  d_simdOpList (i8x16_ExtractLane),            Compile_SimdLane ),      // 0x15
+    M3OP( "i8x16.extract_lane_u",             0,  i_32,  d_simdOpList (u8x16_ExtractLane),            Compile_SimdLane ),      // 0x16
+    M3OP( "i8x16.replace_lane",              -1,  v_128, d_simdOpList (i8x16_ReplaceLane),            Compile_SimdLane ),      // 0x17
+    M3OP( "i16x8.extract_lane_s",             0,  i_32,  d_simdOpList (i16x8_ExtractLane),            Compile_SimdLane ),      // 0x18
+    M3OP( "i16x8.extract_lane_u",             0,  i_32,  d_simdOpList (u16x8_ExtractLane),            Compile_SimdLane ),      // 0x19
+    M3OP( "i16x8.replace_lane",              -1,  v_128, d_simdOpList (i16x8_ReplaceLane),            Compile_SimdLane ),      // 0x1a
+    M3OP( "i32x4.extract_lane",               0,  i_32,  d_simdOpList (i32x4_ExtractLane),            Compile_SimdLane ),      // 0x1b
+    M3OP( "i32x4.replace_lane",              -1,  v_128, d_simdOpList (i32x4_ReplaceLane),            Compile_SimdLane ),      // 0x1c
+    M3OP( "i64x2.extract_lane",               0,  i_64,  d_simdOpList (i64x2_ExtractLane),            Compile_SimdLane ),      // 0x1d
+    M3OP( "i64x2.replace_lane",              -1,  v_128, d_simdOpList (i64x2_ReplaceLane),            Compile_SimdLane ),      // 0x1e
+    M3OP( "f32x4.extract_lane",               0,  f_32,  d_simdOpList (f32x4_ExtractLane),            Compile_SimdLane ),      // 0x1f
+    M3OP( "f32x4.replace_lane",              -1,  v_128, d_simdOpList (f32x4_ReplaceLane),            Compile_SimdLane ),      // 0x20
+    M3OP( "f64x2.extract_lane",               0,  f_64,  d_simdOpList (f64x2_ExtractLane),            Compile_SimdLane ),      // 0x21
+    M3OP( "f64x2.replace_lane",              -1,  v_128, d_simdOpList (f64x2_ReplaceLane),            Compile_SimdLane ),      // 0x22
+    M3OP( "i8x16.eq",                        -1,  v_128, d_simdOpList (i8x16_Equal),                  Compile_SimdOperator ),  // 0x23
+    M3OP( "i8x16.ne",                        -1,  v_128, d_simdOpList (i8x16_NotEqual),               Compile_SimdOperator ),  // 0x24
+    M3OP( "i8x16.lt_s",                      -1,  v_128, d_simdOpList (i8x16_LessThan),               Compile_SimdOperator ),  // 0x25
+    M3OP( "i8x16.lt_u",                      -1,  v_128, d_simdOpList (u8x16_LessThan),               Compile_SimdOperator ),  // 0x26
+    M3OP( "i8x16.gt_s",                      -1,  v_128, d_simdOpList (i8x16_GreaterThan),            Compile_SimdOperator ),  // 0x27
+    M3OP( "i8x16.gt_u",                      -1,  v_128, d_simdOpList (u8x16_GreaterThan),            Compile_SimdOperator ),  // 0x28
+    M3OP( "i8x16.le_s",                      -1,  v_128, d_simdOpList (i8x16_LessThanOrEqual),        Compile_SimdOperator ),  // 0x29
+    M3OP( "i8x16.le_u",                      -1,  v_128, d_simdOpList (u8x16_LessThanOrEqual),        Compile_SimdOperator ),  // 0x2a
+    M3OP( "i8x16.ge_s",                      -1,  v_128, d_simdOpList (i8x16_GreaterThanOrEqual),     Compile_SimdOperator ),  // 0x2b
+    M3OP( "i8x16.ge_u",                      -1,  v_128, d_simdOpList (u8x16_GreaterThanOrEqual),     Compile_SimdOperator ),  // 0x2c
+    M3OP( "i16x8.eq",                        -1,  v_128, d_simdOpList (i16x8_Equal),                  Compile_SimdOperator ),  // 0x2d
+    M3OP( "i16x8.ne",                        -1,  v_128, d_simdOpList (i16x8_NotEqual),               Compile_SimdOperator ),  // 0x2e
+    M3OP( "i16x8.lt_s",                      -1,  v_128, d_simdOpList (i16x8_LessThan),               Compile_SimdOperator ),  // 0x2f
+    M3OP( "i16x8.lt_u",                      -1,  v_128, d_simdOpList (u16x8_LessThan),               Compile_SimdOperator ),  // 0x30
+    M3OP( "i16x8.gt_s",                      -1,  v_128, d_simdOpList (i16x8_GreaterThan),            Compile_SimdOperator ),  // 0x31
+    M3OP( "i16x8.gt_u",                      -1,  v_128, d_simdOpList (u16x8_GreaterThan),            Compile_SimdOperator ),  // 0x32
+    M3OP( "i16x8.le_s",                      -1,  v_128, d_simdOpList (i16x8_LessThanOrEqual),        Compile_SimdOperator ),  // 0x33
+    M3OP( "i16x8.le_u",                      -1,  v_128, d_simdOpList (u16x8_LessThanOrEqual),        Compile_SimdOperator ),  // 0x34
+    M3OP( "i16x8.ge_s",                      -1,  v_128, d_simdOpList (i16x8_GreaterThanOrEqual),     Compile_SimdOperator ),  // 0x35
+    M3OP( "i16x8.ge_u",                      -1,  v_128, d_simdOpList (u16x8_GreaterThanOrEqual),     Compile_SimdOperator ),  // 0x36
+    M3OP( "i32x4.eq",                        -1,  v_128, d_simdOpList (i32x4_Equal),                  Compile_SimdOperator ),  // 0x37
+    M3OP( "i32x4.ne",                        -1,  v_128, d_simdOpList (i32x4_NotEqual),               Compile_SimdOperator ),  // 0x38
+    M3OP( "i32x4.lt_s",                      -1,  v_128, d_simdOpList (i32x4_LessThan),               Compile_SimdOperator ),  // 0x39
+    M3OP( "i32x4.lt_u",                      -1,  v_128, d_simdOpList (u32x4_LessThan),               Compile_SimdOperator ),  // 0x3a
+    M3OP( "i32x4.gt_s",                      -1,  v_128, d_simdOpList (i32x4_GreaterThan),            Compile_SimdOperator ),  // 0x3b
+    M3OP( "i32x4.gt_u",                      -1,  v_128, d_simdOpList (u32x4_GreaterThan),            Compile_SimdOperator ),  // 0x3c
+    M3OP( "i32x4.le_s",                      -1,  v_128, d_simdOpList (i32x4_LessThanOrEqual),        Compile_SimdOperator ),  // 0x3d
+    M3OP( "i32x4.le_u",                      -1,  v_128, d_simdOpList (u32x4_LessThanOrEqual),        Compile_SimdOperator ),  // 0x3e
+    M3OP( "i32x4.ge_s",                      -1,  v_128, d_simdOpList (i32x4_GreaterThanOrEqual),     Compile_SimdOperator ),  // 0x3f
+    M3OP( "i32x4.ge_u",                      -1,  v_128, d_simdOpList (u32x4_GreaterThanOrEqual),     Compile_SimdOperator ),  // 0x40
+    M3OP( "f32x4.eq",                        -1,  v_128, d_simdOpList (f32x4_Equal),                  Compile_SimdOperator ),  // 0x41
+    M3OP( "f32x4.ne",                        -1,  v_128, d_simdOpList (f32x4_NotEqual),               Compile_SimdOperator ),  // 0x42
+    M3OP( "f32x4.lt",                        -1,  v_128, d_simdOpList (f32x4_LessThan),               Compile_SimdOperator ),  // 0x43
+    M3OP( "f32x4.gt",                        -1,  v_128, d_simdOpList (f32x4_GreaterThan),            Compile_SimdOperator ),  // 0x44
+    M3OP( "f32x4.le",                        -1,  v_128, d_simdOpList (f32x4_LessThanOrEqual),        Compile_SimdOperator ),  // 0x45
+    M3OP( "f32x4.ge",                        -1,  v_128, d_simdOpList (f32x4_GreaterThanOrEqual),     Compile_SimdOperator ),  // 0x46
+    M3OP( "f64x2.eq",                        -1,  v_128, d_simdOpList (f64x2_Equal),                  Compile_SimdOperator ),  // 0x47
+    M3OP( "f64x2.ne",                        -1,  v_128, d_simdOpList (f64x2_NotEqual),               Compile_SimdOperator ),  // 0x48
+    M3OP( "f64x2.lt",                        -1,  v_128, d_simdOpList (f64x2_LessThan),               Compile_SimdOperator ),  // 0x49
+    M3OP( "f64x2.gt",                        -1,  v_128, d_simdOpList (f64x2_GreaterThan),            Compile_SimdOperator ),  // 0x4a
+    M3OP( "f64x2.le",                        -1,  v_128, d_simdOpList (f64x2_LessThanOrEqual),        Compile_SimdOperator ),  // 0x4b
+    M3OP( "f64x2.ge",                        -1,  v_128, d_simdOpList (f64x2_GreaterThanOrEqual),     Compile_SimdOperator ),  // 0x4c
+    M3OP( "v128.not",                         0,  v_128, d_simdOpList (v128_Not),                     Compile_SimdOperator ),  // 0x4d
+    M3OP( "v128.and",                        -1,  v_128, d_simdOpList (v128_And),                     Compile_SimdOperator ),  // 0x4e
+    M3OP( "v128.andnot",                     -1,  v_128, d_simdOpList (v128_AndNot),                  Compile_SimdOperator ),  // 0x4f
+    M3OP( "v128.or",                         -1,  v_128, d_simdOpList (v128_Or),                      Compile_SimdOperator ),  // 0x50
+    M3OP( "v128.xor",                        -1,  v_128, d_simdOpList (v128_Xor),                     Compile_SimdOperator ),  // 0x51
+    M3OP( "v128.bitselect",                  -2,  v_128, d_simdOpList (v128_BitSelect),               Compile_SimdOperator ),  // 0x52
+    M3OP( "v128.any_true",                    0,  i_32,  d_simdOpList (v128_AnyTrue),                 Compile_SimdOperator ),  // 0x53
+    M3OP( "v128.load8_lane",                 -1,  v_128, d_simdMemOpList (i8x16_LoadLane),            Compile_SimdLoadStore ), // 0x54
+    M3OP( "v128.load16_lane",                -1,  v_128, d_simdMemOpList (i16x8_LoadLane),            Compile_SimdLoadStore ), // 0x55
+    M3OP( "v128.load32_lane",                -1,  v_128, d_simdMemOpList (i32x4_LoadLane),            Compile_SimdLoadStore ), // 0x56
+    M3OP( "v128.load64_lane",                -1,  v_128, d_simdMemOpList (i64x2_LoadLane),            Compile_SimdLoadStore ), // 0x57
+    M3OP( "v128.store8_lane",                -2,  none,  d_simdMemOpList (i8x16_StoreLane),           Compile_SimdLoadStore ), // 0x58
+    M3OP( "v128.store16_lane",               -2,  none,  d_simdMemOpList (i16x8_StoreLane),           Compile_SimdLoadStore ), // 0x59
+    M3OP( "v128.store32_lane",               -2,  none,  d_simdMemOpList (i32x4_StoreLane),           Compile_SimdLoadStore ), // 0x5a
+    M3OP( "v128.store64_lane",               -2,  none,  d_simdMemOpList (i64x2_StoreLane),           Compile_SimdLoadStore ), // 0x5b
+    M3OP( "v128.load32_zero",                 0,  v_128, d_simdMemOpList (i32x4_LoadZero),            Compile_SimdLoadStore ), // 0x5c
+    M3OP( "v128.load64_zero",                 0,  v_128, d_simdMemOpList (i64x2_LoadZero),            Compile_SimdLoadStore ), // 0x5d
+    M3OP( "f32x4.demote_f64x2_zero",          0,  v_128, d_simdOpList (f32x4_DemoteZero_f64x2),       Compile_SimdOperator ),  // 0x5e
+    M3OP( "f64x2.promote_low_f32x4",          0,  v_128, d_simdOpList (f64x2_PromoteLow_f32x4),       Compile_SimdOperator ),  // 0x5f
+    M3OP( "i8x16.abs",                        0,  v_128, d_simdOpList (i8x16_Abs),                    Compile_SimdOperator ),  // 0x60
+    M3OP( "i8x16.neg",                        0,  v_128, d_simdOpList (i8x16_Negate),                 Compile_SimdOperator ),  // 0x61
+    M3OP( "i8x16.popcnt",                     0,  v_128, d_simdOpList (i8x16_Popcnt),                 Compile_SimdOperator ),  // 0x62
+    M3OP( "i8x16.all_true",                   0,  i_32,  d_simdOpList (i8x16_AllTrue),                Compile_SimdOperator ),  // 0x63
+    M3OP( "i8x16.bitmask",                    0,  i_32,  d_simdOpList (i8x16_Bitmask),                Compile_SimdOperator ),  // 0x64
+    M3OP( "i8x16.narrow_i16x8_s",            -1,  v_128, d_simdOpList (i8x16_Narrow_i16x8),           Compile_SimdOperator ),  // 0x65
+    M3OP( "i8x16.narrow_i16x8_u",            -1,  v_128, d_simdOpList (u8x16_Narrow_i16x8),           Compile_SimdOperator ),  // 0x66
+    M3OP( "f32x4.ceil",                       0,  v_128, d_simdOpList (f32x4_Ceil),                   Compile_SimdOperator ),  // 0x67
+    M3OP( "f32x4.floor",                      0,  v_128, d_simdOpList (f32x4_Floor),                  Compile_SimdOperator ),  // 0x68
+    M3OP( "f32x4.trunc",                      0,  v_128, d_simdOpList (f32x4_Trunc),                  Compile_SimdOperator ),  // 0x69
+    M3OP( "f32x4.nearest",                    0,  v_128, d_simdOpList (f32x4_Nearest),                Compile_SimdOperator ),  // 0x6a
+    M3OP( "i8x16.shl",                       -1,  v_128, d_simdOpList (i8x16_ShiftLeft),              Compile_SimdOperator ),  // 0x6b
+    M3OP( "i8x16.shr_s",                     -1,  v_128, d_simdOpList (i8x16_ShiftRight),             Compile_SimdOperator ),  // 0x6c
+    M3OP( "i8x16.shr_u",                     -1,  v_128, d_simdOpList (u8x16_ShiftRight),             Compile_SimdOperator ),  // 0x6d
+    M3OP( "i8x16.add",                       -1,  v_128, d_simdOpList (i8x16_Add),                    Compile_SimdOperator ),  // 0x6e
+    M3OP( "i8x16.add_sat_s",                 -1,  v_128, d_simdOpList (i8x16_AddSat),                 Compile_SimdOperator ),  // 0x6f
+    M3OP( "i8x16.add_sat_u",                 -1,  v_128, d_simdOpList (u8x16_AddSat),                 Compile_SimdOperator ),  // 0x70
+    M3OP( "i8x16.sub",                       -1,  v_128, d_simdOpList (i8x16_Subtract),               Compile_SimdOperator ),  // 0x71
+    M3OP( "i8x16.sub_sat_s",                 -1,  v_128, d_simdOpList (i8x16_SubtractSat),            Compile_SimdOperator ),  // 0x72
+    M3OP( "i8x16.sub_sat_u",                 -1,  v_128, d_simdOpList (u8x16_SubtractSat),            Compile_SimdOperator ),  // 0x73
+    M3OP( "f64x2.ceil",                       0,  v_128, d_simdOpList (f64x2_Ceil),                   Compile_SimdOperator ),  // 0x74
+    M3OP( "f64x2.floor",                      0,  v_128, d_simdOpList (f64x2_Floor),                  Compile_SimdOperator ),  // 0x75
+    M3OP( "i8x16.min_s",                     -1,  v_128, d_simdOpList (i8x16_Min),                    Compile_SimdOperator ),  // 0x76
+    M3OP( "i8x16.min_u",                     -1,  v_128, d_simdOpList (u8x16_Min),                    Compile_SimdOperator ),  // 0x77
+    M3OP( "i8x16.max_s",                     -1,  v_128, d_simdOpList (i8x16_Max),                    Compile_SimdOperator ),  // 0x78
+    M3OP( "i8x16.max_u",                     -1,  v_128, d_simdOpList (u8x16_Max),                    Compile_SimdOperator ),  // 0x79
+    M3OP( "f64x2.trunc",                      0,  v_128, d_simdOpList (f64x2_Trunc),                  Compile_SimdOperator ),  // 0x7a
+    M3OP( "i8x16.avgr_u",                    -1,  v_128, d_simdOpList (u8x16_AvgRound),               Compile_SimdOperator ),  // 0x7b
+    M3OP( "i16x8.extadd_pairwise_i8x16_s",    0,  v_128, d_simdOpList (i16x8_ExtAddPairwise_i8x16),   Compile_SimdOperator ),  // 0x7c
+    M3OP( "i16x8.extadd_pairwise_i8x16_u",    0,  v_128, d_simdOpList (i16x8_ExtAddPairwise_u8x16),   Compile_SimdOperator ),  // 0x7d
+    M3OP( "i32x4.extadd_pairwise_i16x8_s",    0,  v_128, d_simdOpList (i32x4_ExtAddPairwise_i16x8),   Compile_SimdOperator ),  // 0x7e
+    M3OP( "i32x4.extadd_pairwise_i16x8_u",    0,  v_128, d_simdOpList (i32x4_ExtAddPairwise_u16x8),   Compile_SimdOperator ),  // 0x7f
+    M3OP( "i16x8.abs",                        0,  v_128, d_simdOpList (i16x8_Abs),                    Compile_SimdOperator ),  // 0x80
+    M3OP( "i16x8.neg",                        0,  v_128, d_simdOpList (i16x8_Negate),                 Compile_SimdOperator ),  // 0x81
+    M3OP( "i16x8.q15mulr_sat_s",             -1,  v_128, d_simdOpList (i16x8_Q15MulrSat),             Compile_SimdOperator ),  // 0x82
+    M3OP( "i16x8.all_true",                   0,  i_32,  d_simdOpList (i16x8_AllTrue),                Compile_SimdOperator ),  // 0x83
+    M3OP( "i16x8.bitmask",                    0,  i_32,  d_simdOpList (i16x8_Bitmask),                Compile_SimdOperator ),  // 0x84
+    M3OP( "i16x8.narrow_i32x4_s",            -1,  v_128, d_simdOpList (i16x8_Narrow_i32x4),           Compile_SimdOperator ),  // 0x85
+    M3OP( "i16x8.narrow_i32x4_u",            -1,  v_128, d_simdOpList (u16x8_Narrow_i32x4),           Compile_SimdOperator ),  // 0x86
+    M3OP( "i16x8.extend_low_i8x16_s",         0,  v_128, d_simdOpList (i16x8_ExtendLow_i8x16),        Compile_SimdOperator ),  // 0x87
+    M3OP( "i16x8.extend_high_i8x16_s",        0,  v_128, d_simdOpList (i16x8_ExtendHigh_i8x16),       Compile_SimdOperator ),  // 0x88
+    M3OP( "i16x8.extend_low_i8x16_u",         0,  v_128, d_simdOpList (i16x8_ExtendLow_u8x16),        Compile_SimdOperator ),  // 0x89
+    M3OP( "i16x8.extend_high_i8x16_u",        0,  v_128, d_simdOpList (i16x8_ExtendHigh_u8x16),       Compile_SimdOperator ),  // 0x8a
+    M3OP( "i16x8.shl",                       -1,  v_128, d_simdOpList (i16x8_ShiftLeft),              Compile_SimdOperator ),  // 0x8b
+    M3OP( "i16x8.shr_s",                     -1,  v_128, d_simdOpList (i16x8_ShiftRight),             Compile_SimdOperator ),  // 0x8c
+    M3OP( "i16x8.shr_u",                     -1,  v_128, d_simdOpList (u16x8_ShiftRight),             Compile_SimdOperator ),  // 0x8d
+    M3OP( "i16x8.add",                       -1,  v_128, d_simdOpList (i16x8_Add),                    Compile_SimdOperator ),  // 0x8e
+    M3OP( "i16x8.add_sat_s",                 -1,  v_128, d_simdOpList (i16x8_AddSat),                 Compile_SimdOperator ),  // 0x8f
+    M3OP( "i16x8.add_sat_u",                 -1,  v_128, d_simdOpList (u16x8_AddSat),                 Compile_SimdOperator ),  // 0x90
+    M3OP( "i16x8.sub",                       -1,  v_128, d_simdOpList (i16x8_Subtract),               Compile_SimdOperator ),  // 0x91
+    M3OP( "i16x8.sub_sat_s",                 -1,  v_128, d_simdOpList (i16x8_SubtractSat),            Compile_SimdOperator ),  // 0x92
+    M3OP( "i16x8.sub_sat_u",                 -1,  v_128, d_simdOpList (u16x8_SubtractSat),            Compile_SimdOperator ),  // 0x93
+    M3OP( "f64x2.nearest",                    0,  v_128, d_simdOpList (f64x2_Nearest),                Compile_SimdOperator ),  // 0x94
+    M3OP( "i16x8.mul",                       -1,  v_128, d_simdOpList (i16x8_Multiply),               Compile_SimdOperator ),  // 0x95
+    M3OP( "i16x8.min_s",                     -1,  v_128, d_simdOpList (i16x8_Min),                    Compile_SimdOperator ),  // 0x96
+    M3OP( "i16x8.min_u",                     -1,  v_128, d_simdOpList (u16x8_Min),                    Compile_SimdOperator ),  // 0x97
+    M3OP( "i16x8.max_s",                     -1,  v_128, d_simdOpList (i16x8_Max),                    Compile_SimdOperator ),  // 0x98
+    M3OP( "i16x8.max_u",                     -1,  v_128, d_simdOpList (u16x8_Max),                    Compile_SimdOperator ),  // 0x99
+    M3OP_RESERVED,                                                                                           // 0x9a
+    M3OP( "i16x8.avgr_u",                    -1,  v_128, d_simdOpList (u16x8_AvgRound),               Compile_SimdOperator ),  // 0x9b
+    M3OP( "i16x8.extmul_low_i8x16_s",        -1,  v_128, d_simdOpList (i16x8_ExtMulLow_i8x16),        Compile_SimdOperator ),  // 0x9c
+    M3OP( "i16x8.extmul_high_i8x16_s",       -1,  v_128, d_simdOpList (i16x8_ExtMulHigh_i8x16),       Compile_SimdOperator ),  // 0x9d
+    M3OP( "i16x8.extmul_low_i8x16_u",        -1,  v_128, d_simdOpList (i16x8_ExtMulLow_u8x16),        Compile_SimdOperator ),  // 0x9e
+    M3OP( "i16x8.extmul_high_i8x16_u",       -1,  v_128, d_simdOpList (i16x8_ExtMulHigh_u8x16),       Compile_SimdOperator ),  // 0x9f
+    M3OP( "i32x4.abs",                        0,  v_128, d_simdOpList (i32x4_Abs),                    Compile_SimdOperator ),  // 0xa0
+    M3OP( "i32x4.neg",                        0,  v_128, d_simdOpList (i32x4_Negate),                 Compile_SimdOperator ),  // 0xa1
+    M3OP_RESERVED,                                                                                           // 0xa2
+    M3OP( "i32x4.all_true",                   0,  i_32,  d_simdOpList (i32x4_AllTrue),                Compile_SimdOperator ),  // 0xa3
+    M3OP( "i32x4.bitmask",                    0,  i_32,  d_simdOpList (i32x4_Bitmask),                Compile_SimdOperator ),  // 0xa4
+    M3OP_RESERVED, M3OP_RESERVED,                                                                            // 0xa5...0xa6
+    M3OP( "i32x4.extend_low_i16x8_s",         0,  v_128, d_simdOpList (i32x4_ExtendLow_i16x8),        Compile_SimdOperator ),  // 0xa7
+    M3OP( "i32x4.extend_high_i16x8_s",        0,  v_128, d_simdOpList (i32x4_ExtendHigh_i16x8),       Compile_SimdOperator ),  // 0xa8
+    M3OP( "i32x4.extend_low_i16x8_u",         0,  v_128, d_simdOpList (i32x4_ExtendLow_u16x8),        Compile_SimdOperator ),  // 0xa9
+    M3OP( "i32x4.extend_high_i16x8_u",        0,  v_128, d_simdOpList (i32x4_ExtendHigh_u16x8),       Compile_SimdOperator ),  // 0xaa
+    M3OP( "i32x4.shl",                       -1,  v_128, d_simdOpList (i32x4_ShiftLeft),              Compile_SimdOperator ),  // 0xab
+    M3OP( "i32x4.shr_s",                     -1,  v_128, d_simdOpList (i32x4_ShiftRight),             Compile_SimdOperator ),  // 0xac
+    M3OP( "i32x4.shr_u",                     -1,  v_128, d_simdOpList (u32x4_ShiftRight),             Compile_SimdOperator ),  // 0xad
+    M3OP( "i32x4.add",                       -1,  v_128, d_simdOpList (i32x4_Add),                    Compile_SimdOperator ),  // 0xae
+    M3OP_RESERVED, M3OP_RESERVED,                                                                            // 0xaf...0xb0
+    M3OP( "i32x4.sub",                       -1,  v_128, d_simdOpList (i32x4_Subtract),               Compile_SimdOperator ),  // 0xb1
+    M3OP_RESERVED, M3OP_RESERVED, M3OP_RESERVED,                                                             // 0xb2...0xb4
+    M3OP( "i32x4.mul",                       -1,  v_128, d_simdOpList (i32x4_Multiply),               Compile_SimdOperator ),  // 0xb5
+    M3OP( "i32x4.min_s",                     -1,  v_128, d_simdOpList (i32x4_Min),                    Compile_SimdOperator ),  // 0xb6
+    M3OP( "i32x4.min_u",                     -1,  v_128, d_simdOpList (u32x4_Min),                    Compile_SimdOperator ),  // 0xb7
+    M3OP( "i32x4.max_s",                     -1,  v_128, d_simdOpList (i32x4_Max),                    Compile_SimdOperator ),  // 0xb8
+    M3OP( "i32x4.max_u",                     -1,  v_128, d_simdOpList (u32x4_Max),                    Compile_SimdOperator ),  // 0xb9
+    M3OP( "i32x4.dot_i16x8_s",               -1,  v_128, d_simdOpList (i32x4_Dot_i16x8),              Compile_SimdOperator ),  // 0xba
+    M3OP_RESERVED,                                                                                           // 0xbb
+    M3OP( "i32x4.extmul_low_i16x8_s",        -1,  v_128, d_simdOpList (i32x4_ExtMulLow_i16x8),        Compile_SimdOperator ),  // 0xbc
+    M3OP( "i32x4.extmul_high_i16x8_s",       -1,  v_128, d_simdOpList (i32x4_ExtMulHigh_i16x8),       Compile_SimdOperator ),  // 0xbd
+    M3OP( "i32x4.extmul_low_i16x8_u",        -1,  v_128, d_simdOpList (i32x4_ExtMulLow_u16x8),        Compile_SimdOperator ),  // 0xbe
+    M3OP( "i32x4.extmul_high_i16x8_u",       -1,  v_128, d_simdOpList (i32x4_ExtMulHigh_u16x8),       Compile_SimdOperator ),  // 0xbf
+    M3OP( "i64x2.abs",                        0,  v_128, d_simdOpList (i64x2_Abs),                    Compile_SimdOperator ),  // 0xc0
+    M3OP( "i64x2.neg",                        0,  v_128, d_simdOpList (i64x2_Negate),                 Compile_SimdOperator ),  // 0xc1
+    M3OP_RESERVED,                                                                                           // 0xc2
+    M3OP( "i64x2.all_true",                   0,  i_32,  d_simdOpList (i64x2_AllTrue),                Compile_SimdOperator ),  // 0xc3
+    M3OP( "i64x2.bitmask",                    0,  i_32,  d_simdOpList (i64x2_Bitmask),                Compile_SimdOperator ),  // 0xc4
+    M3OP_RESERVED, M3OP_RESERVED,                                                                            // 0xc5...0xc6
+    M3OP( "i64x2.extend_low_i32x4_s",         0,  v_128, d_simdOpList (i64x2_ExtendLow_i32x4),        Compile_SimdOperator ),  // 0xc7
+    M3OP( "i64x2.extend_high_i32x4_s",        0,  v_128, d_simdOpList (i64x2_ExtendHigh_i32x4),       Compile_SimdOperator ),  // 0xc8
+    M3OP( "i64x2.extend_low_i32x4_u",         0,  v_128, d_simdOpList (i64x2_ExtendLow_u32x4),        Compile_SimdOperator ),  // 0xc9
+    M3OP( "i64x2.extend_high_i32x4_u",        0,  v_128, d_simdOpList (i64x2_ExtendHigh_u32x4),       Compile_SimdOperator ),  // 0xca
+    M3OP( "i64x2.shl",                       -1,  v_128, d_simdOpList (i64x2_ShiftLeft),              Compile_SimdOperator ),  // 0xcb
+    M3OP( "i64x2.shr_s",                     -1,  v_128, d_simdOpList (i64x2_ShiftRight),             Compile_SimdOperator ),  // 0xcc
+    M3OP( "i64x2.shr_u",                     -1,  v_128, d_simdOpList (u64x2_ShiftRight),             Compile_SimdOperator ),  // 0xcd
+    M3OP( "i64x2.add",                       -1,  v_128, d_simdOpList (i64x2_Add),                    Compile_SimdOperator ),  // 0xce
+    M3OP_RESERVED, M3OP_RESERVED,                                                                            // 0xcf...0xd0
+    M3OP( "i64x2.sub",                       -1,  v_128, d_simdOpList (i64x2_Subtract),               Compile_SimdOperator ),  // 0xd1
+    M3OP_RESERVED, M3OP_RESERVED, M3OP_RESERVED,                                                             // 0xd2...0xd4
+    M3OP( "i64x2.mul",                       -1,  v_128, d_simdOpList (i64x2_Multiply),               Compile_SimdOperator ),  // 0xd5
+    M3OP( "i64x2.eq",                        -1,  v_128, d_simdOpList (i64x2_Equal),                  Compile_SimdOperator ),  // 0xd6
+    M3OP( "i64x2.ne",                        -1,  v_128, d_simdOpList (i64x2_NotEqual),               Compile_SimdOperator ),  // 0xd7
+    M3OP( "i64x2.lt_s",                      -1,  v_128, d_simdOpList (i64x2_LessThan),               Compile_SimdOperator ),  // 0xd8
+    M3OP( "i64x2.gt_s",                      -1,  v_128, d_simdOpList (i64x2_GreaterThan),            Compile_SimdOperator ),  // 0xd9
+    M3OP( "i64x2.le_s",                      -1,  v_128, d_simdOpList (i64x2_LessThanOrEqual),        Compile_SimdOperator ),  // 0xda
+    M3OP( "i64x2.ge_s",                      -1,  v_128, d_simdOpList (i64x2_GreaterThanOrEqual),     Compile_SimdOperator ),  // 0xdb
+    M3OP( "i64x2.extmul_low_i32x4_s",        -1,  v_128, d_simdOpList (i64x2_ExtMulLow_i32x4),        Compile_SimdOperator ),  // 0xdc
+    M3OP( "i64x2.extmul_high_i32x4_s",       -1,  v_128, d_simdOpList (i64x2_ExtMulHigh_i32x4),       Compile_SimdOperator ),  // 0xdd
+    M3OP( "i64x2.extmul_low_i32x4_u",        -1,  v_128, d_simdOpList (i64x2_ExtMulLow_u32x4),        Compile_SimdOperator ),  // 0xde
+    M3OP( "i64x2.extmul_high_i32x4_u",       -1,  v_128, d_simdOpList (i64x2_ExtMulHigh_u32x4),       Compile_SimdOperator ),  // 0xdf
+    M3OP( "f32x4.abs",                        0,  v_128, d_simdOpList (f32x4_Abs),                    Compile_SimdOperator ),  // 0xe0
+    M3OP( "f32x4.neg",                        0,  v_128, d_simdOpList (f32x4_Negate),                 Compile_SimdOperator ),  // 0xe1
+    M3OP_RESERVED,                                                                                           // 0xe2
+    M3OP( "f32x4.sqrt",                       0,  v_128, d_simdOpList (f32x4_Sqrt),                   Compile_SimdOperator ),  // 0xe3
+    M3OP( "f32x4.add",                       -1,  v_128, d_simdOpList (f32x4_Add),                    Compile_SimdOperator ),  // 0xe4
+    M3OP( "f32x4.sub",                       -1,  v_128, d_simdOpList (f32x4_Subtract),               Compile_SimdOperator ),  // 0xe5
+    M3OP( "f32x4.mul",                       -1,  v_128, d_simdOpList (f32x4_Multiply),               Compile_SimdOperator ),  // 0xe6
+    M3OP( "f32x4.div",                       -1,  v_128, d_simdOpList (f32x4_Divide),                 Compile_SimdOperator ),  // 0xe7
+    M3OP( "f32x4.min",                       -1,  v_128, d_simdOpList (f32x4_Min),                    Compile_SimdOperator ),  // 0xe8
+    M3OP( "f32x4.max",                       -1,  v_128, d_simdOpList (f32x4_Max),                    Compile_SimdOperator ),  // 0xe9
+    M3OP( "f32x4.pmin",                      -1,  v_128, d_simdOpList (f32x4_PMin),                   Compile_SimdOperator ),  // 0xea
+    M3OP( "f32x4.pmax",                      -1,  v_128, d_simdOpList (f32x4_PMax),                   Compile_SimdOperator ),  // 0xeb
+    M3OP( "f64x2.abs",                        0,  v_128, d_simdOpList (f64x2_Abs),                    Compile_SimdOperator ),  // 0xec
+    M3OP( "f64x2.neg",                        0,  v_128, d_simdOpList (f64x2_Negate),                 Compile_SimdOperator ),  // 0xed
+    M3OP_RESERVED,                                                                                           // 0xee
+    M3OP( "f64x2.sqrt",                       0,  v_128, d_simdOpList (f64x2_Sqrt),                   Compile_SimdOperator ),  // 0xef
+    M3OP( "f64x2.add",                       -1,  v_128, d_simdOpList (f64x2_Add),                    Compile_SimdOperator ),  // 0xf0
+    M3OP( "f64x2.sub",                       -1,  v_128, d_simdOpList (f64x2_Subtract),               Compile_SimdOperator ),  // 0xf1
+    M3OP( "f64x2.mul",                       -1,  v_128, d_simdOpList (f64x2_Multiply),               Compile_SimdOperator ),  // 0xf2
+    M3OP( "f64x2.div",                       -1,  v_128, d_simdOpList (f64x2_Divide),                 Compile_SimdOperator ),  // 0xf3
+    M3OP( "f64x2.min",                       -1,  v_128, d_simdOpList (f64x2_Min),                    Compile_SimdOperator ),  // 0xf4
+    M3OP( "f64x2.max",                       -1,  v_128, d_simdOpList (f64x2_Max),                    Compile_SimdOperator ),  // 0xf5
+    M3OP( "f64x2.pmin",                      -1,  v_128, d_simdOpList (f64x2_PMin),                   Compile_SimdOperator ),  // 0xf6
+    M3OP( "f64x2.pmax",                      -1,  v_128, d_simdOpList (f64x2_PMax),                   Compile_SimdOperator ),  // 0xf7
+    M3OP( "i32x4.trunc_sat_f32x4_s",          0,  v_128, d_simdOpList (i32x4_TruncSat_f32x4),         Compile_SimdOperator ),  // 0xf8
+    M3OP( "i32x4.trunc_sat_f32x4_u",          0,  v_128, d_simdOpList (u32x4_TruncSat_f32x4),         Compile_SimdOperator ),  // 0xf9
+    M3OP( "f32x4.convert_i32x4_s",            0,  v_128, d_simdOpList (f32x4_Convert_i32x4),          Compile_SimdOperator ),  // 0xfa
+    M3OP( "f32x4.convert_i32x4_u",            0,  v_128, d_simdOpList (f32x4_Convert_u32x4),          Compile_SimdOperator ),  // 0xfb
+    M3OP( "i32x4.trunc_sat_f64x2_s_zero",     0,  v_128, d_simdOpList (i32x4_TruncSatZero_f64x2),     Compile_SimdOperator ),  // 0xfc
+    M3OP( "i32x4.trunc_sat_f64x2_u_zero",     0,  v_128, d_simdOpList (u32x4_TruncSatZero_f64x2),     Compile_SimdOperator ),  // 0xfd
+    M3OP( "f64x2.convert_low_i32x4_s",        0,  v_128, d_simdOpList (f64x2_ConvertLow_i32x4),       Compile_SimdOperator ),  // 0xfe
+    M3OP( "f64x2.convert_low_i32x4_u",        0,  v_128, d_simdOpList (f64x2_ConvertLow_u32x4),       Compile_SimdOperator ),  // 0xff
+};
+# endif
+
 
 IM3OpInfo  GetOpInfo  (m3opcode_t opcode)
 {
@@ -2561,6 +3162,14 @@ IM3OpInfo  GetOpInfo  (m3opcode_t opcode)
             return &c_operationsFC[opcode];
         }
         break;
+# if d_m3EnableSimd
+    case c_waOp_simd:
+        opcode &= 0xFF;
+        if (M3_LIKELY(opcode < M3_COUNT_OF(c_operationsFD))) {
+            return &c_operationsFD[opcode];
+        }
+        break;
+# endif
     }
     return NULL;
 }
@@ -2578,7 +3187,7 @@ M3Result  CompileBlockStatements  (IM3Compilation o)
             EmitOp          (o, op_DumpStack);
             EmitConstant32  (o, o->numOpcodes);
             EmitConstant32  (o, GetMaxUsedSlotPlusOne(o));
-            EmitPointer     (o, o->function);
+            EmitPointer     (o, o->function, c_m3Reloc_function);
 
             o->numEmits = 0;
         }
@@ -2593,6 +3202,9 @@ _       (Read_opcode (& opcode, & o->wasm, o->wasmEnd));                log_opco
             case c_waOp_i32_const: case c_waOp_i64_const:
             case c_waOp_f32_const: case c_waOp_f64_const:
             case c_waOp_getGlobal: case c_waOp_end:
+# if d_m3EnableSimd
+            case c_waOp_simd:   // Compile_SimdOpcode only accepts v128.const
+# endif
                 break;
             default:
                 _throw(m3Err_restrictedOpcode);
@@ -2837,6 +3449,8 @@ M3Result  CompileFunction  (IM3Function io_function)
                                                                         io_function->index, m3_GetFunctionName (io_function), SPrintFuncTypeSignature (funcType), (u32) (io_function->wasmEnd - io_function->wasm));
     IM3Runtime runtime = io_function->module->runtime;
 
+    double startTime = runtime->clockCallback ? runtime->clockCallback () : 0;  // NOTE(orca): compilation statistics
+
     IM3Compilation o = & runtime->compilation;                      d_m3Assert (d_m3MaxFunctionSlots >= d_m3MaxFunctionStackHeight * (d_m3Use32BitSlots + 1))  // need twice as many slots in 32-bit mode
     memset (o, 0x0, sizeof (M3Compilation));
 
@@ -2856,7 +3470,7 @@ _   (AcquireCompilationCodePage (o, & o->page));
 
     pc_t pc = GetPagePC (o->page);
 
-    u16 numRetSlots = GetFunctionNumReturns (o->function) * c_ioSlotCount;
+    u16 numRetSlots = GetFuncTypeNumResultSlots (funcType);
 
     for (u16 i = 0; i < numRetSlots; ++i)
         MarkSlotAllocated (o, i);
@@ -2869,10 +3483,13 @@ _   (AcquireCompilationCodePage (o, & o->page));
     for (u16 i = 0; i < numArgs; ++i)
     {
         u8 type = GetFunctionArgType (o->function, i);
-_       (PushAllocatedSlot (o, type));
+        u16 slot = o->slotFirstDynamicIndex;
+
+        MarkSlotsAllocatedByType (o, slot, type);
+_       (Push (o, type, slot));
 
         // prevent allocator fill-in
-        o->slotFirstDynamicIndex += c_ioSlotCount;
+        o->slotFirstDynamicIndex += GetTypeNumIoSlots (type);
     }
 
     o->slotMaxAllocatedIndexPlusOne = o->function->numRetAndArgSlots = o->slotFirstLocalIndex = o->slotFirstDynamicIndex;
@@ -2894,7 +3511,7 @@ _   (ReserveConstants (o));
     o->block.blockStackIndex = o->stackFirstDynamicIndex = o->stackIndex;                           m3log (compile, "start stack index: %d",
                                                                                                           (u32) o->stackFirstDynamicIndex);
 _   (EmitOp (o, op_Entry));
-    EmitPointer (o, io_function);
+    EmitPointer (o, io_function, c_m3Reloc_function);
 
 _   (CompileBlockStatements (o));
 
@@ -2918,5 +3535,82 @@ _   (CompileBlockStatements (o));
 
     ReleaseCompilationCodePage (o);
 
+    runtime->numCompilations++;
+    if (runtime->clockCallback)
+        runtime->compileTime += runtime->clockCallback () - startTime;
+
     return result;
 }
+
+
+# if d_m3EnableCodeCache
+static
+u32  AppendOperations  (IM3Operation * o_operations, u32 i_count, u32 i_capacity, const IM3Operation * i_operations, u32 i_numOperations)
+{
+    for (u32 i = 0; i < i_numOperations; ++i)
+    {
+        if (i_operations [i])
+        {
+            if (o_operations and i_count < i_capacity)
+                o_operations [i_count] = i_operations [i];
+
+            ++i_count;
+        }
+    }
+
+    return i_count;
+}
+
+static
+u32  AppendOpInfoOperations  (IM3Operation * o_operations, u32 i_count, u32 i_capacity, const M3OpInfo * i_opInfos, u32 i_numOpInfos)
+{
+    for (u32 i = 0; i < i_numOpInfos; ++i)
+        i_count = AppendOperations (o_operations, i_count, i_capacity, i_opInfos [i].operations, M3_COUNT_OF (i_opInfos [i].operations));
+
+    return i_count;
+}
+
+// lists every operation the compiler can emit, or that an executing function can patch into its code.
+// returns the total count, which can exceed i_capacity. the list can contain duplicates.
+u32  GetCompilerOperations  (IM3Operation * o_operations, u32 i_capacity)
+{
+    static const IM3Operation c_directOps [] =
+    {
+        op_Entry, op_Compile, op_Call, op_CallIndirect, op_CallRawFunction, op_Return, op_Unreachable,
+        op_Branch, op_BranchIf_r, op_BranchIf_s, op_BranchIfPrologue_r, op_BranchIfPrologue_s, op_BranchTable,
+        op_Loop, op_ContinueLoop, op_ContinueLoopIf, op_If_r, op_If_s,
+        op_Const32, op_Const64, op_MemSize, op_MemGrow, op_MemCopy, op_MemFill,
+        op_CopySlot_32, op_CopySlot_64, op_PreserveCopySlot_32, op_PreserveCopySlot_64,
+        op_GetGlobal_s32, op_GetGlobal_s64, op_SetGlobal_s32, op_SetGlobal_s64,
+#   if d_m3EnableSimd
+        op_CopySlot_128, op_PreserveCopySlot_128, op_GetGlobal_s128, op_SetGlobal_s128, op_v128_Const, op_v128_Select,
+#   endif
+#   if d_m3EnableOpTracing
+        op_DumpStack,
+#   endif
+#   if d_m3EnableJit
+        op_JitEntry,
+#   endif
+    };
+
+    u32 count = 0;
+
+    count = AppendOperations (o_operations, count, i_capacity, c_directOps, M3_COUNT_OF (c_directOps));
+    count = AppendOperations (o_operations, count, i_capacity, c_preserveSetSlot, M3_COUNT_OF (c_preserveSetSlot));
+    count = AppendOperations (o_operations, count, i_capacity, c_setSetOps, M3_COUNT_OF (c_setSetOps));
+    count = AppendOperations (o_operations, count, i_capacity, c_setGlobalOps, M3_COUNT_OF (c_setGlobalOps));
+    count = AppendOperations (o_operations, count, i_capacity, c_setRegisterOps, M3_COUNT_OF (c_setRegisterOps));
+    count = AppendOperations (o_operations, count, i_capacity, & c_intSelectOps [0][0], sizeof (c_intSelectOps) / sizeof (IM3Operation));
+#   if d_m3HasFloat
+    count = AppendOperations (o_operations, count, i_capacity, & c_fpSelectOps [0][0][0], sizeof (c_fpSelectOps) / sizeof (IM3Operation));
+#   endif
+
+    count = AppendOpInfoOperations (o_operations, count, i_capacity, c_operations, M3_COUNT_OF (c_operations));
+    count = AppendOpInfoOperations (o_operations, count, i_capacity, c_operationsFC, M3_COUNT_OF (c_operationsFC));
+#   if d_m3EnableSimd
+    count = AppendOpInfoOperations (o_operations, count, i_capacity, c_operationsFD, M3_COUNT_OF (c_operationsFD));
+#   endif
+
+    return count;
+}
+# endif
@@ -40,9 +40,12 @@ enum
     c_waOp_f64_const            = 0x44,
 
     c_waOp_extended             = 0xfc,
+    c_waOp_simd                 = 0xfd,
 
     c_waOp_memoryCopy           = 0xfc0a,
-    c_waOp_memoryFill           = 0xfc0b
+    c_waOp_memoryFill           = 0xfc0b,
+
+    c_waOp_v128_const           = 0xfd0c
 };
 
 
@@ -69,6 +69,23 @@
 #   define d_m3RecordBacktraces                 0
 # endif
 
+# ifndef d_m3EnableCodeCache
+#   define d_m3EnableCodeCache                  0       // record code relocations so that compiled modules can be serialized (see m3_cache.c)
+# endif
+
+# ifndef d_m3EnableJit
+#   define d_m3EnableJit                        0       // translate hot functions to x86-64 machine code (see m3_jit.c)
+# endif
+
+# if d_m3EnableJit && !(defined (__x86_64__) || defined (_M_X64))
+#   undef  d_m3EnableJit
+#   define d_m3EnableJit                        0
+# endif
+
+# ifndef d_m3JitHotThreshold
+#   define d_m3JitHotThreshold                  1000    // calls plus loop iterations before a function is translated
+# endif
+
 # ifndef d_m3EnableExceptionBreakpoint
 #   define d_m3EnableExceptionBreakpoint        0       // see m3_exception.h
 # endif
@@ -148,7 +165,16 @@
 # endif
 
 # ifndef d_m3SkipMemoryBoundsCheck
-#   define d_m3SkipMemoryBoundsCheck            0       // skip memory bounds checks
+#   define d_m3SkipMemoryBoundsCheck            0       // skip memory bounds checks (the host must back linear memory with guard pages)
+# endif
+
+# ifndef d_m3EnableSimd
+#   define d_m3EnableSimd                       1       // WebAssembly 128-bit SIMD (v128); see m3_exec_simd.h
+# endif
+
+# if d_m3EnableSimd && (!d_m3HasFloat || defined (M3_BIG_ENDIAN))
+#   undef  d_m3EnableSimd
+#   define d_m3EnableSimd                       0       // lanes are stored in wasm (little-endian) order
 # endif
 
 #endif // m3_config_h
@@ -203,7 +203,11 @@ M3Result NormalizeType (u8 * o_type, i8 i_convolutedWasmType)
 
     if (type == 0x40)
         type = c_m3Type_none;
+# if d_m3EnableSimd
+    else if (type < c_m3Type_i32 or type > c_m3Type_v128)
+# else
     else if (type < c_m3Type_i32 or type > c_m3Type_f64)
+# endif
         result = m3Err_invalidTypeId;
 
     * o_type = type;
@@ -228,7 +232,7 @@ bool  Is64BitType  (u8 i_m3Type)
 {
     if (i_m3Type == c_m3Type_i64 or i_m3Type == c_m3Type_f64)
         return true;
-    else if (i_m3Type == c_m3Type_i32 or i_m3Type == c_m3Type_f32 or i_m3Type == c_m3Type_none)
+    else if (i_m3Type == c_m3Type_i32 or i_m3Type == c_m3Type_f32 or i_m3Type == c_m3Type_none or i_m3Type == c_m3Type_v128)
         return false;
     else
         return (sizeof (voidptr_t) == 8); // all other cases are pointers
@@ -239,6 +243,9 @@ u32  SizeOfType  (u8 i_m3Type)
     if (i_m3Type == c_m3Type_i32 or i_m3Type == c_m3Type_f32)
         return sizeof (i32);
 
+    if (i_m3Type == c_m3Type_v128)
+        return 16;
+
     return sizeof (i64);
 }
 
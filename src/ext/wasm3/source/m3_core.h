@@ -69,6 +69,24 @@ typedef u64                     m3slot_t;
 
 typedef m3slot_t *              m3stack_t;
 
+# if d_m3EnableSimd
+// a v128 value occupies 16 bytes of consecutive slots; lane 0 is at the lowest address
+typedef union m3v128_t
+{
+    u8      u8x16   [16];
+    i8      i8x16   [16];
+    u16     u16x8   [8];
+    i16     i16x8   [8];
+    u32     u32x4   [4];
+    i32     i32x4   [4];
+    u64     u64x2   [2];
+    i64     i64x2   [2];
+    f32     f32x4   [4];
+    f64     f64x2   [2];
+}
+m3v128_t;
+# endif
+
 typedef
 const void * const  cvptr_t;
 
@@ -155,7 +173,11 @@ typedef struct M3CodePageHeader
 M3CodePageHeader;
 
 
+#if d_m3EnableSimd
+#define d_m3CodePageFreeLinesThreshold      8+2       // max is: i8x16.shuffle (3 slots + 16 immediate bytes) + 2 for bridge
+#else
 #define d_m3CodePageFreeLinesThreshold      4+2       // max is: select _sss & CallIndirect + 2 for bridge
+#endif
 
 #define d_m3MemPageSize                     65536
 
@@ -178,8 +200,8 @@ M3CodePageHeader;
 #define d_externalKind_memory               2
 #define d_externalKind_global               3
 
-static const char * const c_waTypes []          = { "nil", "i32", "i64", "f32", "f64", "unknown" };
-static const char * const c_waCompactTypes []   = { "_", "i", "I", "f", "F", "?" };
+static const char * const c_waTypes []          = { "nil", "i32", "i64", "f32", "f64", "v128", "unknown" };
+static const char * const c_waCompactTypes []   = { "_", "i", "I", "f", "F", "V", "?" };
 
 
 # if d_m3VerboseErrorMessages
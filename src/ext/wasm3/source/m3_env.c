@@ -11,6 +11,8 @@
 #include "m3_env.h"
 #include "m3_compile.h"
 #include "m3_exception.h"
+#include "m3_cache.h"
+#include "m3_jit.h"
 #include "m3_info.h"
 
 
@@ -23,7 +25,7 @@ IM3Environment  m3_NewEnvironment  ()
         _try
         {
             // create FuncTypes for all simple block return ValueTypes
-            for (u8 t = c_m3Type_none; t <= c_m3Type_f64; t++)
+            for (u8 t = c_m3Type_none; t < c_m3Type_unknown; t++)
             {
                 IM3FuncType ftype;
 _               (AllocFuncType (& ftype, 1));
@@ -34,7 +36,6 @@ _               (AllocFuncType (& ftype, 1));
 
                 Environment_AddFuncType (env, & ftype);
 
-                d_m3Assert (t < 5);
                 env->retFuncTypes [t] = ftype;
             }
         }
@@ -60,6 +61,59 @@ void m3_RuntimeSetMemoryCallbacks(IM3Runtime runtime, m3_resize_proc resizeCallb
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//NOTE(orca): compilation statistics
+void m3_RuntimeSetClockCallback(IM3Runtime runtime, m3_clock_proc clockCallback)
+{
+	runtime->clockCallback = clockCallback;
+}
+
+static
+void *  _CountCompiledFunctions  (IM3Module i_module, void * i_stats)
+{
+    M3CompileStats * stats = (M3CompileStats *) i_stats;
+
+    for (u32 i = 0; i < i_module->numFunctions; ++i)
+    {
+        IM3Function function = & i_module->functions [i];
+
+        if (function->wasm)
+        {
+            stats->numFunctions++;
+
+            if (function->compiled)
+                stats->numCompiledFunctions++;
+        }
+    }
+
+    return NULL;
+}
+
+void m3_GetCompileStats(IM3Runtime runtime, M3CompileStats* stats)
+{
+	memset (stats, 0, sizeof (M3CompileStats));
+
+	ForEachModule (runtime, _CountCompiledFunctions, stats);
+
+	stats->numCompilations = runtime->numCompilations;
+	stats->compileTime = runtime->compileTime;
+# if d_m3EnableJit
+	stats->numJitFunctions = runtime->numJitFunctions;
+	stats->jitCodeBytes = runtime->jitCodeBytes;
+# endif
+}
+
+M3Result m3_RuntimeSetJitEnabled(IM3Runtime runtime, int enabled)
+{
+# if d_m3EnableJit
+	runtime->jitEnabled = (enabled != 0);
+	return m3Err_none;
+# else
+	return enabled ? m3Err_jitDisabled : m3Err_none;
+# endif
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void  Environment_Release  (IM3Environment i_environment)
 {
     IM3FuncType ftype = i_environment->funcTypes;
@@ -244,6 +298,9 @@ void  Runtime_Release  (IM3Runtime i_runtime)
 
     m3_Free (i_runtime->stack);
 
+    FreeCodeRelocations (i_runtime);
+    FreeJitCode (i_runtime);
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 //NOTE(martin): patched to allow controlling runtime memory externally
 #if 0
@@ -325,14 +382,7 @@ M3Result  EvaluateExpression  (IM3Module i_module, void * o_expressed, u8 i_type
 
             if (r == 0)
             {                                                                               m3log (runtime, "expression result: %s", SPrintValue (stack, i_type));
-                if (SizeOfType (i_type) == sizeof (u32))
-                {
-                    * (u32 *) o_expressed = * ((u32 *) stack);
-                }
-                else
-                {
-                    * (u64 *) o_expressed = * ((u64 *) stack);
-                }
+                memcpy (o_expressed, stack, SizeOfType (i_type));
             }
         }
 
@@ -856,7 +906,11 @@ u8 *  GetStackPointerForArgs  (IM3Function i_function)
     u64 * stack = (u64 *) i_function->module->runtime->stack;
     IM3FuncType ftype = i_function->funcType;
 
-    stack += ftype->numRets;
+    for (u32 i = 0; i < ftype->numRets; ++i)
+    {
+        // v128 returns take two 64-bit cells
+        stack += (d_FuncRetType (ftype, i) == c_m3Type_v128) ? 2 : 1;
+    }
 
     return (u8 *) stack;
 }
@@ -948,6 +1002,9 @@ M3Result  m3_Call  (IM3Function i_function, uint32_t i_argc, const void * i_argp
 # if d_m3HasFloat
         case c_m3Type_f32:  *(f32*)(s) = *(f32*)i_argptrs[i];  s += 8; break;
         case c_m3Type_f64:  *(f64*)(s) = *(f64*)i_argptrs[i];  s += 8; break;
+# endif
+# if d_m3EnableSimd
+        case c_m3Type_v128: memcpy(s, i_argptrs[i], 16);       s += 16; break;
 # endif
         default: return "unknown argument type";
         }
@@ -1039,6 +1096,9 @@ M3Result  m3_GetResults  (IM3Function i_function, uint32_t i_retc, const void *
 # if d_m3HasFloat
         case c_m3Type_f32:  *(f32*)o_retptrs[i] = *(f32*)(s); s += 8; break;
         case c_m3Type_f64:  *(f64*)o_retptrs[i] = *(f64*)(s); s += 8; break;
+# endif
+# if d_m3EnableSimd
+        case c_m3Type_v128: memcpy((void*)o_retptrs[i], s, 16); s += 16; break;
 # endif
         default: return "unknown return type";
         }
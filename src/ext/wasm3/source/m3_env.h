@@ -62,6 +62,9 @@ typedef struct M3Global
 #if d_m3HasFloat
         f64 f64Value;
         f32 f32Value;
+#endif
+#if d_m3EnableSimd
+        m3v128_t v128Value;
 #endif
     };
 
@@ -191,12 +194,33 @@ typedef struct M3Runtime
 
 	u32						newCodePageSequence;
 
+#if d_m3EnableCodeCache
+    M3CodeRelocation *      codeRelocations;
+    u32                     numCodeRelocations;
+    u32                     codeRelocationsCapacity;
+    bool                    codeRelocationsOverflow;    // an allocation failed; the code can't be serialized
+#endif
+
+#if d_m3EnableJit
+    struct M3JitCode *      jitCode;
+    u32                     numJitFunctions;
+    u32                     jitCodeBytes;
+#endif
+    bool                    jitEnabled;
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 //NOTE(Martin): allow controlling memory resize
 ///////////////////////////////////////////////////////////////////////////////////////////
 	m3_resize_proc resizeCallback;
 	m3_free_proc   freeCallback;
 	void*          memoryUserData;
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//NOTE(orca): compilation statistics, see m3_GetCompileStats
+///////////////////////////////////////////////////////////////////////////////////////////
+	m3_clock_proc  clockCallback;
+	u32            numCompilations;
+	double         compileTime;
 }
 M3Runtime;
 
@@ -31,6 +31,7 @@
 #include "m3_env.h"
 #include "m3_info.h"
 #include "m3_exec_defs.h"
+#include "m3_jit.h"
 
 #include <limits.h>
 
@@ -772,6 +773,10 @@ d_m3Op  (Compile)
 
 
 
+# if d_m3EnableJit
+d_m3Op  (JitEntry);
+# endif
+
 d_m3Op  (Entry)
 {
     d_m3ClearRegisters
@@ -789,6 +794,22 @@ d_m3Op  (Entry)
     {
 #if defined(DEBUG)
         function->hits++;
+#endif
+#if d_m3EnableJit
+        // tier up: from now on, the function's entry point jumps straight to its machine code.
+        // op_Loop counts iterations into jitHits too, so a function that's called rarely but
+        // loops a lot is translated on its next call. if it can't be translated, it stays
+        // interpreted and is never considered again.
+        if (M3_UNLIKELY (++function->jitHits >= d_m3JitHotThreshold) and m3MemRuntime (_mem)->jitEnabled and not function->jitFailed)
+        {
+            if (not JitCompileFunction (function))
+            {
+                * (void **) function->compiled = (void *) op_JitEntry;
+                jumpOp (function->compiled);
+            }
+
+            function->jitFailed = true;
+        }
 #endif
         u8 * stack = (u8 *) ((m3slot_t *) _sp + function->numRetAndArgSlots);
 
@@ -834,6 +855,30 @@ d_m3Op  (Entry)
 }
 
 
+#if d_m3EnableJit
+d_m3Op  (JitEntry)
+{
+    IM3Function function = immediate (IM3Function);
+
+    if (M3_UNLIKELY (not function->jitCode))
+    {
+        // the code page was restored from a code cache, but machine code isn't cached:
+        // go back to the interpreter and count the calls again
+        function->jitHits = 0;
+        * (void **) function->compiled = (void *) op_Entry;
+        jumpOp (function->compiled);
+    }
+
+    if (M3_LIKELY ((u8 *) _sp + function->jitFrameBytes < (u8 *) _mem->maxStack))
+    {
+        m3ret_t r = ((M3JitFunction) function->jitCode) (_sp, _mem, m3MemRuntime (_mem));
+        forwardTrap (r);
+    }
+    else newTrap (m3Err_trapStackOverflow);
+}
+#endif
+
+
 d_m3Op  (Loop)
 {
     d_m3TracePrepare
@@ -846,8 +891,15 @@ d_m3Op  (Loop)
 
     IM3Memory memory = m3MemInfo (_mem);
 
+#if d_m3EnableJit
+    IM3Function function = immediate (IM3Function);
+#endif
+
     do
     {
+#if d_m3EnableJit
+        function->jitHits++;
+#endif
 #if d_m3EnableStrace >= 3
         d_m3TracePrint("iter {");
         trace_rt->callDepth++;
@@ -1453,6 +1505,10 @@ d_m3Store_i (i64, i16)
 d_m3Store_i (i64, i32)
 d_m3Store_i (i64, i64)
 
+#if d_m3EnableSimd
+#   include "m3_exec_simd.h"
+#endif
+
 #undef m3MemCheck
 
 
@@ -0,0 +1,1006 @@
+//
+//  m3_exec_simd.h
+//
+//  WebAssembly 128-bit SIMD operations. Included by m3_exec.h when d_m3EnableSimd is set.
+//
+//  v128 values never live in _r0/_fp0; every operand and result is a slot. Operations read their
+//  immediates in the same order: operand slots (deepest stack item first), destination slot, then
+//  any lane index or memory offset. Where the host has SSE, hot operations are lowered to intrinsics;
+//  everything else is a plain per-lane loop.
+//
+
+#ifndef m3_exec_simd_h
+#define m3_exec_simd_h
+
+#ifndef M3_COMPILE_OPCODES
+#  error "Opcodes should only be included in one compilation unit"
+#endif
+
+#ifndef d_m3SimdSSE2
+#   if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define d_m3SimdSSE2                     1
+#   else
+#       define d_m3SimdSSE2                     0
+#   endif
+#endif
+
+#ifndef d_m3SimdSSSE3
+#   if d_m3SimdSSE2 && (defined (__SSSE3__) || defined (__AVX__))
+#       define d_m3SimdSSSE3                    1
+#   else
+#       define d_m3SimdSSSE3                    0
+#   endif
+#endif
+
+#ifndef d_m3SimdSSE41
+#   if d_m3SimdSSE2 && (defined (__SSE4_1__) || defined (__AVX__))
+#       define d_m3SimdSSE41                    1
+#   else
+#       define d_m3SimdSSE41                    0
+#   endif
+#endif
+
+#if d_m3SimdSSE2
+#   include <emmintrin.h>
+#endif
+#if d_m3SimdSSSE3
+#   include <tmmintrin.h>
+#endif
+#if d_m3SimdSSE41
+#   include <smmintrin.h>
+#endif
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// lane operators
+//---------------------------------------------------------------------------------------------------------------------
+
+#define OP_SIMD_ADD(A,B)            ((A) + (B))
+#define OP_SIMD_SUB(A,B)            ((A) - (B))
+#define OP_SIMD_MUL(A,B)            ((A) * (B))
+#define OP_SIMD_MUL_16(A,B)         ((u32) (A) * (u32) (B))     // u16 * u16 would overflow a promoted int
+#define OP_SIMD_DIV(A,B)            ((A) / (B))
+#define OP_SIMD_AND(A,B)            ((A) & (B))
+#define OP_SIMD_OR(A,B)             ((A) | (B))
+#define OP_SIMD_XOR(A,B)            ((A) ^ (B))
+#define OP_SIMD_ANDNOT(A,B)         ((A) & ~(B))
+#define OP_SIMD_MIN(A,B)            ((A) < (B) ? (A) : (B))
+#define OP_SIMD_MAX(A,B)            ((A) > (B) ? (A) : (B))
+#define OP_SIMD_PMIN(A,B)           ((B) < (A) ? (B) : (A))
+#define OP_SIMD_PMAX(A,B)           ((A) < (B) ? (B) : (A))
+#define OP_SIMD_AVGR(A,B)           (((A) + (B) + 1) >> 1)
+
+#define OP_SIMD_SAT(X,MIN,MAX)      ((X) < (MIN) ? (MIN) : ((X) > (MAX) ? (MAX) : (X)))
+#define OP_SIMD_ADD_SAT_S8(A,B)     OP_SIMD_SAT ((A) + (B), INT8_MIN, INT8_MAX)
+#define OP_SIMD_ADD_SAT_U8(A,B)     OP_SIMD_SAT ((A) + (B), 0, UINT8_MAX)
+#define OP_SIMD_ADD_SAT_S16(A,B)    OP_SIMD_SAT ((A) + (B), INT16_MIN, INT16_MAX)
+#define OP_SIMD_ADD_SAT_U16(A,B)    OP_SIMD_SAT ((A) + (B), 0, UINT16_MAX)
+#define OP_SIMD_SUB_SAT_S8(A,B)     OP_SIMD_SAT ((A) - (B), INT8_MIN, INT8_MAX)
+#define OP_SIMD_SUB_SAT_U8(A,B)     OP_SIMD_SAT ((A) - (B), 0, UINT8_MAX)
+#define OP_SIMD_SUB_SAT_S16(A,B)    OP_SIMD_SAT ((A) - (B), INT16_MIN, INT16_MAX)
+#define OP_SIMD_SUB_SAT_U16(A,B)    OP_SIMD_SAT ((A) - (B), 0, UINT16_MAX)
+#define OP_SIMD_Q15MULR(A,B)        OP_SIMD_SAT (((A) * (B) + 0x4000) >> 15, INT16_MIN, INT16_MAX)
+
+// comparisons produce all-ones or all-zeros lanes
+#define OP_SIMD_EQ(A,B)             (-((A) == (B)))
+#define OP_SIMD_NE(A,B)             (-((A) != (B)))
+#define OP_SIMD_LT(A,B)             (-((A) <  (B)))
+#define OP_SIMD_GT(A,B)             (-((A) >  (B)))
+#define OP_SIMD_LE(A,B)             (-((A) <= (B)))
+#define OP_SIMD_GE(A,B)             (-((A) >= (B)))
+
+#define OP_SIMD_NOT(X)              (~(X))
+#define OP_SIMD_NEG(X)              (-(X))
+#define OP_SIMD_ABS(X)              ((X) < 0 ? -(X) : (X))
+#define OP_SIMD_ABS_32(X)           ((X) < 0 ? 0u - (u32) (X) : (u32) (X))
+#define OP_SIMD_ABS_64(X)           ((X) < 0 ? 0ull - (u64) (X) : (u64) (X))
+#define OP_SIMD_POPCNT(X)           __builtin_popcount (X)
+
+#define OP_SIMD_SHL(X,N)            ((u64) (X) << (N))          // narrow lanes would shift a promoted (signed) int
+#define OP_SIMD_SHR(X,N)            ((X) >> (N))
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// operation templates
+//---------------------------------------------------------------------------------------------------------------------
+
+#define d_m3SimdUnary(NAME, RLANE, LANE, N, OP)                     \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    m3v128_t r;                                                     \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+        r.RLANE [i] = OP (a.LANE [i]);                              \
+                                                                    \
+    slot (m3v128_t) = r;                                            \
+    nextOp ();                                                      \
+}
+
+#define d_m3SimdBinary(NAME, RLANE, LANE, N, OP)                    \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    m3v128_t b = slot (m3v128_t);                                   \
+    m3v128_t r;                                                     \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+        r.RLANE [i] = OP (a.LANE [i], b.LANE [i]);                  \
+                                                                    \
+    slot (m3v128_t) = r;                                            \
+    nextOp ();                                                      \
+}
+
+#define d_m3SimdShift(NAME, LANE, N, OP)                            \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    u32 n = slot (u32) & (128 / N - 1);                             \
+    m3v128_t r;                                                     \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+        r.LANE [i] = OP (a.LANE [i], n);                            \
+                                                                    \
+    slot (m3v128_t) = r;                                            \
+    nextOp ();                                                      \
+}
+
+// widen half of the source lanes; FIRST is 0 for the low half and N for the high half
+#define d_m3SimdExtend(NAME, RLANE, LANE, N, FIRST)                 \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    m3v128_t r;                                                     \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+        r.RLANE [i] = a.LANE [FIRST + i];                           \
+                                                                    \
+    slot (m3v128_t) = r;                                            \
+    nextOp ();                                                      \
+}
+
+#define d_m3SimdExtMul(NAME, RLANE, TYPE, LANE, N, FIRST)           \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    m3v128_t b = slot (m3v128_t);                                   \
+    m3v128_t r;                                                     \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+        r.RLANE [i] = (TYPE) a.LANE [FIRST + i] * (TYPE) b.LANE [FIRST + i]; \
+                                                                    \
+    slot (m3v128_t) = r;                                            \
+    nextOp ();                                                      \
+}
+
+#define d_m3SimdExtAddPairwise(NAME, RLANE, TYPE, LANE, N)          \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    m3v128_t r;                                                     \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+        r.RLANE [i] = (TYPE) a.LANE [2 * i] + (TYPE) a.LANE [2 * i + 1]; \
+                                                                    \
+    slot (m3v128_t) = r;                                            \
+    nextOp ();                                                      \
+}
+
+#define d_m3SimdNarrow(NAME, RLANE, LANE, N, MIN, MAX)              \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    m3v128_t b = slot (m3v128_t);                                   \
+    m3v128_t r;                                                     \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+    {                                                               \
+        r.RLANE [i]     = OP_SIMD_SAT (a.LANE [i], MIN, MAX);       \
+        r.RLANE [N + i] = OP_SIMD_SAT (b.LANE [i], MIN, MAX);       \
+    }                                                               \
+                                                                    \
+    slot (m3v128_t) = r;                                            \
+    nextOp ();                                                      \
+}
+
+#define d_m3SimdAllTrue(NAME, LANE, N)                              \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    i32 r = 1;                                                      \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+        r &= (a.LANE [i] != 0);                                     \
+                                                                    \
+    slot (i32) = r;                                                 \
+    nextOp ();                                                      \
+}
+
+#define d_m3SimdBitmask(NAME, LANE, N)                              \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    u32 r = 0;                                                      \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+        r |= (u32) (a.LANE [i] < 0) << i;                           \
+                                                                    \
+    slot (u32) = r;                                                 \
+    nextOp ();                                                      \
+}
+
+#define d_m3SimdSplat(NAME, LANE, N, TYPE)                          \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    TYPE x = slot (TYPE);                                           \
+    m3v128_t r;                                                     \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+        r.LANE [i] = x;                                             \
+                                                                    \
+    slot (m3v128_t) = r;                                            \
+    nextOp ();                                                      \
+}
+
+#define d_m3SimdExtractLane(NAME, LANE, TYPE)                       \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    TYPE * r = slot_ptr (TYPE);                                     \
+    u32 lane = immediate (u32);                                     \
+                                                                    \
+    * r = a.LANE [lane];                                            \
+    nextOp ();                                                      \
+}
+
+#define d_m3SimdReplaceLane(NAME, LANE, TYPE)                       \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    TYPE x = slot (TYPE);                                           \
+    m3v128_t * r = slot_ptr (m3v128_t);                             \
+    u32 lane = immediate (u32);                                     \
+                                                                    \
+    a.LANE [lane] = x;                                              \
+    * r = a;                                                        \
+    nextOp ();                                                      \
+}
+
+// the saturating truncations are statement macros; see m3_math_utils.h
+#define d_m3SimdTruncSat(NAME, RLANE, LANE, N, TRUNC)               \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    m3v128_t r;                                                     \
+    memset (& r, 0, sizeof (r));                                    \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+    {                                                               \
+        TRUNC (r.RLANE [i], a.LANE [i]);                            \
+    }                                                               \
+                                                                    \
+    slot (m3v128_t) = r;                                            \
+    nextOp ();                                                      \
+}
+
+// lane conversions that leave the upper half of the result zeroed (the wasm "_zero" variants)
+#define d_m3SimdConvertZero(NAME, RLANE, TYPE, LANE, N)             \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    m3v128_t a = slot (m3v128_t);                                   \
+    m3v128_t r;                                                     \
+    memset (& r, 0, sizeof (r));                                    \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+        r.RLANE [i] = (TYPE) a.LANE [i];                            \
+                                                                    \
+    slot (m3v128_t) = r;                                            \
+    nextOp ();                                                      \
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// intrinsic templates. the d_m3SimdXxx_isa macros below select the intrinsic when the host supports the ISA and fall
+// back to the lane loop otherwise
+//---------------------------------------------------------------------------------------------------------------------
+
+#if d_m3SimdSSE2
+
+#define d_m3SimdIntrinsicUnary(NAME, VEC, SUFFIX, INTRINSIC)        \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    VEC a = _mm_loadu_##SUFFIX ((void *) (_sp + immediate (i32)));  \
+    _mm_storeu_##SUFFIX ((void *) (_sp + immediate (i32)), INTRINSIC (a)); \
+    nextOp ();                                                      \
+}
+
+#define d_m3SimdIntrinsicBinary(NAME, VEC, SUFFIX, INTRINSIC)       \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    VEC a = _mm_loadu_##SUFFIX ((void *) (_sp + immediate (i32)));  \
+    VEC b = _mm_loadu_##SUFFIX ((void *) (_sp + immediate (i32)));  \
+    _mm_storeu_##SUFFIX ((void *) (_sp + immediate (i32)), INTRINSIC (a, b)); \
+    nextOp ();                                                      \
+}
+
+#define d_m3SimdIntrinsicShift(NAME, BITS, INTRINSIC)               \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    __m128i a = _mm_loadu_si128 ((void *) (_sp + immediate (i32))); \
+    u32 n = slot (u32) & (BITS - 1);                                \
+    _mm_storeu_si128 ((void *) (_sp + immediate (i32)), INTRINSIC (a, _mm_cvtsi32_si128 ((int) n))); \
+    nextOp ();                                                      \
+}
+
+// wasm's andnot is a & ~b; SSE's is ~a & b
+#define SSE_ANDNOT(A,B)             _mm_andnot_si128 ((B), (A))
+#define SSE_NOT(A)                  _mm_xor_si128 ((A), _mm_set1_epi32 (-1))
+#define SSE_NE_EPI8(A,B)            SSE_NOT (_mm_cmpeq_epi8 ((A), (B)))
+#define SSE_NE_EPI16(A,B)           SSE_NOT (_mm_cmpeq_epi16 ((A), (B)))
+#define SSE_NE_EPI32(A,B)           SSE_NOT (_mm_cmpeq_epi32 ((A), (B)))
+#define SSE_ABS_PS(A)               _mm_andnot_ps (_mm_set1_ps (-0.f), (A))
+#define SSE_NEG_PS(A)               _mm_xor_ps (_mm_set1_ps (-0.f), (A))
+#define SSE_ABS_PD(A)               _mm_andnot_pd (_mm_set1_pd (-0.), (A))
+#define SSE_NEG_PD(A)               _mm_xor_pd (_mm_set1_pd (-0.), (A))
+#define SSE_PMIN_PS(A,B)            _mm_min_ps ((B), (A))       // minps returns its second operand unless the first is less
+#define SSE_PMAX_PS(A,B)            _mm_max_ps ((B), (A))
+#define SSE_PMIN_PD(A,B)            _mm_min_pd ((B), (A))
+#define SSE_PMAX_PD(A,B)            _mm_max_pd ((B), (A))
+
+#   define d_m3SimdUnary_sse2(NAME, RLANE, LANE, N, OP, INTRINSIC)      d_m3SimdIntrinsicUnary  (NAME, __m128i, si128, INTRINSIC)
+#   define d_m3SimdBinary_sse2(NAME, RLANE, LANE, N, OP, INTRINSIC)     d_m3SimdIntrinsicBinary (NAME, __m128i, si128, INTRINSIC)
+#   define d_m3SimdShift_sse2(NAME, LANE, N, OP, INTRINSIC)             d_m3SimdIntrinsicShift  (NAME, 128 / N, INTRINSIC)
+#   define d_m3SimdUnary_ps(NAME, RLANE, LANE, N, OP, INTRINSIC)        d_m3SimdIntrinsicUnary  (NAME, __m128, ps, INTRINSIC)
+#   define d_m3SimdBinary_ps(NAME, RLANE, LANE, N, OP, INTRINSIC)       d_m3SimdIntrinsicBinary (NAME, __m128, ps, INTRINSIC)
+#   define d_m3SimdUnary_pd(NAME, RLANE, LANE, N, OP, INTRINSIC)        d_m3SimdIntrinsicUnary  (NAME, __m128d, pd, INTRINSIC)
+#   define d_m3SimdBinary_pd(NAME, RLANE, LANE, N, OP, INTRINSIC)       d_m3SimdIntrinsicBinary (NAME, __m128d, pd, INTRINSIC)
+#else
+#   define d_m3SimdUnary_sse2(NAME, RLANE, LANE, N, OP, INTRINSIC)      d_m3SimdUnary  (NAME, RLANE, LANE, N, OP)
+#   define d_m3SimdBinary_sse2(NAME, RLANE, LANE, N, OP, INTRINSIC)     d_m3SimdBinary (NAME, RLANE, LANE, N, OP)
+#   define d_m3SimdShift_sse2(NAME, LANE, N, OP, INTRINSIC)             d_m3SimdShift  (NAME, LANE, N, OP)
+#   define d_m3SimdUnary_ps(NAME, RLANE, LANE, N, OP, INTRINSIC)        d_m3SimdUnary  (NAME, RLANE, LANE, N, OP)
+#   define d_m3SimdBinary_ps(NAME, RLANE, LANE, N, OP, INTRINSIC)       d_m3SimdBinary (NAME, RLANE, LANE, N, OP)
+#   define d_m3SimdUnary_pd(NAME, RLANE, LANE, N, OP, INTRINSIC)        d_m3SimdUnary  (NAME, RLANE, LANE, N, OP)
+#   define d_m3SimdBinary_pd(NAME, RLANE, LANE, N, OP, INTRINSIC)       d_m3SimdBinary (NAME, RLANE, LANE, N, OP)
+#endif
+
+#if d_m3SimdSSSE3
+#   define d_m3SimdUnary_ssse3(NAME, RLANE, LANE, N, OP, INTRINSIC)     d_m3SimdIntrinsicUnary  (NAME, __m128i, si128, INTRINSIC)
+#else
+#   define d_m3SimdUnary_ssse3(NAME, RLANE, LANE, N, OP, INTRINSIC)     d_m3SimdUnary  (NAME, RLANE, LANE, N, OP)
+#endif
+
+#if d_m3SimdSSE41
+#define SSE_CEIL_PS(A)              _mm_round_ps ((A), _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC)
+#define SSE_FLOOR_PS(A)             _mm_round_ps ((A), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)
+#define SSE_TRUNC_PS(A)             _mm_round_ps ((A), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC)
+#define SSE_NEAREST_PS(A)           _mm_round_ps ((A), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)
+#define SSE_CEIL_PD(A)              _mm_round_pd ((A), _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC)
+#define SSE_FLOOR_PD(A)             _mm_round_pd ((A), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)
+#define SSE_TRUNC_PD(A)             _mm_round_pd ((A), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC)
+#define SSE_NEAREST_PD(A)           _mm_round_pd ((A), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)
+
+#   define d_m3SimdBinary_sse41(NAME, RLANE, LANE, N, OP, INTRINSIC)    d_m3SimdIntrinsicBinary (NAME, __m128i, si128, INTRINSIC)
+#   define d_m3SimdUnary_sse41ps(NAME, RLANE, LANE, N, OP, INTRINSIC)   d_m3SimdIntrinsicUnary  (NAME, __m128, ps, INTRINSIC)
+#   define d_m3SimdUnary_sse41pd(NAME, RLANE, LANE, N, OP, INTRINSIC)   d_m3SimdIntrinsicUnary  (NAME, __m128d, pd, INTRINSIC)
+#else
+#   define d_m3SimdBinary_sse41(NAME, RLANE, LANE, N, OP, INTRINSIC)    d_m3SimdBinary (NAME, RLANE, LANE, N, OP)
+#   define d_m3SimdUnary_sse41ps(NAME, RLANE, LANE, N, OP, INTRINSIC)   d_m3SimdUnary  (NAME, RLANE, LANE, N, OP)
+#   define d_m3SimdUnary_sse41pd(NAME, RLANE, LANE, N, OP, INTRINSIC)   d_m3SimdUnary  (NAME, RLANE, LANE, N, OP)
+#endif
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// slots, globals & constants
+//---------------------------------------------------------------------------------------------------------------------
+
+d_m3Op  (CopySlot_128)
+{
+    m3v128_t * dst = slot_ptr (m3v128_t);
+    m3v128_t * src = slot_ptr (m3v128_t);
+
+    * dst = * src;
+
+    nextOp ();
+}
+
+
+d_m3Op  (PreserveCopySlot_128)
+{
+    m3v128_t * dest      = slot_ptr (m3v128_t);
+    m3v128_t * src       = slot_ptr (m3v128_t);
+    m3v128_t * preserve  = slot_ptr (m3v128_t);
+
+    * preserve = * dest;
+    * dest = * src;
+
+    nextOp ();
+}
+
+
+d_m3Op  (GetGlobal_s128)
+{
+    m3v128_t * global = immediate (m3v128_t *);
+    slot (m3v128_t) = * global;
+
+    nextOp ();
+}
+
+
+d_m3Op  (SetGlobal_s128)
+{
+    m3v128_t * global = immediate (m3v128_t *);
+    * global = slot (m3v128_t);
+
+    nextOp ();
+}
+
+
+d_m3Op  (v128_Const)
+{
+    m3v128_t * r = slot_ptr (m3v128_t);
+
+    memcpy (r, _pc, sizeof (m3v128_t));
+    _pc += sizeof (m3v128_t) / sizeof (code_t);
+
+    nextOp ();
+}
+
+
+// operands are in the order the compiler pops them: selector, then the second and first values
+d_m3Op  (v128_Select)
+{
+    i32 condition = slot (i32);
+    m3v128_t b = slot (m3v128_t);
+    m3v128_t a = slot (m3v128_t);
+
+    slot (m3v128_t) = condition ? a : b;
+
+    nextOp ();
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// memory
+//---------------------------------------------------------------------------------------------------------------------
+
+// every memory operation comes in two flavors: address in a slot (_s) and address in _r0 (_r)
+#define d_m3SimdMemoryOp(NAME, BODY, ...)                           \
+d_m3Op  (NAME##_s)                                                  \
+{                                                                   \
+    u64 operand = slot (u32);                                       \
+    BODY (__VA_ARGS__)                                              \
+}                                                                   \
+d_m3Op  (NAME##_r)                                                  \
+{                                                                   \
+    u64 operand = (u32) _r0;                                        \
+    BODY (__VA_ARGS__)                                              \
+}
+
+#define d_m3SimdLoadBody(SIZE, FILL)                                \
+    m3v128_t * r = slot_ptr (m3v128_t);                             \
+    operand += immediate (u32);                                     \
+                                                                    \
+    if (m3MemCheck (operand + SIZE <= _mem->length))                \
+    {                                                               \
+        FILL (r, m3MemData (_mem) + operand);                       \
+        nextOp ();                                                  \
+    }                                                               \
+    else d_outOfBounds;
+
+#define d_m3SimdStoreBody(SIZE)                                    \
+    m3v128_t a = slot (m3v128_t);                                   \
+    operand += immediate (u32);                                     \
+                                                                    \
+    if (m3MemCheck (operand + SIZE <= _mem->length))                \
+    {                                                               \
+        memcpy (m3MemData (_mem) + operand, & a, SIZE);             \
+        nextOp ();                                                  \
+    }                                                               \
+    else d_outOfBounds;
+
+#define d_m3SimdLoadLaneBody(SIZE)                                  \
+    m3v128_t a = slot (m3v128_t);                                   \
+    m3v128_t * r = slot_ptr (m3v128_t);                             \
+    operand += immediate (u32);                                     \
+    u32 lane = immediate (u32);                                     \
+                                                                    \
+    if (m3MemCheck (operand + SIZE <= _mem->length))                \
+    {                                                               \
+        memcpy (& a.u8x16 [lane * SIZE], m3MemData (_mem) + operand, SIZE); \
+        * r = a;                                                    \
+        nextOp ();                                                  \
+    }                                                               \
+    else d_outOfBounds;
+
+#define d_m3SimdStoreLaneBody(SIZE)                                 \
+    m3v128_t a = slot (m3v128_t);                                   \
+    operand += immediate (u32);                                     \
+    u32 lane = immediate (u32);                                     \
+                                                                    \
+    if (m3MemCheck (operand + SIZE <= _mem->length))                \
+    {                                                               \
+        memcpy (m3MemData (_mem) + operand, & a.u8x16 [lane * SIZE], SIZE); \
+        nextOp ();                                                  \
+    }                                                               \
+    else d_outOfBounds;
+
+
+static inline void  SimdLoad_v128  (m3v128_t * o_value, const u8 * i_src)
+{
+    memcpy (o_value, i_src, sizeof (m3v128_t));
+}
+
+#define d_m3SimdLoadExtend(NAME, RLANE, LANE, TYPE, N)              \
+static inline void  SimdLoad_##NAME  (m3v128_t * o_value, const u8 * i_src) \
+{                                                                   \
+    TYPE lanes [N];                                                 \
+    memcpy (lanes, i_src, sizeof (lanes));                          \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+        o_value->RLANE [i] = lanes [i];                             \
+}
+
+d_m3SimdLoadExtend (i8x8,   i16x8,  i8x16,  i8,     8)
+d_m3SimdLoadExtend (u8x8,   u16x8,  u8x16,  u8,     8)
+d_m3SimdLoadExtend (i16x4,  i32x4,  i16x8,  i16,    4)
+d_m3SimdLoadExtend (u16x4,  u32x4,  u16x8,  u16,    4)
+d_m3SimdLoadExtend (i32x2,  i64x2,  i32x4,  i32,    2)
+d_m3SimdLoadExtend (u32x2,  u64x2,  u32x4,  u32,    2)
+
+#define d_m3SimdLoadSplat(NAME, LANE, TYPE, N)                      \
+static inline void  SimdLoad_##NAME  (m3v128_t * o_value, const u8 * i_src) \
+{                                                                   \
+    TYPE x;                                                         \
+    memcpy (& x, i_src, sizeof (x));                                \
+                                                                    \
+    for (u32 i = 0; i < N; ++i)                                     \
+        o_value->LANE [i] = x;                                      \
+}
+
+d_m3SimdLoadSplat (splat8,  u8x16,  u8,     16)
+d_m3SimdLoadSplat (splat16, u16x8,  u16,    8)
+d_m3SimdLoadSplat (splat32, u32x4,  u32,    4)
+d_m3SimdLoadSplat (splat64, u64x2,  u64,    2)
+
+static inline void  SimdLoad_zero32  (m3v128_t * o_value, const u8 * i_src)
+{
+    memset (o_value, 0, sizeof (m3v128_t));
+    memcpy (o_value, i_src, sizeof (u32));
+}
+
+static inline void  SimdLoad_zero64  (m3v128_t * o_value, const u8 * i_src)
+{
+    memset (o_value, 0, sizeof (m3v128_t));
+    memcpy (o_value, i_src, sizeof (u64));
+}
+
+d_m3SimdMemoryOp (v128_Load,            d_m3SimdLoadBody,       16, SimdLoad_v128)
+d_m3SimdMemoryOp (i16x8_Load_i8x8,      d_m3SimdLoadBody,       8,  SimdLoad_i8x8)
+d_m3SimdMemoryOp (i16x8_Load_u8x8,      d_m3SimdLoadBody,       8,  SimdLoad_u8x8)
+d_m3SimdMemoryOp (i32x4_Load_i16x4,     d_m3SimdLoadBody,       8,  SimdLoad_i16x4)
+d_m3SimdMemoryOp (i32x4_Load_u16x4,     d_m3SimdLoadBody,       8,  SimdLoad_u16x4)
+d_m3SimdMemoryOp (i64x2_Load_i32x2,     d_m3SimdLoadBody,       8,  SimdLoad_i32x2)
+d_m3SimdMemoryOp (i64x2_Load_u32x2,     d_m3SimdLoadBody,       8,  SimdLoad_u32x2)
+d_m3SimdMemoryOp (i8x16_LoadSplat,      d_m3SimdLoadBody,       1,  SimdLoad_splat8)
+d_m3SimdMemoryOp (i16x8_LoadSplat,      d_m3SimdLoadBody,       2,  SimdLoad_splat16)
+d_m3SimdMemoryOp (i32x4_LoadSplat,      d_m3SimdLoadBody,       4,  SimdLoad_splat32)
+d_m3SimdMemoryOp (i64x2_LoadSplat,      d_m3SimdLoadBody,       8,  SimdLoad_splat64)
+d_m3SimdMemoryOp (i32x4_LoadZero,       d_m3SimdLoadBody,       4,  SimdLoad_zero32)
+d_m3SimdMemoryOp (i64x2_LoadZero,       d_m3SimdLoadBody,       8,  SimdLoad_zero64)
+
+d_m3SimdMemoryOp (v128_Store,           d_m3SimdStoreBody,      16)
+
+d_m3SimdMemoryOp (i8x16_LoadLane,       d_m3SimdLoadLaneBody,   1)
+d_m3SimdMemoryOp (i16x8_LoadLane,       d_m3SimdLoadLaneBody,   2)
+d_m3SimdMemoryOp (i32x4_LoadLane,       d_m3SimdLoadLaneBody,   4)
+d_m3SimdMemoryOp (i64x2_LoadLane,       d_m3SimdLoadLaneBody,   8)
+
+d_m3SimdMemoryOp (i8x16_StoreLane,      d_m3SimdStoreLaneBody,  1)
+d_m3SimdMemoryOp (i16x8_StoreLane,      d_m3SimdStoreLaneBody,  2)
+d_m3SimdMemoryOp (i32x4_StoreLane,      d_m3SimdStoreLaneBody,  4)
+d_m3SimdMemoryOp (i64x2_StoreLane,      d_m3SimdStoreLaneBody,  8)
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// lanes
+//---------------------------------------------------------------------------------------------------------------------
+
+d_m3SimdSplat (i8x16_Splat,     u8x16,  16, u32)
+d_m3SimdSplat (i16x8_Splat,     u16x8,  8,  u32)
+d_m3SimdSplat (i32x4_Splat,     u32x4,  4,  u32)
+d_m3SimdSplat (i64x2_Splat,     u64x2,  2,  u64)
+d_m3SimdSplat (f32x4_Splat,     f32x4,  4,  f32)
+d_m3SimdSplat (f64x2_Splat,     f64x2,  2,  f64)
+
+d_m3SimdExtractLane (i8x16_ExtractLane,     i8x16,  i32)
+d_m3SimdExtractLane (u8x16_ExtractLane,     u8x16,  i32)
+d_m3SimdExtractLane (i16x8_ExtractLane,     i16x8,  i32)
+d_m3SimdExtractLane (u16x8_ExtractLane,     u16x8,  i32)
+d_m3SimdExtractLane (i32x4_ExtractLane,     i32x4,  i32)
+d_m3SimdExtractLane (i64x2_ExtractLane,     i64x2,  i64)
+d_m3SimdExtractLane (f32x4_ExtractLane,     f32x4,  f32)
+d_m3SimdExtractLane (f64x2_ExtractLane,     f64x2,  f64)
+
+d_m3SimdReplaceLane (i8x16_ReplaceLane,     u8x16,  u32)
+d_m3SimdReplaceLane (i16x8_ReplaceLane,     u16x8,  u32)
+d_m3SimdReplaceLane (i32x4_ReplaceLane,     u32x4,  u32)
+d_m3SimdReplaceLane (i64x2_ReplaceLane,     u64x2,  u64)
+d_m3SimdReplaceLane (f32x4_ReplaceLane,     f32x4,  f32)
+d_m3SimdReplaceLane (f64x2_ReplaceLane,     f64x2,  f64)
+
+
+d_m3Op  (i8x16_Shuffle)
+{
+    m3v128_t a = slot (m3v128_t);
+    m3v128_t b = slot (m3v128_t);
+    m3v128_t * r = slot_ptr (m3v128_t);
+
+    u8 lanes [16];
+    memcpy (lanes, _pc, sizeof (lanes));
+    _pc += sizeof (lanes) / sizeof (code_t);
+
+    for (u32 i = 0; i < 16; ++i)
+    {
+        u8 lane = lanes [i];        // validated < 32 by the compiler
+        r->u8x16 [i] = (lane < 16) ? a.u8x16 [lane] : b.u8x16 [lane - 16];
+    }
+
+    nextOp ();
+}
+
+
+#if d_m3SimdSSSE3
+// pshufb zeroes a lane when bit 7 of its index is set; saturating +0x70 sets it for every index >= 16
+#define SSE_SWIZZLE(A,B)            _mm_shuffle_epi8 ((A), _mm_adds_epu8 ((B), _mm_set1_epi8 (0x70)))
+
+d_m3SimdIntrinsicBinary (i8x16_Swizzle, __m128i, si128, SSE_SWIZZLE)
+#else
+d_m3Op  (i8x16_Swizzle)
+{
+    m3v128_t a = slot (m3v128_t);
+    m3v128_t b = slot (m3v128_t);
+    m3v128_t r;
+
+    for (u32 i = 0; i < 16; ++i)
+    {
+        u8 lane = b.u8x16 [i];
+        r.u8x16 [i] = (lane < 16) ? a.u8x16 [lane] : 0;
+    }
+
+    slot (m3v128_t) = r;
+    nextOp ();
+}
+#endif
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// bitwise
+//---------------------------------------------------------------------------------------------------------------------
+
+d_m3SimdUnary_sse2  (v128_Not,      u64x2, u64x2, 2, OP_SIMD_NOT,      SSE_NOT)
+d_m3SimdBinary_sse2 (v128_And,      u64x2, u64x2, 2, OP_SIMD_AND,      _mm_and_si128)
+d_m3SimdBinary_sse2 (v128_AndNot,   u64x2, u64x2, 2, OP_SIMD_ANDNOT,   SSE_ANDNOT)
+d_m3SimdBinary_sse2 (v128_Or,       u64x2, u64x2, 2, OP_SIMD_OR,       _mm_or_si128)
+d_m3SimdBinary_sse2 (v128_Xor,      u64x2, u64x2, 2, OP_SIMD_XOR,      _mm_xor_si128)
+
+
+d_m3Op  (v128_BitSelect)
+{
+    m3v128_t a = slot (m3v128_t);
+    m3v128_t b = slot (m3v128_t);
+    m3v128_t c = slot (m3v128_t);
+    m3v128_t r;
+
+    for (u32 i = 0; i < 2; ++i)
+        r.u64x2 [i] = (a.u64x2 [i] & c.u64x2 [i]) | (b.u64x2 [i] & ~c.u64x2 [i]);
+
+    slot (m3v128_t) = r;
+    nextOp ();
+}
+
+
+d_m3Op  (v128_AnyTrue)
+{
+    m3v128_t a = slot (m3v128_t);
+    slot (i32) = (a.u64x2 [0] | a.u64x2 [1]) != 0;
+
+    nextOp ();
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// comparisons
+//---------------------------------------------------------------------------------------------------------------------
+
+d_m3SimdBinary_sse2 (i8x16_Equal,               u8x16,  i8x16,  16, OP_SIMD_EQ, _mm_cmpeq_epi8)
+d_m3SimdBinary_sse2 (i8x16_NotEqual,            u8x16,  i8x16,  16, OP_SIMD_NE, SSE_NE_EPI8)
+d_m3SimdBinary_sse2 (i8x16_LessThan,            u8x16,  i8x16,  16, OP_SIMD_LT, _mm_cmplt_epi8)
+d_m3SimdBinary      (u8x16_LessThan,            u8x16,  u8x16,  16, OP_SIMD_LT)
+d_m3SimdBinary_sse2 (i8x16_GreaterThan,         u8x16,  i8x16,  16, OP_SIMD_GT, _mm_cmpgt_epi8)
+d_m3SimdBinary      (u8x16_GreaterThan,         u8x16,  u8x16,  16, OP_SIMD_GT)
+d_m3SimdBinary      (i8x16_LessThanOrEqual,     u8x16,  i8x16,  16, OP_SIMD_LE)
+d_m3SimdBinary      (u8x16_LessThanOrEqual,     u8x16,  u8x16,  16, OP_SIMD_LE)
+d_m3SimdBinary      (i8x16_GreaterThanOrEqual,  u8x16,  i8x16,  16, OP_SIMD_GE)
+d_m3SimdBinary      (u8x16_GreaterThanOrEqual,  u8x16,  u8x16,  16, OP_SIMD_GE)
+
+d_m3SimdBinary_sse2 (i16x8_Equal,               u16x8,  i16x8,  8,  OP_SIMD_EQ, _mm_cmpeq_epi16)
+d_m3SimdBinary_sse2 (i16x8_NotEqual,            u16x8,  i16x8,  8,  OP_SIMD_NE, SSE_NE_EPI16)
+d_m3SimdBinary_sse2 (i16x8_LessThan,            u16x8,  i16x8,  8,  OP_SIMD_LT, _mm_cmplt_epi16)
+d_m3SimdBinary      (u16x8_LessThan,            u16x8,  u16x8,  8,  OP_SIMD_LT)
+d_m3SimdBinary_sse2 (i16x8_GreaterThan,         u16x8,  i16x8,  8,  OP_SIMD_GT, _mm_cmpgt_epi16)
+d_m3SimdBinary      (u16x8_GreaterThan,         u16x8,  u16x8,  8,  OP_SIMD_GT)
+d_m3SimdBinary      (i16x8_LessThanOrEqual,     u16x8,  i16x8,  8,  OP_SIMD_LE)
+d_m3SimdBinary      (u16x8_LessThanOrEqual,     u16x8,  u16x8,  8,  OP_SIMD_LE)
+d_m3SimdBinary      (i16x8_GreaterThanOrEqual,  u16x8,  i16x8,  8,  OP_SIMD_GE)
+d_m3SimdBinary      (u16x8_GreaterThanOrEqual,  u16x8,  u16x8,  8,  OP_SIMD_GE)
+
+d_m3SimdBinary_sse2 (i32x4_Equal,               u32x4,  i32x4,  4,  OP_SIMD_EQ, _mm_cmpeq_epi32)
+d_m3SimdBinary_sse2 (i32x4_NotEqual,            u32x4,  i32x4,  4,  OP_SIMD_NE, SSE_NE_EPI32)
+d_m3SimdBinary_sse2 (i32x4_LessThan,            u32x4,  i32x4,  4,  OP_SIMD_LT, _mm_cmplt_epi32)
+d_m3SimdBinary      (u32x4_LessThan,            u32x4,  u32x4,  4,  OP_SIMD_LT)
+d_m3SimdBinary_sse2 (i32x4_GreaterThan,         u32x4,  i32x4,  4,  OP_SIMD_GT, _mm_cmpgt_epi32)
+d_m3SimdBinary      (u32x4_GreaterThan,         u32x4,  u32x4,  4,  OP_SIMD_GT)
+d_m3SimdBinary      (i32x4_LessThanOrEqual,     u32x4,  i32x4,  4,  OP_SIMD_LE)
+d_m3SimdBinary      (u32x4_LessThanOrEqual,     u32x4,  u32x4,  4,  OP_SIMD_LE)
+d_m3SimdBinary      (i32x4_GreaterThanOrEqual,  u32x4,  i32x4,  4,  OP_SIMD_GE)
+d_m3SimdBinary      (u32x4_GreaterThanOrEqual,  u32x4,  u32x4,  4,  OP_SIMD_GE)
+
+d_m3SimdBinary_sse41(i64x2_Equal,               u64x2,  i64x2,  2,  OP_SIMD_EQ, _mm_cmpeq_epi64)
+d_m3SimdBinary      (i64x2_NotEqual,            u64x2,  i64x2,  2,  OP_SIMD_NE)
+d_m3SimdBinary      (i64x2_LessThan,            u64x2,  i64x2,  2,  OP_SIMD_LT)
+d_m3SimdBinary      (i64x2_GreaterThan,         u64x2,  i64x2,  2,  OP_SIMD_GT)
+d_m3SimdBinary      (i64x2_LessThanOrEqual,     u64x2,  i64x2,  2,  OP_SIMD_LE)
+d_m3SimdBinary      (i64x2_GreaterThanOrEqual,  u64x2,  i64x2,  2,  OP_SIMD_GE)
+
+d_m3SimdBinary_ps   (f32x4_Equal,               u32x4,  f32x4,  4,  OP_SIMD_EQ, _mm_cmpeq_ps)
+d_m3SimdBinary_ps   (f32x4_NotEqual,            u32x4,  f32x4,  4,  OP_SIMD_NE, _mm_cmpneq_ps)
+d_m3SimdBinary_ps   (f32x4_LessThan,            u32x4,  f32x4,  4,  OP_SIMD_LT, _mm_cmplt_ps)
+d_m3SimdBinary_ps   (f32x4_GreaterThan,         u32x4,  f32x4,  4,  OP_SIMD_GT, _mm_cmpgt_ps)
+d_m3SimdBinary_ps   (f32x4_LessThanOrEqual,     u32x4,  f32x4,  4,  OP_SIMD_LE, _mm_cmple_ps)
+d_m3SimdBinary_ps   (f32x4_GreaterThanOrEqual,  u32x4,  f32x4,  4,  OP_SIMD_GE, _mm_cmpge_ps)
+
+d_m3SimdBinary_pd   (f64x2_Equal,               u64x2,  f64x2,  2,  OP_SIMD_EQ, _mm_cmpeq_pd)
+d_m3SimdBinary_pd   (f64x2_NotEqual,            u64x2,  f64x2,  2,  OP_SIMD_NE, _mm_cmpneq_pd)
+d_m3SimdBinary_pd   (f64x2_LessThan,            u64x2,  f64x2,  2,  OP_SIMD_LT, _mm_cmplt_pd)
+d_m3SimdBinary_pd   (f64x2_GreaterThan,         u64x2,  f64x2,  2,  OP_SIMD_GT, _mm_cmpgt_pd)
+d_m3SimdBinary_pd   (f64x2_LessThanOrEqual,     u64x2,  f64x2,  2,  OP_SIMD_LE, _mm_cmple_pd)
+d_m3SimdBinary_pd   (f64x2_GreaterThanOrEqual,  u64x2,  f64x2,  2,  OP_SIMD_GE, _mm_cmpge_pd)
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// integer arithmetic
+//---------------------------------------------------------------------------------------------------------------------
+
+d_m3SimdUnary_ssse3 (i8x16_Abs,             u8x16,  i8x16,  16, OP_SIMD_ABS,            _mm_abs_epi8)
+d_m3SimdUnary       (i8x16_Negate,          u8x16,  u8x16,  16, OP_SIMD_NEG)
+d_m3SimdUnary       (i8x16_Popcnt,          u8x16,  u8x16,  16, OP_SIMD_POPCNT)
+d_m3SimdShift       (i8x16_ShiftLeft,       u8x16,  16, OP_SIMD_SHL)
+d_m3SimdShift       (i8x16_ShiftRight,      i8x16,  16, OP_SIMD_SHR)
+d_m3SimdShift       (u8x16_ShiftRight,      u8x16,  16, OP_SIMD_SHR)
+d_m3SimdBinary_sse2 (i8x16_Add,             u8x16,  u8x16,  16, OP_SIMD_ADD,            _mm_add_epi8)
+d_m3SimdBinary_sse2 (i8x16_AddSat,          i8x16,  i8x16,  16, OP_SIMD_ADD_SAT_S8,     _mm_adds_epi8)
+d_m3SimdBinary_sse2 (u8x16_AddSat,          u8x16,  u8x16,  16, OP_SIMD_ADD_SAT_U8,     _mm_adds_epu8)
+d_m3SimdBinary_sse2 (i8x16_Subtract,        u8x16,  u8x16,  16, OP_SIMD_SUB,            _mm_sub_epi8)
+d_m3SimdBinary_sse2 (i8x16_SubtractSat,     i8x16,  i8x16,  16, OP_SIMD_SUB_SAT_S8,     _mm_subs_epi8)
+d_m3SimdBinary_sse2 (u8x16_SubtractSat,     u8x16,  u8x16,  16, OP_SIMD_SUB_SAT_U8,     _mm_subs_epu8)
+d_m3SimdBinary_sse41(i8x16_Min,             i8x16,  i8x16,  16, OP_SIMD_MIN,            _mm_min_epi8)
+d_m3SimdBinary_sse2 (u8x16_Min,             u8x16,  u8x16,  16, OP_SIMD_MIN,            _mm_min_epu8)
+d_m3SimdBinary_sse41(i8x16_Max,             i8x16,  i8x16,  16, OP_SIMD_MAX,            _mm_max_epi8)
+d_m3SimdBinary_sse2 (u8x16_Max,             u8x16,  u8x16,  16, OP_SIMD_MAX,            _mm_max_epu8)
+d_m3SimdBinary_sse2 (u8x16_AvgRound,        u8x16,  u8x16,  16, OP_SIMD_AVGR,           _mm_avg_epu8)
+
+d_m3SimdUnary_ssse3 (i16x8_Abs,             u16x8,  i16x8,  8,  OP_SIMD_ABS,            _mm_abs_epi16)
+d_m3SimdUnary       (i16x8_Negate,          u16x8,  u16x8,  8,  OP_SIMD_NEG)
+d_m3SimdBinary      (i16x8_Q15MulrSat,      i16x8,  i16x8,  8,  OP_SIMD_Q15MULR)
+d_m3SimdShift_sse2  (i16x8_ShiftLeft,       u16x8,  8,  OP_SIMD_SHL,                    _mm_sll_epi16)
+d_m3SimdShift_sse2  (i16x8_ShiftRight,      i16x8,  8,  OP_SIMD_SHR,                    _mm_sra_epi16)
+d_m3SimdShift_sse2  (u16x8_ShiftRight,      u16x8,  8,  OP_SIMD_SHR,                    _mm_srl_epi16)
+d_m3SimdBinary_sse2 (i16x8_Add,             u16x8,  u16x8,  8,  OP_SIMD_ADD,            _mm_add_epi16)
+d_m3SimdBinary_sse2 (i16x8_AddSat,          i16x8,  i16x8,  8,  OP_SIMD_ADD_SAT_S16,    _mm_adds_epi16)
+d_m3SimdBinary_sse2 (u16x8_AddSat,          u16x8,  u16x8,  8,  OP_SIMD_ADD_SAT_U16,    _mm_adds_epu16)
+d_m3SimdBinary_sse2 (i16x8_Subtract,        u16x8,  u16x8,  8,  OP_SIMD_SUB,            _mm_sub_epi16)
+d_m3SimdBinary_sse2 (i16x8_SubtractSat,     i16x8,  i16x8,  8,  OP_SIMD_SUB_SAT_S16,    _mm_subs_epi16)
+d_m3SimdBinary_sse2 (u16x8_SubtractSat,     u16x8,  u16x8,  8,  OP_SIMD_SUB_SAT_U16,    _mm_subs_epu16)
+d_m3SimdBinary_sse2 (i16x8_Multiply,        u16x8,  u16x8,  8,  OP_SIMD_MUL_16,         _mm_mullo_epi16)
+d_m3SimdBinary_sse2 (i16x8_Min,             i16x8,  i16x8,  8,  OP_SIMD_MIN,            _mm_min_epi16)
+d_m3SimdBinary_sse41(u16x8_Min,             u16x8,  u16x8,  8,  OP_SIMD_MIN,            _mm_min_epu16)
+d_m3SimdBinary_sse2 (i16x8_Max,             i16x8,  i16x8,  8,  OP_SIMD_MAX,            _mm_max_epi16)
+d_m3SimdBinary_sse41(u16x8_Max,             u16x8,  u16x8,  8,  OP_SIMD_MAX,            _mm_max_epu16)
+d_m3SimdBinary_sse2 (u16x8_AvgRound,        u16x8,  u16x8,  8,  OP_SIMD_AVGR,           _mm_avg_epu16)
+
+d_m3SimdUnary_ssse3 (i32x4_Abs,             u32x4,  i32x4,  4,  OP_SIMD_ABS_32,         _mm_abs_epi32)
+d_m3SimdUnary       (i32x4_Negate,          u32x4,  u32x4,  4,  OP_SIMD_NEG)
+d_m3SimdShift_sse2  (i32x4_ShiftLeft,       u32x4,  4,  OP_SIMD_SHL,                    _mm_sll_epi32)
+d_m3SimdShift_sse2  (i32x4_ShiftRight,      i32x4,  4,  OP_SIMD_SHR,                    _mm_sra_epi32)
+d_m3SimdShift_sse2  (u32x4_ShiftRight,      u32x4,  4,  OP_SIMD_SHR,                    _mm_srl_epi32)
+d_m3SimdBinary_sse2 (i32x4_Add,             u32x4,  u32x4,  4,  OP_SIMD_ADD,            _mm_add_epi32)
+d_m3SimdBinary_sse2 (i32x4_Subtract,        u32x4,  u32x4,  4,  OP_SIMD_SUB,            _mm_sub_epi32)
+d_m3SimdBinary_sse41(i32x4_Multiply,        u32x4,  u32x4,  4,  OP_SIMD_MUL,            _mm_mullo_epi32)
+d_m3SimdBinary_sse41(i32x4_Min,             i32x4,  i32x4,  4,  OP_SIMD_MIN,            _mm_min_epi32)
+d_m3SimdBinary_sse41(u32x4_Min,             u32x4,  u32x4,  4,  OP_SIMD_MIN,            _mm_min_epu32)
+d_m3SimdBinary_sse41(i32x4_Max,             i32x4,  i32x4,  4,  OP_SIMD_MAX,            _mm_max_epi32)
+d_m3SimdBinary_sse41(u32x4_Max,             u32x4,  u32x4,  4,  OP_SIMD_MAX,            _mm_max_epu32)
+
+d_m3SimdUnary       (i64x2_Abs,             u64x2,  i64x2,  2,  OP_SIMD_ABS_64)
+d_m3SimdUnary       (i64x2_Negate,          u64x2,  u64x2,  2,  OP_SIMD_NEG)
+d_m3SimdShift_sse2  (i64x2_ShiftLeft,       u64x2,  2,  OP_SIMD_SHL,                    _mm_sll_epi64)
+d_m3SimdShift       (i64x2_ShiftRight,      i64x2,  2,  OP_SIMD_SHR)
+d_m3SimdShift_sse2  (u64x2_ShiftRight,      u64x2,  2,  OP_SIMD_SHR,                    _mm_srl_epi64)
+d_m3SimdBinary_sse2 (i64x2_Add,             u64x2,  u64x2,  2,  OP_SIMD_ADD,            _mm_add_epi64)
+d_m3SimdBinary_sse2 (i64x2_Subtract,        u64x2,  u64x2,  2,  OP_SIMD_SUB,            _mm_sub_epi64)
+d_m3SimdBinary      (i64x2_Multiply,        u64x2,  u64x2,  2,  OP_SIMD_MUL)
+
+d_m3SimdAllTrue     (i8x16_AllTrue,         u8x16,  16)
+d_m3SimdAllTrue     (i16x8_AllTrue,         u16x8,  8)
+d_m3SimdAllTrue     (i32x4_AllTrue,         u32x4,  4)
+d_m3SimdAllTrue     (i64x2_AllTrue,         u64x2,  2)
+
+d_m3SimdBitmask     (i16x8_Bitmask,         i16x8,  8)
+d_m3SimdBitmask     (i64x2_Bitmask,         i64x2,  2)
+
+#if d_m3SimdSSE2
+d_m3Op  (i8x16_Bitmask)
+{
+    __m128i a = _mm_loadu_si128 ((void *) (_sp + immediate (i32)));
+    slot (i32) = _mm_movemask_epi8 (a);
+
+    nextOp ();
+}
+
+d_m3Op  (i32x4_Bitmask)
+{
+    __m128 a = _mm_loadu_ps ((void *) (_sp + immediate (i32)));
+    slot (i32) = _mm_movemask_ps (a);
+
+    nextOp ();
+}
+#else
+d_m3SimdBitmask     (i8x16_Bitmask,         i8x16,  16)
+d_m3SimdBitmask     (i32x4_Bitmask,         i32x4,  4)
+#endif
+
+
+d_m3Op  (i32x4_Dot_i16x8)
+{
+#if d_m3SimdSSE2
+    __m128i a = _mm_loadu_si128 ((void *) (_sp + immediate (i32)));
+    __m128i b = _mm_loadu_si128 ((void *) (_sp + immediate (i32)));
+    _mm_storeu_si128 ((void *) (_sp + immediate (i32)), _mm_madd_epi16 (a, b));
+#else
+    m3v128_t a = slot (m3v128_t);
+    m3v128_t b = slot (m3v128_t);
+    m3v128_t r;
+
+    // the sum overflows an int for -32768 * -32768 * 2; it wraps like pmaddwd
+    for (u32 i = 0; i < 4; ++i)
+        r.u32x4 [i] = (u32) (a.i16x8 [2 * i] * b.i16x8 [2 * i]) + (u32) (a.i16x8 [2 * i + 1] * b.i16x8 [2 * i + 1]);
+
+    slot (m3v128_t) = r;
+#endif
+    nextOp ();
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// widening & narrowing
+//---------------------------------------------------------------------------------------------------------------------
+
+#if d_m3SimdSSE2
+d_m3SimdIntrinsicBinary (i8x16_Narrow_i16x8,    __m128i, si128, _mm_packs_epi16)
+d_m3SimdIntrinsicBinary (u8x16_Narrow_i16x8,    __m128i, si128, _mm_packus_epi16)
+d_m3SimdIntrinsicBinary (i16x8_Narrow_i32x4,    __m128i, si128, _mm_packs_epi32)
+#else
+d_m3SimdNarrow (i8x16_Narrow_i16x8,     i8x16,  i16x8,  8,  INT8_MIN,   INT8_MAX)
+d_m3SimdNarrow (u8x16_Narrow_i16x8,     u8x16,  i16x8,  8,  0,          UINT8_MAX)
+d_m3SimdNarrow (i16x8_Narrow_i32x4,     i16x8,  i32x4,  4,  INT16_MIN,  INT16_MAX)
+#endif
+
+#if d_m3SimdSSE41
+d_m3SimdIntrinsicBinary (u16x8_Narrow_i32x4,    __m128i, si128, _mm_packus_epi32)
+#else
+d_m3SimdNarrow (u16x8_Narrow_i32x4,     u16x8,  i32x4,  4,  0,          UINT16_MAX)
+#endif
+
+d_m3SimdExtend (i16x8_ExtendLow_i8x16,      i16x8,  i8x16,  8,  0)
+d_m3SimdExtend (i16x8_ExtendHigh_i8x16,     i16x8,  i8x16,  8,  8)
+d_m3SimdExtend (i16x8_ExtendLow_u8x16,      u16x8,  u8x16,  8,  0)
+d_m3SimdExtend (i16x8_ExtendHigh_u8x16,     u16x8,  u8x16,  8,  8)
+d_m3SimdExtend (i32x4_ExtendLow_i16x8,      i32x4,  i16x8,  4,  0)
+d_m3SimdExtend (i32x4_ExtendHigh_i16x8,     i32x4,  i16x8,  4,  4)
+d_m3SimdExtend (i32x4_ExtendLow_u16x8,      u32x4,  u16x8,  4,  0)
+d_m3SimdExtend (i32x4_ExtendHigh_u16x8,     u32x4,  u16x8,  4,  4)
+d_m3SimdExtend (i64x2_ExtendLow_i32x4,      i64x2,  i32x4,  2,  0)
+d_m3SimdExtend (i64x2_ExtendHigh_i32x4,     i64x2,  i32x4,  2,  2)
+d_m3SimdExtend (i64x2_ExtendLow_u32x4,      u64x2,  u32x4,  2,  0)
+d_m3SimdExtend (i64x2_ExtendHigh_u32x4,     u64x2,  u32x4,  2,  2)
+
+d_m3SimdExtMul (i16x8_ExtMulLow_i8x16,      i16x8,  i32,    i8x16,  8,  0)
+d_m3SimdExtMul (i16x8_ExtMulHigh_i8x16,     i16x8,  i32,    i8x16,  8,  8)
+d_m3SimdExtMul (i16x8_ExtMulLow_u8x16,      u16x8,  u32,    u8x16,  8,  0)
+d_m3SimdExtMul (i16x8_ExtMulHigh_u8x16,     u16x8,  u32,    u8x16,  8,  8)
+d_m3SimdExtMul (i32x4_ExtMulLow_i16x8,      i32x4,  i32,    i16x8,  4,  0)
+d_m3SimdExtMul (i32x4_ExtMulHigh_i16x8,     i32x4,  i32,    i16x8,  4,  4)
+d_m3SimdExtMul (i32x4_ExtMulLow_u16x8,      u32x4,  u32,    u16x8,  4,  0)
+d_m3SimdExtMul (i32x4_ExtMulHigh_u16x8,     u32x4,  u32,    u16x8,  4,  4)
+d_m3SimdExtMul (i64x2_ExtMulLow_i32x4,      i64x2,  i64,    i32x4,  2,  0)
+d_m3SimdExtMul (i64x2_ExtMulHigh_i32x4,     i64x2,  i64,    i32x4,  2,  2)
+d_m3SimdExtMul (i64x2_ExtMulLow_u32x4,      u64x2,  u64,    u32x4,  2,  0)
+d_m3SimdExtMul (i64x2_ExtMulHigh_u32x4,     u64x2,  u64,    u32x4,  2,  2)
+
+d_m3SimdExtAddPairwise (i16x8_ExtAddPairwise_i8x16,     i16x8,  i32,    i8x16,  8)
+d_m3SimdExtAddPairwise (i16x8_ExtAddPairwise_u8x16,     u16x8,  u32,    u8x16,  8)
+d_m3SimdExtAddPairwise (i32x4_ExtAddPairwise_i16x8,     i32x4,  i32,    i16x8,  4)
+d_m3SimdExtAddPairwise (i32x4_ExtAddPairwise_u16x8,     u32x4,  u32,    u16x8,  4)
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// floating point
+//---------------------------------------------------------------------------------------------------------------------
+
+d_m3SimdUnary_ps    (f32x4_Abs,         f32x4,  f32x4,  4,  fabsf,          SSE_ABS_PS)
+d_m3SimdUnary_ps    (f32x4_Negate,      f32x4,  f32x4,  4,  OP_SIMD_NEG,    SSE_NEG_PS)
+d_m3SimdUnary_ps    (f32x4_Sqrt,        f32x4,  f32x4,  4,  sqrtf,          _mm_sqrt_ps)
+d_m3SimdUnary_sse41ps (f32x4_Ceil,      f32x4,  f32x4,  4,  ceilf,          SSE_CEIL_PS)
+d_m3SimdUnary_sse41ps (f32x4_Floor,     f32x4,  f32x4,  4,  floorf,         SSE_FLOOR_PS)
+d_m3SimdUnary_sse41ps (f32x4_Trunc,     f32x4,  f32x4,  4,  truncf,         SSE_TRUNC_PS)
+d_m3SimdUnary_sse41ps (f32x4_Nearest,   f32x4,  f32x4,  4,  rintf,          SSE_NEAREST_PS)
+d_m3SimdBinary_ps   (f32x4_Add,         f32x4,  f32x4,  4,  OP_SIMD_ADD,    _mm_add_ps)
+d_m3SimdBinary_ps   (f32x4_Subtract,    f32x4,  f32x4,  4,  OP_SIMD_SUB,    _mm_sub_ps)
+d_m3SimdBinary_ps   (f32x4_Multiply,    f32x4,  f32x4,  4,  OP_SIMD_MUL,    _mm_mul_ps)
+d_m3SimdBinary_ps   (f32x4_Divide,      f32x4,  f32x4,  4,  OP_SIMD_DIV,    _mm_div_ps)
+d_m3SimdBinary      (f32x4_Min,         f32x4,  f32x4,  4,  min_f32)
+d_m3SimdBinary      (f32x4_Max,         f32x4,  f32x4,  4,  max_f32)
+d_m3SimdBinary_ps   (f32x4_PMin,        f32x4,  f32x4,  4,  OP_SIMD_PMIN,   SSE_PMIN_PS)
+d_m3SimdBinary_ps   (f32x4_PMax,        f32x4,  f32x4,  4,  OP_SIMD_PMAX,   SSE_PMAX_PS)
+
+d_m3SimdUnary_pd    (f64x2_Abs,         f64x2,  f64x2,  2,  fabs,           SSE_ABS_PD)
+d_m3SimdUnary_pd    (f64x2_Negate,      f64x2,  f64x2,  2,  OP_SIMD_NEG,    SSE_NEG_PD)
+d_m3SimdUnary_pd    (f64x2_Sqrt,        f64x2,  f64x2,  2,  sqrt,           _mm_sqrt_pd)
+d_m3SimdUnary_sse41pd (f64x2_Ceil,      f64x2,  f64x2,  2,  ceil,           SSE_CEIL_PD)
+d_m3SimdUnary_sse41pd (f64x2_Floor,     f64x2,  f64x2,  2,  floor,          SSE_FLOOR_PD)
+d_m3SimdUnary_sse41pd (f64x2_Trunc,     f64x2,  f64x2,  2,  trunc,          SSE_TRUNC_PD)
+d_m3SimdUnary_sse41pd (f64x2_Nearest,   f64x2,  f64x2,  2,  rint,           SSE_NEAREST_PD)
+d_m3SimdBinary_pd   (f64x2_Add,         f64x2,  f64x2,  2,  OP_SIMD_ADD,    _mm_add_pd)
+d_m3SimdBinary_pd   (f64x2_Subtract,    f64x2,  f64x2,  2,  OP_SIMD_SUB,    _mm_sub_pd)
+d_m3SimdBinary_pd   (f64x2_Multiply,    f64x2,  f64x2,  2,  OP_SIMD_MUL,    _mm_mul_pd)
+d_m3SimdBinary_pd   (f64x2_Divide,      f64x2,  f64x2,  2,  OP_SIMD_DIV,    _mm_div_pd)
+d_m3SimdBinary      (f64x2_Min,         f64x2,  f64x2,  2,  min_f64)
+d_m3SimdBinary      (f64x2_Max,         f64x2,  f64x2,  2,  max_f64)
+d_m3SimdBinary_pd   (f64x2_PMin,        f64x2,  f64x2,  2,  OP_SIMD_PMIN,   SSE_PMIN_PD)
+d_m3SimdBinary_pd   (f64x2_PMax,        f64x2,  f64x2,  2,  OP_SIMD_PMAX,   SSE_PMAX_PD)
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// conversions
+//---------------------------------------------------------------------------------------------------------------------
+
+d_m3SimdTruncSat (i32x4_TruncSat_f32x4,         i32x4,  f32x4,  4,  OP_I32_TRUNC_SAT_F32)
+d_m3SimdTruncSat (u32x4_TruncSat_f32x4,         u32x4,  f32x4,  4,  OP_U32_TRUNC_SAT_F32)
+d_m3SimdTruncSat (i32x4_TruncSatZero_f64x2,     i32x4,  f64x2,  2,  OP_I32_TRUNC_SAT_F64)
+d_m3SimdTruncSat (u32x4_TruncSatZero_f64x2,     u32x4,  f64x2,  2,  OP_U32_TRUNC_SAT_F64)
+
+d_m3SimdConvertZero (f32x4_Convert_u32x4,       f32x4,  f32,    u32x4,  4)
+d_m3SimdConvertZero (f64x2_ConvertLow_u32x4,    f64x2,  f64,    u32x4,  2)
+
+#if d_m3SimdSSE2
+#define d_m3SimdIntrinsicConvert(NAME, VEC, FROM, TO, INTRINSIC)    \
+d_m3Op  (NAME)                                                      \
+{                                                                   \
+    VEC a = _mm_loadu_##FROM ((void *) (_sp + immediate (i32)));    \
+    _mm_storeu_##TO ((void *) (_sp + immediate (i32)), INTRINSIC (a)); \
+    nextOp ();                                                      \
+}
+
+d_m3SimdIntrinsicConvert (f32x4_Convert_i32x4,      __m128i,    si128,  ps, _mm_cvtepi32_ps)
+d_m3SimdIntrinsicConvert (f64x2_ConvertLow_i32x4,   __m128i,    si128,  pd, _mm_cvtepi32_pd)
+d_m3SimdIntrinsicConvert (f32x4_DemoteZero_f64x2,   __m128d,    pd,     ps, _mm_cvtpd_ps)
+d_m3SimdIntrinsicConvert (f64x2_PromoteLow_f32x4,   __m128,     ps,     pd, _mm_cvtps_pd)
+#else
+d_m3SimdConvertZero (f32x4_Convert_i32x4,       f32x4,  f32,    i32x4,  4)
+d_m3SimdConvertZero (f64x2_ConvertLow_i32x4,    f64x2,  f64,    i32x4,  2)
+d_m3SimdConvertZero (f32x4_DemoteZero_f64x2,    f32x4,  f32,    f64x2,  2)
+d_m3SimdConvertZero (f64x2_PromoteLow_f32x4,    f64x2,  f64,    f32x4,  2)
+#endif
+
+#endif // m3_exec_simd_h
@@ -76,6 +76,13 @@ typedef struct M3Function
 
     u16                     numConstantBytes;
     void *                  constants;
+
+# if d_m3EnableJit
+    u32                     jitHits;                                // calls counted by op_Entry, iterations by op_Loop
+    void *                  jitCode;                                // M3JitFunction
+    u32                     jitFrameBytes;
+    bool                    jitFailed;
+# endif
 }
 M3Function;
 
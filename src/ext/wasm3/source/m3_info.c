@@ -60,7 +60,7 @@ void  m3_PrintRuntimeInfo  (IM3Runtime i_runtime)
 
 cstr_t  GetTypeName  (u8 i_m3Type)
 {
-    if (i_m3Type < 5)
+    if (i_m3Type < c_m3Type_unknown)
         return c_waTypes [i_m3Type];
     else
         return "?";
@@ -114,6 +114,10 @@ size_t  SPrintArg  (char * o_string, size_t i_stringBufferSize, voidptr_t i_sp,
     else if (i_type == c_m3Type_f64)
         len = snprintf (o_string, i_stringBufferSize, "%" PRIf64, * (f64 *) i_sp);
 #endif
+#if d_m3EnableSimd
+    else if (i_type == c_m3Type_v128)
+        len = snprintf (o_string, i_stringBufferSize, "0x%016" PRIx64 "%016" PRIx64, ((u64 *) i_sp) [1], ((u64 *) i_sp) [0]);
+#endif
 
     len = M3_MAX (0, len);
 
@@ -154,7 +158,8 @@ cstr_t  SPrintFunctionArgList  (IM3Function i_function, m3stack_t i_sp)
             ret = snprintf (s, e-s, "%s: ", c_waTypes [type]);
             s += M3_MAX (0, ret);
 
-            s += SPrintArg (s, e-s, argSp + i, type);
+            s += SPrintArg (s, e-s, argSp, type);
+            argSp += (type == c_m3Type_v128) ? 2 : 1;
 
             if (i != numArgs - 1) {
                 ret = snprintf (s, e-s, ", ");
@@ -265,6 +270,16 @@ d_m3Decoder  (BranchTable)
 }
 
 
+#if d_m3EnableJit
+d_m3Decoder (Loop)
+{
+    IM3Function function = fetch (IM3Function);
+
+    sprintf (o_string, "%s", m3_GetFunctionName(function));
+}
+#endif
+
+
 d_m3Decoder  (Const)
 {
     u64 value = fetch (u64); i32 offset = fetch (i32);
@@ -282,6 +297,9 @@ void  DecodeOperation  (char * o_string, u8 i_opcode, IM3Operation i_operation,
     {
 //        d_m3Decode (0xc0,                  Const)
         d_m3Decode (0xc5,                  Entry)
+#if d_m3EnableJit
+        d_m3Decode (c_waOp_loop,           Loop)
+#endif
         d_m3Decode (c_waOp_call,           Call)
         d_m3Decode (c_waOp_branch,         Branch)
         d_m3Decode (c_waOp_branchTable,    BranchTable)
@@ -0,0 +1,2319 @@
+//
+//  m3_jit.c
+//
+//  Baseline x86-64 tier.
+//
+//  op_Entry counts the calls of each function. Once a function gets hot, its wasm body is
+//  translated to machine code, one template per opcode, and the function's op_Entry is
+//  rewritten to op_JitEntry. Everything else (callers, tables, exports) keeps pointing at
+//  the interpreted code, so the interpreter remains the fallback: a function that uses an
+//  opcode this file doesn't handle is simply never promoted.
+//
+//  The machine code uses the interpreter's calling convention. Returns and arguments live in
+//  64-bit cells at the start of the frame, followed by the locals, followed by the wasm
+//  operand stack. Every operand stack position maps to a fixed cell, but an operand only goes
+//  there when it has to: constants and local.get are tracked without emitting code, results
+//  stay in registers, and a compare feeding br_if or if stays in the flags. Operands are
+//  flushed to their cells at block boundaries and around calls, so that all the paths into a
+//  label agree on where the values are.
+//
+//      rbx     frame (the interpreter's _sp)
+//      r12     linear memory base
+//      r13     linear memory length, for bounds checks
+//      r14     runtime
+//      rsi, rdi, r8-r11, r15   operands
+//      rax, rcx, rdx           scratch
+//
+//  The body has already been validated by CompileFunction, so the operand stack and the block
+//  nesting are trusted here.
+//
+//  Calls go through the interpreter (which dispatches to op_JitEntry for promoted callees),
+//  so linear memory is reloaded after each of them. Traps return the same M3Result strings
+//  as the interpreter.
+//
+
+#define _DEFAULT_SOURCE         // MAP_ANONYMOUS
+
+#include <stddef.h>
+
+#include "m3_jit.h"
+#include "m3_compile.h"
+#include "m3_exception.h"
+#include "m3_math_utils.h"
+
+# if d_m3EnableJit
+
+# if defined (_WIN32)
+#   define WIN32_LEAN_AND_MEAN
+#   include <windows.h>
+# else
+#   include <sys/mman.h>
+# endif
+
+//---------------------------------------------------------------------------------------------------------------------------------
+
+enum
+{
+    c_rax = 0, c_rcx, c_rdx, c_rbx, c_rsp, c_rbp, c_rsi, c_rdi,
+    c_r8, c_r9, c_r10, c_r11, c_r12, c_r13, c_r14, c_r15
+};
+
+// condition codes
+enum
+{
+    c_ccB = 0x2, c_ccAE = 0x3, c_ccE = 0x4, c_ccNE = 0x5, c_ccBE = 0x6, c_ccA = 0x7,
+    c_ccP = 0xA, c_ccNP = 0xB, c_ccL = 0xC, c_ccGE = 0xD, c_ccLE = 0xE, c_ccG = 0xF,
+    c_ccAlways = 0xFF
+};
+
+// host calling convention
+# if defined (_WIN32)
+static const u8 c_argRegs [] = { c_rcx, c_rdx, c_r8, c_r9 };
+# else
+static const u8 c_argRegs [] = { c_rdi, c_rsi, c_rdx, c_rcx };
+# endif
+
+#define c_frameRegister         c_rbx
+#define c_memoryRegister        c_r12
+#define c_lengthRegister        c_r13           // unused with guard pages, which do the bounds checks
+#define c_runtimeRegister       c_r14
+
+// fixup targets that aren't blocks
+#define c_targetEpilogue        0xffff0000
+#define c_targetTrap            0xffff0001      // + trap kind
+
+enum
+{
+    c_trapOutOfBounds,
+    c_trapDivisionByZero,
+    c_trapIntegerOverflow,
+    c_trapUnreachable,
+
+    c_numTraps
+};
+
+#define d_m3JitMaxBlockDepth    1024
+
+// the opcodes m3_compile.h doesn't name
+enum
+{
+    c_jitOp_unreachable         = 0x00,
+    c_jitOp_nop                 = 0x01,
+    c_jitOp_return              = 0x0f,
+    c_jitOp_callIndirect        = 0x11,
+    c_jitOp_drop                = 0x1a,
+    c_jitOp_select              = 0x1b,
+    c_jitOp_selectTyped         = 0x1c,
+    c_jitOp_setGlobal           = 0x24,
+    c_jitOp_i32_load            = 0x28,
+    c_jitOp_i32_store           = 0x36,
+    c_jitOp_lastStore           = 0x3e,
+    c_jitOp_memorySize          = 0x3f,
+    c_jitOp_memoryGrow          = 0x40
+};
+
+// where an operand stack value currently is
+enum
+{
+    c_jitCell,                              // in its operand stack cell
+    c_jitConstant,                          // 'value'
+    c_jitLocal,                             // still in local 'value'
+    c_jitRegister,                          // in 'reg'
+    c_jitFlags                              // the result of a compare: true when condition 'reg' holds
+};
+
+typedef struct M3JitOperand
+{
+    u8                      kind;
+    u8                      reg;
+    u64                     value;
+}
+M3JitOperand;
+
+// caller saved in the host ABI, or saved by the prologue
+static const u8 c_operandRegisters [] = { c_rsi, c_rdi, c_r8, c_r9, c_r10, c_r11, c_r15 };
+
+typedef struct M3JitFixup
+{
+    u32                     location;       // of a rel32
+    u32                     target;         // block level, c_targetEpilogue or c_targetTrap + kind
+}
+M3JitFixup;
+
+typedef struct M3JitBlock
+{
+    u8                      opcode;         // c_waOp_block, loop or if
+    bool                    dead;           // opened in unreachable code: nothing is emitted for it
+    u16                     numParams;
+    u16                     numResults;
+    u32                     entryDepth;     // operand stack depth below the params
+    u32                     start;          // loop: branch target
+    i32                     elseFixup;      // if: location of the jump to the else arm, or -1
+}
+M3JitBlock;
+
+typedef struct M3Jit
+{
+    IM3Function             function;
+    IM3Module               module;
+    bytes_t                 wasm;
+    bytes_t                 wasmEnd;
+
+    u8 *                    code;
+    u32                     size;
+    u32                     capacity;
+    bool                    outOfMemory;
+
+    M3JitFixup *            fixups;
+    u32                     numFixups;
+    u32                     fixupsCapacity;
+
+    M3JitBlock              blocks [d_m3JitMaxBlockDepth];
+    u32                     numBlocks;
+
+    u32                     numRets;
+    u32                     numArgs;
+    u32                     numLocals;      // declared locals, not including args
+
+    u32                     stackBase;      // cell index of the operand stack
+    u32                     depth;
+    u32                     maxDepth;       // including the frames set up for calls
+
+    M3JitOperand            operands [d_m3MaxFunctionStackHeight];
+    u32                     usedRegisters;  // mask of the operand registers in use
+
+    bool                    unreachable;
+    bool                    usesTrap [c_numTraps];
+}
+M3Jit;
+
+typedef M3Jit *             IM3Jit;
+
+//---------------------------------------------------------------------------------------------------------------------------------
+// encoding
+//---------------------------------------------------------------------------------------------------------------------------------
+
+static
+void  Emit8  (IM3Jit o, u8 i_byte)
+{
+    if (M3_UNLIKELY (o->size == o->capacity))
+    {
+        u32 capacity = o->capacity ? o->capacity * 2 : 4096;
+        u8 * code = m3_ReallocArray (u8, o->code, capacity, o->capacity);
+
+        if (not code)
+        {
+            o->outOfMemory = true;
+            o->size = 0;
+            return;
+        }
+
+        o->code = code;
+        o->capacity = capacity;
+    }
+
+    o->code [o->size++] = i_byte;
+}
+
+static
+void  Emit32  (IM3Jit o, u32 i_value)
+{
+    for (u32 i = 0; i < 4; ++i)
+        Emit8 (o, (u8) (i_value >> (i * 8)));
+}
+
+static
+void  Emit64  (IM3Jit o, u64 i_value)
+{
+    Emit32 (o, (u32) i_value);
+    Emit32 (o, (u32) (i_value >> 32));
+}
+
+static
+void  EmitPrefixAndRex  (IM3Jit o, u8 i_prefix, bool i_wide, u8 i_reg, u8 i_index, u8 i_base)
+{
+    if (i_prefix)
+        Emit8 (o, i_prefix);
+
+    u8 rex = 0x40 | (i_wide << 3) | ((i_reg & 8) >> 1) | ((i_index & 8) >> 2) | ((i_base & 8) >> 3);
+    if (rex != 0x40)
+        Emit8 (o, rex);
+}
+
+static
+void  EmitOpcode  (IM3Jit o, u16 i_opcode)
+{
+    if (i_opcode > 0xff)
+        Emit8 (o, (u8) (i_opcode >> 8));        // 0x0f escape
+
+    Emit8 (o, (u8) i_opcode);
+}
+
+static
+void  EmitDisplacement  (IM3Jit o, u8 i_modRM, u8 i_sib, bool i_hasSib, i32 i_disp)
+{
+    bool shortDisp = (i_disp == (i8) i_disp);
+
+    Emit8 (o, (shortDisp ? 0x40 : 0x80) | i_modRM);
+
+    if (i_hasSib)
+        Emit8 (o, i_sib);
+
+    if (shortDisp)
+        Emit8 (o, (u8) i_disp);
+    else
+        Emit32 (o, (u32) i_disp);
+}
+
+// op reg, [base + disp]
+static
+void  EmitRM  (IM3Jit o, u8 i_prefix, bool i_wide, u16 i_opcode, u8 i_reg, u8 i_base, i32 i_disp)
+{
+    EmitPrefixAndRex (o, i_prefix, i_wide, i_reg, 0, i_base);
+    EmitOpcode (o, i_opcode);
+    EmitDisplacement (o, ((i_reg & 7) << 3) | (i_base & 7), 0x24, (i_base & 7) == c_rsp, i_disp);
+}
+
+// op reg, rm
+static
+void  EmitRR  (IM3Jit o, u8 i_prefix, bool i_wide, u16 i_opcode, u8 i_reg, u8 i_rm)
+{
+    EmitPrefixAndRex (o, i_prefix, i_wide, i_reg, 0, i_rm);
+    EmitOpcode (o, i_opcode);
+    Emit8 (o, 0xC0 | ((i_reg & 7) << 3) | (i_rm & 7));
+}
+
+// op reg, [r12 + rax + disp]
+static
+void  EmitLinearMemoryRM  (IM3Jit o, u8 i_prefix, bool i_wide, u16 i_opcode, u8 i_reg, i32 i_disp)
+{
+    u8 sib = ((c_rax & 7) << 3) | (c_memoryRegister & 7);
+
+    EmitPrefixAndRex (o, i_prefix, i_wide, i_reg, c_rax, c_memoryRegister);
+    EmitOpcode (o, i_opcode);
+
+    if (i_disp)
+        EmitDisplacement (o, 0x04 | ((i_reg & 7) << 3), sib, true, i_disp);
+    else
+    {
+        Emit8 (o, 0x04 | ((i_reg & 7) << 3));
+        Emit8 (o, sib);
+    }
+}
+
+static
+void  EmitLoadCell  (IM3Jit o, bool i_wide, u8 i_reg, i32 i_cell)
+{
+    EmitRM (o, 0, i_wide, 0x8B, i_reg, c_frameRegister, i_cell);
+}
+
+static
+void  EmitStoreCell  (IM3Jit o, bool i_wide, i32 i_cell, u8 i_reg)
+{
+    EmitRM (o, 0, i_wide, 0x89, i_reg, c_frameRegister, i_cell);
+}
+
+static
+void  EmitCopyCell  (IM3Jit o, i32 i_to, i32 i_from)
+{
+    if (i_to != i_from)
+    {
+        EmitLoadCell (o, true, c_rcx, i_from);
+        EmitStoreCell (o, true, i_to, c_rcx);
+    }
+}
+
+static
+void  EmitMoveImmediate  (IM3Jit o, u8 i_reg, u64 i_value)
+{
+    if (i_value <= UINT32_MAX)
+    {
+        // mov r32, imm32 zero extends
+        EmitPrefixAndRex (o, 0, false, 0, 0, i_reg);
+        Emit8 (o, 0xB8 + (i_reg & 7));
+        Emit32 (o, (u32) i_value);
+    }
+    else
+    {
+        EmitPrefixAndRex (o, 0, true, 0, 0, i_reg);
+        Emit8 (o, 0xB8 + (i_reg & 7));
+        Emit64 (o, i_value);
+    }
+}
+
+static
+void  EmitLeaCell  (IM3Jit o, u8 i_reg, i32 i_cell)
+{
+    EmitRM (o, 0, true, 0x8D, i_reg, c_frameRegister, i_cell);
+}
+
+static
+void  EmitSetCondition  (IM3Jit o, u8 i_condition, u8 i_reg)
+{
+    EmitRR (o, 0, false, 0x0F90 | i_condition, 0, i_reg);
+}
+
+// movzx eax, al; mov [cell], eax
+static
+void  EmitStoreFlagResult  (IM3Jit o, i32 i_cell)
+{
+    EmitRR (o, 0, false, 0x0FB6, c_rax, c_rax);
+    EmitStoreCell (o, false, i_cell, c_rax);
+}
+
+static
+void  EmitTest  (IM3Jit o, bool i_wide, u8 i_reg)
+{
+    EmitRR (o, 0, i_wide, 0x85, i_reg, i_reg);
+}
+
+static
+void  EmitCallAddress  (IM3Jit o, const void * i_function)
+{
+    EmitMoveImmediate (o, c_rax, (u64) (uintptr_t) i_function);
+    EmitRR (o, 0, false, 0xFF, 2, c_rax);                                   // call rax
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------
+// labels
+//---------------------------------------------------------------------------------------------------------------------------------
+
+static
+void  PatchJump  (IM3Jit o, u32 i_location, u32 i_destination)
+{
+    if (o->outOfMemory)
+        return;
+
+    i32 displacement = (i32) (i_destination - (i_location + 4));
+    memcpy (o->code + i_location, & displacement, sizeof (displacement));
+}
+
+// emits a jmp/jcc with an unresolved rel32 and returns the rel32 location
+static
+u32  EmitJumpForward  (IM3Jit o, u8 i_condition)
+{
+    if (i_condition == c_ccAlways)
+        Emit8 (o, 0xE9);
+    else
+        EmitOpcode (o, 0x0F80 | i_condition);
+
+    u32 location = o->size;
+    Emit32 (o, 0);
+
+    return location;
+}
+
+static
+void  EmitJumpBackward  (IM3Jit o, u8 i_condition, u32 i_destination)
+{
+    u32 location = EmitJumpForward (o, i_condition);
+    PatchJump (o, location, i_destination);
+}
+
+static
+void  EmitJumpTo  (IM3Jit o, u8 i_condition, u32 i_target)
+{
+    u32 location = EmitJumpForward (o, i_condition);
+
+    if (o->numFixups == o->fixupsCapacity)
+    {
+        u32 capacity = o->fixupsCapacity ? o->fixupsCapacity * 2 : 64;
+        M3JitFixup * fixups = m3_ReallocArray (M3JitFixup, o->fixups, capacity, o->fixupsCapacity);
+
+        if (not fixups)
+        {
+            o->outOfMemory = true;
+            return;
+        }
+
+        o->fixups = fixups;
+        o->fixupsCapacity = capacity;
+    }
+
+    o->fixups [o->numFixups].location = location;
+    o->fixups [o->numFixups].target = i_target;
+    o->numFixups++;
+}
+
+static
+void  EmitTrapIf  (IM3Jit o, u8 i_condition, u32 i_trap)
+{
+    o->usesTrap [i_trap] = true;
+    EmitJumpTo (o, i_condition, c_targetTrap + i_trap);
+}
+
+// resolves and removes the fixups of i_target
+static
+void  ResolveFixups  (IM3Jit o, u32 i_target, u32 i_destination)
+{
+    u32 numFixups = 0;
+
+    for (u32 i = 0; i < o->numFixups; ++i)
+    {
+        if (o->fixups [i].target == i_target)
+            PatchJump (o, o->fixups [i].location, i_destination);
+        else
+            o->fixups [numFixups++] = o->fixups [i];
+    }
+
+    o->numFixups = numFixups;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------
+// frame
+//---------------------------------------------------------------------------------------------------------------------------------
+
+static
+i32  GetStackCell  (IM3Jit o, u32 i_depth)
+{
+    return (i32) ((o->stackBase + i_depth) * sizeof (u64));
+}
+
+static
+i32  GetTopCell  (IM3Jit o, u32 i_index)
+{
+    return GetStackCell (o, o->depth - 1 - i_index);
+}
+
+static
+i32  GetLocalCell  (IM3Jit o, u32 i_local)
+{
+    // args follow the returns, and the declared locals follow the args
+    return (i32) ((o->numRets + i_local) * sizeof (u64));
+}
+
+static
+void  UpdateMaxDepth  (IM3Jit o, u32 i_depth)
+{
+    if (i_depth > o->maxDepth)
+        o->maxDepth = i_depth;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------
+// operands
+//---------------------------------------------------------------------------------------------------------------------------------
+
+static
+M3JitOperand *  GetOperand  (IM3Jit o, u32 i_depth)
+{
+    return & o->operands [i_depth];
+}
+
+// the interpreter's compiler already bounded the depth by d_m3MaxFunctionStackHeight
+static
+M3JitOperand *  PushOperand  (IM3Jit o, u8 i_kind)
+{
+    M3JitOperand * operand = & o->operands [o->depth];
+    operand->kind = i_kind;
+
+    UpdateMaxDepth (o, ++o->depth);
+
+    return operand;
+}
+
+static
+void  PushConstant  (IM3Jit o, u64 i_value)
+{
+    PushOperand (o, c_jitConstant)->value = i_value;
+}
+
+static
+void  PushRegister  (IM3Jit o, u8 i_reg)
+{
+    PushOperand (o, c_jitRegister)->reg = i_reg;
+    o->usedRegisters |= 1u << i_reg;
+}
+
+static
+void  PushFlags  (IM3Jit o, u8 i_condition)
+{
+    PushOperand (o, c_jitFlags)->reg = i_condition;
+}
+
+static
+void  Pop  (IM3Jit o, u32 i_count)
+{
+    for (u32 i = 0; i < i_count; ++i)
+    {
+        M3JitOperand * operand = & o->operands [--o->depth];
+
+        if (operand->kind == c_jitRegister)
+            o->usedRegisters &= ~(1u << operand->reg);
+    }
+}
+
+// mov qword [cell], value
+static
+void  EmitStoreConstant  (IM3Jit o, i32 i_cell, u64 i_value)
+{
+    if ((i64) i_value == (i32) i_value)
+    {
+        EmitRM (o, 0, true, 0xC7, 0, c_frameRegister, i_cell);             // sign extends imm32
+        Emit32 (o, (u32) i_value);
+    }
+    else
+    {
+        EmitRM (o, 0, false, 0xC7, 0, c_frameRegister, i_cell);
+        Emit32 (o, (u32) i_value);
+        EmitRM (o, 0, false, 0xC7, 0, c_frameRegister, i_cell + 4);
+        Emit32 (o, (u32) (i_value >> 32));
+    }
+}
+
+// loads an operand into a register. an i32 is zero extended
+static
+void  EmitLoadOperand  (IM3Jit o, bool i_wide, u8 i_reg, u32 i_depth)
+{
+    M3JitOperand * operand = GetOperand (o, i_depth);
+
+    switch (operand->kind)
+    {
+        case c_jitConstant:
+            EmitMoveImmediate (o, i_reg, i_wide ? operand->value : (u32) operand->value);
+            break;
+
+        case c_jitLocal:
+            EmitLoadCell (o, i_wide, i_reg, GetLocalCell (o, (u32) operand->value));
+            break;
+
+        case c_jitRegister:
+            EmitRR (o, 0, i_wide, 0x8B, i_reg, operand->reg);
+            break;
+
+        case c_jitFlags:
+            EmitSetCondition (o, operand->reg, c_rax);
+            EmitRR (o, 0, false, 0x0FB6, i_reg, c_rax);                     // movzx reg, al
+            break;
+
+        default:
+            EmitLoadCell (o, i_wide, i_reg, GetStackCell (o, i_depth));
+            break;
+    }
+}
+
+// moves an operand to its cell
+static
+void  FlushOperand  (IM3Jit o, u32 i_depth)
+{
+    M3JitOperand * operand = GetOperand (o, i_depth);
+    i32 cell = GetStackCell (o, i_depth);
+
+    switch (operand->kind)
+    {
+        case c_jitConstant:
+            EmitStoreConstant (o, cell, operand->value);
+            break;
+
+        case c_jitLocal:
+            EmitCopyCell (o, cell, GetLocalCell (o, (u32) operand->value));
+            break;
+
+        case c_jitRegister:
+            EmitStoreCell (o, true, cell, operand->reg);
+            o->usedRegisters &= ~(1u << operand->reg);
+            break;
+
+        case c_jitFlags:
+            EmitSetCondition (o, operand->reg, c_rax);
+            EmitStoreFlagResult (o, cell);
+            break;
+    }
+
+    operand->kind = c_jitCell;
+}
+
+// flushes every operand but the top i_keep ones. these moves don't change the flags
+static
+void  FlushOperands  (IM3Jit o, u32 i_keep)
+{
+    for (u32 i = 0; i + i_keep < o->depth; ++i)
+        FlushOperand (o, i);
+}
+
+// for the templates that work on cells
+static
+void  FlushTopOperands  (IM3Jit o, u32 i_count)
+{
+    for (u32 i = o->depth - i_count; i < o->depth; ++i)
+        FlushOperand (o, i);
+}
+
+// the operands that still refer to a local must be read before the local changes
+static
+void  FlushLocal  (IM3Jit o, u32 i_local)
+{
+    for (u32 i = 0; i < o->depth; ++i)
+    {
+        M3JitOperand * operand = GetOperand (o, i);
+
+        if (operand->kind == c_jitLocal and operand->value == i_local)
+            FlushOperand (o, i);
+    }
+}
+
+static
+u8  AllocateRegister  (IM3Jit o)
+{
+    for (u32 i = 0; i < sizeof (c_operandRegisters); ++i)
+    {
+        u8 reg = c_operandRegisters [i];
+
+        if (not (o->usedRegisters & (1u << reg)))
+        {
+            o->usedRegisters |= 1u << reg;
+            return reg;
+        }
+    }
+
+    // they're all taken: spill the deepest operand that holds one
+    u32 i = 0;
+    while (GetOperand (o, i)->kind != c_jitRegister)
+        ++i;
+
+    u8 reg = GetOperand (o, i)->reg;
+    FlushOperand (o, i);
+    o->usedRegisters |= 1u << reg;
+
+    return reg;
+}
+
+// the register that receives the result of an operator: the operand's own register, or a new one
+static
+u8  LoadOperandToRegister  (IM3Jit o, bool i_wide, u32 i_depth)
+{
+    M3JitOperand * operand = GetOperand (o, i_depth);
+
+    if (operand->kind == c_jitRegister)
+        return operand->reg;
+
+    u8 reg = AllocateRegister (o);
+    EmitLoadOperand (o, i_wide, reg, i_depth);
+
+    return reg;
+}
+
+// a compare result only stays in the flags for the branch right after it
+static
+void  MaterializeFlags  (IM3Jit o)
+{
+    M3JitOperand * operand = o->depth ? GetOperand (o, o->depth - 1) : NULL;
+
+    if (operand and operand->kind == c_jitFlags)
+    {
+        u8 reg = AllocateRegister (o);
+        EmitLoadOperand (o, false, reg, o->depth - 1);
+
+        operand->kind = c_jitRegister;
+        operand->reg = reg;
+    }
+}
+
+// true if the operand is a constant that fits a sign extended imm32
+static
+bool  GetImmediate  (IM3Jit o, bool i_wide, u32 i_depth, i32 * o_value)
+{
+    M3JitOperand * operand = GetOperand (o, i_depth);
+
+    if (operand->kind != c_jitConstant)
+        return false;
+
+    * o_value = (i32) operand->value;
+
+    return not i_wide or (i64) operand->value == (i32) operand->value;
+}
+
+// op reg, operand
+static
+void  EmitOperandRM  (IM3Jit o, bool i_wide, u16 i_opcode, u8 i_reg, u32 i_depth)
+{
+    M3JitOperand * operand = GetOperand (o, i_depth);
+
+    switch (operand->kind)
+    {
+        case c_jitRegister:
+            EmitRR (o, 0, i_wide, i_opcode, i_reg, operand->reg);
+            break;
+
+        case c_jitLocal:
+            EmitRM (o, 0, i_wide, i_opcode, i_reg, c_frameRegister, GetLocalCell (o, (u32) operand->value));
+            break;
+
+        case c_jitCell:
+            EmitRM (o, 0, i_wide, i_opcode, i_reg, c_frameRegister, GetStackCell (o, i_depth));
+            break;
+
+        default:
+            EmitLoadOperand (o, i_wide, c_rdx, i_depth);
+            EmitRR (o, 0, i_wide, i_opcode, i_reg, c_rdx);
+            break;
+    }
+}
+
+// add, or, and, sub, xor or cmp, by their /digit, of a register and an operand
+static
+void  EmitArithmetic  (IM3Jit o, bool i_wide, u8 i_digit, u8 i_reg, u32 i_depth)
+{
+    i32 value;
+
+    if (GetImmediate (o, i_wide, i_depth, & value))
+    {
+        if (value == (i8) value)
+        {
+            EmitRR (o, 0, i_wide, 0x83, i_digit, i_reg);
+            Emit8 (o, (u8) value);
+        }
+        else
+        {
+            EmitRR (o, 0, i_wide, 0x81, i_digit, i_reg);
+            Emit32 (o, (u32) value);
+        }
+    }
+    else EmitOperandRM (o, i_wide, (u16) (i_digit * 8 + 3), i_reg, i_depth);
+}
+
+// pops the i32 on top and returns the condition code that holds when it isn't zero
+static
+u8  EmitCondition  (IM3Jit o)
+{
+    u32 top = o->depth - 1;
+    M3JitOperand * operand = GetOperand (o, top);
+
+    u8 condition = c_ccNE;
+
+    if (operand->kind == c_jitFlags)
+    {
+        condition = operand->reg;
+    }
+    else if (operand->kind == c_jitRegister)
+    {
+        EmitTest (o, false, operand->reg);
+    }
+    else
+    {
+        EmitLoadOperand (o, false, c_rax, top);
+        EmitTest (o, false, c_rax);
+    }
+
+    Pop (o, 1);
+
+    return condition;
+}
+
+// at a block boundary, the values the block passes on are in their cells
+static
+void  ResetBlockOperands  (IM3Jit o, M3JitBlock * i_block, u32 i_numValues)
+{
+    if (o->depth > i_block->entryDepth)
+        Pop (o, o->depth - i_block->entryDepth);
+
+    o->depth = i_block->entryDepth;
+
+    for (u32 i = 0; i < i_numValues; ++i)
+        PushOperand (o, c_jitCell);
+}
+
+static
+void  EmitReloadMemory  (IM3Jit o)
+{
+    // rax = runtime->memory.mallocated
+    EmitRM (o, 0, true, 0x8B, c_rax, c_runtimeRegister, (i32) (offsetof (M3Runtime, memory) + offsetof (M3Memory, mallocated)));
+    EmitRM (o, 0, true, 0x8D, c_memoryRegister, c_rax, (i32) sizeof (M3MemoryHeader));
+# if !d_m3SkipMemoryBoundsCheck
+    EmitRM (o, 0, true, 0x8B, c_lengthRegister, c_rax, (i32) offsetof (M3MemoryHeader, length));
+# endif
+}
+
+static
+void  EmitPrologue  (IM3Jit o)
+{
+    Emit8 (o, 0x53);                                                        // push rbx
+    Emit8 (o, 0x41); Emit8 (o, 0x54);                                       // push r12
+    Emit8 (o, 0x41); Emit8 (o, 0x55);                                       // push r13
+    Emit8 (o, 0x41); Emit8 (o, 0x56);                                       // push r14
+    Emit8 (o, 0x41); Emit8 (o, 0x57);                                       // push r15
+# if defined (_WIN32)
+    Emit8 (o, 0x56);                                                        // push rsi
+    Emit8 (o, 0x57);                                                        // push rdi
+# endif
+    // keeps rsp 16 byte aligned for helper calls, and reserves the win64 shadow space
+    Emit8 (o, 0x48); Emit8 (o, 0x83); Emit8 (o, 0xEC); Emit8 (o, 0x20);     // sub rsp, 32
+
+    EmitRR (o, 0, true, 0x89, c_argRegs [0], c_frameRegister);              // mov rbx, sp
+    EmitRR (o, 0, true, 0x89, c_argRegs [2], c_runtimeRegister);            // mov r14, runtime
+    EmitRM (o, 0, true, 0x8D, c_memoryRegister, c_argRegs [1], (i32) sizeof (M3MemoryHeader));
+# if !d_m3SkipMemoryBoundsCheck
+    EmitRM (o, 0, true, 0x8B, c_lengthRegister, c_argRegs [1], (i32) offsetof (M3MemoryHeader, length));
+# endif
+
+    // zero the declared locals
+    if (o->numLocals > 16)
+    {
+        EmitLeaCell (o, c_rdi, GetLocalCell (o, o->numArgs));
+        EmitMoveImmediate (o, c_rcx, o->numLocals);
+        EmitRR (o, 0, false, 0x31, c_rax, c_rax);                           // xor eax, eax
+        Emit8 (o, 0xF3); Emit8 (o, 0x48); Emit8 (o, 0xAB);                  // rep stosq
+    }
+    else if (o->numLocals)
+    {
+        EmitRR (o, 0, false, 0x31, c_rax, c_rax);
+        for (u32 i = 0; i < o->numLocals; ++i)
+            EmitStoreCell (o, true, GetLocalCell (o, o->numArgs + i), c_rax);
+    }
+}
+
+static
+void  EmitEpilogue  (IM3Jit o)
+{
+    Emit8 (o, 0x48); Emit8 (o, 0x83); Emit8 (o, 0xC4); Emit8 (o, 0x20);     // add rsp, 32
+# if defined (_WIN32)
+    Emit8 (o, 0x5F);                                                        // pop rdi
+    Emit8 (o, 0x5E);                                                        // pop rsi
+# endif
+    Emit8 (o, 0x41); Emit8 (o, 0x5F);                                       // pop r15
+    Emit8 (o, 0x41); Emit8 (o, 0x5E);                                       // pop r14
+    Emit8 (o, 0x41); Emit8 (o, 0x5D);                                       // pop r13
+    Emit8 (o, 0x41); Emit8 (o, 0x5C);                                       // pop r12
+    Emit8 (o, 0x5B);                                                        // pop rbx
+    Emit8 (o, 0xC3);                                                        // ret
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------
+// helpers called from the machine code
+//---------------------------------------------------------------------------------------------------------------------------------
+
+// OP_TRUNC and friends from m3_math_utils.h report traps with newTrap
+# define newTrap(ERR)       return ERR
+
+static
+m3ret_t  JitCall  (IM3Function i_function, m3stack_t i_sp)
+{
+    M3Result result = m3Err_none;
+
+    if (M3_UNLIKELY (not i_function->compiled))
+        result = CompileFunction (i_function);
+
+    if (not result)
+        result = (M3Result) RunCode (i_function->compiled, i_sp, i_function->module->runtime->memory.mallocated, d_m3OpDefaultArgs);
+
+    return result;
+}
+
+static
+m3ret_t  JitCallIndirect  (IM3Module i_module, IM3FuncType i_type, u32 i_tableIndex, m3stack_t i_sp)
+{
+    if (M3_UNLIKELY (i_tableIndex >= i_module->table0Size))
+        newTrap (m3Err_trapTableIndexOutOfRange);
+
+    IM3Function function = i_module->table0 [i_tableIndex];
+
+    if (M3_UNLIKELY (not function))
+        newTrap (m3Err_trapTableElementIsNull);
+
+    if (M3_UNLIKELY (function->funcType != i_type))
+        newTrap (m3Err_trapIndirectCallTypeMismatch);
+
+    return JitCall (function, i_sp);
+}
+
+static
+m3ret_t  JitMemoryGrow  (IM3Runtime io_runtime, u64 * io_cell)
+{
+    IM3Memory memory = & io_runtime->memory;
+
+    u32 numPagesToGrow = (u32) io_cell [0];
+    io_cell [0] = memory->numPages;
+
+    if (numPagesToGrow)
+    {
+        if (ResizeMemory (io_runtime, memory->numPages + numPagesToGrow))
+            io_cell [0] = (u32) -1;
+    }
+
+    return m3Err_none;
+}
+
+static
+m3ret_t  JitMemoryBulk  (IM3Runtime i_runtime, u32 i_opcode, u64 * i_cells)
+{
+    M3MemoryHeader * mem = i_runtime->memory.mallocated;
+
+    u64 destination = (u32) i_cells [0];
+    u32 size = (u32) i_cells [2];
+
+    if (M3_UNLIKELY (destination + size > mem->length))
+        newTrap (m3Err_trapOutOfBoundsMemoryAccess);
+
+    if (i_opcode == 0xFC0A)                                                 // memory.copy
+    {
+        u64 source = (u32) i_cells [1];
+
+        if (M3_UNLIKELY (source + size > mem->length))
+            newTrap (m3Err_trapOutOfBoundsMemoryAccess);
+
+        memmove (m3MemData (mem) + destination, m3MemData (mem) + source, size);
+    }
+    else memset (m3MemData (mem) + destination, (u8) i_cells [1], size);    // memory.fill
+
+    return m3Err_none;
+}
+
+// the operators that aren't worth a template: bit counting, float rounding and min/max, and
+// conversions that trap. operands are read from the cells and the result replaces the first one.
+static
+m3ret_t  JitNumeric  (u32 i_opcode, u64 * io_cells)
+{
+    u64 a = io_cells [0];
+    u64 b = io_cells [1];
+
+    u32 a32 = (u32) a;
+
+    f32 fa, fb;
+    f64 da, db;
+    memcpy (& fa, & a, sizeof (f32));
+    memcpy (& fb, & b, sizeof (f32));
+    memcpy (& da, & a, sizeof (f64));
+    memcpy (& db, & b, sizeof (f64));
+
+    u64 r = 0;
+    f32 fr = 0;
+    f64 dr = 0;
+
+    enum { c_int, c_f32, c_f64 } kind = c_int;
+
+    i32 ri32; u32 ru32; i64 ri64; u64 ru64;
+
+    switch (i_opcode)
+    {
+        case 0x67: r = a32 ? __builtin_clz (a32) : 32; break;
+        case 0x68: r = a32 ? __builtin_ctz (a32) : 32; break;
+        case 0x69: r = __builtin_popcount (a32); break;
+        case 0x79: r = a ? __builtin_clzll (a) : 64; break;
+        case 0x7A: r = a ? __builtin_ctzll (a) : 64; break;
+        case 0x7B: r = __builtin_popcountll (a); break;
+
+        case 0x8D: kind = c_f32; fr = ceilf (fa); break;
+        case 0x8E: kind = c_f32; fr = floorf (fa); break;
+        case 0x8F: kind = c_f32; fr = truncf (fa); break;
+        case 0x90: kind = c_f32; fr = rintf (fa); break;
+        case 0x96: kind = c_f32; fr = min_f32 (fa, fb); break;
+        case 0x97: kind = c_f32; fr = max_f32 (fa, fb); break;
+        case 0x98: kind = c_f32; fr = copysignf (fa, fb); break;
+
+        case 0x9B: kind = c_f64; dr = ceil (da); break;
+        case 0x9C: kind = c_f64; dr = floor (da); break;
+        case 0x9D: kind = c_f64; dr = trunc (da); break;
+        case 0x9E: kind = c_f64; dr = rint (da); break;
+        case 0xA4: kind = c_f64; dr = min_f64 (da, db); break;
+        case 0xA5: kind = c_f64; dr = max_f64 (da, db); break;
+        case 0xA6: kind = c_f64; dr = copysign (da, db); break;
+
+        case 0xA8: { OP_I32_TRUNC_F32 (ri32, fa); r = (u32) ri32; break; }
+        case 0xA9: { OP_U32_TRUNC_F32 (ru32, fa); r = ru32; break; }
+        case 0xAA: { OP_I32_TRUNC_F64 (ri32, da); r = (u32) ri32; break; }
+        case 0xAB: { OP_U32_TRUNC_F64 (ru32, da); r = ru32; break; }
+        case 0xAE: { OP_I64_TRUNC_F32 (ri64, fa); r = (u64) ri64; break; }
+        case 0xAF: { OP_U64_TRUNC_F32 (ru64, fa); r = ru64; break; }
+        case 0xB0: { OP_I64_TRUNC_F64 (ri64, da); r = (u64) ri64; break; }
+        case 0xB1: { OP_U64_TRUNC_F64 (ru64, da); r = ru64; break; }
+
+        case 0xB5: kind = c_f32; fr = (f32) a; break;
+        case 0xBA: kind = c_f64; dr = (f64) a; break;
+
+        case 0xFC00: { OP_I32_TRUNC_SAT_F32 (ri32, fa); r = (u32) ri32; break; }
+        case 0xFC01: { OP_U32_TRUNC_SAT_F32 (ru32, fa); r = ru32; break; }
+        case 0xFC02: { OP_I32_TRUNC_SAT_F64 (ri32, da); r = (u32) ri32; break; }
+        case 0xFC03: { OP_U32_TRUNC_SAT_F64 (ru32, da); r = ru32; break; }
+        case 0xFC04: { OP_I64_TRUNC_SAT_F32 (ri64, fa); r = (u64) ri64; break; }
+        case 0xFC05: { OP_U64_TRUNC_SAT_F32 (ru64, fa); r = ru64; break; }
+        case 0xFC06: { OP_I64_TRUNC_SAT_F64 (ri64, da); r = (u64) ri64; break; }
+        case 0xFC07: { OP_U64_TRUNC_SAT_F64 (ru64, da); r = ru64; break; }
+
+        default: newTrap (m3Err_trapUnreachable);
+    }
+
+    if (kind == c_f32)
+    {
+        u32 bits;
+        memcpy (& bits, & fr, sizeof (f32));
+        r = bits;
+    }
+    else if (kind == c_f64)
+        memcpy (& r, & dr, sizeof (f64));
+
+    io_cells [0] = r;
+
+    return m3Err_none;
+}
+
+# undef newTrap
+
+//---------------------------------------------------------------------------------------------------------------------------------
+// templates
+//---------------------------------------------------------------------------------------------------------------------------------
+
+static
+M3Result  EmitHelperCall  (IM3Jit o, const void * i_helper, bool i_reloadMemory)
+{
+    EmitCallAddress (o, i_helper);
+    EmitTest (o, true, c_rax);
+    EmitJumpTo (o, c_ccNE, c_targetEpilogue);                               // forward the trap
+
+    if (i_reloadMemory)
+        EmitReloadMemory (o);
+
+    return m3Err_none;
+}
+
+static
+M3Result  EmitNumericHelper  (IM3Jit o, u32 i_opcode, u32 i_numOperands)
+{
+    M3Result result;
+
+    FlushOperands (o, 0);
+
+    EmitMoveImmediate (o, c_argRegs [0], i_opcode);
+    EmitLeaCell (o, c_argRegs [1], GetTopCell (o, i_numOperands - 1));
+_   (EmitHelperCall (o, (const void *) JitNumeric, false));
+    Pop (o, i_numOperands - 1);
+
+    _catch: return result;
+}
+
+// copies the branch values to the target block's entry and jumps
+static
+void  EmitBranch  (IM3Jit o, u32 i_relativeDepth, u8 i_condition)
+{
+    u32 level = o->numBlocks - 1 - i_relativeDepth;
+    M3JitBlock * block = & o->blocks [level];
+
+    u32 arity = (block->opcode == c_waOp_loop) ? block->numParams : block->numResults;
+
+    bool moves = (block->entryDepth != o->depth - arity);
+
+    u32 skip = 0;
+    if (moves and i_condition != c_ccAlways)
+    {
+        skip = EmitJumpForward (o, i_condition ^ 1);
+        i_condition = c_ccAlways;
+    }
+
+    if (moves)
+    {
+        for (u32 i = 0; i < arity; ++i)
+            EmitCopyCell (o, GetStackCell (o, block->entryDepth + i), GetStackCell (o, o->depth - arity + i));
+    }
+
+    if (block->opcode == c_waOp_loop)
+        EmitJumpBackward (o, i_condition, block->start);
+    else
+        EmitJumpTo (o, i_condition, level);
+
+    if (skip)
+        PatchJump (o, skip, o->size);
+}
+
+// a v128 doesn't fit a 64-bit cell; functions that touch one stay interpreted
+static
+bool  HasV128Type  (IM3FuncType i_type)
+{
+    for (u32 i = 0; i < i_type->numRets + i_type->numArgs; ++i)
+    {
+        if (i_type->types [i] == c_m3Type_v128)
+            return true;
+    }
+
+    return false;
+}
+
+static
+M3Result  ReadBlockType  (IM3Jit o, u16 * o_numParams, u16 * o_numResults)
+{
+    M3Result result;
+
+    i64 type;
+_   (ReadLebSigned (& type, 33, & o->wasm, o->wasmEnd));
+
+    * o_numParams = 0;
+    * o_numResults = 0;
+
+    if (type >= 0)
+    {
+        _throwif (m3Err_wasmMalformed, type >= o->module->numFuncTypes);
+
+        IM3FuncType funcType = o->module->funcTypes [type];
+        _throwif ("jit: unsupported type", HasV128Type (funcType));
+
+        * o_numParams = funcType->numArgs;
+        * o_numResults = funcType->numRets;
+    }
+    else if (type != -64)                                                   // 0x40: empty
+    {
+        _throwif ("jit: unsupported type", type == -5);                     // 0x7b: v128
+        * o_numResults = 1;
+    }
+
+    _catch: return result;
+}
+
+static
+M3Result  OpenBlock  (IM3Jit o, u8 i_opcode)
+{
+    M3Result result;
+
+    u16 numParams, numResults;
+    M3JitBlock * block;
+
+_   (ReadBlockType (o, & numParams, & numResults));
+
+    _throwif ("jit: blocks nested too deep", o->numBlocks == d_m3JitMaxBlockDepth);
+
+    block = & o->blocks [o->numBlocks++];
+    memset (block, 0, sizeof (M3JitBlock));
+
+    block->opcode = i_opcode;
+    block->dead = o->unreachable;
+    block->numParams = numParams;
+    block->numResults = numResults;
+    block->elseFixup = -1;
+
+    if (block->dead)
+        goto _catch;
+
+    if (i_opcode == c_waOp_if)
+    {
+        // the else arm would need its own copy of the params
+        _throwif ("jit: if with params", numParams);
+
+        FlushOperands (o, 1);
+        block->elseFixup = (i32) EmitJumpForward (o, EmitCondition (o) ^ 1);
+    }
+    else FlushOperands (o, 0);
+
+    block->entryDepth = o->depth - numParams;
+    block->start = o->size;
+
+    _catch: return result;
+}
+
+static
+void  CompileElse  (IM3Jit o)
+{
+    u32 level = o->numBlocks - 1;
+    M3JitBlock * block = & o->blocks [level];
+
+    if (block->dead)
+        return;
+
+    if (not o->unreachable)
+    {
+        FlushOperands (o, 0);
+        EmitJumpTo (o, c_ccAlways, level);
+    }
+
+    PatchJump (o, (u32) block->elseFixup, o->size);
+    block->elseFixup = -1;
+
+    ResetBlockOperands (o, block, block->numParams);
+    o->unreachable = false;
+}
+
+static
+void  CloseBlock  (IM3Jit o)
+{
+    u32 level = o->numBlocks - 1;
+    M3JitBlock * block = & o->blocks [level];
+
+    if (not block->dead)
+    {
+        if (not o->unreachable)
+            FlushOperands (o, 0);
+
+        if (block->elseFixup >= 0)
+            PatchJump (o, (u32) block->elseFixup, o->size);
+
+        ResolveFixups (o, level, o->size);
+
+        ResetBlockOperands (o, block, block->numResults);
+        o->unreachable = false;
+    }
+
+    o->numBlocks--;
+}
+
+static
+M3Result  EmitCall  (IM3Jit o, IM3FuncType i_type, const void * i_helper, IM3Function i_function)
+{
+    M3Result result = m3Err_none;
+
+    u32 numArgs = i_type->numArgs;
+    u32 numRets = i_type->numRets;
+
+    if (HasV128Type (i_type))
+        return "jit: unsupported type";
+
+    FlushOperands (o, 0);
+
+    if (not i_function)
+    {
+        // call_indirect: the table index is on top of the args
+        EmitLoadCell (o, false, c_argRegs [2], GetTopCell (o, 0));
+        Pop (o, 1);
+    }
+
+    // the callee frame goes right above the operand stack: returns first, then the args
+    u32 argsDepth = o->depth - numArgs;
+    u32 frameDepth = o->depth;
+
+    for (u32 i = 0; i < numArgs; ++i)
+        EmitCopyCell (o, GetStackCell (o, frameDepth + numRets + i), GetStackCell (o, argsDepth + i));
+
+    UpdateMaxDepth (o, frameDepth + numRets + numArgs);
+
+    if (i_function)
+    {
+        EmitMoveImmediate (o, c_argRegs [0], (u64) (uintptr_t) i_function);
+        EmitLeaCell (o, c_argRegs [1], GetStackCell (o, frameDepth));
+    }
+    else
+    {
+        EmitMoveImmediate (o, c_argRegs [0], (u64) (uintptr_t) o->module);
+        EmitMoveImmediate (o, c_argRegs [1], (u64) (uintptr_t) i_type);
+        EmitLeaCell (o, c_argRegs [3], GetStackCell (o, frameDepth));
+    }
+
+_   (EmitHelperCall (o, i_helper, true));
+
+    for (u32 i = 0; i < numRets; ++i)
+        EmitCopyCell (o, GetStackCell (o, argsDepth + i), GetStackCell (o, frameDepth + i));
+
+    Pop (o, numArgs);
+
+    for (u32 i = 0; i < numRets; ++i)
+        PushOperand (o, c_jitCell);
+
+    _catch: return result;
+}
+
+// leaves the address in rax and returns the displacement that completes it, or traps
+static
+i32  EmitEffectiveAddress  (IM3Jit o, u32 i_address, u32 i_offset, u32 i_size)
+{
+    EmitLoadOperand (o, false, c_rax, i_address);                           // zero extends
+
+    i32 displacement = 0;
+
+    if (i_offset <= INT32_MAX - 8)
+    {
+        displacement = (i32) i_offset;
+    }
+    else
+    {
+        EmitMoveImmediate (o, c_rdx, i_offset);
+        EmitRR (o, 0, true, 0x01, c_rdx, c_rax);                            // add rax, rdx
+    }
+
+# if !d_m3SkipMemoryBoundsCheck
+    EmitRM (o, 0, true, 0x8D, c_rdx, c_rax, displacement + (i32) i_size);   // lea rdx, [rax + offset + size]
+    EmitRR (o, 0, true, 0x39, c_lengthRegister, c_rdx);                     // cmp rdx, r13
+    EmitTrapIf (o, c_ccA, c_trapOutOfBounds);
+# endif
+
+    return displacement;
+}
+
+static
+void  CompileLoad  (IM3Jit o, u8 i_opcode, u32 i_offset)
+{
+    //                                i32.load  i64.load  f32.load  f64.load  8_s     8_u     16_s    16_u
+    static const u16 c_opcodes [] = { 0x8B,     0x8B,     0x8B,     0x8B,     0x0FBE, 0x0FB6, 0x0FBF, 0x0FB7,
+    //                                i64 8_s   8_u       16_s      16_u      32_s    32_u
+                                      0x0FBE,   0x0FB6,   0x0FBF,   0x0FB7,   0x63,   0x8B };
+    static const bool c_wide [] =   { 0, 1, 0, 1,   0, 0, 0, 0,   1, 0, 1, 0, 1, 0 };
+    static const u8 c_sizes [] =    { 4, 8, 4, 8,   1, 1, 2, 2,   1, 1, 2, 2, 4, 4 };
+
+    u32 index = i_opcode - c_jitOp_i32_load;
+
+    i32 displacement = EmitEffectiveAddress (o, o->depth - 1, i_offset, c_sizes [index]);
+    Pop (o, 1);
+
+    u8 reg = AllocateRegister (o);
+    EmitLinearMemoryRM (o, 0, c_wide [index], c_opcodes [index], reg, displacement);
+    PushRegister (o, reg);
+}
+
+static
+void  CompileStore  (IM3Jit o, u8 i_opcode, u32 i_offset)
+{
+    //                              i32     i64     f32     f64     i32.8   i32.16  i64.8   i64.16  i64.32
+    static const u8 c_sizes [] =  { 4,      8,      4,      8,      1,      2,      1,      2,      4 };
+
+    u32 index = i_opcode - c_jitOp_i32_store;
+    u8 size = c_sizes [index];
+
+    u32 value = o->depth - 1;
+    i32 displacement = EmitEffectiveAddress (o, o->depth - 2, i_offset, size);
+
+    u8 reg = GetOperand (o, value)->reg;
+    if (GetOperand (o, value)->kind != c_jitRegister)
+    {
+        reg = c_rcx;
+        EmitLoadOperand (o, size == 8, reg, value);
+    }
+
+    // the memory operand has a REX prefix (r12), so that sil and dil are addressable
+    if (size == 1)
+        EmitLinearMemoryRM (o, 0, false, 0x88, reg, displacement);
+    else if (size == 2)
+        EmitLinearMemoryRM (o, 0x66, false, 0x89, reg, displacement);
+    else
+        EmitLinearMemoryRM (o, 0, size == 8, 0x89, reg, displacement);
+
+    Pop (o, 2);
+}
+
+static
+void  CompileIntegerDivision  (IM3Jit o, u32 i_op, bool i_wide)
+{
+    bool isSigned = (i_op == 3 or i_op == 5);
+    bool isRemainder = (i_op >= 5);
+
+    u32 a = o->depth - 2;
+    u32 b = o->depth - 1;
+
+    // a constant divisor drops the checks it can't fail
+    M3JitOperand * divisor = GetOperand (o, b);
+    u64 value = i_wide ? divisor->value : (u32) divisor->value;
+    bool isConstant = (divisor->kind == c_jitConstant);
+
+    EmitLoadOperand (o, i_wide, c_rax, a);
+    EmitLoadOperand (o, i_wide, c_rcx, b);
+
+    if (not isConstant or value == 0)
+    {
+        EmitTest (o, i_wide, c_rcx);
+        EmitTrapIf (o, c_ccE, c_trapDivisionByZero);
+    }
+
+    u32 done = 0;
+    if (isSigned)
+    {
+        bool mayBeMinusOne = not isConstant or value == (i_wide ? ~0ULL : 0xffffffffULL);
+
+        if (mayBeMinusOne)
+        {
+            EmitRR (o, 0, i_wide, 0x83, 7, c_rcx); Emit8 (o, 0xFF);         // cmp rcx, -1
+            u32 notMinusOne = EmitJumpForward (o, c_ccNE);
+
+            if (isRemainder)
+            {
+                // INT_MIN % -1 faults on x86; the result is 0 for any dividend
+                EmitRR (o, 0, false, 0x31, c_rax, c_rax);
+                done = EmitJumpForward (o, c_ccAlways);
+            }
+            else
+            {
+                EmitMoveImmediate (o, c_rdx, i_wide ? 0x8000000000000000ULL : 0x80000000);
+                EmitRR (o, 0, i_wide, 0x39, c_rdx, c_rax);                  // cmp rax, rdx
+                EmitTrapIf (o, c_ccE, c_trapIntegerOverflow);
+            }
+
+            PatchJump (o, notMinusOne, o->size);
+        }
+
+        if (i_wide) Emit8 (o, 0x48);
+        Emit8 (o, 0x99);                                                    // cdq / cqo
+        EmitRR (o, 0, i_wide, 0xF7, 7, c_rcx);                              // idiv rcx
+    }
+    else
+    {
+        EmitRR (o, 0, false, 0x31, c_rdx, c_rdx);                           // xor edx, edx
+        EmitRR (o, 0, i_wide, 0xF7, 6, c_rcx);                              // div rcx
+    }
+
+    if (isRemainder)
+        EmitRR (o, 0, true, 0x89, c_rdx, c_rax);                            // mov rax, rdx
+
+    if (done)
+        PatchJump (o, done, o->size);
+
+    Pop (o, 2);
+
+    u8 reg = AllocateRegister (o);
+    EmitRR (o, 0, true, 0x89, c_rax, reg);                                  // mov reg, rax
+    PushRegister (o, reg);
+}
+
+static
+void  CompileIntegerBinary  (IM3Jit o, u8 i_opcode, bool i_wide)
+{
+    // opcodes relative to i32.add / i64.add
+    u32 op = i_opcode - (i_wide ? 0x7C : 0x6A);
+
+    if (op >= 3 and op <= 6)
+    {
+        CompileIntegerDivision (o, op, i_wide);
+        return;
+    }
+
+    u32 a = o->depth - 2;
+    u32 b = o->depth - 1;
+
+    u8 reg = LoadOperandToRegister (o, i_wide, a);
+
+    switch (op)
+    {
+        case 0: EmitArithmetic (o, i_wide, 0, reg, b); break;                             // add
+        case 1: EmitArithmetic (o, i_wide, 5, reg, b); break;                             // sub
+        case 7: EmitArithmetic (o, i_wide, 4, reg, b); break;                             // and
+        case 8: EmitArithmetic (o, i_wide, 1, reg, b); break;                             // or
+        case 9: EmitArithmetic (o, i_wide, 6, reg, b); break;                             // xor
+
+        case 2:                                                                           // mul
+        {
+            i32 value;
+            if (GetImmediate (o, i_wide, b, & value))
+            {
+                EmitRR (o, 0, i_wide, 0x69, reg, reg);                      // imul reg, reg, imm32
+                Emit32 (o, (u32) value);
+            }
+            else EmitOperandRM (o, i_wide, 0x0FAF, reg, b);
+            break;
+        }
+
+        default:
+        {
+            //                            shl shr_s shr_u rotl rotr
+            static const u8 c_digits [] = { 4,  7,    5,    0,   1 };
+            M3JitOperand * count = GetOperand (o, b);
+
+            if (count->kind == c_jitConstant)
+            {
+                EmitRR (o, 0, i_wide, 0xC1, c_digits [op - 10], reg);
+                Emit8 (o, (u8) (count->value & (i_wide ? 63 : 31)));
+            }
+            else
+            {
+                EmitLoadOperand (o, false, c_rcx, b);
+                EmitRR (o, 0, i_wide, 0xD3, c_digits [op - 10], reg);
+            }
+            break;
+        }
+    }
+
+    Pop (o, 2);
+    PushRegister (o, reg);
+}
+
+static
+void  CompileIntegerCompare  (IM3Jit o, u8 i_opcode, bool i_wide)
+{
+    //                                 eq      ne      lt_s    lt_u   gt_s    gt_u   le_s    le_u    ge_s    ge_u
+    static const u8 c_conditions [] = { c_ccE, c_ccNE, c_ccL,  c_ccB, c_ccG,  c_ccA, c_ccLE, c_ccBE, c_ccGE, c_ccAE };
+
+    u32 a = o->depth - 2;
+    u32 b = o->depth - 1;
+
+    u8 reg = GetOperand (o, a)->reg;
+    if (GetOperand (o, a)->kind != c_jitRegister)
+    {
+        reg = c_rcx;
+        EmitLoadOperand (o, i_wide, reg, a);
+    }
+
+    EmitArithmetic (o, i_wide, 7, reg, b);                                  // cmp
+
+    Pop (o, 2);
+    PushFlags (o, c_conditions [i_opcode - (i_wide ? 0x51 : 0x46)]);
+}
+
+static
+void  CompileTestZero  (IM3Jit o, bool i_wide)
+{
+    u32 a = o->depth - 1;
+    M3JitOperand * operand = GetOperand (o, a);
+
+    if (operand->kind == c_jitFlags)
+    {
+        operand->reg ^= 1;                                                  // the opposite condition
+        return;
+    }
+
+    u8 reg = operand->reg;
+    if (operand->kind != c_jitRegister)
+    {
+        reg = c_rcx;
+        EmitLoadOperand (o, i_wide, reg, a);
+    }
+
+    EmitTest (o, i_wide, reg);
+
+    Pop (o, 1);
+    PushFlags (o, c_ccE);
+}
+
+static
+void  CompileFloatCompare  (IM3Jit o, u8 i_opcode, bool i_double)
+{
+
+    i32 a = GetTopCell (o, 1);
+    i32 b = GetTopCell (o, 0);
+
+    u8 movPrefix = i_double ? 0xF2 : 0xF3;
+    u8 ucomiPrefix = i_double ? 0x66 : 0;
+
+    u32 op = i_opcode - (i_double ? 0x61 : 0x5B);                          // eq ne lt gt le ge
+
+    // lt and le compare the operands the other way around, so that unordered is always false
+    bool swap = (op == 2 or op == 4);
+
+    FlushTopOperands (o, 2);
+
+    EmitRM (o, movPrefix, false, 0x0F10, 0, c_frameRegister, swap ? b : a);
+    EmitRM (o, ucomiPrefix, false, 0x0F2E, 0, c_frameRegister, swap ? a : b);
+
+    switch (op)
+    {
+        case 0:
+            EmitSetCondition (o, c_ccE, c_rax);
+            EmitSetCondition (o, c_ccNP, c_rcx);
+            EmitRR (o, 0, false, 0x20, c_rcx, c_rax);                       // and al, cl
+            break;
+        case 1:
+            EmitSetCondition (o, c_ccNE, c_rax);
+            EmitSetCondition (o, c_ccP, c_rcx);
+            EmitRR (o, 0, false, 0x08, c_rcx, c_rax);                       // or al, cl
+            break;
+        case 2: case 3:
+            EmitSetCondition (o, c_ccA, c_rax);
+            break;
+        default:
+            EmitSetCondition (o, c_ccAE, c_rax);
+            break;
+    }
+
+    EmitStoreFlagResult (o, a);
+    Pop (o, 1);
+}
+
+static
+M3Result  CompileFloatArithmetic  (IM3Jit o, u8 i_opcode, bool i_double)
+{
+    M3Result result = m3Err_none;
+
+    u8 prefix = i_double ? 0xF2 : 0xF3;
+    u32 op = i_opcode - (i_double ? 0x99 : 0x8B);                           // abs neg ceil floor trunc nearest sqrt add sub mul div min max copysign
+
+
+    FlushTopOperands (o, (op >= 7) ? 2 : 1);
+
+    i32 a = GetTopCell (o, 0);
+
+    switch (op)
+    {
+        case 0: case 1:
+            // btr/btc on the sign bit
+            EmitRM (o, 0, i_double, 0x0FBA, op ? 7 : 6, c_frameRegister, a);
+            Emit8 (o, i_double ? 63 : 31);
+            break;
+
+        case 6:
+            EmitRM (o, prefix, false, 0x0F51, 0, c_frameRegister, a);       // sqrt
+            EmitRM (o, prefix, false, 0x0F11, 0, c_frameRegister, a);
+            break;
+
+        case 7: case 8: case 9: case 10:
+        {
+            //                              add   sub   mul   div
+            static const u16 c_ops [] = { 0x0F58, 0x0F5C, 0x0F59, 0x0F5E };
+
+            a = GetTopCell (o, 1);
+
+            EmitRM (o, prefix, false, 0x0F10, 0, c_frameRegister, a);
+            EmitRM (o, prefix, false, c_ops [op - 7], 0, c_frameRegister, GetTopCell (o, 0));
+            EmitRM (o, prefix, false, 0x0F11, 0, c_frameRegister, a);
+            Pop (o, 1);
+            break;
+        }
+
+        case 11: case 12: case 13:
+_           (EmitNumericHelper (o, i_opcode, 2));
+            break;
+
+        default:
+_           (EmitNumericHelper (o, i_opcode, 1));
+            break;
+    }
+
+    _catch: return result;
+}
+
+static
+M3Result  CompileConversion  (IM3Jit o, u8 i_opcode)
+{
+    M3Result result = m3Err_none;
+
+
+    u32 top = o->depth - 1;
+
+    switch (i_opcode)
+    {
+        // the upper half of an i32 is never read, so these don't need any code
+        case 0xA7:                                                          // i32.wrap_i64
+        case 0xBC: case 0xBD: case 0xBE: case 0xBF:                         // reinterpret
+            return result;
+
+        case 0xAC:                                                          // i64.extend_i32_s
+        case 0xAD:                                                          // i64.extend_i32_u
+        {
+            u8 reg = LoadOperandToRegister (o, false, top);
+
+            if (i_opcode == 0xAC)
+                EmitRR (o, 0, true, 0x63, reg, reg);                        // movsxd reg, reg32
+            else
+                EmitRR (o, 0, false, 0x8B, reg, reg);                       // mov reg32, reg32
+
+            Pop (o, 1);
+            PushRegister (o, reg);
+            return result;
+        }
+    }
+
+    FlushTopOperands (o, 1);
+
+    i32 a = GetTopCell (o, 0);
+
+    switch (i_opcode)
+    {
+
+        case 0xC0: EmitRM (o, 0, false, 0x0FBE, c_rax, c_frameRegister, a); EmitStoreCell (o, false, a, c_rax); break;
+        case 0xC1: EmitRM (o, 0, false, 0x0FBF, c_rax, c_frameRegister, a); EmitStoreCell (o, false, a, c_rax); break;
+        case 0xC2: EmitRM (o, 0, true, 0x0FBE, c_rax, c_frameRegister, a); EmitStoreCell (o, true, a, c_rax); break;
+        case 0xC3: EmitRM (o, 0, true, 0x0FBF, c_rax, c_frameRegister, a); EmitStoreCell (o, true, a, c_rax); break;
+        case 0xC4: EmitRM (o, 0, true, 0x63, c_rax, c_frameRegister, a); EmitStoreCell (o, true, a, c_rax); break;
+
+        case 0xB2: case 0xB3: case 0xB4:                                    // f32.convert_i32_s, _i32_u, _i64_s
+        case 0xB7: case 0xB8: case 0xB9:                                    // f64.convert_i32_s, _i32_u, _i64_s
+        {
+            bool toDouble = (i_opcode >= 0xB7);
+            u32 op = i_opcode - (toDouble ? 0xB7 : 0xB2);
+            u8 prefix = toDouble ? 0xF2 : 0xF3;
+
+            // i32_u: zero extend, then convert as a signed 64-bit integer
+            EmitLoadCell (o, op == 2, c_rax, a);
+            EmitRR (o, prefix, op != 0, 0x0F2A, 0, c_rax);                  // cvtsi2sd/ss xmm0, eax/rax
+            EmitRM (o, prefix, false, 0x0F11, 0, c_frameRegister, a);
+            break;
+        }
+
+        case 0xB6:                                                          // f32.demote_f64
+            EmitRM (o, 0xF2, false, 0x0F5A, 0, c_frameRegister, a);
+            EmitRM (o, 0xF3, false, 0x0F11, 0, c_frameRegister, a);
+            break;
+
+        case 0xBB:                                                          // f64.promote_f32
+            EmitRM (o, 0xF3, false, 0x0F5A, 0, c_frameRegister, a);
+            EmitRM (o, 0xF2, false, 0x0F11, 0, c_frameRegister, a);
+            break;
+
+        default:                                                            // truncations and u64 conversions
+_           (EmitNumericHelper (o, i_opcode, 1));
+            break;
+    }
+
+    _catch: return result;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------
+
+static
+M3Result  CompileBody  (IM3Jit o)
+{
+    M3Result result = m3Err_none;
+
+    u32 epilogue;
+
+    while (o->numBlocks)
+    {
+        u8 opcode;
+_       (Read_u8 (& opcode, & o->wasm, o->wasmEnd));
+
+        if (opcode != c_waOp_branchIf and opcode != c_waOp_if and opcode != 0x45 and not o->unreachable)
+            MaterializeFlags (o);
+
+        switch (opcode)
+        {
+            case c_waOp_block:
+            case c_waOp_loop:
+            case c_waOp_if:
+_               (OpenBlock (o, opcode));
+                break;
+
+            case c_waOp_else:
+                CompileElse (o);
+                break;
+
+            case c_waOp_end:
+                CloseBlock (o);
+                break;
+
+            case c_jitOp_unreachable:
+                if (o->unreachable) break;
+                EmitTrapIf (o, c_ccAlways, c_trapUnreachable);
+                o->unreachable = true;
+                break;
+
+            case c_jitOp_nop:
+                break;
+
+            case c_waOp_branch:
+            case c_waOp_branchIf:
+            {
+                u32 depth;
+_               (ReadLEB_u32 (& depth, & o->wasm, o->wasmEnd));
+                if (o->unreachable) break;
+
+                if (opcode == c_waOp_branch)
+                {
+                    FlushOperands (o, 0);
+                    EmitBranch (o, depth, c_ccAlways);
+                    o->unreachable = true;
+                }
+                else
+                {
+                    FlushOperands (o, 1);
+                    EmitBranch (o, depth, EmitCondition (o));
+                }
+                break;
+            }
+
+            case c_waOp_branchTable:
+            {
+                u32 count;
+_               (ReadLEB_u32 (& count, & o->wasm, o->wasmEnd));
+
+                bool live = not o->unreachable;
+                if (live)
+                {
+                    FlushOperands (o, 1);
+                    EmitLoadOperand (o, false, c_rax, o->depth - 1);
+                    Pop (o, 1);
+                }
+
+                // linear dispatch; EmitBranch only touches rcx, so eax survives the value moves
+                for (u32 i = 0; i <= count; ++i)
+                {
+                    u32 depth;
+_                   (ReadLEB_u32 (& depth, & o->wasm, o->wasmEnd));
+
+                    if (not live)
+                        continue;
+
+                    if (i < count)
+                    {
+                        EmitRR (o, 0, false, 0x81, 7, c_rax); Emit32 (o, i);    // cmp eax, i
+                        u32 next = EmitJumpForward (o, c_ccNE);
+                        EmitBranch (o, depth, c_ccAlways);
+                        PatchJump (o, next, o->size);
+                    }
+                    else
+                    {
+                        EmitBranch (o, depth, c_ccAlways);
+                    }
+                }
+
+                o->unreachable = true;
+                break;
+            }
+
+            case c_jitOp_return:
+                if (o->unreachable) break;
+                FlushOperands (o, 0);
+                EmitBranch (o, o->numBlocks - 1, c_ccAlways);
+                o->unreachable = true;
+                break;
+
+            case c_waOp_call:
+            {
+                u32 index;
+_               (ReadLEB_u32 (& index, & o->wasm, o->wasmEnd));
+                if (o->unreachable) break;
+
+                _throwif (m3Err_wasmMalformed, index >= o->module->numFunctions);
+                IM3Function callee = & o->module->functions [index];
+
+_               (EmitCall (o, callee->funcType, (const void *) JitCall, callee));
+                break;
+            }
+
+            case c_jitOp_callIndirect:
+            {
+                u32 typeIndex, tableIndex;
+_               (ReadLEB_u32 (& typeIndex, & o->wasm, o->wasmEnd));
+_               (ReadLEB_u32 (& tableIndex, & o->wasm, o->wasmEnd));
+                if (o->unreachable) break;
+
+                _throwif (m3Err_wasmMalformed, typeIndex >= o->module->numFuncTypes);
+                _throwif ("jit: unsupported table", tableIndex != 0);
+
+_               (EmitCall (o, o->module->funcTypes [typeIndex], (const void *) JitCallIndirect, NULL));
+                break;
+            }
+
+            case c_jitOp_drop:
+                if (o->unreachable) break;
+                Pop (o, 1);
+                break;
+
+            case c_jitOp_select:
+            case c_jitOp_selectTyped:
+            {
+                if (opcode == c_jitOp_selectTyped)
+                {
+                    u32 numTypes;
+_                   (ReadLEB_u32 (& numTypes, & o->wasm, o->wasmEnd));
+                    _throwif (m3Err_wasmMalformed, numTypes != 1);
+                    u8 type;
+_                   (Read_u8 (& type, & o->wasm, o->wasmEnd));
+                }
+                if (o->unreachable) break;
+
+                FlushTopOperands (o, 3);
+
+                i32 a = GetTopCell (o, 2);
+                EmitLoadCell (o, false, c_rax, GetTopCell (o, 0));
+                EmitLoadCell (o, true, c_rcx, a);
+                EmitTest (o, false, c_rax);
+                EmitRM (o, 0, true, 0x0F44, c_rcx, c_frameRegister, GetTopCell (o, 1));    // cmovz rcx, [b]
+                EmitStoreCell (o, true, a, c_rcx);
+                Pop (o, 2);
+                break;
+            }
+
+            case c_waOp_getLocal:
+            case c_waOp_setLocal:
+            case c_waOp_teeLocal:
+            {
+                u32 index;
+_               (ReadLEB_u32 (& index, & o->wasm, o->wasmEnd));
+                if (o->unreachable) break;
+
+                _throwif (m3Err_wasmMalformed, index >= o->numArgs + o->numLocals);
+                i32 local = GetLocalCell (o, index);
+
+                if (opcode == c_waOp_getLocal)
+                {
+                    PushOperand (o, c_jitLocal)->value = index;
+                    break;
+                }
+
+                u32 top = o->depth - 1;
+                M3JitOperand * value = GetOperand (o, top);
+
+                if (value->kind != c_jitLocal or value->value != index)
+                {
+                    FlushLocal (o, index);
+
+                    switch (value->kind)
+                    {
+                        case c_jitRegister: EmitStoreCell (o, true, local, value->reg); break;
+                        case c_jitConstant: EmitStoreConstant (o, local, value->value); break;
+                        case c_jitLocal:    EmitCopyCell (o, local, GetLocalCell (o, (u32) value->value)); break;
+                        default:            EmitCopyCell (o, local, GetStackCell (o, top)); break;
+                    }
+                }
+
+                if (opcode == c_waOp_setLocal)
+                    Pop (o, 1);
+                break;
+            }
+
+            case c_waOp_getGlobal:
+            case c_jitOp_setGlobal:
+            {
+                u32 index;
+_               (ReadLEB_u32 (& index, & o->wasm, o->wasmEnd));
+                if (o->unreachable) break;
+
+                _throwif (m3Err_wasmMalformed, index >= o->module->numGlobals);
+                IM3Global global = & o->module->globals [index];
+                _throwif ("jit: unsupported type", global->type == c_m3Type_v128);
+
+                bool wide = (global->type == c_m3Type_i64 or global->type == c_m3Type_f64);
+
+                if (opcode == c_waOp_getGlobal)
+                {
+                    u8 reg = AllocateRegister (o);
+                    EmitMoveImmediate (o, c_rax, (u64) (uintptr_t) & global->intValue);
+                    EmitRM (o, 0, wide, 0x8B, reg, c_rax, 0);
+                    PushRegister (o, reg);
+                }
+                else
+                {
+                    u32 top = o->depth - 1;
+                    u8 reg = GetOperand (o, top)->reg;
+
+                    if (GetOperand (o, top)->kind != c_jitRegister)
+                    {
+                        reg = c_rcx;
+                        EmitLoadOperand (o, wide, reg, top);
+                    }
+
+                    EmitMoveImmediate (o, c_rax, (u64) (uintptr_t) & global->intValue);
+                    EmitRM (o, 0, wide, 0x89, reg, c_rax, 0);
+                    Pop (o, 1);
+                }
+                break;
+            }
+
+            case c_jitOp_memorySize:
+            case c_jitOp_memoryGrow:
+            {
+                u8 reserved;
+_               (Read_u8 (& reserved, & o->wasm, o->wasmEnd));
+                if (o->unreachable) break;
+
+                if (opcode == c_jitOp_memorySize)
+                {
+                    u8 reg = AllocateRegister (o);
+                    EmitRM (o, 0, false, 0x8B, reg, c_runtimeRegister, (i32) (offsetof (M3Runtime, memory) + offsetof (M3Memory, numPages)));
+                    PushRegister (o, reg);
+                }
+                else
+                {
+                    FlushOperands (o, 0);
+                    EmitRR (o, 0, true, 0x89, c_runtimeRegister, c_argRegs [0]);
+                    EmitLeaCell (o, c_argRegs [1], GetTopCell (o, 0));
+_                   (EmitHelperCall (o, (const void *) JitMemoryGrow, true));
+                }
+                break;
+            }
+
+            case c_waOp_i32_const:
+            {
+                i32 value;
+_               (ReadLEB_i32 (& value, & o->wasm, o->wasmEnd));
+                if (o->unreachable) break;
+
+                PushConstant (o, (u64) (i64) value);
+                break;
+            }
+
+            case c_waOp_i64_const:
+            case c_waOp_f64_const:
+            {
+                u64 value;
+                if (opcode == c_waOp_i64_const)
+                {
+                    i64 signedValue;
+_                   (ReadLEB_i64 (& signedValue, & o->wasm, o->wasmEnd));
+                    value = (u64) signedValue;
+                }
+                else
+                {
+_                   (Read_u64 (& value, & o->wasm, o->wasmEnd));
+                }
+                if (o->unreachable) break;
+
+                PushConstant (o, value);
+                break;
+            }
+
+            case c_waOp_f32_const:
+            {
+                u32 value;
+_               (Read_u32 (& value, & o->wasm, o->wasmEnd));
+                if (o->unreachable) break;
+
+                PushConstant (o, value);
+                break;
+            }
+
+            case c_waOp_extended:
+            {
+                u32 extended;
+_               (ReadLEB_u32 (& extended, & o->wasm, o->wasmEnd));
+
+                if (extended <= 7)                                          // trunc_sat
+                {
+                    if (o->unreachable) break;
+_                   (EmitNumericHelper (o, 0xFC00 | extended, 1));
+                }
+                else if (extended == 10 or extended == 11)                  // memory.copy, memory.fill
+                {
+                    u8 reserved;
+_                   (Read_u8 (& reserved, & o->wasm, o->wasmEnd));
+                    if (extended == 10)
+                    {
+_                       (Read_u8 (& reserved, & o->wasm, o->wasmEnd));
+                    }
+                    if (o->unreachable) break;
+
+                    FlushOperands (o, 0);
+                    EmitRR (o, 0, true, 0x89, c_runtimeRegister, c_argRegs [0]);
+                    EmitMoveImmediate (o, c_argRegs [1], 0xFC00 | extended);
+                    EmitLeaCell (o, c_argRegs [2], GetTopCell (o, 2));
+_                   (EmitHelperCall (o, (const void *) JitMemoryBulk, false));
+                    Pop (o, 3);
+                }
+                else _throw ("jit: unsupported opcode");
+                break;
+            }
+
+            default:
+            {
+                if (opcode >= c_jitOp_i32_load and opcode <= c_jitOp_lastStore)
+                {
+                    u32 alignment, offset;
+_                   (ReadLEB_u32 (& alignment, & o->wasm, o->wasmEnd));
+_                   (ReadLEB_u32 (& offset, & o->wasm, o->wasmEnd));
+                    if (o->unreachable) break;
+
+                    if (opcode < c_jitOp_i32_store)
+                    {
+                        CompileLoad (o, opcode, offset);
+                    }
+                    else
+                    {
+                        CompileStore (o, opcode, offset);
+                    }
+                    break;
+                }
+
+                if (o->unreachable)
+                {
+                    // every remaining opcode is immediate free
+                    _throwif ("jit: unsupported opcode", opcode < 0x45 or opcode > 0xC4);
+                    break;
+                }
+
+                if (opcode == 0x45 or opcode == 0x50)                       // eqz
+                {
+                    CompileTestZero (o, opcode == 0x50);
+                }
+                else if (opcode >= 0x46 and opcode <= 0x4F)
+                {
+                    CompileIntegerCompare (o, opcode, false);
+                }
+                else if (opcode >= 0x51 and opcode <= 0x5A)
+                {
+                    CompileIntegerCompare (o, opcode, true);
+                }
+                else if (opcode >= 0x5B and opcode <= 0x60)
+                {
+                    CompileFloatCompare (o, opcode, false);
+                }
+                else if (opcode >= 0x61 and opcode <= 0x66)
+                {
+                    CompileFloatCompare (o, opcode, true);
+                }
+                else if (opcode >= 0x67 and opcode <= 0x69)
+                {
+_                   (EmitNumericHelper (o, opcode, 1));
+                }
+                else if (opcode >= 0x6A and opcode <= 0x78)
+                {
+                    CompileIntegerBinary (o, opcode, false);
+                }
+                else if (opcode >= 0x79 and opcode <= 0x7B)
+                {
+_                   (EmitNumericHelper (o, opcode, 1));
+                }
+                else if (opcode >= 0x7C and opcode <= 0x8A)
+                {
+                    CompileIntegerBinary (o, opcode, true);
+                }
+                else if (opcode >= 0x8B and opcode <= 0x98)
+                {
+_                   (CompileFloatArithmetic (o, opcode, false));
+                }
+                else if (opcode >= 0x99 and opcode <= 0xA6)
+                {
+_                   (CompileFloatArithmetic (o, opcode, true));
+                }
+                else if (opcode >= 0xA7 and opcode <= 0xC4)
+                {
+_                   (CompileConversion (o, opcode));
+                }
+                else
+                    _throw ("jit: unsupported opcode");
+            }
+        }
+
+        _throwif (m3Err_mallocFailed, o->outOfMemory);
+    }
+
+    _throwif (m3Err_wasmMalformed, o->wasm != o->wasmEnd);
+
+    // the function block is closed: copy the results to the return cells
+    for (u32 i = 0; i < o->numRets; ++i)
+        EmitCopyCell (o, (i32) (i * sizeof (u64)), GetStackCell (o, i));
+
+    EmitRR (o, 0, false, 0x31, c_rax, c_rax);                               // xor eax, eax
+
+    epilogue = o->size;
+    ResolveFixups (o, c_targetEpilogue, epilogue);
+    EmitEpilogue (o);
+
+    for (u32 i = 0; i < c_numTraps; ++i)
+    {
+        static const M3Result * c_traps [c_numTraps] = { & m3Err_trapOutOfBoundsMemoryAccess, & m3Err_trapDivisionByZero,
+                                                         & m3Err_trapIntegerOverflow, & m3Err_trapUnreachable };
+        if (o->usesTrap [i])
+        {
+            ResolveFixups (o, c_targetTrap + i, o->size);
+            EmitMoveImmediate (o, c_rax, (u64) (uintptr_t) * c_traps [i]);
+            EmitJumpBackward (o, c_ccAlways, epilogue);
+        }
+    }
+
+    _catch: return result;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------------
+
+static
+void *  AllocateExecutableMemory  (const u8 * i_code, u32 i_size)
+{
+# if defined (_WIN32)
+    void * memory = VirtualAlloc (NULL, i_size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (not memory)
+        return NULL;
+
+    memcpy (memory, i_code, i_size);
+
+    DWORD previous;
+    if (not VirtualProtect (memory, i_size, PAGE_EXECUTE_READ, & previous))
+    {
+        VirtualFree (memory, 0, MEM_RELEASE);
+        return NULL;
+    }
+# else
+    void * memory = mmap (NULL, i_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return NULL;
+
+    memcpy (memory, i_code, i_size);
+
+    if (mprotect (memory, i_size, PROT_READ | PROT_EXEC))
+    {
+        munmap (memory, i_size);
+        return NULL;
+    }
+# endif
+
+    return memory;
+}
+
+static
+void  FreeExecutableMemory  (void * i_memory, u32 i_size)
+{
+# if defined (_WIN32)
+    VirtualFree (i_memory, 0, MEM_RELEASE);
+# else
+    munmap (i_memory, i_size);
+# endif
+}
+
+
+M3Result  JitCompileFunction  (IM3Function io_function)
+{
+    M3Result result = m3Err_none;
+
+    IM3Jit o = NULL;
+    M3JitCode * jitCode = NULL;
+
+    IM3FuncType type = io_function->funcType;
+    IM3Runtime runtime = io_function->module->runtime;
+    M3JitBlock * block;
+    u32 size, numLocalBlocks;
+
+    _throwif ("jit: function isn't compiled", not io_function->compiled or not io_function->wasm);
+    _throwif ("jit: unsupported type", HasV128Type (type));
+
+    o = m3_AllocStruct (M3Jit);
+    _throwifnull (o);
+
+    o->function = io_function;
+    o->module = io_function->module;
+    o->wasm = io_function->wasm;
+    o->wasmEnd = io_function->wasmEnd;
+    o->numRets = type->numRets;
+    o->numArgs = type->numArgs;
+
+_   (ReadLEB_u32 (& size, & o->wasm, o->wasmEnd));
+_   (ReadLEB_u32 (& numLocalBlocks, & o->wasm, o->wasmEnd));
+
+    for (u32 i = 0; i < numLocalBlocks; ++i)
+    {
+        u32 count;
+        u8 localType;
+_       (ReadLEB_u32 (& count, & o->wasm, o->wasmEnd));
+_       (Read_u8 (& localType, & o->wasm, o->wasmEnd));
+        _throwif ("jit: unsupported type", localType == 0x7b);             // v128
+
+        o->numLocals += count;
+        _throwif ("jit: too many locals", o->numLocals > d_m3MaxFunctionSlots);
+    }
+
+    o->stackBase = o->numRets + o->numArgs + o->numLocals;
+
+    // the function body is the outermost block; 'return' branches to it
+    block = & o->blocks [o->numBlocks++];
+    block->opcode = c_waOp_block;
+    block->numResults = o->numRets;
+    block->elseFixup = -1;
+
+    EmitPrologue (o);
+_   (CompileBody (o));
+    _throwif (m3Err_mallocFailed, o->outOfMemory);
+
+    jitCode = m3_AllocStruct (M3JitCode);
+    _throwifnull (jitCode);
+
+    jitCode->code = AllocateExecutableMemory (o->code, o->size);
+    _throwif (m3Err_mallocFailed, not jitCode->code);
+    jitCode->size = o->size;
+
+    jitCode->next = runtime->jitCode;
+    runtime->jitCode = jitCode;
+    runtime->numJitFunctions++;
+    runtime->jitCodeBytes += o->size;
+
+    io_function->jitCode = jitCode->code;
+    io_function->jitFrameBytes = (o->stackBase + o->maxDepth) * sizeof (u64);
+
+    jitCode = NULL;
+
+    _catch:
+
+    m3_Free (jitCode);
+
+    if (o)
+    {
+        m3_Free (o->fixups);
+        m3_Free (o->code);
+        m3_Free (o);
+    }
+
+    return result;
+}
+
+
+void  FreeJitCode  (IM3Runtime io_runtime)
+{
+    M3JitCode * jitCode = io_runtime->jitCode;
+
+    while (jitCode)
+    {
+        M3JitCode * next = jitCode->next;
+
+        FreeExecutableMemory (jitCode->code, jitCode->size);
+        m3_Free (jitCode);
+
+        jitCode = next;
+    }
+
+    io_runtime->jitCode = NULL;
+}
+
+# endif // d_m3EnableJit
@@ -0,0 +1,42 @@
+//
+//  m3_jit.h
+//
+//  Baseline x86-64 tier for hot functions. See m3_jit.c
+//
+
+#ifndef m3_jit_h
+#define m3_jit_h
+
+#include "m3_env.h"
+#include "m3_exec_defs.h"
+
+d_m3BeginExternC
+
+# if d_m3EnableJit
+
+// machine code entry point. i_sp points to the function's return slots, like the interpreter's _sp
+typedef m3ret_t (* M3JitFunction) (m3stack_t i_sp, M3MemoryHeader * i_mem, IM3Runtime i_runtime);
+
+typedef struct M3JitCode
+{
+    struct M3JitCode *      next;
+    void *                  code;
+    u32                     size;
+}
+M3JitCode;
+
+// translates the function's wasm body. on success, io_function->jitCode is set and the caller is
+// expected to rewrite the function's op_Entry to op_JitEntry
+M3Result        JitCompileFunction          (IM3Function io_function);
+
+void            FreeJitCode                 (IM3Runtime io_runtime);
+
+# else
+
+static inline void FreeJitCode              (IM3Runtime io_runtime) {}
+
+# endif // d_m3EnableJit
+
+d_m3EndExternC
+
+#endif // m3_jit_h
@@ -73,6 +73,7 @@ typedef enum M3ValueType
     c_m3Type_i64    = 2,
     c_m3Type_f32    = 3,
     c_m3Type_f64    = 4,
+    c_m3Type_v128   = 5,
 
     c_m3Type_unknown
 } M3ValueType;
@@ -167,6 +168,13 @@ d_m3ErrorConst  (globalLookupFailed,            "global lookup failed")
 d_m3ErrorConst  (globalTypeMismatch,            "global type mismatch")
 d_m3ErrorConst  (globalNotMutable,              "global is not mutable")
 
+// code cache errors
+d_m3ErrorConst  (codeCacheDisabled,             "wasm3 was built without d_m3EnableCodeCache")
+d_m3ErrorConst  (codeCacheStale,                "compiled code cache doesn't match this module or wasm3 build")
+d_m3ErrorConst  (codeCacheMalformed,            "compiled code cache is malformed")
+d_m3ErrorConst  (codeCacheBufferTooSmall,       "compiled code cache buffer is too small")
+d_m3ErrorConst  (jitDisabled,                   "wasm3 was built without d_m3EnableJit")
+
 // traps
 d_m3ErrorConst  (trapOutOfBoundsMemoryAccess,   "[trap] out of bounds memory access")
 d_m3ErrorConst  (trapDivisionByZero,            "[trap] integer divide by zero")
@@ -224,6 +232,29 @@ typedef void* (*m3_resize_proc)(void* p, unsigned long size, void* userData);
 typedef void (*m3_free_proc)(void* p, void* userData);
 void m3_RuntimeSetMemoryCallbacks(IM3Runtime runtime, m3_resize_proc resizeCallback, m3_free_proc freeCallback, void* userData);
 
+///////////////////////////////////////////////////////////////////////////////////////////
+//NOTE(orca): compilation statistics. Functions are compiled on first call when a module
+//            isn't compiled upfront by m3_CompileModule, so these keep changing as it runs.
+///////////////////////////////////////////////////////////////////////////////////////////
+typedef double (*m3_clock_proc)(void);
+
+typedef struct M3CompileStats
+{
+    uint32_t numFunctions;          // functions with a body, across all the runtime's modules
+    uint32_t numCompiledFunctions;  // functions with compiled code, including the ones restored from a code cache
+    uint32_t numCompilations;       // calls to the compiler
+    double   compileTime;           // time spent compiling, in the unit of the clock callback (0 without a clock)
+    uint32_t numJitFunctions;       // functions translated to machine code
+    uint32_t jitCodeBytes;
+} M3CompileStats;
+
+void m3_RuntimeSetClockCallback(IM3Runtime runtime, m3_clock_proc clockCallback);
+
+// translate hot functions to machine code. off by default, and only available when wasm3 is built
+// with d_m3EnableJit on x86-64; returns m3Err_jitDisabled otherwise.
+M3Result m3_RuntimeSetJitEnabled(IM3Runtime runtime, int enabled);
+void m3_GetCompileStats(IM3Runtime runtime, M3CompileStats* stats);
+
 
 //-------------------------------------------------------------------------------------------------------------------------------
 //  modules
@@ -246,6 +277,30 @@ void m3_RuntimeSetMemoryCallbacks(IM3Runtime runtime, m3_resize_proc resizeCallb
     // Optional, compiles all functions in the module
     M3Result            m3_CompileModule            (IM3Module io_module);
 
+///////////////////////////////////////////////////////////////////////////////////////////
+//NOTE(orca): compiled code cache, see m3_cache.c
+///////////////////////////////////////////////////////////////////////////////////////////
+    // Serializes the compiled code of a loaded module. Pass o_buffer = NULL to query the required size in o_size.
+    M3Result            m3_SerializeCompiledModule  (IM3Module              i_module,
+                                                     uint8_t *              o_buffer,
+                                                     uint32_t               i_bufferSize,
+                                                     uint32_t *             o_size);
+
+    // Restores code produced by m3_SerializeCompiledModule instead of compiling the module. The module must have been
+    // parsed from the same bytes, loaded into a runtime and had its imports linked. Returns m3Err_codeCacheStale if
+    // the buffer comes from another module or another wasm3 build. On failure the module is left uncompiled.
+    M3Result            m3_LoadCompiledModule       (IM3Module              io_module,
+                                                     const uint8_t *        i_buffer,
+                                                     uint32_t               i_bufferSize);
+
+    // Reports whether a buffer produced by m3_SerializeCompiledModule holds the code of every function of its module.
+    // A module serialized while it was compiled lazily only holds the functions that had been called. Once such a buffer
+    // is loaded, m3_CompileModule compiles the missing functions.
+    M3Result            m3_GetCompiledModuleInfo    (const uint8_t *        i_buffer,
+                                                     uint32_t               i_bufferSize,
+                                                     int *                  o_isComplete);
+///////////////////////////////////////////////////////////////////////////////////////////
+
     // Calling m3_RunStart is optional
     M3Result            m3_RunStart                 (IM3Module i_module);
 
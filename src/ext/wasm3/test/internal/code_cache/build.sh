@@ -0,0 +1,7 @@
+# Builds the code cache benchmark against the wasm3 sources, with the cache enabled.
+# usage: ./build.sh && ./code_cache_bench [iterations] [run coremark: 0|1]
+
+SRC=../../../source
+
+gcc -O3 -Dd_m3EnableCodeCache=1 -Dd_m3HasWASI=0 -I$SRC \
+    code_cache_bench.c $SRC/*.c -lm -o code_cache_bench
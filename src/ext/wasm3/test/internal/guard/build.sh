@@ -0,0 +1,10 @@
+# Builds the bounds check benchmark against the wasm3 sources, once with the default bounds checks
+# and once with guard pages instead, both with the JIT enabled. 64-bit POSIX hosts only.
+# usage: ./build.sh && ./guard_bench_checked && ./guard_bench
+
+SRC=../../../source
+
+gcc -O3 -Dd_m3EnableJit=1 -Dd_m3JitHotThreshold=1 -Dd_m3HasWASI=0 -I$SRC \
+    guard_bench.c $SRC/*.c -lm -o guard_bench_checked
+gcc -O3 -Dd_m3EnableJit=1 -Dd_m3JitHotThreshold=1 -Dd_m3SkipMemoryBoundsCheck=1 -Dd_m3HasWASI=0 -I$SRC \
+    guard_bench.c $SRC/*.c -lm -o guard_bench
@@ -0,0 +1,301 @@
+//
+//  guard_bench.c
+//
+//  Measures load/store throughput with and without memory bounds checks, and checks that out
+//  of bounds accesses still trap when the checks are replaced by guard pages. Built twice by
+//  build.sh: guard_bench_checked uses wasm3's default bounds checks, guard_bench is built with
+//  d_m3SkipMemoryBoundsCheck and backs the linear memory with a guarded reservation, the way
+//  the Orca runtime does.
+//
+//  On x86-64 the interpreter runs within noise in both builds: the checks are well predicted
+//  branches and the cost of an access is dominated by op dispatch. The JIT keeps the sweep in
+//  registers, so there the check is a visible part of each access and guard pages gain about
+//  a quarter.
+//
+//  The sweep module, in text form:
+//
+//    (memory (export "memory") 16)
+//    (func $sweep (param $n i32) (result i32) (local $i i32) (local $acc i32)
+//        (loop $outer
+//            (local.set $i (i32.const 0))
+//            (loop $inner
+//                (i32.store (local.get $i) (i32.add (i32.load (local.get $i)) (local.get $i)))
+//                (local.set $acc (i32.add (local.get $acc) (i32.load8_u offset=1 (local.get $i))))
+//                (br_if $inner (i32.lt_u (local.tee $i (i32.add (local.get $i) (i32.const 4))) (i32.const 0x100000))))
+//            (br_if $outer (local.tee $n (i32.sub (local.get $n) (i32.const 1)))))
+//        (local.get $acc))
+//    (func $poke (param i32)                    (i32.store (local.get 0) (i32.const 1)))
+//
+//  CoreMark (from the WASI test programs) is run as well, as a less synthetic workload.
+//
+//  See build.sh
+//
+
+#include <setjmp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include "wasm3.h"
+#include "m3_env.h"
+#include "m3_api_libc.h"
+
+#include "extra/coremark_minimal.wasm.h"
+
+#define FATAL(msg, ...) { printf("Fatal: " msg "\n", ##__VA_ARGS__); exit(1); }
+
+static const uint8_t sweep_wasm [] =
+{
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0a, 0x02, 0x60, 0x01, 0x7f, 0x01, 0x7f,
+    0x60, 0x01, 0x7f, 0x00, 0x03, 0x03, 0x02, 0x00, 0x01, 0x05, 0x03, 0x01, 0x00, 0x10, 0x07, 0x19,
+    0x03, 0x06, 0x6d, 0x65, 0x6d, 0x6f, 0x72, 0x79, 0x02, 0x00, 0x05, 0x73, 0x77, 0x65, 0x65, 0x70,
+    0x00, 0x00, 0x04, 0x70, 0x6f, 0x6b, 0x65, 0x00, 0x01, 0x0a, 0x4b, 0x02, 0x3f, 0x01, 0x02, 0x7f,
+    0x03, 0x40, 0x41, 0x00, 0x21, 0x01, 0x03, 0x40, 0x20, 0x01, 0x20, 0x01, 0x28, 0x02, 0x00, 0x20,
+    0x01, 0x6a, 0x36, 0x02, 0x00, 0x20, 0x02, 0x20, 0x01, 0x2d, 0x00, 0x01, 0x6a, 0x21, 0x02, 0x20,
+    0x01, 0x41, 0x04, 0x6a, 0x22, 0x01, 0x41, 0x80, 0x80, 0xc0, 0x00, 0x49, 0x0d, 0x00, 0x0b, 0x20,
+    0x00, 0x41, 0x01, 0x6b, 0x22, 0x00, 0x0d, 0x00, 0x0b, 0x20, 0x02, 0x0b, 0x09, 0x00, 0x20, 0x00,
+    0x41, 0x01, 0x36, 0x02, 0x00, 0x0b,
+};
+
+static const uint32_t c_sweepBytes = 16 * 65536;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000. + ts.tv_nsec / 1000000.;
+}
+
+#if d_m3SkipMemoryBoundsCheck
+
+// Same layout as the Orca runtime: the header sits just below a 64K boundary so that the end of
+// the linear memory is the end of the committed pages, and the reservation covers any address
+// plus offset a guest can form.
+#define DATA_OFFSET     (64 << 10)
+#define HEADER_OFFSET   (DATA_OFFSET - sizeof (M3MemoryHeader))
+#define RESERVE_SIZE    (DATA_OFFSET + (8ULL << 30) + (64 << 10))
+
+typedef struct
+{
+    char *      base;
+    size_t      committed;
+}
+GuardedMemory;
+
+static GuardedMemory    g_memory;
+static sigjmp_buf       g_trapJump;
+static volatile int     g_inCall;
+
+static void* guarded_resize(void* p, unsigned long size, void* userData)
+{
+    GuardedMemory* memory = (GuardedMemory*) userData;
+
+    size_t end = (HEADER_OFFSET + size + 4095) & ~(size_t) 4095;
+    if (end > memory->committed)
+    {
+        if (mprotect (memory->base + memory->committed, end - memory->committed, PROT_READ | PROT_WRITE))
+            return NULL;
+        memory->committed = end;
+    }
+    return memory->base + HEADER_OFFSET;
+}
+
+static void guarded_free(void* p, void* userData)
+{
+    GuardedMemory* memory = (GuardedMemory*) userData;
+    munmap (memory->base, RESERVE_SIZE);
+    memset (memory, 0, sizeof (*memory));
+}
+
+static void fault_handler(int sig, siginfo_t* info, void* context)
+{
+    char* addr = (char*) info->si_addr;
+    if (g_inCall && addr >= g_memory.base + g_memory.committed && addr < g_memory.base + RESERVE_SIZE)
+        siglongjmp (g_trapJump, 1);
+
+    signal (sig, SIG_DFL);
+}
+
+static void setup_memory(IM3Runtime runtime)
+{
+    g_memory.base = mmap (NULL, RESERVE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (g_memory.base == MAP_FAILED) FATAL("couldn't reserve guarded memory");
+    g_memory.committed = 0;
+
+    m3_RuntimeSetMemoryCallbacks (runtime, guarded_resize, guarded_free, &g_memory);
+
+    struct sigaction action = { 0 };
+    action.sa_sigaction = fault_handler;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset (&action.sa_mask);
+    sigaction (SIGSEGV, &action, NULL);
+    sigaction (SIGBUS, &action, NULL);
+}
+
+// runs the call, turning guard page faults into the trap the bounds checks would have returned
+#define GUARDED_CALL(result, call)                                          \
+    if (sigsetjmp (g_trapJump, 1) == 0)                                     \
+    {                                                                       \
+        g_inCall = 1; result = call; g_inCall = 0;                          \
+    }                                                                       \
+    else                                                                    \
+    {                                                                       \
+        g_inCall = 0; result = m3Err_trapOutOfBoundsMemoryAccess;           \
+    }
+
+#else
+
+static void setup_memory(IM3Runtime runtime) {}
+
+#define GUARDED_CALL(result, call)  result = call;
+
+#endif // d_m3SkipMemoryBoundsCheck
+
+static IM3Runtime load(IM3Environment env, const uint8_t* wasm, uint32_t size, int jit)
+{
+    IM3Runtime runtime = m3_NewRuntime(env, 1024*1024, NULL);
+    if (!runtime) FATAL("m3_NewRuntime failed");
+
+    setup_memory(runtime);
+
+    if (jit)
+    {
+        M3Result result = m3_RuntimeSetJitEnabled(runtime, 1);
+        if (result) FATAL("m3_RuntimeSetJitEnabled: %s", result);
+    }
+
+    IM3Module module;
+    M3Result result = m3_ParseModule(env, &module, wasm, size);
+    if (result) FATAL("m3_ParseModule: %s", result);
+
+    result = m3_LoadModule(runtime, module);
+    if (result) FATAL("m3_LoadModule: %s", result);
+
+    result = m3_LinkLibC(module);
+    if (result) FATAL("m3_LinkLibC: %s", result);
+
+    return runtime;
+}
+
+// result of sweep(n) after `warmup` passes have already been made over the memory
+static uint32_t expected_sweep(uint32_t warmup, uint32_t n)
+{
+    uint8_t* mem = calloc(c_sweepBytes, 1);
+    uint32_t acc = 0;
+    for (uint32_t pass = 0; pass < warmup + n; pass++)
+    {
+        for (uint32_t i = 0; i < c_sweepBytes; i += 4)
+        {
+            uint32_t value;
+            memcpy(&value, mem + i, 4);
+            value += i;
+            memcpy(mem + i, &value, 4);
+            if (pass >= warmup)
+                acc += mem[i + 1];
+        }
+    }
+    free(mem);
+    return acc;
+}
+
+static int check_poke(IM3Function poke, uint32_t addr, int shouldTrap)
+{
+    M3Result result;
+    GUARDED_CALL(result, m3_CallV(poke, addr));
+
+    int trapped = (result == m3Err_trapOutOfBoundsMemoryAccess);
+    if (result && !trapped) FATAL("poke(0x%x): %s", addr, result);
+
+    printf("  poke(0x%08x): %-5s %s\n", addr, trapped ? "trap" : "ok", (trapped == shouldTrap) ? "ok" : "MISMATCH");
+    return trapped != shouldTrap;
+}
+
+static int run_sweep(IM3Environment env, uint32_t n, int jit)
+{
+    int failed = 0;
+    IM3Runtime runtime = load(env, sweep_wasm, sizeof(sweep_wasm), jit);
+
+    IM3Function sweep, poke;
+    M3Result result = m3_FindFunction(&sweep, runtime, "sweep");
+    if (result) FATAL("m3_FindFunction: %s", result);
+    result = m3_FindFunction(&poke, runtime, "poke");
+    if (result) FATAL("m3_FindFunction: %s", result);
+
+    // one short call first, so that the JIT has translated sweep before it's timed
+    GUARDED_CALL(result, m3_CallV(sweep, 1));
+    if (result) FATAL("m3_Call: %s", result);
+
+    double start = now_ms();
+    GUARDED_CALL(result, m3_CallV(sweep, n));
+    if (result) FATAL("m3_Call: %s", result);
+    double time = now_ms() - start;
+
+    uint32_t value = 0;
+    result = m3_GetResultsV(sweep, &value);
+    if (result) FATAL("m3_GetResults: %s", result);
+
+    uint32_t expected = expected_sweep(1, n);
+    double accesses = 3. * n * (c_sweepBytes / 4);
+
+    printf("%s sweep(%u): %u %s, %.1fms, %.1fM accesses/s\n", jit ? "jit:        " : "interpreter:", n, value,
+           (value == expected) ? "ok" : "MISMATCH", time, accesses / (time * 1000.));
+    failed |= (value != expected);
+
+    M3CompileStats stats;
+    m3_GetCompileStats(runtime, &stats);
+    if (jit && stats.numJitFunctions == 0) FATAL("sweep wasn't translated");
+
+    // the last word is in bounds, anything reaching past the end must trap
+    failed |= check_poke(poke, c_sweepBytes - 4, 0);
+    failed |= check_poke(poke, c_sweepBytes - 3, 1);
+    failed |= check_poke(poke, c_sweepBytes, 1);
+    failed |= check_poke(poke, 0xfffffffc, 1);
+
+    m3_FreeRuntime(runtime);
+    return failed;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t n = (argc > 1) ? atoi(argv[1]) : 200;
+    int failed = 0;
+
+    printf("bounds checks: %s\n", d_m3SkipMemoryBoundsCheck ? "off (guard pages)" : "on");
+
+    IM3Environment env = m3_NewEnvironment();
+    if (!env) FATAL("m3_NewEnvironment failed");
+
+    failed |= run_sweep(env, n, 0);
+#if d_m3EnableJit
+    failed |= run_sweep(env, n, 1);
+#endif
+
+    {
+        IM3Runtime runtime = load(env, coremark_minimal_wasm, coremark_minimal_wasm_len, 0);
+
+        IM3Function run;
+        M3Result result = m3_FindFunction(&run, runtime, "run");
+        if (result) FATAL("m3_FindFunction: %s", result);
+
+        double start = now_ms();
+        GUARDED_CALL(result, m3_CallV(run));
+        if (result) FATAL("m3_Call: %s", result);
+        double time = now_ms() - start;
+
+        float score = 0;
+        result = m3_GetResultsV(run, &score);
+        if (result) FATAL("m3_GetResults: %s", result);
+
+        // coremark validates its own results and reports 0 if they're wrong
+        printf("coremark:    %.3f %s, %.1fms\n", score, (score > 0) ? "ok" : "FAILED", time);
+        failed |= !(score > 0);
+
+        m3_FreeRuntime(runtime);
+    }
+
+    m3_FreeEnvironment(env);
+    return failed;
+}
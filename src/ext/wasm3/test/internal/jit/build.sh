@@ -0,0 +1,7 @@
+# Builds the JIT test against the wasm3 sources, with the JIT enabled. x86-64 only.
+# usage: ./build.sh && ./jit_bench
+
+SRC=../../../source
+
+gcc -O3 -Dd_m3EnableJit=1 -Dd_m3JitHotThreshold=4 -Dd_m3HasWASI=0 -I$SRC \
+    jit_bench.c $SRC/*.c -lm -o jit_bench
@@ -0,0 +1,144 @@
+//
+//  jit_bench.c
+//
+//  Runs fib and CoreMark with the interpreter only, then with the JIT enabled, and checks
+//  that both tiers agree. CoreMark reports its own score, so its result is compared loosely.
+//
+//  See build.sh
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "wasm3.h"
+#include "m3_api_libc.h"
+
+#include "extra/fib32.wasm.h"
+#include "extra/fib64.wasm.h"
+#include "extra/coremark_minimal.wasm.h"
+
+#define FATAL(msg, ...) { printf("Fatal: " msg "\n", ##__VA_ARGS__); exit(1); }
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000. + ts.tv_nsec / 1000000.;
+}
+
+static IM3Runtime load(IM3Environment env, const uint8_t* wasm, uint32_t size, int jit)
+{
+    IM3Runtime runtime = m3_NewRuntime(env, 1024*1024, NULL);
+    if (!runtime) FATAL("m3_NewRuntime failed");
+
+    M3Result result = m3_RuntimeSetJitEnabled(runtime, jit);
+    if (result) FATAL("m3_RuntimeSetJitEnabled: %s", result);
+
+    IM3Module module;
+    result = m3_ParseModule(env, &module, wasm, size);
+    if (result) FATAL("m3_ParseModule: %s", result);
+
+    result = m3_LoadModule(runtime, module);
+    if (result) FATAL("m3_LoadModule: %s", result);
+
+    result = m3_LinkLibC(module);
+    if (result) FATAL("m3_LinkLibC: %s", result);
+
+    return runtime;
+}
+
+static uint64_t run_fib(IM3Environment env, const uint8_t* wasm, uint32_t size, int is64, uint32_t n, int jit, double* time)
+{
+    IM3Runtime runtime = load(env, wasm, size, jit);
+
+    IM3Function f;
+    M3Result result = m3_FindFunction(&f, runtime, "fib");
+    if (result) FATAL("m3_FindFunction: %s", result);
+
+    double start = now_ms();
+    result = is64 ? m3_CallV(f, (uint64_t)n) : m3_CallV(f, n);
+    if (result) FATAL("m3_Call: %s", result);
+    *time = now_ms() - start;
+
+    uint64_t value = 0;
+    if (is64)
+    {
+        result = m3_GetResultsV(f, &value);
+    }
+    else
+    {
+        uint32_t value32 = 0;
+        result = m3_GetResultsV(f, &value32);
+        value = value32;
+    }
+    if (result) FATAL("m3_GetResults: %s", result);
+
+    M3CompileStats stats;
+    m3_GetCompileStats(runtime, &stats);
+    if (jit && stats.numJitFunctions == 0) FATAL("fib wasn't translated");
+
+    m3_FreeRuntime(runtime);
+    return value;
+}
+
+static float run_coremark(IM3Environment env, int jit, double* time, uint32_t* numJitFunctions)
+{
+    IM3Runtime runtime = load(env, coremark_minimal_wasm, coremark_minimal_wasm_len, jit);
+
+    IM3Function f;
+    M3Result result = m3_FindFunction(&f, runtime, "run");
+    if (result) FATAL("m3_FindFunction: %s", result);
+
+    double start = now_ms();
+    result = m3_CallV(f);
+    if (result) FATAL("m3_Call: %s", result);
+    *time = now_ms() - start;
+
+    float value = 0;
+    result = m3_GetResultsV(f, &value);
+    if (result) FATAL("m3_GetResults: %s", result);
+
+    M3CompileStats stats;
+    m3_GetCompileStats(runtime, &stats);
+    *numJitFunctions = stats.numJitFunctions;
+
+    m3_FreeRuntime(runtime);
+    return value;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t n = (argc > 1) ? atoi(argv[1]) : 30;
+    int failed = 0;
+
+    IM3Environment env = m3_NewEnvironment();
+    if (!env) FATAL("m3_NewEnvironment failed");
+
+    for (int is64 = 0; is64 <= 1; is64++)
+    {
+        const uint8_t* wasm = is64 ? fib64_wasm : fib32_wasm;
+        uint32_t size = is64 ? fib64_wasm_len : fib32_wasm_len;
+
+        double interpreted, jitted;
+        uint64_t expected = run_fib(env, wasm, size, is64, n, 0, &interpreted);
+        uint64_t value = run_fib(env, wasm, size, is64, n, 1, &jitted);
+
+        printf("fib%d(%u):    %llu %s, %.1fms -> %.1fms (x%.2f)\n", is64 ? 64 : 32, n, (unsigned long long)value,
+               (value == expected) ? "ok" : "MISMATCH", interpreted, jitted, interpreted / jitted);
+        failed |= (value != expected);
+    }
+
+    double interpreted, jitted;
+    uint32_t numJitFunctions;
+    float expected = run_coremark(env, 0, &interpreted, &numJitFunctions);
+    float score = run_coremark(env, 1, &jitted, &numJitFunctions);
+
+    // coremark validates its own results and reports 0 if they're wrong
+    printf("coremark:    %.3f -> %.3f %s, %u functions translated\n", expected, score, (score > 0) ? "ok" : "FAILED", numJitFunctions);
+    failed |= !(score > 0);
+
+    m3_FreeEnvironment(env);
+    return failed;
+}
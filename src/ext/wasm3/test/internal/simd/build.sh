@@ -0,0 +1,8 @@
+# Builds the SIMD test against the wasm3 sources, once with the host's SSE paths and once with the
+# portable lane loops only.
+# usage: ./build.sh && ./simd_test && ./simd_test_scalar
+
+SRC=../../../source
+
+gcc -O3 -msse4.1 -Dd_m3HasWASI=0 -I$SRC simd_test.c $SRC/*.c -lm -o simd_test
+gcc -O3 -Dd_m3SimdSSE2=0 -Dd_m3HasWASI=0 -I$SRC simd_test.c $SRC/*.c -lm -o simd_test_scalar
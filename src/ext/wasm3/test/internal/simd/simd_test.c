@@ -0,0 +1,184 @@
+//
+//  simd_test.c
+//
+//  Runs a hand-assembled module that exercises v128 locals, args, returns, globals, memory,
+//  block results, select and a sample of the lane operations. Build it with and without the
+//  SSE paths (see build.sh) to check that both agree.
+//
+//  The module, in text form:
+//
+//    (global $g (mut v128) (v128.const i64x2 7 9))
+//    (func $add4 (param v128 v128) (result v128)   (i32x4.add (local.get 0) (local.get 1)))
+//    (func $dot (param i32) (result i32) (local v128)
+//        (local.set 1 (i32x4.mul (i32x4.splat (local.get 0)) (v128.const i32x4 1 2 3 4)))
+//        (i32x4.extract_lane 3 (call $add4 (local.get 1) (local.get 1))))
+//    (func $shuffle (result i32) (local v128)
+//        (v128.store (i32.const 16) (v128.const i8x16 0 1 2 ... 15))
+//        (local.set 0 (i8x16.shuffle 31 3 0 0 ... (v128.load (i32.add (i32.const 8) (i32.const 8)))
+//                                                  (v128.const i8x16 100 101 ... 115)))
+//        (i32.add (i8x16.extract_lane_u 0 (local.get 0)) (i8x16.extract_lane_u 1 (local.get 0))))
+//    (func $fmul (param f32) (result f32)       (f32x4.extract_lane 0 (f32x4.mul (f32x4.splat (local.get 0)) (v128.const f32x4 1.5 2 3 4))))
+//    (func $global (result i64)                 (global.set $g (i64x2.add (global.get $g) (global.get $g))) (i64x2.extract_lane 1 (global.get $g)))
+//    (func $select (param i32) (result i32)     (i32x4.extract_lane 0 (select (v128.const i32x4 1 1 1 1) (v128.const i32x4 2 2 2 2) (i32.eqz (local.get 0)))))
+//    (func $block (param i32) (result i32)
+//        (i32x4.extract_lane 0 (block (result v128) (br_if 0 (v128.const i32x4 10 0 0 0) (local.get 0)) (drop) (v128.const i32x4 20 0 0 0))))
+//    (func $shift (param i32) (result i32)      (i32x4.extract_lane 2 (i32x4.shl (i32x4.splat (i32.const 1)) (i32.add (local.get 0) (i32.const 1)))))
+//    (func $saturate (result i32)               (i8x16.extract_lane_s 0 (i8x16.add_sat_s (i8x16.splat (i32.const 100)) (i8x16.splat (i32.const 100)))))
+//    (func $truncate (result i32)               (i32x4.extract_lane 1 (i32x4.trunc_sat_f32x4_s (v128.const f32x4 -1.5 3e9 nan 2.5))))
+//    (func $bitmask (result i32)                (i8x16.bitmask (v128.const i8x16 -1 0 -1 0 0 0 0 0 0 0 0 0 0 0 0 -128)))
+//
+//  See build.sh
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wasm3.h"
+
+#define FATAL(msg, ...) { printf("Fatal: " msg "\n", ##__VA_ARGS__); exit(1); }
+
+static const uint8_t simd_wasm [] =
+{
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x19, 0x05, 0x60, 0x02, 0x7b, 0x7b, 0x01,
+    0x7b, 0x60, 0x01, 0x7f, 0x01, 0x7f, 0x60, 0x00, 0x01, 0x7f, 0x60, 0x01, 0x7d, 0x01, 0x7d, 0x60,
+    0x00, 0x01, 0x7e, 0x03, 0x0c, 0x0b, 0x00, 0x01, 0x02, 0x03, 0x04, 0x01, 0x01, 0x01, 0x02, 0x02,
+    0x02, 0x05, 0x03, 0x01, 0x00, 0x01, 0x06, 0x16, 0x01, 0x7b, 0x01, 0xfd, 0x0c, 0x07, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0b, 0x07, 0x61,
+    0x0b, 0x04, 0x61, 0x64, 0x64, 0x34, 0x00, 0x00, 0x03, 0x64, 0x6f, 0x74, 0x00, 0x01, 0x07, 0x73,
+    0x68, 0x75, 0x66, 0x66, 0x6c, 0x65, 0x00, 0x02, 0x04, 0x66, 0x6d, 0x75, 0x6c, 0x00, 0x03, 0x06,
+    0x67, 0x6c, 0x6f, 0x62, 0x61, 0x6c, 0x00, 0x04, 0x06, 0x73, 0x65, 0x6c, 0x65, 0x63, 0x74, 0x00,
+    0x05, 0x05, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x00, 0x06, 0x05, 0x73, 0x68, 0x69, 0x66, 0x74, 0x00,
+    0x07, 0x08, 0x73, 0x61, 0x74, 0x75, 0x72, 0x61, 0x74, 0x65, 0x00, 0x08, 0x08, 0x74, 0x72, 0x75,
+    0x6e, 0x63, 0x61, 0x74, 0x65, 0x00, 0x09, 0x07, 0x62, 0x69, 0x74, 0x6d, 0x61, 0x73, 0x6b, 0x00,
+    0x0a, 0x0a, 0xf1, 0x02, 0x0b, 0x09, 0x00, 0x20, 0x00, 0x20, 0x01, 0xfd, 0xae, 0x01, 0x0b, 0x28,
+    0x01, 0x01, 0x7b, 0x20, 0x00, 0xfd, 0x11, 0xfd, 0x0c, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
+    0x00, 0x03, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0xfd, 0xb5, 0x01, 0x21, 0x01, 0x20, 0x01,
+    0x20, 0x01, 0x10, 0x00, 0xfd, 0x1b, 0x03, 0x0b, 0x56, 0x01, 0x01, 0x7b, 0x41, 0x10, 0xfd, 0x0c,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0xfd, 0x0b, 0x04, 0x00, 0x41, 0x08, 0x41, 0x08, 0x6a, 0xfd, 0x00, 0x04, 0x00, 0xfd, 0x0c, 0x64,
+    0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0xfd,
+    0x0d, 0x1f, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x21, 0x00, 0x20, 0x00, 0xfd, 0x16, 0x00, 0x20, 0x00, 0xfd, 0x16, 0x01, 0x6a, 0x0b, 0x1e,
+    0x00, 0x20, 0x00, 0xfd, 0x13, 0xfd, 0x0c, 0x00, 0x00, 0xc0, 0x3f, 0x00, 0x00, 0x00, 0x40, 0x00,
+    0x00, 0x40, 0x40, 0x00, 0x00, 0x80, 0x40, 0xfd, 0xe6, 0x01, 0xfd, 0x1f, 0x00, 0x0b, 0x10, 0x00,
+    0x23, 0x00, 0x23, 0x00, 0xfd, 0xce, 0x01, 0x24, 0x00, 0x23, 0x00, 0xfd, 0x1d, 0x01, 0x0b, 0x2d,
+    0x00, 0xfd, 0x0c, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0xfd, 0x0c, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
+    0x00, 0x02, 0x00, 0x00, 0x00, 0x20, 0x00, 0x45, 0x1b, 0xfd, 0x1b, 0x00, 0x0b, 0x31, 0x00, 0x02,
+    0x7b, 0xfd, 0x0c, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x20, 0x00, 0x0d, 0x00, 0x1a, 0xfd, 0x0c, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0b, 0xfd, 0x1b, 0x00, 0x0b, 0x11,
+    0x00, 0x41, 0x01, 0xfd, 0x11, 0x20, 0x00, 0x41, 0x01, 0x6a, 0xfd, 0xab, 0x01, 0xfd, 0x1b, 0x02,
+    0x0b, 0x11, 0x00, 0x41, 0xe4, 0x00, 0xfd, 0x0f, 0x41, 0xe4, 0x00, 0xfd, 0x0f, 0xfd, 0x6f, 0xfd,
+    0x15, 0x00, 0x0b, 0x1a, 0x00, 0xfd, 0x0c, 0x00, 0x00, 0xc0, 0xbf, 0x5e, 0xd0, 0x32, 0x4f, 0x00,
+    0x00, 0xc0, 0x7f, 0x00, 0x00, 0x20, 0x40, 0xfd, 0xf8, 0x01, 0xfd, 0x1b, 0x01, 0x0b, 0x16, 0x00,
+    0xfd, 0x0c, 0xff, 0x00, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x80, 0xfd, 0x64, 0x0b,
+
+};
+
+static IM3Function find(IM3Runtime runtime, const char* name)
+{
+    IM3Function f;
+    M3Result result = m3_FindFunction(&f, runtime, name);
+    if (result) FATAL("m3_FindFunction(%s): %s", name, result);
+    return f;
+}
+
+static uint64_t call(IM3Runtime runtime, const char* name, int32_t arg)
+{
+    IM3Function f = find(runtime, name);
+
+    M3Result result = (m3_GetArgCount(f) > 0) ? m3_CallV(f, arg) : m3_CallV(f);
+    if (result) FATAL("m3_Call(%s): %s", name, result);
+
+    uint64_t value = 0;
+    if (m3_GetRetType(f, 0) == c_m3Type_i64)
+    {
+        result = m3_GetResultsV(f, &value);
+    }
+    else
+    {
+        uint32_t value32 = 0;
+        result = m3_GetResultsV(f, &value32);
+        value = value32;
+    }
+    if (result) FATAL("m3_GetResults(%s): %s", name, result);
+
+    return value;
+}
+
+static int check(const char* name, int32_t arg, uint64_t value, uint64_t expected)
+{
+    printf("%-10s(%d): %llu %s\n", name, arg, (unsigned long long)value, (value == expected) ? "ok" : "MISMATCH");
+    return value != expected;
+}
+
+int main(int argc, char** argv)
+{
+    int failed = 0;
+
+    IM3Environment env = m3_NewEnvironment();
+    if (!env) FATAL("m3_NewEnvironment failed");
+
+    IM3Runtime runtime = m3_NewRuntime(env, 64*1024, NULL);
+    if (!runtime) FATAL("m3_NewRuntime failed");
+
+    IM3Module module;
+    M3Result result = m3_ParseModule(env, &module, simd_wasm, sizeof(simd_wasm));
+    if (result) FATAL("m3_ParseModule: %s", result);
+
+    result = m3_LoadModule(runtime, module);
+    if (result) FATAL("m3_LoadModule: %s", result);
+
+    // v128 args and results are passed through 16-byte buffers
+    {
+        int32_t a [4] = { 1, 2, 3, 4 }, b [4] = { 10, 20, 30, 40 }, r [4] = { 0 };
+        const void* args [] = { a, b };
+        const void* rets [] = { r };
+
+        IM3Function f = find(runtime, "add4");
+        result = m3_Call(f, 2, args);
+        if (result) FATAL("m3_Call(add4): %s", result);
+        result = m3_GetResults(f, 1, rets);
+        if (result) FATAL("m3_GetResults(add4): %s", result);
+
+        int ok = (r[0] == 11 && r[1] == 22 && r[2] == 33 && r[3] == 44);
+        printf("%-10s    : %d %d %d %d %s\n", "add4", r[0], r[1], r[2], r[3], ok ? "ok" : "MISMATCH");
+        failed |= !ok;
+    }
+
+    {
+        float x = 2.f, r = 0;
+        const void* args [] = { &x };
+        const void* rets [] = { &r };
+
+        IM3Function f = find(runtime, "fmul");
+        result = m3_Call(f, 1, args);
+        if (result) FATAL("m3_Call(fmul): %s", result);
+        result = m3_GetResults(f, 1, rets);
+        if (result) FATAL("m3_GetResults(fmul): %s", result);
+
+        printf("%-10s    : %g %s\n", "fmul", r, (r == 3.f) ? "ok" : "MISMATCH");
+        failed |= (r != 3.f);
+    }
+
+    failed |= check("dot",      5, call(runtime, "dot", 5),         40);
+    failed |= check("shuffle",  0, call(runtime, "shuffle", 0),     115 + 3);
+    failed |= check("global",   0, call(runtime, "global", 0),      18);
+    failed |= check("select",   0, call(runtime, "select", 0),      1);
+    failed |= check("select",   5, call(runtime, "select", 5),      2);
+    failed |= check("block",    1, call(runtime, "block", 1),       10);
+    failed |= check("block",    0, call(runtime, "block", 0),       20);
+    failed |= check("shift",    2, call(runtime, "shift", 2),       8);
+    failed |= check("saturate", 0, call(runtime, "saturate", 0),    127);
+    failed |= check("truncate", 0, call(runtime, "truncate", 0),    2147483647);
+    failed |= check("bitmask",  0, call(runtime, "bitmask", 0),     0x8005);
+
+    m3_FreeRuntime(runtime);
+    m3_FreeEnvironment(env);
+
+    printf(failed ? "FAILED\n" : "all passed\n");
+    return failed;
+}
@@ -0,0 +1,185 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+#if OC_PLATFORM_WINDOWS
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+#include "canvas_workers.h"
+#include "util/macros.h"
+
+static u32 oc_canvas_workers_processor_count(void)
+{
+#if OC_PLATFORM_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long count = info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (oc_clamp(count, 1, OC_CANVAS_MAX_WORKERS + 1));
+}
+
+static void oc_canvas_workers_drain(oc_canvas_workers* workers, u32 workerIndex)
+{
+    while(1)
+    {
+        u32 jobIndex = atomic_fetch_add(&workers->nextJob, 1);
+        if(jobIndex >= workers->jobCount)
+        {
+            break;
+        }
+        workers->proc(workers->user, workerIndex, jobIndex);
+    }
+}
+
+static i32 oc_canvas_worker_proc(void* user)
+{
+    oc_canvas_worker* worker = (oc_canvas_worker*)user;
+    oc_canvas_workers* workers = worker->workers;
+
+    //NOTE: the worker's generation is set at creation, so that a batch of jobs issued before the thread
+    //      gets to run isn't missed
+    oc_mutex_lock(workers->mutex);
+    while(1)
+    {
+        while(workers->generation == worker->generation && !workers->quit)
+        {
+            oc_condition_wait(workers->start, workers->mutex);
+        }
+        if(workers->quit)
+        {
+            break;
+        }
+        worker->generation = workers->generation;
+        oc_mutex_unlock(workers->mutex);
+
+        oc_canvas_workers_drain(workers, worker->index);
+
+        oc_mutex_lock(workers->mutex);
+        workers->busyCount--;
+        if(workers->busyCount == 0)
+        {
+            oc_condition_signal(workers->done);
+        }
+    }
+    oc_mutex_unlock(workers->mutex);
+    return (0);
+}
+
+void oc_canvas_workers_init(oc_canvas_workers* workers, oc_str8 name)
+{
+    memset(workers, 0, sizeof(oc_canvas_workers));
+
+    workers->runMutex = oc_mutex_create();
+    workers->mutex = oc_mutex_create();
+    workers->start = oc_condition_create();
+    workers->done = oc_condition_create();
+
+    if(!workers->runMutex || !workers->mutex || !workers->start || !workers->done)
+    {
+        oc_log_error("couldn't create canvas worker pool, running jobs on the calling thread\n");
+        return;
+    }
+
+    u32 workerCount = oc_canvas_workers_processor_count() - 1;
+    for(u32 i = 0; i < workerCount; i++)
+    {
+        oc_canvas_worker* worker = &workers->workers[i];
+        worker->workers = workers;
+        worker->index = i + 1;
+        worker->generation = workers->generation;
+        worker->thread = oc_thread_create_with_name(oc_canvas_worker_proc, worker, name);
+        if(!worker->thread)
+        {
+            break;
+        }
+        workers->workerCount++;
+    }
+}
+
+void oc_canvas_workers_cleanup(oc_canvas_workers* workers)
+{
+    if(workers->workerCount)
+    {
+        oc_mutex_lock(workers->mutex);
+        workers->quit = true;
+        oc_condition_broadcast(workers->start);
+        oc_mutex_unlock(workers->mutex);
+
+        for(u32 i = 0; i < workers->workerCount; i++)
+        {
+            oc_thread_join(workers->workers[i].thread, 0);
+        }
+    }
+    if(workers->start)
+    {
+        oc_condition_destroy(workers->start);
+    }
+    if(workers->done)
+    {
+        oc_condition_destroy(workers->done);
+    }
+    if(workers->mutex)
+    {
+        oc_mutex_destroy(workers->mutex);
+    }
+    if(workers->runMutex)
+    {
+        oc_mutex_destroy(workers->runMutex);
+    }
+    memset(workers, 0, sizeof(oc_canvas_workers));
+}
+
+u32 oc_canvas_workers_count(oc_canvas_workers* workers)
+{
+    return (workers->workerCount + 1);
+}
+
+void oc_canvas_workers_run(oc_canvas_workers* workers, u32 jobCount, oc_canvas_job_proc proc, void* user)
+{
+    if(workers->runMutex)
+    {
+        oc_mutex_lock(workers->runMutex);
+    }
+
+    workers->proc = proc;
+    workers->user = user;
+    workers->jobCount = jobCount;
+    atomic_store(&workers->nextJob, 0);
+
+    //NOTE: don't bother waking workers for a single job
+    bool wake = workers->workerCount && jobCount > 1;
+    if(wake)
+    {
+        oc_mutex_lock(workers->mutex);
+        workers->busyCount = workers->workerCount;
+        workers->generation++;
+        oc_condition_broadcast(workers->start);
+        oc_mutex_unlock(workers->mutex);
+    }
+
+    oc_canvas_workers_drain(workers, 0);
+
+    if(wake)
+    {
+        oc_mutex_lock(workers->mutex);
+        while(workers->busyCount)
+        {
+            oc_condition_wait(workers->done, workers->mutex);
+        }
+        oc_mutex_unlock(workers->mutex);
+    }
+
+    if(workers->runMutex)
+    {
+        oc_mutex_unlock(workers->runMutex);
+    }
+}
@@ -0,0 +1,65 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+#ifndef __CANVAS_WORKERS_H_
+#define __CANVAS_WORKERS_H_
+
+#include "platform/platform_thread.h"
+#include "util/strings.h"
+#include "util/typedefs.h"
+
+//NOTE: a pool of threads that canvas backends use to split the work of a frame into jobs. oc_canvas_workers_run()
+//      hands out job indices to the workers and to the calling thread, and returns once all jobs are done.
+//      The worker index passed to the job proc is 0 for the calling thread, so that backends can keep per-worker
+//      scratch data in an array of oc_canvas_workers_count() entries.
+//      All canvas surfaces share the pool returned by oc_graphics_canvas_workers(). Surfaces rendering on different
+//      threads take turns: oc_canvas_workers_run() runs one batch of jobs at a time.
+
+enum
+{
+    OC_CANVAS_MAX_WORKERS = 32,
+};
+
+typedef void (*oc_canvas_job_proc)(void* user, u32 workerIndex, u32 jobIndex);
+
+typedef struct oc_canvas_workers oc_canvas_workers;
+
+typedef struct oc_canvas_worker
+{
+    oc_canvas_workers* workers;
+    oc_thread* thread;
+    u32 index;
+    u64 generation; // last batch of jobs this worker was woken for
+
+} oc_canvas_worker;
+
+typedef struct oc_canvas_workers
+{
+    oc_mutex* runMutex; // held by the thread running a batch of jobs
+    oc_mutex* mutex;
+    oc_condition* start;
+    oc_condition* done;
+    u64 generation;
+    u32 busyCount;
+    bool quit;
+
+    u32 workerCount;
+    oc_canvas_worker workers[OC_CANVAS_MAX_WORKERS];
+
+    oc_canvas_job_proc proc;
+    void* user;
+    u32 jobCount;
+    _Atomic(u32) nextJob;
+
+} oc_canvas_workers;
+
+void oc_canvas_workers_init(oc_canvas_workers* workers, oc_str8 name);
+void oc_canvas_workers_cleanup(oc_canvas_workers* workers);
+u32 oc_canvas_workers_count(oc_canvas_workers* workers); // number of threads running jobs, including the caller
+void oc_canvas_workers_run(oc_canvas_workers* workers, u32 jobCount, oc_canvas_job_proc proc, void* user);
+
+#endif //__CANVAS_WORKERS_H_
@@ -0,0 +1,2771 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+#include <math.h>
+
+#include "canvas_workers.h"
+#include "graphics_surface.h"
+#include "util/hash.h"
+#include "util/macros.h"
+
+//NOTE: The cpu canvas backend runs the same tile-based algorithm as the GL and Metal backends, without a GPU:
+//
+//      - paths are encoded into monotonic segments, which are binned into the tiles they cross (path setup,
+//        segment setup, backprop, as in the compute shaders),
+//      - each screen tile gets the ordered list of paths that touch it (merge),
+//      - tiles are rasterized in parallel by a pool of worker threads into an RGBA8 framebuffer.
+//
+//      The raster pass evaluates a whole row of samples at a time. The tests that only depend on the row are
+//      hoisted out, and the per-sample loops are straight-line code that the compiler vectorizes.
+//
+//      The framebuffer is kept across frames. Before rasterizing a tile, we hash everything its raster depends on,
+//      and skip it if the hash matches the previous frame's, so mostly static frames only redraw what changed.
+//      This backend is used by headless surfaces, and serves as a reference for the GPU backends.
+
+typedef struct oc_cpu_image
+{
+    oc_image_data interface;
+    u8* pixels;
+    u64 version; // changes on each upload, so that tiles sampling the image get redrawn
+} oc_cpu_image;
+
+static u64 oc_cpuImageVersion = 0;
+
+enum
+{
+    OC_CPU_TILE_SIZE = 16,
+    OC_CPU_MSAA_COUNT = 8,
+    OC_CPU_SRC_SAMPLE_COUNT = 2,
+    OC_CPU_TILE_PIXEL_COUNT = OC_CPU_TILE_SIZE * OC_CPU_TILE_SIZE,
+};
+
+enum oc_cpu_seg_kind_enum
+{
+    OC_CPU_LINE = 1,
+    OC_CPU_QUADRATIC,
+    OC_CPU_CUBIC,
+};
+
+typedef int oc_cpu_seg_kind;
+
+// curve config
+enum oc_cpu_seg_config_enum
+{
+    OC_CPU_BL = 1, /* curve on bottom left */
+    OC_CPU_BR,     /* curve on bottom right */
+    OC_CPU_TL,     /* curve on top left */
+    OC_CPU_TR,     /* curve on top right */
+};
+
+typedef struct oc_cpu_path
+{
+    oc_primitive_cmd cmd;
+    oc_color color;
+    oc_vec4 box;
+    oc_vec4 clip;
+    oc_cpu_image* image;
+    oc_mat2x3 uvTransform;
+    oc_vec4 uvClamp;
+
+    // tiles covered by the path, and index of its first tile queue
+    i32 area[4];
+    u32 tileQueues;
+
+} oc_cpu_path;
+
+typedef struct oc_cpu_path_elt
+{
+    oc_vec2 p[4];
+    u32 pathIndex;
+    oc_cpu_seg_kind kind;
+
+} oc_cpu_path_elt;
+
+typedef struct oc_cpu_segment
+{
+    oc_cpu_seg_kind kind;
+    u32 pathIndex;
+    int config;
+    i32 windingIncrement;
+    oc_vec4 box;
+    f32 implicitMatrix[3][3]; // rows give k, l, m as functions of (x, y, 1)
+    oc_vec2 hullVertex;
+    f32 sign;
+
+} oc_cpu_segment;
+
+typedef struct oc_cpu_tile_op
+{
+    i32 next;
+    u32 segIndex;
+    bool crossRight;
+
+} oc_cpu_tile_op;
+
+typedef struct oc_cpu_tile_queue
+{
+    i32 windingOffset;
+    i32 first;
+
+} oc_cpu_tile_queue;
+
+typedef enum
+{
+    OC_CPU_OP_FILL,
+    OC_CPU_OP_CLIP_FILL,
+    OC_CPU_OP_SEGMENTS,
+} oc_cpu_tile_entry_kind;
+
+typedef struct oc_cpu_tile_entry
+{
+    oc_cpu_tile_entry_kind kind;
+    u32 pathIndex;
+    u32 tileQueue;
+    i32 next;
+
+} oc_cpu_tile_entry;
+
+typedef struct oc_cpu_screen_tile
+{
+    i32 first;
+    i32 last;
+
+} oc_cpu_screen_tile;
+
+// per-worker scratch data for rasterizing a tile
+typedef struct oc_cpu_tile_raster
+{
+    i32 winding[OC_CPU_MSAA_COUNT][OC_CPU_TILE_PIXEL_COUNT];
+    f32 coverage[OC_CPU_TILE_PIXEL_COUNT];
+    f32 color[4][OC_CPU_TILE_PIXEL_COUNT];
+
+} oc_cpu_tile_raster;
+
+typedef struct oc_cpu_canvas_backend
+{
+    oc_canvas_backend interface;
+    oc_surface_data* surface;
+
+    // framebuffer
+    oc_vec2 frameSize;
+    int nTilesX;
+    int nTilesY;
+    u8* pixels;
+    oc_color clearColor;
+    f32 scale;
+
+    // encoding context
+    oc_primitive* primitive;
+    oc_vec4 pathScreenExtents;
+    oc_vec4 pathUserExtents;
+
+    // frame buffers, grown as needed
+    u32 pathCount;
+    u32 pathCap;
+    oc_cpu_path* paths;
+
+    u32 eltCount;
+    u32 eltCap;
+    oc_cpu_path_elt* elements;
+
+    u32 segmentCount;
+    u32 segmentCap;
+    oc_cpu_segment* segments;
+
+    u32 tileQueueCount;
+    u32 tileQueueCap;
+    oc_cpu_tile_queue* tileQueues;
+
+    u32 tileOpCount;
+    u32 tileOpCap;
+    oc_cpu_tile_op* tileOps;
+
+    u32 tileEntryCount;
+    u32 tileEntryCap;
+    oc_cpu_tile_entry* tileEntries;
+
+    u32 screenTileCap;
+    oc_cpu_screen_tile* screenTiles;
+
+    // raster workers, and their scratch tile
+    oc_canvas_workers* workers;
+    oc_cpu_tile_raster* rasters[OC_CANVAS_MAX_WORKERS + 1];
+
+    // damage tracking: hash of the inputs of each tile in the previous frame
+    u64* tileHashes;
+    bool tileHashesValid;
+    _Atomic(u32) dirtyTileCount;
+
+} oc_cpu_canvas_backend;
+
+static void* oc_cpu_canvas_grow(void* buffer, u32* cap, u32 wanted, u32 eltSize, const char* name)
+{
+    if(wanted > *cap)
+    {
+        u32 newCap = oc_max(1024, *cap);
+        while(newCap < wanted)
+        {
+            newCap = newCap + newCap / 2;
+        }
+        buffer = realloc(buffer, (u64)newCap * eltSize);
+        if(!buffer)
+        {
+            OC_ABORT("couldn't allocate canvas %s buffer", name);
+        }
+        *cap = newCap;
+    }
+    return (buffer);
+}
+
+#define oc_cpu_canvas_reserve(backend, buffer, cap, wanted) \
+    (backend)->buffer = oc_cpu_canvas_grow((backend)->buffer, &(backend)->cap, (wanted), sizeof(*(backend)->buffer), #buffer)
+
+static void oc_cpu_update_path_extents(oc_vec4* extents, oc_vec2 p)
+{
+    extents->x = oc_min(extents->x, p.x);
+    extents->y = oc_min(extents->y, p.y);
+    extents->z = oc_max(extents->z, p.x);
+    extents->w = oc_max(extents->w, p.y);
+}
+
+//------------------------------------------------------------------------
+// path encoding
+//------------------------------------------------------------------------
+
+void oc_cpu_canvas_encode_element(oc_cpu_canvas_backend* backend, oc_path_elt_type kind, oc_vec2* p)
+{
+    oc_cpu_canvas_reserve(backend, elements, eltCap, backend->eltCount + 1);
+
+    oc_cpu_path_elt* elt = &backend->elements[backend->eltCount];
+    backend->eltCount++;
+
+    elt->pathIndex = backend->pathCount;
+    int count = 0;
+    switch(kind)
+    {
+        case OC_PATH_LINE:
+            elt->kind = OC_CPU_LINE;
+            count = 2;
+            break;
+
+        case OC_PATH_QUADRATIC:
+            elt->kind = OC_CPU_QUADRATIC;
+            count = 3;
+            break;
+
+        case OC_PATH_CUBIC:
+            elt->kind = OC_CPU_CUBIC;
+            count = 4;
+            break;
+
+        default:
+            break;
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+        oc_cpu_update_path_extents(&backend->pathUserExtents, p[i]);
+
+        oc_vec2 screenP = oc_mat2x3_mul(backend->primitive->attributes.transform, p[i]);
+        elt->p[i] = (oc_vec2){ screenP.x, screenP.y };
+
+        oc_cpu_update_path_extents(&backend->pathScreenExtents, screenP);
+    }
+}
+
+void oc_cpu_canvas_encode_path(oc_cpu_canvas_backend* backend, oc_primitive* primitive, f32 scale)
+{
+    oc_cpu_canvas_reserve(backend, paths, pathCap, backend->pathCount + 1);
+
+    oc_cpu_path* path = &backend->paths[backend->pathCount];
+    backend->pathCount++;
+
+    path->cmd = primitive->cmd;
+    path->box = backend->pathScreenExtents;
+
+    path->clip = (oc_vec4){
+        primitive->attributes.clip.x,
+        primitive->attributes.clip.y,
+        primitive->attributes.clip.x + primitive->attributes.clip.w,
+        primitive->attributes.clip.y + primitive->attributes.clip.h
+    };
+
+    path->color = primitive->attributes.color;
+    path->image = 0;
+
+    if(!oc_image_is_nil(primitive->attributes.image))
+    {
+        path->image = (oc_cpu_image*)oc_image_data_from_handle(primitive->attributes.image);
+    }
+
+    if(path->image)
+    {
+        oc_rect srcRegion = primitive->attributes.srcRegion;
+
+        oc_rect destRegion = {
+            backend->pathUserExtents.x,
+            backend->pathUserExtents.y,
+            backend->pathUserExtents.z - backend->pathUserExtents.x,
+            backend->pathUserExtents.w - backend->pathUserExtents.y
+        };
+
+        oc_vec2 texSize = path->image->interface.size;
+
+        oc_mat2x3 srcRegionToImage = {
+            1 / texSize.x, 0, srcRegion.x / texSize.x,
+            0, 1 / texSize.y, srcRegion.y / texSize.y
+        };
+
+        oc_mat2x3 destRegionToSrcRegion = {
+            srcRegion.w / destRegion.w, 0, 0,
+            0, srcRegion.h / destRegion.h, 0
+        };
+
+        oc_mat2x3 userToDestRegion = {
+            1, 0, -destRegion.x,
+            0, 1, -destRegion.y
+        };
+
+        oc_mat2x3 screenToUser = oc_mat2x3_inv(primitive->attributes.transform);
+
+        oc_mat2x3 uvTransform = srcRegionToImage;
+        uvTransform = oc_mat2x3_mul_m(uvTransform, destRegionToSrcRegion);
+        uvTransform = oc_mat2x3_mul_m(uvTransform, userToDestRegion);
+        uvTransform = oc_mat2x3_mul_m(uvTransform, screenToUser);
+
+        //NOTE: samples are in pixels, so fold the contents scaling in the transform
+        path->uvTransform = (oc_mat2x3){
+            uvTransform.m[0] / scale, uvTransform.m[1] / scale, uvTransform.m[2],
+            uvTransform.m[3] / scale, uvTransform.m[4] / scale, uvTransform.m[5]
+        };
+        path->uvClamp = oc_image_src_region_uv_clamp(srcRegion, texSize);
+    }
+}
+
+static bool oc_cpu_intersect_hull_legs(oc_vec2 p0, oc_vec2 p1, oc_vec2 p2, oc_vec2 p3, oc_vec2* intersection)
+{
+    /*NOTE: check intersection of lines (p0-p1) and (p2-p3)
+
+		P = p0 + u(p1-p0)
+		P = p2 + w(p3-p2)
+	*/
+    bool found = false;
+
+    f32 den = (p0.x - p1.x) * (p2.y - p3.y) - (p0.y - p1.y) * (p2.x - p3.x);
+    if(fabs(den) > 0.0001)
+    {
+        f32 u = ((p0.x - p2.x) * (p2.y - p3.y) - (p0.y - p2.y) * (p2.x - p3.x)) / den;
+
+        intersection->x = p0.x + u * (p1.x - p0.x);
+        intersection->y = p0.y + u * (p1.y - p0.y);
+        found = true;
+    }
+    return (found);
+}
+
+static bool oc_cpu_offset_hull(int count, oc_vec2* p, oc_vec2* result, f32 offset)
+{
+    //NOTE: we should have no more than two coincident points here. This means the leg between
+    //      those two points can't be offset, but we can set a double point at the start of first leg,
+    //      end of first leg, or we can join the first and last leg to create a missing middle one
+
+    oc_vec2 legs[3][2] = { 0 };
+    bool valid[3] = { 0 };
+
+    for(int i = 0; i < count - 1; i++)
+    {
+        oc_vec2 n = { p[i].y - p[i + 1].y,
+                      p[i + 1].x - p[i].x };
+
+        f32 norm = sqrt(n.x * n.x + n.y * n.y);
+        if(norm >= 1e-6)
+        {
+            n = oc_vec2_mul(offset / norm, n);
+            legs[i][0] = oc_vec2_add(p[i], n);
+            legs[i][1] = oc_vec2_add(p[i + 1], n);
+            valid[i] = true;
+        }
+    }
+
+    //NOTE: now we find intersections
+
+    // first point is either the start of the first or second leg
+    if(valid[0])
+    {
+        result[0] = legs[0][0];
+    }
+    else
+    {
+        OC_ASSERT(valid[1]);
+        result[0] = legs[1][0];
+    }
+
+    for(int i = 1; i < count - 1; i++)
+    {
+        //NOTE: we're computing the control point i, at the end of leg (i-1)
+
+        if(!valid[i - 1])
+        {
+            OC_ASSERT(valid[i]);
+            result[i] = legs[i][0];
+        }
+        else if(!valid[i])
+        {
+            OC_ASSERT(valid[i - 1]);
+            result[i] = legs[i - 1][0];
+        }
+        else
+        {
+            if(!oc_cpu_intersect_hull_legs(legs[i - 1][0], legs[i - 1][1], legs[i][0], legs[i][1], &result[i]))
+            {
+                // legs don't intersect.
+                return (false);
+            }
+        }
+    }
+
+    if(valid[count - 2])
+    {
+        result[count - 1] = legs[count - 2][1];
+    }
+    else
+    {
+        OC_ASSERT(valid[count - 3]);
+        result[count - 1] = legs[count - 3][1];
+    }
+
+    return (true);
+}
+
+static oc_vec2 oc_cpu_quadratic_get_point(oc_vec2 p[3], f32 t)
+{
+    oc_vec2 r;
+
+    f32 oneMt = 1 - t;
+    f32 oneMt2 = oc_square(oneMt);
+    f32 t2 = oc_square(t);
+
+    r.x = oneMt2 * p[0].x + 2 * oneMt * t * p[1].x + t2 * p[2].x;
+    r.y = oneMt2 * p[0].y + 2 * oneMt * t * p[1].y + t2 * p[2].y;
+
+    return (r);
+}
+
+static void oc_cpu_quadratic_split(oc_vec2 p[3], f32 t, oc_vec2 outLeft[3], oc_vec2 outRight[3])
+{
+    //NOTE: split bezier curve p at parameter t, using De Casteljau's algorithm
+    f32 oneMt = 1 - t;
+
+    oc_vec2 q0 = { oneMt * p[0].x + t * p[1].x,
+                   oneMt * p[0].y + t * p[1].y };
+
+    oc_vec2 q1 = { oneMt * p[1].x + t * p[2].x,
+                   oneMt * p[1].y + t * p[2].y };
+
+    oc_vec2 s = { oneMt * q0.x + t * q1.x,
+                  oneMt * q0.y + t * q1.y };
+
+    outLeft[0] = p[0];
+    outLeft[1] = q0;
+    outLeft[2] = s;
+
+    outRight[0] = s;
+    outRight[1] = q1;
+    outRight[2] = p[2];
+}
+
+static oc_vec2 oc_cpu_cubic_get_point(oc_vec2 p[4], f32 t)
+{
+    oc_vec2 r;
+
+    f32 oneMt = 1 - t;
+    f32 oneMt2 = oc_square(oneMt);
+    f32 oneMt3 = oneMt2 * oneMt;
+    f32 t2 = oc_square(t);
+    f32 t3 = t2 * t;
+
+    r.x = oneMt3 * p[0].x + 3 * oneMt2 * t * p[1].x + 3 * oneMt * t2 * p[2].x + t3 * p[3].x;
+    r.y = oneMt3 * p[0].y + 3 * oneMt2 * t * p[1].y + 3 * oneMt * t2 * p[2].y + t3 * p[3].y;
+
+    return (r);
+}
+
+static void oc_cpu_cubic_split(oc_vec2 p[4], f32 t, oc_vec2 outLeft[4], oc_vec2 outRight[4])
+{
+    //NOTE: split bezier curve p at parameter t, using De Casteljau's algorithm
+    oc_vec2 q0 = { (1 - t) * p[0].x + t * p[1].x,
+                   (1 - t) * p[0].y + t * p[1].y };
+
+    oc_vec2 q1 = { (1 - t) * p[1].x + t * p[2].x,
+                   (1 - t) * p[1].y + t * p[2].y };
+
+    oc_vec2 q2 = { (1 - t) * p[2].x + t * p[3].x,
+                   (1 - t) * p[2].y + t * p[3].y };
+
+    oc_vec2 r0 = { (1 - t) * q0.x + t * q1.x,
+                   (1 - t) * q0.y + t * q1.y };
+
+    oc_vec2 r1 = { (1 - t) * q1.x + t * q2.x,
+                   (1 - t) * q1.y + t * q2.y };
+
+    oc_vec2 s = { (1 - t) * r0.x + t * r1.x,
+                  (1 - t) * r0.y + t * r1.y };
+
+    outLeft[0] = p[0];
+    outLeft[1] = q0;
+    outLeft[2] = r0;
+    outLeft[3] = s;
+
+    outRight[0] = s;
+    outRight[1] = r1;
+    outRight[2] = q2;
+    outRight[3] = p[3];
+}
+
+void oc_cpu_encode_stroke_line(oc_cpu_canvas_backend* backend, oc_vec2* p)
+{
+    if(p[0].x == p[1].x && p[0].y == p[1].y)
+    {
+        return;
+    }
+
+    f32 width = backend->primitive->attributes.width;
+
+    oc_vec2 v = { p[1].x - p[0].x, p[1].y - p[0].y };
+    oc_vec2 n = { v.y, -v.x };
+    f32 norm = sqrt(n.x * n.x + n.y * n.y);
+    oc_vec2 offset = oc_vec2_mul(0.5 * width / norm, n);
+
+    oc_vec2 left[2] = { oc_vec2_add(p[0], offset), oc_vec2_add(p[1], offset) };
+    oc_vec2 right[2] = { oc_vec2_add(p[1], oc_vec2_mul(-1, offset)), oc_vec2_add(p[0], oc_vec2_mul(-1, offset)) };
+    oc_vec2 joint0[2] = { oc_vec2_add(p[0], oc_vec2_mul(-1, offset)), oc_vec2_add(p[0], offset) };
+    oc_vec2 joint1[2] = { oc_vec2_add(p[1], offset), oc_vec2_add(p[1], oc_vec2_mul(-1, offset)) };
+
+    oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, right);
+    oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, left);
+    oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, joint0);
+    oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, joint1);
+}
+
+enum
+{
+    OC_CPU_HULL_CHECK_SAMPLE_COUNT = 5
+};
+
+void oc_cpu_encode_stroke_quadratic(oc_cpu_canvas_backend* backend, oc_vec2* p)
+{
+    f32 width = backend->primitive->attributes.width;
+    f32 tolerance = oc_min(backend->primitive->attributes.tolerance, 0.5 * width);
+
+    //NOTE: check for degenerate line case
+    const f32 equalEps = 1e-3;
+    if(oc_vec2_close(p[0], p[1], equalEps))
+    {
+        oc_cpu_encode_stroke_line(backend, p + 1);
+        return;
+    }
+    else if(oc_vec2_close(p[1], p[2], equalEps))
+    {
+        oc_cpu_encode_stroke_line(backend, p);
+        return;
+    }
+
+    oc_vec2 leftHull[3];
+    oc_vec2 rightHull[3];
+
+    if(!oc_cpu_offset_hull(3, p, leftHull, width / 2)
+       || !oc_cpu_offset_hull(3, p, rightHull, -width / 2))
+    {
+        //NOTE: offsetting the hull failed, split the curve
+        oc_vec2 splitLeft[3];
+        oc_vec2 splitRight[3];
+        oc_cpu_quadratic_split(p, 0.5, splitLeft, splitRight);
+        oc_cpu_encode_stroke_quadratic(backend, splitLeft);
+        oc_cpu_encode_stroke_quadratic(backend, splitRight);
+    }
+    else
+    {
+        f32 checkSamples[OC_CPU_HULL_CHECK_SAMPLE_COUNT] = { 1. / 6, 2. / 6, 3. / 6, 4. / 6, 5. / 6 };
+
+        f32 d2LowBound = oc_square(0.5 * width - tolerance);
+        f32 d2HighBound = oc_square(0.5 * width + tolerance);
+
+        f32 maxOvershoot = 0;
+        f32 maxOvershootParameter = 0;
+
+        for(int i = 0; i < OC_CPU_HULL_CHECK_SAMPLE_COUNT; i++)
+        {
+            f32 t = checkSamples[i];
+
+            oc_vec2 c = oc_cpu_quadratic_get_point(p, t);
+            oc_vec2 cp = oc_cpu_quadratic_get_point(leftHull, t);
+            oc_vec2 cn = oc_cpu_quadratic_get_point(rightHull, t);
+
+            f32 positiveDistSquare = oc_square(c.x - cp.x) + oc_square(c.y - cp.y);
+            f32 negativeDistSquare = oc_square(c.x - cn.x) + oc_square(c.y - cn.y);
+
+            f32 positiveOvershoot = oc_max(positiveDistSquare - d2HighBound, d2LowBound - positiveDistSquare);
+            f32 negativeOvershoot = oc_max(negativeDistSquare - d2HighBound, d2LowBound - negativeDistSquare);
+
+            f32 overshoot = oc_max(positiveOvershoot, negativeOvershoot);
+
+            if(overshoot > maxOvershoot)
+            {
+                maxOvershoot = overshoot;
+                maxOvershootParameter = t;
+            }
+        }
+
+        if(maxOvershoot > 0)
+        {
+            oc_vec2 splitLeft[3];
+            oc_vec2 splitRight[3];
+            oc_cpu_quadratic_split(p, maxOvershootParameter, splitLeft, splitRight);
+            oc_cpu_encode_stroke_quadratic(backend, splitLeft);
+            oc_cpu_encode_stroke_quadratic(backend, splitRight);
+        }
+        else
+        {
+            oc_vec2 tmp = leftHull[0];
+            leftHull[0] = leftHull[2];
+            leftHull[2] = tmp;
+
+            oc_cpu_canvas_encode_element(backend, OC_PATH_QUADRATIC, rightHull);
+            oc_cpu_canvas_encode_element(backend, OC_PATH_QUADRATIC, leftHull);
+
+            oc_vec2 joint0[2] = { rightHull[2], leftHull[0] };
+            oc_vec2 joint1[2] = { leftHull[2], rightHull[0] };
+            oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, joint0);
+            oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, joint1);
+        }
+    }
+}
+
+void oc_cpu_encode_stroke_cubic(oc_cpu_canvas_backend* backend, oc_vec2* p)
+{
+    f32 width = backend->primitive->attributes.width;
+    f32 tolerance = oc_min(backend->primitive->attributes.tolerance, 0.5 * width);
+
+    //NOTE: check degenerate line cases
+    f32 equalEps = 1e-3;
+
+    if((oc_vec2_close(p[0], p[1], equalEps) && oc_vec2_close(p[2], p[3], equalEps))
+       || (oc_vec2_close(p[0], p[1], equalEps) && oc_vec2_close(p[1], p[2], equalEps))
+       || (oc_vec2_close(p[1], p[2], equalEps) && oc_vec2_close(p[2], p[3], equalEps)))
+    {
+        oc_vec2 line[2] = { p[0], p[3] };
+        oc_cpu_encode_stroke_line(backend, line);
+        return;
+    }
+    else if(oc_vec2_close(p[0], p[1], equalEps) && oc_vec2_close(p[1], p[3], equalEps))
+    {
+        oc_vec2 line[2] = { p[0], oc_vec2_add(oc_vec2_mul(5. / 9, p[0]), oc_vec2_mul(4. / 9, p[2])) };
+        oc_cpu_encode_stroke_line(backend, line);
+        return;
+    }
+    else if(oc_vec2_close(p[0], p[2], equalEps) && oc_vec2_close(p[2], p[3], equalEps))
+    {
+        oc_vec2 line[2] = { p[0], oc_vec2_add(oc_vec2_mul(5. / 9, p[0]), oc_vec2_mul(4. / 9, p[1])) };
+        oc_cpu_encode_stroke_line(backend, line);
+        return;
+    }
+
+    oc_vec2 leftHull[4];
+    oc_vec2 rightHull[4];
+
+    if(!oc_cpu_offset_hull(4, p, leftHull, width / 2)
+       || !oc_cpu_offset_hull(4, p, rightHull, -width / 2))
+    {
+        //NOTE: offsetting the hull failed, split the curve
+        oc_vec2 splitLeft[4];
+        oc_vec2 splitRight[4];
+        oc_cpu_cubic_split(p, 0.5, splitLeft, splitRight);
+        oc_cpu_encode_stroke_cubic(backend, splitLeft);
+        oc_cpu_encode_stroke_cubic(backend, splitRight);
+    }
+    else
+    {
+        f32 checkSamples[OC_CPU_HULL_CHECK_SAMPLE_COUNT] = { 1. / 6, 2. / 6, 3. / 6, 4. / 6, 5. / 6 };
+
+        f32 d2LowBound = oc_square(0.5 * width - tolerance);
+        f32 d2HighBound = oc_square(0.5 * width + tolerance);
+
+        f32 maxOvershoot = 0;
+        f32 maxOvershootParameter = 0;
+
+        for(int i = 0; i < OC_CPU_HULL_CHECK_SAMPLE_COUNT; i++)
+        {
+            f32 t = checkSamples[i];
+
+            oc_vec2 c = oc_cpu_cubic_get_point(p, t);
+            oc_vec2 cp = oc_cpu_cubic_get_point(leftHull, t);
+            oc_vec2 cn = oc_cpu_cubic_get_point(rightHull, t);
+
+            f32 positiveDistSquare = oc_square(c.x - cp.x) + oc_square(c.y - cp.y);
+            f32 negativeDistSquare = oc_square(c.x - cn.x) + oc_square(c.y - cn.y);
+
+            f32 positiveOvershoot = oc_max(positiveDistSquare - d2HighBound, d2LowBound - positiveDistSquare);
+            f32 negativeOvershoot = oc_max(negativeDistSquare - d2HighBound, d2LowBound - negativeDistSquare);
+
+            f32 overshoot = oc_max(positiveOvershoot, negativeOvershoot);
+
+            if(overshoot > maxOvershoot)
+            {
+                maxOvershoot = overshoot;
+                maxOvershootParameter = t;
+            }
+        }
+
+        if(maxOvershoot > 0)
+        {
+            oc_vec2 splitLeft[4];
+            oc_vec2 splitRight[4];
+            oc_cpu_cubic_split(p, maxOvershootParameter, splitLeft, splitRight);
+            oc_cpu_encode_stroke_cubic(backend, splitLeft);
+            oc_cpu_encode_stroke_cubic(backend, splitRight);
+        }
+        else
+        {
+            oc_vec2 tmp = leftHull[0];
+            leftHull[0] = leftHull[3];
+            leftHull[3] = tmp;
+            tmp = leftHull[1];
+            leftHull[1] = leftHull[2];
+            leftHull[2] = tmp;
+
+            oc_cpu_canvas_encode_element(backend, OC_PATH_CUBIC, rightHull);
+            oc_cpu_canvas_encode_element(backend, OC_PATH_CUBIC, leftHull);
+
+            oc_vec2 joint0[2] = { rightHull[3], leftHull[0] };
+            oc_vec2 joint1[2] = { leftHull[3], rightHull[0] };
+            oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, joint0);
+            oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, joint1);
+        }
+    }
+}
+
+void oc_cpu_encode_stroke_element(oc_cpu_canvas_backend* backend,
+                                  oc_path_elt* element,
+                                  oc_vec2 currentPoint,
+                                  oc_vec2* startTangent,
+                                  oc_vec2* endTangent,
+                                  oc_vec2* endPoint)
+{
+    oc_vec2 controlPoints[4] = { currentPoint, element->p[0], element->p[1], element->p[2] };
+    int endPointIndex = 0;
+
+    switch(element->type)
+    {
+        case OC_PATH_LINE:
+            oc_cpu_encode_stroke_line(backend, controlPoints);
+            endPointIndex = 1;
+            break;
+
+        case OC_PATH_QUADRATIC:
+            oc_cpu_encode_stroke_quadratic(backend, controlPoints);
+            endPointIndex = 2;
+            break;
+
+        case OC_PATH_CUBIC:
+            oc_cpu_encode_stroke_cubic(backend, controlPoints);
+            endPointIndex = 3;
+            break;
+
+        case OC_PATH_MOVE:
+            OC_ASSERT(0, "should be unreachable");
+            break;
+    }
+
+    //NOTE: ensure tangents are properly computed even in presence of coincident points
+    for(int i = 1; i < 4; i++)
+    {
+        if(controlPoints[i].x != controlPoints[0].x
+           || controlPoints[i].y != controlPoints[0].y)
+        {
+            *startTangent = (oc_vec2){ .x = controlPoints[i].x - controlPoints[0].x,
+                                       .y = controlPoints[i].y - controlPoints[0].y };
+            break;
+        }
+    }
+    *endPoint = controlPoints[endPointIndex];
+
+    for(int i = endPointIndex - 1; i >= 0; i--)
+    {
+        if(controlPoints[i].x != endPoint->x
+           || controlPoints[i].y != endPoint->y)
+        {
+            *endTangent = (oc_vec2){ .x = endPoint->x - controlPoints[i].x,
+                                     .y = endPoint->y - controlPoints[i].y };
+            break;
+        }
+    }
+    OC_DEBUG_ASSERT(startTangent->x != 0 || startTangent->y != 0);
+}
+
+void oc_cpu_stroke_cap(oc_cpu_canvas_backend* backend,
+                       oc_vec2 p0,
+                       oc_vec2 direction)
+{
+    oc_attributes* attributes = &backend->primitive->attributes;
+
+    //NOTE: compute the tangent and normal vectors (multiplied by half width) at the cap point
+    f32 dn = sqrt(oc_square(direction.x) + oc_square(direction.y));
+    f32 alpha = 0.5 * attributes->width / dn;
+
+    oc_vec2 n0 = { -alpha * direction.y,
+                   alpha * direction.x };
+
+    oc_vec2 m0 = { alpha * direction.x,
+                   alpha * direction.y };
+
+    oc_vec2 points[] = { { p0.x + n0.x, p0.y + n0.y },
+                         { p0.x + n0.x + m0.x, p0.y + n0.y + m0.y },
+                         { p0.x - n0.x + m0.x, p0.y - n0.y + m0.y },
+                         { p0.x - n0.x, p0.y - n0.y },
+                         { p0.x + n0.x, p0.y + n0.y } };
+
+    oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, points);
+    oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, points + 1);
+    oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, points + 2);
+    oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, points + 3);
+}
+
+void oc_cpu_stroke_joint(oc_cpu_canvas_backend* backend,
+                         oc_vec2 p0,
+                         oc_vec2 t0,
+                         oc_vec2 t1)
+{
+    oc_attributes* attributes = &backend->primitive->attributes;
+
+    //NOTE: compute the normals at the joint point
+    f32 norm_t0 = sqrt(oc_square(t0.x) + oc_square(t0.y));
+    f32 norm_t1 = sqrt(oc_square(t1.x) + oc_square(t1.y));
+
+    oc_vec2 n0 = { -t0.y, t0.x };
+    n0.x /= norm_t0;
+    n0.y /= norm_t0;
+
+    oc_vec2 n1 = { -t1.y, t1.x };
+    n1.x /= norm_t1;
+    n1.y /= norm_t1;
+
+    //NOTE: the sign of the cross product determines if the normals are facing outwards or inwards the angle.
+    //      we flip them to face outwards if needed
+    f32 crossZ = n0.x * n1.y - n0.y * n1.x;
+    if(crossZ > 0)
+    {
+        n0.x *= -1;
+        n0.y *= -1;
+        n1.x *= -1;
+        n1.y *= -1;
+    }
+
+    //NOTE: use the same code as hull offset to find mitter point (see oc_gl_stroke_joint())
+    f32 halfW = 0.5 * attributes->width;
+    oc_vec2 u = { n0.x + n1.x, n0.y + n1.y };
+    f32 uNormSquare = u.x * u.x + u.y * u.y;
+    f32 alpha = attributes->width / uNormSquare;
+    oc_vec2 v = { u.x * alpha, u.y * alpha };
+
+    f32 excursionSquare = uNormSquare * oc_square(alpha - attributes->width / 4);
+
+    if(attributes->joint == OC_JOINT_MITER
+       && excursionSquare <= oc_square(attributes->maxJointExcursion))
+    {
+        //NOTE: add a mitter joint
+        oc_vec2 points[] = { p0,
+                             { p0.x + n0.x * halfW, p0.y + n0.y * halfW },
+                             { p0.x + v.x, p0.y + v.y },
+                             { p0.x + n1.x * halfW, p0.y + n1.y * halfW },
+                             p0 };
+
+        oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, points);
+        oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, points + 1);
+        oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, points + 2);
+        oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, points + 3);
+    }
+    else
+    {
+        //NOTE: add a bevel joint
+        oc_vec2 points[] = { p0,
+                             { p0.x + n0.x * halfW, p0.y + n0.y * halfW },
+                             { p0.x + n1.x * halfW, p0.y + n1.y * halfW },
+                             p0 };
+
+        oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, points);
+        oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, points + 1);
+        oc_cpu_canvas_encode_element(backend, OC_PATH_LINE, points + 2);
+    }
+}
+
+u32 oc_cpu_encode_stroke_subpath(oc_cpu_canvas_backend* backend,
+                                 oc_path_elt* elements,
+                                 oc_path_descriptor* path,
+                                 u32 startIndex,
+                                 oc_vec2 startPoint)
+{
+    u32 eltCount = path->count;
+    OC_DEBUG_ASSERT(startIndex < eltCount);
+
+    oc_vec2 currentPoint = startPoint;
+    oc_vec2 endPoint = { 0, 0 };
+    oc_vec2 previousEndTangent = { 0, 0 };
+    oc_vec2 firstTangent = { 0, 0 };
+    oc_vec2 startTangent = { 0, 0 };
+    oc_vec2 endTangent = { 0, 0 };
+
+    //NOTE: encode first element and compute first tangent
+    oc_cpu_encode_stroke_element(backend, elements + startIndex, currentPoint, &startTangent, &endTangent, &endPoint);
+
+    firstTangent = startTangent;
+    previousEndTangent = endTangent;
+    currentPoint = endPoint;
+
+    //NOTE: encode subsequent elements along with their joints
+    oc_attributes* attributes = &backend->primitive->attributes;
+
+    u32 eltIndex = startIndex + 1;
+    for(;
+        eltIndex < eltCount && elements[eltIndex].type != OC_PATH_MOVE;
+        eltIndex++)
+    {
+        oc_cpu_encode_stroke_element(backend, elements + eltIndex, currentPoint, &startTangent, &endTangent, &endPoint);
+
+        if(attributes->joint != OC_JOINT_NONE)
+        {
+            oc_cpu_stroke_joint(backend, currentPoint, previousEndTangent, startTangent);
+        }
+        previousEndTangent = endTangent;
+        currentPoint = endPoint;
+    }
+    u32 subPathEltCount = eltIndex - startIndex;
+
+    //NOTE: draw end cap / joint. We ensure there's at least two segments to draw a closing joint
+    if(subPathEltCount > 1
+       && startPoint.x == endPoint.x
+       && startPoint.y == endPoint.y)
+    {
+        if(attributes->joint != OC_JOINT_NONE)
+        {
+            //NOTE: add a closing joint if the path is closed
+            oc_cpu_stroke_joint(backend, endPoint, endTangent, firstTangent);
+        }
+    }
+    else if(attributes->cap == OC_CAP_SQUARE)
+    {
+        //NOTE: add start and end cap
+        oc_cpu_stroke_cap(backend, startPoint, (oc_vec2){ -startTangent.x, -startTangent.y });
+        oc_cpu_stroke_cap(backend, endPoint, endTangent);
+    }
+    return (eltIndex);
+}
+
+void oc_cpu_encode_stroke(oc_cpu_canvas_backend* backend,
+                          oc_path_elt* elements,
+                          oc_path_descriptor* path)
+{
+    u32 eltCount = path->count;
+    OC_DEBUG_ASSERT(eltCount);
+
+    oc_vec2 startPoint = path->startPoint;
+    u32 startIndex = 0;
+
+    while(startIndex < eltCount)
+    {
+        //NOTE: eliminate leading moves
+        while(startIndex < eltCount && elements[startIndex].type == OC_PATH_MOVE)
+        {
+            startPoint = elements[startIndex].p[0];
+            startIndex++;
+        }
+        if(startIndex < eltCount)
+        {
+            startIndex = oc_cpu_encode_stroke_subpath(backend, elements, path, startIndex, startPoint);
+        }
+    }
+}
+
+//------------------------------------------------------------------------
+// path setup (see path_setup.glsl)
+//------------------------------------------------------------------------
+
+void oc_cpu_canvas_path_setup(oc_cpu_canvas_backend* backend)
+{
+    f32 scale = backend->scale;
+
+    for(u32 pathIndex = 0; pathIndex < backend->pathCount; pathIndex++)
+    {
+        oc_cpu_path* path = &backend->paths[pathIndex];
+
+        //NOTE: we don't clip on the right, since we need those tiles to accurately compute
+        //      the prefix sum of winding increments in the backprop pass.
+        oc_vec4 clippedBox = {
+            oc_max(path->box.x, path->clip.x),
+            oc_max(path->box.y, path->clip.y),
+            path->box.z,
+            oc_min(path->box.w, path->clip.w)
+        };
+
+        int firstTileX = (int)(clippedBox.x * scale) / OC_CPU_TILE_SIZE;
+        int firstTileY = (int)(clippedBox.y * scale) / OC_CPU_TILE_SIZE;
+        int lastTileX = (int)(clippedBox.z * scale) / OC_CPU_TILE_SIZE;
+        int lastTileY = (int)(clippedBox.w * scale) / OC_CPU_TILE_SIZE;
+
+        int nTilesX = oc_max(0, lastTileX - firstTileX + 1);
+        int nTilesY = oc_max(0, lastTileY - firstTileY + 1);
+        u32 tileCount = nTilesX * nTilesY;
+
+        path->area[0] = firstTileX;
+        path->area[1] = firstTileY;
+        path->area[2] = nTilesX;
+        path->area[3] = nTilesY;
+        path->tileQueues = backend->tileQueueCount;
+
+        oc_cpu_canvas_reserve(backend, tileQueues, tileQueueCap, backend->tileQueueCount + tileCount);
+        for(u32 i = 0; i < tileCount; i++)
+        {
+            backend->tileQueues[backend->tileQueueCount + i] = (oc_cpu_tile_queue){ .windingOffset = 0, .first = -1 };
+        }
+        backend->tileQueueCount += tileCount;
+    }
+}
+
+//------------------------------------------------------------------------
+// segment setup (see segment_setup.glsl)
+//------------------------------------------------------------------------
+
+static f32 oc_cpu_ccw(oc_vec2 a, oc_vec2 b, oc_vec2 c)
+{
+    return ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+}
+
+static void oc_cpu_segment_diagonal(oc_cpu_segment* seg, oc_vec2* a, oc_vec2* b)
+{
+    switch(seg->config)
+    {
+        case OC_CPU_TL:
+            *a = (oc_vec2){ seg->box.x, seg->box.y };
+            *b = (oc_vec2){ seg->box.z, seg->box.w };
+            break;
+
+        case OC_CPU_BR:
+            *a = (oc_vec2){ seg->box.z, seg->box.w };
+            *b = (oc_vec2){ seg->box.x, seg->box.y };
+            break;
+
+        case OC_CPU_TR:
+            *a = (oc_vec2){ seg->box.x, seg->box.w };
+            *b = (oc_vec2){ seg->box.z, seg->box.y };
+            break;
+
+        case OC_CPU_BL:
+        default:
+            *a = (oc_vec2){ seg->box.z, seg->box.y };
+            *b = (oc_vec2){ seg->box.x, seg->box.w };
+            break;
+    }
+}
+
+static int oc_cpu_side_of_segment(oc_vec2 p, oc_cpu_segment* seg)
+{
+    int side = 0;
+    if(p.y > seg->box.w || p.y <= seg->box.y)
+    {
+        if(p.x > seg->box.x && p.x <= seg->box.z)
+        {
+            if(p.y > seg->box.w)
+            {
+                side = (seg->config == OC_CPU_TL || seg->config == OC_CPU_BR) ? -1 : 1;
+            }
+            else
+            {
+                side = (seg->config == OC_CPU_TL || seg->config == OC_CPU_BR) ? 1 : -1;
+            }
+        }
+    }
+    else if(p.x > seg->box.z)
+    {
+        side = 1;
+    }
+    else if(p.x <= seg->box.x)
+    {
+        side = -1;
+    }
+    else
+    {
+        oc_vec2 a, b;
+        oc_cpu_segment_diagonal(seg, &a, &b);
+        oc_vec2 c = seg->hullVertex;
+
+        if(oc_cpu_ccw(a, b, p) < 0)
+        {
+            // other side of the diagonal
+            side = (seg->config == OC_CPU_BR || seg->config == OC_CPU_TR) ? -1 : 1;
+        }
+        else if(oc_cpu_ccw(b, c, p) < 0 || oc_cpu_ccw(c, a, p) < 0)
+        {
+            // same side of the diagonal, but outside curve hull
+            side = (seg->config == OC_CPU_BL || seg->config == OC_CPU_TL) ? -1 : 1;
+        }
+        else
+        {
+            // inside curve hull
+            f32(*m)[3] = seg->implicitMatrix;
+            f32 k = m[0][0] * p.x + m[0][1] * p.y + m[0][2];
+            f32 l = m[1][0] * p.x + m[1][1] * p.y + m[1][2];
+            f32 n = m[2][0] * p.x + m[2][1] * p.y + m[2][2];
+
+            switch(seg->kind)
+            {
+                case OC_CPU_LINE:
+                    side = 1;
+                    break;
+
+                case OC_CPU_QUADRATIC:
+                    side = ((k * k - l) * n < 0) ? -1 : 1;
+                    break;
+
+                case OC_CPU_CUBIC:
+                    side = (seg->sign * (k * k * k - l * n) < 0) ? -1 : 1;
+                    break;
+            }
+        }
+    }
+    return (side);
+}
+
+static void oc_cpu_bin_to_tiles(oc_cpu_canvas_backend* backend, u32 segIndex)
+{
+    //NOTE: add segment index to the queues of tiles it overlaps with
+    oc_cpu_segment* seg = &backend->segments[segIndex];
+    oc_cpu_path* path = &backend->paths[seg->pathIndex];
+
+    i32* pathArea = path->area;
+    int coveredTiles[4] = {
+        (int)seg->box.x / OC_CPU_TILE_SIZE,
+        (int)seg->box.y / OC_CPU_TILE_SIZE,
+        (int)seg->box.z / OC_CPU_TILE_SIZE,
+        (int)seg->box.w / OC_CPU_TILE_SIZE,
+    };
+    int xMin = oc_max(0, coveredTiles[0] - pathArea[0]);
+    int yMin = oc_max(0, coveredTiles[1] - pathArea[1]);
+    int xMax = oc_min(coveredTiles[2] - pathArea[0], pathArea[2] - 1);
+    int yMax = oc_min(coveredTiles[3] - pathArea[1], pathArea[3] - 1);
+
+    oc_vec2 s0, s1;
+    if(seg->config == OC_CPU_TL || seg->config == OC_CPU_BR)
+    {
+        s0 = (oc_vec2){ seg->box.x, seg->box.y };
+        s1 = (oc_vec2){ seg->box.z, seg->box.w };
+    }
+    else
+    {
+        s0 = (oc_vec2){ seg->box.x, seg->box.w };
+        s1 = (oc_vec2){ seg->box.z, seg->box.y };
+    }
+
+    for(int y = yMin; y <= yMax; y++)
+    {
+        for(int x = xMin; x <= xMax; x++)
+        {
+            oc_vec4 tileBox = {
+                (f32)(x + pathArea[0]) * OC_CPU_TILE_SIZE,
+                (f32)(y + pathArea[1]) * OC_CPU_TILE_SIZE,
+                (f32)(x + pathArea[0] + 1) * OC_CPU_TILE_SIZE,
+                (f32)(y + pathArea[1] + 1) * OC_CPU_TILE_SIZE,
+            };
+
+            int sbl = oc_cpu_side_of_segment((oc_vec2){ tileBox.x, tileBox.y }, seg);
+            int sbr = oc_cpu_side_of_segment((oc_vec2){ tileBox.z, tileBox.y }, seg);
+            int str = oc_cpu_side_of_segment((oc_vec2){ tileBox.z, tileBox.w }, seg);
+            int stl = oc_cpu_side_of_segment((oc_vec2){ tileBox.x, tileBox.w }, seg);
+
+            bool crossL = (stl * sbl < 0);
+            bool crossR = (str * sbr < 0);
+            bool crossT = (stl * str < 0);
+            bool crossB = (sbl * sbr < 0);
+
+            bool s0Inside = s0.x >= tileBox.x
+                         && s0.x < tileBox.z
+                         && s0.y >= tileBox.y
+                         && s0.y < tileBox.w;
+
+            bool s1Inside = s1.x >= tileBox.x
+                         && s1.x < tileBox.z
+                         && s1.y >= tileBox.y
+                         && s1.y < tileBox.w;
+
+            if(crossL || crossR || crossT || crossB || s0Inside || s1Inside)
+            {
+                oc_cpu_canvas_reserve(backend, tileOps, tileOpCap, backend->tileOpCount + 1);
+
+                u32 tileOpIndex = backend->tileOpCount;
+                backend->tileOpCount++;
+
+                oc_cpu_tile_queue* tileQueue = &backend->tileQueues[path->tileQueues + y * pathArea[2] + x];
+                oc_cpu_tile_op* op = &backend->tileOps[tileOpIndex];
+
+                op->segIndex = segIndex;
+                op->next = tileQueue->first;
+                tileQueue->first = tileOpIndex;
+
+                //NOTE: if the segment crosses the tile's bottom boundary, update the tile's winding offset
+                if(crossB)
+                {
+                    tileQueue->windingOffset += seg->windingIncrement;
+                }
+
+                //NOTE: if the segment crosses the right boundary, mark it.
+                op->crossRight = crossR;
+            }
+        }
+    }
+}
+
+static u32 oc_cpu_push_segment(oc_cpu_canvas_backend* backend, oc_vec2 p[4], oc_cpu_seg_kind kind, u32 pathIndex)
+{
+    oc_cpu_canvas_reserve(backend, segments, segmentCap, backend->segmentCount + 1);
+
+    u32 segIndex = backend->segmentCount;
+    backend->segmentCount++;
+
+    oc_cpu_segment* seg = &backend->segments[segIndex];
+    memset(seg, 0, sizeof(oc_cpu_segment));
+
+    oc_vec2 s, c, e;
+
+    switch(kind)
+    {
+        case OC_CPU_LINE:
+            s = p[0];
+            c = p[0];
+            e = p[1];
+            break;
+
+        case OC_CPU_QUADRATIC:
+            s = p[0];
+            c = p[1];
+            e = p[2];
+            break;
+
+        case OC_CPU_CUBIC:
+        default:
+        {
+            s = p[0];
+            f32 sqrNorm0 = oc_square(p[1].x - p[0].x) + oc_square(p[1].y - p[0].y);
+            f32 sqrNorm1 = oc_square(p[3].x - p[2].x) + oc_square(p[3].y - p[2].y);
+            if(sqrNorm0 < sqrNorm1)
+            {
+                c = p[2];
+            }
+            else
+            {
+                c = p[1];
+            }
+            e = p[3];
+        }
+        break;
+    }
+
+    bool goingUp = e.y >= s.y;
+    bool goingRight = e.x >= s.x;
+
+    oc_vec4 box = {
+        oc_min(s.x, e.x),
+        oc_min(s.y, e.y),
+        oc_max(s.x, e.x),
+        oc_max(s.y, e.y)
+    };
+
+    seg->kind = kind;
+    seg->pathIndex = pathIndex;
+    seg->windingIncrement = goingUp ? 1 : -1;
+    seg->box = box;
+    seg->sign = 1;
+
+    f32 dx = c.x - box.x;
+    f32 dy = c.y - box.y;
+    f32 alpha = (box.w - box.y) / (box.z - box.x);
+    f32 ofs = box.w - box.y;
+
+    if(goingUp == goingRight)
+    {
+        if(kind == OC_CPU_LINE)
+        {
+            seg->config = OC_CPU_BR;
+        }
+        else if(dy > alpha * dx)
+        {
+            seg->config = OC_CPU_TL;
+        }
+        else
+        {
+            seg->config = OC_CPU_BR;
+        }
+    }
+    else
+    {
+        if(kind == OC_CPU_LINE)
+        {
+            seg->config = OC_CPU_TR;
+        }
+        else if(dy < ofs - alpha * dx)
+        {
+            seg->config = OC_CPU_BL;
+        }
+        else
+        {
+            seg->config = OC_CPU_TR;
+        }
+    }
+    return (segIndex);
+}
+
+static void oc_cpu_line_setup(oc_cpu_canvas_backend* backend, oc_vec2 p[4], u32 pathIndex)
+{
+    u32 segIndex = oc_cpu_push_segment(backend, p, OC_CPU_LINE, pathIndex);
+    backend->segments[segIndex].hullVertex = p[0];
+    oc_cpu_bin_to_tiles(backend, segIndex);
+}
+
+static oc_vec2 oc_cpu_quadratic_blossom(oc_vec2 p[4], f32 u, f32 v)
+{
+    oc_vec2 b10 = { u * p[1].x + (1 - u) * p[0].x, u * p[1].y + (1 - u) * p[0].y };
+    oc_vec2 b11 = { u * p[2].x + (1 - u) * p[1].x, u * p[2].y + (1 - u) * p[1].y };
+    oc_vec2 b20 = { v * b11.x + (1 - v) * b10.x, v * b11.y + (1 - v) * b10.y };
+    return (b20);
+}
+
+static void oc_cpu_quadratic_slice(oc_vec2 p[4], f32 s0, f32 s1, oc_vec2 sp[4])
+{
+    //NOTE: using blossoms ensures that consecutive slices share their end points (see segment_setup.glsl)
+    sp[0] = (s0 == 0) ? p[0] : oc_cpu_quadratic_blossom(p, s0, s0);
+    sp[1] = oc_cpu_quadratic_blossom(p, s0, s1);
+    sp[2] = (s1 == 1) ? p[2] : oc_cpu_quadratic_blossom(p, s1, s1);
+}
+
+static int oc_cpu_quadratic_monotonize(oc_vec2 p[4], f32 splits[4])
+{
+    //NOTE: compute split points
+    int count = 0;
+    splits[0] = 0;
+    count++;
+
+    oc_vec2 r = { (p[0].x - p[1].x) / (p[2].x - 2 * p[1].x + p[0].x),
+                  (p[0].y - p[1].y) / (p[2].y - 2 * p[1].y + p[0].y) };
+    if(r.x > r.y)
+    {
+        f32 tmp = r.x;
+        r.x = r.y;
+        r.y = tmp;
+    }
+    if(r.x > 0 && r.x < 1)
+    {
+        splits[count] = r.x;
+        count++;
+    }
+    if(r.y > 0 && r.y < 1)
+    {
+        splits[count] = r.y;
+        count++;
+    }
+    splits[count] = 1;
+    count++;
+    return (count);
+}
+
+static void oc_cpu_quadratic_emit(oc_cpu_canvas_backend* backend, oc_vec2 p[4], u32 pathIndex)
+{
+    u32 segIndex = oc_cpu_push_segment(backend, p, OC_CPU_QUADRATIC, pathIndex);
+    oc_cpu_segment* seg = &backend->segments[segIndex];
+
+    //NOTE: compute implicit equation matrix
+    f32 det = p[0].x * (p[1].y - p[2].y) + p[1].x * (p[2].y - p[0].y) + p[2].x * (p[0].y - p[1].y);
+
+    f32 a = p[0].y - p[1].y + 0.5 * (p[2].y - p[0].y);
+    f32 b = p[1].x - p[0].x + 0.5 * (p[0].x - p[2].x);
+    f32 c = p[0].x * p[1].y - p[1].x * p[0].y + 0.5 * (p[2].x * p[0].y - p[0].x * p[2].y);
+    f32 d = p[0].y - p[1].y;
+    f32 e = p[1].x - p[0].x;
+    f32 f = p[0].x * p[1].y - p[1].x * p[0].y;
+
+    f32 flip = (seg->config == OC_CPU_TL || seg->config == OC_CPU_BL) ? -1 : 1;
+
+    f32 g = flip * (p[2].x * (p[0].y - p[1].y) + p[0].x * (p[1].y - p[2].y) + p[1].x * (p[2].y - p[0].y));
+
+    f32 invDet = 1 / det;
+    seg->implicitMatrix[0][0] = a * invDet;
+    seg->implicitMatrix[0][1] = b * invDet;
+    seg->implicitMatrix[0][2] = c * invDet;
+    seg->implicitMatrix[1][0] = d * invDet;
+    seg->implicitMatrix[1][1] = e * invDet;
+    seg->implicitMatrix[1][2] = f * invDet;
+    seg->implicitMatrix[2][0] = 0;
+    seg->implicitMatrix[2][1] = 0;
+    seg->implicitMatrix[2][2] = g * invDet;
+
+    seg->hullVertex = p[1];
+
+    oc_cpu_bin_to_tiles(backend, segIndex);
+}
+
+static void oc_cpu_quadratic_setup(oc_cpu_canvas_backend* backend, oc_vec2 p[4], u32 pathIndex)
+{
+    f32 splits[4];
+    int splitCount = oc_cpu_quadratic_monotonize(p, splits);
+
+    //NOTE: produce bézier curve for each consecutive pair of roots
+    for(int sliceIndex = 0; sliceIndex < splitCount - 1; sliceIndex++)
+    {
+        oc_vec2 sp[4];
+        oc_cpu_quadratic_slice(p, splits[sliceIndex], splits[sliceIndex + 1], sp);
+        oc_cpu_quadratic_emit(backend, sp, pathIndex);
+    }
+}
+
+static int oc_cpu_quadratic_roots_with_det(f32 a, f32 b, f32 c, f32 det, f32 r[2])
+{
+    int count = 0;
+
+    if(a == 0)
+    {
+        if(b != 0)
+        {
+            count = 1;
+            r[0] = -c / b;
+        }
+    }
+    else
+    {
+        b /= 2.0;
+
+        if(det >= 0)
+        {
+            count = (det == 0) ? 1 : 2;
+
+            if(b > 0)
+            {
+                f32 q = b + sqrt(det);
+                r[0] = -c / q;
+                r[1] = -q / a;
+            }
+            else if(b < 0)
+            {
+                f32 q = -b + sqrt(det);
+                r[0] = q / a;
+                r[1] = c / q;
+            }
+            else
+            {
+                f32 q = sqrt(-a * c);
+                if(fabs(a) >= fabs(c))
+                {
+                    r[0] = q / a;
+                    r[1] = -q / a;
+                }
+                else
+                {
+                    r[0] = -c / q;
+                    r[1] = c / q;
+                }
+            }
+        }
+    }
+    if(count > 1 && r[0] > r[1])
+    {
+        f32 tmp = r[0];
+        r[0] = r[1];
+        r[1] = tmp;
+    }
+    return (count);
+}
+
+static int oc_cpu_quadratic_roots(f32 a, f32 b, f32 c, f32 r[2])
+{
+    f32 det = oc_square(b) / 4. - a * c;
+    return (oc_cpu_quadratic_roots_with_det(a, b, c, det, r));
+}
+
+static oc_vec2 oc_cpu_cubic_blossom(oc_vec2 p[4], f32 u, f32 v, f32 w)
+{
+    oc_vec2 b10 = { u * p[1].x + (1 - u) * p[0].x, u * p[1].y + (1 - u) * p[0].y };
+    oc_vec2 b11 = { u * p[2].x + (1 - u) * p[1].x, u * p[2].y + (1 - u) * p[1].y };
+    oc_vec2 b12 = { u * p[3].x + (1 - u) * p[2].x, u * p[3].y + (1 - u) * p[2].y };
+    oc_vec2 b20 = { v * b11.x + (1 - v) * b10.x, v * b11.y + (1 - v) * b10.y };
+    oc_vec2 b21 = { v * b12.x + (1 - v) * b11.x, v * b12.y + (1 - v) * b11.y };
+    oc_vec2 b30 = { w * b21.x + (1 - w) * b20.x, w * b21.y + (1 - w) * b20.y };
+    return (b30);
+}
+
+static void oc_cpu_cubic_slice(oc_vec2 p[4], f32 s0, f32 s1, oc_vec2 sp[4])
+{
+    //NOTE: using blossoms ensures that consecutive slices share their end points (see segment_setup.glsl)
+    sp[0] = (s0 == 0) ? p[0] : oc_cpu_cubic_blossom(p, s0, s0, s0);
+    sp[1] = oc_cpu_cubic_blossom(p, s0, s0, s1);
+    sp[2] = oc_cpu_cubic_blossom(p, s0, s1, s1);
+    sp[3] = (s1 == 1) ? p[3] : oc_cpu_cubic_blossom(p, s1, s1, s1);
+}
+
+typedef enum
+{
+    OC_CPU_CUBIC_ERROR,
+    OC_CPU_CUBIC_SERPENTINE,
+    OC_CPU_CUBIC_CUSP,
+    OC_CPU_CUBIC_CUSP_INFINITY,
+    OC_CPU_CUBIC_LOOP,
+    OC_CPU_CUBIC_DEGENERATE_QUADRATIC,
+    OC_CPU_CUBIC_DEGENERATE_LINE,
+} oc_cpu_cubic_kind;
+
+typedef struct oc_cpu_cubic_info
+{
+    oc_cpu_cubic_kind kind;
+    f32 K[4][3]; // k, l, m values at each control point
+    oc_vec2 ts[2];
+    f32 d1;
+    f32 d2;
+    f32 d3;
+
+} oc_cpu_cubic_info;
+
+static oc_cpu_cubic_info oc_cpu_cubic_classify(oc_vec2 c[4])
+{
+    //NOTE: see cubic_classify() in segment_setup.glsl for the derivation.
+    //      F[i][j] is the power basis coefficient i of the function j (k, l, m, n)
+    oc_cpu_cubic_info result = { .kind = OC_CPU_CUBIC_ERROR };
+    f32 F[4][4] = { 0 };
+
+    f32 d1 = -(c[3].y * c[2].x - c[3].x * c[2].y);
+    f32 d2 = -(c[3].x * c[1].y - c[3].y * c[1].x);
+    f32 d3 = -(c[2].y * c[1].x - c[2].x * c[1].y);
+
+    result.d1 = d1;
+    result.d2 = d2;
+    result.d3 = d3;
+
+    //NOTE: compute the second factor of the discriminant discr(I) = d1^2*(3*d2^2 - 4*d3*d1)
+    f32 discrFactor2 = 3.0 * oc_square(d2) - 4.0 * d3 * d1;
+
+    //NOTE: each following case gives the number of roots, hence the category of the parametric curve
+    if(fabs(d1) <= 1e-6 && fabs(d2) <= 1e-6 && fabs(d3) > 1e-6)
+    {
+        //NOTE: quadratic degenerate case
+        result.kind = OC_CPU_CUBIC_DEGENERATE_QUADRATIC;
+    }
+    else if((discrFactor2 > 0 && fabs(d1) > 1e-6)
+            || (discrFactor2 == 0 && fabs(d1) > 1e-6))
+    {
+        //NOTE: serpentine curve or cusp with inflection at infinity
+        //      (these two cases are handled the same way).
+        f32 tmtl[2] = { 0 };
+        oc_cpu_quadratic_roots_with_det(1, -2 * d2, (4. / 3. * d1 * d3), (1. / 3.) * discrFactor2, tmtl);
+
+        f32 tm = tmtl[0];
+        f32 sm = 2 * d1;
+        f32 tl = tmtl[1];
+        f32 sl = 2 * d1;
+
+        f32 invNorm = 1 / sqrt(oc_square(tm) + oc_square(sm));
+        tm *= invNorm;
+        sm *= invNorm;
+
+        invNorm = 1 / sqrt(oc_square(tl) + oc_square(sl));
+        tl *= invNorm;
+        sl *= invNorm;
+
+        result.kind = (discrFactor2 > 0 && d1 != 0) ? OC_CPU_CUBIC_SERPENTINE : OC_CPU_CUBIC_CUSP;
+
+        f32 serpentine[4][4] = {
+            { tl * tm, oc_cube(tl), oc_cube(tm), 1 },
+            { -sm * tl - sl * tm, -3 * sl * oc_square(tl), -3 * sm * oc_square(tm), 0 },
+            { sl * sm, 3 * oc_square(sl) * tl, 3 * oc_square(sm) * tm, 0 },
+            { 0, -oc_cube(sl), -oc_cube(sm), 0 },
+        };
+        memcpy(F, serpentine, sizeof(F));
+
+        result.ts[0] = (oc_vec2){ tm, sm };
+        result.ts[1] = (oc_vec2){ tl, sl };
+    }
+    else if(discrFactor2 < 0 && fabs(d1) > 1e-6)
+    {
+        //NOTE: loop curve
+        result.kind = OC_CPU_CUBIC_LOOP;
+
+        f32 tetd[2] = { 0 };
+        oc_cpu_quadratic_roots_with_det(1, -2 * d2, 4 * (oc_square(d2) - d1 * d3), -discrFactor2, tetd);
+
+        f32 td = tetd[1];
+        f32 sd = 2 * d1;
+        f32 te = tetd[0];
+        f32 se = 2 * d1;
+
+        f32 invNorm = 1 / sqrt(oc_square(td) + oc_square(sd));
+        td *= invNorm;
+        sd *= invNorm;
+
+        invNorm = 1 / sqrt(oc_square(te) + oc_square(se));
+        te *= invNorm;
+        se *= invNorm;
+
+        f32 loop[4][4] = {
+            { td * te, oc_square(td) * te, td * oc_square(te), 1 },
+            { -se * td - sd * te, -se * oc_square(td) - 2 * sd * te * td, -sd * oc_square(te) - 2 * se * td * te, 0 },
+            { sd * se, te * oc_square(sd) + 2 * se * td * sd, td * oc_square(se) + 2 * sd * te * se, 0 },
+            { 0, -oc_square(sd) * se, -sd * oc_square(se), 0 },
+        };
+        memcpy(F, loop, sizeof(F));
+
+        result.ts[0] = (oc_vec2){ td, sd };
+        result.ts[1] = (oc_vec2){ te, se };
+    }
+    else if(d2 != 0)
+    {
+        //NOTE: cusp with cusp at infinity
+        f32 tl = d3;
+        f32 sl = 3 * d2;
+
+        f32 invNorm = 1 / sqrt(oc_square(tl) + oc_square(sl));
+        tl *= invNorm;
+        sl *= invNorm;
+
+        result.kind = OC_CPU_CUBIC_CUSP_INFINITY;
+
+        f32 cusp[4][4] = {
+            { tl, oc_cube(tl), 1, 1 },
+            { -sl, -3 * sl * oc_square(tl), 0, 0 },
+            { 0, 3 * oc_square(sl) * tl, 0, 0 },
+            { 0, -oc_cube(sl), 0, 0 },
+        };
+        memcpy(F, cusp, sizeof(F));
+
+        result.ts[0] = (oc_vec2){ tl, sl };
+        result.ts[1] = (oc_vec2){ 0, 0 };
+    }
+    else
+    {
+        //NOTE: line or point degenerate case
+        result.kind = OC_CPU_CUBIC_DEGENERATE_LINE;
+    }
+
+    /*NOTE: F is then multiplied by M3^(-1) on the left which yelds the bezier coefficients k, l, m, n
+	        at the control points.
+
+		               | 1  0   0   0 |
+			M3^(-1) =  | 1  1/3 0   0 |
+			           | 1  2/3 1/3 0 |
+				       | 1  1   1   1 |
+	*/
+    const f32 invM3[4][4] = {
+        { 1, 0, 0, 0 },
+        { 1, 1. / 3., 0, 0 },
+        { 1, 2. / 3., 1. / 3., 0 },
+        { 1, 1, 1, 1 },
+    };
+
+    for(int i = 0; i < 4; i++)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            result.K[i][j] = 0;
+            for(int k = 0; k < 4; k++)
+            {
+                result.K[i][j] += invM3[i][k] * F[k][j];
+            }
+        }
+    }
+    return (result);
+}
+
+static oc_vec2 oc_cpu_select_hull_vertex(oc_vec2 p0, oc_vec2 p1, oc_vec2 p2, oc_vec2 p3)
+{
+    /*NOTE: check intersection of lines (p1-p0) and (p3-p2)
+		P = p0 + u(p1-p0)
+		P = p2 + w(p3-p2)
+
+		control points are inside a right triangle so we should always find an intersection
+	*/
+    oc_vec2 pm;
+
+    f32 det = (p1.x - p0.x) * (p3.y - p2.y) - (p1.y - p0.y) * (p3.x - p2.x);
+    f32 sqrNorm0 = oc_square(p1.x - p0.x) + oc_square(p1.y - p0.y);
+    f32 sqrNorm1 = oc_square(p2.x - p3.x) + oc_square(p2.y - p3.y);
+
+    if(fabs(det) < 1e-3 || sqrNorm0 < 0.1 || sqrNorm1 < 0.1)
+    {
+        if(sqrNorm0 < sqrNorm1)
+        {
+            pm = p2;
+        }
+        else
+        {
+            pm = p1;
+        }
+    }
+    else
+    {
+        f32 u = ((p0.x - p2.x) * (p2.y - p3.y) - (p0.y - p2.y) * (p2.x - p3.x)) / det;
+        pm = (oc_vec2){ p0.x + u * (p1.x - p0.x), p0.y + u * (p1.y - p0.y) };
+    }
+    return (pm);
+}
+
+static void oc_cpu_cubic_emit(oc_cpu_canvas_backend* backend,
+                              oc_cpu_cubic_info* curve,
+                              oc_vec2 p[4],
+                              f32 s0,
+                              f32 s1,
+                              oc_vec2 sp[4],
+                              u32 pathIndex)
+{
+    u32 segIndex = oc_cpu_push_segment(backend, sp, OC_CPU_CUBIC, pathIndex);
+    oc_cpu_segment* seg = &backend->segments[segIndex];
+
+    oc_vec2 v0 = p[0];
+    oc_vec2 v1 = p[3];
+    oc_vec2 v2;
+    int klmIndex[3] = { 0, 3, 1 };
+
+    f32 sqrNorm0 = oc_square(p[1].x - p[0].x) + oc_square(p[1].y - p[0].y);
+    f32 sqrNorm1 = oc_square(p[2].x - p[3].x) + oc_square(p[2].y - p[3].y);
+
+    if(oc_square(p[0].x - p[3].x) + oc_square(p[0].y - p[3].y) > 1e-5)
+    {
+        if(sqrNorm0 >= sqrNorm1)
+        {
+            v2 = p[1];
+            klmIndex[2] = 1;
+        }
+        else
+        {
+            v2 = p[2];
+            klmIndex[2] = 2;
+        }
+    }
+    else
+    {
+        v1 = p[1];
+        v2 = p[2];
+        klmIndex[1] = 1;
+        klmIndex[2] = 2;
+    }
+
+    //NOTE: the implicit matrix maps (x, y, 1) to barycentric coordinates in the (v0, v1, v2) triangle,
+    //      then to the klm values interpolated from the values at the triangle's vertices.
+    f32 det = v0.x * (v1.y - v2.y) + v1.x * (v2.y - v0.y) + v2.x * (v0.y - v1.y);
+    f32 B[3][3] = {
+        { (v1.y - v2.y) / det, (v2.y - v0.y) / det, (v0.y - v1.y) / det },
+        { (v2.x - v1.x) / det, (v0.x - v2.x) / det, (v1.x - v0.x) / det },
+        { (v1.x * v2.y - v2.x * v1.y) / det, (v2.x * v0.y - v0.x * v2.y) / det, (v0.x * v1.y - v1.x * v0.y) / det },
+    };
+
+    for(int row = 0; row < 3; row++)
+    {
+        for(int col = 0; col < 3; col++)
+        {
+            seg->implicitMatrix[row][col] = 0;
+            for(int vertex = 0; vertex < 3; vertex++)
+            {
+                seg->implicitMatrix[row][col] += curve->K[klmIndex[vertex]][row] * B[col][vertex];
+            }
+        }
+    }
+
+    seg->hullVertex = oc_cpu_select_hull_vertex(sp[0], sp[1], sp[2], sp[3]);
+
+    //NOTE: compute sign flip
+    seg->sign = 1;
+
+    if(curve->kind == OC_CPU_CUBIC_SERPENTINE
+       || curve->kind == OC_CPU_CUBIC_CUSP)
+    {
+        seg->sign = (curve->d1 < 0) ? -1 : 1;
+    }
+    else if(curve->kind == OC_CPU_CUBIC_LOOP)
+    {
+        f32 d1 = curve->d1;
+        f32 d2 = curve->d2;
+        f32 d3 = curve->d3;
+
+        f32 H0 = d3 * d1 - oc_square(d2) + d1 * d2 * s0 - oc_square(d1) * oc_square(s0);
+        f32 H1 = d3 * d1 - oc_square(d2) + d1 * d2 * s1 - oc_square(d1) * oc_square(s1);
+        f32 H = (fabs(H0) > fabs(H1)) ? H0 : H1;
+        seg->sign = (H * d1 > 0) ? -1 : 1;
+    }
+
+    if(sp[3].y > sp[0].y)
+    {
+        seg->sign *= -1;
+    }
+
+    oc_cpu_bin_to_tiles(backend, segIndex);
+}
+
+static void oc_cpu_cubic_setup(oc_cpu_canvas_backend* backend, oc_vec2 p[4], u32 pathIndex)
+{
+    //NOTE: first convert the control points to power basis
+    oc_vec2 c[4] = {
+        p[0],
+        { 3.0 * (p[1].x - p[0].x), 3.0 * (p[1].y - p[0].y) },
+        { 3.0 * (p[0].x + p[2].x - 2 * p[1].x), 3.0 * (p[0].y + p[2].y - 2 * p[1].y) },
+        { 3.0 * (p[1].x - p[2].x) + p[3].x - p[0].x, 3.0 * (p[1].y - p[2].y) + p[3].y - p[0].y },
+    };
+
+    //NOTE: get classification, implicit matrix, double points and inflection points
+    oc_cpu_cubic_info curve = oc_cpu_cubic_classify(c);
+
+    if(curve.kind == OC_CPU_CUBIC_DEGENERATE_LINE)
+    {
+        oc_vec2 l[4] = { p[0], p[3], { 0 }, { 0 } };
+        oc_cpu_line_setup(backend, l, pathIndex);
+        return;
+    }
+    else if(curve.kind == OC_CPU_CUBIC_DEGENERATE_QUADRATIC)
+    {
+        oc_vec2 quadPoint = { 1.5 * p[1].x - 0.5 * p[0].x, 1.5 * p[1].y - 0.5 * p[0].y };
+        oc_vec2 q[4] = { p[0], quadPoint, p[3], { 0 } };
+        oc_cpu_quadratic_setup(backend, q, pathIndex);
+        return;
+    }
+
+    //NOTE: get the roots of B'(s) = 3.c3.s^2 + 2.c2.s + c1
+    f32 rootsX[2];
+    int rootCountX = oc_cpu_quadratic_roots(3 * c[3].x, 2 * c[2].x, c[1].x, rootsX);
+
+    f32 rootsY[2];
+    int rootCountY = oc_cpu_quadratic_roots(3 * c[3].y, 2 * c[2].y, c[1].y, rootsY);
+
+    f32 roots[6];
+    for(int i = 0; i < rootCountX; i++)
+    {
+        roots[i] = rootsX[i];
+    }
+    for(int i = 0; i < rootCountY; i++)
+    {
+        roots[i + rootCountX] = rootsY[i];
+    }
+
+    //NOTE: add double points and inflection points to roots if finite
+    int rootCount = rootCountX + rootCountY;
+    for(int i = 0; i < 2; i++)
+    {
+        if(curve.ts[i].y != 0)
+        {
+            roots[rootCount] = curve.ts[i].x / curve.ts[i].y;
+            rootCount++;
+        }
+    }
+
+    //NOTE: sort roots
+    for(int i = 1; i < rootCount; i++)
+    {
+        f32 tmp = roots[i];
+        int j = i - 1;
+        while(j >= 0 && roots[j] > tmp)
+        {
+            roots[j + 1] = roots[j];
+            j--;
+        }
+        roots[j + 1] = tmp;
+    }
+
+    //NOTE: compute split points
+    f32 splits[8];
+    int splitCount = 0;
+    splits[0] = 0;
+    splitCount++;
+    for(int i = 0; i < rootCount; i++)
+    {
+        if(roots[i] > 0 && roots[i] < 1)
+        {
+            splits[splitCount] = roots[i];
+            splitCount++;
+        }
+    }
+    splits[splitCount] = 1;
+    splitCount++;
+
+    //NOTE: for each monotonic segment, compute hull matrix and sign, and emit segment
+    for(int sliceIndex = 0; sliceIndex < splitCount - 1; sliceIndex++)
+    {
+        f32 s0 = splits[sliceIndex];
+        f32 s1 = splits[sliceIndex + 1];
+        oc_vec2 sp[4];
+        oc_cpu_cubic_slice(p, s0, s1, sp);
+        oc_cpu_cubic_emit(backend, &curve, p, s0, s1, sp, pathIndex);
+    }
+}
+
+void oc_cpu_canvas_segment_setup(oc_cpu_canvas_backend* backend)
+{
+    f32 scale = backend->scale;
+
+    for(u32 eltIndex = 0; eltIndex < backend->eltCount; eltIndex++)
+    {
+        oc_cpu_path_elt* elt = &backend->elements[eltIndex];
+
+        oc_vec2 p[4] = {
+            { elt->p[0].x * scale, elt->p[0].y * scale },
+            { elt->p[1].x * scale, elt->p[1].y * scale },
+            { elt->p[2].x * scale, elt->p[2].y * scale },
+            { elt->p[3].x * scale, elt->p[3].y * scale },
+        };
+
+        switch(elt->kind)
+        {
+            case OC_CPU_LINE:
+                oc_cpu_line_setup(backend, p, elt->pathIndex);
+                break;
+
+            case OC_CPU_QUADRATIC:
+                oc_cpu_quadratic_setup(backend, p, elt->pathIndex);
+                break;
+
+            case OC_CPU_CUBIC:
+                oc_cpu_cubic_setup(backend, p, elt->pathIndex);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------
+// backprop and merge (see backprop.glsl and merge.glsl)
+//------------------------------------------------------------------------
+
+void oc_cpu_canvas_backprop(oc_cpu_canvas_backend* backend)
+{
+    for(u32 pathIndex = 0; pathIndex < backend->pathCount; pathIndex++)
+    {
+        oc_cpu_path* path = &backend->paths[pathIndex];
+        int rowSize = path->area[2];
+        int rowCount = path->area[3];
+
+        for(int rowIndex = 0; rowIndex < rowCount; rowIndex++)
+        {
+            i32 sum = 0;
+            for(int x = rowSize - 1; x >= 0; x--)
+            {
+                oc_cpu_tile_queue* tileQueue = &backend->tileQueues[path->tileQueues + rowIndex * rowSize + x];
+                i32 offset = tileQueue->windingOffset;
+                tileQueue->windingOffset = sum;
+                sum += offset;
+            }
+        }
+    }
+}
+
+static void oc_cpu_canvas_push_tile_entry(oc_cpu_canvas_backend* backend,
+                                          oc_cpu_screen_tile* screenTile,
+                                          oc_cpu_tile_entry_kind kind,
+                                          u32 pathIndex,
+                                          u32 tileQueue,
+                                          bool trim)
+{
+    oc_cpu_canvas_reserve(backend, tileEntries, tileEntryCap, backend->tileEntryCount + 1);
+
+    i32 entryIndex = backend->tileEntryCount;
+    backend->tileEntryCount++;
+
+    backend->tileEntries[entryIndex] = (oc_cpu_tile_entry){
+        .kind = kind,
+        .pathIndex = pathIndex,
+        .tileQueue = tileQueue,
+        .next = -1,
+    };
+
+    if(trim || screenTile->first < 0)
+    {
+        //NOTE: an opaque fill hides everything below it, so we can drop the previous entries
+        screenTile->first = entryIndex;
+    }
+    else
+    {
+        backend->tileEntries[screenTile->last].next = entryIndex;
+    }
+    screenTile->last = entryIndex;
+}
+
+void oc_cpu_canvas_merge(oc_cpu_canvas_backend* backend)
+{
+    //NOTE: build the ordered list of paths touching each screen tile. Unlike the merge shader, which runs per
+    //      screen tile, we walk each path's tiles, so that the cost is proportional to the area of paths.
+    f32 scale = backend->scale;
+    int nTilesX = backend->nTilesX;
+    int nTilesY = backend->nTilesY;
+
+    for(int i = 0; i < nTilesX * nTilesY; i++)
+    {
+        backend->screenTiles[i] = (oc_cpu_screen_tile){ .first = -1, .last = -1 };
+    }
+
+    for(u32 pathIndex = 0; pathIndex < backend->pathCount; pathIndex++)
+    {
+        oc_cpu_path* path = &backend->paths[pathIndex];
+        i32* area = path->area;
+
+        f32 xMax = oc_min(path->box.z, path->clip.z);
+        int tileMax = (int)(xMax * scale) / OC_CPU_TILE_SIZE;
+
+        int xStart = oc_max(0, area[0]);
+        int xEnd = oc_min(oc_min(tileMax, area[0] + area[2] - 1), nTilesX - 1);
+        int yStart = oc_max(0, area[1]);
+        int yEnd = oc_min(area[1] + area[3] - 1, nTilesY - 1);
+
+        oc_vec4 clip = {
+            path->clip.x * scale,
+            path->clip.y * scale,
+            path->clip.z * scale,
+            path->clip.w * scale,
+        };
+
+        bool opaque = (path->color.a == 1) && !path->image;
+
+        for(int y = yStart; y <= yEnd; y++)
+        {
+            for(int x = xStart; x <= xEnd; x++)
+            {
+                u32 tileQueueIndex = path->tileQueues + (y - area[1]) * area[2] + (x - area[0]);
+                oc_cpu_tile_queue* tileQueue = &backend->tileQueues[tileQueueIndex];
+                oc_cpu_screen_tile* screenTile = &backend->screenTiles[y * nTilesX + x];
+
+                oc_vec4 tileBox = {
+                    x * OC_CPU_TILE_SIZE,
+                    y * OC_CPU_TILE_SIZE,
+                    (x + 1) * OC_CPU_TILE_SIZE,
+                    (y + 1) * OC_CPU_TILE_SIZE,
+                };
+
+                if(tileBox.x >= clip.z
+                   || tileBox.z < clip.x
+                   || tileBox.y >= clip.w
+                   || tileBox.w < clip.y)
+                {
+                    //NOTE: tile is fully outside clip, cull it
+                }
+                else if(tileQueue->first == -1)
+                {
+                    if(tileQueue->windingOffset & 1)
+                    {
+                        //NOTE: tile is fully covered
+                        if(tileBox.x >= clip.x
+                           && tileBox.z < clip.z
+                           && tileBox.y >= clip.y
+                           && tileBox.w < clip.w)
+                        {
+                            oc_cpu_canvas_push_tile_entry(backend, screenTile, OC_CPU_OP_FILL, pathIndex, tileQueueIndex, opaque);
+                        }
+                        else
+                        {
+                            oc_cpu_canvas_push_tile_entry(backend, screenTile, OC_CPU_OP_CLIP_FILL, pathIndex, tileQueueIndex, false);
+                        }
+                    }
+                    // else, tile is fully uncovered, skip path
+                }
+                else
+                {
+                    oc_cpu_canvas_push_tile_entry(backend, screenTile, OC_CPU_OP_SEGMENTS, pathIndex, tileQueueIndex, false);
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------
+// raster (see raster.glsl)
+//------------------------------------------------------------------------
+
+static const oc_vec2 OC_CPU_SAMPLE_OFFSETS[OC_CPU_MSAA_COUNT] = {
+    { 0.5 + 1. / 16, 0.5 + 3. / 16 },
+    { 0.5 - 1. / 16, 0.5 - 3. / 16 },
+    { 0.5 + 5. / 16, 0.5 - 1. / 16 },
+    { 0.5 - 3. / 16, 0.5 + 5. / 16 },
+    { 0.5 - 5. / 16, 0.5 - 5. / 16 },
+    { 0.5 - 7. / 16, 0.5 + 1. / 16 },
+    { 0.5 + 3. / 16, 0.5 - 7. / 16 },
+    { 0.5 + 7. / 16, 0.5 + 7. / 16 },
+};
+
+static const oc_vec2 OC_CPU_SRC_SAMPLE_OFFSETS[OC_CPU_SRC_SAMPLE_COUNT] = {
+    { 0.5 - 0.25, 0.5 + 0.25 },
+    { 0.5 + 0.25, 0.5 + 0.25 },
+};
+
+static void oc_cpu_raster_segment(oc_cpu_tile_raster* raster, oc_cpu_segment* seg, bool crossRight, oc_vec2 tileOrigin)
+{
+    //NOTE: side_of_segment() is linear in x along a row, up to the curve test. Precompute the coefficients of
+    //      each test so that the inner loop is branchless.
+    oc_vec2 a, b;
+    oc_cpu_segment_diagonal(seg, &a, &b);
+    oc_vec2 c = seg->hullVertex;
+
+    // ccw(u, v, p) = (v.x - u.x) * (p.y - u.y) - (v.y - u.y) * (p.x - u.x)
+    f32 diagSlope = -(b.y - a.y);
+    f32 hull0Slope = -(c.y - b.y);
+    f32 hull1Slope = -(a.y - c.y);
+
+    i32 diagNeg = (seg->config == OC_CPU_BR || seg->config == OC_CPU_TR);
+    i32 hullNeg = (seg->config == OC_CPU_BL || seg->config == OC_CPU_TL);
+    bool diagonalBelow = (seg->config == OC_CPU_BR || seg->config == OC_CPU_TL);
+
+    //NOTE: curve test is A*k^3 + B*k^2*m + C*l*m + D < 0
+    f32 cA = 0, cB = 0, cC = 0, cD = 0;
+    switch(seg->kind)
+    {
+        case OC_CPU_LINE:
+            cD = 1;
+            break;
+        case OC_CPU_QUADRATIC:
+            cB = 1;
+            cC = -1;
+            break;
+        case OC_CPU_CUBIC:
+            cA = seg->sign;
+            cC = -seg->sign;
+            break;
+    }
+    f32(*m)[3] = seg->implicitMatrix;
+
+    i32 inc = seg->windingIncrement;
+    f32 boxX0 = seg->box.x;
+    f32 boxX1 = seg->box.z;
+
+    for(int sampleIndex = 0; sampleIndex < OC_CPU_MSAA_COUNT; sampleIndex++)
+    {
+        oc_vec2 offset = OC_CPU_SAMPLE_OFFSETS[sampleIndex];
+        f32 x0 = tileOrigin.x + offset.x;
+
+        for(int row = 0; row < OC_CPU_TILE_SIZE; row++)
+        {
+            f32 y = tileOrigin.y + row + offset.y;
+            i32* winding = &raster->winding[sampleIndex][row * OC_CPU_TILE_SIZE];
+
+            //NOTE: segments crossing the tile's right side contribute to the whole row
+            i32 rowInc = 0;
+            if(crossRight)
+            {
+                if(diagonalBelow && y > seg->box.w)
+                {
+                    rowInc = inc;
+                }
+                else if(!diagonalBelow && y > seg->box.y)
+                {
+                    rowInc = -inc;
+                }
+            }
+
+            if(y > seg->box.y && y <= seg->box.w)
+            {
+                f32 diagOffset = (b.x - a.x) * (y - a.y) + (b.y - a.y) * a.x;
+                f32 hull0Offset = (c.x - b.x) * (y - b.y) + (c.y - b.y) * b.x;
+                f32 hull1Offset = (a.x - c.x) * (y - c.y) + (a.y - c.y) * c.x;
+
+                f32 kOffset = m[0][1] * y + m[0][2];
+                f32 lOffset = m[1][1] * y + m[1][2];
+                f32 mOffset = m[2][1] * y + m[2][2];
+
+                for(int i = 0; i < OC_CPU_TILE_SIZE; i++)
+                {
+                    f32 x = x0 + i;
+
+                    f32 diag = diagSlope * x + diagOffset;
+                    f32 hull0 = hull0Slope * x + hull0Offset;
+                    f32 hull1 = hull1Slope * x + hull1Offset;
+
+                    f32 k = m[0][0] * x + kOffset;
+                    f32 l = m[1][0] * x + lOffset;
+                    f32 n = m[2][0] * x + mOffset;
+                    f32 curve = cA * k * k * k + cB * k * k * n + cC * l * n + cD;
+
+                    i32 left = (x <= boxX0);
+                    i32 inside = (x > boxX0) & (x <= boxX1);
+                    i32 outsideHull = (hull0 < 0) | (hull1 < 0);
+                    i32 insideNeg = (diag < 0) ? diagNeg : (outsideHull ? hullNeg : (curve < 0));
+                    i32 neg = left | (inside & insideNeg);
+
+                    winding[i] += (neg ? inc : 0) + rowInc;
+                }
+            }
+            else if(rowInc)
+            {
+                for(int i = 0; i < OC_CPU_TILE_SIZE; i++)
+                {
+                    winding[i] += rowInc;
+                }
+            }
+        }
+    }
+}
+
+static void oc_cpu_raster_coverage(oc_cpu_tile_raster* raster,
+                                   oc_cpu_path* path,
+                                   oc_cpu_tile_entry_kind kind,
+                                   oc_vec4 clip,
+                                   oc_vec2 tileOrigin)
+{
+    for(int i = 0; i < OC_CPU_TILE_PIXEL_COUNT; i++)
+    {
+        raster->coverage[i] = 0;
+    }
+
+    bool nonZero = (path->cmd == OC_CMD_STROKE);
+
+    for(int sampleIndex = 0; sampleIndex < OC_CPU_MSAA_COUNT; sampleIndex++)
+    {
+        oc_vec2 offset = OC_CPU_SAMPLE_OFFSETS[sampleIndex];
+        f32 x0 = tileOrigin.x + offset.x;
+
+        for(int row = 0; row < OC_CPU_TILE_SIZE; row++)
+        {
+            f32 y = tileOrigin.y + row + offset.y;
+            if(y < clip.y || y >= clip.w)
+            {
+                continue;
+            }
+
+            i32* winding = &raster->winding[sampleIndex][row * OC_CPU_TILE_SIZE];
+            f32* coverage = &raster->coverage[row * OC_CPU_TILE_SIZE];
+
+            for(int i = 0; i < OC_CPU_TILE_SIZE; i++)
+            {
+                f32 x = x0 + i;
+                i32 inClip = (x >= clip.x) & (x < clip.z);
+                i32 filled = (kind == OC_CPU_OP_CLIP_FILL)
+                           | (nonZero ? (winding[i] != 0) : (winding[i] & 1));
+
+                coverage[i] += (inClip & filled) ? 1 : 0;
+            }
+        }
+    }
+
+    for(int i = 0; i < OC_CPU_TILE_PIXEL_COUNT; i++)
+    {
+        raster->coverage[i] *= 1. / OC_CPU_MSAA_COUNT;
+    }
+}
+
+static oc_color oc_cpu_image_sample(oc_cpu_image* image, oc_vec2 uv)
+{
+    //NOTE: bilinear filtering, clamped to the edges of the image
+    int w = (int)image->interface.size.x;
+    int h = (int)image->interface.size.y;
+
+    f32 x = uv.x * w - 0.5;
+    f32 y = uv.y * h - 0.5;
+    f32 fx0 = floorf(x);
+    f32 fy0 = floorf(y);
+    f32 tx = x - fx0;
+    f32 ty = y - fy0;
+
+    int x0 = oc_clamp((int)fx0, 0, w - 1);
+    int x1 = oc_clamp((int)fx0 + 1, 0, w - 1);
+    int y0 = oc_clamp((int)fy0, 0, h - 1);
+    int y1 = oc_clamp((int)fy0 + 1, 0, h - 1);
+
+    u8* p00 = image->pixels + 4 * (y0 * w + x0);
+    u8* p10 = image->pixels + 4 * (y0 * w + x1);
+    u8* p01 = image->pixels + 4 * (y1 * w + x0);
+    u8* p11 = image->pixels + 4 * (y1 * w + x1);
+
+    oc_color color;
+    for(int i = 0; i < 4; i++)
+    {
+        f32 top = p00[i] * (1 - tx) + p10[i] * tx;
+        f32 bottom = p01[i] * (1 - tx) + p11[i] * tx;
+        color.c[i] = (top * (1 - ty) + bottom * ty) * (1. / 255);
+    }
+    return (color);
+}
+
+static void oc_cpu_raster_blend(oc_cpu_tile_raster* raster, oc_cpu_path* path, oc_vec2 tileOrigin)
+{
+    oc_color pathColor = path->color;
+    pathColor.r *= pathColor.a;
+    pathColor.g *= pathColor.a;
+    pathColor.b *= pathColor.a;
+
+    if(path->image)
+    {
+        for(int row = 0; row < OC_CPU_TILE_SIZE; row++)
+        {
+            for(int col = 0; col < OC_CPU_TILE_SIZE; col++)
+            {
+                int i = row * OC_CPU_TILE_SIZE + col;
+                f32 cov = raster->coverage[i];
+                if(cov == 0)
+                {
+                    continue;
+                }
+
+                oc_color texColor = { 0 };
+                for(int sampleIndex = 0; sampleIndex < OC_CPU_SRC_SAMPLE_COUNT; sampleIndex++)
+                {
+                    oc_vec2 sampleCoord = {
+                        tileOrigin.x + col + OC_CPU_SRC_SAMPLE_OFFSETS[sampleIndex].x,
+                        tileOrigin.y + row + OC_CPU_SRC_SAMPLE_OFFSETS[sampleIndex].y,
+                    };
+                    oc_vec2 uv = oc_mat2x3_mul(path->uvTransform, sampleCoord);
+                    uv.x = oc_clamp(uv.x, path->uvClamp.x, path->uvClamp.z);
+                    uv.y = oc_clamp(uv.y, path->uvClamp.y, path->uvClamp.w);
+                    oc_color sample = oc_cpu_image_sample(path->image, uv);
+                    for(int c = 0; c < 4; c++)
+                    {
+                        texColor.c[c] += sample.c[c];
+                    }
+                }
+                for(int c = 0; c < 4; c++)
+                {
+                    texColor.c[c] *= 1. / OC_CPU_SRC_SAMPLE_COUNT;
+                }
+                texColor.r *= texColor.a;
+                texColor.g *= texColor.a;
+                texColor.b *= texColor.a;
+
+                f32 nextAlpha = pathColor.a * texColor.a;
+                for(int c = 0; c < 4; c++)
+                {
+                    f32 next = pathColor.c[c] * texColor.c[c];
+                    raster->color[c][i] = raster->color[c][i] * (1 - cov * nextAlpha) + cov * next;
+                }
+            }
+        }
+    }
+    else
+    {
+        for(int c = 0; c < 4; c++)
+        {
+            f32* color = raster->color[c];
+            f32 next = pathColor.c[c];
+            for(int i = 0; i < OC_CPU_TILE_PIXEL_COUNT; i++)
+            {
+                f32 cov = raster->coverage[i];
+                color[i] = color[i] * (1 - cov * pathColor.a) + cov * next;
+            }
+        }
+    }
+}
+
+//NOTE: the path fields that the raster pass reads, without padding, so that they can be hashed
+typedef struct oc_cpu_tile_entry_key
+{
+    u32 kind;
+    u32 cmd;
+    i32 windingOffset;
+    u32 pad;
+    oc_color color;
+    oc_vec4 clip;
+    oc_mat2x3 uvTransform;
+    oc_vec4 uvClamp;
+    u64 image;
+    u64 imageVersion;
+
+} oc_cpu_tile_entry_key;
+
+static u64 oc_cpu_canvas_tile_hash(oc_cpu_canvas_backend* backend, u32 tileIndex)
+{
+    struct
+    {
+        oc_color clearColor;
+        f32 scale;
+    } frameKey = { backend->clearColor, backend->scale };
+
+    u64 hash = oc_hash_xx64_string(oc_str8_from_buffer(sizeof(frameKey), (char*)&frameKey));
+
+    for(i32 entryIndex = backend->screenTiles[tileIndex].first;
+        entryIndex >= 0;
+        entryIndex = backend->tileEntries[entryIndex].next)
+    {
+        oc_cpu_tile_entry* entry = &backend->tileEntries[entryIndex];
+        oc_cpu_path* path = &backend->paths[entry->pathIndex];
+        oc_cpu_tile_queue* tileQueue = &backend->tileQueues[entry->tileQueue];
+
+        oc_cpu_tile_entry_key key = {
+            .kind = entry->kind,
+            .cmd = path->cmd,
+            .windingOffset = (entry->kind == OC_CPU_OP_SEGMENTS) ? tileQueue->windingOffset : 0,
+            .color = path->color,
+            .clip = path->clip,
+        };
+        if(path->image)
+        {
+            key.uvTransform = path->uvTransform;
+            key.uvClamp = path->uvClamp;
+            key.image = (u64)(uintptr_t)path->image;
+            key.imageVersion = path->image->version;
+        }
+        hash = oc_hash_xx64_string_seed(oc_str8_from_buffer(sizeof(key), (char*)&key), hash);
+
+        if(entry->kind == OC_CPU_OP_SEGMENTS)
+        {
+            for(i32 opIndex = tileQueue->first; opIndex >= 0; opIndex = backend->tileOps[opIndex].next)
+            {
+                oc_cpu_tile_op* op = &backend->tileOps[opIndex];
+
+                //NOTE: the path index of a segment depends on the paths drawn before it, but doesn't affect the raster
+                oc_cpu_segment seg = backend->segments[op->segIndex];
+                seg.pathIndex = op->crossRight ? 1 : 0;
+
+                hash = oc_hash_xx64_string_seed(oc_str8_from_buffer(sizeof(seg), (char*)&seg), hash);
+            }
+        }
+    }
+    return (hash);
+}
+
+static void oc_cpu_canvas_raster_tile(oc_cpu_canvas_backend* backend, oc_cpu_tile_raster* raster, u32 tileIndex)
+{
+    int tileX = tileIndex % backend->nTilesX;
+    int tileY = tileIndex / backend->nTilesX;
+    oc_vec2 tileOrigin = { tileX * OC_CPU_TILE_SIZE, tileY * OC_CPU_TILE_SIZE };
+    f32 scale = backend->scale;
+
+    for(int c = 0; c < 4; c++)
+    {
+        for(int i = 0; i < OC_CPU_TILE_PIXEL_COUNT; i++)
+        {
+            raster->color[c][i] = backend->clearColor.c[c];
+        }
+    }
+
+    for(i32 entryIndex = backend->screenTiles[tileIndex].first;
+        entryIndex >= 0;
+        entryIndex = backend->tileEntries[entryIndex].next)
+    {
+        oc_cpu_tile_entry* entry = &backend->tileEntries[entryIndex];
+        oc_cpu_path* path = &backend->paths[entry->pathIndex];
+
+        if(entry->kind == OC_CPU_OP_FILL)
+        {
+            for(int i = 0; i < OC_CPU_TILE_PIXEL_COUNT; i++)
+            {
+                raster->coverage[i] = 1;
+            }
+        }
+        else
+        {
+            oc_cpu_tile_queue* tileQueue = &backend->tileQueues[entry->tileQueue];
+
+            if(entry->kind == OC_CPU_OP_SEGMENTS)
+            {
+                for(int sampleIndex = 0; sampleIndex < OC_CPU_MSAA_COUNT; sampleIndex++)
+                {
+                    for(int i = 0; i < OC_CPU_TILE_PIXEL_COUNT; i++)
+                    {
+                        raster->winding[sampleIndex][i] = tileQueue->windingOffset;
+                    }
+                }
+
+                for(i32 opIndex = tileQueue->first; opIndex >= 0; opIndex = backend->tileOps[opIndex].next)
+                {
+                    oc_cpu_tile_op* op = &backend->tileOps[opIndex];
+                    oc_cpu_raster_segment(raster, &backend->segments[op->segIndex], op->crossRight, tileOrigin);
+                }
+            }
+
+            oc_vec4 clip = {
+                path->clip.x * scale,
+                path->clip.y * scale,
+                path->clip.z * scale,
+                path->clip.w * scale,
+            };
+            oc_cpu_raster_coverage(raster, path, entry->kind, clip, tileOrigin);
+        }
+
+        oc_cpu_raster_blend(raster, path, tileOrigin);
+    }
+
+    //NOTE: store tile
+    int width = (int)backend->frameSize.x;
+    int height = (int)backend->frameSize.y;
+    int rowCount = oc_min(OC_CPU_TILE_SIZE, height - (int)tileOrigin.y);
+    int colCount = oc_min(OC_CPU_TILE_SIZE, width - (int)tileOrigin.x);
+
+    for(int row = 0; row < rowCount; row++)
+    {
+        u8* dst = backend->pixels + 4 * ((u64)(tileOrigin.y + row) * width + (u64)tileOrigin.x);
+        for(int col = 0; col < colCount; col++)
+        {
+            int i = row * OC_CPU_TILE_SIZE + col;
+            for(int c = 0; c < 4; c++)
+            {
+                dst[4 * col + c] = (u8)(oc_clamp(raster->color[c][i], 0, 1) * 255 + 0.5);
+            }
+        }
+    }
+}
+
+static void oc_cpu_canvas_raster_job(void* user, u32 workerIndex, u32 tileIndex)
+{
+    oc_cpu_canvas_backend* backend = (oc_cpu_canvas_backend*)user;
+
+    u64 hash = oc_cpu_canvas_tile_hash(backend, tileIndex);
+    if(!backend->tileHashesValid || hash != backend->tileHashes[tileIndex])
+    {
+        backend->tileHashes[tileIndex] = hash;
+        oc_cpu_canvas_raster_tile(backend, backend->rasters[workerIndex], tileIndex);
+        atomic_fetch_add(&backend->dirtyTileCount, 1);
+    }
+}
+
+//------------------------------------------------------------------------
+// render
+//------------------------------------------------------------------------
+
+void oc_cpu_canvas_resize(oc_cpu_canvas_backend* backend, oc_vec2 size)
+{
+    backend->frameSize = size;
+    backend->nTilesX = ((int)size.x + OC_CPU_TILE_SIZE - 1) / OC_CPU_TILE_SIZE;
+    backend->nTilesY = ((int)size.y + OC_CPU_TILE_SIZE - 1) / OC_CPU_TILE_SIZE;
+
+    free(backend->pixels);
+    backend->pixels = malloc((u64)size.x * (u64)size.y * 4);
+    if(!backend->pixels)
+    {
+        OC_ABORT("couldn't allocate canvas framebuffer");
+    }
+
+    oc_cpu_canvas_reserve(backend, screenTiles, screenTileCap, backend->nTilesX * backend->nTilesY);
+
+    //NOTE: the contents of the new framebuffer are undefined, so the next frame redraws all tiles
+    free(backend->tileHashes);
+    backend->tileHashes = malloc(backend->nTilesX * backend->nTilesY * sizeof(u64));
+    if(!backend->tileHashes)
+    {
+        OC_ABORT("couldn't allocate canvas tile hashes");
+    }
+    backend->tileHashesValid = false;
+}
+
+void oc_cpu_canvas_render(oc_canvas_backend* interface,
+                          oc_color clearColor,
+                          u32 primitiveCount,
+                          oc_primitive* primitives,
+                          u32 eltCount,
+                          oc_path_elt* pathElements)
+{
+    oc_cpu_canvas_backend* backend = (oc_cpu_canvas_backend*)interface;
+
+    oc_surface_data* surface = backend->surface;
+    oc_vec2 surfaceSize = surface->getSize(surface);
+    oc_vec2 contentsScaling = surface->contentsScaling(surface);
+    //TODO support scaling in both axes?
+    f32 scale = contentsScaling.x;
+
+    oc_vec2 viewportSize = { floorf(surfaceSize.x * scale), floorf(surfaceSize.y * scale) };
+    if(viewportSize.x != backend->frameSize.x || viewportSize.y != backend->frameSize.y)
+    {
+        oc_cpu_canvas_resize(backend, viewportSize);
+    }
+
+    backend->scale = scale;
+    backend->clearColor = clearColor;
+    backend->pathCount = 0;
+    backend->eltCount = 0;
+    backend->segmentCount = 0;
+    backend->tileQueueCount = 0;
+    backend->tileOpCount = 0;
+    backend->tileEntryCount = 0;
+
+    //NOTE: encode paths. Unlike the GPU backends, we can reach any image from the raster pass, so there's no
+    //      need to split primitives in batches.
+    oc_vec2 currentPos = { 0 };
+
+    for(int primitiveIndex = 0; primitiveIndex < primitiveCount; primitiveIndex++)
+    {
+        oc_primitive* primitive = &primitives[primitiveIndex];
+
+        if(primitive->path.count)
+        {
+            backend->primitive = primitive;
+            backend->pathScreenExtents = (oc_vec4){ FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+            backend->pathUserExtents = (oc_vec4){ FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+            if(primitive->cmd == OC_CMD_STROKE)
+            {
+                oc_cpu_encode_stroke(backend, pathElements + primitive->path.startIndex, &primitive->path);
+            }
+            else
+            {
+                for(int eltIndex = 0;
+                    (eltIndex < primitive->path.count) && (primitive->path.startIndex + eltIndex < eltCount);
+                    eltIndex++)
+                {
+                    oc_path_elt* elt = &pathElements[primitive->path.startIndex + eltIndex];
+
+                    if(elt->type != OC_PATH_MOVE)
+                    {
+                        oc_vec2 p[4] = { currentPos, elt->p[0], elt->p[1], elt->p[2] };
+                        oc_cpu_canvas_encode_element(backend, elt->type, p);
+                    }
+                    switch(elt->type)
+                    {
+                        case OC_PATH_MOVE:
+                            currentPos = elt->p[0];
+                            break;
+
+                        case OC_PATH_LINE:
+                            currentPos = elt->p[0];
+                            break;
+
+                        case OC_PATH_QUADRATIC:
+                            currentPos = elt->p[1];
+                            break;
+
+                        case OC_PATH_CUBIC:
+                            currentPos = elt->p[2];
+                            break;
+                    }
+                }
+            }
+            //NOTE: push path
+            oc_cpu_canvas_encode_path(backend, primitive, scale);
+        }
+    }
+
+    oc_cpu_canvas_path_setup(backend);
+    oc_cpu_canvas_segment_setup(backend);
+    oc_cpu_canvas_backprop(backend);
+    oc_cpu_canvas_merge(backend);
+
+    u32 tileCount = backend->nTilesX * backend->nTilesY;
+    backend->dirtyTileCount = 0;
+    oc_canvas_workers_run(backend->workers, tileCount, oc_cpu_canvas_raster_job, backend);
+    backend->tileHashesValid = true;
+
+    backend->interface.stats.tileCount = tileCount;
+    backend->interface.stats.dirtyTileCount = backend->dirtyTileCount;
+}
+
+u8* oc_cpu_canvas_read_pixels(oc_canvas_backend* interface, oc_arena* arena, oc_vec2* size)
+{
+    oc_cpu_canvas_backend* backend = (oc_cpu_canvas_backend*)interface;
+
+    u64 byteCount = (u64)backend->frameSize.x * (u64)backend->frameSize.y * 4;
+    u8* pixels = oc_arena_push(arena, byteCount);
+    *size = backend->frameSize;
+
+    if(pixels && byteCount)
+    {
+        memcpy(pixels, backend->pixels, byteCount);
+    }
+    return (pixels);
+}
+
+//--------------------------------------------------------------------
+// Image API
+//--------------------------------------------------------------------
+oc_image_data* oc_cpu_canvas_image_create(oc_canvas_backend* interface, oc_vec2 size)
+{
+    oc_cpu_image* image = oc_malloc_type(oc_cpu_image);
+    if(image)
+    {
+        memset(image, 0, sizeof(oc_cpu_image));
+        image->interface.size = size;
+        image->pixels = calloc((u64)size.x * (u64)size.y, 4);
+        if(!image->pixels)
+        {
+            free(image);
+            image = 0;
+        }
+    }
+    return ((oc_image_data*)image);
+}
+
+void oc_cpu_canvas_image_destroy(oc_canvas_backend* interface, oc_image_data* imageInterface)
+{
+    oc_cpu_image* image = (oc_cpu_image*)imageInterface;
+    free(image->pixels);
+    free(image);
+}
+
+void oc_cpu_canvas_image_upload_region(oc_canvas_backend* interface,
+                                       oc_image_data* imageInterface,
+                                       oc_rect region,
+                                       u8* pixels)
+{
+    oc_cpu_image* image = (oc_cpu_image*)imageInterface;
+
+    int imageWidth = (int)image->interface.size.x;
+    int imageHeight = (int)image->interface.size.y;
+    int x0 = (int)region.x;
+    int y0 = (int)region.y;
+    int w = (int)region.w;
+    int h = (int)region.h;
+
+    if(x0 < 0 || y0 < 0 || x0 + w > imageWidth || y0 + h > imageHeight)
+    {
+        oc_log_error("image region is out of bounds\n");
+        return;
+    }
+
+    for(int row = 0; row < h; row++)
+    {
+        memcpy(image->pixels + 4 * ((y0 + row) * imageWidth + x0),
+               pixels + 4 * row * w,
+               4 * w);
+    }
+    oc_cpuImageVersion++;
+    image->version = oc_cpuImageVersion;
+}
+
+//--------------------------------------------------------------------
+// Canvas setup / destroy
+//--------------------------------------------------------------------
+
+void oc_cpu_canvas_destroy(oc_canvas_backend* interface)
+{
+    oc_cpu_canvas_backend* backend = (oc_cpu_canvas_backend*)interface;
+
+    for(int i = 0; i < oc_array_size(backend->rasters); i++)
+    {
+        free(backend->rasters[i]);
+    }
+
+    free(backend->pixels);
+    free(backend->paths);
+    free(backend->elements);
+    free(backend->segments);
+    free(backend->tileQueues);
+    free(backend->tileOps);
+    free(backend->tileEntries);
+    free(backend->screenTiles);
+    free(backend->tileHashes);
+    free(backend);
+}
+
+oc_canvas_backend* oc_cpu_canvas_backend_create(oc_surface_data* surface)
+{
+    oc_cpu_canvas_backend* backend = oc_malloc_type(oc_cpu_canvas_backend);
+    if(backend)
+    {
+        memset(backend, 0, sizeof(oc_cpu_canvas_backend));
+        backend->surface = surface;
+
+        backend->interface.destroy = oc_cpu_canvas_destroy;
+        backend->interface.render = oc_cpu_canvas_render;
+        backend->interface.readPixels = oc_cpu_canvas_read_pixels;
+        backend->interface.imageCreate = oc_cpu_canvas_image_create;
+        backend->interface.imageDestroy = oc_cpu_canvas_image_destroy;
+        backend->interface.imageUploadRegion = oc_cpu_canvas_image_upload_region;
+
+        //NOTE: tiles are rasterized by the shared canvas workers, and by the thread calling render()
+        backend->workers = oc_graphics_canvas_workers();
+
+        u32 workerCount = oc_canvas_workers_count(backend->workers);
+        for(u32 i = 0; i < workerCount; i++)
+        {
+            backend->rasters[i] = oc_malloc_type(oc_cpu_tile_raster);
+            if(!backend->rasters[i])
+            {
+                oc_cpu_canvas_destroy((oc_canvas_backend*)backend);
+                return (0);
+            }
+        }
+    }
+    return ((oc_canvas_backend*)backend);
+}
@@ -5,6 +5,7 @@
 *  See LICENSE.txt for licensing information
 *
 **************************************************************************/
+#include "canvas_workers.h"
 #include "gl_api.h"
 #include "glsl_shaders.h"
 #include "graphics_surface.h"
@@ -30,6 +31,7 @@ typedef struct oc_gl_path
     oc_vec4 color;
     oc_vec4 box;
     oc_vec4 clip;
+    oc_vec4 uvClamp;
     oc_gl_cmd cmd;
     int textureID;
     u8 pad[8];
@@ -135,6 +137,127 @@ typedef struct oc_gl_mapped_buffer
     char* contents;
 } oc_gl_mapped_buffer;
 
+//NOTE: paths are encoded in parallel by splitting the primitives of each batch into chunks. Each chunk is encoded
+//      by a worker into its own scratch buffers, then copied into its region of the mapped input buffers, which is
+//      found by a prefix sum of the chunks' path and element counts. Path indices of elements are relative to the
+//      chunk while encoding, and are fixed up during the copy to be relative to the start of the batch.
+enum
+{
+    OC_GL_ENCODING_CHUNK_SIZE = 256, // primitives per chunk
+};
+
+typedef struct oc_gl_encoding_context
+{
+    u32 pathCount;
+    u32 pathCap;
+    oc_gl_path* paths;
+
+    u32 eltCount;
+    u32 eltCap;
+    oc_gl_path_elt* elements;
+
+    oc_primitive* primitive;
+    oc_mat2x3 transform;
+    oc_vec4 pathScreenExtents;
+    oc_vec4 pathUserExtents;
+    int currentImageIndex;
+
+    int maxTileQueueCount;
+    int maxSegmentCount;
+
+} oc_gl_encoding_context;
+
+typedef struct oc_gl_encoding_chunk
+{
+    oc_gl_encoding_context context;
+
+    u32 batchIndex;
+    u32 primitiveStart;
+    u32 primitiveEnd;
+
+    // region of the input buffers, computed after encoding
+    u32 pathOffset;
+    u32 eltOffset;
+
+} oc_gl_encoding_chunk;
+
+typedef struct oc_gl_encoding_batch
+{
+    oc_image images[OC_GL_MAX_IMAGES_PER_BATCH];
+    u32 primitiveStart;
+    u32 primitiveEnd;
+
+    u32 pathStart;
+    u32 pathCount;
+    u32 eltStart;
+    u32 eltCount;
+    int maxTileQueueCount;
+    int maxSegmentCount;
+
+} oc_gl_encoding_batch;
+
+//NOTE: strokes are expensive to encode (their hull is offset and flattened on the CPU), and most of them are redrawn
+//      unchanged from one frame to the next, so we keep their encoded elements in a cache across frames. Entries are
+//      keyed by a hash of the path elements, the stroke attributes and the linear part of the transform, and store
+//      elements encoded without translation, so that moving a path doesn't invalidate its entry. Entries also keep
+//      their key and source elements, which are compared on lookup, so that a hash collision can't draw the wrong path.
+//      During encoding, workers only read the cache. Hits and new entries are recorded per primitive, and are
+//      applied to the cache serially once all chunks are encoded.
+enum
+{
+    OC_GL_PATH_CACHE_BUCKET_COUNT = 1024,
+    OC_GL_PATH_CACHE_BUDGET = 8 << 20, // bytes
+};
+
+typedef struct oc_gl_path_cache_key
+{
+    f32 linear[4];
+    f32 width;
+    f32 tolerance;
+    f32 maxJointExcursion;
+    oc_joint_type joint;
+    oc_cap_type cap;
+    oc_vec2 startPoint;
+    u32 count;
+
+} oc_gl_path_cache_key;
+
+typedef struct oc_gl_path_cache_entry
+{
+    oc_list_elt bucketElt;
+    oc_list_elt lruElt;
+
+    u64 hash;
+    oc_gl_path_cache_key key;
+    oc_path_elt* srcElements; // key.count source elements, stored after the encoded elements
+    u32 eltCount;
+    int maxSegmentCount;
+    oc_vec4 screenExtents;
+    oc_vec4 userExtents;
+
+    oc_gl_path_elt elements[];
+
+} oc_gl_path_cache_entry;
+
+typedef struct oc_gl_path_cache
+{
+    oc_list buckets[OC_GL_PATH_CACHE_BUCKET_COUNT];
+    oc_list lru;
+    u64 size;
+    u64 budget;
+
+    u64 hitCount;
+    u64 missCount;
+
+} oc_gl_path_cache;
+
+typedef struct oc_gl_path_cache_lookup
+{
+    oc_gl_path_cache_entry* entry; // entry that was hit, or new entry to insert
+    bool hit;
+
+} oc_gl_path_cache_lookup;
+
 typedef struct oc_gl_canvas_backend
 {
     oc_canvas_backend interface;
@@ -173,21 +296,33 @@ typedef struct oc_gl_canvas_backend
     GLuint rasterDispatchBuffer;
     GLuint dummyVertexBuffer;
 
-    //encoding context
+    //current batch
     int pathCount;
     int eltCount;
 
     int pathBatchStart;
     int eltBatchStart;
 
-    oc_primitive* primitive;
-    oc_vec4 pathScreenExtents;
-    oc_vec4 pathUserExtents;
-
     int maxTileQueueCount;
     int maxSegmentCount;
 
-    int currentImageIndex;
+    //encoding
+    oc_canvas_workers* workers;
+
+    u32 batchCount;
+    u32 batchCap;
+    oc_gl_encoding_batch* batches;
+
+    u32 chunkCount;
+    u32 chunkCap;
+    oc_gl_encoding_chunk* chunks;
+
+    u32 primitiveCap;
+    i32* primitiveImageIndices;
+    oc_gl_path_cache_lookup* primitiveCacheLookups;
+
+    oc_gl_path_cache pathCache;
+
 } oc_gl_canvas_backend;
 
 static void oc_update_path_extents(oc_vec4* extents, oc_vec2 p)
@@ -221,49 +356,45 @@ void oc_gl_grow_input_buffer(oc_gl_mapped_buffer* buffer, int copyStart, int cop
     *buffer = newBuffer;
 }
 
-void oc_gl_canvas_encode_element(oc_gl_canvas_backend* backend, oc_path_elt_type kind, oc_vec2* p)
+void oc_gl_encoding_context_reserve_elements(oc_gl_encoding_context* context, u32 count)
 {
-    int bufferIndex = backend->bufferIndex;
-    int bufferCap = backend->elementBuffer[bufferIndex].size / sizeof(oc_gl_path_elt);
-    if(backend->eltCount >= bufferCap)
+    if(context->eltCount + count > context->eltCap)
     {
-        int newBufferCap = (int)(bufferCap * 1.5);
-        while(backend->eltCount > newBufferCap)
+        context->eltCap = oc_max(1024, (u32)(context->eltCap * 1.5));
+        context->eltCap = oc_max(context->eltCap, context->eltCount + count);
+        context->elements = realloc(context->elements, context->eltCap * sizeof(oc_gl_path_elt));
+        if(!context->elements)
         {
-            newBufferCap = (int)(newBufferCap * 1.5);
+            OC_ABORT("couldn't allocate path elements scratch buffer");
         }
-        int newBufferSize = newBufferCap * sizeof(oc_gl_path_elt);
-
-        oc_log_info("growing element buffer to %i elements\n", newBufferCap);
-
-        oc_gl_grow_input_buffer(&backend->elementBuffer[bufferIndex],
-                                backend->eltBatchStart * sizeof(oc_gl_path_elt),
-                                backend->eltCount * sizeof(oc_gl_path_elt),
-                                newBufferSize);
     }
+}
+
+void oc_gl_canvas_encode_element(oc_gl_encoding_context* context, oc_path_elt_type kind, oc_vec2* p)
+{
+    oc_gl_encoding_context_reserve_elements(context, 1);
 
-    oc_gl_path_elt* elementData = (oc_gl_path_elt*)backend->elementBuffer[bufferIndex].contents;
-    oc_gl_path_elt* elt = &elementData[backend->eltCount];
-    backend->eltCount++;
+    oc_gl_path_elt* elt = &context->elements[context->eltCount];
+    context->eltCount++;
 
-    elt->pathIndex = backend->pathCount - backend->pathBatchStart;
+    *elt = (oc_gl_path_elt){ .pathIndex = context->pathCount };
     int count = 0;
     switch(kind)
     {
         case OC_PATH_LINE:
-            backend->maxSegmentCount += 1;
+            context->maxSegmentCount += 1;
             elt->kind = OC_GL_LINE;
             count = 2;
             break;
 
         case OC_PATH_QUADRATIC:
-            backend->maxSegmentCount += 3;
+            context->maxSegmentCount += 3;
             elt->kind = OC_GL_QUADRATIC;
             count = 3;
             break;
 
         case OC_PATH_CUBIC:
-            backend->maxSegmentCount += 7;
+            context->maxSegmentCount += 7;
             elt->kind = OC_GL_CUBIC;
             count = 4;
             break;
@@ -274,47 +405,38 @@ void oc_gl_canvas_encode_element(oc_gl_canvas_backend* backend, oc_path_elt_type
 
     for(int i = 0; i < count; i++)
     {
-        oc_update_path_extents(&backend->pathUserExtents, p[i]);
+        oc_update_path_extents(&context->pathUserExtents, p[i]);
 
-        oc_vec2 screenP = oc_mat2x3_mul(backend->primitive->attributes.transform, p[i]);
+        oc_vec2 screenP = oc_mat2x3_mul(context->transform, p[i]);
         elt->p[i] = (oc_vec2){ screenP.x, screenP.y };
 
-        oc_update_path_extents(&backend->pathScreenExtents, screenP);
+        oc_update_path_extents(&context->pathScreenExtents, screenP);
     }
 }
 
-void oc_gl_canvas_encode_path(oc_gl_canvas_backend* backend, oc_primitive* primitive, f32 scale)
+void oc_gl_canvas_encode_path(oc_gl_encoding_context* context, oc_primitive* primitive, f32 scale)
 {
-    int bufferIndex = backend->bufferIndex;
-    int bufferCap = backend->pathBuffer[bufferIndex].size / sizeof(oc_gl_path);
-    if(backend->pathCount >= bufferCap)
+    if(context->pathCount >= context->pathCap)
     {
-        int newBufferCap = (int)(bufferCap * 1.5);
-        while(backend->pathCount > newBufferCap)
+        context->pathCap = oc_max(256, (u32)(context->pathCap * 1.5));
+        context->paths = realloc(context->paths, context->pathCap * sizeof(oc_gl_path));
+        if(!context->paths)
         {
-            newBufferCap = (int)(newBufferCap * 1.5);
+            OC_ABORT("couldn't allocate paths scratch buffer");
         }
-        int newBufferSize = newBufferCap * sizeof(oc_gl_path);
-
-        oc_log_info("growing path buffer to %i elements\n", newBufferCap);
-
-        oc_gl_grow_input_buffer(&backend->pathBuffer[bufferIndex],
-                                backend->pathBatchStart * sizeof(oc_gl_path),
-                                backend->pathCount * sizeof(oc_gl_path),
-                                newBufferSize);
     }
 
-    oc_gl_path* pathData = (oc_gl_path*)backend->pathBuffer[backend->bufferIndex].contents;
-    oc_gl_path* path = &pathData[backend->pathCount];
-    backend->pathCount++;
+    oc_gl_path* path = &context->paths[context->pathCount];
+    context->pathCount++;
 
+    *path = (oc_gl_path){ 0 };
     path->cmd = (oc_gl_cmd)primitive->cmd;
 
     path->box = (oc_vec4){
-        backend->pathScreenExtents.x,
-        backend->pathScreenExtents.y,
-        backend->pathScreenExtents.z,
-        backend->pathScreenExtents.w
+        context->pathScreenExtents.x,
+        context->pathScreenExtents.y,
+        context->pathScreenExtents.z,
+        context->pathScreenExtents.w
     };
 
     path->clip = (oc_vec4){
@@ -334,10 +456,10 @@ void oc_gl_canvas_encode_path(oc_gl_canvas_backend* backend, oc_primitive* primi
     oc_rect srcRegion = primitive->attributes.srcRegion;
 
     oc_rect destRegion = {
-        backend->pathUserExtents.x,
-        backend->pathUserExtents.y,
-        backend->pathUserExtents.z - backend->pathUserExtents.x,
-        backend->pathUserExtents.w - backend->pathUserExtents.y
+        context->pathUserExtents.x,
+        context->pathUserExtents.y,
+        context->pathUserExtents.z - context->pathUserExtents.x,
+        context->pathUserExtents.w - context->pathUserExtents.y
     };
 
     if(!oc_image_is_nil(primitive->attributes.image))
@@ -380,7 +502,9 @@ void oc_gl_canvas_encode_path(oc_gl_canvas_backend* backend, oc_primitive* primi
         path->uvTransform[10] = 1;
         path->uvTransform[11] = 0;
 
-        path->textureID = backend->currentImageIndex;
+        path->uvClamp = oc_image_src_region_uv_clamp(srcRegion, texSize);
+
+        path->textureID = context->currentImageIndex;
     }
     else
     {
@@ -395,7 +519,7 @@ void oc_gl_canvas_encode_path(oc_gl_canvas_backend* backend, oc_primitive* primi
     int nTilesX = lastTileX - firstTileX + 1;
     int nTilesY = lastTileY - firstTileY + 1;
 
-    backend->maxTileQueueCount += (nTilesX * nTilesY);
+    context->maxTileQueueCount += (nTilesX * nTilesY);
 }
 
 static bool oc_intersect_hull_legs(oc_vec2 p0, oc_vec2 p1, oc_vec2 p2, oc_vec2 p3, oc_vec2* intersection)
@@ -587,14 +711,14 @@ static void oc_cubic_split(oc_vec2 p[4], f32 t, oc_vec2 outLeft[4], oc_vec2 outR
     outRight[3] = p[3];
 }
 
-void oc_gl_encode_stroke_line(oc_gl_canvas_backend* backend, oc_vec2* p)
+void oc_gl_encode_stroke_line(oc_gl_encoding_context* context, oc_vec2* p)
 {
     if(p[0].x == p[1].x && p[0].y == p[1].y)
     {
         return;
     }
 
-    f32 width = backend->primitive->attributes.width;
+    f32 width = context->primitive->attributes.width;
 
     oc_vec2 v = { p[1].x - p[0].x, p[1].y - p[0].y };
     oc_vec2 n = { v.y, -v.x };
@@ -606,11 +730,11 @@ void oc_gl_encode_stroke_line(oc_gl_canvas_backend* backend, oc_vec2* p)
     oc_vec2 joint0[2] = { oc_vec2_add(p[0], oc_vec2_mul(-1, offset)), oc_vec2_add(p[0], offset) };
     oc_vec2 joint1[2] = { oc_vec2_add(p[1], offset), oc_vec2_add(p[1], oc_vec2_mul(-1, offset)) };
 
-    oc_gl_canvas_encode_element(backend, OC_PATH_LINE, right);
+    oc_gl_canvas_encode_element(context, OC_PATH_LINE, right);
 
-    oc_gl_canvas_encode_element(backend, OC_PATH_LINE, left);
-    oc_gl_canvas_encode_element(backend, OC_PATH_LINE, joint0);
-    oc_gl_canvas_encode_element(backend, OC_PATH_LINE, joint1);
+    oc_gl_canvas_encode_element(context, OC_PATH_LINE, left);
+    oc_gl_canvas_encode_element(context, OC_PATH_LINE, joint0);
+    oc_gl_canvas_encode_element(context, OC_PATH_LINE, joint1);
 }
 
 enum
@@ -618,21 +742,21 @@ enum
     OC_HULL_CHECK_SAMPLE_COUNT = 5
 };
 
-void oc_gl_encode_stroke_quadratic(oc_gl_canvas_backend* backend, oc_vec2* p)
+void oc_gl_encode_stroke_quadratic(oc_gl_encoding_context* context, oc_vec2* p)
 {
-    f32 width = backend->primitive->attributes.width;
-    f32 tolerance = oc_min(backend->primitive->attributes.tolerance, 0.5 * width);
+    f32 width = context->primitive->attributes.width;
+    f32 tolerance = oc_min(context->primitive->attributes.tolerance, 0.5 * width);
 
     //NOTE: check for degenerate line case
     const f32 equalEps = 1e-3;
     if(oc_vec2_close(p[0], p[1], equalEps))
     {
-        oc_gl_encode_stroke_line(backend, p + 1);
+        oc_gl_encode_stroke_line(context, p + 1);
         return;
     }
     else if(oc_vec2_close(p[1], p[2], equalEps))
     {
-        oc_gl_encode_stroke_line(backend, p);
+        oc_gl_encode_stroke_line(context, p);
         return;
     }
 
@@ -647,8 +771,8 @@ void oc_gl_encode_stroke_quadratic(oc_gl_canvas_backend* backend, oc_vec2* p)
         oc_vec2 splitLeft[3];
         oc_vec2 splitRight[3];
         oc_quadratic_split(p, 0.5, splitLeft, splitRight);
-        oc_gl_encode_stroke_quadratic(backend, splitLeft);
-        oc_gl_encode_stroke_quadratic(backend, splitRight);
+        oc_gl_encode_stroke_quadratic(context, splitLeft);
+        oc_gl_encode_stroke_quadratic(context, splitRight);
     }
     else
     {
@@ -688,8 +812,8 @@ void oc_gl_encode_stroke_quadratic(oc_gl_canvas_backend* backend, oc_vec2* p)
             oc_vec2 splitLeft[3];
             oc_vec2 splitRight[3];
             oc_quadratic_split(p, maxOvershootParameter, splitLeft, splitRight);
-            oc_gl_encode_stroke_quadratic(backend, splitLeft);
-            oc_gl_encode_stroke_quadratic(backend, splitRight);
+            oc_gl_encode_stroke_quadratic(context, splitLeft);
+            oc_gl_encode_stroke_quadratic(context, splitRight);
         }
         else
         {
@@ -697,21 +821,21 @@ void oc_gl_encode_stroke_quadratic(oc_gl_canvas_backend* backend, oc_vec2* p)
             leftHull[0] = leftHull[2];
             leftHull[2] = tmp;
 
-            oc_gl_canvas_encode_element(backend, OC_PATH_QUADRATIC, rightHull);
-            oc_gl_canvas_encode_element(backend, OC_PATH_QUADRATIC, leftHull);
+            oc_gl_canvas_encode_element(context, OC_PATH_QUADRATIC, rightHull);
+            oc_gl_canvas_encode_element(context, OC_PATH_QUADRATIC, leftHull);
 
             oc_vec2 joint0[2] = { rightHull[2], leftHull[0] };
             oc_vec2 joint1[2] = { leftHull[2], rightHull[0] };
-            oc_gl_canvas_encode_element(backend, OC_PATH_LINE, joint0);
-            oc_gl_canvas_encode_element(backend, OC_PATH_LINE, joint1);
+            oc_gl_canvas_encode_element(context, OC_PATH_LINE, joint0);
+            oc_gl_canvas_encode_element(context, OC_PATH_LINE, joint1);
         }
     }
 }
 
-void oc_gl_encode_stroke_cubic(oc_gl_canvas_backend* backend, oc_vec2* p)
+void oc_gl_encode_stroke_cubic(oc_gl_encoding_context* context, oc_vec2* p)
 {
-    f32 width = backend->primitive->attributes.width;
-    f32 tolerance = oc_min(backend->primitive->attributes.tolerance, 0.5 * width);
+    f32 width = context->primitive->attributes.width;
+    f32 tolerance = oc_min(context->primitive->attributes.tolerance, 0.5 * width);
 
     //NOTE: check degenerate line cases
     f32 equalEps = 1e-3;
@@ -721,19 +845,19 @@ void oc_gl_encode_stroke_cubic(oc_gl_canvas_backend* backend, oc_vec2* p)
        || (oc_vec2_close(p[1], p[2], equalEps) && oc_vec2_close(p[2], p[3], equalEps)))
     {
         oc_vec2 line[2] = { p[0], p[3] };
-        oc_gl_encode_stroke_line(backend, line);
+        oc_gl_encode_stroke_line(context, line);
         return;
     }
     else if(oc_vec2_close(p[0], p[1], equalEps) && oc_vec2_close(p[1], p[3], equalEps))
     {
         oc_vec2 line[2] = { p[0], oc_vec2_add(oc_vec2_mul(5. / 9, p[0]), oc_vec2_mul(4. / 9, p[2])) };
-        oc_gl_encode_stroke_line(backend, line);
+        oc_gl_encode_stroke_line(context, line);
         return;
     }
     else if(oc_vec2_close(p[0], p[2], equalEps) && oc_vec2_close(p[2], p[3], equalEps))
     {
         oc_vec2 line[2] = { p[0], oc_vec2_add(oc_vec2_mul(5. / 9, p[0]), oc_vec2_mul(4. / 9, p[1])) };
-        oc_gl_encode_stroke_line(backend, line);
+        oc_gl_encode_stroke_line(context, line);
         return;
     }
 
@@ -748,8 +872,8 @@ void oc_gl_encode_stroke_cubic(oc_gl_canvas_backend* backend, oc_vec2* p)
         oc_vec2 splitLeft[4];
         oc_vec2 splitRight[4];
         oc_cubic_split(p, 0.5, splitLeft, splitRight);
-        oc_gl_encode_stroke_cubic(backend, splitLeft);
-        oc_gl_encode_stroke_cubic(backend, splitRight);
+        oc_gl_encode_stroke_cubic(context, splitLeft);
+        oc_gl_encode_stroke_cubic(context, splitRight);
     }
     else
     {
@@ -789,8 +913,8 @@ void oc_gl_encode_stroke_cubic(oc_gl_canvas_backend* backend, oc_vec2* p)
             oc_vec2 splitLeft[4];
             oc_vec2 splitRight[4];
             oc_cubic_split(p, maxOvershootParameter, splitLeft, splitRight);
-            oc_gl_encode_stroke_cubic(backend, splitLeft);
-            oc_gl_encode_stroke_cubic(backend, splitRight);
+            oc_gl_encode_stroke_cubic(context, splitLeft);
+            oc_gl_encode_stroke_cubic(context, splitRight);
         }
         else
         {
@@ -801,18 +925,18 @@ void oc_gl_encode_stroke_cubic(oc_gl_canvas_backend* backend, oc_vec2* p)
             leftHull[1] = leftHull[2];
             leftHull[2] = tmp;
 
-            oc_gl_canvas_encode_element(backend, OC_PATH_CUBIC, rightHull);
-            oc_gl_canvas_encode_element(backend, OC_PATH_CUBIC, leftHull);
+            oc_gl_canvas_encode_element(context, OC_PATH_CUBIC, rightHull);
+            oc_gl_canvas_encode_element(context, OC_PATH_CUBIC, leftHull);
 
             oc_vec2 joint0[2] = { rightHull[3], leftHull[0] };
             oc_vec2 joint1[2] = { leftHull[3], rightHull[0] };
-            oc_gl_canvas_encode_element(backend, OC_PATH_LINE, joint0);
-            oc_gl_canvas_encode_element(backend, OC_PATH_LINE, joint1);
+            oc_gl_canvas_encode_element(context, OC_PATH_LINE, joint0);
+            oc_gl_canvas_encode_element(context, OC_PATH_LINE, joint1);
         }
     }
 }
 
-void oc_gl_encode_stroke_element(oc_gl_canvas_backend* backend,
+void oc_gl_encode_stroke_element(oc_gl_encoding_context* context,
                                  oc_path_elt* element,
                                  oc_vec2 currentPoint,
                                  oc_vec2* startTangent,
@@ -825,17 +949,17 @@ void oc_gl_encode_stroke_element(oc_gl_canvas_backend* backend,
     switch(element->type)
     {
         case OC_PATH_LINE:
-            oc_gl_encode_stroke_line(backend, controlPoints);
+            oc_gl_encode_stroke_line(context, controlPoints);
             endPointIndex = 1;
             break;
 
         case OC_PATH_QUADRATIC:
-            oc_gl_encode_stroke_quadratic(backend, controlPoints);
+            oc_gl_encode_stroke_quadratic(context, controlPoints);
             endPointIndex = 2;
             break;
 
         case OC_PATH_CUBIC:
-            oc_gl_encode_stroke_cubic(backend, controlPoints);
+            oc_gl_encode_stroke_cubic(context, controlPoints);
             endPointIndex = 3;
             break;
 
@@ -872,11 +996,11 @@ void oc_gl_encode_stroke_element(oc_gl_canvas_backend* backend,
     OC_DEBUG_ASSERT(startTangent->x != 0 || startTangent->y != 0);
 }
 
-void oc_gl_stroke_cap(oc_gl_canvas_backend* backend,
+void oc_gl_stroke_cap(oc_gl_encoding_context* context,
                       oc_vec2 p0,
                       oc_vec2 direction)
 {
-    oc_attributes* attributes = &backend->primitive->attributes;
+    oc_attributes* attributes = &context->primitive->attributes;
 
     //NOTE(martin): compute the tangent and normal vectors (multiplied by half width) at the cap point
     f32 dn = sqrt(oc_square(direction.x) + oc_square(direction.y));
@@ -894,18 +1018,18 @@ void oc_gl_stroke_cap(oc_gl_canvas_backend* backend,
                          { p0.x - n0.x, p0.y - n0.y },
                          { p0.x + n0.x, p0.y + n0.y } };
 
-    oc_gl_canvas_encode_element(backend, OC_PATH_LINE, points);
-    oc_gl_canvas_encode_element(backend, OC_PATH_LINE, points + 1);
-    oc_gl_canvas_encode_element(backend, OC_PATH_LINE, points + 2);
-    oc_gl_canvas_encode_element(backend, OC_PATH_LINE, points + 3);
+    oc_gl_canvas_encode_element(context, OC_PATH_LINE, points);
+    oc_gl_canvas_encode_element(context, OC_PATH_LINE, points + 1);
+    oc_gl_canvas_encode_element(context, OC_PATH_LINE, points + 2);
+    oc_gl_canvas_encode_element(context, OC_PATH_LINE, points + 3);
 }
 
-void oc_gl_stroke_joint(oc_gl_canvas_backend* backend,
+void oc_gl_stroke_joint(oc_gl_encoding_context* context,
                         oc_vec2 p0,
                         oc_vec2 t0,
                         oc_vec2 t1)
 {
-    oc_attributes* attributes = &backend->primitive->attributes;
+    oc_attributes* attributes = &context->primitive->attributes;
 
     //NOTE(martin): compute the normals at the joint point
     f32 norm_t0 = sqrt(oc_square(t0.x) + oc_square(t0.y));
@@ -953,10 +1077,10 @@ void oc_gl_stroke_joint(oc_gl_canvas_backend* backend,
                              { p0.x + n1.x * halfW, p0.y + n1.y * halfW },
                              p0 };
 
-        oc_gl_canvas_encode_element(backend, OC_PATH_LINE, points);
-        oc_gl_canvas_encode_element(backend, OC_PATH_LINE, points + 1);
-        oc_gl_canvas_encode_element(backend, OC_PATH_LINE, points + 2);
-        oc_gl_canvas_encode_element(backend, OC_PATH_LINE, points + 3);
+        oc_gl_canvas_encode_element(context, OC_PATH_LINE, points);
+        oc_gl_canvas_encode_element(context, OC_PATH_LINE, points + 1);
+        oc_gl_canvas_encode_element(context, OC_PATH_LINE, points + 2);
+        oc_gl_canvas_encode_element(context, OC_PATH_LINE, points + 3);
     }
     else
     {
@@ -966,13 +1090,13 @@ void oc_gl_stroke_joint(oc_gl_canvas_backend* backend,
                              { p0.x + n1.x * halfW, p0.y + n1.y * halfW },
                              p0 };
 
-        oc_gl_canvas_encode_element(backend, OC_PATH_LINE, points);
-        oc_gl_canvas_encode_element(backend, OC_PATH_LINE, points + 1);
-        oc_gl_canvas_encode_element(backend, OC_PATH_LINE, points + 2);
+        oc_gl_canvas_encode_element(context, OC_PATH_LINE, points);
+        oc_gl_canvas_encode_element(context, OC_PATH_LINE, points + 1);
+        oc_gl_canvas_encode_element(context, OC_PATH_LINE, points + 2);
     }
 }
 
-u32 oc_gl_encode_stroke_subpath(oc_gl_canvas_backend* backend,
+u32 oc_gl_encode_stroke_subpath(oc_gl_encoding_context* context,
                                 oc_path_elt* elements,
                                 oc_path_descriptor* path,
                                 u32 startIndex,
@@ -989,7 +1113,7 @@ u32 oc_gl_encode_stroke_subpath(oc_gl_canvas_backend* backend,
     oc_vec2 endTangent = { 0, 0 };
 
     //NOTE(martin): encode first element and compute first tangent
-    oc_gl_encode_stroke_element(backend, elements + startIndex, currentPoint, &startTangent, &endTangent, &endPoint);
+    oc_gl_encode_stroke_element(context, elements + startIndex, currentPoint, &startTangent, &endTangent, &endPoint);
 
     firstTangent = startTangent;
     previousEndTangent = endTangent;
@@ -997,18 +1121,18 @@ u32 oc_gl_encode_stroke_subpath(oc_gl_canvas_backend* backend,
 
     //NOTE(martin): encode subsequent elements along with their joints
 
-    oc_attributes* attributes = &backend->primitive->attributes;
+    oc_attributes* attributes = &context->primitive->attributes;
 
     u32 eltIndex = startIndex + 1;
     for(;
         eltIndex < eltCount && elements[eltIndex].type != OC_PATH_MOVE;
         eltIndex++)
     {
-        oc_gl_encode_stroke_element(backend, elements + eltIndex, currentPoint, &startTangent, &endTangent, &endPoint);
+        oc_gl_encode_stroke_element(context, elements + eltIndex, currentPoint, &startTangent, &endTangent, &endPoint);
 
         if(attributes->joint != OC_JOINT_NONE)
         {
-            oc_gl_stroke_joint(backend, currentPoint, previousEndTangent, startTangent);
+            oc_gl_stroke_joint(context, currentPoint, previousEndTangent, startTangent);
         }
         previousEndTangent = endTangent;
         currentPoint = endPoint;
@@ -1023,19 +1147,19 @@ u32 oc_gl_encode_stroke_subpath(oc_gl_canvas_backend* backend,
         if(attributes->joint != OC_JOINT_NONE)
         {
             //NOTE(martin): add a closing joint if the path is closed
-            oc_gl_stroke_joint(backend, endPoint, endTangent, firstTangent);
+            oc_gl_stroke_joint(context, endPoint, endTangent, firstTangent);
         }
     }
     else if(attributes->cap == OC_CAP_SQUARE)
     {
         //NOTE(martin): add start and end cap
-        oc_gl_stroke_cap(backend, startPoint, (oc_vec2){ -startTangent.x, -startTangent.y });
-        oc_gl_stroke_cap(backend, endPoint, endTangent);
+        oc_gl_stroke_cap(context, startPoint, (oc_vec2){ -startTangent.x, -startTangent.y });
+        oc_gl_stroke_cap(context, endPoint, endTangent);
     }
     return (eltIndex);
 }
 
-void oc_gl_encode_stroke(oc_gl_canvas_backend* backend,
+void oc_gl_encode_stroke(oc_gl_encoding_context* context,
                          oc_path_elt* elements,
                          oc_path_descriptor* path)
 {
@@ -1055,7 +1179,7 @@ void oc_gl_encode_stroke(oc_gl_canvas_backend* backend,
         }
         if(startIndex < eltCount)
         {
-            startIndex = oc_gl_encode_stroke_subpath(backend, elements, path, startIndex, startPoint);
+            startIndex = oc_gl_encode_stroke_subpath(context, elements, path, startIndex, startPoint);
         }
     }
 }
@@ -1377,131 +1501,399 @@ void oc_gl_canvas_resize(oc_gl_canvas_backend* backend, oc_vec2 size)
     backend->frameSize = size;
 }
 
-void oc_gl_canvas_render(oc_canvas_backend* interface,
-                         oc_color clearColor,
-                         u32 primitiveCount,
-                         oc_primitive* primitives,
-                         u32 eltCount,
-                         oc_path_elt* pathElements)
+void oc_gl_reserve_input_buffer(oc_gl_mapped_buffer* buffer, int wantedSize, const char* name)
 {
-    oc_gl_canvas_backend* backend = (oc_gl_canvas_backend*)interface;
-
-    //NOTE: roll input buffers
-    backend->bufferIndex = (backend->bufferIndex + 1) % OC_GL_INPUT_BUFFERS_COUNT;
-    if(backend->bufferSync[backend->bufferIndex] != 0)
+    if(wantedSize > buffer->size)
     {
-        glClientWaitSync(backend->bufferSync[backend->bufferIndex], GL_SYNC_FLUSH_COMMANDS_BIT, 0xffffffff);
-        glDeleteSync(backend->bufferSync[backend->bufferIndex]);
-        backend->bufferSync[backend->bufferIndex] = 0;
-    }
-
-    //NOTE update screen tiles buffer size
-    oc_wgl_surface* surface = backend->surface;
-    oc_vec2 surfaceSize = surface->interface.getSize((oc_surface_data*)surface);
-    oc_vec2 contentsScaling = surface->interface.contentsScaling((oc_surface_data*)surface);
-    //TODO support scaling in both axes?
-    f32 scale = contentsScaling.x;
+        int newSize = (int)(buffer->size * 1.5);
+        while(wantedSize > newSize)
+        {
+            newSize = (int)(newSize * 1.5);
+        }
+        oc_log_info("growing %s buffer to %i bytes\n", name, newSize);
 
-    oc_vec2 viewportSize = { surfaceSize.x * scale, surfaceSize.y * scale };
-    int tileSize = OC_GL_TILE_SIZE;
-    int nTilesX = (int)(viewportSize.x + tileSize - 1) / tileSize;
-    int nTilesY = (int)(viewportSize.y + tileSize - 1) / tileSize;
+        //NOTE: nothing is encoded in the buffer yet, so we don't need to copy its contents
+        oc_gl_grow_input_buffer(buffer, 0, 0, newSize);
+    }
+}
 
-    if(viewportSize.x != backend->frameSize.x || viewportSize.y != backend->frameSize.y)
+void oc_gl_canvas_push_batch(oc_gl_canvas_backend* backend, u32 primitiveStart)
+{
+    if(backend->batchCount >= backend->batchCap)
     {
-        oc_gl_canvas_resize(backend, viewportSize);
+        backend->batchCap = oc_max(8, backend->batchCap * 2);
+        backend->batches = realloc(backend->batches, backend->batchCap * sizeof(oc_gl_encoding_batch));
+        if(!backend->batches)
+        {
+            OC_ABORT("couldn't allocate batches");
+        }
     }
+    oc_gl_encoding_batch* batch = &backend->batches[backend->batchCount];
+    backend->batchCount++;
 
-    glViewport(0, 0, viewportSize.x, viewportSize.y);
-
-    //NOTE: clear screen and reset input buffer offsets
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-
-    glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
-    glClear(GL_COLOR_BUFFER_BIT);
+    memset(batch, 0, sizeof(oc_gl_encoding_batch));
+    batch->primitiveStart = primitiveStart;
+    batch->primitiveEnd = primitiveStart;
+}
 
-    backend->pathCount = 0;
-    backend->pathBatchStart = 0;
-    backend->eltCount = 0;
-    backend->eltBatchStart = 0;
-    backend->maxSegmentCount = 0;
-    backend->maxTileQueueCount = 0;
+void oc_gl_canvas_prepare_batches(oc_gl_canvas_backend* backend, u32 primitiveCount, oc_primitive* primitives)
+{
+    //NOTE: assign image slots to primitives, and start a new batch when we run out of slots
+    if(primitiveCount > backend->primitiveCap)
+    {
+        backend->primitiveCap = oc_max(primitiveCount, backend->primitiveCap * 2);
+        backend->primitiveImageIndices = realloc(backend->primitiveImageIndices, backend->primitiveCap * sizeof(i32));
+        backend->primitiveCacheLookups = realloc(backend->primitiveCacheLookups,
+                                                 backend->primitiveCap * sizeof(oc_gl_path_cache_lookup));
+        if(!backend->primitiveImageIndices || !backend->primitiveCacheLookups)
+        {
+            OC_ABORT("couldn't allocate primitive encoding data");
+        }
+    }
 
-    //NOTE: encode and render batches
-    oc_vec2 currentPos = { 0 };
-    oc_image images[OC_GL_MAX_IMAGES_PER_BATCH] = { 0 };
+    backend->batchCount = 0;
+    oc_gl_canvas_push_batch(backend, 0);
     int imageCount = 0;
-    backend->eltCount = 0;
 
     for(int primitiveIndex = 0; primitiveIndex < primitiveCount; primitiveIndex++)
     {
         oc_primitive* primitive = &primitives[primitiveIndex];
+        oc_gl_encoding_batch* batch = &backend->batches[backend->batchCount - 1];
+        i32 imageIndex = -1;
 
         if(primitive->attributes.image.h != 0)
         {
-            backend->currentImageIndex = -1;
             for(int i = 0; i < imageCount; i++)
             {
-                if(images[i].h == primitive->attributes.image.h)
+                if(batch->images[i].h == primitive->attributes.image.h)
                 {
-                    backend->currentImageIndex = i;
+                    imageIndex = i;
+                    break;
                 }
             }
-            if(backend->currentImageIndex <= 0)
+            if(imageIndex < 0)
             {
                 if(imageCount < OC_GL_MAX_IMAGES_PER_BATCH)
                 {
-                    images[imageCount] = primitive->attributes.image;
-                    backend->currentImageIndex = imageCount;
+                    batch->images[imageCount] = primitive->attributes.image;
+                    imageIndex = imageCount;
                     imageCount++;
                 }
                 else
                 {
-                    oc_gl_render_batch(backend,
-                                       surface,
-                                       images,
-                                       tileSize,
-                                       nTilesX,
-                                       nTilesY,
-                                       viewportSize,
-                                       scale);
-
-                    images[0] = primitive->attributes.image;
-                    backend->currentImageIndex = 0;
+                    oc_gl_canvas_push_batch(backend, primitiveIndex);
+                    batch = &backend->batches[backend->batchCount - 1];
+
+                    batch->images[0] = primitive->attributes.image;
+                    imageIndex = 0;
                     imageCount = 1;
                 }
             }
         }
+        backend->primitiveImageIndices[primitiveIndex] = imageIndex;
+        batch->primitiveEnd = primitiveIndex + 1;
+    }
+    backend->interface.stats.batchCount = backend->batchCount;
+
+    //NOTE: split batches into chunks. Chunks never straddle batches, so that element path indices can be
+    //      fixed up relative to the start of their batch.
+    backend->chunkCount = 0;
+    for(u32 batchIndex = 0; batchIndex < backend->batchCount; batchIndex++)
+    {
+        oc_gl_encoding_batch* batch = &backend->batches[batchIndex];
+        for(u32 start = batch->primitiveStart; start < batch->primitiveEnd; start += OC_GL_ENCODING_CHUNK_SIZE)
+        {
+            if(backend->chunkCount >= backend->chunkCap)
+            {
+                //NOTE: chunks keep their scratch buffers across frames, so clear new slots only
+                u32 newCap = oc_max(16, backend->chunkCap * 2);
+                backend->chunks = realloc(backend->chunks, newCap * sizeof(oc_gl_encoding_chunk));
+                if(!backend->chunks)
+                {
+                    OC_ABORT("couldn't allocate encoding chunks");
+                }
+                memset(backend->chunks + backend->chunkCap, 0, (newCap - backend->chunkCap) * sizeof(oc_gl_encoding_chunk));
+                backend->chunkCap = newCap;
+            }
+            oc_gl_encoding_chunk* chunk = &backend->chunks[backend->chunkCount];
+            backend->chunkCount++;
+
+            chunk->batchIndex = batchIndex;
+            chunk->primitiveStart = start;
+            chunk->primitiveEnd = oc_min(start + OC_GL_ENCODING_CHUNK_SIZE, batch->primitiveEnd);
+        }
+    }
+}
+
+//--------------------------------------------------------------------
+// Path cache
+//--------------------------------------------------------------------
+
+oc_gl_path_cache_key oc_gl_path_cache_key_make(oc_primitive* primitive)
+{
+    oc_attributes* attributes = &primitive->attributes;
+    oc_gl_path_cache_key key = {
+        .linear = {
+            attributes->transform.m[0],
+            attributes->transform.m[1],
+            attributes->transform.m[3],
+            attributes->transform.m[4],
+        },
+        .width = attributes->width,
+        .tolerance = attributes->tolerance,
+        .maxJointExcursion = attributes->maxJointExcursion,
+        .joint = attributes->joint,
+        .cap = attributes->cap,
+        .startPoint = primitive->path.startPoint,
+        .count = primitive->path.count,
+    };
+    return (key);
+}
+
+u64 oc_gl_path_cache_hash(oc_gl_path_cache_key* key, oc_path_elt* elements)
+{
+    u64 hash = oc_hash_xx64_string(oc_str8_from_buffer(sizeof(oc_gl_path_cache_key), (char*)key));
+    hash = oc_hash_xx64_string_seed(oc_str8_from_buffer(key->count * sizeof(oc_path_elt), (char*)elements), hash);
+    return (hash);
+}
+
+oc_gl_path_cache_entry* oc_gl_path_cache_find(oc_gl_path_cache* cache, u64 hash, oc_gl_path_cache_key* key, oc_path_elt* elements)
+{
+    oc_gl_path_cache_entry* result = 0;
+    u64 bucketIndex = hash % OC_GL_PATH_CACHE_BUCKET_COUNT;
+
+    oc_list_for(cache->buckets[bucketIndex], entry, oc_gl_path_cache_entry, bucketElt)
+    {
+        if(entry->hash == hash
+           && !memcmp(&entry->key, key, sizeof(oc_gl_path_cache_key))
+           && !memcmp(entry->srcElements, elements, key->count * sizeof(oc_path_elt)))
+        {
+            result = entry;
+            break;
+        }
+    }
+    return (result);
+}
+
+u64 oc_gl_path_cache_entry_size(oc_gl_path_cache_entry* entry)
+{
+    return (sizeof(oc_gl_path_cache_entry)
+            + entry->eltCount * sizeof(oc_gl_path_elt)
+            + entry->key.count * sizeof(oc_path_elt));
+}
+
+void oc_gl_path_cache_evict(oc_gl_path_cache* cache, oc_gl_path_cache_entry* entry)
+{
+    oc_list_remove(&cache->buckets[entry->hash % OC_GL_PATH_CACHE_BUCKET_COUNT], &entry->bucketElt);
+    oc_list_remove(&cache->lru, &entry->lruElt);
+    cache->size -= oc_gl_path_cache_entry_size(entry);
+    free(entry);
+}
+
+void oc_gl_path_cache_update(oc_gl_path_cache* cache, u32 primitiveCount, oc_gl_path_cache_lookup* lookups, oc_canvas_render_stats* stats)
+{
+    stats->pathCacheHitCount = 0;
+    stats->pathCacheMissCount = 0;
+
+    for(u32 primitiveIndex = 0; primitiveIndex < primitiveCount; primitiveIndex++)
+    {
+        oc_gl_path_cache_lookup* lookup = &lookups[primitiveIndex];
+        oc_gl_path_cache_entry* entry = lookup->entry;
+        if(!entry)
+        {
+            continue;
+        }
+
+        if(lookup->hit)
+        {
+            cache->hitCount++;
+            stats->pathCacheHitCount++;
+            oc_list_remove(&cache->lru, &entry->lruElt);
+            oc_list_push(&cache->lru, &entry->lruElt);
+        }
         else
         {
-            backend->currentImageIndex = -1;
+            cache->missCount++;
+            stats->pathCacheMissCount++;
+
+            //NOTE: the same path can miss several times in a frame, in which case we only keep the first entry
+            u64 size = oc_gl_path_cache_entry_size(entry);
+            if(size > cache->budget || oc_gl_path_cache_find(cache, entry->hash, &entry->key, entry->srcElements))
+            {
+                free(entry);
+            }
+            else
+            {
+                oc_list_push(&cache->buckets[entry->hash % OC_GL_PATH_CACHE_BUCKET_COUNT], &entry->bucketElt);
+                oc_list_push(&cache->lru, &entry->lruElt);
+                cache->size += size;
+            }
         }
+        lookup->entry = 0;
+    }
+
+    while(cache->size > cache->budget)
+    {
+        oc_gl_path_cache_entry* entry = oc_list_last_entry(cache->lru, oc_gl_path_cache_entry, lruElt);
+        oc_gl_path_cache_evict(cache, entry);
+    }
+}
+
+void oc_gl_path_cache_cleanup(oc_gl_path_cache* cache)
+{
+    oc_log_info("path cache: %llu hits, %llu misses\n",
+                (unsigned long long)cache->hitCount,
+                (unsigned long long)cache->missCount);
+
+    oc_list_for_safe(cache->lru, entry, oc_gl_path_cache_entry, lruElt)
+    {
+        free(entry);
+    }
+    memset(cache, 0, sizeof(oc_gl_path_cache));
+}
+
+void oc_gl_canvas_encode_cached_stroke(oc_gl_path_cache* cache,
+                                       oc_gl_encoding_context* context,
+                                       oc_gl_path_cache_lookup* lookup,
+                                       oc_path_elt* elements,
+                                       oc_primitive* primitive)
+{
+    //NOTE: encode without translation, so that the elements can be stored in the cache, and translate them afterwards
+    oc_vec2 translation = { context->transform.m[2], context->transform.m[5] };
+    context->transform.m[2] = 0;
+    context->transform.m[5] = 0;
+
+    u32 eltStart = context->eltCount;
+    oc_gl_path_cache_key key = oc_gl_path_cache_key_make(primitive);
+    u64 hash = oc_gl_path_cache_hash(&key, elements);
+    oc_gl_path_cache_entry* entry = oc_gl_path_cache_find(cache, hash, &key, elements);
+
+    if(entry)
+    {
+        oc_gl_encoding_context_reserve_elements(context, entry->eltCount);
+
+        oc_gl_path_elt* dst = context->elements + eltStart;
+        for(u32 i = 0; i < entry->eltCount; i++)
+        {
+            dst[i] = entry->elements[i];
+            dst[i].pathIndex = context->pathCount;
+        }
+        context->eltCount += entry->eltCount;
+        context->maxSegmentCount += entry->maxSegmentCount;
+        context->pathScreenExtents = entry->screenExtents;
+        context->pathUserExtents = entry->userExtents;
+
+        lookup->entry = entry;
+        lookup->hit = true;
+    }
+    else
+    {
+        int maxSegmentCount = context->maxSegmentCount;
+        oc_gl_encode_stroke(context, elements, &primitive->path);
+
+        //NOTE: the entry is inserted in the cache after all chunks are encoded
+        u32 eltCount = context->eltCount - eltStart;
+        entry = malloc(sizeof(oc_gl_path_cache_entry)
+                       + eltCount * sizeof(oc_gl_path_elt)
+                       + key.count * sizeof(oc_path_elt));
+        if(entry)
+        {
+            memset(entry, 0, sizeof(oc_gl_path_cache_entry));
+            entry->hash = hash;
+            entry->key = key;
+            entry->srcElements = (oc_path_elt*)(entry->elements + eltCount);
+            memcpy(entry->srcElements, elements, key.count * sizeof(oc_path_elt));
+            entry->eltCount = eltCount;
+            entry->maxSegmentCount = context->maxSegmentCount - maxSegmentCount;
+            entry->screenExtents = context->pathScreenExtents;
+            entry->userExtents = context->pathUserExtents;
+
+            for(u32 i = 0; i < eltCount; i++)
+            {
+                entry->elements[i] = context->elements[eltStart + i];
+                entry->elements[i].pathIndex = 0;
+            }
+        }
+        lookup->entry = entry;
+        lookup->hit = false;
+    }
+
+    for(u32 eltIndex = eltStart; eltIndex < context->eltCount; eltIndex++)
+    {
+        oc_gl_path_elt* elt = &context->elements[eltIndex];
+        int pointCount = elt->kind + 1;
+        for(int i = 0; i < pointCount; i++)
+        {
+            elt->p[i].x += translation.x;
+            elt->p[i].y += translation.y;
+        }
+    }
+    context->pathScreenExtents.x += translation.x;
+    context->pathScreenExtents.y += translation.y;
+    context->pathScreenExtents.z += translation.x;
+    context->pathScreenExtents.w += translation.y;
+}
+
+typedef struct oc_gl_encoding_job_data
+{
+    oc_gl_canvas_backend* backend;
+    oc_primitive* primitives;
+    oc_path_elt* pathElements;
+    u32 eltCount;
+    f32 scale;
+
+} oc_gl_encoding_job_data;
+
+void oc_gl_canvas_encode_chunk_job(void* user, u32 workerIndex, u32 chunkIndex)
+{
+    oc_gl_encoding_job_data* data = (oc_gl_encoding_job_data*)user;
+    oc_gl_canvas_backend* backend = data->backend;
+    oc_gl_encoding_chunk* chunk = &backend->chunks[chunkIndex];
+    oc_gl_encoding_context* context = &chunk->context;
+
+    context->pathCount = 0;
+    context->eltCount = 0;
+    context->maxTileQueueCount = 0;
+    context->maxSegmentCount = 0;
+
+    for(u32 primitiveIndex = chunk->primitiveStart; primitiveIndex < chunk->primitiveEnd; primitiveIndex++)
+    {
+        oc_primitive* primitive = &data->primitives[primitiveIndex];
+        oc_gl_path_cache_lookup* lookup = &backend->primitiveCacheLookups[primitiveIndex];
+        *lookup = (oc_gl_path_cache_lookup){ 0 };
 
         if(primitive->path.count)
         {
-            backend->primitive = primitive;
-            backend->pathScreenExtents = (oc_vec4){ FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
-            backend->pathUserExtents = (oc_vec4){ FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+            context->primitive = primitive;
+            context->transform = primitive->attributes.transform;
+            context->currentImageIndex = backend->primitiveImageIndices[primitiveIndex];
+            context->pathScreenExtents = (oc_vec4){ FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+            context->pathUserExtents = (oc_vec4){ FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
 
             if(primitive->cmd == OC_CMD_STROKE)
             {
-                oc_gl_encode_stroke(backend, pathElements + primitive->path.startIndex, &primitive->path);
+                oc_gl_canvas_encode_cached_stroke(&backend->pathCache,
+                                                  context,
+                                                  lookup,
+                                                  data->pathElements + primitive->path.startIndex,
+                                                  primitive);
             }
             else
             {
-                int segCount = 0;
+                //NOTE: the path's start point is the last point of the previous path, so that primitives
+                //      can be encoded independently of each other
+                oc_vec2 currentPos = primitive->path.startPoint;
+
                 for(int eltIndex = 0;
-                    (eltIndex < primitive->path.count) && (primitive->path.startIndex + eltIndex < eltCount);
+                    (eltIndex < primitive->path.count) && (primitive->path.startIndex + eltIndex < data->eltCount);
                     eltIndex++)
                 {
-                    oc_path_elt* elt = &pathElements[primitive->path.startIndex + eltIndex];
+                    oc_path_elt* elt = &data->pathElements[primitive->path.startIndex + eltIndex];
 
                     if(elt->type != OC_PATH_MOVE)
                     {
                         oc_vec2 p[4] = { currentPos, elt->p[0], elt->p[1], elt->p[2] };
-                        oc_gl_canvas_encode_element(backend, elt->type, p);
-                        segCount++;
+                        oc_gl_canvas_encode_element(context, elt->type, p);
                     }
                     switch(elt->type)
                     {
@@ -1524,18 +1916,142 @@ void oc_gl_canvas_render(oc_canvas_backend* interface,
                 }
             }
             //NOTE: push path
-            oc_gl_canvas_encode_path(backend, primitive, scale);
+            oc_gl_canvas_encode_path(context, primitive, data->scale);
         }
     }
+}
+
+void oc_gl_canvas_copy_chunk_job(void* user, u32 workerIndex, u32 chunkIndex)
+{
+    oc_gl_encoding_job_data* data = (oc_gl_encoding_job_data*)user;
+    oc_gl_canvas_backend* backend = data->backend;
+    oc_gl_encoding_chunk* chunk = &backend->chunks[chunkIndex];
+    oc_gl_encoding_batch* batch = &backend->batches[chunk->batchIndex];
+    oc_gl_encoding_context* context = &chunk->context;
+
+    oc_gl_path* paths = (oc_gl_path*)backend->pathBuffer[backend->bufferIndex].contents;
+    memcpy(paths + chunk->pathOffset, context->paths, context->pathCount * sizeof(oc_gl_path));
 
-    oc_gl_render_batch(backend,
-                       surface,
-                       images,
-                       tileSize,
-                       nTilesX,
-                       nTilesY,
-                       viewportSize,
-                       scale);
+    oc_gl_path_elt* elements = (oc_gl_path_elt*)backend->elementBuffer[backend->bufferIndex].contents;
+    oc_gl_path_elt* dst = elements + chunk->eltOffset;
+    u32 pathIndexOffset = chunk->pathOffset - batch->pathStart;
+
+    for(u32 i = 0; i < context->eltCount; i++)
+    {
+        dst[i] = context->elements[i];
+        dst[i].pathIndex += pathIndexOffset;
+    }
+}
+
+void oc_gl_canvas_render(oc_canvas_backend* interface,
+                         oc_color clearColor,
+                         u32 primitiveCount,
+                         oc_primitive* primitives,
+                         u32 eltCount,
+                         oc_path_elt* pathElements)
+{
+    oc_gl_canvas_backend* backend = (oc_gl_canvas_backend*)interface;
+
+    //NOTE: roll input buffers
+    backend->bufferIndex = (backend->bufferIndex + 1) % OC_GL_INPUT_BUFFERS_COUNT;
+    if(backend->bufferSync[backend->bufferIndex] != 0)
+    {
+        glClientWaitSync(backend->bufferSync[backend->bufferIndex], GL_SYNC_FLUSH_COMMANDS_BIT, 0xffffffff);
+        glDeleteSync(backend->bufferSync[backend->bufferIndex]);
+        backend->bufferSync[backend->bufferIndex] = 0;
+    }
+
+    //NOTE update screen tiles buffer size
+    oc_wgl_surface* surface = backend->surface;
+    oc_vec2 surfaceSize = surface->interface.getSize((oc_surface_data*)surface);
+    oc_vec2 contentsScaling = surface->interface.contentsScaling((oc_surface_data*)surface);
+    //TODO support scaling in both axes?
+    f32 scale = contentsScaling.x;
+
+    oc_vec2 viewportSize = { surfaceSize.x * scale, surfaceSize.y * scale };
+    int tileSize = OC_GL_TILE_SIZE;
+    int nTilesX = (int)(viewportSize.x + tileSize - 1) / tileSize;
+    int nTilesY = (int)(viewportSize.y + tileSize - 1) / tileSize;
+
+    if(viewportSize.x != backend->frameSize.x || viewportSize.y != backend->frameSize.y)
+    {
+        oc_gl_canvas_resize(backend, viewportSize);
+    }
+
+    glViewport(0, 0, viewportSize.x, viewportSize.y);
+
+    //NOTE: clear screen and reset input buffer offsets
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    //NOTE: split primitives into batches and chunks, and encode chunks in parallel
+    oc_gl_canvas_prepare_batches(backend, primitiveCount, primitives);
+
+    oc_gl_encoding_job_data jobData = {
+        .backend = backend,
+        .primitives = primitives,
+        .pathElements = pathElements,
+        .eltCount = eltCount,
+        .scale = scale,
+    };
+    oc_canvas_workers_run(backend->workers, backend->chunkCount, oc_gl_canvas_encode_chunk_job, &jobData);
+
+    oc_gl_path_cache_update(&backend->pathCache, primitiveCount, backend->primitiveCacheLookups, &backend->interface.stats);
+
+    //NOTE: compute the regions of the input buffers where chunks are copied
+    u32 pathTotal = 0;
+    u32 eltTotal = 0;
+    for(u32 chunkIndex = 0; chunkIndex < backend->chunkCount; chunkIndex++)
+    {
+        oc_gl_encoding_chunk* chunk = &backend->chunks[chunkIndex];
+        oc_gl_encoding_batch* batch = &backend->batches[chunk->batchIndex];
+
+        if(chunk->primitiveStart == batch->primitiveStart)
+        {
+            batch->pathStart = pathTotal;
+            batch->eltStart = eltTotal;
+        }
+        chunk->pathOffset = pathTotal;
+        chunk->eltOffset = eltTotal;
+
+        batch->pathCount += chunk->context.pathCount;
+        batch->eltCount += chunk->context.eltCount;
+        batch->maxTileQueueCount += chunk->context.maxTileQueueCount;
+        batch->maxSegmentCount += chunk->context.maxSegmentCount;
+
+        pathTotal += chunk->context.pathCount;
+        eltTotal += chunk->context.eltCount;
+    }
+
+    oc_gl_reserve_input_buffer(&backend->pathBuffer[backend->bufferIndex], pathTotal * sizeof(oc_gl_path), "path");
+    oc_gl_reserve_input_buffer(&backend->elementBuffer[backend->bufferIndex], eltTotal * sizeof(oc_gl_path_elt), "element");
+
+    oc_canvas_workers_run(backend->workers, backend->chunkCount, oc_gl_canvas_copy_chunk_job, &jobData);
+
+    //NOTE: render batches
+    for(u32 batchIndex = 0; batchIndex < backend->batchCount; batchIndex++)
+    {
+        oc_gl_encoding_batch* batch = &backend->batches[batchIndex];
+
+        backend->pathBatchStart = batch->pathStart;
+        backend->pathCount = batch->pathStart + batch->pathCount;
+        backend->eltBatchStart = batch->eltStart;
+        backend->eltCount = batch->eltStart + batch->eltCount;
+        backend->maxTileQueueCount = batch->maxTileQueueCount;
+        backend->maxSegmentCount = batch->maxSegmentCount;
+
+        oc_gl_render_batch(backend,
+                           surface,
+                           batch->images,
+                           tileSize,
+                           nTilesX,
+                           nTilesY,
+                           viewportSize,
+                           scale);
+    }
 
     //NOTE: add fence for rolling input buffers
     backend->bufferSync[backend->bufferIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
@@ -1593,6 +2109,18 @@ void oc_gl_canvas_destroy(oc_canvas_backend* interface)
     //TODO
     ////////////////////////////////////////////////////////////////////
 
+    for(u32 i = 0; i < backend->chunkCap; i++)
+    {
+        free(backend->chunks[i].context.paths);
+        free(backend->chunks[i].context.elements);
+    }
+    free(backend->chunks);
+    free(backend->batches);
+    free(backend->primitiveImageIndices);
+    free(backend->primitiveCacheLookups);
+
+    oc_gl_path_cache_cleanup(&backend->pathCache);
+
     free(backend);
 }
 
@@ -1723,6 +2251,9 @@ oc_canvas_backend* oc_gl_canvas_backend_create(oc_wgl_surface* surface)
         backend->interface.imageDestroy = oc_gl_canvas_image_destroy;
         backend->interface.imageUploadRegion = oc_gl_canvas_image_upload_region;
 
+        backend->workers = oc_graphics_canvas_workers();
+        backend->pathCache.budget = OC_GL_PATH_CACHE_BUDGET;
+
         surface->interface.prepare((oc_surface_data*)surface);
 
         glGenVertexArrays(1, &backend->vao);
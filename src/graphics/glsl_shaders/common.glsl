@@ -33,6 +33,7 @@ struct oc_gl_path
     vec4 color;
     vec4 box;
     vec4 clip;
+    vec4 uvClamp;
     int cmd;
     int textureID;
 };
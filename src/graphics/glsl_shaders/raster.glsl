@@ -173,6 +173,8 @@ void main()
                     vec2 sampleCoord = imgSampleCoords[sampleIndex];
                     vec3 ph = vec3(sampleCoord.xy, 1);
                     vec2 uv = (pathBuffer.elements[pathBufferStart + pathIndex].uvTransform * ph).xy;
+                    vec4 uvClamp = pathBuffer.elements[pathBufferStart + pathIndex].uvClamp;
+                    uv = clamp(uv, uvClamp.xy, uvClamp.zw);
 
                     if(textureID == 0)
                     {
@@ -65,15 +65,12 @@ typedef enum
         #define OC_COMPILE_CANVAS 1
     #endif
 
-#elif PLATFORM_LINUX
-    #ifndef OC_COMPILE_GL
-        #define OC_COMPILE_GL 1
-    #endif
+#elif OC_PLATFORM_LINUX
+    //NOTE: linux only has a headless canvas backend for now, which accepts render commands without drawing them
+    #define OC_COMPILE_GL 0
+    #define OC_COMPILE_GLES 0
 
     #ifndef OC_COMPILE_CANVAS
-        #if !OC_COMPILE_GL
-            #error "Canvas surface requires an OpenGL backend on Linux. Make sure you define OC_COMPILE_GL to 1."
-        #endif
         #define OC_COMPILE_CANVAS 1
     #endif
 #endif
@@ -108,6 +105,9 @@ ORCA_API void oc_surface_swap_interval(oc_surface surface, int swap);
 ORCA_API bool oc_surface_get_hidden(oc_surface surface);
 ORCA_API void oc_surface_set_hidden(oc_surface surface, bool hidden);
 
+//DOC: copies the last frame rendered to a canvas surface as RGBA8 rows, top row first. Returns 0 if the surface can't be read back.
+ORCA_API u8* oc_surface_read_pixels(oc_arena* arena, oc_surface surface, oc_vec2* size);
+
 #else
 
 ORCA_API oc_surface oc_surface_canvas(void); //DOC: creates a surface for use with the canvas API
@@ -210,6 +210,16 @@ typedef struct oc_text_metrics
 
 } oc_text_metrics;
 
+typedef struct oc_text_run_cache_stats
+{
+    u64 hits;
+    u64 misses;
+    u64 evictions;
+    u32 runCount;
+    f64 hitRate;
+
+} oc_text_run_cache_stats;
+
 //------------------------------------------------------------------------------------------
 //SECTION: graphics canvas
 //------------------------------------------------------------------------------------------
@@ -231,6 +241,13 @@ ORCA_API oc_font oc_font_create_from_memory(oc_str8 mem, u32 rangeCount, oc_unic
 ORCA_API oc_font oc_font_create_from_file(oc_file file, u32 rangeCount, oc_unicode_range* ranges);
 ORCA_API oc_font oc_font_create_from_path(oc_str8 path, u32 rangeCount, oc_unicode_range* ranges);
 
+//NOTE: font caches hold the glyph metrics and outlines of a font, and can be loaded without parsing the font file.
+//      oc_font_create_from_cache_memory() uses the cache in place, so the memory must outlive the font.
+ORCA_API oc_str8 oc_font_push_cache(oc_arena* arena, oc_font font);
+ORCA_API oc_font oc_font_create_from_cache_memory(oc_str8 mem);
+ORCA_API oc_font oc_font_create_from_cache_file(oc_file file);
+ORCA_API oc_font oc_font_create_from_cache_path(oc_str8 path);
+
 ORCA_API void oc_font_destroy(oc_font font);
 
 ORCA_API oc_str32 oc_font_get_glyph_indices(oc_font font, oc_str32 codePoints, oc_str32 backing);
@@ -245,6 +262,11 @@ ORCA_API f32 oc_font_get_scale_for_em_pixels(oc_font font, f32 emSize);
 ORCA_API oc_text_metrics oc_font_text_metrics_utf32(oc_font font, f32 fontSize, oc_str32 codepoints);
 ORCA_API oc_text_metrics oc_font_text_metrics(oc_font font, f32 fontSize, oc_str8 text);
 
+//NOTE: the glyphs and metrics of short strings are cached per (font, size, string) by the text metrics and text
+//      outlines functions, and evicted when they haven't been used for a number of frames.
+ORCA_API oc_text_run_cache_stats oc_text_run_cache_get_stats(void);
+ORCA_API void oc_text_run_cache_reset_stats(void);
+
 //------------------------------------------------------------------------------------------
 //SECTION: images
 //------------------------------------------------------------------------------------------
@@ -262,6 +284,22 @@ ORCA_API void oc_image_destroy(oc_image image);
 ORCA_API void oc_image_upload_region_rgba8(oc_image image, oc_rect region, u8* pixels);
 ORCA_API oc_vec2 oc_image_size(oc_image image);
 
+//NOTE: asynchronous loading. These return an image of its final size right away, which is decoded on loader threads
+//      and uploaded during the following renders of its surface. It draws as transparent until it is ready.
+//      If maxSize is not zero, the image is downscaled to fit in a maxSize x maxSize square.
+typedef enum
+{
+    OC_IMAGE_READY,
+    OC_IMAGE_PENDING,
+    OC_IMAGE_FAILED,
+} oc_image_status;
+
+ORCA_API oc_image oc_image_create_async_from_memory(oc_surface surface, oc_str8 mem, bool flip, u32 maxSize);
+ORCA_API oc_image oc_image_create_async_from_file(oc_surface surface, oc_file file, bool flip, u32 maxSize);
+ORCA_API oc_image oc_image_create_async_from_path(oc_surface surface, oc_str8 path, bool flip, u32 maxSize);
+
+ORCA_API oc_image_status oc_image_get_status(oc_image image);
+
 //------------------------------------------------------------------------------------------
 //SECTION: atlasing
 //------------------------------------------------------------------------------------------
@@ -273,6 +311,36 @@ ORCA_API oc_rect_atlas* oc_rect_atlas_create(oc_arena* arena, i32 width, i32 hei
 ORCA_API oc_rect oc_rect_atlas_alloc(oc_rect_atlas* atlas, i32 width, i32 height);
 ORCA_API void oc_rect_atlas_recycle(oc_rect_atlas* atlas, oc_rect rect);
 
+typedef struct oc_rect_atlas_stats
+{
+    oc_vec2i size;
+    u32 allocCount;
+    u32 freeRectCount;
+    u64 usedArea;        // area of the allocated rectangles
+    u64 freeArea;        // area of the free rectangles
+    u64 largestFreeArea; // area of the largest free rectangle
+    f32 occupancy;       // usedArea divided by the atlas area
+
+} oc_rect_atlas_stats;
+
+ORCA_API oc_rect_atlas_stats oc_rect_atlas_get_stats(oc_rect_atlas* atlas);
+
+//NOTE: oc_rect_atlas_defragment() repacks the allocated rectangles, and calls moveProc once with the list of all the
+//      rectangles that moved, so that the caller can re-blit their contents and update its references. Moves are
+//      not ordered: a destination can overlap the source of another move, so the caller must read all the sources
+//      (eg. into a scratch copy) before writing any destination. moveProc is called before the atlas is updated.
+//      If the rectangles can't be repacked, moveProc is not called, the atlas is left untouched and the function
+//      returns false.
+typedef struct oc_rect_atlas_move
+{
+    oc_rect from;
+    oc_rect to;
+} oc_rect_atlas_move;
+
+typedef void (*oc_rect_atlas_move_proc)(u32 count, oc_rect_atlas_move* moves, void* user);
+
+ORCA_API bool oc_rect_atlas_defragment(oc_rect_atlas* atlas, oc_rect_atlas_move_proc moveProc, void* user);
+
 //NOTE: image atlas helpers
 typedef struct oc_image_region
 {
@@ -311,6 +379,7 @@ ORCA_API void oc_set_cap(oc_cap_type cap);
 ORCA_API void oc_set_font(oc_font font);
 ORCA_API void oc_set_font_size(f32 size);
 ORCA_API void oc_set_text_flip(bool flip);
+ORCA_API void oc_set_glyph_raster_cache(bool enable);
 ORCA_API void oc_set_image(oc_image image);
 ORCA_API void oc_set_image_source_region(oc_rect region);
 
@@ -323,6 +392,7 @@ ORCA_API oc_cap_type oc_get_cap(void);
 ORCA_API oc_font oc_get_font(void);
 ORCA_API f32 oc_get_font_size(void);
 ORCA_API bool oc_get_text_flip(void);
+ORCA_API bool oc_get_glyph_raster_cache(void);
 ORCA_API oc_image oc_get_image();
 ORCA_API oc_rect oc_get_image_source_region();
 
@@ -350,8 +420,10 @@ ORCA_API void oc_stroke(void);
 //------------------------------------------------------------------------------------------
 //SECTION: shapes helpers
 //------------------------------------------------------------------------------------------
+ORCA_API void oc_rectangle_path(f32 x, f32 y, f32 w, f32 h);
 ORCA_API void oc_rectangle_fill(f32 x, f32 y, f32 w, f32 h);
 ORCA_API void oc_rectangle_stroke(f32 x, f32 y, f32 w, f32 h);
+ORCA_API void oc_rounded_rectangle_path(f32 x, f32 y, f32 w, f32 h, f32 r);
 ORCA_API void oc_rounded_rectangle_fill(f32 x, f32 y, f32 w, f32 h, f32 r);
 ORCA_API void oc_rounded_rectangle_stroke(f32 x, f32 y, f32 w, f32 h, f32 r);
 ORCA_API void oc_ellipse_fill(f32 x, f32 y, f32 rx, f32 ry);
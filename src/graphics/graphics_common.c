@@ -17,12 +17,20 @@
 #endif
 #include "stb/stb_image.h"
 
-#define STB_TRUETYPE_IMPLEMENTATION
-#include "stb/stb_truetype.h"
+#if !OC_PLATFORM_ORCA
+    #define STB_TRUETYPE_IMPLEMENTATION
+    #include "stb/stb_truetype.h"
+#endif
 
 #include "graphics_common.h"
 #include "platform/platform_debug.h"
 #include "util/algebra.h"
+#include "util/hash.h"
+
+#if !OC_PLATFORM_ORCA
+
+//NOTE: fonts live on the host. In wasm guests, fonts are only handles, and the font procedures used by the canvas
+//      are imported from the runtime.
 
 typedef struct oc_glyph_map_entry
 {
@@ -33,6 +41,7 @@ typedef struct oc_glyph_map_entry
 
 typedef struct oc_glyph_data
 {
+    bool loaded;
     bool exists;
     oc_utf32 codePoint;
     oc_path_descriptor pathDescriptor;
@@ -41,12 +50,42 @@ typedef struct oc_glyph_data
 
 } oc_glyph_data;
 
+#endif // !OC_PLATFORM_ORCA
+
 enum
 {
     OC_MATRIX_STACK_MAX_DEPTH = 64,
     OC_CLIP_STACK_MAX_DEPTH = 64,
     OC_MAX_PATH_ELEMENT_COUNT = 2 << 20,
-    OC_MAX_PRIMITIVE_COUNT = 8 << 10
+    OC_MAX_PRIMITIVE_COUNT = 8 << 10,
+    OC_MAX_PENDING_GLYPH_COUNT = 4 << 10,
+};
+
+//NOTE: when the glyph raster cache is enabled, small glyphs aren't added to the path as outlines. Instead they are
+//      kept as pending glyphs until the path is filled, where each of them is emitted as an image quad. The quads'
+//      image and rectangle are resolved in oc_render(), once we know which surface they're drawn on, by looking up
+//      (or rasterizing) the glyph in that surface's glyph cache atlas.
+//      Pending glyphs are turned back into outlines if the path is stroked, or filled with a transform that isn't
+//      a pure translation.
+typedef struct oc_glyph_quad
+{
+    oc_font font;
+    u32 glyphIndex;
+    f32 fontSize;
+    oc_vec2 origin; // pen position, in user space
+    oc_rect ink;    // glyph ink box, in font units
+    u32 primitiveIndex;
+
+} oc_glyph_quad;
+
+#if !OC_PLATFORM_ORCA
+
+//NOTE: codepoints are mapped to glyph indices through a two-level table. cmapPageIndices maps each page of
+//      OC_FONT_CMAP_PAGE_SIZE codepoints to a 1-based index into cmapPages, or 0 if the font has no glyph in that page.
+enum
+{
+    OC_FONT_CMAP_PAGE_SIZE = 256,
+    OC_FONT_CMAP_PAGE_COUNT = 0x110000 / OC_FONT_CMAP_PAGE_SIZE,
 };
 
 typedef struct oc_font_data
@@ -56,6 +95,7 @@ typedef struct oc_font_data
     u32 rangeCount;
     u32 glyphCount;
     u32 outlineCount;
+    u32 outlineCapacity;
     oc_glyph_map_entry* glyphMap;
     oc_glyph_data* glyphs;
     oc_path_elt* outlines;
@@ -63,8 +103,23 @@ typedef struct oc_font_data
     f32 unitsPerEm;
     oc_font_metrics metrics;
 
+    //NOTE: the font file is kept around to load glyphs on first use, and to rasterize them for the glyph raster cache
+    char* blob;
+    stbtt_fontinfo stbttInfo;
+
+    //NOTE: fonts created from a font cache have all their glyphs loaded, and their glyph map, glyphs and outlines
+    //      point into the cache's memory. cacheBuffer is set if that memory is owned by the font.
+    bool fromCache;
+    char* cacheBuffer;
+
+    u16* cmapPageIndices;
+    u32* cmapPages;
+    u32 cmapPageCount;
+
 } oc_font_data;
 
+#endif // !OC_PLATFORM_ORCA
+
 typedef struct oc_canvas_data oc_canvas_data;
 
 typedef enum oc_graphics_handle_kind
@@ -103,6 +158,11 @@ typedef struct oc_graphics_data
     oc_arena resourceArena;
     oc_list canvasFreeList;
     oc_list fontFreeList;
+    oc_list glyphCaches;
+
+#if OC_CANVAS_WORKERS
+    oc_canvas_workers workers;
+#endif
 
 } oc_graphics_data;
 
@@ -112,6 +172,7 @@ typedef struct oc_canvas_data
 
     oc_attributes attributes;
     bool textFlip;
+    bool glyphRasterCache;
 
     oc_path_elt pathElements[OC_MAX_PATH_ELEMENT_COUNT];
     oc_path_descriptor path;
@@ -127,6 +188,12 @@ typedef struct oc_canvas_data
     u32 primitiveCount;
     oc_primitive primitives[OC_MAX_PRIMITIVE_COUNT];
 
+    u32 pendingGlyphCount;
+    oc_glyph_quad pendingGlyphs[OC_MAX_PENDING_GLYPH_COUNT];
+
+    u32 glyphQuadCount;
+    oc_glyph_quad glyphQuads[OC_MAX_PRIMITIVE_COUNT];
+
     //NOTE: these are used at render time
     oc_color clearColor;
 
@@ -143,10 +210,24 @@ void oc_graphics_init()
     {
         oc_graphicsData.handleNextIndex = 0;
         oc_arena_init(&oc_graphicsData.resourceArena);
+#if OC_CANVAS_WORKERS
+        oc_canvas_workers_init(&oc_graphicsData.workers, OC_STR8("canvas worker"));
+#endif
         oc_graphicsData.init = true;
     }
 }
 
+#if OC_CANVAS_WORKERS
+oc_canvas_workers* oc_graphics_canvas_workers(void)
+{
+    if(!oc_graphicsData.init)
+    {
+        oc_graphics_init();
+    }
+    return (&oc_graphicsData.workers);
+}
+#endif
+
 //------------------------------------------------------------------------
 // handle pools procedures
 //------------------------------------------------------------------------
@@ -357,6 +438,8 @@ oc_font oc_font_nil() { return ((oc_font){ .h = 0 }); }
 
 bool oc_font_is_nil(oc_font font) { return (font.h == 0); }
 
+#if !OC_PLATFORM_ORCA
+
 oc_font oc_font_handle_alloc(oc_font_data* font)
 {
     oc_font handle = { .h = oc_graphics_handle_alloc(OC_GRAPHICS_HANDLE_FONT, (void*)font) };
@@ -369,14 +452,12 @@ oc_font_data* oc_font_data_from_handle(oc_font handle)
     return (data);
 }
 
-oc_font oc_font_create_from_memory(oc_str8 mem, u32 rangeCount, oc_unicode_range* ranges)
+oc_font_data* oc_font_data_alloc(oc_font* handle)
 {
     if(!oc_graphicsData.init)
     {
         oc_graphics_init();
     }
-    oc_font fontHandle = oc_font_nil();
-
     oc_font_data* font = oc_list_pop_entry(&oc_graphicsData.fontFreeList, oc_font_data, freeListElt);
     if(!font)
     {
@@ -385,10 +466,71 @@ oc_font oc_font_create_from_memory(oc_str8 mem, u32 rangeCount, oc_unicode_range
     if(font)
     {
         memset(font, 0, sizeof(oc_font_data));
-        fontHandle = oc_font_handle_alloc(font);
+        *handle = oc_font_handle_alloc(font);
+    }
+    return (font);
+}
+
+void oc_font_build_cmap(oc_font_data* font)
+{
+    //NOTE: map each page of codepoints covered by the font's ranges to a table of glyph indices
+    font->cmapPageIndices = calloc(OC_FONT_CMAP_PAGE_COUNT, sizeof(u16));
+    font->cmapPageCount = 0;
+
+    for(int rangeIndex = 0; rangeIndex < font->rangeCount; rangeIndex++)
+    {
+        oc_unicode_range range = font->glyphMap[rangeIndex].range;
+        if(!range.count || range.firstCodePoint >= OC_FONT_CMAP_PAGE_COUNT * OC_FONT_CMAP_PAGE_SIZE)
+        {
+            continue;
+        }
+        u32 lastCodePoint = oc_min(range.firstCodePoint + range.count - 1, OC_FONT_CMAP_PAGE_COUNT * OC_FONT_CMAP_PAGE_SIZE - 1);
+        for(u32 page = range.firstCodePoint / OC_FONT_CMAP_PAGE_SIZE; page <= lastCodePoint / OC_FONT_CMAP_PAGE_SIZE; page++)
+        {
+            if(!font->cmapPageIndices[page])
+            {
+                font->cmapPageCount++;
+                font->cmapPageIndices[page] = font->cmapPageCount;
+            }
+        }
+    }
+
+    font->cmapPages = calloc(font->cmapPageCount * OC_FONT_CMAP_PAGE_SIZE, sizeof(u32));
+
+    for(int rangeIndex = 0; rangeIndex < font->rangeCount; rangeIndex++)
+    {
+        oc_glyph_map_entry* entry = &font->glyphMap[rangeIndex];
+        for(u32 offset = 0; offset < entry->range.count; offset++)
+        {
+            u32 codePoint = entry->range.firstCodePoint + offset;
+            if(codePoint >= OC_FONT_CMAP_PAGE_COUNT * OC_FONT_CMAP_PAGE_SIZE)
+            {
+                break;
+            }
+            u32 page = font->cmapPageIndices[codePoint / OC_FONT_CMAP_PAGE_SIZE] - 1;
+            u32* slot = &font->cmapPages[page * OC_FONT_CMAP_PAGE_SIZE + codePoint % OC_FONT_CMAP_PAGE_SIZE];
+
+            //NOTE: when ranges overlap, the first one wins
+            if(!*slot)
+            {
+                *slot = entry->firstGlyphIndex + offset;
+            }
+        }
+    }
+}
+
+oc_font oc_font_create_from_memory(oc_str8 mem, u32 rangeCount, oc_unicode_range* ranges)
+{
+    oc_font fontHandle = oc_font_nil();
+    oc_font_data* font = oc_font_data_alloc(&fontHandle);
+    if(font)
+    {
+        font->blob = oc_malloc_array(char, mem.len);
+        memcpy(font->blob, mem.ptr, mem.len);
 
         stbtt_fontinfo stbttFontInfo;
-        stbtt_InitFont(&stbttFontInfo, (byte*)mem.ptr, 0);
+        stbtt_InitFont(&stbttFontInfo, (byte*)font->blob, 0);
+        font->stbttInfo = stbttFontInfo;
 
         //NOTE(martin): load font metrics data
         font->unitsPerEm = 1. / stbtt_ScaleForMappingEmToPixels(&stbttFontInfo, 1);
@@ -421,303 +563,448 @@ oc_font oc_font_create_from_memory(oc_str8 mem, u32 rangeCount, oc_unicode_range
             font->glyphMap[i].firstGlyphIndex = font->glyphCount + 1;
             font->glyphCount += ranges[i].count;
         }
+        oc_font_build_cmap(font);
 
-        font->glyphs = oc_malloc_array(oc_glyph_data, font->glyphCount);
+        //NOTE: glyph metrics and outlines are loaded on first use, see oc_font_get_glyph_data()
+        font->glyphs = calloc(font->glyphCount, sizeof(oc_glyph_data));
+    }
+    return (fontHandle);
+}
 
-        //NOTE(martin): first do a count of outlines
-        int outlineCount = 0;
-        for(int rangeIndex = 0; rangeIndex < rangeCount; rangeIndex++)
+void oc_font_destroy(oc_font fontHandle)
+{
+    oc_font_data* fontData = oc_font_data_from_handle(fontHandle);
+    if(fontData)
+    {
+        if(fontData->fromCache)
         {
-            oc_utf32 codePoint = font->glyphMap[rangeIndex].range.firstCodePoint;
-            u32 firstGlyphIndex = font->glyphMap[rangeIndex].firstGlyphIndex;
-            u32 endGlyphIndex = firstGlyphIndex + font->glyphMap[rangeIndex].range.count;
-
-            for(int glyphIndex = firstGlyphIndex;
-                glyphIndex < endGlyphIndex; glyphIndex++)
-            {
-                int stbttGlyphIndex = stbtt_FindGlyphIndex(&stbttFontInfo, codePoint);
-                if(stbttGlyphIndex == 0)
-                {
-                    //NOTE(martin): the codepoint is not found in the font
-                    codePoint++;
-                    continue;
-                }
-                //NOTE(martin): load glyph outlines
-                stbtt_vertex* vertices = 0;
-                outlineCount += stbtt_GetGlyphShape(&stbttFontInfo, stbttGlyphIndex, &vertices);
-                stbtt_FreeShape(&stbttFontInfo, vertices);
-                codePoint++;
-            }
+            free(fontData->cacheBuffer);
         }
-        //NOTE(martin): allocate outlines
-        font->outlines = oc_malloc_array(oc_path_elt, outlineCount);
-        font->outlineCount = 0;
-
-        //NOTE(martin): load metrics and outlines
-        for(int rangeIndex = 0; rangeIndex < rangeCount; rangeIndex++)
+        else
         {
-            oc_utf32 codePoint = font->glyphMap[rangeIndex].range.firstCodePoint;
-            u32 firstGlyphIndex = font->glyphMap[rangeIndex].firstGlyphIndex;
-            u32 endGlyphIndex = firstGlyphIndex + font->glyphMap[rangeIndex].range.count;
-
-            for(int glyphIndex = firstGlyphIndex;
-                glyphIndex < endGlyphIndex; glyphIndex++)
-            {
-                oc_glyph_data* glyph = &(font->glyphs[glyphIndex - 1]);
-
-                int stbttGlyphIndex = stbtt_FindGlyphIndex(&stbttFontInfo, codePoint);
-                if(stbttGlyphIndex == 0)
-                {
-                    //NOTE(martin): the codepoint is not found in the font, we zero the glyph info
-                    memset(glyph, 0, sizeof(*glyph));
-                    codePoint++;
-                    continue;
-                }
-
-                glyph->exists = true;
-                glyph->codePoint = codePoint;
-
-                //NOTE(martin): load glyph metric
-                int xAdvance, xBearing, x0, y0, x1, y1;
-                stbtt_GetGlyphHMetrics(&stbttFontInfo, stbttGlyphIndex, &xAdvance, &xBearing);
-                stbtt_GetGlyphBox(&stbttFontInfo, stbttGlyphIndex, &x0, &y0, &x1, &y1);
-
-                //NOTE(martin): stb stbtt_GetGlyphBox returns bottom left and top right corners, with y up,
-                //              so we have to set .y = -y1
-                glyph->metrics.ink = (oc_rect){
-                    .x = x0,
-                    .y = -y1,
-                    .w = x1 - x0,
-                    .h = y1 - y0
-                };
-
-                glyph->metrics.advance = (oc_vec2){ xAdvance, 0 };
-
-                //NOTE(martin): load glyph outlines
-
-                stbtt_vertex* vertices = 0;
-                int vertexCount = stbtt_GetGlyphShape(&stbttFontInfo, stbttGlyphIndex, &vertices);
-
-                glyph->pathDescriptor = (oc_path_descriptor){ .startIndex = font->outlineCount,
-                                                              .count = vertexCount,
-                                                              .startPoint = { 0, 0 } };
+            free(fontData->glyphMap);
+            free(fontData->glyphs);
+            free(fontData->outlines);
+            free(fontData->blob);
+        }
+        free(fontData->cmapPageIndices);
+        free(fontData->cmapPages);
 
-                oc_path_elt* elements = font->outlines + font->outlineCount;
-                font->outlineCount += vertexCount;
-                oc_vec2 currentPos = { 0, 0 };
+        oc_list_push(&oc_graphicsData.fontFreeList, &fontData->freeListElt);
+        oc_graphics_handle_recycle(fontHandle.h);
+    }
+}
 
-                for(int vertIndex = 0; vertIndex < vertexCount; vertIndex++)
-                {
-                    f32 x = vertices[vertIndex].x;
-                    f32 y = vertices[vertIndex].y;
-                    f32 cx = vertices[vertIndex].cx;
-                    f32 cy = vertices[vertIndex].cy;
-                    f32 cx1 = vertices[vertIndex].cx1;
-                    f32 cy1 = vertices[vertIndex].cy1;
-
-                    switch(vertices[vertIndex].type)
-                    {
-                        case STBTT_vmove:
-                            elements[vertIndex].type = OC_PATH_MOVE;
-                            elements[vertIndex].p[0] = (oc_vec2){ x, y };
-                            break;
-
-                        case STBTT_vline:
-                            elements[vertIndex].type = OC_PATH_LINE;
-                            elements[vertIndex].p[0] = (oc_vec2){ x, y };
-                            break;
-
-                        case STBTT_vcurve:
-                        {
-                            elements[vertIndex].type = OC_PATH_QUADRATIC;
-                            elements[vertIndex].p[0] = (oc_vec2){ cx, cy };
-                            elements[vertIndex].p[1] = (oc_vec2){ x, y };
-                        }
-                        break;
-
-                        case STBTT_vcubic:
-                            elements[vertIndex].type = OC_PATH_CUBIC;
-                            elements[vertIndex].p[0] = (oc_vec2){ cx, cy };
-                            elements[vertIndex].p[1] = (oc_vec2){ cx1, cy1 };
-                            elements[vertIndex].p[2] = (oc_vec2){ x, y };
-                            break;
-                    }
-                    currentPos = (oc_vec2){ x, y };
-                }
-                stbtt_FreeShape(&stbttFontInfo, vertices);
-                codePoint++;
-            }
+u32 oc_font_get_glyph_index_from_font_data(oc_font_data* fontData, oc_utf32 codePoint)
+{
+    u32 glyphIndex = 0;
+    if(codePoint < OC_FONT_CMAP_PAGE_COUNT * OC_FONT_CMAP_PAGE_SIZE)
+    {
+        u32 page = fontData->cmapPageIndices[codePoint / OC_FONT_CMAP_PAGE_SIZE];
+        if(page)
+        {
+            glyphIndex = fontData->cmapPages[(page - 1) * OC_FONT_CMAP_PAGE_SIZE + codePoint % OC_FONT_CMAP_PAGE_SIZE];
         }
     }
-    return (fontHandle);
+    return (glyphIndex);
 }
 
-oc_font oc_font_create_from_file(oc_file file, u32 rangeCount, oc_unicode_range* ranges)
+oc_str32 oc_font_get_glyph_indices_from_font_data(oc_font_data* fontData, oc_str32 codePoints, oc_str32 backing)
 {
-    oc_font font = oc_font_nil();
-    oc_arena_scope scratch = oc_scratch_begin();
-
-    u64 size = oc_file_size(file);
-    char* buffer = oc_arena_push(scratch.arena, size);
-    u64 read = oc_file_read(file, size, buffer);
+    u64 count = oc_min(codePoints.len, backing.len);
 
-    if(read != size)
+    for(int i = 0; i < count; i++)
     {
-        oc_log_error("Couldn't read font data\n");
+        backing.ptr[i] = oc_font_get_glyph_index_from_font_data(fontData, codePoints.ptr[i]);
     }
-    else
+    oc_str32 res = { .ptr = backing.ptr, .len = count };
+    return (res);
+}
+
+oc_str32 oc_font_get_glyph_indices(oc_font font, oc_str32 codePoints, oc_str32 backing)
+{
+    oc_font_data* fontData = oc_font_data_from_handle(font);
+    if(!fontData)
     {
-        font = oc_font_create_from_memory(oc_str8_from_buffer(size, buffer), rangeCount, ranges);
+        return ((oc_str32){ 0 });
     }
+    return (oc_font_get_glyph_indices_from_font_data(fontData, codePoints, backing));
+}
 
-    oc_scratch_end(scratch);
-    return (font);
+oc_path_elt* oc_font_push_outlines(oc_font_data* fontData, u32 count)
+{
+    if(fontData->outlineCount + count > fontData->outlineCapacity)
+    {
+        u32 capacity = oc_max(oc_max(fontData->outlineCapacity * 2, fontData->outlineCount + count), 1024);
+        oc_path_elt* outlines = realloc(fontData->outlines, capacity * sizeof(oc_path_elt));
+        if(!outlines)
+        {
+            return (0);
+        }
+        fontData->outlines = outlines;
+        fontData->outlineCapacity = capacity;
+    }
+    oc_path_elt* elements = fontData->outlines + fontData->outlineCount;
+    fontData->outlineCount += count;
+    return (elements);
 }
 
-oc_font oc_font_create_from_path(oc_str8 path, u32 rangeCount, oc_unicode_range* ranges)
+void oc_font_load_glyph(oc_font_data* font, u32 glyphIndex, oc_glyph_data* glyph)
 {
-    oc_font font = oc_font_nil();
+    memset(glyph, 0, sizeof(*glyph));
+    glyph->loaded = true;
 
-    oc_file file = oc_file_open(path, OC_FILE_ACCESS_READ, OC_FILE_OPEN_NONE);
-    if(oc_file_last_error(file) != OC_IO_OK)
+    //NOTE: find the glyph's codepoint
+    oc_utf32 codePoint = 0;
+    bool found = false;
+    for(int rangeIndex = 0; rangeIndex < font->rangeCount; rangeIndex++)
     {
-        oc_log_error("Could not open file %*.s\n", oc_str8_ip(path));
+        oc_glyph_map_entry* entry = &font->glyphMap[rangeIndex];
+        if(glyphIndex >= entry->firstGlyphIndex
+           && glyphIndex < entry->firstGlyphIndex + entry->range.count)
+        {
+            codePoint = entry->range.firstCodePoint + (glyphIndex - entry->firstGlyphIndex);
+            found = true;
+            break;
+        }
     }
-    else
+
+    int stbttGlyphIndex = found ? stbtt_FindGlyphIndex(&font->stbttInfo, codePoint) : 0;
+    if(stbttGlyphIndex == 0)
     {
-        font = oc_font_create_from_file(file, rangeCount, ranges);
+        //NOTE(martin): the codepoint is not found in the font
+        return;
     }
-    oc_file_close(file);
 
-    return (font);
-}
+    glyph->exists = true;
+    glyph->codePoint = codePoint;
 
-void oc_font_destroy(oc_font fontHandle)
-{
-    oc_font_data* fontData = oc_font_data_from_handle(fontHandle);
-    if(fontData)
-    {
-        free(fontData->glyphMap);
-        free(fontData->glyphs);
-        free(fontData->outlines);
+    //NOTE(martin): load glyph metric
+    int xAdvance, xBearing, x0, y0, x1, y1;
+    stbtt_GetGlyphHMetrics(&font->stbttInfo, stbttGlyphIndex, &xAdvance, &xBearing);
+    stbtt_GetGlyphBox(&font->stbttInfo, stbttGlyphIndex, &x0, &y0, &x1, &y1);
 
-        oc_list_push(&oc_graphicsData.fontFreeList, &fontData->freeListElt);
-        oc_graphics_handle_recycle(fontHandle.h);
+    //NOTE(martin): stb stbtt_GetGlyphBox returns bottom left and top right corners, with y up,
+    //              so we have to set .y = -y1
+    glyph->metrics.ink = (oc_rect){
+        .x = x0,
+        .y = -y1,
+        .w = x1 - x0,
+        .h = y1 - y0
+    };
+
+    glyph->metrics.advance = (oc_vec2){ xAdvance, 0 };
+
+    //NOTE(martin): load glyph outlines
+    stbtt_vertex* vertices = 0;
+    int vertexCount = stbtt_GetGlyphShape(&font->stbttInfo, stbttGlyphIndex, &vertices);
+
+    u32 startIndex = font->outlineCount;
+    oc_path_elt* elements = oc_font_push_outlines(font, vertexCount);
+    if(!elements)
+    {
+        oc_log_error("couldn't allocate glyph outlines\n");
+        vertexCount = 0;
     }
-}
 
-oc_str32 oc_font_get_glyph_indices_from_font_data(oc_font_data* fontData, oc_str32 codePoints, oc_str32 backing)
-{
-    u64 count = oc_min(codePoints.len, backing.len);
+    glyph->pathDescriptor = (oc_path_descriptor){ .startIndex = startIndex,
+                                                  .count = vertexCount,
+                                                  .startPoint = { 0, 0 } };
 
-    for(int i = 0; i < count; i++)
+    for(int vertIndex = 0; vertIndex < vertexCount; vertIndex++)
     {
-        u32 glyphIndex = 0;
-        for(int rangeIndex = 0; rangeIndex < fontData->rangeCount; rangeIndex++)
+        f32 x = vertices[vertIndex].x;
+        f32 y = vertices[vertIndex].y;
+        f32 cx = vertices[vertIndex].cx;
+        f32 cy = vertices[vertIndex].cy;
+        f32 cx1 = vertices[vertIndex].cx1;
+        f32 cy1 = vertices[vertIndex].cy1;
+
+        switch(vertices[vertIndex].type)
         {
-            if(codePoints.ptr[i] >= fontData->glyphMap[rangeIndex].range.firstCodePoint
-               && codePoints.ptr[i] < (fontData->glyphMap[rangeIndex].range.firstCodePoint + fontData->glyphMap[rangeIndex].range.count))
-            {
-                u32 rangeOffset = codePoints.ptr[i] - fontData->glyphMap[rangeIndex].range.firstCodePoint;
-                glyphIndex = fontData->glyphMap[rangeIndex].firstGlyphIndex + rangeOffset;
+            case STBTT_vmove:
+                elements[vertIndex].type = OC_PATH_MOVE;
+                elements[vertIndex].p[0] = (oc_vec2){ x, y };
+                break;
+
+            case STBTT_vline:
+                elements[vertIndex].type = OC_PATH_LINE;
+                elements[vertIndex].p[0] = (oc_vec2){ x, y };
                 break;
+
+            case STBTT_vcurve:
+            {
+                elements[vertIndex].type = OC_PATH_QUADRATIC;
+                elements[vertIndex].p[0] = (oc_vec2){ cx, cy };
+                elements[vertIndex].p[1] = (oc_vec2){ x, y };
             }
+            break;
+
+            case STBTT_vcubic:
+                elements[vertIndex].type = OC_PATH_CUBIC;
+                elements[vertIndex].p[0] = (oc_vec2){ cx, cy };
+                elements[vertIndex].p[1] = (oc_vec2){ cx1, cy1 };
+                elements[vertIndex].p[2] = (oc_vec2){ x, y };
+                break;
         }
-        if(glyphIndex && !fontData->glyphs[glyphIndex].exists)
-        {
-            backing.ptr[i] = 0;
-        }
-        backing.ptr[i] = glyphIndex;
     }
-    oc_str32 res = { .ptr = backing.ptr, .len = count };
-    return (res);
+    stbtt_FreeShape(&font->stbttInfo, vertices);
 }
 
-u32 oc_font_get_glyph_index_from_font_data(oc_font_data* fontData, oc_utf32 codePoint)
+oc_glyph_data* oc_font_get_glyph_data(oc_font_data* fontData, u32 glyphIndex)
 {
-    u32 glyphIndex = 0;
-    oc_str32 codePoints = { .ptr = &codePoint, .len = 1 };
-    oc_str32 backing = { .ptr = &glyphIndex, 1 };
-    oc_font_get_glyph_indices_from_font_data(fontData, codePoints, backing);
-    return (glyphIndex);
-}
+    OC_DEBUG_ASSERT(glyphIndex);
+    OC_DEBUG_ASSERT(glyphIndex < fontData->glyphCount);
 
-oc_str32 oc_font_get_glyph_indices(oc_font font, oc_str32 codePoints, oc_str32 backing)
-{
-    oc_font_data* fontData = oc_font_data_from_handle(font);
-    if(!fontData)
+    oc_glyph_data* glyph = &(fontData->glyphs[glyphIndex - 1]);
+    if(!glyph->loaded && !fontData->fromCache)
     {
-        return ((oc_str32){ 0 });
+        oc_font_load_glyph(fontData, glyphIndex, glyph);
     }
-    return (oc_font_get_glyph_indices_from_font_data(fontData, codePoints, backing));
+    return (glyph);
 }
 
-oc_str32 oc_font_push_glyph_indices(oc_arena* arena, oc_font font, oc_str32 codePoints)
+//NOTE: font caches are a serialized form of a font's glyph map, metrics and outlines. They can be created offline with
+//      oc_font_push_cache(), and loaded without parsing the font file. The cache doesn't contain pointers, and has the
+//      same layout on the host and in wasm guests.
+enum
 {
-    u32* buffer = oc_arena_push_array(arena, u32, codePoints.len);
-    oc_str32 backing = { .ptr = buffer, .len = codePoints.len };
-    return (oc_font_get_glyph_indices(font, codePoints, backing));
-}
+    OC_FONT_CACHE_MAGIC = 0x6366636f, // 'ocfc'
+    OC_FONT_CACHE_VERSION = 1,
+};
 
-u32 oc_font_get_glyph_index(oc_font font, oc_utf32 codePoint)
+typedef struct oc_font_cache_header
 {
-    u32 glyphIndex = 0;
-    oc_str32 codePoints = { .ptr = &codePoint, .len = 1 };
-    oc_str32 backing = { .ptr = &glyphIndex, .len = 1 };
-    oc_font_get_glyph_indices(font, codePoints, backing);
-    return (glyphIndex);
-}
+    u32 magic;
+    u32 version;
 
-oc_glyph_data* oc_font_get_glyph_data(oc_font_data* fontData, u32 glyphIndex)
-{
-    OC_DEBUG_ASSERT(glyphIndex);
-    OC_DEBUG_ASSERT(glyphIndex < fontData->glyphCount);
-    return (&(fontData->glyphs[glyphIndex - 1]));
-}
+    f32 unitsPerEm;
+    oc_font_metrics metrics;
 
-oc_font_metrics oc_font_get_metrics_unscaled(oc_font font)
+    u32 rangeCount;
+    u32 glyphCount;
+    u32 outlineCount;
+
+    u32 glyphMapOffset;
+    u32 glyphsOffset;
+    u32 outlinesOffset;
+
+} oc_font_cache_header;
+
+void oc_font_load_all_glyphs(oc_font_data* fontData)
 {
-    oc_font_data* fontData = oc_font_data_from_handle(font);
-    if(!fontData)
+    if(!fontData->fromCache)
     {
-        return ((oc_font_metrics){ 0 });
+        for(u32 glyphIndex = 1; glyphIndex <= fontData->glyphCount; glyphIndex++)
+        {
+            oc_glyph_data* glyph = &fontData->glyphs[glyphIndex - 1];
+            if(!glyph->loaded)
+            {
+                oc_font_load_glyph(fontData, glyphIndex, glyph);
+            }
+        }
     }
-    return (fontData->metrics);
 }
 
-oc_font_metrics oc_font_get_metrics(oc_font font, f32 emSize)
+u64 oc_font_cache_size(oc_font font)
 {
     oc_font_data* fontData = oc_font_data_from_handle(font);
     if(!fontData)
     {
-        return ((oc_font_metrics){ 0 });
+        return (0);
     }
-    f32 scale = emSize / fontData->unitsPerEm;
-    oc_font_metrics metrics = fontData->metrics;
+    oc_font_load_all_glyphs(fontData);
 
-    metrics.ascent *= scale;
-    metrics.descent *= scale;
-    metrics.lineGap *= scale;
-    metrics.xHeight *= scale;
-    metrics.capHeight *= scale;
-    metrics.width *= scale;
+    u64 glyphMapOffset = oc_align_up_pow2(sizeof(oc_font_cache_header), 8);
+    u64 glyphsOffset = oc_align_up_pow2(glyphMapOffset + fontData->rangeCount * sizeof(oc_glyph_map_entry), 8);
+    u64 outlinesOffset = oc_align_up_pow2(glyphsOffset + fontData->glyphCount * sizeof(oc_glyph_data), 8);
+    u64 size = outlinesOffset + fontData->outlineCount * sizeof(oc_path_elt);
 
-    return (metrics);
+    if(size > UINT32_MAX)
+    {
+        oc_log_error("font is too big to be cached\n");
+        size = 0;
+    }
+    return (size);
 }
 
-f32 oc_font_get_scale_for_em_pixels(oc_font font, f32 emSize)
+u64 oc_font_write_cache(oc_font font, u64 size, char* buffer)
 {
     oc_font_data* fontData = oc_font_data_from_handle(font);
-    if(!fontData)
+    if(!fontData || !size || size != oc_font_cache_size(font))
     {
         return (0);
     }
-    return (emSize / fontData->unitsPerEm);
-}
 
-////////////////////////////////////////////////////////////////////////////////////////////::
-void oc_font_get_glyph_metrics_from_font_data(oc_font_data* fontData,
-                                              oc_str32 glyphIndices,
+    u64 glyphMapOffset = oc_align_up_pow2(sizeof(oc_font_cache_header), 8);
+    u64 glyphsOffset = oc_align_up_pow2(glyphMapOffset + fontData->rangeCount * sizeof(oc_glyph_map_entry), 8);
+    u64 outlinesOffset = oc_align_up_pow2(glyphsOffset + fontData->glyphCount * sizeof(oc_glyph_data), 8);
+
+    memset(buffer, 0, size);
+
+    oc_font_cache_header header = {
+        .magic = OC_FONT_CACHE_MAGIC,
+        .version = OC_FONT_CACHE_VERSION,
+        .unitsPerEm = fontData->unitsPerEm,
+        .metrics = fontData->metrics,
+        .rangeCount = fontData->rangeCount,
+        .glyphCount = fontData->glyphCount,
+        .outlineCount = fontData->outlineCount,
+        .glyphMapOffset = glyphMapOffset,
+        .glyphsOffset = glyphsOffset,
+        .outlinesOffset = outlinesOffset,
+    };
+    memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + glyphMapOffset, fontData->glyphMap, fontData->rangeCount * sizeof(oc_glyph_map_entry));
+    memcpy(buffer + glyphsOffset, fontData->glyphs, fontData->glyphCount * sizeof(oc_glyph_data));
+    memcpy(buffer + outlinesOffset, fontData->outlines, fontData->outlineCount * sizeof(oc_path_elt));
+
+    return (size);
+}
+
+oc_font oc_font_create_from_cache_buffer(char* buffer, u64 len, bool owned)
+{
+    oc_font fontHandle = oc_font_nil();
+
+    oc_font_cache_header* header = (oc_font_cache_header*)buffer;
+    if(len < sizeof(oc_font_cache_header)
+       || header->magic != OC_FONT_CACHE_MAGIC
+       || header->version != OC_FONT_CACHE_VERSION
+       || header->glyphMapOffset + (u64)header->rangeCount * sizeof(oc_glyph_map_entry) > len
+       || header->glyphsOffset + (u64)header->glyphCount * sizeof(oc_glyph_data) > len
+       || header->outlinesOffset + (u64)header->outlineCount * sizeof(oc_path_elt) > len)
+    {
+        oc_log_error("invalid font cache\n");
+        if(owned)
+        {
+            free(buffer);
+        }
+        return (fontHandle);
+    }
+
+    //NOTE: check that glyph indices and outlines stay in bounds
+    oc_glyph_map_entry* glyphMap = (oc_glyph_map_entry*)(buffer + header->glyphMapOffset);
+    oc_glyph_data* glyphs = (oc_glyph_data*)(buffer + header->glyphsOffset);
+    bool valid = true;
+    for(u32 i = 0; i < header->rangeCount && valid; i++)
+    {
+        valid = glyphMap[i].firstGlyphIndex
+             && (u64)glyphMap[i].firstGlyphIndex + glyphMap[i].range.count <= (u64)header->glyphCount + 1;
+    }
+    for(u32 i = 0; i < header->glyphCount && valid; i++)
+    {
+        valid = (u64)glyphs[i].pathDescriptor.startIndex + glyphs[i].pathDescriptor.count <= header->outlineCount;
+    }
+    if(!valid)
+    {
+        oc_log_error("invalid font cache\n");
+        if(owned)
+        {
+            free(buffer);
+        }
+        return (fontHandle);
+    }
+
+    oc_font_data* font = oc_font_data_alloc(&fontHandle);
+    if(font)
+    {
+        font->fromCache = true;
+        font->cacheBuffer = owned ? buffer : 0;
+
+        font->unitsPerEm = header->unitsPerEm;
+        font->metrics = header->metrics;
+        font->rangeCount = header->rangeCount;
+        font->glyphCount = header->glyphCount;
+        font->outlineCount = header->outlineCount;
+        font->outlineCapacity = header->outlineCount;
+        font->glyphMap = (oc_glyph_map_entry*)(buffer + header->glyphMapOffset);
+        font->glyphs = (oc_glyph_data*)(buffer + header->glyphsOffset);
+        font->outlines = (oc_path_elt*)(buffer + header->outlinesOffset);
+
+        oc_font_build_cmap(font);
+    }
+    else if(owned)
+    {
+        free(buffer);
+    }
+    return (fontHandle);
+}
+
+oc_font oc_font_create_from_cache_copy(u64 len, char* mem)
+{
+    oc_font font = oc_font_nil();
+    char* buffer = oc_malloc_array(char, len);
+    if(buffer)
+    {
+        memcpy(buffer, mem, len);
+        font = oc_font_create_from_cache_buffer(buffer, len, true);
+    }
+    return (font);
+}
+
+oc_font oc_font_create_from_cache_memory(oc_str8 mem)
+{
+    oc_font font = oc_font_nil();
+    if((u64)mem.ptr & 7)
+    {
+        //NOTE: the cache is used in place, so copy it if it's not aligned
+        font = oc_font_create_from_cache_copy(mem.len, mem.ptr);
+    }
+    else
+    {
+        font = oc_font_create_from_cache_buffer(mem.ptr, mem.len, false);
+    }
+    return (font);
+}
+
+oc_font oc_font_create_from_buffer(u64 len, char* mem, u32 rangeCount, oc_unicode_range* ranges)
+{
+    return (oc_font_create_from_memory(oc_str8_from_buffer(len, mem), rangeCount, ranges));
+}
+
+oc_font_metrics oc_font_get_metrics_unscaled(oc_font font)
+{
+    oc_font_data* fontData = oc_font_data_from_handle(font);
+    if(!fontData)
+    {
+        return ((oc_font_metrics){ 0 });
+    }
+    return (fontData->metrics);
+}
+
+oc_font_metrics oc_font_get_metrics(oc_font font, f32 emSize)
+{
+    oc_font_data* fontData = oc_font_data_from_handle(font);
+    if(!fontData)
+    {
+        return ((oc_font_metrics){ 0 });
+    }
+    f32 scale = emSize / fontData->unitsPerEm;
+    oc_font_metrics metrics = fontData->metrics;
+
+    metrics.ascent *= scale;
+    metrics.descent *= scale;
+    metrics.lineGap *= scale;
+    metrics.xHeight *= scale;
+    metrics.capHeight *= scale;
+    metrics.width *= scale;
+
+    return (metrics);
+}
+
+f32 oc_font_get_scale_for_em_pixels(oc_font font, f32 emSize)
+{
+    oc_font_data* fontData = oc_font_data_from_handle(font);
+    if(!fontData)
+    {
+        return (0);
+    }
+    return (emSize / fontData->unitsPerEm);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////::
+void oc_font_get_glyph_metrics_from_font_data(oc_font_data* fontData,
+                                              oc_str32 glyphIndices,
                                               oc_glyph_metrics* outMetrics)
 {
     for(int i = 0; i < glyphIndices.len; i++)
@@ -760,95 +1047,366 @@ int oc_font_get_codepoint_metrics(oc_font font, oc_utf32 codePoint, oc_text_metr
 */
 /////////////////////////////////////////////////
 
-oc_text_metrics oc_font_text_metrics_utf32(oc_font font, f32 fontSize, oc_str32 codePoints)
+//NOTE: the following procedures are used by the canvas to query fonts. In wasm guests, they are imported from the host
+//      (see font_api.json), and take plain buffers so that they can be bound without extra marshalling.
+
+u32 oc_font_lookup_glyph_indices(oc_font font, u32 count, u32* codePoints, u32* glyphIndices)
 {
-    if(!codePoints.len || !codePoints.ptr)
+    oc_str32 res = oc_font_get_glyph_indices(font,
+                                             (oc_str32){ .ptr = codePoints, .len = count },
+                                             (oc_str32){ .ptr = glyphIndices, .len = count });
+    return (res.len);
+}
+
+void oc_font_lookup_glyph_metrics(oc_font font, u32 count, u32* glyphIndices, oc_glyph_metrics* metrics)
+{
+    memset(metrics, 0, count * sizeof(oc_glyph_metrics));
+    oc_font_data* fontData = oc_font_data_from_handle(font);
+    if(fontData)
     {
-        return ((oc_text_metrics){ 0 });
+        oc_font_get_glyph_metrics_from_font_data(fontData, (oc_str32){ .ptr = glyphIndices, .len = count }, metrics);
     }
+}
+
+oc_text_metrics oc_font_measure_utf8(oc_font font, f32 fontSize, u64 len, char* text)
+{
+    return (oc_font_text_metrics(font, fontSize, oc_str8_from_buffer(len, text)));
+}
+
+oc_text_metrics oc_font_measure_utf32(oc_font font, f32 fontSize, u64 count, u32* codePoints)
+{
+    return (oc_font_text_metrics_utf32(font, fontSize, (oc_str32){ .ptr = codePoints, .len = count }));
+}
 
+u32 oc_font_emit_glyph_outlines(oc_font font, u32 glyphIndex, oc_vec2 origin, f32 scale, f32 flip, u32 capacity, oc_path_elt* elements)
+{
     oc_font_data* fontData = oc_font_data_from_handle(font);
-    if(!fontData)
+    if(!fontData || !glyphIndex || glyphIndex >= fontData->glyphCount)
     {
-        return ((oc_text_metrics){ 0 });
+        return (0);
+    }
+
+    oc_glyph_data* glyph = oc_font_get_glyph_data(fontData, glyphIndex);
+    u32 count = glyph->pathDescriptor.count;
+    if(count > capacity)
+    {
+        oc_log_error("not enough space for glyph outlines\n");
+        return (0);
+    }
+
+    memcpy(elements, fontData->outlines + glyph->pathDescriptor.startIndex, count * sizeof(oc_path_elt));
+    for(int eltIndex = 0; eltIndex < count; eltIndex++)
+    {
+        for(int pIndex = 0; pIndex < 3; pIndex++)
+        {
+            elements[eltIndex].p[pIndex].x = elements[eltIndex].p[pIndex].x * scale + origin.x;
+            elements[eltIndex].p[pIndex].y = elements[eltIndex].p[pIndex].y * scale * flip + origin.y;
+        }
+    }
+    return (count);
+}
+
+int oc_font_find_stbtt_glyph(oc_font_data* fontData, u32 glyphIndex)
+{
+    //NOTE: fonts loaded from a cache don't have a font file, so they can't be rasterized
+    int stbttGlyphIndex = 0;
+    if(fontData->blob && glyphIndex && glyphIndex < fontData->glyphCount)
+    {
+        oc_glyph_data* glyph = oc_font_get_glyph_data(fontData, glyphIndex);
+        if(glyph->exists)
+        {
+            stbttGlyphIndex = stbtt_FindGlyphIndex(&fontData->stbttInfo, glyph->codePoint);
+        }
     }
+    return (stbttGlyphIndex);
+}
 
+oc_rect oc_font_glyph_bitmap_box(oc_font font, u32 glyphIndex, f32 scale, f32 shiftX)
+{
+    oc_rect box = { 0 };
+    oc_font_data* fontData = oc_font_data_from_handle(font);
+    int stbttGlyphIndex = fontData ? oc_font_find_stbtt_glyph(fontData, glyphIndex) : 0;
+    if(stbttGlyphIndex)
+    {
+        int x0, y0, x1, y1;
+        stbtt_GetGlyphBitmapBoxSubpixel(&fontData->stbttInfo, stbttGlyphIndex, scale, scale, shiftX, 0, &x0, &y0, &x1, &y1);
+        box = (oc_rect){ x0, y0, x1 - x0, y1 - y0 };
+    }
+    return (box);
+}
+
+bool oc_font_rasterize_glyph(oc_font font, u32 glyphIndex, f32 scale, f32 shiftX, u32 width, u32 height, u8* coverage)
+{
+    oc_font_data* fontData = oc_font_data_from_handle(font);
+    int stbttGlyphIndex = fontData ? oc_font_find_stbtt_glyph(fontData, glyphIndex) : 0;
+    if(stbttGlyphIndex)
+    {
+        stbtt_MakeGlyphBitmapSubpixel(&fontData->stbttInfo, coverage, width, height, width, scale, scale, shiftX, 0, stbttGlyphIndex);
+    }
+    return (stbttGlyphIndex != 0);
+}
+
+#else // OC_PLATFORM_ORCA
+
+//NOTE: in wasm guests, fonts live on the host. The oc_font API forwards to the procedures imported from font_api.json
+
+oc_font oc_font_create_from_memory(oc_str8 mem, u32 rangeCount, oc_unicode_range* ranges)
+{
+    return (oc_font_create_from_buffer(mem.len, mem.ptr, rangeCount, ranges));
+}
+
+oc_font oc_font_create_from_cache_memory(oc_str8 mem)
+{
+    return (oc_font_create_from_cache_copy(mem.len, mem.ptr));
+}
+
+oc_str32 oc_font_get_glyph_indices(oc_font font, oc_str32 codePoints, oc_str32 backing)
+{
+    u32 count = oc_min(codePoints.len, backing.len);
+    count = oc_font_lookup_glyph_indices(font, count, codePoints.ptr, backing.ptr);
+    return ((oc_str32){ .ptr = backing.ptr, .len = count });
+}
+
+#endif // OC_PLATFORM_ORCA
+
+oc_font oc_font_create_from_file(oc_file file, u32 rangeCount, oc_unicode_range* ranges)
+{
+    oc_font font = oc_font_nil();
     oc_arena_scope scratch = oc_scratch_begin();
-    oc_str32 glyphIndices = oc_font_push_glyph_indices(scratch.arena, font, codePoints);
 
-    //NOTE(martin): find width of missing character
-    //TODO(martin): should cache that at font creation...
-    oc_glyph_metrics missingGlyphMetrics = { 0 };
-    u32 missingGlyphIndex = oc_font_get_glyph_index_from_font_data(fontData, 0xfffd);
+    u64 size = oc_file_size(file);
+    char* buffer = oc_arena_push(scratch.arena, size);
+    u64 read = oc_file_read(file, size, buffer);
 
-    if(missingGlyphIndex)
+    if(read != size)
     {
-        oc_font_get_glyph_metrics_from_font_data(fontData, (oc_str32){ .ptr = &missingGlyphIndex, .len = 1 }, &missingGlyphMetrics);
+        oc_log_error("Couldn't read font data\n");
     }
     else
     {
-        //NOTE(martin): could not find replacement glyph, try to get an 'X' to get a somewhat correct dimensions
-        //              to render an empty rectangle. Otherwise just render with the max font width
+        font = oc_font_create_from_memory(oc_str8_from_buffer(size, buffer), rangeCount, ranges);
+    }
 
-        missingGlyphIndex = oc_font_get_glyph_index_from_font_data(fontData, 'X');
-        if(missingGlyphIndex)
-        {
-            oc_font_get_glyph_metrics_from_font_data(fontData, (oc_str32){ .ptr = &missingGlyphIndex, .len = 1 }, &missingGlyphMetrics);
-        }
-        else
+    oc_scratch_end(scratch);
+    return (font);
+}
+
+oc_font oc_font_create_from_path(oc_str8 path, u32 rangeCount, oc_unicode_range* ranges)
+{
+    oc_font font = oc_font_nil();
+
+    oc_file file = oc_file_open(path, OC_FILE_ACCESS_READ, OC_FILE_OPEN_NONE);
+    if(oc_file_last_error(file) != OC_IO_OK)
+    {
+        oc_log_error("Could not open file %*.s\n", oc_str8_ip(path));
+    }
+    else
+    {
+        font = oc_font_create_from_file(file, rangeCount, ranges);
+    }
+    oc_file_close(file);
+
+    return (font);
+}
+
+oc_str8 oc_font_push_cache(oc_arena* arena, oc_font font)
+{
+    oc_str8 cache = { 0 };
+    u64 size = oc_font_cache_size(font);
+    if(size)
+    {
+        char* buffer = oc_arena_push_aligned(arena, size, 8);
+        if(buffer && oc_font_write_cache(font, size, buffer) == size)
         {
-            missingGlyphMetrics = (oc_glyph_metrics){
-                .ink = {
-                    .x = fontData->metrics.width * 0.1,
-                    .y = -fontData->metrics.ascent,
-                    .w = fontData->metrics.width * 0.8,
-                    .h = fontData->metrics.ascent,
-                },
-                .advance = { .x = fontData->metrics.width, .y = 0 },
-            };
+            cache = oc_str8_from_buffer(size, buffer);
         }
     }
+    return (cache);
+}
 
-    //NOTE(martin): accumulate text extents
-    oc_text_metrics metrics = { 0 };
-    f32 lineHeight = fontData->metrics.descent + fontData->metrics.ascent + fontData->metrics.lineGap;
+oc_font oc_font_create_from_cache_file(oc_file file)
+{
+    oc_font font = oc_font_nil();
+    oc_arena_scope scratch = oc_scratch_begin();
 
-    if(glyphIndices.len)
+    u64 size = oc_file_size(file);
+    char* buffer = oc_arena_push(scratch.arena, size);
+    u64 read = oc_file_read(file, size, buffer);
+
+    if(read != size)
     {
-        metrics.logical.y = -(fontData->metrics.ascent + fontData->metrics.lineGap);
-        metrics.logical.h += lineHeight + fontData->metrics.lineGap;
+        oc_log_error("Couldn't read font cache\n");
+    }
+    else
+    {
+        font = oc_font_create_from_cache_copy(size, buffer);
     }
 
+    oc_scratch_end(scratch);
+    return (font);
+}
+
+oc_font oc_font_create_from_cache_path(oc_str8 path)
+{
+    oc_font font = oc_font_nil();
+
+    oc_file file = oc_file_open(path, OC_FILE_ACCESS_READ, OC_FILE_OPEN_NONE);
+    if(oc_file_last_error(file) != OC_IO_OK)
+    {
+        oc_log_error("Could not open file %*.s\n", oc_str8_ip(path));
+    }
+    else
+    {
+        font = oc_font_create_from_cache_file(file);
+    }
+    oc_file_close(file);
+
+    return (font);
+}
+
+oc_str32 oc_font_push_glyph_indices(oc_arena* arena, oc_font font, oc_str32 codePoints)
+{
+    u32* buffer = oc_arena_push_array(arena, u32, codePoints.len);
+    oc_str32 backing = { .ptr = buffer, .len = codePoints.len };
+    return (oc_font_get_glyph_indices(font, codePoints, backing));
+}
+
+u32 oc_font_get_glyph_index(oc_font font, oc_utf32 codePoint)
+{
+    u32 glyphIndex = 0;
+    oc_str32 codePoints = { .ptr = &codePoint, .len = 1 };
+    oc_str32 backing = { .ptr = &glyphIndex, .len = 1 };
+    oc_font_get_glyph_indices(font, codePoints, backing);
+    return (glyphIndex);
+}
+
+//------------------------------------------------------------------------------------------
+// text run cache
+//------------------------------------------------------------------------------------------
+
+//NOTE: UI labels measure and draw the same strings every frame. The glyph indices, glyph metrics and text metrics
+//      of short strings are cached by (font, size, string), so that repeated strings skip UTF-8 decoding, glyph
+//      lookup and metrics accumulation. Runs that haven't been used for OC_TEXT_RUN_CACHE_EVICT_FRAMES frames are
+//      evicted in oc_render(), and the least recently used runs are evicted when the cache is full.
+enum
+{
+    OC_TEXT_RUN_CACHE_BUCKET_COUNT = 1024,
+    OC_TEXT_RUN_CACHE_MAX_COUNT = 4096,
+    OC_TEXT_RUN_CACHE_MAX_KEY_SIZE = 1024,
+    OC_TEXT_RUN_CACHE_EVICT_FRAMES = 60,
+};
+
+typedef struct oc_text_run
+{
+    oc_list_elt bucketElt;
+    oc_list_elt lruElt;
+
+    u64 hash;
+    u64 font;
+    f32 fontSize;
+    bool utf32;
+    oc_str8 key; // the string's bytes, utf8 or utf32
+    u64 lastFrame;
+
+    oc_str32 codePoints;
+    oc_str32 glyphIndices;
+    oc_glyph_metrics* glyphMetrics; // unscaled
+    oc_text_metrics metrics;
+
+} oc_text_run;
+
+typedef struct oc_text_run_cache
+{
+    bool init;
+    u64 frame;
+    u32 runCount;
+    oc_list lru; // most recently used first
+    oc_list buckets[OC_TEXT_RUN_CACHE_BUCKET_COUNT];
+
+    u64 hits;
+    u64 misses;
+    u64 evictions;
+
+} oc_text_run_cache;
+
+static oc_text_run_cache oc_textRunCache = { 0 };
+
+oc_text_metrics oc_text_metrics_from_glyphs(oc_font font,
+                                            f32 fontSize,
+                                            oc_str32 codePoints,
+                                            oc_str32 glyphIndices,
+                                            oc_glyph_metrics* glyphMetrics)
+{
+    oc_text_metrics metrics = { 0 };
+    if(!glyphIndices.len)
+    {
+        return (metrics);
+    }
+
+    oc_font_metrics fontMetrics = oc_font_get_metrics_unscaled(font);
+
+    //NOTE(martin): find width of missing character, if needed
+    oc_glyph_metrics missingGlyphMetrics = { 0 };
+    bool missingGlyphFound = false;
+
+    //NOTE(martin): accumulate text extents
+    f32 lineHeight = fontMetrics.descent + fontMetrics.ascent + fontMetrics.lineGap;
+
+    metrics.logical.y = -(fontMetrics.ascent + fontMetrics.lineGap);
+    metrics.logical.h += lineHeight + fontMetrics.lineGap;
+
     f32 inkX0 = 0, inkX1 = 0, inkY0 = 0, inkY1 = 0;
 
     for(int i = 0; i < glyphIndices.len; i++)
     {
         //TODO(martin): make it failsafe for fonts that don't have a glyph for the line-feed codepoint ?
 
-        oc_glyph_data* glyph = 0;
-        oc_glyph_metrics glyphMetrics;
-        if(!glyphIndices.ptr[i] || glyphIndices.ptr[i] >= fontData->glyphCount)
+        oc_glyph_metrics glyphMetric = glyphMetrics[i];
+        if(!glyphIndices.ptr[i])
         {
-            glyphMetrics = missingGlyphMetrics;
-        }
-        else
-        {
-            glyph = oc_font_get_glyph_data(fontData, glyphIndices.ptr[i]);
-            glyphMetrics = glyph->metrics;
+            if(!missingGlyphFound)
+            {
+                u32 missingGlyphIndex = oc_font_get_glyph_index(font, 0xfffd);
+                if(!missingGlyphIndex)
+                {
+                    //NOTE(martin): could not find replacement glyph, try to get an 'X' to get a somewhat correct dimensions
+                    //              to render an empty rectangle. Otherwise just render with the max font width
+                    missingGlyphIndex = oc_font_get_glyph_index(font, 'X');
+                }
+
+                if(missingGlyphIndex)
+                {
+                    oc_font_lookup_glyph_metrics(font, 1, &missingGlyphIndex, &missingGlyphMetrics);
+                }
+                else
+                {
+                    missingGlyphMetrics = (oc_glyph_metrics){
+                        .ink = {
+                            .x = fontMetrics.width * 0.1,
+                            .y = -fontMetrics.ascent,
+                            .w = fontMetrics.width * 0.8,
+                            .h = fontMetrics.ascent,
+                        },
+                        .advance = { .x = fontMetrics.width, .y = 0 },
+                    };
+                }
+                missingGlyphFound = true;
+            }
+            glyphMetric = missingGlyphMetrics;
         }
 
-        inkX0 = oc_min(inkX0, metrics.advance.x + glyphMetrics.ink.x);
-        inkX1 = oc_max(inkX1, metrics.advance.x + glyphMetrics.ink.x + glyphMetrics.ink.w);
+        inkX0 = oc_min(inkX0, metrics.advance.x + glyphMetric.ink.x);
+        inkX1 = oc_max(inkX1, metrics.advance.x + glyphMetric.ink.x + glyphMetric.ink.w);
 
-        inkY0 = oc_min(inkY0, metrics.advance.y + glyphMetrics.ink.y);
-        inkY1 = oc_max(inkY1, metrics.advance.y + glyphMetrics.ink.y + glyphMetrics.ink.h);
+        inkY0 = oc_min(inkY0, metrics.advance.y + glyphMetric.ink.y);
+        inkY1 = oc_max(inkY1, metrics.advance.y + glyphMetric.ink.y + glyphMetric.ink.h);
 
-        metrics.advance.x += glyphMetrics.advance.x;
-        metrics.advance.y += glyphMetrics.advance.y;
+        metrics.advance.x += glyphMetric.advance.x;
+        metrics.advance.y += glyphMetric.advance.y;
 
         metrics.logical.w = oc_max(metrics.logical.w, metrics.advance.x);
 
-        if(glyph && glyph->codePoint == '\n')
+        if(glyphIndices.ptr[i] && codePoints.ptr[i] == '\n')
         {
             metrics.advance.y += lineHeight;
             metrics.advance.x = 0;
@@ -881,22 +1439,510 @@ oc_text_metrics oc_font_text_metrics_utf32(oc_font font, f32 fontSize, oc_str32
     metrics.advance.x *= fontScale;
     metrics.advance.y *= fontScale;
 
+    return (metrics);
+}
+
+void oc_text_run_compute(oc_text_run* run, oc_font font, f32 fontSize)
+{
+    oc_font_get_glyph_indices(font, run->codePoints, run->glyphIndices);
+    oc_font_lookup_glyph_metrics(font, run->glyphIndices.len, run->glyphIndices.ptr, run->glyphMetrics);
+    run->metrics = oc_text_metrics_from_glyphs(font, fontSize, run->codePoints, run->glyphIndices, run->glyphMetrics);
+}
+
+void oc_text_run_evict(oc_text_run_cache* cache, oc_text_run* run)
+{
+    oc_list_remove(&cache->buckets[run->hash & (OC_TEXT_RUN_CACHE_BUCKET_COUNT - 1)], &run->bucketElt);
+    oc_list_remove(&cache->lru, &run->lruElt);
+    free(run);
+    cache->runCount--;
+    cache->evictions++;
+}
+
+void oc_text_run_cache_next_frame()
+{
+    oc_text_run_cache* cache = &oc_textRunCache;
+    cache->frame++;
+
+    oc_text_run* run = oc_list_last_entry(cache->lru, oc_text_run, lruElt);
+    while(run && run->lastFrame + OC_TEXT_RUN_CACHE_EVICT_FRAMES < cache->frame)
+    {
+        oc_text_run* prev = oc_list_prev_entry(cache->lru, run, oc_text_run, lruElt);
+        oc_text_run_evict(cache, run);
+        run = prev;
+    }
+}
+
+//NOTE: returns the run of a string, from the cache if possible. If the string is too long to be cached, the run is
+//      allocated on the arena instead. One of text or codePoints is set, depending on the encoding of the string.
+oc_text_run* oc_text_run_get(oc_arena* arena, oc_font font, f32 fontSize, oc_str8 text, oc_str32 codePoints)
+{
+    oc_text_run_cache* cache = &oc_textRunCache;
+    if(!cache->init)
+    {
+        oc_list_init(&cache->lru);
+        for(int i = 0; i < OC_TEXT_RUN_CACHE_BUCKET_COUNT; i++)
+        {
+            oc_list_init(&cache->buckets[i]);
+        }
+        cache->init = true;
+    }
+
+    bool utf32 = (codePoints.ptr != 0);
+    oc_str8 key = utf32 ? oc_str8_from_buffer(codePoints.len * sizeof(u32), (char*)codePoints.ptr) : text;
+
+    if(key.len > OC_TEXT_RUN_CACHE_MAX_KEY_SIZE)
+    {
+        //NOTE: long strings are usually edited text, so we don't cache them
+        if(!utf32)
+        {
+            codePoints = oc_utf8_push_to_codepoints(arena, text);
+        }
+        oc_text_run* run = oc_arena_push_type(arena, oc_text_run);
+        memset(run, 0, sizeof(oc_text_run));
+        run->codePoints = codePoints;
+        run->glyphIndices = (oc_str32){ .ptr = oc_arena_push_array(arena, u32, codePoints.len), .len = codePoints.len };
+        run->glyphMetrics = oc_arena_push_array(arena, oc_glyph_metrics, codePoints.len);
+        oc_text_run_compute(run, font, fontSize);
+        return (run);
+    }
+
+    u32 fontSizeBits = 0;
+    memcpy(&fontSizeBits, &fontSize, sizeof(u32));
+    u64 seed = font.h ^ ((u64)fontSizeBits << 32) ^ (utf32 ? 0x9e3779b97f4a7c15ULL : 0);
+    u64 hash = oc_hash_xx64_string_seed(key, seed);
+
+    oc_list* bucket = &cache->buckets[hash & (OC_TEXT_RUN_CACHE_BUCKET_COUNT - 1)];
+    oc_list_for(*bucket, run, oc_text_run, bucketElt)
+    {
+        if(run->hash == hash
+           && run->font == font.h
+           && run->fontSize == fontSize
+           && run->utf32 == utf32
+           && run->key.len == key.len
+           && !memcmp(run->key.ptr, key.ptr, key.len))
+        {
+            run->lastFrame = cache->frame;
+            oc_list_remove(&cache->lru, &run->lruElt);
+            oc_list_push(&cache->lru, &run->lruElt);
+            cache->hits++;
+            return (run);
+        }
+    }
+    cache->misses++;
+
+    if(cache->runCount >= OC_TEXT_RUN_CACHE_MAX_COUNT)
+    {
+        oc_text_run_evict(cache, oc_list_last_entry(cache->lru, oc_text_run, lruElt));
+    }
+
+    //NOTE: decode the string in scratch memory, then allocate the run, its key and its arrays in one block
+    oc_arena_scope scratch = oc_scratch_begin_next(arena);
+    if(!utf32)
+    {
+        codePoints = oc_utf8_push_to_codepoints(scratch.arena, text);
+    }
+    u64 count = codePoints.len;
+    u64 keyOffset = oc_align_up_pow2(sizeof(oc_text_run), 8);
+    u64 metricsOffset = oc_align_up_pow2(keyOffset + key.len, 8);
+    u64 codePointsOffset = metricsOffset + count * sizeof(oc_glyph_metrics);
+    u64 glyphIndicesOffset = codePointsOffset + count * sizeof(u32);
+    u64 size = glyphIndicesOffset + count * sizeof(u32);
+
+    char* block = malloc(size);
+    if(!block)
+    {
+        oc_scratch_end(scratch);
+        return (0);
+    }
+    oc_text_run* run = (oc_text_run*)block;
+    memset(run, 0, sizeof(oc_text_run));
+
+    run->hash = hash;
+    run->font = font.h;
+    run->fontSize = fontSize;
+    run->utf32 = utf32;
+    run->key = oc_str8_from_buffer(key.len, block + keyOffset);
+    memcpy(run->key.ptr, key.ptr, key.len);
+    run->lastFrame = cache->frame;
+
+    run->glyphMetrics = (oc_glyph_metrics*)(block + metricsOffset);
+    run->codePoints = (oc_str32){ .ptr = (u32*)(block + codePointsOffset), .len = count };
+    memcpy(run->codePoints.ptr, codePoints.ptr, count * sizeof(u32));
+    run->glyphIndices = (oc_str32){ .ptr = (u32*)(block + glyphIndicesOffset), .len = count };
+
+    oc_scratch_end(scratch);
+
+    oc_text_run_compute(run, font, fontSize);
+
+    oc_list_push(bucket, &run->bucketElt);
+    oc_list_push(&cache->lru, &run->lruElt);
+    cache->runCount++;
+
+    return (run);
+}
+
+oc_text_run_cache_stats oc_text_run_cache_get_stats()
+{
+    oc_text_run_cache* cache = &oc_textRunCache;
+    oc_text_run_cache_stats stats = {
+        .hits = cache->hits,
+        .misses = cache->misses,
+        .evictions = cache->evictions,
+        .runCount = cache->runCount,
+        .hitRate = (cache->hits + cache->misses) ? (f64)cache->hits / (cache->hits + cache->misses) : 0,
+    };
+    return (stats);
+}
+
+void oc_text_run_cache_reset_stats()
+{
+    oc_textRunCache.hits = 0;
+    oc_textRunCache.misses = 0;
+    oc_textRunCache.evictions = 0;
+}
+
+oc_text_metrics oc_font_text_metrics_utf32(oc_font font, f32 fontSize, oc_str32 codePoints)
+{
+    if(!codePoints.len || !codePoints.ptr || oc_font_is_nil(font))
+    {
+        return ((oc_text_metrics){ 0 });
+    }
+
+    oc_arena_scope scratch = oc_scratch_begin();
+    oc_text_run* run = oc_text_run_get(scratch.arena, font, fontSize, (oc_str8){ 0 }, codePoints);
+    oc_text_metrics metrics = run ? run->metrics : (oc_text_metrics){ 0 };
     oc_scratch_end(scratch);
     return (metrics);
 }
 
 oc_text_metrics oc_font_text_metrics(oc_font font, f32 fontSize, oc_str8 text)
 {
-    if(!text.len || !text.ptr)
+    if(!text.len || !text.ptr || oc_font_is_nil(font))
     {
         return ((oc_text_metrics){ 0 });
     }
 
     oc_arena_scope scratch = oc_scratch_begin();
-    oc_str32 codePoints = oc_utf8_push_to_codepoints(scratch.arena, text);
-    oc_text_metrics result = oc_font_text_metrics_utf32(font, fontSize, codePoints);
+    oc_text_run* run = oc_text_run_get(scratch.arena, font, fontSize, text, (oc_str32){ 0 });
+    oc_text_metrics metrics = run ? run->metrics : (oc_text_metrics){ 0 };
     oc_scratch_end(scratch);
-    return (result);
+    return (metrics);
+}
+
+//------------------------------------------------------------------------------------------
+// glyph raster cache
+//------------------------------------------------------------------------------------------
+
+//NOTE: small glyphs are rasterized once per (font, glyph, size bucket, subpixel offset) into atlas pages owned by
+//      the surface they're drawn on. When all pages are full, the cache is flushed at the beginning of the next
+//      frame, and glyphs that don't fit in the current frame fall back to outlines.
+enum
+{
+    OC_GLYPH_CACHE_MAX_FONT_SIZE = 32,
+    OC_GLYPH_CACHE_PAGE_SIZE = 1024,
+    OC_GLYPH_CACHE_MAX_PAGES = 4,
+    OC_GLYPH_CACHE_BUCKET_COUNT = 1024,
+    OC_GLYPH_CACHE_SUBPIXEL_STEPS = 4,
+    OC_GLYPH_CACHE_SIZE_STEPS = 4, // size buckets per pixel
+};
+
+typedef struct oc_glyph_cache_page
+{
+    oc_list_elt listElt;
+    oc_image image;
+    oc_rect_atlas* atlas;
+
+} oc_glyph_cache_page;
+
+typedef struct oc_glyph_cache_entry
+{
+    oc_list_elt listElt;
+
+    u64 font;
+    u32 glyphIndex;
+    u32 sizeBucket;
+    u32 subpixel;
+
+    oc_image image;
+    oc_rect srcRegion;
+    oc_vec2 offset; // offset of the region's top left corner from the pen position, in pixels
+
+} oc_glyph_cache_entry;
+
+typedef struct oc_glyph_cache
+{
+    oc_list_elt listElt;
+    oc_surface surface;
+
+    oc_arena arena;
+    oc_list pages;
+    u32 pageCount;
+    oc_glyph_cache_page* currentPage;
+    bool needsReset;
+
+    oc_list buckets[OC_GLYPH_CACHE_BUCKET_COUNT];
+
+} oc_glyph_cache;
+
+void oc_glyph_push_outlines(oc_canvas_data* canvas, oc_font font, u32 glyphIndex, oc_vec2 origin, f32 scale, f32 flip)
+{
+    //NOTE: the font emits the transformed outlines directly at the end of the current path
+    u32 end = canvas->path.startIndex + canvas->path.count;
+    u32 capacity = OC_MAX_PATH_ELEMENT_COUNT - end - 1;
+    canvas->path.count += oc_font_emit_glyph_outlines(font, glyphIndex, origin, scale, flip, capacity, canvas->pathElements + end);
+}
+
+void oc_pending_glyphs_push_outlines(oc_canvas_data* canvas)
+{
+    for(u32 i = 0; i < canvas->pendingGlyphCount; i++)
+    {
+        oc_glyph_quad* pending = &canvas->pendingGlyphs[i];
+        f32 scale = oc_font_get_scale_for_em_pixels(pending->font, pending->fontSize);
+        oc_glyph_push_outlines(canvas, pending->font, pending->glyphIndex, pending->origin, scale, -1);
+    }
+    canvas->pendingGlyphCount = 0;
+}
+
+oc_glyph_cache* oc_glyph_cache_get(oc_surface surface)
+{
+    oc_list_for(oc_graphicsData.glyphCaches, cache, oc_glyph_cache, listElt)
+    {
+        if(cache->surface.h == surface.h)
+        {
+            return (cache);
+        }
+    }
+
+    oc_glyph_cache* cache = oc_malloc_type(oc_glyph_cache);
+    memset(cache, 0, sizeof(oc_glyph_cache));
+    cache->surface = surface;
+    oc_arena_init(&cache->arena);
+    oc_list_push(&oc_graphicsData.glyphCaches, &cache->listElt);
+
+    return (cache);
+}
+
+void oc_glyph_cache_reset(oc_glyph_cache* cache)
+{
+    oc_list_for(cache->pages, page, oc_glyph_cache_page, listElt)
+    {
+        oc_image_destroy(page->image);
+    }
+    oc_arena_clear(&cache->arena);
+
+    cache->pages = (oc_list){ 0 };
+    cache->pageCount = 0;
+    cache->currentPage = 0;
+    cache->needsReset = false;
+    memset(cache->buckets, 0, sizeof(cache->buckets));
+}
+
+void oc_glyph_cache_release(oc_surface surface)
+{
+    //NOTE: called when the surface is destroyed. The surface must be selected, so that the page images
+    //      can be destroyed.
+    oc_list_for(oc_graphicsData.glyphCaches, cache, oc_glyph_cache, listElt)
+    {
+        if(cache->surface.h == surface.h)
+        {
+            oc_glyph_cache_reset(cache);
+            oc_arena_cleanup(&cache->arena);
+            oc_list_remove(&oc_graphicsData.glyphCaches, &cache->listElt);
+            free(cache);
+            break;
+        }
+    }
+}
+
+oc_glyph_cache_page* oc_glyph_cache_add_page(oc_glyph_cache* cache)
+{
+    oc_glyph_cache_page* page = 0;
+    if(cache->pageCount < OC_GLYPH_CACHE_MAX_PAGES)
+    {
+        oc_image image = oc_image_create(cache->surface, OC_GLYPH_CACHE_PAGE_SIZE, OC_GLYPH_CACHE_PAGE_SIZE);
+        if(!oc_image_is_nil(image))
+        {
+            page = oc_arena_push_type(&cache->arena, oc_glyph_cache_page);
+            page->image = image;
+            page->atlas = oc_rect_atlas_create(&cache->arena, OC_GLYPH_CACHE_PAGE_SIZE, OC_GLYPH_CACHE_PAGE_SIZE);
+            oc_list_push_back(&cache->pages, &page->listElt);
+            cache->pageCount++;
+            cache->currentPage = page;
+        }
+    }
+    return (page);
+}
+
+oc_glyph_cache_entry* oc_glyph_cache_rasterize(oc_glyph_cache* cache,
+                                               oc_font font,
+                                               u32 glyphIndex,
+                                               u32 sizeBucket,
+                                               u32 subpixel)
+{
+    f32 pixelScale = oc_font_get_scale_for_em_pixels(font, (f32)sizeBucket / OC_GLYPH_CACHE_SIZE_STEPS);
+    f32 shiftX = (f32)subpixel / OC_GLYPH_CACHE_SUBPIXEL_STEPS;
+
+    //NOTE: the bitmap box is empty if the font can't rasterize the glyph
+    oc_rect box = oc_font_glyph_bitmap_box(font, glyphIndex, pixelScale, shiftX);
+
+    //NOTE: keep a transparent border around the glyph so that filtering doesn't pick up neighbouring glyphs
+    int glyphWidth = box.w;
+    int glyphHeight = box.h;
+    int width = glyphWidth + 2;
+    int height = glyphHeight + 2;
+
+    if(glyphWidth <= 0 || glyphHeight <= 0 || width >= OC_GLYPH_CACHE_PAGE_SIZE || height >= OC_GLYPH_CACHE_PAGE_SIZE)
+    {
+        return (0);
+    }
+
+    oc_rect rect = { 0 };
+    if(cache->currentPage)
+    {
+        rect = oc_rect_atlas_alloc(cache->currentPage->atlas, width, height);
+    }
+    if(rect.w == 0)
+    {
+        if(!oc_glyph_cache_add_page(cache))
+        {
+            cache->needsReset = true;
+            return (0);
+        }
+        rect = oc_rect_atlas_alloc(cache->currentPage->atlas, width, height);
+        if(rect.w == 0)
+        {
+            return (0);
+        }
+    }
+
+    oc_arena_scope scratch = oc_scratch_begin();
+
+    u8* coverage = oc_arena_push_array(scratch.arena, u8, glyphWidth * glyphHeight);
+    oc_font_rasterize_glyph(font, glyphIndex, pixelScale, shiftX, glyphWidth, glyphHeight, coverage);
+
+    u8* pixels = oc_arena_push_array(scratch.arena, u8, width * height * 4);
+    memset(pixels, 0, width * height * 4);
+    for(int y = 0; y < glyphHeight; y++)
+    {
+        for(int x = 0; x < glyphWidth; x++)
+        {
+            u8* pixel = pixels + ((y + 1) * width + (x + 1)) * 4;
+            pixel[0] = 255;
+            pixel[1] = 255;
+            pixel[2] = 255;
+            pixel[3] = coverage[y * glyphWidth + x];
+        }
+    }
+    oc_image_upload_region_rgba8(cache->currentPage->image, rect, pixels);
+
+    oc_scratch_end(scratch);
+
+    oc_glyph_cache_entry* entry = oc_arena_push_type(&cache->arena, oc_glyph_cache_entry);
+    memset(entry, 0, sizeof(oc_glyph_cache_entry));
+    entry->image = cache->currentPage->image;
+    entry->srcRegion = rect;
+    entry->offset = (oc_vec2){ box.x - 1, box.y - 1 };
+
+    return (entry);
+}
+
+oc_glyph_cache_entry* oc_glyph_cache_find(oc_glyph_cache* cache,
+                                          oc_font font,
+                                          u32 glyphIndex,
+                                          u32 sizeBucket,
+                                          u32 subpixel)
+{
+    u64 hash = font.h * 0x9e3779b97f4a7c15ULL;
+    hash ^= (glyphIndex + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+    hash ^= (((u64)sizeBucket << 8) | subpixel) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+    oc_list* bucket = &cache->buckets[hash & (OC_GLYPH_CACHE_BUCKET_COUNT - 1)];
+
+    oc_list_for(*bucket, entry, oc_glyph_cache_entry, listElt)
+    {
+        if(entry->font == font.h
+           && entry->glyphIndex == glyphIndex
+           && entry->sizeBucket == sizeBucket
+           && entry->subpixel == subpixel)
+        {
+            return (entry);
+        }
+    }
+
+    oc_glyph_cache_entry* entry = oc_glyph_cache_rasterize(cache, font, glyphIndex, sizeBucket, subpixel);
+    if(entry)
+    {
+        entry->font = font.h;
+        entry->glyphIndex = glyphIndex;
+        entry->sizeBucket = sizeBucket;
+        entry->subpixel = subpixel;
+        oc_list_push(bucket, &entry->listElt);
+    }
+    return (entry);
+}
+
+void oc_glyph_cache_resolve_quads(oc_canvas_data* canvas, oc_surface surface)
+{
+    oc_glyph_cache* cache = oc_glyph_cache_get(surface);
+    if(cache->needsReset)
+    {
+        oc_glyph_cache_reset(cache);
+    }
+
+    f32 scale = oc_surface_contents_scaling(surface).x;
+
+    //NOTE: glyphs that can't be cached are turned into outlines, which are pushed after the frame's path elements
+    oc_new_path(canvas);
+
+    for(u32 quadIndex = 0; quadIndex < canvas->glyphQuadCount; quadIndex++)
+    {
+        oc_glyph_quad* quad = &canvas->glyphQuads[quadIndex];
+        oc_primitive* primitive = &canvas->primitives[quad->primitiveIndex];
+
+        //NOTE: snap the pen to the pixel grid vertically, and to a subpixel step horizontally
+        oc_vec2 translation = { primitive->attributes.transform.m[2], primitive->attributes.transform.m[5] };
+        f32 penX = (quad->origin.x + translation.x) * scale;
+        f32 penY = (quad->origin.y + translation.y) * scale;
+
+        f32 pixelX = floorf(penX);
+        f32 pixelY = floorf(penY + 0.5);
+        u32 subpixel = oc_min((u32)((penX - pixelX) * OC_GLYPH_CACHE_SUBPIXEL_STEPS), OC_GLYPH_CACHE_SUBPIXEL_STEPS - 1);
+        u32 sizeBucket = (u32)roundf(quad->fontSize * scale * OC_GLYPH_CACHE_SIZE_STEPS);
+
+        oc_glyph_cache_entry* entry = 0;
+        if(sizeBucket)
+        {
+            entry = oc_glyph_cache_find(cache, quad->font, quad->glyphIndex, sizeBucket, subpixel);
+        }
+
+        if(entry)
+        {
+            oc_rect rect = {
+                (pixelX + entry->offset.x) / scale - translation.x,
+                (pixelY + entry->offset.y) / scale - translation.y,
+                entry->srcRegion.w / scale,
+                entry->srcRegion.h / scale,
+            };
+
+            oc_path_elt* elements = canvas->pathElements + primitive->path.startIndex;
+            elements[0].p[0] = (oc_vec2){ rect.x, rect.y };
+            elements[1].p[0] = (oc_vec2){ rect.x + rect.w, rect.y };
+            elements[2].p[0] = (oc_vec2){ rect.x + rect.w, rect.y + rect.h };
+            elements[3].p[0] = (oc_vec2){ rect.x, rect.y + rect.h };
+            elements[4].p[0] = (oc_vec2){ rect.x, rect.y };
+            primitive->path.startPoint = elements[0].p[0];
+
+            primitive->attributes.image = entry->image;
+            primitive->attributes.srcRegion = entry->srcRegion;
+        }
+        else
+        {
+            f32 outlineScale = oc_font_get_scale_for_em_pixels(quad->font, quad->fontSize);
+            oc_glyph_push_outlines(canvas, quad->font, quad->glyphIndex, quad->origin, outlineScale, -1);
+            primitive->path = canvas->path;
+            oc_new_path(canvas);
+        }
+    }
 }
 
 //------------------------------------------------------------------------------------------
@@ -935,10 +1981,13 @@ oc_canvas oc_canvas_create()
     if(canvas)
     {
         canvas->textFlip = false;
+        canvas->glyphRasterCache = false;
         canvas->path = (oc_path_descriptor){ 0 };
         canvas->matrixStackSize = 0;
         canvas->clipStackSize = 0;
         canvas->primitiveCount = 0;
+        canvas->pendingGlyphCount = 0;
+        canvas->glyphQuadCount = 0;
         canvas->clearColor = (oc_color){ 0, 0, 0, 0 };
 
         canvas->attributes = (oc_attributes){ 0 };
@@ -983,6 +2032,11 @@ void oc_render(oc_canvas canvas)
     oc_canvas_data* canvasData = oc_canvas_data_from_handle(canvas);
     if(canvasData && !oc_surface_is_nil(selectedSurface))
     {
+        if(canvasData->glyphQuadCount)
+        {
+            oc_glyph_cache_resolve_quads(canvasData, selectedSurface);
+        }
+
         int eltCount = canvasData->path.startIndex + canvasData->path.count;
         oc_surface_render_commands(selectedSurface,
                                    canvasData->clearColor,
@@ -992,8 +2046,12 @@ void oc_render(oc_canvas canvas)
                                    canvasData->pathElements);
 
         canvasData->primitiveCount = 0;
+        canvasData->pendingGlyphCount = 0;
+        canvasData->glyphQuadCount = 0;
         canvasData->path.startIndex = 0;
         canvasData->path.count = 0;
+
+        oc_text_run_cache_next_frame();
     }
 }
 
@@ -1190,6 +2248,15 @@ void oc_set_text_flip(bool flip)
     }
 }
 
+void oc_set_glyph_raster_cache(bool enable)
+{
+    oc_canvas_data* canvas = __mgCurrentCanvas;
+    if(canvas)
+    {
+        canvas->glyphRasterCache = enable;
+    }
+}
+
 void oc_set_image(oc_image image)
 {
     oc_canvas_data* canvas = __mgCurrentCanvas;
@@ -1309,6 +2376,17 @@ bool oc_get_text_flip()
     return (flip);
 }
 
+bool oc_get_glyph_raster_cache()
+{
+    bool enabled = false;
+    oc_canvas_data* canvas = __mgCurrentCanvas;
+    if(canvas)
+    {
+        enabled = canvas->glyphRasterCache;
+    }
+    return (enabled);
+}
+
 oc_image oc_get_image()
 {
     oc_image image = oc_image_nil();
@@ -1404,7 +2482,7 @@ void oc_close_path()
     canvas->subPathStartPoint = canvas->subPathLastPoint;
 }
 
-oc_rect oc_glyph_outlines_from_font_data(oc_font_data* fontData, oc_str32 glyphIndices)
+oc_rect oc_glyph_outlines_from_font(oc_font font, oc_str32 glyphIndices, oc_glyph_metrics* glyphMetrics)
 {
     oc_canvas_data* canvas = __mgCurrentCanvas;
 
@@ -1412,43 +2490,64 @@ oc_rect oc_glyph_outlines_from_font_data(oc_font_data* fontData, oc_str32 glyphI
     f32 startY = canvas->subPathLastPoint.y;
     f32 maxWidth = 0;
 
-    f32 scale = canvas->attributes.fontSize / fontData->unitsPerEm;
+    f32 scale = oc_font_get_scale_for_em_pixels(font, canvas->attributes.fontSize);
+    oc_font_metrics fontMetrics = oc_font_get_metrics_unscaled(font);
+
+    bool rasterize = canvas->glyphRasterCache
+                  && !canvas->textFlip
+                  && oc_image_is_nil(canvas->attributes.image)
+                  && canvas->attributes.fontSize > 0
+                  && canvas->attributes.fontSize <= OC_GLYPH_CACHE_MAX_FONT_SIZE;
+
+    //NOTE: if the metrics aren't provided by a text run, query the metrics of the whole run at once, so that
+    //      guests only do one call to the host
+    oc_arena_scope scratch = oc_scratch_begin();
+    if(!glyphMetrics)
+    {
+        glyphMetrics = oc_arena_push_array(scratch.arena, oc_glyph_metrics, glyphIndices.len);
+        oc_font_lookup_glyph_metrics(font, glyphIndices.len, glyphIndices.ptr, glyphMetrics);
+    }
 
     for(int i = 0; i < glyphIndices.len; i++)
     {
         u32 glyphIndex = glyphIndices.ptr[i];
+        oc_glyph_metrics metrics = glyphMetrics[i];
 
         f32 xOffset = canvas->subPathLastPoint.x;
         f32 yOffset = canvas->subPathLastPoint.y;
         f32 flip = canvas->textFlip ? 1 : -1;
 
-        if(!glyphIndex || glyphIndex >= fontData->glyphCount)
+        if(!glyphIndex)
         {
             oc_log_warning("code point is not present in font ranges\n");
             //NOTE(martin): try to find the replacement character
-            glyphIndex = oc_font_get_glyph_index_from_font_data(fontData, 0xfffd);
-            if(!glyphIndex)
+            glyphIndex = oc_font_get_glyph_index(font, 0xfffd);
+            if(glyphIndex)
+            {
+                oc_font_lookup_glyph_metrics(font, 1, &glyphIndex, &metrics);
+            }
+            else
             {
                 //NOTE(martin): could not find replacement glyph, try to get an 'X' to get a somewhat correct dimensions
                 //              to render an empty rectangle. Otherwise just render with the max font width
 
                 oc_glyph_metrics missingGlyphMetrics = { 0 };
-                u32 missingGlyphIndex = oc_font_get_glyph_index_from_font_data(fontData, 'X');
+                u32 missingGlyphIndex = oc_font_get_glyph_index(font, 'X');
 
                 if(missingGlyphIndex)
                 {
-                    oc_font_get_glyph_metrics_from_font_data(fontData, (oc_str32){ .ptr = &missingGlyphIndex, .len = 1 }, &missingGlyphMetrics);
+                    oc_font_lookup_glyph_metrics(font, 1, &missingGlyphIndex, &missingGlyphMetrics);
                 }
                 else
                 {
                     missingGlyphMetrics = (oc_glyph_metrics){
                         .ink = {
-                            .x = fontData->metrics.width * 0.1,
-                            .y = -fontData->metrics.ascent,
-                            .w = fontData->metrics.width * 0.8,
-                            .h = fontData->metrics.ascent,
+                            .x = fontMetrics.width * 0.1,
+                            .y = -fontMetrics.ascent,
+                            .w = fontMetrics.width * 0.8,
+                            .h = fontMetrics.ascent,
                         },
-                        .advance = { .x = fontData->metrics.width, .y = 0 },
+                        .advance = { .x = fontMetrics.width, .y = 0 },
                     };
                 }
 
@@ -1467,24 +2566,32 @@ oc_rect oc_glyph_outlines_from_font_data(oc_font_data* fontData, oc_str32 glyphI
             }
         }
 
-        oc_glyph_data* glyph = oc_font_get_glyph_data(fontData, glyphIndex);
-
-        oc_path_push_elements(canvas, glyph->pathDescriptor.count, fontData->outlines + glyph->pathDescriptor.startIndex);
-
-        oc_path_elt* elements = canvas->pathElements + canvas->path.count + canvas->path.startIndex - glyph->pathDescriptor.count;
-        for(int eltIndex = 0; eltIndex < glyph->pathDescriptor.count; eltIndex++)
+        if(rasterize && canvas->pendingGlyphCount < OC_MAX_PENDING_GLYPH_COUNT)
         {
-            for(int pIndex = 0; pIndex < 3; pIndex++)
+            //NOTE: glyphs with no ink (eg spaces) don't need a quad
+            if(metrics.ink.w > 0 && metrics.ink.h > 0)
             {
-                elements[eltIndex].p[pIndex].x = elements[eltIndex].p[pIndex].x * scale + xOffset;
-                elements[eltIndex].p[pIndex].y = elements[eltIndex].p[pIndex].y * scale * flip + yOffset;
+                canvas->pendingGlyphs[canvas->pendingGlyphCount] = (oc_glyph_quad){
+                    .font = font,
+                    .glyphIndex = glyphIndex,
+                    .fontSize = canvas->attributes.fontSize,
+                    .origin = { xOffset, yOffset },
+                    .ink = metrics.ink,
+                };
+                canvas->pendingGlyphCount++;
             }
         }
-        oc_move_to(xOffset + scale * glyph->metrics.advance.x, yOffset);
+        else
+        {
+            oc_glyph_push_outlines(canvas, font, glyphIndex, (oc_vec2){ xOffset, yOffset }, scale, flip);
+        }
+        oc_move_to(xOffset + scale * metrics.advance.x, yOffset);
 
-        maxWidth = oc_max(maxWidth, xOffset + scale * glyph->metrics.advance.x - startX);
+        maxWidth = oc_max(maxWidth, xOffset + scale * metrics.advance.x - startX);
     }
-    f32 lineHeight = (fontData->metrics.ascent + fontData->metrics.descent) * scale;
+    oc_scratch_end(scratch);
+
+    f32 lineHeight = (fontMetrics.ascent + fontMetrics.descent) * scale;
     oc_rect box = { startX, startY, maxWidth, canvas->subPathLastPoint.y - startY + lineHeight };
     return (box);
 }
@@ -1492,35 +2599,28 @@ oc_rect oc_glyph_outlines_from_font_data(oc_font_data* fontData, oc_str32 glyphI
 oc_rect oc_glyph_outlines(oc_str32 glyphIndices)
 {
     oc_canvas_data* canvas = __mgCurrentCanvas;
-    if(!canvas)
+    if(!canvas || oc_font_is_nil(canvas->attributes.font))
     {
         return ((oc_rect){ 0 });
     }
-    oc_font_data* fontData = oc_font_data_from_handle(canvas->attributes.font);
-    if(!fontData)
-    {
-        return ((oc_rect){ 0 });
-    }
-    return (oc_glyph_outlines_from_font_data(fontData, glyphIndices));
+    return (oc_glyph_outlines_from_font(canvas->attributes.font, glyphIndices, 0));
 }
 
 void oc_codepoints_outlines(oc_str32 codePoints)
 {
     oc_canvas_data* canvas = __mgCurrentCanvas;
-    if(!canvas)
-    {
-        return;
-    }
-    oc_font_data* fontData = oc_font_data_from_handle(canvas->attributes.font);
-    if(!fontData)
+    if(!canvas || oc_font_is_nil(canvas->attributes.font))
     {
         return;
     }
 
     oc_arena_scope scratch = oc_scratch_begin();
 
-    oc_str32 glyphIndices = oc_font_push_glyph_indices(scratch.arena, canvas->attributes.font, codePoints);
-    oc_glyph_outlines_from_font_data(fontData, glyphIndices);
+    oc_text_run* run = oc_text_run_get(scratch.arena, canvas->attributes.font, canvas->attributes.fontSize, (oc_str8){ 0 }, codePoints);
+    if(run)
+    {
+        oc_glyph_outlines_from_font(canvas->attributes.font, run->glyphIndices, run->glyphMetrics);
+    }
 
     oc_scratch_end(scratch);
 }
@@ -1528,21 +2628,18 @@ void oc_codepoints_outlines(oc_str32 codePoints)
 void oc_text_outlines(oc_str8 text)
 {
     oc_canvas_data* canvas = __mgCurrentCanvas;
-    if(!canvas)
-    {
-        return;
-    }
-    oc_font_data* fontData = oc_font_data_from_handle(canvas->attributes.font);
-    if(!fontData)
+    if(!canvas || oc_font_is_nil(canvas->attributes.font))
     {
         return;
     }
 
     oc_arena_scope scratch = oc_scratch_begin();
-    oc_str32 codePoints = oc_utf8_push_to_codepoints(scratch.arena, text);
-    oc_str32 glyphIndices = oc_font_push_glyph_indices(scratch.arena, canvas->attributes.font, codePoints);
 
-    oc_glyph_outlines_from_font_data(fontData, glyphIndices);
+    oc_text_run* run = oc_text_run_get(scratch.arena, canvas->attributes.font, canvas->attributes.fontSize, text, (oc_str32){ 0 });
+    if(run)
+    {
+        oc_glyph_outlines_from_font(canvas->attributes.font, run->glyphIndices, run->glyphMetrics);
+    }
 
     oc_scratch_end(scratch);
 }
@@ -1557,13 +2654,88 @@ void oc_clear()
     if(canvas)
     {
         canvas->primitiveCount = 0;
+        canvas->glyphQuadCount = 0;
         canvas->clearColor = canvas->attributes.color;
     }
 }
 
+void oc_glyph_quads_push(oc_canvas_data* canvas)
+{
+    oc_mat2x3 transform = oc_matrix_stack_top(canvas);
+    u32 count = canvas->pendingGlyphCount;
+
+    if(transform.m[0] != 1
+       || transform.m[1] != 0
+       || transform.m[3] != 0
+       || transform.m[4] != 1
+       || canvas->primitiveCount + count + 1 > OC_MAX_PRIMITIVE_COUNT
+       || canvas->glyphQuadCount + count > OC_MAX_PRIMITIVE_COUNT)
+    {
+        oc_pending_glyphs_push_outlines(canvas);
+        return;
+    }
+
+    //NOTE: fill the rest of the path first, unless it only contains the moves between glyphs
+    bool drawable = false;
+    for(u32 eltIndex = 0; eltIndex < canvas->path.count; eltIndex++)
+    {
+        if(canvas->pathElements[canvas->path.startIndex + eltIndex].type != OC_PATH_MOVE)
+        {
+            drawable = true;
+            break;
+        }
+    }
+    if(drawable)
+    {
+        oc_push_command(canvas, (oc_primitive){ .cmd = OC_CMD_FILL, .path = canvas->path });
+    }
+    canvas->path.startIndex += canvas->path.count;
+    canvas->path.count = 0;
+
+    for(u32 i = 0; i < count; i++)
+    {
+        oc_glyph_quad* quad = &canvas->pendingGlyphs[i];
+
+        //NOTE: use the glyph's ink box until the quad is resolved to its rasterized glyph in oc_render()
+        f32 scale = oc_font_get_scale_for_em_pixels(quad->font, quad->fontSize);
+        oc_rect rect = {
+            quad->origin.x + quad->ink.x * scale,
+            quad->origin.y + quad->ink.y * scale,
+            quad->ink.w * scale,
+            quad->ink.h * scale,
+        };
+
+        oc_path_elt elements[5] = {
+            { .type = OC_PATH_MOVE, .p[0] = { rect.x, rect.y } },
+            { .type = OC_PATH_LINE, .p[0] = { rect.x + rect.w, rect.y } },
+            { .type = OC_PATH_LINE, .p[0] = { rect.x + rect.w, rect.y + rect.h } },
+            { .type = OC_PATH_LINE, .p[0] = { rect.x, rect.y + rect.h } },
+            { .type = OC_PATH_LINE, .p[0] = { rect.x, rect.y } },
+        };
+        oc_path_push_elements(canvas, 5, elements);
+
+        quad->primitiveIndex = canvas->primitiveCount;
+        canvas->glyphQuads[canvas->glyphQuadCount] = *quad;
+        canvas->glyphQuadCount++;
+
+        oc_push_command(canvas, (oc_primitive){ .cmd = OC_CMD_FILL, .path = canvas->path });
+        canvas->path.startIndex += canvas->path.count;
+        canvas->path.count = 0;
+    }
+    canvas->pendingGlyphCount = 0;
+
+    //NOTE: leave the pen where the text ended, as oc_new_path() would
+    canvas->subPathStartPoint = canvas->subPathLastPoint;
+    canvas->path.startPoint = canvas->subPathStartPoint;
+}
+
 void oc_fill()
 {
     oc_canvas_data* canvas = __mgCurrentCanvas;
+    if(canvas && canvas->pendingGlyphCount)
+    {
+        oc_glyph_quads_push(canvas);
+    }
     if(canvas && canvas->path.count)
     {
         oc_push_command(canvas, (oc_primitive){ .cmd = OC_CMD_FILL, .path = canvas->path });
@@ -1574,6 +2746,10 @@ void oc_fill()
 void oc_stroke()
 {
     oc_canvas_data* canvas = __mgCurrentCanvas;
+    if(canvas && canvas->pendingGlyphCount)
+    {
+        oc_pending_glyphs_push_outlines(canvas);
+    }
     if(canvas && canvas->path.count)
     {
         oc_push_command(canvas, (oc_primitive){ .cmd = OC_CMD_STROKE, .path = canvas->path });
@@ -1730,13 +2906,47 @@ oc_image oc_image_create_from_rgba8(oc_surface surface, u32 width, u32 height, u
     return (image);
 }
 
+//NOTE: stb_image's flip setting is global, so we flip by hand to allow decoding on several threads
+oc_vec4 oc_image_src_region_uv_clamp(oc_rect srcRegion, oc_vec2 texSize)
+{
+    f32 minX = srcRegion.x + 0.5;
+    f32 minY = srcRegion.y + 0.5;
+    f32 maxX = oc_max(minX, srcRegion.x + srcRegion.w - 0.5);
+    f32 maxY = oc_max(minY, srcRegion.y + srcRegion.h - 0.5);
+
+    oc_vec4 clamp = { minX / texSize.x, minY / texSize.y, maxX / texSize.x, maxY / texSize.y };
+    return (clamp);
+}
+
+u8* oc_image_decode_rgba8(oc_str8 mem, bool flip, int* width, int* height)
+{
+    int channels;
+    u8* pixels = stbi_load_from_memory((u8*)mem.ptr, mem.len, width, height, &channels, 4);
+
+    if(pixels && flip)
+    {
+        u64 pitch = (u64)*width * 4;
+        for(int row = 0; row < *height / 2; row++)
+        {
+            u8* top = pixels + row * pitch;
+            u8* bottom = pixels + (*height - 1 - row) * pitch;
+            for(u64 i = 0; i < pitch; i++)
+            {
+                u8 tmp = top[i];
+                top[i] = bottom[i];
+                bottom[i] = tmp;
+            }
+        }
+    }
+    return (pixels);
+}
+
 oc_image oc_image_create_from_memory(oc_surface surface, oc_str8 mem, bool flip)
 {
     oc_image image = oc_image_nil();
-    int width, height, channels;
+    int width, height;
 
-    stbi_set_flip_vertically_on_load(flip ? 1 : 0);
-    u8* pixels = stbi_load_from_memory((u8*)mem.ptr, mem.len, &width, &height, &channels, 4);
+    u8* pixels = oc_image_decode_rgba8(mem, flip, &width, &height);
 
     if(pixels)
     {
@@ -1789,6 +2999,50 @@ oc_image oc_image_create_from_path(oc_surface surface, oc_str8 path, bool flip)
     return (image);
 }
 
+oc_image oc_image_create_async_from_memory(oc_surface surface, oc_str8 mem, bool flip, u32 maxSize)
+{
+    return (oc_image_create_async_from_buffer(surface, mem.len, mem.ptr, flip, maxSize));
+}
+
+oc_image oc_image_create_async_from_file(oc_surface surface, oc_file file, bool flip, u32 maxSize)
+{
+    oc_image image = oc_image_nil();
+    oc_arena_scope scratch = oc_scratch_begin();
+
+    u64 size = oc_file_size(file);
+    char* buffer = oc_arena_push(scratch.arena, size);
+    u64 read = oc_file_read(file, size, buffer);
+
+    if(read != size)
+    {
+        oc_log_error("Couldn't read image data\n");
+    }
+    else
+    {
+        image = oc_image_create_async_from_buffer(surface, size, buffer, flip, maxSize);
+    }
+
+    oc_scratch_end(scratch);
+    return (image);
+}
+
+oc_image oc_image_create_async_from_path(oc_surface surface, oc_str8 path, bool flip, u32 maxSize)
+{
+    oc_image image = oc_image_nil();
+
+    oc_file file = oc_file_open(path, OC_FILE_ACCESS_READ, OC_FILE_OPEN_NONE);
+    if(oc_file_last_error(file) != OC_IO_OK)
+    {
+        oc_log_error("Could not open file %*.s\n", oc_str8_ip(path));
+    }
+    else
+    {
+        image = oc_image_create_async_from_file(surface, file, flip, maxSize);
+    }
+    oc_file_close(file);
+    return (image);
+}
+
 void oc_image_draw_region(oc_image image, oc_rect srcRegion, oc_rect dstRegion)
 {
     oc_canvas_data* canvas = __mgCurrentCanvas;
@@ -1827,50 +3081,343 @@ void oc_image_draw(oc_image image, oc_rect rect)
 //------------------------------------------------------------------------------------------
 
 //NOTE: rectangle allocator
+//      Free space is kept as a list of disjoint free rectangles (guillotine packing). Allocations pick the free
+//      rectangle with the best short side fit, and split the leftover space along the shorter leftover axis.
+//      Recycled rectangles are merged back with adjacent free rectangles that share a full edge with them.
+//      Each allocation reserves a one pixel gap on its right and bottom sides, so that filtering doesn't pick up
+//      neighbouring rectangles.
+typedef struct oc_rect_atlas_cell
+{
+    oc_list_elt listElt;
+    i32 x;
+    i32 y;
+    i32 w;
+    i32 h;
+
+} oc_rect_atlas_cell;
+
 typedef struct oc_rect_atlas
 {
     oc_arena* arena;
     oc_vec2i size;
-    oc_vec2i pos;
-    u32 lineHeight;
+
+    oc_list freeCells;
+    oc_list usedCells;
+    oc_list cellPool;
+
+    u32 freeCount;
+    u32 usedCount;
+    u64 usedArea;
 
 } oc_rect_atlas;
 
+oc_rect_atlas_cell* oc_rect_atlas_cell_alloc(oc_rect_atlas* atlas, i32 x, i32 y, i32 w, i32 h)
+{
+    oc_rect_atlas_cell* cell = oc_list_pop_entry(&atlas->cellPool, oc_rect_atlas_cell, listElt);
+    if(!cell)
+    {
+        cell = oc_arena_push_type(atlas->arena, oc_rect_atlas_cell);
+    }
+    memset(cell, 0, sizeof(oc_rect_atlas_cell));
+    cell->x = x;
+    cell->y = y;
+    cell->w = w;
+    cell->h = h;
+    return (cell);
+}
+
+void oc_rect_atlas_push_free(oc_rect_atlas* atlas, i32 x, i32 y, i32 w, i32 h)
+{
+    if(w > 0 && h > 0)
+    {
+        oc_rect_atlas_cell* cell = oc_rect_atlas_cell_alloc(atlas, x, y, w, h);
+        oc_list_push(&atlas->freeCells, &cell->listElt);
+        atlas->freeCount++;
+    }
+}
+
+void oc_rect_atlas_reset(oc_rect_atlas* atlas)
+{
+    oc_list_for_safe(atlas->freeCells, cell, oc_rect_atlas_cell, listElt)
+    {
+        oc_list_remove(&atlas->freeCells, &cell->listElt);
+        oc_list_push(&atlas->cellPool, &cell->listElt);
+    }
+    oc_list_for_safe(atlas->usedCells, cell, oc_rect_atlas_cell, listElt)
+    {
+        oc_list_remove(&atlas->usedCells, &cell->listElt);
+        oc_list_push(&atlas->cellPool, &cell->listElt);
+    }
+    atlas->freeCount = 0;
+    atlas->usedCount = 0;
+    atlas->usedArea = 0;
+
+    oc_rect_atlas_push_free(atlas, 0, 0, atlas->size.x, atlas->size.y);
+}
+
 oc_rect_atlas* oc_rect_atlas_create(oc_arena* arena, i32 width, i32 height)
 {
     oc_rect_atlas* atlas = oc_arena_push_type(arena, oc_rect_atlas);
     memset(atlas, 0, sizeof(oc_rect_atlas));
     atlas->arena = arena;
     atlas->size = (oc_vec2i){ width, height };
+
+    oc_list_init(&atlas->freeCells);
+    oc_list_init(&atlas->usedCells);
+    oc_list_init(&atlas->cellPool);
+    oc_rect_atlas_reset(atlas);
+
     return (atlas);
 }
 
+oc_rect_atlas_cell* oc_rect_atlas_alloc_cell(oc_rect_atlas* atlas, i32 width, i32 height)
+{
+    i32 cellWidth = width + 1;
+    i32 cellHeight = height + 1;
+
+    //NOTE: find the free rectangle with the best short side fit, breaking ties with the long side
+    oc_rect_atlas_cell* best = 0;
+    i32 bestShortSide = INT32_MAX;
+    i32 bestLongSide = INT32_MAX;
+
+    oc_list_for(atlas->freeCells, cell, oc_rect_atlas_cell, listElt)
+    {
+        if(cell->w >= cellWidth && cell->h >= cellHeight)
+        {
+            i32 leftoverX = cell->w - cellWidth;
+            i32 leftoverY = cell->h - cellHeight;
+            i32 shortSide = oc_min(leftoverX, leftoverY);
+            i32 longSide = oc_max(leftoverX, leftoverY);
+
+            if(shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+            {
+                best = cell;
+                bestShortSide = shortSide;
+                bestLongSide = longSide;
+                if(longSide == 0)
+                {
+                    break;
+                }
+            }
+        }
+    }
+    if(!best)
+    {
+        return (0);
+    }
+
+    //NOTE: split the leftover space along the shorter leftover axis, so that the bigger free rectangle is kept whole
+    oc_list_remove(&atlas->freeCells, &best->listElt);
+    atlas->freeCount--;
+
+    i32 leftoverX = best->w - cellWidth;
+    i32 leftoverY = best->h - cellHeight;
+    if(leftoverX < leftoverY)
+    {
+        oc_rect_atlas_push_free(atlas, best->x + cellWidth, best->y, leftoverX, cellHeight);
+        oc_rect_atlas_push_free(atlas, best->x, best->y + cellHeight, best->w, leftoverY);
+    }
+    else
+    {
+        oc_rect_atlas_push_free(atlas, best->x + cellWidth, best->y, leftoverX, best->h);
+        oc_rect_atlas_push_free(atlas, best->x, best->y + cellHeight, cellWidth, leftoverY);
+    }
+
+    best->w = cellWidth;
+    best->h = cellHeight;
+    oc_list_push(&atlas->usedCells, &best->listElt);
+    atlas->usedCount++;
+    atlas->usedArea += (u64)width * height;
+
+    return (best);
+}
+
 oc_rect oc_rect_atlas_alloc(oc_rect_atlas* atlas, i32 width, i32 height)
 {
     oc_rect rect = { 0, 0, 0, 0 };
     if(width > 0 && height > 0)
     {
-        if(atlas->pos.x + width >= atlas->size.x)
+        oc_rect_atlas_cell* cell = oc_rect_atlas_alloc_cell(atlas, width, height);
+        if(cell)
         {
-            atlas->pos.x = 0;
-            atlas->pos.y += (atlas->lineHeight + 1);
-            atlas->lineHeight = 0;
+            rect = (oc_rect){ cell->x, cell->y, width, height };
         }
-        if(atlas->pos.x + width < atlas->size.x
-           && atlas->pos.y + height < atlas->size.y)
+    }
+    return (rect);
+}
+
+bool oc_rect_atlas_try_merge(oc_rect_atlas_cell* a, oc_rect_atlas_cell* b)
+{
+    bool merged = false;
+    if(a->y == b->y && a->h == b->h && (a->x + a->w == b->x || b->x + b->w == a->x))
+    {
+        a->x = oc_min(a->x, b->x);
+        a->w += b->w;
+        merged = true;
+    }
+    else if(a->x == b->x && a->w == b->w && (a->y + a->h == b->y || b->y + b->h == a->y))
+    {
+        a->y = oc_min(a->y, b->y);
+        a->h += b->h;
+        merged = true;
+    }
+    return (merged);
+}
+
+void oc_rect_atlas_recycle(oc_rect_atlas* atlas, oc_rect rect)
+{
+    oc_rect_atlas_cell* cell = 0;
+    oc_list_for(atlas->usedCells, used, oc_rect_atlas_cell, listElt)
+    {
+        if(used->x == (i32)rect.x
+           && used->y == (i32)rect.y
+           && used->w == (i32)rect.w + 1
+           && used->h == (i32)rect.h + 1)
         {
-            rect = (oc_rect){ atlas->pos.x, atlas->pos.y, width, height };
+            cell = used;
+            break;
+        }
+    }
+    if(!cell)
+    {
+        return;
+    }
+
+    oc_list_remove(&atlas->usedCells, &cell->listElt);
+    atlas->usedCount--;
+    atlas->usedArea -= (u64)(cell->w - 1) * (cell->h - 1);
+
+    if(!atlas->usedCount)
+    {
+        //NOTE: the atlas is empty, start over with a single free rectangle
+        oc_list_push(&atlas->cellPool, &cell->listElt);
+        oc_rect_atlas_reset(atlas);
+        return;
+    }
 
-            atlas->pos.x += (width + 1);
-            atlas->lineHeight = oc_max(atlas->lineHeight, height);
+    //NOTE: coalesce the freed rectangle with its neighbours, until no more merges are possible
+    bool merged = true;
+    while(merged)
+    {
+        merged = false;
+        oc_list_for(atlas->freeCells, other, oc_rect_atlas_cell, listElt)
+        {
+            if(oc_rect_atlas_try_merge(cell, other))
+            {
+                oc_list_remove(&atlas->freeCells, &other->listElt);
+                oc_list_push(&atlas->cellPool, &other->listElt);
+                atlas->freeCount--;
+                merged = true;
+                break;
+            }
         }
     }
-    return (rect);
+    oc_list_push(&atlas->freeCells, &cell->listElt);
+    atlas->freeCount++;
 }
 
-void oc_rect_atlas_recycle(oc_rect_atlas* atlas, oc_rect rect)
+oc_rect_atlas_stats oc_rect_atlas_get_stats(oc_rect_atlas* atlas)
+{
+    oc_rect_atlas_stats stats = {
+        .size = atlas->size,
+        .allocCount = atlas->usedCount,
+        .freeRectCount = atlas->freeCount,
+        .usedArea = atlas->usedArea,
+    };
+
+    oc_list_for(atlas->freeCells, cell, oc_rect_atlas_cell, listElt)
+    {
+        u64 area = (u64)cell->w * cell->h;
+        stats.freeArea += area;
+        stats.largestFreeArea = oc_max(stats.largestFreeArea, area);
+    }
+
+    u64 totalArea = (u64)atlas->size.x * atlas->size.y;
+    stats.occupancy = totalArea ? (f32)atlas->usedArea / totalArea : 0;
+
+    return (stats);
+}
+
+bool oc_rect_atlas_defragment(oc_rect_atlas* atlas, oc_rect_atlas_move_proc moveProc, void* user)
 {
-    //TODO
+    if(!atlas->usedCount)
+    {
+        return (true);
+    }
+
+    oc_arena_scope scratch = oc_scratch_begin_next(atlas->arena);
+
+    //NOTE: sort the live cells by decreasing height, then width
+    u32 count = atlas->usedCount;
+    oc_rect_atlas_cell** cells = oc_arena_push_array(scratch.arena, oc_rect_atlas_cell*, count);
+    u32 index = 0;
+    oc_list_for(atlas->usedCells, cell, oc_rect_atlas_cell, listElt)
+    {
+        oc_rect_atlas_cell* sorted = cell;
+        u32 i = index;
+        while(i > 0
+              && (cells[i - 1]->h < sorted->h
+                  || (cells[i - 1]->h == sorted->h && cells[i - 1]->w < sorted->w)))
+        {
+            cells[i] = cells[i - 1];
+            i--;
+        }
+        cells[i] = sorted;
+        index++;
+    }
+
+    //NOTE: repack them into a temporary atlas, and only commit the new layout if everything fits
+    oc_rect_atlas* packed = oc_rect_atlas_create(scratch.arena, atlas->size.x, atlas->size.y);
+    oc_rect_atlas_cell** packedCells = oc_arena_push_array(scratch.arena, oc_rect_atlas_cell*, count);
+    for(u32 i = 0; i < count; i++)
+    {
+        packedCells[i] = oc_rect_atlas_alloc_cell(packed, cells[i]->w - 1, cells[i]->h - 1);
+        if(!packedCells[i])
+        {
+            oc_scratch_end(scratch);
+            return (false);
+        }
+    }
+
+    //NOTE: stage all the moves, so that the caller can read every source before overwriting anything
+    oc_rect_atlas_move* moves = oc_arena_push_array(scratch.arena, oc_rect_atlas_move, count);
+    u32 moveCount = 0;
+    for(u32 i = 0; i < count; i++)
+    {
+        oc_rect_atlas_cell* from = cells[i];
+        oc_rect_atlas_cell* to = packedCells[i];
+        if(from->x != to->x || from->y != to->y)
+        {
+            moves[moveCount] = (oc_rect_atlas_move){
+                .from = { from->x, from->y, from->w - 1, from->h - 1 },
+                .to = { to->x, to->y, to->w - 1, to->h - 1 },
+            };
+            moveCount++;
+        }
+    }
+    if(moveProc && moveCount)
+    {
+        moveProc(moveCount, moves, user);
+    }
+
+    oc_rect_atlas_reset(atlas);
+    oc_list_push(&atlas->cellPool, oc_list_pop(&atlas->freeCells));
+    atlas->freeCount = 0;
+
+    oc_list_for(packed->freeCells, cell, oc_rect_atlas_cell, listElt)
+    {
+        oc_rect_atlas_push_free(atlas, cell->x, cell->y, cell->w, cell->h);
+    }
+    for(u32 i = 0; i < count; i++)
+    {
+        oc_rect_atlas_cell* cell = oc_rect_atlas_cell_alloc(atlas, packedCells[i]->x, packedCells[i]->y, packedCells[i]->w, packedCells[i]->h);
+        oc_list_push(&atlas->usedCells, &cell->listElt);
+    }
+    atlas->usedCount = count;
+    atlas->usedArea = packed->usedArea;
+
+    oc_scratch_end(scratch);
+    return (true);
 }
 
 oc_image_region oc_image_atlas_alloc_from_rgba8(oc_rect_atlas* atlas, oc_image backingImage, u32 width, u32 height, u8* pixels)
@@ -1891,10 +3438,9 @@ oc_image_region oc_image_atlas_alloc_from_memory(oc_rect_atlas* atlas, oc_image
 {
     oc_image_region imageRgn = { 0 };
 
-    int width, height, channels;
+    int width, height;
 
-    stbi_set_flip_vertically_on_load(flip ? 1 : 0);
-    u8* pixels = stbi_load_from_memory((u8*)mem.ptr, mem.len, &width, &height, &channels, 4);
+    u8* pixels = oc_image_decode_rgba8(mem, flip, &width, &height);
     if(pixels)
     {
         imageRgn = oc_image_atlas_alloc_from_rgba8(atlas, backingImage, width, height, pixels);
@@ -84,4 +84,80 @@ ORCA_API void oc_surface_render_commands(oc_surface surface,
                                          u32 eltCount,
                                          oc_path_elt* elements);
 
+//NOTE: statistics about the last oc_surface_render_commands() call on a canvas surface, shown in the debug overlay
+typedef struct oc_canvas_render_stats
+{
+    u32 primitiveCount;
+    u32 batchCount;        // the backend starts a new batch each time it runs out of image slots
+    u32 atlasedImageCount; // images currently packed in shared atlas pages
+    u32 atlasPageCount;
+    u32 atlasDefragCount;  // number of times a page was defragmented to fit a new image
+    u32 tileCount;         // for backends that track damage, number of screen tiles
+    u32 dirtyTileCount;    // and number of tiles that were redrawn
+    u32 pathCacheHitCount; // for backends that cache encoded paths, number of paths reused from the cache
+    u32 pathCacheMissCount;
+
+} oc_canvas_render_stats;
+
+ORCA_API oc_canvas_render_stats oc_surface_canvas_render_stats(oc_surface surface);
+
+//NOTE: backends clamp the texture coordinates of image samples to the box returned by oc_image_src_region_uv_clamp()
+//      (min x, min y, max x, max y, in normalized texture coordinates). It is inset by half a texel, so that bilinear
+//      taps never read outside of the source region, whatever the minification. This is what keeps images packed in
+//      atlas pages from bleeding into their neighbours.
+oc_vec4 oc_image_src_region_uv_clamp(oc_rect srcRegion, oc_vec2 texSize);
+
+//------------------------------------------------------------------------
+// canvas workers
+//------------------------------------------------------------------------
+//NOTE: the canvas backends that split their frames into jobs (GL on windows, cpu on linux) share one pool of worker
+//      threads, created by oc_graphics_init(). The metal backend doesn't use it, and wasm guests don't have threads.
+#if OC_COMPILE_CANVAS && (OC_PLATFORM_WINDOWS || OC_PLATFORM_LINUX)
+    #define OC_CANVAS_WORKERS 1
+    #include "canvas_workers.h"
+
+oc_canvas_workers* oc_graphics_canvas_workers(void);
+#endif
+
+//------------------------------------------------------------------------
+// image loading
+//------------------------------------------------------------------------
+//NOTE: images are decoded on host threads, so this is what the async image API calls, and what wasm guests import
+//      (see wasmbind/surface_api.json)
+ORCA_API oc_image oc_image_create_async_from_buffer(oc_surface surface, u64 len, char* mem, bool flip, u32 maxSize);
+
+//NOTE: whether some async images are still decoding or uploading. Uploads only progress when their surface renders,
+//      so the runtime keeps producing frames while this is true, even when the guest didn't request one.
+ORCA_API bool oc_image_loader_busy(void);
+
+u8* oc_image_decode_rgba8(oc_str8 mem, bool flip, int* width, int* height);
+
+//------------------------------------------------------------------------
+// font queries
+//------------------------------------------------------------------------
+//NOTE: fonts are owned by the host. These procedures are what the canvas and the font API use to query them, and
+//      are imported by wasm guests (see wasmbind/font_api.json). They take plain buffers rather than oc_str8/oc_str32
+//      so that they can be bound directly.
+
+ORCA_API oc_font oc_font_create_from_buffer(u64 len, char* mem, u32 rangeCount, oc_unicode_range* ranges);
+ORCA_API oc_font oc_font_create_from_cache_copy(u64 len, char* mem);
+ORCA_API u64 oc_font_cache_size(oc_font font);
+ORCA_API u64 oc_font_write_cache(oc_font font, u64 size, char* buffer);
+
+ORCA_API u32 oc_font_lookup_glyph_indices(oc_font font, u32 count, u32* codePoints, u32* glyphIndices);
+ORCA_API void oc_font_lookup_glyph_metrics(oc_font font, u32 count, u32* glyphIndices, oc_glyph_metrics* metrics);
+ORCA_API oc_text_metrics oc_font_measure_utf8(oc_font font, f32 fontSize, u64 len, char* text);
+ORCA_API oc_text_metrics oc_font_measure_utf32(oc_font font, f32 fontSize, u64 count, u32* codePoints);
+
+ORCA_API u32 oc_font_emit_glyph_outlines(oc_font font,
+                                         u32 glyphIndex,
+                                         oc_vec2 origin,
+                                         f32 scale,
+                                         f32 flip,
+                                         u32 capacity,
+                                         oc_path_elt* elements);
+
+ORCA_API oc_rect oc_font_glyph_bitmap_box(oc_font font, u32 glyphIndex, f32 scale, f32 shiftX);
+ORCA_API bool oc_font_rasterize_glyph(oc_font font, u32 glyphIndex, f32 scale, f32 shiftX, u32 width, u32 height, u8* coverage);
+
 #endif //__GRAPHICS_COMMON_H_
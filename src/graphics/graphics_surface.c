@@ -7,6 +7,7 @@
 **************************************************************************/
 
 #include "graphics_surface.h"
+#include "image_loader.h"
 
 //---------------------------------------------------------------
 // per-thread selected surface
@@ -47,6 +48,286 @@ oc_image_data* oc_image_data_from_handle(oc_image handle)
     return (data);
 }
 
+//---------------------------------------------------------------
+// image atlas pages
+//---------------------------------------------------------------
+
+//NOTE: images up to OC_IMAGE_ATLAS_MAX_IMAGE_SIZE are transparently packed into shared atlas pages, so that frames
+//      using many small images (eg sprites or icons) don't split into a batch every time the backend runs out of
+//      image slots. Backends clamp image samples to the source region (see oc_image_src_region_uv_clamp()), so that
+//      atlased images don't bleed into their neighbours at any scale. The page rectangle of an image is also surrounded
+//      by a one pixel border of its edge pixels, which guards against the limited precision of hardware filtering.
+//      Pages keep a CPU copy of their pixels, so that they can be defragmented when a new image doesn't fit.
+enum
+{
+    OC_IMAGE_ATLAS_PAGE_SIZE = 1024,
+    OC_IMAGE_ATLAS_MAX_IMAGE_SIZE = 256,
+    OC_IMAGE_ATLAS_BORDER = 1,
+};
+
+typedef struct oc_image_atlas_page
+{
+    oc_list_elt listElt;
+    oc_arena arena;
+    oc_rect_atlas* atlas;
+    oc_image image;
+    u8* pixels;
+    oc_list images;
+    u32 imageCount;
+
+} oc_image_atlas_page;
+
+oc_image_atlas_page* oc_image_atlas_page_create(oc_canvas_backend* backend, oc_surface surface)
+{
+    oc_image_atlas_page* page = 0;
+    oc_image_data* imageData = backend->imageCreate(backend, (oc_vec2){ OC_IMAGE_ATLAS_PAGE_SIZE, OC_IMAGE_ATLAS_PAGE_SIZE });
+    if(imageData)
+    {
+        imageData->surface = surface;
+        imageData->atlasPage = 0;
+
+        page = oc_malloc_type(oc_image_atlas_page);
+        memset(page, 0, sizeof(oc_image_atlas_page));
+        oc_arena_init(&page->arena);
+        page->atlas = oc_rect_atlas_create(&page->arena, OC_IMAGE_ATLAS_PAGE_SIZE, OC_IMAGE_ATLAS_PAGE_SIZE);
+        page->image = oc_image_handle_alloc(imageData);
+        page->pixels = oc_arena_push_array(&page->arena, u8, OC_IMAGE_ATLAS_PAGE_SIZE * OC_IMAGE_ATLAS_PAGE_SIZE * 4);
+        memset(page->pixels, 0, OC_IMAGE_ATLAS_PAGE_SIZE * OC_IMAGE_ATLAS_PAGE_SIZE * 4);
+
+        oc_list_append(&backend->imageAtlasPages, &page->listElt);
+        backend->stats.atlasPageCount++;
+    }
+    return (page);
+}
+
+void oc_image_atlas_page_destroy(oc_canvas_backend* backend, oc_image_atlas_page* page)
+{
+    oc_image_data* imageData = oc_image_data_from_handle(page->image);
+    if(imageData)
+    {
+        backend->imageDestroy(backend, imageData);
+    }
+    oc_graphics_handle_recycle(page->image.h);
+    oc_arena_cleanup(&page->arena);
+
+    oc_list_remove(&backend->imageAtlasPages, &page->listElt);
+    backend->stats.atlasPageCount--;
+    free(page);
+}
+
+void oc_image_atlas_pages_cleanup(oc_canvas_backend* backend)
+{
+    oc_list_for_safe(backend->imageAtlasPages, page, oc_image_atlas_page, listElt)
+    {
+        oc_image_atlas_page_destroy(backend, page);
+    }
+}
+
+typedef struct oc_image_atlas_defrag_info
+{
+    oc_canvas_backend* backend;
+    oc_image_atlas_page* page;
+} oc_image_atlas_defrag_info;
+
+void oc_image_atlas_page_move_regions(u32 count, oc_rect_atlas_move* moves, void* user)
+{
+    oc_image_atlas_defrag_info* info = (oc_image_atlas_defrag_info*)user;
+    oc_image_atlas_page* page = info->page;
+    oc_image_data* pageImage = oc_image_data_from_handle(page->image);
+
+    oc_arena_scope scratch = oc_scratch_begin();
+
+    //NOTE: destinations can overlap sources of other moves, so copy all the sources out before writing anything
+    u8** buffers = oc_arena_push_array(scratch.arena, u8*, count);
+    for(u32 i = 0; i < count; i++)
+    {
+        i32 w = moves[i].from.w;
+        i32 h = moves[i].from.h;
+        buffers[i] = oc_arena_push_array(scratch.arena, u8, w * h * 4);
+        for(i32 row = 0; row < h; row++)
+        {
+            memcpy(buffers[i] + row * w * 4,
+                   page->pixels + (((i32)moves[i].from.y + row) * OC_IMAGE_ATLAS_PAGE_SIZE + (i32)moves[i].from.x) * 4,
+                   w * 4);
+        }
+    }
+
+    for(u32 i = 0; i < count; i++)
+    {
+        i32 w = moves[i].to.w;
+        i32 h = moves[i].to.h;
+        for(i32 row = 0; row < h; row++)
+        {
+            memcpy(page->pixels + (((i32)moves[i].to.y + row) * OC_IMAGE_ATLAS_PAGE_SIZE + (i32)moves[i].to.x) * 4,
+                   buffers[i] + row * w * 4,
+                   w * 4);
+        }
+        if(pageImage)
+        {
+            info->backend->imageUploadRegion(info->backend, pageImage, moves[i].to, buffers[i]);
+        }
+    }
+    oc_scratch_end(scratch);
+
+    oc_list_for(page->images, image, oc_image_data, atlasElt)
+    {
+        for(u32 i = 0; i < count; i++)
+        {
+            if(image->atlasRegion.x == moves[i].from.x && image->atlasRegion.y == moves[i].from.y)
+            {
+                image->atlasRegion = moves[i].to;
+                break;
+            }
+        }
+    }
+}
+
+oc_image_data* oc_image_atlas_create(oc_canvas_backend* backend, oc_surface surface, u32 width, u32 height)
+{
+    i32 cellWidth = width + 2 * OC_IMAGE_ATLAS_BORDER;
+    i32 cellHeight = height + 2 * OC_IMAGE_ATLAS_BORDER;
+
+    oc_image_atlas_page* page = 0;
+    oc_rect region = { 0 };
+
+    oc_list_for(backend->imageAtlasPages, candidate, oc_image_atlas_page, listElt)
+    {
+        region = oc_rect_atlas_alloc(candidate->atlas, cellWidth, cellHeight);
+        if(region.w)
+        {
+            page = candidate;
+            break;
+        }
+    }
+    if(!page)
+    {
+        //NOTE: before creating a new page, defragment the pages that have enough free space in total
+        u64 cellArea = (u64)(cellWidth + 1) * (cellHeight + 1);
+
+        oc_list_for(backend->imageAtlasPages, candidate, oc_image_atlas_page, listElt)
+        {
+            oc_rect_atlas_stats stats = oc_rect_atlas_get_stats(candidate->atlas);
+            if(stats.freeArea >= cellArea)
+            {
+                oc_image_atlas_defrag_info info = { .backend = backend, .page = candidate };
+                if(oc_rect_atlas_defragment(candidate->atlas, oc_image_atlas_page_move_regions, &info))
+                {
+                    backend->stats.atlasDefragCount++;
+                    region = oc_rect_atlas_alloc(candidate->atlas, cellWidth, cellHeight);
+                    if(region.w)
+                    {
+                        page = candidate;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    if(!page)
+    {
+        page = oc_image_atlas_page_create(backend, surface);
+        if(page)
+        {
+            region = oc_rect_atlas_alloc(page->atlas, cellWidth, cellHeight);
+        }
+    }
+
+    oc_image_data* image = 0;
+    if(page && region.w)
+    {
+        image = oc_malloc_type(oc_image_data);
+        memset(image, 0, sizeof(oc_image_data));
+        image->size = (oc_vec2){ width, height };
+        image->atlasPage = page;
+        image->atlasRegion = region;
+        oc_list_push(&page->images, &image->atlasElt);
+
+        page->imageCount++;
+        backend->stats.atlasedImageCount++;
+    }
+    return (image);
+}
+
+void oc_image_atlas_destroy(oc_canvas_backend* backend, oc_image_data* image)
+{
+    oc_image_atlas_page* page = image->atlasPage;
+    oc_rect_atlas_recycle(page->atlas, image->atlasRegion);
+    oc_list_remove(&page->images, &image->atlasElt);
+
+    page->imageCount--;
+    backend->stats.atlasedImageCount--;
+    if(!page->imageCount)
+    {
+        oc_image_atlas_page_destroy(backend, page);
+    }
+    free(image);
+}
+
+void oc_image_atlas_upload_region(oc_canvas_backend* backend, oc_image_data* image, oc_rect region, u8* pixels)
+{
+    i32 x = region.x;
+    i32 y = region.y;
+    i32 w = region.w;
+    i32 h = region.h;
+
+    if(x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > image->size.x || y + h > image->size.y)
+    {
+        oc_log_error("upload region is outside of the image.\n");
+        return;
+    }
+
+    //NOTE: extrude the border along the edges of the image that the region touches
+    i32 left = (x == 0) ? OC_IMAGE_ATLAS_BORDER : 0;
+    i32 top = (y == 0) ? OC_IMAGE_ATLAS_BORDER : 0;
+    i32 right = (x + w == (i32)image->size.x) ? OC_IMAGE_ATLAS_BORDER : 0;
+    i32 bottom = (y + h == (i32)image->size.y) ? OC_IMAGE_ATLAS_BORDER : 0;
+
+    i32 dstWidth = left + w + right;
+    i32 dstHeight = top + h + bottom;
+
+    oc_arena_scope scratch = oc_scratch_begin();
+    u8* buffer = oc_arena_push_array(scratch.arena, u8, dstWidth * dstHeight * 4);
+
+    for(i32 row = 0; row < dstHeight; row++)
+    {
+        u8* src = pixels + oc_clamp(row - top, 0, h - 1) * w * 4;
+        u8* dst = buffer + row * dstWidth * 4;
+
+        for(i32 i = 0; i < left; i++)
+        {
+            memcpy(dst + i * 4, src, 4);
+        }
+        memcpy(dst + left * 4, src, w * 4);
+        for(i32 i = 0; i < right; i++)
+        {
+            memcpy(dst + (left + w + i) * 4, src + (w - 1) * 4, 4);
+        }
+    }
+
+    oc_image_data* pageImage = oc_image_data_from_handle(image->atlasPage->image);
+    if(pageImage)
+    {
+        oc_rect dstRegion = {
+            image->atlasRegion.x + OC_IMAGE_ATLAS_BORDER + x - left,
+            image->atlasRegion.y + OC_IMAGE_ATLAS_BORDER + y - top,
+            dstWidth,
+            dstHeight,
+        };
+        backend->imageUploadRegion(backend, pageImage, dstRegion, buffer);
+    }
+
+    oc_image_atlas_page* page = image->atlasPage;
+    for(i32 row = 0; row < dstHeight; row++)
+    {
+        memcpy(page->pixels + (((i32)image->atlasRegion.y + OC_IMAGE_ATLAS_BORDER + y - top + row) * OC_IMAGE_ATLAS_PAGE_SIZE
+                               + (i32)image->atlasRegion.x + OC_IMAGE_ATLAS_BORDER + x - left)
+                                  * 4,
+               buffer + row * dstWidth * 4,
+               dstWidth * 4);
+    }
+    oc_scratch_end(scratch);
+}
+
 //---------------------------------------------------------------
 // surface API
 //---------------------------------------------------------------
@@ -71,6 +352,8 @@ oc_image_data* oc_image_data_from_handle(oc_image handle)
 oc_surface_data* oc_mtl_canvas_surface_create_for_window(oc_window window);
     #elif OC_PLATFORM_WINDOWS
 oc_surface_data* oc_gl_canvas_surface_create_for_window(oc_window window);
+    #elif OC_PLATFORM_LINUX
+oc_surface_data* oc_headless_canvas_surface_create_for_window(oc_window window);
     #endif
 #endif
 
@@ -105,7 +388,7 @@ bool oc_is_surface_backend_available(oc_surface_api api)
 
 oc_surface oc_surface_create_for_window(oc_window window, oc_surface_api api)
 {
-    if(oc_graphicsData.init)
+    if(!oc_graphicsData.init)
     {
         oc_graphics_init();
     }
@@ -139,6 +422,8 @@ oc_surface oc_surface_create_for_window(oc_window window, oc_surface_api api)
             surface = oc_mtl_canvas_surface_create_for_window(window);
     #elif OC_PLATFORM_WINDOWS
             surface = oc_gl_canvas_surface_create_for_window(window);
+    #elif OC_PLATFORM_LINUX
+            surface = oc_headless_canvas_surface_create_for_window(window);
     #endif
             break;
 #endif
@@ -161,17 +446,29 @@ void oc_surface_destroy(oc_surface handle)
     oc_surface_data* surface = oc_surface_data_from_handle(handle);
     if(surface)
     {
-        if(oc_selectedSurface.h == handle.h)
+        //NOTE: release the surface's glyph cache while the surface is selected, since it owns images
+        oc_surface previousSurface = oc_selectedSurface;
+        oc_surface_select(handle);
+        oc_glyph_cache_release(handle);
+        oc_surface_deselect();
+
+        oc_image_loader_cancel_surface(handle);
+
+        if(surface->backend)
         {
-            oc_surface_deselect();
+            oc_image_atlas_pages_cleanup(surface->backend);
         }
-
         if(surface->backend && surface->backend->destroy)
         {
             surface->backend->destroy(surface->backend);
         }
         surface->destroy(surface);
         oc_graphics_handle_recycle(handle.h);
+
+        if(previousSurface.h != handle.h && !oc_surface_is_nil(previousSurface))
+        {
+            oc_surface_select(previousSurface);
+        }
     }
 }
 
@@ -248,6 +545,22 @@ oc_vec2 oc_surface_contents_scaling(oc_surface surface)
     return (scaling);
 }
 
+u8* oc_surface_read_pixels(oc_arena* arena, oc_surface surface, oc_vec2* size)
+{
+    OC_DEBUG_ASSERT(oc_graphicsData.init);
+    u8* pixels = 0;
+    *size = (oc_vec2){ 0 };
+    oc_surface_data* surfaceData = oc_surface_data_from_handle(surface);
+    if(surfaceData
+       && surfaceData->api == OC_CANVAS
+       && surfaceData->backend
+       && surfaceData->backend->readPixels)
+    {
+        pixels = surfaceData->backend->readPixels(surfaceData->backend, arena, size);
+    }
+    return (pixels);
+}
+
 void oc_surface_set_hidden(oc_surface surface, bool hidden)
 {
     OC_DEBUG_ASSERT(oc_graphicsData.init);
@@ -296,15 +609,59 @@ void oc_surface_render_commands(oc_surface surface,
     }
     else if(surfaceData && surfaceData->backend)
     {
-        surfaceData->backend->render(surfaceData->backend,
-                                     clearColor,
-                                     primitiveCount,
-                                     primitives,
-                                     eltCount,
-                                     elements);
+        oc_canvas_backend* backend = surfaceData->backend;
+
+        oc_image_loader_upload(surface);
+
+        oc_arena_scope scratch = oc_scratch_begin();
+
+        backend->stats.primitiveCount = primitiveCount;
+        backend->stats.batchCount = 1;
+
+        //NOTE: point primitives that use atlased images to their atlas page. The primitives are copied on the
+        //      first hit since they may live in the caller's (or the guest's) command buffer.
+        oc_primitive* remapped = primitives;
+
+        for(u32 primitiveIndex = 0; primitiveIndex < primitiveCount; primitiveIndex++)
+        {
+            oc_image image = primitives[primitiveIndex].attributes.image;
+            oc_image_data* imageData = image.h ? oc_image_data_from_handle(image) : 0;
+            if(imageData && imageData->atlasPage)
+            {
+                if(remapped == primitives)
+                {
+                    remapped = oc_arena_push_array(scratch.arena, oc_primitive, primitiveCount);
+                    memcpy(remapped, primitives, primitiveCount * sizeof(oc_primitive));
+                }
+                oc_attributes* attributes = &remapped[primitiveIndex].attributes;
+                attributes->image = imageData->atlasPage->image;
+                attributes->srcRegion.x += imageData->atlasRegion.x + OC_IMAGE_ATLAS_BORDER;
+                attributes->srcRegion.y += imageData->atlasRegion.y + OC_IMAGE_ATLAS_BORDER;
+            }
+        }
+
+        backend->render(backend,
+                        clearColor,
+                        primitiveCount,
+                        remapped,
+                        eltCount,
+                        elements);
+
+        oc_scratch_end(scratch);
     }
 }
 
+oc_canvas_render_stats oc_surface_canvas_render_stats(oc_surface surface)
+{
+    oc_canvas_render_stats stats = { 0 };
+    oc_surface_data* surfaceData = oc_surface_data_from_handle(surface);
+    if(surfaceData && surfaceData->backend)
+    {
+        stats = surfaceData->backend->stats;
+    }
+    return (stats);
+}
+
 void oc_surface_bring_to_front(oc_surface handle)
 {
     oc_surface_data* surface = oc_surface_data_from_handle(handle);
@@ -338,6 +695,17 @@ oc_vec2 oc_image_size(oc_image image)
     return (res);
 }
 
+oc_image_status oc_image_get_status(oc_image image)
+{
+    oc_image_status status = OC_IMAGE_FAILED;
+    oc_image_data* imageData = oc_image_data_from_handle(image);
+    if(imageData)
+    {
+        status = imageData->status;
+    }
+    return (status);
+}
+
 oc_image oc_image_create(oc_surface surface, u32 width, u32 height)
 {
     oc_image image = oc_image_nil();
@@ -351,10 +719,25 @@ oc_image oc_image_create(oc_surface surface, u32 width, u32 height)
     {
         OC_DEBUG_ASSERT(surfaceData->api == OC_CANVAS);
 
-        oc_image_data* imageData = surfaceData->backend->imageCreate(surfaceData->backend, (oc_vec2){ width, height });
+        oc_image_data* imageData = 0;
+        if(width && height && width <= OC_IMAGE_ATLAS_MAX_IMAGE_SIZE && height <= OC_IMAGE_ATLAS_MAX_IMAGE_SIZE)
+        {
+            imageData = oc_image_atlas_create(surfaceData->backend, surface, width, height);
+        }
+        if(!imageData)
+        {
+            imageData = surfaceData->backend->imageCreate(surfaceData->backend, (oc_vec2){ width, height });
+            if(imageData)
+            {
+                //NOTE: not all backends clear their image structs
+                imageData->atlasPage = 0;
+            }
+        }
         if(imageData)
         {
             imageData->surface = surface;
+            imageData->status = OC_IMAGE_READY;
+            imageData->loadJob = 0;
             image = oc_image_handle_alloc(imageData);
         }
     }
@@ -376,7 +759,18 @@ void oc_image_destroy(oc_image image)
             oc_surface_data* surface = oc_surface_data_from_handle(imageData->surface);
             if(surface && surface->backend)
             {
-                surface->backend->imageDestroy(surface->backend, imageData);
+                if(imageData->loadJob)
+                {
+                    oc_image_loader_cancel(imageData->loadJob);
+                }
+                if(imageData->atlasPage)
+                {
+                    oc_image_atlas_destroy(surface->backend, imageData);
+                }
+                else
+                {
+                    surface->backend->imageDestroy(surface->backend, imageData);
+                }
                 oc_graphics_handle_recycle(image.h);
             }
         }
@@ -399,7 +793,14 @@ void oc_image_upload_region_rgba8(oc_image image, oc_rect region, u8* pixels)
             if(surfaceData)
             {
                 OC_DEBUG_ASSERT(surfaceData->backend);
-                surfaceData->backend->imageUploadRegion(surfaceData->backend, imageData, region, pixels);
+                if(imageData->atlasPage)
+                {
+                    oc_image_atlas_upload_region(surfaceData->backend, imageData, region, pixels);
+                }
+                else
+                {
+                    surfaceData->backend->imageUploadRegion(surfaceData->backend, imageData, region, pixels);
+                }
             }
         }
     }
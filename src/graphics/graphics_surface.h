@@ -68,6 +68,9 @@ void* oc_surface_native_layer(oc_surface surface);
 //---------------------------------------------------------------
 // canvas backend interface
 //---------------------------------------------------------------
+typedef struct oc_image_atlas_page oc_image_atlas_page;
+typedef struct oc_image_load_job oc_image_load_job;
+
 typedef struct oc_image_data
 {
     oc_list_elt listElt;
@@ -75,6 +78,16 @@ typedef struct oc_image_data
     oc_surface surface;
     oc_vec2 size;
 
+    //NOTE: small images are packed into shared atlas pages (see graphics_surface.c). Such images are not backend
+    //      images: their contents live in atlasPage's image, at atlasRegion.
+    oc_image_atlas_page* atlasPage;
+    oc_list_elt atlasElt;
+    oc_rect atlasRegion;
+
+    //NOTE: images created by the async image API are pending until their load job is done (see image_loader.c)
+    oc_image_status status;
+    oc_image_load_job* loadJob;
+
 } oc_image_data;
 
 typedef void (*oc_canvas_backend_destroy_proc)(oc_canvas_backend* backend);
@@ -93,6 +106,8 @@ typedef void (*oc_canvas_backend_render_proc)(oc_canvas_backend* backend,
                                               u32 eltCount,
                                               oc_path_elt* pathElements);
 
+typedef u8* (*oc_canvas_backend_read_pixels_proc)(oc_canvas_backend* backend, oc_arena* arena, oc_vec2* size);
+
 typedef struct oc_canvas_backend
 {
     oc_canvas_backend_destroy_proc destroy;
@@ -102,6 +117,11 @@ typedef struct oc_canvas_backend
     oc_canvas_backend_image_upload_region_proc imageUploadRegion;
 
     oc_canvas_backend_render_proc render;
+    oc_canvas_backend_read_pixels_proc readPixels; // optional, for backends that render to memory
+
+    //NOTE: filled by the surface layer, except for batchCount which backends that split batches must update in render
+    oc_canvas_render_stats stats;
+    oc_list imageAtlasPages;
 
 } oc_canvas_backend;
 
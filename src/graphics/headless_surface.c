@@ -0,0 +1,56 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+#include "graphics_surface.h"
+
+//NOTE: headless canvas surfaces render into memory with the cpu canvas backend (see cpu_canvas.c). They are
+//      used to run apps without a GPU, e.g. to measure the cost of their frames on CI machines, or to render
+//      thumbnails and reference images. The last frame can be read back with oc_surface_read_pixels().
+
+//--------------------------------------------------------------------
+// headless surface
+//--------------------------------------------------------------------
+
+void oc_headless_surface_destroy(oc_surface_data* surface)
+{
+    oc_surface_cleanup(surface);
+    free(surface);
+}
+
+//NOTE: surfaces have no context to make current, but oc_surface_select() only selects surfaces that
+//      have a prepare proc
+void oc_headless_surface_prepare(oc_surface_data* surface)
+{
+}
+
+oc_surface_data* oc_headless_canvas_surface_create_for_window(oc_window window)
+{
+    oc_surface_data* surface = 0;
+
+    oc_window_data* windowData = oc_window_ptr_from_handle(window);
+    if(windowData)
+    {
+        surface = oc_malloc_type(oc_surface_data);
+        if(surface)
+        {
+            memset(surface, 0, sizeof(oc_surface_data));
+            oc_surface_init_for_window(surface, windowData);
+
+            surface->api = OC_CANVAS;
+            surface->destroy = oc_headless_surface_destroy;
+            surface->prepare = oc_headless_surface_prepare;
+
+            surface->backend = oc_cpu_canvas_backend_create(surface);
+            if(!surface->backend)
+            {
+                surface->destroy(surface);
+                surface = 0;
+            }
+        }
+    }
+    return (surface);
+}
@@ -0,0 +1,401 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+#include "image_loader.h"
+#include "platform/platform_thread.h"
+
+typedef enum oc_image_load_state
+{
+    OC_IMAGE_LOAD_QUEUED,
+    OC_IMAGE_LOAD_DECODING,
+    OC_IMAGE_LOAD_DECODED,
+} oc_image_load_state;
+
+typedef struct oc_image_load_job
+{
+    oc_list_elt listElt;
+    oc_image_load_state state;
+    bool cancelled;
+
+    oc_surface surface;
+    oc_image image;
+
+    oc_str8 mem; // copy of the encoded image, freed once decoded
+    bool flip;
+    u32 srcWidth;
+    u32 srcHeight;
+    u32 width;
+    u32 height;
+
+    u8* pixels; // null if decoding failed
+    u32 uploadedRows;
+
+} oc_image_load_job;
+
+typedef struct oc_image_loader
+{
+    bool init;
+    oc_mutex* mutex;
+    oc_condition* wakeUp;
+
+    //NOTE: jobs move from queued to decoding to decoded. All three lists are protected by the mutex.
+    oc_list queued;
+    oc_list decoding;
+    oc_list decoded;
+
+    u32 threadCount;
+    oc_thread* threads[OC_IMAGE_LOADER_THREAD_COUNT];
+
+} oc_image_loader;
+
+static oc_image_loader oc_imageLoader = { 0 };
+
+//NOTE: if the loader couldn't create its threads, everything happens on the calling thread and there's no mutex
+static void oc_image_loader_lock(oc_image_loader* loader)
+{
+    if(loader->threadCount)
+    {
+        oc_mutex_lock(loader->mutex);
+    }
+}
+
+static void oc_image_loader_unlock(oc_image_loader* loader)
+{
+    if(loader->threadCount)
+    {
+        oc_mutex_unlock(loader->mutex);
+    }
+}
+
+static void oc_image_load_job_free(oc_image_load_job* job)
+{
+    free(job->mem.ptr);
+    free(job->pixels);
+    free(job);
+}
+
+//NOTE: box filter, averaging colors weighted by alpha so that transparent pixels don't darken the edges
+static u8* oc_image_downscale_rgba8(u32 srcWidth, u32 srcHeight, u8* src, u32 width, u32 height)
+{
+    u8* dst = malloc((u64)width * height * 4);
+    if(!dst)
+    {
+        return (0);
+    }
+
+    for(u32 y = 0; y < height; y++)
+    {
+        u32 y0 = (u64)y * srcHeight / height;
+        u32 y1 = oc_max(y0 + 1, (u64)(y + 1) * srcHeight / height);
+
+        for(u32 x = 0; x < width; x++)
+        {
+            u32 x0 = (u64)x * srcWidth / width;
+            u32 x1 = oc_max(x0 + 1, (u64)(x + 1) * srcWidth / width);
+
+            u64 sum[4] = { 0 };
+            for(u32 row = y0; row < y1; row++)
+            {
+                u8* p = src + ((u64)row * srcWidth + x0) * 4;
+                for(u32 col = x0; col < x1; col++, p += 4)
+                {
+                    sum[0] += p[0] * p[3];
+                    sum[1] += p[1] * p[3];
+                    sum[2] += p[2] * p[3];
+                    sum[3] += p[3];
+                }
+            }
+
+            u8* out = dst + ((u64)y * width + x) * 4;
+            u64 count = (u64)(y1 - y0) * (x1 - x0);
+            for(int c = 0; c < 3; c++)
+            {
+                out[c] = sum[3] ? (sum[c] + sum[3] / 2) / sum[3] : 0;
+            }
+            out[3] = (sum[3] + count / 2) / count;
+        }
+    }
+    return (dst);
+}
+
+static void oc_image_load_job_decode(oc_image_load_job* job)
+{
+    int width, height;
+    u8* pixels = oc_image_decode_rgba8(job->mem, job->flip, &width, &height);
+
+    free(job->mem.ptr);
+    job->mem = (oc_str8){ 0 };
+
+    if(pixels && (width != job->srcWidth || height != job->srcHeight))
+    {
+        free(pixels);
+        pixels = 0;
+    }
+    if(pixels && (job->width != job->srcWidth || job->height != job->srcHeight))
+    {
+        u8* scaled = oc_image_downscale_rgba8(job->srcWidth, job->srcHeight, pixels, job->width, job->height);
+        free(pixels);
+        pixels = scaled;
+    }
+    job->pixels = pixels;
+}
+
+static i32 oc_image_loader_thread_proc(void* user)
+{
+    oc_image_loader* loader = (oc_image_loader*)user;
+
+    oc_mutex_lock(loader->mutex);
+    while(1)
+    {
+        while(oc_list_empty(loader->queued))
+        {
+            oc_condition_wait(loader->wakeUp, loader->mutex);
+        }
+        oc_image_load_job* job = oc_list_pop_entry(&loader->queued, oc_image_load_job, listElt);
+        job->state = OC_IMAGE_LOAD_DECODING;
+        oc_list_push_back(&loader->decoding, &job->listElt);
+        oc_mutex_unlock(loader->mutex);
+
+        oc_image_load_job_decode(job);
+
+        oc_mutex_lock(loader->mutex);
+        oc_list_remove(&loader->decoding, &job->listElt);
+        if(job->cancelled)
+        {
+            oc_image_load_job_free(job);
+        }
+        else
+        {
+            job->state = OC_IMAGE_LOAD_DECODED;
+            oc_list_push_back(&loader->decoded, &job->listElt);
+        }
+    }
+    oc_mutex_unlock(loader->mutex);
+    return (0);
+}
+
+static void oc_image_loader_init(oc_image_loader* loader)
+{
+    loader->init = true;
+    loader->mutex = oc_mutex_create();
+    loader->wakeUp = oc_condition_create();
+
+    if(!loader->mutex || !loader->wakeUp)
+    {
+        oc_log_error("couldn't create image loader threads, decoding images on the calling thread\n");
+        return;
+    }
+
+    for(u32 i = 0; i < OC_IMAGE_LOADER_THREAD_COUNT; i++)
+    {
+        loader->threads[i] = oc_thread_create_with_name(oc_image_loader_thread_proc, loader, OC_STR8("image loader"));
+        if(!loader->threads[i])
+        {
+            break;
+        }
+        loader->threadCount++;
+    }
+}
+
+oc_image oc_image_create_async_from_buffer(oc_surface surface, u64 len, char* mem, bool flip, u32 maxSize)
+{
+    oc_image_loader* loader = &oc_imageLoader;
+    if(!loader->init)
+    {
+        oc_image_loader_init(loader);
+    }
+
+    //NOTE: only parse the header here, so that we can return an image of the right size
+    int srcWidth, srcHeight, channels;
+    if(!stbi_info_from_memory((u8*)mem, len, &srcWidth, &srcHeight, &channels))
+    {
+        oc_log_error("stbi_info_from_memory() failed: %s\n", stbi_failure_reason());
+        return (oc_image_nil());
+    }
+
+    u32 width = srcWidth;
+    u32 height = srcHeight;
+    if(maxSize && (width > maxSize || height > maxSize))
+    {
+        f64 scale = oc_min((f64)maxSize / width, (f64)maxSize / height);
+        width = oc_clamp((u32)(width * scale + 0.5), 1, maxSize);
+        height = oc_clamp((u32)(height * scale + 0.5), 1, maxSize);
+    }
+
+    oc_image image = oc_image_create(surface, width, height);
+    oc_image_data* imageData = oc_image_data_from_handle(image);
+    if(!imageData)
+    {
+        return (image);
+    }
+
+    oc_image_load_job* job = oc_malloc_type(oc_image_load_job);
+    char* copy = malloc(len);
+    if(!job || !copy)
+    {
+        free(job);
+        free(copy);
+        imageData->status = OC_IMAGE_FAILED;
+        return (image);
+    }
+    memset(job, 0, sizeof(oc_image_load_job));
+    memcpy(copy, mem, len);
+
+    job->surface = surface;
+    job->image = image;
+    job->mem = oc_str8_from_buffer(len, copy);
+    job->flip = flip;
+    job->srcWidth = srcWidth;
+    job->srcHeight = srcHeight;
+    job->width = width;
+    job->height = height;
+
+    imageData->status = OC_IMAGE_PENDING;
+    imageData->loadJob = job;
+
+    if(loader->threadCount)
+    {
+        oc_mutex_lock(loader->mutex);
+        oc_list_push_back(&loader->queued, &job->listElt);
+        oc_condition_signal(loader->wakeUp);
+        oc_mutex_unlock(loader->mutex);
+    }
+    else
+    {
+        oc_image_load_job_decode(job);
+        job->state = OC_IMAGE_LOAD_DECODED;
+        oc_list_push_back(&loader->decoded, &job->listElt);
+    }
+    return (image);
+}
+
+static oc_image_load_job* oc_image_loader_take_decoded(oc_image_loader* loader, oc_surface surface)
+{
+    oc_image_load_job* result = 0;
+    oc_image_loader_lock(loader);
+    oc_list_for(loader->decoded, job, oc_image_load_job, listElt)
+    {
+        if(job->surface.h == surface.h)
+        {
+            oc_list_remove(&loader->decoded, &job->listElt);
+            result = job;
+            break;
+        }
+    }
+    oc_image_loader_unlock(loader);
+    return (result);
+}
+
+void oc_image_loader_upload(oc_surface surface)
+{
+    oc_image_loader* loader = &oc_imageLoader;
+    if(!loader->init)
+    {
+        return;
+    }
+
+    u64 budget = OC_IMAGE_LOADER_UPLOAD_BUDGET;
+    oc_image_load_job* job = 0;
+
+    while(budget && (job = oc_image_loader_take_decoded(loader, surface)))
+    {
+        oc_image_data* imageData = oc_image_data_from_handle(job->image);
+        OC_DEBUG_ASSERT(imageData && imageData->loadJob == job);
+
+        if(job->pixels)
+        {
+            u64 pitch = (u64)job->width * 4;
+            u32 rowCount = oc_clamp(budget / pitch, 1, job->height - job->uploadedRows);
+
+            oc_image_upload_region_rgba8(job->image,
+                                         (oc_rect){ 0, job->uploadedRows, job->width, rowCount },
+                                         job->pixels + job->uploadedRows * pitch);
+
+            job->uploadedRows += rowCount;
+            budget -= oc_min(budget, rowCount * pitch);
+        }
+
+        if(!job->pixels || job->uploadedRows == job->height)
+        {
+            if(!job->pixels)
+            {
+                oc_log_error("couldn't decode image\n");
+            }
+            imageData->status = job->pixels ? OC_IMAGE_READY : OC_IMAGE_FAILED;
+            imageData->loadJob = 0;
+            oc_image_load_job_free(job);
+        }
+        else
+        {
+            //NOTE: out of budget, finish the upload on the next render
+            oc_image_loader_lock(loader);
+            oc_list_push(&loader->decoded, &job->listElt);
+            oc_image_loader_unlock(loader);
+        }
+    }
+}
+
+bool oc_image_loader_busy(void)
+{
+    oc_image_loader* loader = &oc_imageLoader;
+    if(!loader->init)
+    {
+        return (false);
+    }
+    oc_image_loader_lock(loader);
+    bool busy = !oc_list_empty(loader->queued)
+             || !oc_list_empty(loader->decoding)
+             || !oc_list_empty(loader->decoded);
+    oc_image_loader_unlock(loader);
+    return (busy);
+}
+
+static void oc_image_loader_cancel_locked(oc_image_loader* loader, oc_image_load_job* job)
+{
+    //NOTE: jobs that are being decoded are freed by their loader thread once it's done
+    job->cancelled = true;
+    if(job->state == OC_IMAGE_LOAD_QUEUED)
+    {
+        oc_list_remove(&loader->queued, &job->listElt);
+        oc_image_load_job_free(job);
+    }
+    else if(job->state == OC_IMAGE_LOAD_DECODED)
+    {
+        oc_list_remove(&loader->decoded, &job->listElt);
+        oc_image_load_job_free(job);
+    }
+}
+
+void oc_image_loader_cancel(oc_image_load_job* job)
+{
+    oc_image_loader* loader = &oc_imageLoader;
+    oc_image_loader_lock(loader);
+    oc_image_loader_cancel_locked(loader, job);
+    oc_image_loader_unlock(loader);
+}
+
+void oc_image_loader_cancel_surface(oc_surface surface)
+{
+    oc_image_loader* loader = &oc_imageLoader;
+    if(!loader->init)
+    {
+        return;
+    }
+    oc_image_loader_lock(loader);
+    oc_list* lists[] = { &loader->queued, &loader->decoding, &loader->decoded };
+    for(int i = 0; i < oc_array_size(lists); i++)
+    {
+        oc_list_for_safe(*lists[i], job, oc_image_load_job, listElt)
+        {
+            if(job->surface.h == surface.h)
+            {
+                oc_image_loader_cancel_locked(loader, job);
+            }
+        }
+    }
+    oc_image_loader_unlock(loader);
+}
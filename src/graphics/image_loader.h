@@ -0,0 +1,27 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+#ifndef __IMAGE_LOADER_H_
+#define __IMAGE_LOADER_H_
+
+#include "graphics_surface.h"
+
+//NOTE: the image loader decodes images created by the async image API on a few background threads. Decoded pixels
+//      are uploaded in bands of rows by oc_image_loader_upload(), which oc_surface_render_commands() calls for the
+//      surface being rendered, so that loading many large images doesn't stall a single frame.
+
+enum
+{
+    OC_IMAGE_LOADER_THREAD_COUNT = 2,
+    OC_IMAGE_LOADER_UPLOAD_BUDGET = 4 << 20, // bytes uploaded per render
+};
+
+void oc_image_loader_upload(oc_surface surface);
+void oc_image_loader_cancel(oc_image_load_job* job);
+void oc_image_loader_cancel_surface(oc_surface surface);
+
+#endif //__IMAGE_LOADER_H_
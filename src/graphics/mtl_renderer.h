@@ -23,6 +23,7 @@ typedef struct oc_mtl_path
     vector_float4 color;
     vector_float4 box;
     vector_float4 clip;
+    vector_float4 uvClamp;
     int texture;
 } oc_mtl_path;
 
@@ -253,6 +253,9 @@ void oc_mtl_encode_path(oc_mtl_canvas_backend* backend, oc_primitive* primitive,
         path->uvTransform = simd_matrix(simd_make_float3(uvTransform.m[0] / scale, uvTransform.m[3] / scale, 0),
                                         simd_make_float3(uvTransform.m[1] / scale, uvTransform.m[4] / scale, 0),
                                         simd_make_float3(uvTransform.m[2], uvTransform.m[5], 1));
+
+        oc_vec4 uvClamp = oc_image_src_region_uv_clamp(srcRegion, texSize);
+        path->uvClamp = (vector_float4){ uvClamp.x, uvClamp.y, uvClamp.z, uvClamp.w };
     }
     path->texture = backend->currentImageIndex;
 
@@ -1252,6 +1255,7 @@ void oc_mtl_canvas_render(oc_canvas_backend* interface,
     oc_vec2 currentPos = { 0 };
     oc_image images[OC_MTL_MAX_IMAGES_PER_BATCH] = { 0 };
     int imageCount = 0;
+    u32 batchCount = 1;
 
     for(int primitiveIndex = 0; primitiveIndex < primitiveCount; primitiveIndex++)
     {
@@ -1265,9 +1269,10 @@ void oc_mtl_canvas_render(oc_canvas_backend* interface,
                 if(images[i].h == primitive->attributes.image.h)
                 {
                     backend->currentImageIndex = i;
+                    break;
                 }
             }
-            if(backend->currentImageIndex <= 0)
+            if(backend->currentImageIndex < 0)
             {
                 if(imageCount < OC_MTL_MAX_IMAGES_PER_BATCH)
                 {
@@ -1285,6 +1290,7 @@ void oc_mtl_canvas_render(oc_canvas_backend* interface,
                                         nTilesY,
                                         viewportSize,
                                         scale);
+                    batchCount++;
 
                     images[0] = primitive->attributes.image;
                     backend->currentImageIndex = 0;
@@ -1354,6 +1360,8 @@ void oc_mtl_canvas_render(oc_canvas_backend* interface,
                         viewportSize,
                         scale);
 
+    backend->interface.stats.batchCount = batchCount;
+
     @autoreleasepool
     {
         //NOTE: finalize
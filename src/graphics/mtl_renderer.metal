@@ -1641,6 +1641,7 @@ kernel void mtl_raster(const device oc_mtl_screen_tile* screenTilesBuffer [[buff
                     float2 sampleCoord = imgSampleCoords[sampleIndex];
                     float3 ph = float3(sampleCoord.xy, 1);
                     float2 uv = (pathBuffer[pathIndex].uvTransform * ph).xy;
+                    uv = clamp(uv, pathBuffer[pathIndex].uvClamp.xy, pathBuffer[pathIndex].uvClamp.zw);
 
                     texColor += srcTextures[textureIndex].sample(smp, uv);
                 }
@@ -35,13 +35,14 @@
 	#include"platform/posix_socket.c"
 	*/
 
-#elif PLATFORM_LINUX
+#elif OC_PLATFORM_LINUX
     #include "platform/native_debug.c"
-    #include "platform/unix_base_memory.c"
+    #include "platform/unix_memory.c"
     #include "platform/linux_clock.c"
+    #include "platform/linux_path.c"
     #include "platform/posix_io.c"
-    #include "platform/platform_io_dialog.c"
     #include "platform/posix_thread.c"
+    #include "platform/linux_platform.c"
 /*
 	#include"platform/unix_rng.c"
 	#include"platform/posix_socket.c"
@@ -80,6 +81,7 @@
         #include "graphics/win32_vsync.c"
         #include "graphics/graphics_common.c"
         #include "graphics/graphics_surface.c"
+        #include "graphics/image_loader.c"
 
         #if OC_COMPILE_GL || OC_COMPILE_GLES
             #include "graphics/gl_loader.c"
@@ -90,6 +92,7 @@
         #endif
 
         #if OC_COMPILE_CANVAS
+            #include "graphics/canvas_workers.c"
             #include "graphics/gl_canvas.c"
         #endif
 
@@ -100,11 +103,23 @@
     #elif OC_PLATFORM_MACOS
         #include "platform/platform_io_dialog.c"
     //NOTE: macos application layer and graphics backends are defined in orca.m
+    #elif OC_PLATFORM_LINUX
+        //NOTE: there is no windowing or GPU backend on linux yet, only a headless app layer used to
+        //      run and benchmark apps without a display, which renders canvas surfaces on the cpu.
+        #include "platform/platform_io_dialog.c"
+        #include "app/headless_app.c"
+        #include "graphics/graphics_common.c"
+        #include "graphics/graphics_surface.c"
+        #include "graphics/image_loader.c"
+        #include "graphics/canvas_workers.c"
+        #include "graphics/cpu_canvas.c"
+        #include "graphics/headless_surface.c"
     #elif OC_PLATFORM_ORCA
         #include "app/orca_app.c"
         #include "wasmbind/core_api_stubs.c"
         #include "graphics/graphics_common.c"
         #include "graphics/orca_surface_stubs.c"
+        #include "graphics/orca_font_stubs.c"
     #else
         #error "Unsupported platform"
     #endif
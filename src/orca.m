@@ -9,6 +9,7 @@
 #include "app/osx_app.m"
 #include "graphics/graphics_common.c"
 #include "graphics/graphics_surface.c"
+#include "graphics/image_loader.c"
 
 #if OC_COMPILE_METAL
     #include "graphics/mtl_surface.m"
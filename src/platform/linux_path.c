@@ -0,0 +1,61 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+
+#include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "platform_path.c"
+
+bool oc_path_is_absolute(oc_str8 path)
+{
+    return (path.len && (path.ptr[0] == '/'));
+}
+
+oc_str8 oc_path_executable(oc_arena* arena)
+{
+    oc_str8 result = {};
+    char buffer[PATH_MAX];
+    ssize_t size = readlink("/proc/self/exe", buffer, PATH_MAX);
+    if(size > 0)
+    {
+        result = oc_str8_push_buffer(arena, size, buffer);
+    }
+    return (result);
+}
+
+oc_str8 oc_path_user_cache_directory(oc_arena* arena)
+{
+    oc_str8 result = {};
+    char* xdgCache = getenv("XDG_CACHE_HOME");
+    char* home = getenv("HOME");
+
+    if(xdgCache && oc_path_is_absolute(OC_STR8(xdgCache)))
+    {
+        result = oc_str8_push_cstring(arena, xdgCache);
+    }
+    else if(home && home[0])
+    {
+        result = oc_path_append(arena, OC_STR8(home), OC_STR8(".cache"));
+    }
+    return (result);
+}
+
+oc_str8 oc_path_canonical(oc_arena* arena, oc_str8 path)
+{
+    oc_arena_scope scratch = oc_scratch_begin_next(arena);
+    char* pathCString = oc_str8_to_cstring(scratch.arena, path);
+
+    char* real = realpath(pathCString, 0);
+    oc_str8 result = oc_str8_push_cstring(arena, real);
+
+    free(real);
+    oc_scratch_end(scratch);
+
+    return (result);
+}
@@ -8,6 +8,7 @@
 
 #include <libgen.h>
 #include <mach-o/dyld.h>
+#include <stdlib.h>
 
 #include "platform_path.c"
 
@@ -28,6 +29,17 @@ oc_str8 oc_path_executable(oc_arena* arena)
     return (result);
 }
 
+oc_str8 oc_path_user_cache_directory(oc_arena* arena)
+{
+    oc_str8 result = {};
+    char* home = getenv("HOME");
+    if(home && home[0])
+    {
+        result = oc_path_append(arena, OC_STR8(home), OC_STR8("Library/Caches"));
+    }
+    return (result);
+}
+
 oc_str8 oc_path_canonical(oc_arena* arena, oc_str8 path)
 {
     oc_arena_scope scratch = oc_scratch_begin_next(arena);
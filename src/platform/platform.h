@@ -38,7 +38,7 @@
 #elif defined(__APPLE__) && defined(__MACH__)
     #define OC_PLATFORM_MACOS 1
 #elif defined(__gnu_linux__)
-    #define PLATFORM_LINUX 1
+    #define OC_PLATFORM_LINUX 1
 #elif defined(__ORCA__)
     #define OC_PLATFORM_ORCA 1
 #else
@@ -119,6 +119,7 @@ typedef enum
 {
     OC_HOST_PLATFORM_MACOS,
     OC_HOST_PLATFORM_WINDOWS,
+    OC_HOST_PLATFORM_LINUX,
 } oc_host_platform;
 
 ORCA_API oc_host_platform oc_get_host_platform(void);
@@ -37,6 +37,10 @@ ORCA_API oc_str8 oc_path_canonical(oc_arena* arena, oc_str8 path);
 
 // helper: gets the path from oc_path_executable() and appends relPath
 ORCA_API oc_str8 oc_path_executable_relative(oc_arena* arena, oc_str8 relPath);
+
+// per-user directory for data that can be regenerated (XDG cache dir, ~/Library/Caches, %LOCALAPPDATA%).
+// returns an empty string if it can't be determined. the directory isn't guaranteed to exist.
+ORCA_API oc_str8 oc_path_user_cache_directory(oc_arena* arena);
 #endif
 
 #ifdef __cplusplus
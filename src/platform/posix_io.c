@@ -162,7 +162,12 @@ static int oc_io_convert_open_flags(oc_file_open_flags flags)
     }
     if(flags & OC_FILE_OPEN_SYMLINK)
     {
+#if OC_PLATFORM_LINUX
+        //NOTE: linux has no O_SYMLINK, O_PATH | O_NOFOLLOW opens the link itself (but only allows stat-like operations)
+        oflags |= O_PATH | O_NOFOLLOW;
+#else
         oflags |= O_SYMLINK;
+#endif
     }
     return (oflags);
 }
@@ -306,9 +311,16 @@ oc_io_error oc_io_raw_fstat(oc_file_desc fd, oc_file_status* status)
         status->type = oc_io_convert_type_from_stat(s.st_mode);
         status->size = s.st_size;
 
+#if OC_PLATFORM_LINUX
+        //NOTE: struct stat has no birth time on linux, we use the last status change time instead
+        status->creationDate = oc_datestamp_from_timespec(s.st_ctim);
+        status->accessDate = oc_datestamp_from_timespec(s.st_atim);
+        status->modificationDate = oc_datestamp_from_timespec(s.st_mtim);
+#else
         status->creationDate = oc_datestamp_from_timespec(s.st_birthtimespec);
         status->accessDate = oc_datestamp_from_timespec(s.st_atimespec);
         status->modificationDate = oc_datestamp_from_timespec(s.st_mtimespec);
+#endif
     }
     return (error);
 }
@@ -29,7 +29,11 @@ static void* oc_thread_bootstrap(void* data)
     oc_thread* thread = (oc_thread*)data;
     if(thread->name.len)
     {
+#if OC_PLATFORM_LINUX
+        pthread_setname_np(pthread_self(), thread->nameBuffer);
+#else
         pthread_setname_np(thread->nameBuffer);
+#endif
     }
     i32 exitCode = thread->start(thread->userPointer);
     return ((void*)(ptrdiff_t)exitCode);
@@ -81,16 +85,24 @@ oc_str8 oc_thread_get_name(oc_thread* thread)
 
 u64 oc_thread_unique_id(oc_thread* thread)
 {
+#if OC_PLATFORM_LINUX
+    u64 id = (u64)thread->pthread;
+#else
     u64 id;
     pthread_threadid_np(thread->pthread, &id);
+#endif
     return (id);
 }
 
 u64 oc_thread_self_id()
 {
     pthread_t thread = pthread_self();
+#if OC_PLATFORM_LINUX
+    u64 id = (u64)thread;
+#else
     u64 id;
     pthread_threadid_np(thread, &id);
+#endif
     return (id);
 }
 
@@ -249,7 +261,7 @@ int oc_condition_broadcast(oc_condition* cond)
 
 void oc_sleep_nano(u64 nanoseconds)
 {
-    timespec rqtp;
+    struct timespec rqtp;
     rqtp.tv_sec = nanoseconds / 1000000000;
     rqtp.tv_nsec = nanoseconds - rqtp.tv_sec * 1000000000;
     nanosleep(&rqtp, 0);
@@ -6,6 +6,7 @@
 *
 **************************************************************************/
 #include <shlwapi.h> // PathIsRelative()
+#include <stdlib.h>
 
 #include "platform_path.c"
 #include "win32_string_helpers.h"
@@ -35,4 +36,16 @@ oc_str8 oc_path_executable(oc_arena* arena)
     return (path);
 }
 
+oc_str8 oc_path_user_cache_directory(oc_arena* arena)
+{
+    oc_str8 result = {};
+    char* localAppData = getenv("LOCALAPPDATA");
+    if(localAppData && localAppData[0])
+    {
+        result = oc_str8_push_cstring(arena, localAppData);
+        oc_win32_path_normalize_slash_in_place(result);
+    }
+    return (result);
+}
+
 oc_str8 oc_path_canonical(oc_arena* arena, oc_str8 path); //TODO
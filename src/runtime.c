@@ -15,8 +15,11 @@
 
 #include "runtime.h"
 #include "runtime_clipboard.c"
+#include "runtime_code_cache.c"
 #include "runtime_io.c"
 #include "runtime_memory.c"
+#include "runtime_replay.c"
+#include "runtime_snapshot.c"
 
 oc_font orca_font_create(const char* resourcePath)
 {
@@ -271,11 +274,27 @@ void oc_bridge_log(oc_log_level level,
                msg);
 }
 
+f64 oc_bridge_clock_time(oc_clock_kind clock)
+{
+    //NOTE: when replaying an event log, the guest sees the virtual clock of the replay, so that runs are reproducible
+    if(__orcaApp.replay.file)
+    {
+        return (oc_runtime_replay_clock(&__orcaApp.replay, clock));
+    }
+    return (oc_clock_time(clock));
+}
+
 void oc_bridge_request_quit(void)
 {
     __orcaApp.quit = true;
 }
 
+void oc_bridge_request_frame(void)
+{
+    __orcaApp.onDemandFrames = true;
+    __orcaApp.frameRequested = true;
+}
+
 typedef struct orca_surface_create_data
 {
     oc_window window;
@@ -289,7 +308,7 @@ i32 orca_surface_callback(void* user)
     orca_surface_create_data* data = (orca_surface_create_data*)user;
     data->surface = oc_surface_create_for_window(data->window, data->api);
 
-#if OC_PLATFORM_WINDOWS
+#if OC_PLATFORM_WINDOWS || OC_PLATFORM_LINUX
     //NOTE(martin): on windows we set all surfaces to non-synced, and do a single "manual" wait here.
     //              on macOS each surface is individually synced to the monitor refresh rate but don't block each other
     oc_surface_swap_interval(data->surface, 0);
@@ -312,6 +331,7 @@ oc_surface orca_surface_canvas(void)
 
     oc_dispatch_on_main_thread_sync(__orcaApp.window, orca_surface_callback, (void*)&data);
     oc_surface_select(data.surface);
+    __orcaApp.debugOverlay.guestCanvasSurface = data.surface;
     return (data.surface);
 }
 
@@ -368,7 +388,7 @@ void debug_overlay_toggle(oc_debug_overlay* overlay)
     }
 }
 
-void log_entry_ui(oc_debug_overlay* overlay, log_entry* entry)
+oc_ui_box* log_entry_ui(oc_debug_overlay* overlay, log_entry* entry)
 {
     oc_arena_scope scratch = oc_scratch_begin();
 
@@ -398,7 +418,7 @@ void log_entry_ui(oc_debug_overlay* overlay, log_entry* entry)
 
     oc_str8 key = oc_str8_pushf(scratch.arena, "%ull", entry->recordIndex);
 
-    oc_ui_container_str8(key, OC_UI_FLAG_DRAW_BACKGROUND)
+    oc_ui_box* box = oc_ui_box_begin_str8(key, OC_UI_FLAG_DRAW_BACKGROUND);
     {
         oc_ui_style_next(&(oc_ui_style){ .size.width = { OC_UI_SIZE_PARENT, 1 },
                                          .size.height = { OC_UI_SIZE_CHILDREN },
@@ -423,7 +443,10 @@ void log_entry_ui(oc_debug_overlay* overlay, log_entry* entry)
         }
         oc_ui_label_str8(entry->msg);
     }
+    oc_ui_box_end();
+
     oc_scratch_end(scratch);
+    return (box);
 }
 
 char m3_type_to_tag(M3ValueType type)
@@ -450,20 +473,312 @@ char m3_type_to_tag(M3ValueType type)
 void oc_wasm_env_init(oc_wasm_env* runtime)
 {
     memset(runtime, 0, sizeof(oc_wasm_env));
-    oc_base_allocator* allocator = oc_base_allocator_default();
-    runtime->wasmMemory.committed = 0;
-    runtime->wasmMemory.reserved = 4ULL << 30;
-    runtime->wasmMemory.ptr = oc_base_reserve(allocator, runtime->wasmMemory.reserved);
+    oc_wasm_memory_reserve(&runtime->wasmMemory);
 }
 
 #include "wasmbind/clock_api_bind_gen.c"
 #include "wasmbind/core_api_bind_gen.c"
-#include "wasmbind/gles_api_bind_manual.c"
-#include "wasmbind/gles_api_bind_gen.c"
+#include "wasmbind/font_api_bind_manual.c"
+#include "wasmbind/font_api_bind_gen.c"
+#if OC_COMPILE_GLES
+    #include "wasmbind/gles_api_bind_manual.c"
+    #include "wasmbind/gles_api_bind_gen.c"
+#endif
 #include "wasmbind/io_api_bind_gen.c"
 #include "wasmbind/surface_api_bind_manual.c"
 #include "wasmbind/surface_api_bind_gen.c"
 
+f64 oc_runtime_clock(void)
+{
+    return (oc_clock_time(OC_CLOCK_MONOTONIC));
+}
+
+void oc_runtime_call_export(oc_runtime* app, guest_export_kind kind, u32 argCount, const void** args)
+{
+    f64 startTime = app->timings.file ? oc_clock_time(OC_CLOCK_MONOTONIC) : 0;
+
+    M3Result res = m3_Call(app->env.exports[kind], argCount, args);
+    if(res)
+    {
+        OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
+    }
+
+    if(app->timings.file)
+    {
+        app->timings.exportTime[kind] += oc_clock_time(OC_CLOCK_MONOTONIC) - startTime;
+    }
+}
+
+//------------------------------------------------------------------------
+// timings
+//------------------------------------------------------------------------
+
+bool oc_runtime_timings_open(oc_runtime_timings* timings, oc_str8 path)
+{
+    memset(timings, 0, sizeof(oc_runtime_timings));
+
+    oc_arena_scope scratch = oc_scratch_begin();
+    timings->file = fopen(oc_str8_to_cstring(scratch.arena, path), "w");
+    oc_scratch_end(scratch);
+
+    if(!timings->file)
+    {
+        oc_log_error("couldn't open timings file %.*s\n", oc_str8_ip(path));
+        return (false);
+    }
+
+    //NOTE: one row per frame, with the total time of the frame and the time spent in each handler, in milliseconds.
+    //      Time spent waiting for vsync isn't counted. Guest allocations done on behalf of the host aren't handlers,
+    //      so they don't get a column.
+    fprintf(timings->file, "frame,total");
+    for(int i = 0; i < OC_EXPORT_COUNT; i++)
+    {
+        if(i != OC_EXPORT_ARENA_PUSH)
+        {
+            fprintf(timings->file, ",%.*s", oc_str8_ip(OC_EXPORT_DESC[i].name));
+        }
+    }
+    fprintf(timings->file, "\n");
+
+    timings->frameStart = oc_clock_time(OC_CLOCK_MONOTONIC);
+    return (true);
+}
+
+void oc_runtime_timings_begin_frame(oc_runtime_timings* timings)
+{
+    if(timings->file)
+    {
+        timings->frameStart = oc_clock_time(OC_CLOCK_MONOTONIC);
+    }
+}
+
+//NOTE: label overrides the frame number, for the rows of the init and terminate handlers
+void oc_runtime_timings_end_frame(oc_runtime_timings* timings, const char* label)
+{
+    if(timings->file)
+    {
+        f64 total = oc_clock_time(OC_CLOCK_MONOTONIC) - timings->frameStart;
+
+        if(label)
+        {
+            fprintf(timings->file, "%s,%.3f", label, total * 1000);
+        }
+        else
+        {
+            fprintf(timings->file, "%llu,%.3f", (unsigned long long)timings->frame, total * 1000);
+            timings->frame++;
+        }
+        for(int i = 0; i < OC_EXPORT_COUNT; i++)
+        {
+            if(i != OC_EXPORT_ARENA_PUSH)
+            {
+                fprintf(timings->file, ",%.3f", timings->exportTime[i] * 1000);
+            }
+        }
+        fprintf(timings->file, "\n");
+
+        memset(timings->exportTime, 0, sizeof(timings->exportTime));
+    }
+}
+
+void oc_runtime_timings_close(oc_runtime_timings* timings)
+{
+    if(timings->file)
+    {
+        fclose(timings->file);
+    }
+    memset(timings, 0, sizeof(oc_runtime_timings));
+}
+
+//NOTE: when replaying an event log, events come from the log instead of the platform layer. Platform events are
+//      drained and dropped, except for quit and close requests, so that live input can't disturb the replay.
+oc_event* oc_runtime_next_event(oc_runtime* app, oc_arena* arena)
+{
+    oc_event* event = 0;
+    if(app->replay.file)
+    {
+        while((event = oc_next_event(arena)) != 0)
+        {
+            if(event->type == OC_EVENT_QUIT || event->type == OC_EVENT_WINDOW_CLOSE)
+            {
+                return (event);
+            }
+        }
+
+        event = oc_runtime_replay_next_event(&app->replay, arena);
+        if(event)
+        {
+            event->window = app->window;
+            if(event->type == OC_EVENT_WINDOW_RESIZE || event->type == OC_EVENT_WINDOW_MOVE)
+            {
+                //NOTE: keep the window in sync with the log, since the runtime queries its content rect
+                oc_window_set_content_rect(app->window, event->move.content);
+            }
+        }
+    }
+    else
+    {
+        event = oc_next_event(arena);
+        if(event && app->recorder.file)
+        {
+            oc_runtime_recorder_write(&app->recorder, event);
+        }
+    }
+    return (event);
+}
+
+//NOTE: calls the guest's typed event handlers (oc_on_mouse_move(), oc_on_key_down(), etc) for an event
+void oc_runtime_dispatch_typed_event(oc_runtime* app, oc_event* event)
+{
+    IM3Function* exports = app->env.exports;
+
+    switch(event->type)
+    {
+        case OC_EVENT_WINDOW_RESIZE:
+        {
+            if(exports[OC_EXPORT_FRAME_RESIZE])
+            {
+                u32 width = (u32)event->move.content.w;
+                u32 height = (u32)event->move.content.h;
+                const void* args[2] = { &width, &height };
+                oc_runtime_call_export(app, OC_EXPORT_FRAME_RESIZE, 2, args);
+            }
+        }
+        break;
+
+        case OC_EVENT_MOUSE_BUTTON:
+        {
+            if(event->key.action == OC_KEY_PRESS)
+            {
+                if(exports[OC_EXPORT_MOUSE_DOWN])
+                {
+                    oc_mouse_button button = event->key.button;
+                    const void* args[1] = { &button };
+                    oc_runtime_call_export(app, OC_EXPORT_MOUSE_DOWN, 1, args);
+                }
+            }
+            else
+            {
+                if(exports[OC_EXPORT_MOUSE_UP])
+                {
+                    oc_mouse_button button = event->key.button;
+                    const void* args[1] = { &button };
+                    oc_runtime_call_export(app, OC_EXPORT_MOUSE_UP, 1, args);
+                }
+            }
+        }
+        break;
+
+        case OC_EVENT_MOUSE_WHEEL:
+        {
+            if(exports[OC_EXPORT_MOUSE_WHEEL])
+            {
+                const void* args[2] = { &event->mouse.deltaX, &event->mouse.deltaY };
+                oc_runtime_call_export(app, OC_EXPORT_MOUSE_WHEEL, 2, args);
+            }
+        }
+        break;
+
+        case OC_EVENT_MOUSE_MOVE:
+        {
+            if(exports[OC_EXPORT_MOUSE_MOVE])
+            {
+                const void* args[4] = { &event->mouse.x, &event->mouse.y, &event->mouse.deltaX, &event->mouse.deltaY };
+                oc_runtime_call_export(app, OC_EXPORT_MOUSE_MOVE, 4, args);
+            }
+        }
+        break;
+
+        case OC_EVENT_KEYBOARD_KEY:
+        {
+            if(event->key.action == OC_KEY_PRESS)
+            {
+                if(exports[OC_EXPORT_KEY_DOWN])
+                {
+                    const void* args[2] = { &event->key.scanCode, &event->key.keyCode };
+                    oc_runtime_call_export(app, OC_EXPORT_KEY_DOWN, 2, args);
+                }
+            }
+            else if(event->key.action == OC_KEY_RELEASE)
+            {
+                if(exports[OC_EXPORT_KEY_UP])
+                {
+                    const void* args[2] = { &event->key.scanCode, &event->key.keyCode };
+                    oc_runtime_call_export(app, OC_EXPORT_KEY_UP, 2, args);
+                }
+            }
+        }
+        break;
+
+        default:
+            break;
+    }
+}
+
+//NOTE: when the app exports oc_on_events(), events are staged directly in the guest's oc_rawEventBatch
+//      array and passed in a single call at the end of the frame's event loop, instead of entering the
+//      interpreter once per event.
+//
+//      The typed handlers are then called for each event of the batch, in order. This keeps the order of
+//      the per-event path (raw handler first, then typed handler), and the typed handlers see the same
+//      coalesced mouse moves as oc_on_events().
+void oc_runtime_flush_event_batch(oc_runtime* app)
+{
+    oc_wasm_env* env = &app->env;
+    if(env->rawEventBatchCount)
+    {
+        //NOTE: copy the batch out of guest memory first, since the guest can modify it or grow its memory
+        oc_arena_scope scratch = oc_scratch_begin();
+        u32 count = env->rawEventBatchCount;
+        oc_event* batch = (oc_event*)oc_wasm_address_to_ptr(env->rawEventBatchOffset, count * sizeof(oc_event));
+        oc_event* events = oc_arena_push_array(scratch.arena, oc_event, count);
+        memcpy(events, batch, count * sizeof(oc_event));
+
+        const void* args[2] = { &env->rawEventBatchOffset, &env->rawEventBatchCount };
+        oc_runtime_call_export(app, OC_EXPORT_EVENTS, 2, args);
+        env->rawEventBatchCount = 0;
+
+        for(u32 i = 0; i < count; i++)
+        {
+            oc_runtime_dispatch_typed_event(app, &events[i]);
+        }
+        oc_scratch_end(scratch);
+    }
+}
+
+void oc_runtime_push_event_batch(oc_runtime* app, oc_event* event)
+{
+    oc_wasm_env* env = &app->env;
+
+    if(env->rawEventBatchCount >= OC_EVENT_BATCH_CAPACITY)
+    {
+        oc_runtime_flush_event_batch(app);
+    }
+
+    //NOTE: get the batch address after flushing, since the guest can grow its memory when handling events
+    oc_event* batch = (oc_event*)oc_wasm_address_to_ptr(env->rawEventBatchOffset, OC_EVENT_BATCH_CAPACITY * sizeof(oc_event));
+
+    if(app->options.coalesceMouseMoves
+       && event->type == OC_EVENT_MOUSE_MOVE
+       && env->rawEventBatchCount)
+    {
+        oc_event* last = &batch[env->rawEventBatchCount - 1];
+        if(last->type == OC_EVENT_MOUSE_MOVE && last->window.h == event->window.h)
+        {
+            //NOTE: keep the latest position and accumulate deltas, so that the guest still sees the total motion
+            last->mouse.x = event->mouse.x;
+            last->mouse.y = event->mouse.y;
+            last->mouse.deltaX += event->mouse.deltaX;
+            last->mouse.deltaY += event->mouse.deltaY;
+            last->mouse.mods = event->mouse.mods;
+            return;
+        }
+    }
+
+    memcpy(&batch[env->rawEventBatchCount], event, sizeof(oc_event));
+    env->rawEventBatchCount++;
+}
+
 i32 orca_runloop(void* user)
 {
     oc_runtime* app = &__orcaApp;
@@ -518,21 +833,65 @@ i32 orca_runloop(void* user)
         int err = 0;
         err |= bindgen_link_core_api(app->env.m3Module);
         err |= bindgen_link_surface_api(app->env.m3Module);
+        err |= bindgen_link_font_api(app->env.m3Module);
         err |= bindgen_link_clock_api(app->env.m3Module);
         err |= bindgen_link_io_api(app->env.m3Module);
+#if OC_COMPILE_GLES
         err |= bindgen_link_gles_api(app->env.m3Module);
         err |= manual_link_gles_api(app->env.m3Module);
+#endif
 
         if(err)
         {
             OC_ABORT("The application couldn't link one or more functions to its web assembly module (see console log for more information)");
         }
     }
-    //NOTE: compile
-    res = m3_CompileModule(app->env.m3Module);
-    if(res)
+    //NOTE: compile, or restore the compiled code from the code cache.
+    //      The cache lives in the user's cache directory, out of reach of the guest's file system.
+    //      In lazy mode, functions that weren't restored from the cache are compiled by wasm3 on their first call,
+    //      and the cache is written on exit.
+    m3_RuntimeSetClockCallback(app->env.m3Runtime, oc_runtime_clock);
+
+    if(app->options.jit)
     {
-        OC_WASM3_TRAP(app->env.m3Runtime, res, "The application couldn't compile its web assembly module");
+        res = m3_RuntimeSetJitEnabled(app->env.m3Runtime, true);
+        if(res)
+        {
+            oc_log_warning("%s, running interpreted only\n", res);
+        }
+    }
+    {
+        oc_arena_scope scratch = oc_scratch_begin();
+        oc_str8 modulePath = oc_path_executable_relative(scratch.arena, OC_STR8("../app/wasm/module.wasm"));
+        oc_str8 cachePath = oc_runtime_code_cache_path(scratch.arena, modulePath);
+
+        f64 startTime = oc_clock_time(OC_CLOCK_MONOTONIC);
+
+        bool complete = false;
+        bool restored = oc_runtime_code_cache_load(app->env.m3Module, cachePath, &complete);
+        if(restored)
+        {
+            oc_log_info("restored compiled module from %s code cache in %.2fms\n",
+                        complete ? "complete" : "partial",
+                        (oc_clock_time(OC_CLOCK_MONOTONIC) - startTime) * 1000);
+        }
+
+        //NOTE: a partial cache comes from a lazy compile run. In eager mode, compile the functions it's missing
+        //      (m3_CompileModule skips the restored ones) and store the complete cache.
+        if(!app->options.lazyCompile && !complete)
+        {
+            res = m3_CompileModule(app->env.m3Module);
+            if(res)
+            {
+                OC_WASM3_TRAP(app->env.m3Runtime, res, "The application couldn't compile its web assembly module");
+            }
+            oc_log_info("compiled %s in %.2fms\n",
+                        restored ? "functions missing from the code cache" : "module",
+                        (oc_clock_time(OC_CLOCK_MONOTONIC) - startTime) * 1000);
+
+            oc_runtime_code_cache_store(app->env.m3Module, cachePath);
+        }
+        oc_scratch_end(scratch);
     }
 
     //NOTE: Find and type check event handlers.
@@ -594,6 +953,25 @@ i32 orca_runloop(void* user)
     IM3Global rawEventGlobal = m3_FindGlobal(app->env.m3Module, "oc_rawEvent");
     app->env.rawEventOffset = (u32)rawEventGlobal->intValue;
 
+    //NOTE: get location of the event batch buffer used by oc_on_events()
+    IM3Global rawEventBatchGlobal = m3_FindGlobal(app->env.m3Module, "oc_rawEventBatch");
+    if(rawEventBatchGlobal)
+    {
+        app->env.rawEventBatchOffset = (u32)rawEventBatchGlobal->intValue;
+    }
+    else if(app->env.exports[OC_EXPORT_EVENTS])
+    {
+        oc_log_error("oc_on_events() requires the oc_rawEventBatch buffer, falling back to per-event handlers\n");
+        app->env.exports[OC_EXPORT_EVENTS] = 0;
+    }
+#ifdef M3_BIG_ENDIAN
+    if(app->env.exports[OC_EXPORT_EVENTS])
+    {
+        oc_log_error("oc_on_events() is not supported on big endian platforms\n");
+        app->env.exports[OC_EXPORT_EVENTS] = 0;
+    }
+#endif
+
     //NOTE: preopen the app local root dir
     {
         scratch = oc_scratch_begin();
@@ -612,14 +990,53 @@ i32 orca_runloop(void* user)
 
     IM3Function* exports = app->env.exports;
 
-    //NOTE: call init handler
-    if(exports[OC_EXPORT_ON_INIT])
+    oc_runtime_timings_begin_frame(&app->timings);
+
+    //NOTE: restore the state left by the init handler on a previous launch, or call init handler
     {
-        M3Result res = m3_Call(exports[OC_EXPORT_ON_INIT], 0, 0);
-        if(res)
+        scratch = oc_scratch_begin();
+
+        oc_str8 snapshotPath = oc_runtime_snapshot_path(scratch.arena, &app->env);
+        bool useSnapshot = app->options.snapshot;
+        bool restored = false;
+
+        if(useSnapshot && !exports[OC_EXPORT_ON_RESTORE])
+        {
+            oc_log_warning("snapshots are disabled: the app doesn't export oc_on_restore() to re-create its host resources\n");
+            useSnapshot = false;
+        }
+        if(useSnapshot && !snapshotPath.len)
         {
-            OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
+            useSnapshot = false;
         }
+
+        if(useSnapshot)
+        {
+            f64 startTime = oc_clock_time(OC_CLOCK_MONOTONIC);
+            restored = oc_runtime_snapshot_load(&app->env, snapshotPath);
+            if(restored)
+            {
+                oc_log_info("restored snapshot in %.2fms\n", (oc_clock_time(OC_CLOCK_MONOTONIC) - startTime) * 1000);
+            }
+        }
+
+        if(restored)
+        {
+            oc_runtime_call_export(app, OC_EXPORT_ON_RESTORE, 0, 0);
+        }
+        else
+        {
+            if(exports[OC_EXPORT_ON_INIT])
+            {
+                oc_runtime_call_export(app, OC_EXPORT_ON_INIT, 0, 0);
+            }
+            if(useSnapshot)
+            {
+                oc_runtime_snapshot_store(&app->env, snapshotPath);
+            }
+        }
+
+        oc_scratch_end(scratch);
     }
 
     if(exports[OC_EXPORT_FRAME_RESIZE])
@@ -628,13 +1045,11 @@ i32 orca_runloop(void* user)
         u32 width = (u32)content.w;
         u32 height = (u32)content.h;
         const void* args[2] = { &width, &height };
-        M3Result res = m3_Call(exports[OC_EXPORT_FRAME_RESIZE], 2, args);
-        if(res)
-        {
-            OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
-        }
+        oc_runtime_call_export(app, OC_EXPORT_FRAME_RESIZE, 2, args);
     }
 
+    oc_runtime_timings_end_frame(&app->timings, "init");
+
     oc_ui_set_context(&app->debugOverlay.ui);
 
     while(!app->quit)
@@ -642,14 +1057,41 @@ i32 orca_runloop(void* user)
         scratch = oc_scratch_begin();
         oc_event* event = 0;
 
-        while((event = oc_next_event(scratch.arena)) != 0)
+        if(app->replay.file)
+        {
+            if(app->replay.done && !app->replay.hasPending)
+            {
+                oc_scratch_end(scratch);
+                break;
+            }
+            oc_runtime_replay_begin_frame(&app->replay);
+        }
+        oc_runtime_timings_begin_frame(&app->timings);
+
+        while((event = oc_runtime_next_event(app, scratch.arena)) != 0)
         {
             if(app->debugOverlay.show)
             {
                 oc_ui_process_event(event);
             }
 
-            if(exports[OC_EXPORT_RAW_EVENT])
+            if(exports[OC_EXPORT_EVENTS])
+            {
+                oc_event* clipboardEvent = oc_runtime_clipboard_process_event_begin(scratch.arena, &__orcaApp.clipboard, event);
+                if(clipboardEvent != 0)
+                {
+                    //NOTE: the guest can only read the clipboard while handling the paste event, so deliver it right away
+                    oc_runtime_push_event_batch(app, clipboardEvent);
+                    oc_runtime_push_event_batch(app, event);
+                    oc_runtime_flush_event_batch(app);
+                }
+                else
+                {
+                    oc_runtime_push_event_batch(app, event);
+                }
+                oc_runtime_clipboard_process_event_end(&__orcaApp.clipboard);
+            }
+            else if(exports[OC_EXPORT_RAW_EVENT])
             {
                 oc_event* clipboardEvent = oc_runtime_clipboard_process_event_begin(scratch.arena, &__orcaApp.clipboard, event);
                 oc_event* events[2];
@@ -673,11 +1115,7 @@ i32 orca_runloop(void* user)
                     memcpy(eventPtr, events[i], sizeof(*events[i]));
 
                     const void* args[1] = { &app->env.rawEventOffset };
-                    M3Result res = m3_Call(exports[OC_EXPORT_RAW_EVENT], 1, args);
-                    if(res)
-                    {
-                        OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
-                    }
+                    oc_runtime_call_export(app, OC_EXPORT_RAW_EVENT, 1, args);
 #else
                     oc_log_error("oc_on_raw_event() is not supported on big endian platforms");
 #endif
@@ -695,115 +1133,14 @@ i32 orca_runloop(void* user)
                 }
                 break;
 
-                case OC_EVENT_WINDOW_RESIZE:
-                {
-                    oc_rect frame = { 0, 0, event->move.frame.w, event->move.frame.h };
-
-                    if(exports[OC_EXPORT_FRAME_RESIZE])
-                    {
-                        u32 width = (u32)event->move.content.w;
-                        u32 height = (u32)event->move.content.h;
-                        const void* args[2] = { &width, &height };
-                        M3Result res = m3_Call(exports[OC_EXPORT_FRAME_RESIZE], 2, args);
-                        if(res)
-                        {
-                            OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
-                        }
-                    }
-                }
-                break;
-
-                case OC_EVENT_MOUSE_BUTTON:
-                {
-                    if(event->key.action == OC_KEY_PRESS)
-                    {
-                        if(exports[OC_EXPORT_MOUSE_DOWN])
-                        {
-                            oc_mouse_button button = event->key.button;
-                            const void* args[1] = { &button };
-                            M3Result res = m3_Call(exports[OC_EXPORT_MOUSE_DOWN], 1, args);
-                            if(res)
-                            {
-                                OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
-                            }
-                        }
-                    }
-                    else
-                    {
-                        if(exports[OC_EXPORT_MOUSE_UP])
-                        {
-                            oc_mouse_button button = event->key.button;
-                            const void* args[1] = { &button };
-                            M3Result res = m3_Call(exports[OC_EXPORT_MOUSE_UP], 1, args);
-                            if(res)
-                            {
-                                OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
-                            }
-                        }
-                    }
-                }
-                break;
-
-                case OC_EVENT_MOUSE_WHEEL:
-                {
-                    if(exports[OC_EXPORT_MOUSE_WHEEL])
-                    {
-                        const void* args[2] = { &event->mouse.deltaX, &event->mouse.deltaY };
-                        M3Result res = m3_Call(exports[OC_EXPORT_MOUSE_WHEEL], 2, args);
-                        if(res)
-                        {
-                            OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
-                        }
-                    }
-                }
-                break;
-
-                case OC_EVENT_MOUSE_MOVE:
-                {
-                    if(exports[OC_EXPORT_MOUSE_MOVE])
-                    {
-                        const void* args[4] = { &event->mouse.x, &event->mouse.y, &event->mouse.deltaX, &event->mouse.deltaY };
-                        M3Result res = m3_Call(exports[OC_EXPORT_MOUSE_MOVE], 4, args);
-                        if(res)
-                        {
-                            OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
-                        }
-                    }
-                }
-                break;
-
                 case OC_EVENT_KEYBOARD_KEY:
                 {
-                    if(event->key.action == OC_KEY_PRESS)
-                    {
-                        if(event->key.keyCode == OC_KEY_D
-                           && (event->key.mods & OC_KEYMOD_SHIFT)
-                           && (event->key.mods & OC_KEYMOD_MAIN_MODIFIER))
-                        {
-                            debug_overlay_toggle(&app->debugOverlay);
-                        }
-
-                        if(exports[OC_EXPORT_KEY_DOWN])
-                        {
-                            const void* args[2] = { &event->key.scanCode, &event->key.keyCode };
-                            M3Result res = m3_Call(exports[OC_EXPORT_KEY_DOWN], 2, args);
-                            if(res)
-                            {
-                                OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
-                            }
-                        }
-                    }
-                    else if(event->key.action == OC_KEY_RELEASE)
+                    if(event->key.action == OC_KEY_PRESS
+                       && event->key.keyCode == OC_KEY_D
+                       && (event->key.mods & OC_KEYMOD_SHIFT)
+                       && (event->key.mods & OC_KEYMOD_MAIN_MODIFIER))
                     {
-                        if(exports[OC_EXPORT_KEY_UP])
-                        {
-                            const void* args[2] = { &event->key.scanCode, &event->key.keyCode };
-                            M3Result res = m3_Call(exports[OC_EXPORT_KEY_UP], 2, args);
-                            if(res)
-                            {
-                                OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
-                            }
-                        }
+                        debug_overlay_toggle(&app->debugOverlay);
                     }
                 }
                 break;
@@ -811,24 +1148,33 @@ i32 orca_runloop(void* user)
                 default:
                     break;
             }
+
+            //NOTE: with oc_on_events(), the typed handlers are called when the batch is flushed
+            if(!exports[OC_EXPORT_EVENTS])
+            {
+                oc_runtime_dispatch_typed_event(app, event);
+            }
+        }
+
+        if(exports[OC_EXPORT_EVENTS])
+        {
+            oc_runtime_flush_event_batch(app);
         }
 
         oc_surface_deselect();
 
+        //NOTE: clear the request before the refresh, so that a request made by the refresh schedules the next frame
+        app->frameRequested = false;
+
         if(exports[OC_EXPORT_FRAME_REFRESH])
         {
-            M3Result res = m3_Call(exports[OC_EXPORT_FRAME_REFRESH], 0, 0);
-            if(res)
-            {
-                OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
-            }
+            oc_runtime_call_export(app, OC_EXPORT_FRAME_REFRESH, 0, 0);
         }
 
-        oc_surface_select(app->debugOverlay.surface);
-        oc_canvas_select(app->debugOverlay.canvas);
-
         if(app->debugOverlay.show)
         {
+            oc_surface_select(app->debugOverlay.surface);
+            oc_canvas_select(app->debugOverlay.canvas);
             oc_surface_bring_to_front(app->debugOverlay.surface);
 
             oc_ui_style debugUIDefaultStyle = { .bgColor = { 0 },
@@ -900,6 +1246,33 @@ i32 orca_runloop(void* user)
                                 app->debugOverlay.entryCount--;
                             }
                         }
+
+                        M3CompileStats compileStats;
+                        m3_GetCompileStats(app->env.m3Runtime, &compileStats);
+
+                        oc_str8 compileLabel = oc_str8_pushf(scratch.arena,
+                                                             "wasm: %u/%u functions compiled (%s), %.2fms, %u jitted (%u bytes)",
+                                                             compileStats.numCompiledFunctions,
+                                                             compileStats.numFunctions,
+                                                             app->options.lazyCompile ? "lazy" : "eager",
+                                                             compileStats.compileTime * 1000,
+                                                             compileStats.numJitFunctions,
+                                                             compileStats.jitCodeBytes);
+                        oc_ui_label_str8(compileLabel);
+
+                        oc_canvas_render_stats renderStats = oc_surface_canvas_render_stats(app->debugOverlay.guestCanvasSurface);
+                        oc_str8 renderLabel = oc_str8_pushf(scratch.arena,
+                                                            "canvas: %u primitives, %u batches, %u images in %u atlas pages (%u defrags), %u/%u tiles redrawn, path cache %u hits %u misses",
+                                                            renderStats.primitiveCount,
+                                                            renderStats.batchCount,
+                                                            renderStats.atlasedImageCount,
+                                                            renderStats.atlasPageCount,
+                                                            renderStats.atlasDefragCount,
+                                                            renderStats.dirtyTileCount,
+                                                            renderStats.tileCount,
+                                                            renderStats.pathCacheHitCount,
+                                                            renderStats.pathCacheMissCount);
+                        oc_ui_label_str8(renderLabel);
                     }
 
                     oc_ui_style_next(&(oc_ui_style){ .size.width = { OC_UI_SIZE_PARENT, 1 },
@@ -921,23 +1294,27 @@ i32 orca_runloop(void* user)
                         scrollY = panel->scroll.y;
                     }
 
-                    oc_ui_panel("log view", OC_UI_FLAG_SCROLL_WHEEL_Y)
+                    //NOTE: only build the entries that are in view
+                    oc_ui_list_info logList = { .rowCount = app->debugOverlay.entryCount,
+                                                .rowHeight = app->debugOverlay.logEntryHeight };
+
+                    oc_ui_list("log view", OC_UI_FLAG_SCROLL_WHEEL_Y, &logList)
                     {
                         panel = oc_ui_box_top()->parent;
 
-                        oc_ui_style_next(&(oc_ui_style){ .size.width = { OC_UI_SIZE_PARENT, 1 },
-                                                         .size.height = { OC_UI_SIZE_CHILDREN },
-                                                         .layout.axis = OC_UI_AXIS_Y,
-                                                         .layout.margin.y = 5 },
-                                         OC_UI_STYLE_SIZE
-                                             | OC_UI_STYLE_LAYOUT_AXIS);
-
-                        oc_ui_container("contents", 0)
+                        log_entry* entry = oc_list_first_entry(app->debugOverlay.logEntries, log_entry, listElt);
+                        for(u64 i = 0; entry && i < logList.firstRow; i++)
                         {
-                            oc_list_for(app->debugOverlay.logEntries, entry, log_entry, listElt)
+                            entry = oc_list_next_entry(app->debugOverlay.logEntries, entry, log_entry, listElt);
+                        }
+                        for(u64 i = logList.firstRow; entry && i < logList.endRow; i++)
+                        {
+                            oc_ui_box* row = log_entry_ui(&app->debugOverlay, entry);
+                            if(!row->fresh && row->rect.h > 0)
                             {
-                                log_entry_ui(&app->debugOverlay, entry);
+                                app->debugOverlay.logEntryHeight = row->rect.h;
                             }
+                            entry = oc_list_next_entry(app->debugOverlay.logEntries, entry, log_entry, listElt);
                         }
                     }
                     if(app->debugOverlay.logScrollToLast)
@@ -959,32 +1336,72 @@ i32 orca_runloop(void* user)
             }
 
             oc_ui_draw();
+
+            oc_render(app->debugOverlay.canvas);
+            oc_surface_present(app->debugOverlay.surface);
+            app->debugOverlay.cleared = false;
         }
-        else
+        else if(!app->debugOverlay.cleared)
         {
+            //NOTE: present a single transparent frame when the overlay gets hidden, then leave the surface alone
+            oc_surface_select(app->debugOverlay.surface);
+            oc_canvas_select(app->debugOverlay.canvas);
             oc_set_color_rgba(0, 0, 0, 0);
             oc_clear();
+            oc_render(app->debugOverlay.canvas);
+            oc_surface_present(app->debugOverlay.surface);
+            app->debugOverlay.cleared = true;
         }
 
-        oc_render(app->debugOverlay.canvas);
-        oc_surface_present(app->debugOverlay.surface);
-
         oc_scratch_end(scratch);
 
-#if OC_PLATFORM_WINDOWS
+        oc_runtime_timings_end_frame(&app->timings, 0);
+
+#if OC_PLATFORM_WINDOWS || OC_PLATFORM_LINUX
         //NOTE(martin): on windows we set all surfaces to non-synced, and do a single "manual" wait here.
         //              on macOS each surface is individually synced to the monitor refresh rate but don't block each other
-        oc_vsync_wait(app->window);
+        //NOTE: replays run frames back to back on their virtual clock
+        if(!app->replay.file)
+        {
+            oc_vsync_wait(app->window);
+        }
 #endif
+
+        //NOTE: in on-demand mode, sleep until the next event unless something needs another frame. The overlay
+        //      displays live stats, pending image uploads only progress when the guest renders, and replays run
+        //      their frames back to back.
+        if(app->onDemandFrames
+           && !app->quit
+           && !app->frameRequested
+           && !app->debugOverlay.show
+           && !app->replay.file
+           && !oc_image_loader_busy())
+        {
+            oc_wait_event(-1);
+        }
     }
 
+    oc_runtime_timings_begin_frame(&app->timings);
+
     if(exports[OC_EXPORT_TERMINATE])
     {
-        M3Result res = m3_Call(exports[OC_EXPORT_TERMINATE], 0, 0);
-        if(res)
-        {
-            OC_WASM3_TRAP(app->env.m3Runtime, res, "Runtime error");
-        }
+        oc_runtime_call_export(app, OC_EXPORT_TERMINATE, 0, 0);
+    }
+
+    oc_runtime_timings_end_frame(&app->timings, "terminate");
+
+    oc_runtime_replay_close(&app->replay);
+    oc_runtime_recorder_close(&app->recorder);
+    oc_runtime_timings_close(&app->timings);
+
+    if(app->options.lazyCompile)
+    {
+        //NOTE: save the functions compiled during this run, so that the next launch doesn't have to compile them again
+        oc_arena_scope scratch = oc_scratch_begin();
+        oc_str8 modulePath = oc_path_executable_relative(scratch.arena, OC_STR8("../app/wasm/module.wasm"));
+        oc_str8 cachePath = oc_runtime_code_cache_path(scratch.arena, modulePath);
+        oc_runtime_code_cache_store(app->env.m3Module, cachePath);
+        oc_scratch_end(scratch);
     }
 
     oc_request_quit();
@@ -1001,6 +1418,41 @@ int main(int argc, char** argv)
 
     oc_runtime* app = &__orcaApp;
 
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--lazy-compile"))
+        {
+            app->options.lazyCompile = true;
+        }
+        else if(!strcmp(argv[i], "--jit"))
+        {
+            app->options.jit = true;
+        }
+        else if(!strcmp(argv[i], "--coalesce-mouse-moves"))
+        {
+            app->options.coalesceMouseMoves = true;
+        }
+        else if(!strcmp(argv[i], "--snapshot"))
+        {
+            app->options.snapshot = true;
+        }
+        else if(!strcmp(argv[i], "--replay-events") && i + 1 < argc)
+        {
+            i++;
+            oc_runtime_replay_open(&app->replay, OC_STR8(argv[i]));
+        }
+        else if(!strcmp(argv[i], "--record-events") && i + 1 < argc)
+        {
+            i++;
+            oc_runtime_recorder_open(&app->recorder, OC_STR8(argv[i]));
+        }
+        else if(!strcmp(argv[i], "--timings") && i + 1 < argc)
+        {
+            i++;
+            oc_runtime_timings_open(&app->timings, OC_STR8(argv[i]));
+        }
+    }
+
     //NOTE: create window and surfaces
     oc_rect windowRect = { .x = 100, .y = 100, .w = 810, .h = 610 };
     app->window = oc_window_create(windowRect, OC_STR8("orca"), 0);
@@ -1008,12 +1460,14 @@ int main(int argc, char** argv)
     app->debugOverlay.show = false;
     app->debugOverlay.surface = oc_surface_create_for_window(app->window, OC_CANVAS);
     app->debugOverlay.canvas = oc_canvas_create();
+    oc_set_glyph_raster_cache(true);
     app->debugOverlay.fontReg = orca_font_create("../resources/Menlo.ttf");
     app->debugOverlay.fontBold = orca_font_create("../resources/Menlo Bold.ttf");
     app->debugOverlay.maxEntries = 200;
+    app->debugOverlay.logEntryHeight = 40;
     oc_arena_init(&app->debugOverlay.logArena);
 
-#if OC_PLATFORM_WINDOWS
+#if OC_PLATFORM_WINDOWS || OC_PLATFORM_LINUX
     //NOTE(martin): on windows we set all surfaces to non-synced, and do a single "manual" wait here.
     //              on macOS each surface is individually synced to the monitor refresh rate but don't block each other
     oc_surface_swap_interval(app->debugOverlay.surface, 0);
@@ -11,6 +11,9 @@
 #include "platform/platform_io_internal.h"
 #include "runtime_memory.h"
 #include "runtime_clipboard.h"
+#include "runtime_code_cache.h"
+#include "runtime_replay.h"
+#include "runtime_snapshot.h"
 
 #include "m3_compile.h"
 #include "m3_env.h"
@@ -18,6 +21,7 @@
 
 #define OC_EXPORTS(X)                                         \
     X(OC_EXPORT_ON_INIT, "oc_on_init", "", "")                \
+    X(OC_EXPORT_ON_RESTORE, "oc_on_restore", "", "")          \
     X(OC_EXPORT_MOUSE_DOWN, "oc_on_mouse_down", "", "i")      \
     X(OC_EXPORT_MOUSE_UP, "oc_on_mouse_up", "", "i")          \
     X(OC_EXPORT_MOUSE_ENTER, "oc_on_mouse_enter", "", "")     \
@@ -29,6 +33,7 @@
     X(OC_EXPORT_FRAME_REFRESH, "oc_on_frame_refresh", "", "") \
     X(OC_EXPORT_FRAME_RESIZE, "oc_on_resize", "", "ii")       \
     X(OC_EXPORT_RAW_EVENT, "oc_on_raw_event", "", "i")        \
+    X(OC_EXPORT_EVENTS, "oc_on_events", "", "ii")             \
     X(OC_EXPORT_TERMINATE, "oc_on_terminate", "", "")         \
     X(OC_EXPORT_ARENA_PUSH, "oc_arena_push_stub", "i", "iI")
 
@@ -75,6 +80,8 @@ typedef struct oc_wasm_env
     IM3Module m3Module;
     IM3Function exports[OC_EXPORT_COUNT];
     u32 rawEventOffset;
+    u32 rawEventBatchOffset;
+    u32 rawEventBatchCount;
 
 } oc_wasm_env;
 
@@ -98,9 +105,11 @@ typedef struct oc_debug_overlay
     bool show;
     oc_surface surface;
     oc_canvas canvas;
+    oc_surface guestCanvasSurface; // last canvas surface created by the guest, whose render stats are displayed
     oc_font fontReg;
     oc_font fontBold;
     oc_ui_context ui;
+    bool cleared; // a transparent frame was presented since the overlay was hidden
 
     oc_arena logArena;
     oc_list logEntries;
@@ -109,12 +118,35 @@ typedef struct oc_debug_overlay
     u32 maxEntries;
     u64 logEntryTotalCount;
     bool logScrollToLast;
+    f32 logEntryHeight; // measured on entries that were laid out, used to estimate the size of the others
 
 } oc_debug_overlay;
 
+typedef struct oc_runtime_options
+{
+    bool lazyCompile;        // compile wasm functions on their first call instead of at startup
+    bool jit;                // translate hot wasm functions to machine code (x86-64 only)
+    bool coalesceMouseMoves; // merge consecutive mouse moves passed to oc_on_events() and oc_on_mouse_move()
+    bool snapshot;           // restore the guest's state after oc_on_init() from a previous launch
+
+} oc_runtime_options;
+
+//NOTE: per-frame time spent in each export handler, written as CSV rows with --timings
+typedef struct oc_runtime_timings
+{
+    FILE* file;
+    u64 frame;
+    f64 frameStart;
+    f64 exportTime[OC_EXPORT_COUNT];
+
+} oc_runtime_timings;
+
 typedef struct oc_runtime
 {
     bool quit;
+    bool onDemandFrames; // set once the guest calls oc_request_frame()
+    bool frameRequested;
+    oc_runtime_options options;
     oc_window window;
     oc_debug_overlay debugOverlay;
 
@@ -124,6 +156,10 @@ typedef struct oc_runtime
     oc_wasm_env env;
 
     oc_runtime_clipboard clipboard;
+
+    oc_runtime_replay replay;
+    oc_runtime_recorder recorder;
+    oc_runtime_timings timings;
 } oc_runtime;
 
 oc_runtime* oc_runtime_get(void);
@@ -8,7 +8,7 @@
 
 #include "runtime_clipboard.h"
 
-#if OC_PLATFORM_WINDOWS || OC_PLATFORM_MACOS
+#if OC_PLATFORM_WINDOWS || OC_PLATFORM_MACOS || OC_PLATFORM_LINUX
 
 oc_wasm_str8 oc_runtime_clipboard_get_string(oc_runtime_clipboard* clipboard, oc_wasm_addr wasmArena)
 {
@@ -55,7 +55,7 @@ oc_event* oc_runtime_clipboard_process_event_begin(oc_arena* arena, oc_runtime_c
     {
         bool isPressedOrRepeated = origEvent->key.action == OC_KEY_PRESS || origEvent->key.action == OC_KEY_REPEAT;
         oc_keymod_flags rawMods = origEvent->key.mods & ~OC_KEYMOD_MAIN_MODIFIER;
-    #if OC_PLATFORM_WINDOWS
+    #if OC_PLATFORM_WINDOWS || OC_PLATFORM_LINUX
         bool cutOrCopied = isPressedOrRepeated
                         && ((origEvent->key.keyCode == OC_KEY_X && rawMods == OC_KEYMOD_CTRL)
                             || (origEvent->key.keyCode == OC_KEY_DELETE && rawMods == OC_KEYMOD_SHIFT)
@@ -0,0 +1,247 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+
+#include "runtime_code_cache.h"
+
+#if OC_PLATFORM_WINDOWS
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+typedef struct oc_code_cache_mapping
+{
+    char* ptr;
+    u64 len;
+#if OC_PLATFORM_WINDOWS
+    HANDLE file;
+    HANDLE mapping;
+#endif
+} oc_code_cache_mapping;
+
+static bool oc_code_cache_map(oc_str8 path, oc_code_cache_mapping* mapping)
+{
+    memset(mapping, 0, sizeof(oc_code_cache_mapping));
+
+#if OC_PLATFORM_WINDOWS
+    mapping->file = CreateFileA(path.ptr, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if(mapping->file == INVALID_HANDLE_VALUE)
+    {
+        return (false);
+    }
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(mapping->file, &size) || size.QuadPart == 0 || size.QuadPart > UINT32_MAX)
+    {
+        CloseHandle(mapping->file);
+        return (false);
+    }
+    mapping->mapping = CreateFileMappingA(mapping->file, 0, PAGE_READONLY, 0, 0, 0);
+    if(!mapping->mapping)
+    {
+        CloseHandle(mapping->file);
+        return (false);
+    }
+    mapping->ptr = (char*)MapViewOfFile(mapping->mapping, FILE_MAP_READ, 0, 0, 0);
+    if(!mapping->ptr)
+    {
+        CloseHandle(mapping->mapping);
+        CloseHandle(mapping->file);
+        return (false);
+    }
+    mapping->len = size.QuadPart;
+#else
+    int fd = open(path.ptr, O_RDONLY);
+    if(fd < 0)
+    {
+        return (false);
+    }
+    struct stat st;
+    if(fstat(fd, &st) || st.st_size == 0 || st.st_size > UINT32_MAX)
+    {
+        close(fd);
+        return (false);
+    }
+    void* ptr = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(ptr == MAP_FAILED)
+    {
+        return (false);
+    }
+    mapping->ptr = (char*)ptr;
+    mapping->len = st.st_size;
+#endif
+    return (true);
+}
+
+static void oc_code_cache_unmap(oc_code_cache_mapping* mapping)
+{
+#if OC_PLATFORM_WINDOWS
+    UnmapViewOfFile(mapping->ptr);
+    CloseHandle(mapping->mapping);
+    CloseHandle(mapping->file);
+#else
+    munmap(mapping->ptr, mapping->len);
+#endif
+}
+
+static bool oc_code_cache_create_directories(oc_str8 path)
+{
+    oc_arena_scope scratch = oc_scratch_begin();
+    char* cpath = oc_str8_to_cstring(scratch.arena, path);
+    bool result = true;
+
+    //NOTE: create the intermediate directories, skipping the root (or drive letter on windows)
+    for(char* c = cpath + 1; *c; c++)
+    {
+        if(*c == '/')
+        {
+            *c = '\0';
+#if OC_PLATFORM_WINDOWS
+            CreateDirectoryA(cpath, 0);
+#else
+            mkdir(cpath, 0755);
+#endif
+            *c = '/';
+        }
+    }
+#if OC_PLATFORM_WINDOWS
+    if(!CreateDirectoryA(cpath, 0) && GetLastError() != ERROR_ALREADY_EXISTS)
+#else
+    if(mkdir(cpath, 0755) && errno != EEXIST)
+#endif
+    {
+        result = false;
+    }
+    oc_scratch_end(scratch);
+    return (result);
+}
+
+oc_str8 oc_runtime_code_cache_path(oc_arena* arena, oc_str8 modulePath)
+{
+    oc_str8 result = {};
+    oc_arena_scope scratch = oc_scratch_begin_next(arena);
+
+    oc_str8 cacheDir = oc_path_user_cache_directory(scratch.arena);
+    if(cacheDir.len)
+    {
+        cacheDir = oc_path_append(scratch.arena, cacheDir, OC_STR8("orca/code_cache"));
+        if(oc_code_cache_create_directories(cacheDir))
+        {
+            //NOTE: the file is named after the module path, so that different apps don't evict each other's cache
+            oc_str8 fileName = oc_str8_pushf(scratch.arena, "%016llx.m3cache", (unsigned long long)oc_hash_xx64_string(modulePath));
+            result = oc_path_append(arena, cacheDir, fileName);
+        }
+        else
+        {
+            oc_log_warning("couldn't create code cache directory %.*s\n", oc_str8_ip(cacheDir));
+        }
+    }
+    oc_scratch_end(scratch);
+    return (result);
+}
+
+bool oc_runtime_code_cache_load(IM3Module module, oc_str8 path, bool* complete)
+{
+    *complete = false;
+
+    oc_code_cache_mapping mapping;
+    if(!path.len || !oc_code_cache_map(path, &mapping))
+    {
+        return (false);
+    }
+
+    //NOTE: the loader validates the whole cache before touching the module, so on failure we can
+    //      just fall back to a normal compile.
+    int isComplete = 0;
+    M3Result res = m3_GetCompiledModuleInfo((u8*)mapping.ptr, (u32)mapping.len, &isComplete);
+    if(!res)
+    {
+        res = m3_LoadCompiledModule(module, (u8*)mapping.ptr, (u32)mapping.len);
+    }
+    oc_code_cache_unmap(&mapping);
+
+    *complete = (res == m3Err_none) && isComplete;
+
+    if(res == m3Err_codeCacheStale)
+    {
+        oc_log_info("code cache is stale, recompiling\n");
+    }
+    else if(res)
+    {
+        oc_log_warning("couldn't load code cache: %s\n", res);
+    }
+    return (res == m3Err_none);
+}
+
+void oc_runtime_code_cache_store(IM3Module module, oc_str8 path)
+{
+    if(!path.len)
+    {
+        return;
+    }
+    oc_arena_scope scratch = oc_scratch_begin();
+
+    u32 size = 0;
+    M3Result res = m3_SerializeCompiledModule(module, 0, 0, &size);
+    if(res)
+    {
+        if(res != m3Err_codeCacheDisabled)
+        {
+            oc_log_warning("couldn't serialize compiled module: %s\n", res);
+        }
+        goto end;
+    }
+
+    u8* buffer = (u8*)oc_arena_push_aligned(scratch.arena, size, 8);
+    res = m3_SerializeCompiledModule(module, buffer, size, &size);
+    if(res)
+    {
+        oc_log_warning("couldn't serialize compiled module: %s\n", res);
+        goto end;
+    }
+
+    //NOTE: write to a temporary file and move it in place, so that an interrupted write can't leave
+    //      a truncated cache behind.
+    oc_str8 tmpPath = oc_str8_pushf(scratch.arena, "%.*s.tmp", oc_str8_ip(path));
+
+    FILE* file = fopen(tmpPath.ptr, "wb");
+    if(!file)
+    {
+        oc_log_warning("couldn't open code cache file %.*s\n", oc_str8_ip(tmpPath));
+        goto end;
+    }
+    u64 written = fwrite(buffer, 1, size, file);
+    fclose(file);
+
+    if(written != size)
+    {
+        oc_log_warning("couldn't write code cache file %.*s\n", oc_str8_ip(tmpPath));
+        remove(tmpPath.ptr);
+        goto end;
+    }
+
+#if OC_PLATFORM_WINDOWS
+    bool moved = MoveFileExA(tmpPath.ptr, path.ptr, MOVEFILE_REPLACE_EXISTING);
+#else
+    bool moved = (rename(tmpPath.ptr, path.ptr) == 0);
+#endif
+    if(!moved)
+    {
+        oc_log_warning("couldn't move code cache file to %.*s\n", oc_str8_ip(path));
+        remove(tmpPath.ptr);
+    }
+
+end:
+    oc_scratch_end(scratch);
+}
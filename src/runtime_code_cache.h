@@ -0,0 +1,29 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+
+#ifndef __RUNTIME_CODE_CACHE_H_
+#define __RUNTIME_CODE_CACHE_H_
+
+#include "wasm3.h"
+
+//NOTE: The code cache stores the compiled code pages of the app's module, so that the next launch
+//      can skip m3_CompileModule. It is keyed by a hash of the bytecode and of the wasm3 build, and
+//      is simply recompiled and overwritten when stale.
+//
+//      The cache contains code pointers, so it must never be placed where the guest can write to it
+//      (ie under the app's data directory). It also can't go into the app bundle, which may be read-only
+//      or signed, so it lives in a runtime-owned directory under the user's cache directory, in a file
+//      named after the module path.
+
+oc_str8 oc_runtime_code_cache_path(oc_arena* arena, oc_str8 modulePath);
+
+// complete is set if the cache holds the code of every function, ie it wasn't written by a lazy compile run
+bool oc_runtime_code_cache_load(IM3Module module, oc_str8 path, bool* complete);
+void oc_runtime_code_cache_store(IM3Module module, oc_str8 path);
+
+#endif //__RUNTIME_CODE_CACHE_H_
@@ -9,30 +9,145 @@
 #include "runtime.h"
 #include "runtime_memory.h"
 
+//NOTE: the wasm3 memory header is placed just below a 64K boundary, so that the linear memory itself is
+//      page aligned (which lets snapshots map it straight from a file), and so that its end, always a
+//      multiple of 64K, lands exactly at the end of the committed pages.
+enum
+{
+    OC_WASM_MEMORY_DATA_OFFSET = 64 << 10,
+    OC_WASM_MEMORY_HEADER_OFFSET = OC_WASM_MEMORY_DATA_OFFSET - sizeof(M3MemoryHeader),
+};
+
+#if d_m3SkipMemoryBoundsCheck
+    #if OC_PLATFORM_WINDOWS
+        #define WIN32_LEAN_AND_MEAN
+        #include <windows.h>
+    #else
+        #include <signal.h>
+        #include <sys/mman.h>
+    #endif
+
+//NOTE: wasm3 was built without memory bounds checks, so we reserve everything a guest access can reach
+//      (a 32-bit address plus a 32-bit offset, plus the access size) and leave it uncommitted past the end
+//      of the linear memory. Out of bounds accesses then fault, and we turn the fault into a wasm trap.
+    #define OC_WASM_MEMORY_RESERVE (OC_WASM_MEMORY_DATA_OFFSET + (8ULL << 30) + (64ULL << 10))
+
+static bool oc_wasm_memory_is_guard_fault(void* addr)
+{
+    oc_wasm_memory* memory = &oc_runtime_get_env()->wasmMemory;
+    char* p = (char*)addr;
+    return (memory->ptr
+            && p >= memory->ptr + memory->committed
+            && p < memory->ptr + memory->reserved);
+}
+
+    #if OC_PLATFORM_WINDOWS
+
+static LONG WINAPI oc_wasm_memory_fault_handler(EXCEPTION_POINTERS* exception)
+{
+    EXCEPTION_RECORD* record = exception->ExceptionRecord;
+    if(record->ExceptionCode == EXCEPTION_ACCESS_VIOLATION
+       && record->NumberParameters >= 2
+       && oc_wasm_memory_is_guard_fault((void*)record->ExceptionInformation[1]))
+    {
+        //NOTE: we're on the faulting thread, inside the guest call. oc_wasm3_trap() doesn't return.
+        OC_WASM3_TRAP(oc_runtime_get_env()->m3Runtime, m3Err_trapOutOfBoundsMemoryAccess, "Runtime error");
+    }
+    return (EXCEPTION_CONTINUE_SEARCH);
+}
+
+static void oc_wasm_memory_install_fault_handler(void)
+{
+    AddVectoredExceptionHandler(1, oc_wasm_memory_fault_handler);
+}
+
+    #else
+
+static void oc_wasm_memory_fault_handler(int sig, siginfo_t* info, void* context)
+{
+    if(oc_wasm_memory_is_guard_fault(info->si_addr))
+    {
+        //NOTE: we're on the faulting thread, inside the guest call. oc_wasm3_trap() doesn't return.
+        OC_WASM3_TRAP(oc_runtime_get_env()->m3Runtime, m3Err_trapOutOfBoundsMemoryAccess, "Runtime error");
+    }
+    else
+    {
+        //NOTE: not a guest access. Restore the default action and return, so that the access faults again.
+        signal(sig, SIG_DFL);
+    }
+}
+
+static void oc_wasm_memory_install_fault_handler(void)
+{
+    struct sigaction action = { 0 };
+    action.sa_sigaction = oc_wasm_memory_fault_handler;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+
+    //NOTE: macOS reports accesses to reserved pages as SIGBUS, Linux as SIGSEGV
+    sigaction(SIGSEGV, &action, 0);
+    sigaction(SIGBUS, &action, 0);
+}
+
+    #endif
+
+#else
+
+    #define OC_WASM_MEMORY_RESERVE (OC_WASM_MEMORY_DATA_OFFSET + (4ULL << 30))
+
+#endif // d_m3SkipMemoryBoundsCheck
+
+void oc_wasm_memory_reserve(oc_wasm_memory* memory)
+{
+    memory->committed = 0;
+    memory->reserved = OC_WASM_MEMORY_RESERVE;
+
+#if d_m3SkipMemoryBoundsCheck && !OC_PLATFORM_WINDOWS
+    //NOTE: the default allocator maps reserved memory read/write on POSIX systems, which would defeat the guard
+    //      pages, so we map the reservation inaccessible ourselves and make pages accessible as they're committed.
+    memory->ptr = mmap(0, memory->reserved, PROT_NONE, MAP_ANON | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+    if(memory->ptr == MAP_FAILED)
+    {
+        OC_ABORT("Couldn't reserve wasm memory");
+    }
+#else
+    oc_base_allocator* allocator = oc_base_allocator_default();
+    memory->ptr = oc_base_reserve(allocator, memory->reserved);
+#endif
+
+#if d_m3SkipMemoryBoundsCheck
+    oc_wasm_memory_install_fault_handler();
+#endif
+}
+
 void* oc_wasm_memory_resize_callback(void* p, unsigned long newSize, void* userData)
 {
     //NOTE: this is called by wasm3. The size passed includes wasm3 memory header.
     //      We first align it on 4K page size
 
-    newSize = oc_align_up_pow2(newSize, 4 << 10);
-
     oc_wasm_memory* memory = (oc_wasm_memory*)userData;
 
-    if(memory->committed >= newSize)
+    u64 commitEnd = oc_align_up_pow2(OC_WASM_MEMORY_HEADER_OFFSET + (u64)newSize, 4 << 10);
+
+    if(memory->committed >= commitEnd)
     {
-        return (memory->ptr);
+        return (memory->ptr + OC_WASM_MEMORY_HEADER_OFFSET);
     }
-    else if(newSize <= memory->reserved)
+    else if(commitEnd <= memory->reserved)
     {
-        u32 commitSize = newSize - memory->committed;
+        u64 commitSize = commitEnd - memory->committed;
 
+#if d_m3SkipMemoryBoundsCheck && !OC_PLATFORM_WINDOWS
+        mprotect(memory->ptr + memory->committed, commitSize, PROT_READ | PROT_WRITE);
+#else
         oc_base_allocator* allocator = oc_base_allocator_default();
         oc_base_commit(allocator, memory->ptr + memory->committed, commitSize);
+#endif
         memory->committed += commitSize;
 
         OC_DEBUG_ASSERT((memory->committed & 0xfff) == 0, "Committed pointer is not aligned on page size");
 
-        return (memory->ptr);
+        return (memory->ptr + OC_WASM_MEMORY_HEADER_OFFSET);
     }
     else
     {
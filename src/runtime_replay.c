@@ -0,0 +1,319 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+
+#include "runtime_replay.h"
+
+typedef struct oc_replay_event_kind
+{
+    oc_event_type type;
+    const char* name;
+
+} oc_replay_event_kind;
+
+static const oc_replay_event_kind OC_REPLAY_EVENT_KINDS[] = {
+    { OC_EVENT_KEYBOARD_MODS, "mods" },
+    { OC_EVENT_KEYBOARD_KEY, "key" },
+    { OC_EVENT_KEYBOARD_CHAR, "char" },
+    { OC_EVENT_MOUSE_BUTTON, "mouse_button" },
+    { OC_EVENT_MOUSE_MOVE, "mouse_move" },
+    { OC_EVENT_MOUSE_WHEEL, "mouse_wheel" },
+    { OC_EVENT_MOUSE_ENTER, "mouse_enter" },
+    { OC_EVENT_MOUSE_LEAVE, "mouse_leave" },
+    { OC_EVENT_WINDOW_RESIZE, "resize" },
+    { OC_EVENT_WINDOW_MOVE, "move" },
+    { OC_EVENT_WINDOW_FOCUS, "focus" },
+    { OC_EVENT_WINDOW_UNFOCUS, "unfocus" },
+    { OC_EVENT_WINDOW_HIDE, "hide" },
+    { OC_EVENT_WINDOW_SHOW, "show" },
+    { OC_EVENT_WINDOW_CLOSE, "close" },
+    { OC_EVENT_QUIT, "quit" },
+};
+
+static const char* oc_replay_event_kind_name(oc_event_type type)
+{
+    for(int i = 0; i < oc_array_size(OC_REPLAY_EVENT_KINDS); i++)
+    {
+        if(OC_REPLAY_EVENT_KINDS[i].type == type)
+        {
+            return (OC_REPLAY_EVENT_KINDS[i].name);
+        }
+    }
+    return (0);
+}
+
+//------------------------------------------------------------------------
+// replay
+//------------------------------------------------------------------------
+
+bool oc_runtime_replay_open(oc_runtime_replay* replay, oc_str8 path)
+{
+    memset(replay, 0, sizeof(oc_runtime_replay));
+
+    oc_arena_scope scratch = oc_scratch_begin();
+    replay->file = fopen(oc_str8_to_cstring(scratch.arena, path), "r");
+    oc_scratch_end(scratch);
+
+    if(!replay->file)
+    {
+        oc_log_error("couldn't open event log %.*s\n", oc_str8_ip(path));
+        return (false);
+    }
+    replay->startDate = oc_clock_time(OC_CLOCK_DATE);
+    return (true);
+}
+
+void oc_runtime_replay_close(oc_runtime_replay* replay)
+{
+    if(replay->file)
+    {
+        fclose(replay->file);
+    }
+    memset(replay, 0, sizeof(oc_runtime_replay));
+}
+
+void oc_runtime_replay_begin_frame(oc_runtime_replay* replay)
+{
+    replay->time = (f64)replay->frame / OC_REPLAY_FRAMES_PER_SECOND;
+    replay->frame++;
+}
+
+f64 oc_runtime_replay_clock(oc_runtime_replay* replay, oc_clock_kind clock)
+{
+    f64 time = replay->time;
+    if(clock == OC_CLOCK_DATE)
+    {
+        time += replay->startDate;
+    }
+    return (time);
+}
+
+static bool oc_runtime_replay_parse_line(oc_runtime_replay* replay, char* line, f64* time, oc_event* event)
+{
+    char name[32];
+    int offset = 0;
+    if(sscanf(line, "%lf %31s%n", time, name, &offset) != 2)
+    {
+        return (false);
+    }
+    char* fields = line + offset;
+
+    memset(event, 0, sizeof(oc_event));
+    event->type = OC_EVENT_NONE;
+    for(int i = 0; i < oc_array_size(OC_REPLAY_EVENT_KINDS); i++)
+    {
+        if(!strcmp(OC_REPLAY_EVENT_KINDS[i].name, name))
+        {
+            event->type = OC_REPLAY_EVENT_KINDS[i].type;
+            break;
+        }
+    }
+
+    bool ok = true;
+    switch(event->type)
+    {
+        case OC_EVENT_NONE:
+            ok = false;
+            break;
+
+        case OC_EVENT_KEYBOARD_MODS:
+        {
+            int mods = 0;
+            ok = (sscanf(fields, "%i", &mods) == 1);
+            event->key.mods = mods;
+        }
+        break;
+
+        case OC_EVENT_KEYBOARD_KEY:
+        {
+            int action = 0, scanCode = 0, keyCode = 0, mods = 0;
+            ok = (sscanf(fields, "%i %i %i %i", &action, &scanCode, &keyCode, &mods) == 4)
+              && scanCode >= 0 && scanCode < OC_SCANCODE_COUNT;
+            event->key.action = action;
+            event->key.scanCode = scanCode;
+            event->key.keyCode = keyCode;
+            event->key.mods = mods;
+        }
+        break;
+
+        case OC_EVENT_KEYBOARD_CHAR:
+        {
+            u32 codepoint = 0;
+            ok = (sscanf(fields, "%u", &codepoint) == 1);
+            event->character.codepoint = codepoint;
+            oc_str8 seq = oc_utf8_encode(event->character.sequence, event->character.codepoint);
+            event->character.seqLen = seq.len;
+        }
+        break;
+
+        case OC_EVENT_MOUSE_BUTTON:
+        {
+            int action = 0, button = 0, mods = 0, clickCount = 0;
+            ok = (sscanf(fields, "%i %i %i %i", &action, &button, &mods, &clickCount) == 4)
+              && button >= 0 && button < OC_MOUSE_BUTTON_COUNT;
+            event->key.action = action;
+            event->key.button = button;
+            event->key.mods = mods;
+            event->key.clickCount = clickCount;
+        }
+        break;
+
+        case OC_EVENT_MOUSE_MOVE:
+        case OC_EVENT_MOUSE_WHEEL:
+        {
+            int mods = 0;
+            ok = (sscanf(fields, "%f %f %f %f %i",
+                         &event->mouse.x,
+                         &event->mouse.y,
+                         &event->mouse.deltaX,
+                         &event->mouse.deltaY,
+                         &mods)
+                  == 5);
+            event->mouse.mods = mods;
+        }
+        break;
+
+        case OC_EVENT_WINDOW_RESIZE:
+        case OC_EVENT_WINDOW_MOVE:
+        {
+            oc_move_event* move = &event->move;
+            ok = (sscanf(fields, "%f %f %f %f %f %f %f %f",
+                         &move->frame.x, &move->frame.y, &move->frame.w, &move->frame.h,
+                         &move->content.x, &move->content.y, &move->content.w, &move->content.h)
+                  == 8);
+        }
+        break;
+
+        default:
+            break;
+    }
+    return (ok);
+}
+
+oc_event* oc_runtime_replay_next_event(oc_runtime_replay* replay, oc_arena* arena)
+{
+    while(!replay->hasPending && !replay->done)
+    {
+        char line[512];
+        if(!fgets(line, sizeof(line), replay->file))
+        {
+            replay->done = true;
+            break;
+        }
+        replay->line++;
+
+        char* c = line;
+        while(*c == ' ' || *c == '\t')
+        {
+            c++;
+        }
+        if(*c == '#' || *c == '\n' || *c == '\r' || *c == '\0')
+        {
+            continue;
+        }
+
+        if(oc_runtime_replay_parse_line(replay, c, &replay->pendingTime, &replay->pending))
+        {
+            replay->hasPending = true;
+        }
+        else
+        {
+            oc_log_warning("event log line %u: invalid event, skipping\n", replay->line);
+        }
+    }
+
+    oc_event* event = 0;
+    if(replay->hasPending && replay->pendingTime <= replay->time)
+    {
+        event = oc_arena_push_type(arena, oc_event);
+        *event = replay->pending;
+        replay->hasPending = false;
+    }
+    return (event);
+}
+
+//------------------------------------------------------------------------
+// recording
+//------------------------------------------------------------------------
+
+bool oc_runtime_recorder_open(oc_runtime_recorder* recorder, oc_str8 path)
+{
+    memset(recorder, 0, sizeof(oc_runtime_recorder));
+
+    oc_arena_scope scratch = oc_scratch_begin();
+    recorder->file = fopen(oc_str8_to_cstring(scratch.arena, path), "w");
+    oc_scratch_end(scratch);
+
+    if(!recorder->file)
+    {
+        oc_log_error("couldn't open event log %.*s for writing\n", oc_str8_ip(path));
+        return (false);
+    }
+    recorder->startTime = oc_clock_time(OC_CLOCK_MONOTONIC);
+    fprintf(recorder->file, "# orca event log\n");
+    return (true);
+}
+
+void oc_runtime_recorder_close(oc_runtime_recorder* recorder)
+{
+    if(recorder->file)
+    {
+        fclose(recorder->file);
+    }
+    memset(recorder, 0, sizeof(oc_runtime_recorder));
+}
+
+void oc_runtime_recorder_write(oc_runtime_recorder* recorder, oc_event* event)
+{
+    const char* name = oc_replay_event_kind_name(event->type);
+    if(!name)
+    {
+        //NOTE: clipboard pastes are synthesized by the runtime from key events, and path drops can't be replayed
+        return;
+    }
+
+    FILE* file = recorder->file;
+    fprintf(file, "%.4f %s", oc_clock_time(OC_CLOCK_MONOTONIC) - recorder->startTime, name);
+
+    switch(event->type)
+    {
+        case OC_EVENT_KEYBOARD_MODS:
+            fprintf(file, " %i", event->key.mods);
+            break;
+
+        case OC_EVENT_KEYBOARD_KEY:
+            fprintf(file, " %i %i %i %i", event->key.action, event->key.scanCode, event->key.keyCode, event->key.mods);
+            break;
+
+        case OC_EVENT_KEYBOARD_CHAR:
+            fprintf(file, " %u", event->character.codepoint);
+            break;
+
+        case OC_EVENT_MOUSE_BUTTON:
+            fprintf(file, " %i %i %i %i", event->key.action, event->key.button, event->key.mods, event->key.clickCount);
+            break;
+
+        case OC_EVENT_MOUSE_MOVE:
+        case OC_EVENT_MOUSE_WHEEL:
+            fprintf(file, " %g %g %g %g %i", event->mouse.x, event->mouse.y, event->mouse.deltaX, event->mouse.deltaY, event->mouse.mods);
+            break;
+
+        case OC_EVENT_WINDOW_RESIZE:
+        case OC_EVENT_WINDOW_MOVE:
+        {
+            oc_move_event* move = &event->move;
+            fprintf(file, " %g %g %g %g %g %g %g %g",
+                    move->frame.x, move->frame.y, move->frame.w, move->frame.h,
+                    move->content.x, move->content.y, move->content.w, move->content.h);
+        }
+        break;
+
+        default:
+            break;
+    }
+    fprintf(file, "\n");
+}
@@ -0,0 +1,77 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+
+#ifndef __RUNTIME_REPLAY_H_
+#define __RUNTIME_REPLAY_H_
+
+#include <stdio.h>
+
+#include "app/app.h"
+#include "platform/platform_clock.h"
+
+//NOTE: An event log is a text file with one event per line. Each line starts with the time, in seconds
+//      since the start of the run, at which the event is delivered, followed by the event kind and its
+//      fields. Empty lines and lines starting with '#' are ignored:
+//
+//          # time  kind          fields
+//          0.000   resize        <frame x y w h> <content x y w h>
+//          0.250   mouse_move    <x> <y> <deltaX> <deltaY> <mods>
+//          0.266   mouse_button  <action> <button> <mods> <clickCount>
+//          0.300   mouse_wheel   <x> <y> <deltaX> <deltaY> <mods>
+//          0.400   key           <action> <scanCode> <keyCode> <mods>
+//          0.400   char          <codepoint>
+//          0.500   mods          <mods>
+//          1.000   quit
+//
+//      Other kinds without fields are mouse_enter, mouse_leave, move (with the same fields as resize),
+//      focus, unfocus, hide, show and close. Enum fields use their numeric values from app.h.
+//
+//      When replaying, the runtime runs frames back to back on a virtual clock that advances by a fixed step
+//      per frame, and delivers each event on the first frame whose time is at or past its timestamp. The guest
+//      sees that virtual clock through oc_clock_time(), so that runs are reproducible. The run ends when
+//      the log is exhausted.
+
+enum
+{
+    OC_REPLAY_FRAMES_PER_SECOND = 60,
+};
+
+typedef struct oc_runtime_replay
+{
+    FILE* file;
+    u32 line;
+    bool done;
+
+    u64 frame;
+    f64 time;      // virtual time of the current frame
+    f64 startDate; // date at the start of the run, for OC_CLOCK_DATE
+
+    bool hasPending;
+    f64 pendingTime;
+    oc_event pending;
+
+} oc_runtime_replay;
+
+typedef struct oc_runtime_recorder
+{
+    FILE* file;
+    f64 startTime;
+
+} oc_runtime_recorder;
+
+bool oc_runtime_replay_open(oc_runtime_replay* replay, oc_str8 path);
+void oc_runtime_replay_close(oc_runtime_replay* replay);
+void oc_runtime_replay_begin_frame(oc_runtime_replay* replay);
+oc_event* oc_runtime_replay_next_event(oc_runtime_replay* replay, oc_arena* arena); // returns 0 when no more events are due this frame
+f64 oc_runtime_replay_clock(oc_runtime_replay* replay, oc_clock_kind clock);
+
+bool oc_runtime_recorder_open(oc_runtime_recorder* recorder, oc_str8 path);
+void oc_runtime_recorder_close(oc_runtime_recorder* recorder);
+void oc_runtime_recorder_write(oc_runtime_recorder* recorder, oc_event* event);
+
+#endif //__RUNTIME_REPLAY_H_
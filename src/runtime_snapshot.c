@@ -0,0 +1,266 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+
+#include "runtime_snapshot.h"
+
+#if OC_PLATFORM_WINDOWS
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+enum
+{
+    OC_SNAPSHOT_MAGIC = 0x4e53434f, // "OCSN"
+    OC_SNAPSHOT_VERSION = 1,
+
+    //NOTE: the linear memory is stored at an offset aligned on the largest page size we might run on,
+    //      so that it can be mapped directly over the guest's memory.
+    OC_SNAPSHOT_DATA_ALIGN = 64 << 10,
+};
+
+typedef struct oc_snapshot_header
+{
+    u32 magic;
+    u32 version;
+    u64 moduleHash;
+    u32 numPages;
+    u32 numGlobals;
+    u32 tableSize;
+    u32 dataOffset; // file offset of the linear memory
+
+} oc_snapshot_header;
+
+typedef struct oc_snapshot_global
+{
+    u32 type;
+    u32 pad;
+    u64 value[2];
+
+} oc_snapshot_global;
+
+static const u32 OC_SNAPSHOT_NULL_FUNCTION = 0xffffffff;
+
+oc_str8 oc_runtime_snapshot_path(oc_arena* arena, oc_wasm_env* env)
+{
+    oc_str8 result = {};
+    oc_arena_scope scratch = oc_scratch_begin_next(arena);
+
+    oc_str8 cacheDir = oc_path_user_cache_directory(scratch.arena);
+    if(cacheDir.len)
+    {
+        cacheDir = oc_path_append(scratch.arena, cacheDir, OC_STR8("orca/snapshots"));
+        if(oc_code_cache_create_directories(cacheDir))
+        {
+            //NOTE: the file is named after the module hash, so a rebuilt module never picks up a stale snapshot
+            oc_str8 fileName = oc_str8_pushf(scratch.arena, "%016llx.snapshot", (unsigned long long)oc_hash_xx64_string(env->wasmBytecode));
+            result = oc_path_append(arena, cacheDir, fileName);
+        }
+        else
+        {
+            oc_log_warning("couldn't create snapshot directory %.*s\n", oc_str8_ip(cacheDir));
+        }
+    }
+    oc_scratch_end(scratch);
+    return (result);
+}
+
+bool oc_runtime_snapshot_load(oc_wasm_env* env, oc_str8 path)
+{
+    IM3Module module = env->m3Module;
+    bool result = false;
+    oc_arena_scope scratch = oc_scratch_begin();
+
+    FILE* file = fopen(path.ptr, "rb");
+    if(!file)
+    {
+        goto end;
+    }
+
+    oc_snapshot_header header = { 0 };
+    fseek(file, 0, SEEK_END);
+    u64 fileSize = ftell(file);
+    rewind(file);
+
+    if(fread(&header, sizeof(header), 1, file) != 1
+       || header.magic != OC_SNAPSHOT_MAGIC
+       || header.version != OC_SNAPSHOT_VERSION)
+    {
+        oc_log_warning("couldn't load snapshot: invalid file\n");
+        goto close;
+    }
+
+    u32 numPages = m3_GetMemorySize(env->m3Runtime) / d_m3MemPageSize;
+    u64 dataSize = (u64)header.numPages * d_m3MemPageSize;
+
+    if(header.moduleHash != oc_hash_xx64_string(env->wasmBytecode)
+       || header.numGlobals != module->numGlobals
+       || header.tableSize != module->table0Size
+       || header.numPages < numPages)
+    {
+        oc_log_info("snapshot is stale, running init handler\n");
+        goto close;
+    }
+    if((header.dataOffset & (OC_SNAPSHOT_DATA_ALIGN - 1))
+       || header.dataOffset < sizeof(header) + header.numGlobals * sizeof(oc_snapshot_global) + header.tableSize * sizeof(u32)
+       || fileSize < header.dataOffset + dataSize)
+    {
+        oc_log_warning("couldn't load snapshot: invalid file\n");
+        goto close;
+    }
+
+    //NOTE: read and validate everything before touching the guest's state, so that we can still fall back to
+    //      running the init handler.
+    oc_snapshot_global* globals = oc_arena_push_array(scratch.arena, oc_snapshot_global, header.numGlobals);
+    u32* table = oc_arena_push_array(scratch.arena, u32, header.tableSize);
+
+    if(fread(globals, sizeof(oc_snapshot_global), header.numGlobals, file) != header.numGlobals
+       || fread(table, sizeof(u32), header.tableSize, file) != header.tableSize)
+    {
+        oc_log_warning("couldn't load snapshot: invalid file\n");
+        goto close;
+    }
+    for(u32 i = 0; i < header.numGlobals; i++)
+    {
+        if(globals[i].type != module->globals[i].type)
+        {
+            oc_log_warning("couldn't load snapshot: invalid file\n");
+            goto close;
+        }
+    }
+    for(u32 i = 0; i < header.tableSize; i++)
+    {
+        if(table[i] != OC_SNAPSHOT_NULL_FUNCTION && table[i] >= module->numFunctions)
+        {
+            oc_log_warning("couldn't load snapshot: invalid file\n");
+            goto close;
+        }
+    }
+
+    M3Result res = ResizeMemory(env->m3Runtime, header.numPages);
+    if(res)
+    {
+        oc_log_warning("couldn't load snapshot: %s\n", res);
+        goto close;
+    }
+
+    u32 memSize = 0;
+    u8* mem = m3_GetMemory(env->m3Runtime, &memSize, 0);
+    OC_ASSERT(memSize == dataSize && ((uintptr_t)mem & (OC_SNAPSHOT_DATA_ALIGN - 1)) == 0, "Wasm memory is not laid out as expected");
+
+    bool mapped = false;
+#if !OC_PLATFORM_WINDOWS
+    //NOTE: map the memory copy-on-write, so that only the pages the app actually touches are read and copied
+    mapped = (mmap(mem, dataSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fileno(file), header.dataOffset) != MAP_FAILED);
+#endif
+    if(!mapped)
+    {
+        fseek(file, header.dataOffset, SEEK_SET);
+        if(fread(mem, 1, dataSize, file) != dataSize)
+        {
+            OC_ABORT("The application couldn't restore its snapshot");
+        }
+    }
+
+    for(u32 i = 0; i < header.numGlobals; i++)
+    {
+        M3Global* global = &module->globals[i];
+        memcpy(&global->intValue, globals[i].value, SizeOfType(global->type));
+    }
+    for(u32 i = 0; i < header.tableSize; i++)
+    {
+        module->table0[i] = (table[i] == OC_SNAPSHOT_NULL_FUNCTION) ? 0 : &module->functions[table[i]];
+    }
+
+    result = true;
+
+close:
+    fclose(file);
+end:
+    oc_scratch_end(scratch);
+    return (result);
+}
+
+void oc_runtime_snapshot_store(oc_wasm_env* env, oc_str8 path)
+{
+    IM3Module module = env->m3Module;
+    oc_arena_scope scratch = oc_scratch_begin();
+
+    u32 memSize = 0;
+    u8* mem = m3_GetMemory(env->m3Runtime, &memSize, 0);
+
+    u64 metaSize = sizeof(oc_snapshot_header)
+                 + module->numGlobals * sizeof(oc_snapshot_global)
+                 + module->table0Size * sizeof(u32);
+    u32 dataOffset = oc_align_up_pow2(metaSize, OC_SNAPSHOT_DATA_ALIGN);
+
+    char* meta = oc_arena_push(scratch.arena, dataOffset);
+    memset(meta, 0, dataOffset);
+
+    oc_snapshot_header* header = (oc_snapshot_header*)meta;
+    *header = (oc_snapshot_header){
+        .magic = OC_SNAPSHOT_MAGIC,
+        .version = OC_SNAPSHOT_VERSION,
+        .moduleHash = oc_hash_xx64_string(env->wasmBytecode),
+        .numPages = memSize / d_m3MemPageSize,
+        .numGlobals = module->numGlobals,
+        .tableSize = module->table0Size,
+        .dataOffset = dataOffset,
+    };
+
+    oc_snapshot_global* globals = (oc_snapshot_global*)(header + 1);
+    for(u32 i = 0; i < module->numGlobals; i++)
+    {
+        M3Global* global = &module->globals[i];
+        globals[i].type = global->type;
+        memcpy(globals[i].value, &global->intValue, SizeOfType(global->type));
+    }
+
+    u32* table = (u32*)(globals + module->numGlobals);
+    for(u32 i = 0; i < module->table0Size; i++)
+    {
+        IM3Function function = module->table0[i];
+        table[i] = function ? (u32)(function - module->functions) : OC_SNAPSHOT_NULL_FUNCTION;
+    }
+
+    //NOTE: write to a temporary file and move it in place, so that an interrupted write can't leave
+    //      a truncated snapshot behind.
+    oc_str8 tmpPath = oc_str8_pushf(scratch.arena, "%.*s.tmp", oc_str8_ip(path));
+
+    FILE* file = fopen(tmpPath.ptr, "wb");
+    if(!file)
+    {
+        oc_log_warning("couldn't open snapshot file %.*s\n", oc_str8_ip(tmpPath));
+        goto end;
+    }
+    bool written = (fwrite(meta, 1, dataOffset, file) == dataOffset)
+                && (fwrite(mem, 1, memSize, file) == memSize);
+    fclose(file);
+
+    if(!written)
+    {
+        oc_log_warning("couldn't write snapshot file %.*s\n", oc_str8_ip(tmpPath));
+        remove(tmpPath.ptr);
+        goto end;
+    }
+
+#if OC_PLATFORM_WINDOWS
+    bool moved = MoveFileExA(tmpPath.ptr, path.ptr, MOVEFILE_REPLACE_EXISTING);
+#else
+    bool moved = (rename(tmpPath.ptr, path.ptr) == 0);
+#endif
+    if(!moved)
+    {
+        oc_log_warning("couldn't move snapshot file to %.*s\n", oc_str8_ip(path));
+        remove(tmpPath.ptr);
+    }
+
+end:
+    oc_scratch_end(scratch);
+}
@@ -0,0 +1,32 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+
+#ifndef __RUNTIME_SNAPSHOT_H_
+#define __RUNTIME_SNAPSHOT_H_
+
+#include "wasm3.h"
+
+typedef struct oc_wasm_env oc_wasm_env;
+
+//NOTE: A snapshot captures the guest's linear memory, globals and function table right after oc_on_init()
+//      returns, so that later launches can restore it instead of running the init handler again. It is
+//      keyed by a hash of the module's bytecode, and is simply retaken when stale.
+//
+//      Host resources (fonts, images, surfaces, files...) can't be captured: their handles in a restored
+//      snapshot are dangling. Apps opt into snapshots by exporting oc_on_restore(), which is called instead
+//      of oc_on_init() after a restore, and must re-create those resources.
+//
+//      Like the code cache, snapshots live in a runtime-owned directory under the user's cache directory,
+//      rather than in the app bundle, which may be read-only or signed.
+
+oc_str8 oc_runtime_snapshot_path(oc_arena* arena, oc_wasm_env* env);
+
+bool oc_runtime_snapshot_load(oc_wasm_env* env, oc_str8 path);
+void oc_runtime_snapshot_store(oc_wasm_env* env, oc_str8 path);
+
+#endif //__RUNTIME_SNAPSHOT_H_
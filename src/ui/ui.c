@@ -203,23 +203,85 @@ bool oc_ui_key_equal(oc_ui_key a, oc_ui_key b)
     return (a.hash == b.hash);
 }
 
+#define OC_UI_BOX_MAP_TOMBSTONE ((oc_ui_box*)1)
+
+static void oc_ui_box_map_resize(oc_ui_box_map* map, u64 capacity)
+{
+    u32 arenaIndex = map->arenaIndex ^ 1;
+    oc_arena* arena = &map->arenas[arenaIndex];
+    oc_arena_clear(arena);
+
+    oc_ui_box** slots = oc_arena_push_array(arena, oc_ui_box*, capacity);
+    memset(slots, 0, capacity * sizeof(oc_ui_box*));
+
+    for(u64 i = 0; i < map->capacity; i++)
+    {
+        oc_ui_box* box = map->slots[i];
+        if(box && box != OC_UI_BOX_MAP_TOMBSTONE)
+        {
+            u64 index = box->key.hash & (capacity - 1);
+            while(slots[index])
+            {
+                index = (index + 1) & (capacity - 1);
+            }
+            slots[index] = box;
+        }
+    }
+
+    map->arenaIndex = arenaIndex;
+    map->slots = slots;
+    map->capacity = capacity;
+    map->tombstoneCount = 0;
+}
+
 void oc_ui_box_cache(oc_ui_context* ui, oc_ui_box* box)
 {
-    u64 index = box->key.hash & (OC_UI_BOX_MAP_BUCKET_COUNT - 1);
-    oc_list_append(&(ui->boxMap[index]), &box->bucketElt);
+    oc_ui_box_map* map = &ui->boxMap;
+
+    //NOTE: keep the load factor, including tombstones, under 3/4. Double the capacity if live boxes fill at least
+    //      half of the table, otherwise rehashing in place is enough to get rid of the tombstones.
+    if((map->count + map->tombstoneCount + 1) * 4 > map->capacity * 3)
+    {
+        u64 capacity = oc_max(map->capacity, OC_UI_BOX_MAP_MIN_CAPACITY);
+        if((map->count + 1) * 2 > capacity)
+        {
+            capacity *= 2;
+        }
+        oc_ui_box_map_resize(map, capacity);
+    }
+
+    u64 index = box->key.hash & (map->capacity - 1);
+    while(map->slots[index] && map->slots[index] != OC_UI_BOX_MAP_TOMBSTONE)
+    {
+        index = (index + 1) & (map->capacity - 1);
+    }
+    if(map->slots[index] == OC_UI_BOX_MAP_TOMBSTONE)
+    {
+        map->tombstoneCount--;
+    }
+    map->slots[index] = box;
+    map->count++;
 }
 
 oc_ui_box* oc_ui_box_lookup_key(oc_ui_key key)
 {
     oc_ui_context* ui = oc_ui_get_context();
-    u64 index = key.hash & (OC_UI_BOX_MAP_BUCKET_COUNT - 1);
+    oc_ui_box_map* map = &ui->boxMap;
+
+    if(!map->capacity)
+    {
+        return (0);
+    }
 
-    oc_list_for(ui->boxMap[index], box, oc_ui_box, bucketElt)
+    u64 index = key.hash & (map->capacity - 1);
+    oc_ui_box* box = 0;
+    while((box = map->slots[index]) != 0)
     {
-        if(oc_ui_key_equal(key, box->key))
+        if(box != OC_UI_BOX_MAP_TOMBSTONE && oc_ui_key_equal(key, box->key))
         {
             return (box);
         }
+        index = (index + 1) & (map->capacity - 1);
     }
     return (0);
 }
@@ -263,6 +325,7 @@ void oc_ui_style_match_before(oc_ui_pattern pattern, oc_ui_style* style, oc_ui_s
     if(ui)
     {
         oc_ui_style_rule* rule = oc_arena_push_type(&ui->frameArena, oc_ui_style_rule);
+        memset(rule, 0, sizeof(oc_ui_style_rule));
         rule->pattern = pattern;
         rule->mask = mask;
         rule->style = oc_arena_push_type(&ui->frameArena, oc_ui_style);
@@ -278,6 +341,7 @@ void oc_ui_style_match_after(oc_ui_pattern pattern, oc_ui_style* style, oc_ui_st
     if(ui)
     {
         oc_ui_style_rule* rule = oc_arena_push_type(&ui->frameArena, oc_ui_style_rule);
+        memset(rule, 0, sizeof(oc_ui_style_rule));
         rule->pattern = pattern;
         rule->mask = mask;
         rule->style = oc_arena_push_type(&ui->frameArena, oc_ui_style);
@@ -298,6 +362,7 @@ void oc_ui_style_box_before(oc_ui_box* box, oc_ui_pattern pattern, oc_ui_style*
     if(ui)
     {
         oc_ui_style_rule* rule = oc_arena_push_type(&ui->frameArena, oc_ui_style_rule);
+        memset(rule, 0, sizeof(oc_ui_style_rule));
         rule->pattern = pattern;
         rule->mask = mask;
         rule->style = oc_arena_push_type(&ui->frameArena, oc_ui_style);
@@ -314,6 +379,7 @@ void oc_ui_style_box_after(oc_ui_box* box, oc_ui_pattern pattern, oc_ui_style* s
     if(ui)
     {
         oc_ui_style_rule* rule = oc_arena_push_type(&ui->frameArena, oc_ui_style_rule);
+        memset(rule, 0, sizeof(oc_ui_style_rule));
         rule->pattern = pattern;
         rule->mask = mask;
         rule->style = oc_arena_push_type(&ui->frameArena, oc_ui_style);
@@ -890,7 +956,192 @@ bool oc_ui_style_selector_match(oc_ui_box* box, oc_ui_style_rule* rule, oc_ui_se
     return (res);
 }
 
-void oc_ui_style_rule_match(oc_ui_context* ui, oc_ui_box* box, oc_ui_style_rule* rule, oc_list* buildList, oc_list* tmpList)
+//NOTE: style rule index. Rules active during the styling prepass are bucketed by a selector of the first compound
+//      selector of their pattern (ie. the selectors joined by OC_UI_SEL_AND that must all match the same box), so
+//      that each box only tests the rules that can match it, rather than every active rule. The most selective selector
+//      is used as the bucket's key, and rules whose first compound can't identify boxes (any, status) are kept in
+//      separate lists that all boxes test.
+//      Each rule gets an order number when it is added, that follows the order in which rules were applied when they
+//      were kept in a single list: rules appended get increasing numbers, and rules prepended decreasing ones. Buckets
+//      are thus always sorted, and the candidates for a box are obtained by merging its buckets.
+
+enum
+{
+    OC_UI_RULE_INDEX_BUCKET_COUNT = 256,
+};
+
+typedef struct oc_ui_rule_index
+{
+    i64 firstOrder;
+    i64 lastOrder;
+    u32 textRuleCount;
+    oc_list any;
+    oc_list status;
+    oc_list buckets[OC_UI_RULE_INDEX_BUCKET_COUNT];
+    oc_list derivedFreeList;
+} oc_ui_rule_index;
+
+oc_list* oc_ui_rule_index_bucket(oc_ui_rule_index* index, oc_ui_selector_kind kind, u64 value)
+{
+    u64 h = (value ^ ((u64)kind << 56)) * 0x9e3779b97f4a7c15ULL;
+    return (&index->buckets[(h >> 32) & (OC_UI_RULE_INDEX_BUCKET_COUNT - 1)]);
+}
+
+int oc_ui_rule_index_selectivity(oc_ui_selector_kind kind)
+{
+    switch(kind)
+    {
+        case OC_UI_SEL_OWNER:
+            return (5);
+        case OC_UI_SEL_KEY:
+            return (4);
+        case OC_UI_SEL_TEXT:
+            return (3);
+        case OC_UI_SEL_TAG:
+            return (2);
+        case OC_UI_SEL_STATUS:
+            return (1);
+        default:
+            return (0);
+    }
+}
+
+oc_list* oc_ui_rule_index_find_list(oc_ui_rule_index* index, oc_ui_style_rule* rule)
+{
+    oc_ui_selector* selector = oc_list_first_entry(rule->pattern.l, oc_ui_selector, listElt);
+    oc_ui_selector* best = selector;
+
+    selector = oc_list_next_entry(rule->pattern.l, selector, oc_ui_selector, listElt);
+    while(selector && selector->op == OC_UI_SEL_AND)
+    {
+        if(oc_ui_rule_index_selectivity(selector->kind) > oc_ui_rule_index_selectivity(best->kind))
+        {
+            best = selector;
+        }
+        selector = oc_list_next_entry(rule->pattern.l, selector, oc_ui_selector, listElt);
+    }
+
+    rule->indexKind = best->kind;
+    oc_list* list = 0;
+
+    switch(best->kind)
+    {
+        case OC_UI_SEL_OWNER:
+            //NOTE: derived rules don't have an owner, so an owner selector can't match any box
+            if(rule->owner)
+            {
+                rule->indexValue = (u64)(uintptr_t)rule->owner;
+                list = oc_ui_rule_index_bucket(index, best->kind, rule->indexValue);
+            }
+            break;
+
+        case OC_UI_SEL_TEXT:
+            rule->indexValue = oc_hash_xx64_string(best->text);
+            list = oc_ui_rule_index_bucket(index, best->kind, rule->indexValue);
+            break;
+
+        case OC_UI_SEL_TAG:
+            rule->indexValue = best->tag.hash;
+            list = oc_ui_rule_index_bucket(index, best->kind, rule->indexValue);
+            break;
+
+        case OC_UI_SEL_KEY:
+            rule->indexValue = best->key.hash;
+            list = oc_ui_rule_index_bucket(index, best->kind, rule->indexValue);
+            break;
+
+        case OC_UI_SEL_STATUS:
+            list = &index->status;
+            break;
+
+        default:
+            list = &index->any;
+            break;
+    }
+    return (list);
+}
+
+void oc_ui_rule_index_add(oc_ui_rule_index* index, oc_ui_style_rule* rule, bool prepend)
+{
+    rule->indexList = oc_ui_rule_index_find_list(index, rule);
+    if(rule->indexList)
+    {
+        if(prepend)
+        {
+            rule->order = --index->firstOrder;
+            oc_list_push(rule->indexList, &rule->indexElt);
+        }
+        else
+        {
+            rule->order = ++index->lastOrder;
+            oc_list_append(rule->indexList, &rule->indexElt);
+        }
+
+        if(rule->indexKind == OC_UI_SEL_TEXT)
+        {
+            index->textRuleCount++;
+        }
+    }
+}
+
+void oc_ui_rule_index_remove(oc_ui_rule_index* index, oc_ui_style_rule* rule)
+{
+    if(rule->indexList)
+    {
+        oc_list_remove(rule->indexList, &rule->indexElt);
+        rule->indexList = 0;
+
+        if(rule->indexKind == OC_UI_SEL_TEXT)
+        {
+            index->textRuleCount--;
+        }
+    }
+    if(rule->derived)
+    {
+        oc_list_push(&index->derivedFreeList, &rule->boxElt);
+    }
+}
+
+//NOTE: cheap test on the rule's indexed selector, that rejects rules which landed in the box's buckets because of a
+//      hash collision. Status selectors are left to the full match.
+bool oc_ui_rule_index_candidate(oc_ui_box* box, u64 textHash, oc_ui_style_rule* rule)
+{
+    bool res = true;
+    switch(rule->indexKind)
+    {
+        case OC_UI_SEL_OWNER:
+            res = (rule->owner == box);
+            break;
+
+        case OC_UI_SEL_TEXT:
+            res = (rule->indexValue == textHash);
+            break;
+
+        case OC_UI_SEL_TAG:
+        {
+            res = false;
+            oc_list_for(box->tags, elt, oc_ui_tag_elt, listElt)
+            {
+                if(elt->tag.hash == rule->indexValue)
+                {
+                    res = true;
+                    break;
+                }
+            }
+        }
+        break;
+
+        case OC_UI_SEL_KEY:
+            res = (rule->indexValue == box->key.hash);
+            break;
+
+        default:
+            break;
+    }
+    return (res);
+}
+
+void oc_ui_style_rule_match(oc_ui_context* ui, oc_ui_box* box, oc_ui_style_rule* rule, oc_ui_rule_index* index, oc_list* matchList, oc_list* tmpList)
 {
     oc_ui_selector* selector = oc_list_first_entry(rule->pattern.l, oc_ui_selector, listElt);
     bool match = oc_ui_style_selector_match(box, rule, selector);
@@ -910,19 +1161,191 @@ void oc_ui_style_rule_match(oc_ui_context* ui, oc_ui_box* box, oc_ui_style_rule*
         }
         else
         {
-            //NOTE create derived rule if there's more than one selector
-            oc_ui_style_rule* derived = oc_arena_push_type(&ui->frameArena, oc_ui_style_rule);
+            //NOTE create derived rule if there's more than one selector. Derived rules are recycled once the subtree
+            //     that created them has been styled.
+            oc_ui_style_rule* derived = oc_list_pop_entry(&index->derivedFreeList, oc_ui_style_rule, boxElt);
+            if(!derived)
+            {
+                derived = oc_arena_push_type(&ui->frameArena, oc_ui_style_rule);
+            }
+            memset(derived, 0, sizeof(oc_ui_style_rule));
             derived->mask = rule->mask;
             derived->style = rule->style;
             derived->pattern.l = (oc_list){ &selector->listElt, rule->pattern.l.last };
+            derived->derived = true;
 
-            oc_list_append(buildList, &derived->buildElt);
+            //NOTE: derived rules are also matched against the box that created them
+            oc_ui_rule_index_add(index, derived, false);
+            oc_list_append(matchList, &derived->matchElt);
             oc_list_append(tmpList, &derived->tmpElt);
         }
     }
 }
 
-void oc_ui_styling_prepass(oc_ui_context* ui, oc_ui_box* box, oc_list* before, oc_list* after)
+void oc_ui_style_rules_match(oc_ui_context* ui, oc_ui_box* box, oc_ui_rule_index* index, oc_list* tmpList)
+{
+    oc_arena_scope scratch = oc_scratch_begin();
+
+    //NOTE: gather the lists that can hold rules matching this box
+    u32 maxListCount = 5;
+    oc_list_for(box->tags, elt, oc_ui_tag_elt, listElt)
+    {
+        maxListCount++;
+    }
+    oc_list** lists = oc_arena_push_array(scratch.arena, oc_list*, maxListCount);
+    oc_list_elt** cursors = oc_arena_push_array(scratch.arena, oc_list_elt*, maxListCount);
+    u32 listCount = 0;
+
+    lists[listCount++] = &index->any;
+    lists[listCount++] = &index->status;
+    lists[listCount++] = oc_ui_rule_index_bucket(index, OC_UI_SEL_OWNER, (u64)(uintptr_t)box);
+    lists[listCount++] = oc_ui_rule_index_bucket(index, OC_UI_SEL_KEY, box->key.hash);
+
+    u64 textHash = 0;
+    if(index->textRuleCount)
+    {
+        textHash = oc_hash_xx64_string(box->string);
+        lists[listCount++] = oc_ui_rule_index_bucket(index, OC_UI_SEL_TEXT, textHash);
+    }
+    oc_list_for(box->tags, elt, oc_ui_tag_elt, listElt)
+    {
+        lists[listCount++] = oc_ui_rule_index_bucket(index, OC_UI_SEL_TAG, elt->tag.hash);
+    }
+
+    //NOTE: remove duplicate buckets, so that rules don't get matched twice
+    u32 cursorCount = 0;
+    for(u32 i = 0; i < listCount; i++)
+    {
+        bool duplicate = false;
+        for(u32 j = 0; j < i; j++)
+        {
+            if(lists[j] == lists[i])
+            {
+                duplicate = true;
+                break;
+            }
+        }
+        if(!duplicate && !oc_list_empty(*lists[i]))
+        {
+            cursors[cursorCount++] = oc_list_begin(*lists[i]);
+        }
+    }
+
+    //NOTE: merge candidates in rule order
+    oc_list matchList = { 0 };
+    while(1)
+    {
+        oc_ui_style_rule* next = 0;
+        u32 nextCursor = 0;
+        for(u32 i = 0; i < cursorCount; i++)
+        {
+            oc_ui_style_rule* rule = 0;
+            while(cursors[i])
+            {
+                rule = oc_list_entry(cursors[i], oc_ui_style_rule, indexElt);
+                if(oc_ui_rule_index_candidate(box, textHash, rule))
+                {
+                    break;
+                }
+                rule = 0;
+                cursors[i] = oc_list_next(cursors[i]);
+            }
+            if(rule && (!next || rule->order < next->order))
+            {
+                next = rule;
+                nextCursor = i;
+            }
+        }
+        if(!next)
+        {
+            break;
+        }
+        oc_list_append(&matchList, &next->matchElt);
+        cursors[nextCursor] = oc_list_next(cursors[nextCursor]);
+    }
+
+    oc_list_for(matchList, rule, oc_ui_style_rule, matchElt)
+    {
+        oc_ui_style_rule_match(ui, box, rule, index, &matchList, tmpList);
+    }
+
+    oc_scratch_end(scratch);
+}
+
+//NOTE: layout caching. After styling, each box hashes the inputs of its own layout, and the hashes are combined up the
+//      tree. Subtrees whose hash is the same as on the previous frame are "clean": the layout passes reuse the sizes
+//      they computed on the previous frame instead of descending into them, unless the size or position handed down
+//      by the parent changed.
+
+typedef struct oc_ui_layout_inputs
+{
+    u64 key;
+    oc_font font;
+    oc_ui_box_size size;
+    oc_ui_layout layout;
+    oc_vec2 floatTarget;
+    oc_vec2 floatPos;
+    oc_vec2 scroll;
+    oc_vec2 staticSize;
+    f32 borderSize; // doesn't change the layout, but changes the bounds of the subtree
+    u32 floating[2];
+    u32 flags;
+    u32 hidden;
+} oc_ui_layout_inputs;
+
+u64 oc_ui_box_layout_hash(oc_ui_box* box)
+{
+    //NOTE: memset so that padding bytes don't end up in the hash
+    oc_ui_layout_inputs inputs;
+    memset(&inputs, 0, sizeof(inputs));
+
+    inputs.key = box->key.hash;
+    inputs.font = box->style.font;
+    inputs.size = box->style.size;
+    inputs.layout = box->style.layout;
+    inputs.floatTarget = box->style.floatTarget;
+    inputs.floatPos = box->floatPos;
+    inputs.borderSize = box->style.borderSize;
+    inputs.scroll = box->scroll;
+    inputs.floating[0] = box->style.floating.c[0];
+    inputs.floating[1] = box->style.floating.c[1];
+    inputs.flags = box->flags;
+    inputs.hidden = oc_ui_box_hidden(box);
+
+    for(int i = 0; i < OC_UI_AXIS_COUNT; i++)
+    {
+        oc_ui_size_kind kind = box->style.size.c[i].kind;
+        if(!inputs.hidden && (kind == OC_UI_SIZE_TEXT || kind == OC_UI_SIZE_PIXELS))
+        {
+            inputs.staticSize.c[i] = box->staticSize[i];
+        }
+    }
+    return (oc_hash_xx64_string(oc_str8_from_buffer(sizeof(inputs), (char*)&inputs)));
+}
+
+void oc_ui_layout_compute_hash(oc_ui_context* ui, oc_ui_box* box)
+{
+    u64 hash = box->layoutHash;
+
+    //NOTE: hidden boxes don't style or lay out their children
+    if(!oc_ui_box_hidden(box))
+    {
+        oc_list_for(box->children, child, oc_ui_box, listElt)
+        {
+            oc_ui_layout_compute_hash(ui, child);
+            hash = oc_hash_xx64_string_seed(oc_str8_from_buffer(sizeof(u64), (char*)&child->subtreeHash), hash);
+        }
+    }
+
+    //NOTE: boxes that weren't laid out on the previous frame (eg. because they were hidden) don't have usable results
+    box->layoutClean = !box->fresh
+                    && box->layoutFrame + 1 == ui->frameCounter
+                    && box->subtreeHash == hash;
+    box->subtreeHash = hash;
+    box->layoutFrame = ui->frameCounter;
+}
+
+void oc_ui_styling_prepass(oc_ui_context* ui, oc_ui_box* box, oc_ui_rule_index* before, oc_ui_rule_index* after)
 {
     //NOTE: inherit style from parent
     if(box->parent)
@@ -936,47 +1359,55 @@ void oc_ui_styling_prepass(oc_ui_context* ui, oc_ui_box* box, oc_list* before, o
     oc_list tmpBefore = { 0 };
     oc_list_for(box->beforeRules, rule, oc_ui_style_rule, boxElt)
     {
-        oc_list_append(before, &rule->buildElt);
+        oc_ui_rule_index_add(before, rule, false);
         oc_list_append(&tmpBefore, &rule->tmpElt);
     }
     //NOTE: match before rules
-    oc_list_for(*before, rule, oc_ui_style_rule, buildElt)
-    {
-        oc_ui_style_rule_match(ui, box, rule, before, &tmpBefore);
-    }
+    oc_ui_style_rules_match(ui, box, before, &tmpBefore);
 
     //NOTE: prepend box after rules to after and append them to tmp
     oc_list tmpAfter = { 0 };
     oc_list_for_reverse(box->afterRules, rule, oc_ui_style_rule, boxElt)
     {
-        oc_list_push(after, &rule->buildElt);
+        oc_ui_rule_index_add(after, rule, true);
         oc_list_append(&tmpAfter, &rule->tmpElt);
     }
 
     //NOTE: match after rules
-    oc_list_for(*after, rule, oc_ui_style_rule, buildElt)
-    {
-        oc_ui_style_rule_match(ui, box, rule, after, &tmpAfter);
-    }
+    oc_ui_style_rules_match(ui, box, after, &tmpAfter);
 
     //NOTE: compute static sizes
     oc_ui_box_animate_style(ui, box);
 
     if(oc_ui_box_hidden(box))
     {
+        box->layoutHash = oc_ui_box_layout_hash(box);
         return;
     }
 
     oc_ui_style* style = &box->style;
 
-    oc_rect textBox = { 0 };
     oc_ui_size desiredSize[2] = { box->style.size.c[OC_UI_AXIS_X],
                                   box->style.size.c[OC_UI_AXIS_Y] };
 
     if(desiredSize[OC_UI_AXIS_X].kind == OC_UI_SIZE_TEXT
        || desiredSize[OC_UI_AXIS_Y].kind == OC_UI_SIZE_TEXT)
     {
-        textBox = oc_font_text_metrics(style->font, style->fontSize, box->string).logical;
+        //NOTE: only measure text again if the string or the font changed
+        struct
+        {
+            oc_font font;
+            f32 fontSize;
+        } textKey = { style->font, style->fontSize };
+
+        u64 textHash = oc_hash_xx64_string_seed(box->string,
+                                                oc_hash_xx64_string(oc_str8_from_buffer(sizeof(textKey), (char*)&textKey)));
+        if(textHash != box->textHash)
+        {
+            oc_rect textBox = oc_font_text_metrics(style->font, style->fontSize, box->string).logical;
+            box->textSize = (oc_vec2){ textBox.w, textBox.h };
+            box->textHash = textHash;
+        }
     }
 
     for(int i = 0; i < OC_UI_AXIS_COUNT; i++)
@@ -986,13 +1417,14 @@ void oc_ui_styling_prepass(oc_ui_context* ui, oc_ui_box* box, oc_list* before, o
         if(size.kind == OC_UI_SIZE_TEXT)
         {
             f32 margin = style->layout.margin.c[i];
-            box->rect.c[2 + i] = textBox.c[2 + i] + margin * 2;
+            box->staticSize[i] = box->textSize.c[i] + margin * 2;
         }
         else if(size.kind == OC_UI_SIZE_PIXELS)
         {
-            box->rect.c[2 + i] = size.value;
+            box->staticSize[i] = size.value;
         }
     }
+    box->layoutHash = oc_ui_box_layout_hash(box);
 
     //NOTE: descend in children
     oc_list_for(box->children, child, oc_ui_box, listElt)
@@ -1003,11 +1435,11 @@ void oc_ui_styling_prepass(oc_ui_context* ui, oc_ui_box* box, oc_list* before, o
     //NOTE: remove temporary rules
     oc_list_for(tmpBefore, rule, oc_ui_style_rule, tmpElt)
     {
-        oc_list_remove(before, &rule->buildElt);
+        oc_ui_rule_index_remove(before, rule);
     }
     oc_list_for(tmpAfter, rule, oc_ui_style_rule, tmpElt)
     {
-        oc_list_remove(after, &rule->buildElt);
+        oc_ui_rule_index_remove(after, rule);
     }
 }
 
@@ -1021,6 +1453,14 @@ bool oc_ui_layout_downward_dependency(oc_ui_box* child, int axis)
 
 void oc_ui_layout_downward_dependent_size(oc_ui_context* ui, oc_ui_box* box, int axis)
 {
+    if(box->layoutClean)
+    {
+        //NOTE: the subtree didn't change, restore what this pass computed for the box on the previous frame
+        box->rect.c[2 + axis] = box->downSize[axis];
+        box->minSize[axis] = box->downMinSize[axis];
+        return;
+    }
+
     //NOTE: layout children and compute spacing and minimum size
     i32 count = 0;
     f32 minSum = 0;
@@ -1051,6 +1491,7 @@ void oc_ui_layout_downward_dependent_size(oc_ui_context* ui, oc_ui_box* box, int
     {
         case OC_UI_SIZE_TEXT:
         case OC_UI_SIZE_PIXELS:
+            box->rect.c[2 + axis] = box->staticSize[axis];
             box->minSize[axis] = box->rect.c[2 + axis];
             break;
 
@@ -1060,10 +1501,17 @@ void oc_ui_layout_downward_dependent_size(oc_ui_context* ui, oc_ui_box* box, int
         {
             int overflowFlag = (OC_UI_FLAG_OVERFLOW_ALLOW_X << axis);
 
+            //NOTE: boxes that allow overflow don't get a minimum size from their children. Reset it rather than
+            //      keeping last frame's value, which the upward pass may have raised, so that layout only depends on
+            //      the current frame's inputs.
             if(!(box->flags & overflowFlag))
             {
                 box->minSize[axis] = minSum + box->spacing[axis] + 2 * box->style.layout.margin.c[axis];
             }
+            else
+            {
+                box->minSize[axis] = 0;
+            }
         }
         break;
     }
@@ -1099,10 +1547,35 @@ void oc_ui_layout_downward_dependent_size(oc_ui_context* ui, oc_ui_box* box, int
         f32 margin = box->style.layout.margin.c[axis];
         box->rect.c[2 + axis] = sum + box->spacing[axis] + 2 * margin;
     }
+
+    box->downSize[axis] = box->rect.c[2 + axis];
+    box->downMinSize[axis] = box->minSize[axis];
 }
 
 void oc_ui_layout_upward_dependent_size(oc_ui_context* ui, oc_ui_box* box, int axis)
 {
+    box->layoutReused[axis] = false;
+    if(box->layoutClean)
+    {
+        if(box->rect.c[2 + axis] == box->layoutInputSize[axis])
+        {
+            //NOTE: same subtree and same size as on the previous frame, the descendants still hold their results
+            box->layoutReused[axis] = true;
+            return;
+        }
+
+        //NOTE: the downward pass didn't visit the children, reset them to its results before solving again
+        oc_list_for(box->children, child, oc_ui_box, listElt)
+        {
+            if(!oc_ui_box_hidden(child))
+            {
+                child->rect.c[2 + axis] = child->downSize[axis];
+                child->minSize[axis] = child->downMinSize[axis];
+            }
+        }
+    }
+    box->layoutInputSize[axis] = box->rect.c[2 + axis];
+
     //NOTE: re-compute/set size of children that depend on box's size
 
     f32 margin = box->style.layout.margin.c[axis];
@@ -1326,6 +1799,18 @@ void oc_ui_layout_compute_rect(oc_ui_context* ui, oc_ui_box* box, oc_vec2 pos)
         return;
     }
 
+    if(box->layoutClean
+       && box->layoutReused[OC_UI_AXIS_X]
+       && box->layoutReused[OC_UI_AXIS_Y]
+       && box->rect.x == pos.x
+       && box->rect.y == pos.y
+       && box->z == ui->z)
+    {
+        //NOTE: nothing changed in the subtree and it didn't move, so the previous rects are still valid
+        ui->z += box->zCount;
+        return;
+    }
+
     box->rect.x = pos.x;
     box->rect.y = pos.y;
     box->z = ui->z;
@@ -1396,6 +1881,41 @@ void oc_ui_layout_compute_rect(oc_ui_context* ui, oc_ui_box* box, oc_vec2 pos)
             currentPos.c[layoutAxis] += child->rect.c[2 + layoutAxis] + spacing;
         }
     }
+    box->zCount = ui->z - box->z;
+
+    //NOTE: compute the bounds of the subtree, including borders, which are drawn across the edges of the boxes
+    f32 halfBorder = 0.5 * box->style.borderSize;
+    f32 x0 = box->rect.x - halfBorder;
+    f32 y0 = box->rect.y - halfBorder;
+    f32 x1 = box->rect.x + box->rect.w + halfBorder;
+    f32 y1 = box->rect.y + box->rect.h + halfBorder;
+
+    oc_list_for(box->children, child, oc_ui_box, listElt)
+    {
+        if(!oc_ui_box_hidden(child))
+        {
+            oc_rect bounds = child->subtreeRect;
+            if(box->flags & OC_UI_FLAG_CLIP)
+            {
+                //NOTE: children are clipped by the box's rect, but the box's border isn't
+                f32 cx0 = oc_max(bounds.x, box->rect.x);
+                f32 cy0 = oc_max(bounds.y, box->rect.y);
+                f32 cx1 = oc_min(bounds.x + bounds.w, box->rect.x + box->rect.w);
+                f32 cy1 = oc_min(bounds.y + bounds.h, box->rect.y + box->rect.h);
+                if(cx0 > cx1 || cy0 > cy1)
+                {
+                    continue;
+                }
+                bounds = (oc_rect){ cx0, cy0, cx1 - cx0, cy1 - cy0 };
+            }
+            x0 = oc_min(x0, bounds.x);
+            y0 = oc_min(y0, bounds.y);
+            x1 = oc_max(x1, bounds.x + bounds.w);
+            y1 = oc_max(y1, bounds.y + bounds.h);
+        }
+    }
+    box->subtreeRect = (oc_rect){ x0, y0, x1 - x0, y1 - y0 };
+
     if(isnan(box->rect.w) || isnan(box->rect.h))
     {
         oc_log_error("error in box %.*s\n", oc_str8_ip(box->string));
@@ -1432,11 +1952,13 @@ void oc_ui_layout_find_next_hovered(oc_ui_context* ui, oc_vec2 p)
 
 void oc_ui_solve_layout(oc_ui_context* ui)
 {
-    oc_list beforeRules = { 0 };
-    oc_list afterRules = { 0 };
+    oc_ui_rule_index* beforeRules = oc_arena_push_type(&ui->frameArena, oc_ui_rule_index);
+    oc_ui_rule_index* afterRules = oc_arena_push_type(&ui->frameArena, oc_ui_rule_index);
+    memset(beforeRules, 0, sizeof(oc_ui_rule_index));
+    memset(afterRules, 0, sizeof(oc_ui_rule_index));
 
     //NOTE: style and compute static sizes
-    oc_ui_styling_prepass(ui, ui->root, &beforeRules, &afterRules);
+    oc_ui_styling_prepass(ui, ui->root, beforeRules, afterRules);
 
     //NOTE: reparent overlay boxes
     oc_list_for(ui->overlayList, box, oc_ui_box, overlayElt)
@@ -1448,6 +1970,9 @@ void oc_ui_solve_layout(oc_ui_context* ui)
         }
     }
 
+    //NOTE: find the subtrees that changed since the previous frame
+    oc_ui_layout_compute_hash(ui, ui->root);
+
     //NOTE: compute layout
     for(int axis = 0; axis < OC_UI_AXIS_COUNT; axis++)
     {
@@ -1466,16 +1991,97 @@ void oc_ui_solve_layout(oc_ui_context* ui)
 // Drawing
 //-----------------------------------------------------------------------------
 
-void oc_ui_rectangle_fill(oc_rect rect, f32 roundness)
+//NOTE: solid rectangle fills are deferred, so that consecutive fills with the same color that line up (eg. the
+//      backgrounds of the cells of a row, or of the rows of a list) are merged into a single path. The pending fill
+//      is flushed before anything else is drawn, and before the clip changes.
+typedef struct oc_ui_draw_batch
+{
+    bool pending;
+    oc_color color;
+    oc_rect rect;
+} oc_ui_draw_batch;
+
+void oc_ui_draw_batch_flush(oc_ui_draw_batch* batch)
+{
+    if(batch->pending)
+    {
+        oc_set_color(batch->color);
+        oc_rectangle_fill(batch->rect.x, batch->rect.y, batch->rect.w, batch->rect.h);
+        batch->pending = false;
+    }
+}
+
+void oc_ui_rectangle_fill(oc_ui_draw_batch* batch, oc_rect rect, f32 roundness, oc_color color)
 {
     if(roundness)
     {
+        oc_ui_draw_batch_flush(batch);
+        oc_set_color(color);
         oc_rounded_rectangle_fill(rect.x, rect.y, rect.w, rect.h, roundness);
+        return;
+    }
+
+    if(batch->pending && !memcmp(&batch->color, &color, sizeof(oc_color)))
+    {
+        oc_rect* p = &batch->rect;
+        if(rect.y == p->y && rect.h == p->h && rect.x == p->x + p->w)
+        {
+            p->w += rect.w;
+            return;
+        }
+        else if(rect.x == p->x && rect.w == p->w && rect.y == p->y + p->h)
+        {
+            p->h += rect.h;
+            return;
+        }
+        else if(color.a == 1
+                && rect.x >= p->x
+                && rect.y >= p->y
+                && rect.x + rect.w <= p->x + p->w
+                && rect.y + rect.h <= p->y + p->h)
+        {
+            //NOTE: opaque fill over the same color, eg. a box with the same background as its parent
+            return;
+        }
+    }
+    oc_ui_draw_batch_flush(batch);
+    batch->pending = true;
+    batch->color = color;
+    batch->rect = rect;
+}
+
+//NOTE: borders are filled as the ring between the outer and inner edges of the stroke (fills use the even-odd rule),
+//      which gives the same shape as stroking the box's outline, but is much cheaper to encode than a stroke.
+void oc_ui_rectangle_border(oc_ui_draw_batch* batch, oc_rect rect, f32 roundness, f32 width, oc_color color)
+{
+    oc_ui_draw_batch_flush(batch);
+    oc_set_color(color);
+
+    f32 h = 0.5 * width;
+    oc_rect outer = { rect.x - h, rect.y - h, rect.w + width, rect.h + width };
+    oc_rect inner = { rect.x + h, rect.y + h, rect.w - width, rect.h - width };
+
+    if(roundness)
+    {
+        oc_rounded_rectangle_path(outer.x, outer.y, outer.w, outer.h, roundness + h);
     }
     else
     {
-        oc_rectangle_fill(rect.x, rect.y, rect.w, rect.h);
+        oc_rectangle_path(outer.x, outer.y, outer.w, outer.h);
     }
+
+    if(inner.w > 0 && inner.h > 0)
+    {
+        if(roundness > h)
+        {
+            oc_rounded_rectangle_path(inner.x, inner.y, inner.w, inner.h, roundness - h);
+        }
+        else
+        {
+            oc_rectangle_path(inner.x, inner.y, inner.w, inner.h);
+        }
+    }
+    oc_fill();
 }
 
 void oc_ui_rectangle_stroke(oc_rect rect, f32 roundness)
@@ -1490,60 +2096,66 @@ void oc_ui_rectangle_stroke(oc_rect rect, f32 roundness)
     }
 }
 
-void oc_ui_draw_box(oc_ui_box* box)
+bool oc_ui_rect_clipped(oc_rect rect, oc_rect clip)
+{
+    return ((rect.x + rect.w < clip.x)
+            || (rect.y + rect.h < clip.y)
+            || (rect.x > clip.x + clip.w)
+            || (rect.y > clip.y + clip.h));
+}
+
+void oc_ui_draw_box(oc_ui_draw_batch* batch, oc_ui_box* box)
 {
     if(oc_ui_box_hidden(box))
     {
         return;
     }
 
-    oc_ui_style* style = &box->style;
-
-    bool draw = true;
-
+    //NOTE: skip the whole subtree if it doesn't intersect the clip
+    oc_rect clip = oc_clip_top();
+    if(oc_ui_rect_clipped(box->subtreeRect, clip))
     {
-        oc_rect clip = oc_clip_top();
-        oc_rect expRect = {
-            box->rect.x - 0.5 * style->borderSize,
-            box->rect.y - 0.5 * style->borderSize,
-            box->rect.w + style->borderSize,
-            box->rect.h + style->borderSize
-        };
-
-        if((expRect.x + expRect.w < clip.x)
-           || (expRect.y + expRect.h < clip.y)
-           || (expRect.x > clip.x + clip.w)
-           || (expRect.y > clip.y + clip.h))
-        {
-            draw = false;
-        }
+        return;
     }
 
+    oc_ui_style* style = &box->style;
+
+    oc_rect expRect = {
+        box->rect.x - 0.5 * style->borderSize,
+        box->rect.y - 0.5 * style->borderSize,
+        box->rect.w + style->borderSize,
+        box->rect.h + style->borderSize
+    };
+    bool draw = !oc_ui_rect_clipped(expRect, clip);
+
     if(box->flags & OC_UI_FLAG_CLIP)
     {
+        oc_ui_draw_batch_flush(batch);
         oc_clip_push(box->rect.x, box->rect.y, box->rect.w, box->rect.h);
     }
 
     if(draw && (box->flags & OC_UI_FLAG_DRAW_BACKGROUND))
     {
-        oc_set_color(style->bgColor);
-        oc_ui_rectangle_fill(box->rect, style->roundness);
+        oc_ui_rectangle_fill(batch, box->rect, style->roundness, style->bgColor);
     }
 
     if(draw
        && (box->flags & OC_UI_FLAG_DRAW_PROC)
        && box->drawProc)
     {
+        oc_ui_draw_batch_flush(batch);
         box->drawProc(box, box->drawData);
     }
 
     oc_list_for(box->children, child, oc_ui_box, listElt)
     {
-        oc_ui_draw_box(child);
+        oc_ui_draw_box(batch, child);
     }
 
     if(draw && (box->flags & OC_UI_FLAG_DRAW_TEXT))
     {
+        oc_ui_draw_batch_flush(batch);
+
         oc_rect textBox = oc_font_text_metrics(style->font, style->fontSize, box->string).logical;
 
         f32 x = 0;
@@ -1589,19 +2201,19 @@ void oc_ui_draw_box(oc_ui_box* box)
 
     if(box->flags & OC_UI_FLAG_CLIP)
     {
+        oc_ui_draw_batch_flush(batch);
         oc_clip_pop();
     }
 
     if(draw && (box->flags & OC_UI_FLAG_DRAW_BORDER))
     {
-        oc_set_width(style->borderSize);
-        oc_set_color(style->borderColor);
-        oc_ui_rectangle_stroke(box->rect, style->roundness);
+        oc_ui_rectangle_border(batch, box->rect, style->roundness, style->borderSize, style->borderColor);
     }
 
 #if 0
     if(box->rect.w && box->rect.h)
     {
+        oc_ui_draw_batch_flush(batch);
         oc_set_width(1);
         oc_set_color_rgba(1, 0, 0, 1);
         oc_ui_rectangle_stroke(box->rect, 0);
@@ -1617,7 +2229,9 @@ void oc_ui_draw()
     bool oldTextFlip = oc_get_text_flip();
     oc_set_text_flip(false);
 
-    oc_ui_draw_box(ui->root);
+    oc_ui_draw_batch batch = { 0 };
+    oc_ui_draw_box(&batch, ui->root);
+    oc_ui_draw_batch_flush(&batch);
 
     oc_set_text_flip(oldTextFlip);
 }
@@ -1693,18 +2307,34 @@ void oc_ui_end_frame(void)
     //NOTE: layout
     oc_ui_solve_layout(ui);
 
-    //NOTE: prune unused boxes
-    for(int i = 0; i < OC_UI_BOX_MAP_BUCKET_COUNT; i++)
+    //NOTE: prune unused boxes and recycle them
+    oc_ui_box_map* map = &ui->boxMap;
+    for(u64 i = 0; i < map->capacity; i++)
     {
-        oc_list_for_safe(ui->boxMap[i], box, oc_ui_box, bucketElt)
+        oc_ui_box* box = map->slots[i];
+        if(box && box != OC_UI_BOX_MAP_TOMBSTONE && box->frameCounter < ui->frameCounter)
         {
-            if(box->frameCounter < ui->frameCounter)
+            if(ui->focus == box)
             {
-                oc_list_remove(&ui->boxMap[i], &box->bucketElt);
+                ui->focus = 0;
             }
+            map->slots[i] = OC_UI_BOX_MAP_TOMBSTONE;
+            map->count--;
+            map->tombstoneCount++;
+            oc_pool_recycle(&ui->boxPool, box);
         }
     }
 
+    //NOTE: shrink the table after a large number of boxes went away, so that pruning doesn't keep scanning it
+    if(map->capacity > OC_UI_BOX_MAP_MIN_CAPACITY && map->count * 8 < map->capacity)
+    {
+        oc_ui_box_map_resize(map, oc_max(map->capacity / 4, OC_UI_BOX_MAP_MIN_CAPACITY));
+    }
+    else if(map->tombstoneCount * 4 > map->capacity)
+    {
+        oc_ui_box_map_resize(map, map->capacity);
+    }
+
     oc_arena_clear(&ui->frameArena);
     oc_input_next_frame(&ui->input);
 }
@@ -1719,6 +2349,8 @@ void oc_ui_init(oc_ui_context* ui)
     memset(ui, 0, sizeof(oc_ui_context));
     oc_arena_init(&ui->frameArena);
     oc_pool_init(&ui->boxPool, sizeof(oc_ui_box));
+    oc_arena_init(&ui->boxMap.arenas[0]);
+    oc_arena_init(&ui->boxMap.arenas[1]);
     ui->init = true;
 
     oc_ui_set_context(ui);
@@ -1732,6 +2364,9 @@ void oc_ui_cleanup(void)
     oc_ui_context* ui = oc_ui_get_context();
     oc_arena_cleanup(&ui->frameArena);
     oc_pool_cleanup(&ui->boxPool);
+    oc_arena_cleanup(&ui->boxMap.arenas[0]);
+    oc_arena_cleanup(&ui->boxMap.arenas[1]);
+    ui->boxMap = (oc_ui_box_map){ 0 };
     ui->init = false;
 }
 
@@ -2406,6 +3041,83 @@ void oc_ui_panel_end(void)
     oc_ui_box_end(); // panel
 }
 
+//------------------------------------------------------------------------------
+// lists
+//------------------------------------------------------------------------------
+void oc_ui_list_begin_str8(oc_str8 str, oc_ui_flags flags, oc_ui_list_info* info)
+{
+    oc_ui_context* ui = oc_ui_get_context();
+
+    oc_ui_panel_begin_str8(str, flags);
+
+    oc_ui_box* contents = oc_ui_box_top();
+    oc_ui_box* panel = contents->parent;
+
+    //NOTE: the visible rows are found using the size and style of the panel on the previous frame. A fresh panel doesn't
+    //      have a size yet, so assume it covers the whole ui.
+    f64 viewHeight = panel->fresh ? ui->root->rect.h : panel->rect.h;
+    f64 spacing = contents->style.layout.spacing;
+    f64 pitch = oc_clamp_low(info->rowHeight, 1) + spacing;
+    u64 overscan = info->overscan ? info->overscan : OC_UI_LIST_DEFAULT_OVERSCAN;
+
+    //NOTE: box sizes are f32, so past OC_UI_LIST_MAX_HEIGHT the list is given that height and the scroll position
+    //      is scaled to a position in the full list.
+    f64 listHeight = oc_clamp_low(info->rowCount * pitch - spacing, 0);
+    f64 contentsHeight = oc_min(listHeight, OC_UI_LIST_MAX_HEIGHT);
+    f64 scroll = oc_clamp(panel->scroll.y, 0, oc_clamp_low(contentsHeight - viewHeight, 0));
+    f64 listScroll = scroll;
+    if(listHeight > contentsHeight && contentsHeight > viewHeight)
+    {
+        listScroll = scroll * (listHeight - viewHeight) / (contentsHeight - viewHeight);
+    }
+
+    u64 first = (u64)(listScroll / pitch);
+    u64 visibleCount = (u64)(viewHeight / pitch) + 2;
+
+    info->firstRow = oc_min(info->rowCount, first > overscan ? first - overscan : 0);
+    info->endRow = oc_min(info->rowCount, first + visibleCount + overscan);
+
+    //NOTE: the spacers are placed relative to the scroll position rather than to the top of the list, so that the
+    //      offset of the built rows stays exact in f32. A spacer is omitted when empty, so that its spacing isn't added.
+    f64 beforeHeight = 0;
+    if(info->firstRow)
+    {
+        beforeHeight = oc_clamp_low(scroll - (listScroll - info->firstRow * pitch) - spacing, 0);
+
+        oc_ui_style_next(&(oc_ui_style){ .size.width = { OC_UI_SIZE_PIXELS, 0 },
+                                         .size.height = { OC_UI_SIZE_PIXELS, beforeHeight } },
+                         OC_UI_STYLE_SIZE);
+        oc_ui_box_make("_before_", 0);
+
+        beforeHeight += spacing;
+    }
+
+    info->afterHeight = 0;
+    if(info->endRow < info->rowCount)
+    {
+        f64 builtHeight = (info->endRow - info->firstRow) * pitch;
+        info->afterHeight = oc_clamp_low(contentsHeight - beforeHeight - builtHeight, 0);
+    }
+}
+
+void oc_ui_list_begin(const char* str, oc_ui_flags flags, oc_ui_list_info* info)
+{
+    oc_ui_list_begin_str8(OC_STR8(str), flags, info);
+}
+
+void oc_ui_list_end(oc_ui_list_info* info)
+{
+    if(info->endRow < info->rowCount)
+    {
+        oc_ui_style_next(&(oc_ui_style){ .size.width = { OC_UI_SIZE_PIXELS, 0 },
+                                         .size.height = { OC_UI_SIZE_PIXELS, info->afterHeight } },
+                         OC_UI_STYLE_SIZE);
+        oc_ui_box_make("_after_", 0);
+    }
+
+    oc_ui_panel_end();
+}
+
 //------------------------------------------------------------------------------
 // tooltips
 //------------------------------------------------------------------------------
@@ -4103,6 +4815,7 @@ oc_ui_text_box_result oc_ui_text_box_str8(oc_str8 name, oc_arena* arena, oc_str8
                 editCommandCount = OC_UI_EDIT_COMMAND_MACOS_COUNT;
                 break;
             case OC_HOST_PLATFORM_WINDOWS:
+            case OC_HOST_PLATFORM_LINUX:
                 editCommands = OC_UI_EDIT_COMMANDS_WINDOWS;
                 editCommandCount = OC_UI_EDIT_COMMAND_WINDOWS_COUNT;
                 break;
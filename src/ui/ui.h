@@ -436,13 +436,21 @@ typedef struct oc_ui_box oc_ui_box;
 typedef struct oc_ui_style_rule
 {
     oc_list_elt boxElt;
-    oc_list_elt buildElt;
+    oc_list_elt indexElt;
+    oc_list_elt matchElt;
     oc_list_elt tmpElt;
 
     oc_ui_box* owner;
     oc_ui_pattern pattern;
     oc_ui_style_mask mask;
     oc_ui_style* style;
+
+    // styling prepass
+    oc_list* indexList;
+    oc_ui_selector_kind indexKind;
+    u64 indexValue;
+    i64 order;
+    bool derived;
 } oc_ui_style_rule;
 
 typedef struct oc_ui_sig
@@ -502,7 +510,6 @@ struct oc_ui_box
     oc_list_elt overlayElt;
 
     // keying and caching
-    oc_list_elt bucketElt;
     oc_ui_key key;
     u64 frameCounter;
 
@@ -527,6 +534,21 @@ struct oc_ui_box
     f32 spacing[2];
     f32 minSize[2];
     oc_rect rect;
+    oc_rect subtreeRect; // bounds of what the box and its descendants draw, used to cull them
+
+    // layout caching
+    u64 textHash;
+    oc_vec2 textSize;
+    f32 staticSize[2];
+    u64 layoutHash;  // layout inputs of the box itself
+    u64 subtreeHash; // layout inputs of the box and its descendants
+    u64 layoutFrame;
+    bool layoutClean; // subtree inputs didn't change since the previous frame
+    bool layoutReused[2];
+    f32 layoutInputSize[2];
+    f32 downSize[2];
+    f32 downMinSize[2];
+    u32 zCount;
 
     // signals
     oc_ui_sig* sig;
@@ -584,9 +606,22 @@ typedef struct oc_ui_tag_elt
 
 enum
 {
-    OC_UI_BOX_MAP_BUCKET_COUNT = 1024
+    OC_UI_BOX_MAP_MIN_CAPACITY = 1024
 };
 
+//NOTE: open-addressing table of the boxes built during the last frames, keyed by oc_ui_key.hash.
+//      The slots are allocated from two arenas in turn: a resize builds the new table in the arena that
+//      doesn't hold the current one, and the old table is released when that arena is cleared on the next resize.
+typedef struct oc_ui_box_map
+{
+    oc_arena arenas[2];
+    u32 arenaIndex;    // arena holding the current slots
+    oc_ui_box** slots; // null for empty slots, OC_UI_BOX_MAP_TOMBSTONE for removed ones
+    u64 capacity;      // power of two, 0 until the first box is cached
+    u64 count;
+    u64 tombstoneCount;
+} oc_ui_box_map;
+
 typedef enum
 {
     OC_UI_EDIT_MOVE_NONE = 0,
@@ -607,7 +642,7 @@ typedef struct oc_ui_context
 
     oc_arena frameArena;
     oc_pool boxPool;
-    oc_list boxMap[OC_UI_BOX_MAP_BUCKET_COUNT];
+    oc_ui_box_map boxMap;
 
     oc_ui_box* root;
     oc_ui_box* overlay;
@@ -638,6 +673,7 @@ typedef struct oc_ui_context
 // UI context initialization and frame cycle
 //-------------------------------------------------------------------------------------
 ORCA_API void oc_ui_init(oc_ui_context* context);
+ORCA_API void oc_ui_cleanup(void);
 ORCA_API oc_ui_context* oc_ui_get_context(void);
 ORCA_API void oc_ui_set_context(oc_ui_context* context);
 
@@ -741,6 +777,32 @@ ORCA_API void oc_ui_panel_begin(const char* name, oc_ui_flags flags);
 ORCA_API void oc_ui_panel_end(void);
 #define oc_ui_panel(s, f) oc_defer_loop(oc_ui_panel_begin(s, f), oc_ui_panel_end())
 
+//NOTE: virtualized list. Only the rows in [firstRow, endRow) are built by the caller, the space taken by the other rows is
+//      filled with spacers of rowHeight plus the contents' spacing per row, so that the scrollbar reflects the whole list.
+//      Rows should be keyed by their index, so that their boxes persist while they stay in view. If rows have different
+//      heights, rowHeight is used as an estimate, and slightly underestimating it only builds a few more rows.
+enum
+{
+    OC_UI_LIST_DEFAULT_OVERSCAN = 2,
+    OC_UI_LIST_MAX_HEIGHT = 1 << 24, // largest height of the list's contents, f32 pixel offsets are exact below that
+};
+
+typedef struct oc_ui_list_info
+{
+    u64 rowCount;
+    f32 rowHeight; // not including the spacing between rows
+    u32 overscan;  // rows built before and after the visible ones, OC_UI_LIST_DEFAULT_OVERSCAN if 0
+
+    // set by oc_ui_list_begin()
+    u64 firstRow;
+    u64 endRow;
+    f32 afterHeight; // height of the spacer after the built rows
+} oc_ui_list_info;
+
+ORCA_API void oc_ui_list_begin(const char* name, oc_ui_flags flags, oc_ui_list_info* info);
+ORCA_API void oc_ui_list_end(oc_ui_list_info* info);
+#define oc_ui_list(s, f, info) oc_defer_loop(oc_ui_list_begin(s, f, info), oc_ui_list_end(info))
+
 ORCA_API void oc_ui_menu_bar_begin(const char* name);
 ORCA_API void oc_ui_menu_bar_end(void);
 #define oc_ui_menu_bar(name) oc_defer_loop(oc_ui_menu_bar_begin(name), oc_ui_menu_bar_end())
@@ -109,8 +109,8 @@ inline T oc_cube(T a)
     //NOTE(martin): this macros helps generate variants of a generic 'template' for all arithmetic types.
     // the def parameter must be a macro that takes a type, and optional arguments
 
-    #if OC_COMPILER_CL
-        //NOTE: size_t conflicts with u64 on MSVC, whereas it is a distinct type on clang
+    #if OC_COMPILER_CL || OC_PLATFORM_LINUX
+        //NOTE: size_t conflicts with u64 on MSVC and 64-bit linux, whereas it is a distinct type on macOS
         #define oc_tga_variants(def, ...)                                                                       \
             def(u8, ##__VA_ARGS__) def(i8, ##__VA_ARGS__) def(u16, ##__VA_ARGS__) def(i16, ##__VA_ARGS__)       \
                 def(u32, ##__VA_ARGS__) def(i32, ##__VA_ARGS__) def(u64, ##__VA_ARGS__) def(i64, ##__VA_ARGS__) \
@@ -0,0 +1,17 @@
+/*************************************************************************
+*
+*  Orca
+*  Copyright 2023 Martin Fouilleul and the Orca project contributors
+*  See LICENSE.txt for licensing information
+*
+**************************************************************************/
+
+//------------------------------------------------------------------------
+// glyph coverage length checks
+//------------------------------------------------------------------------
+
+u64 orca_font_rasterize_glyph_length(IM3Runtime runtime, u32 width, u32 height)
+{
+    u64 len = (u64)width * height;
+    return len;
+}